@@ -67,6 +67,7 @@ void AmbientOcclusionPass::renderGui(Gui* pGui)
     int dirty = 0;
     dirty |= (int)pGui->addFloatVar("AO radius", mAORadius, 1e-4f, 1e38f, mAORadius * 0.01f);
 	dirty |= (int)pGui->addIntVar("Num AO Rays", mNumRaysPerPixel, 1, 64);
+	dirty |= (int)pGui->addCheckBox(mUseBlueNoise ? "Using blue-noise samples" : "Using white-noise samples", mUseBlueNoise);
 
     // If we modify options, let our pipeline know that we changed our rendering parameters 
     if (dirty) setRefreshFlag();
@@ -87,9 +88,11 @@ void AmbientOcclusionPass::execute(RenderContext* pRenderContext)
 	rayGenVars["RayGenCB"]["gAORadius"]    = mAORadius;
 	rayGenVars["RayGenCB"]["gMinT"]        = mpResManager->getMinTDist();  // From the UI dropdown
 	rayGenVars["RayGenCB"]["gNumRays"]     = uint32_t(mNumRaysPerPixel);
+	rayGenVars["RayGenCB"]["gBlueNoise"]   = uint32_t(mUseBlueNoise ? 1 : 0);
 	rayGenVars["gPos"]    = mpResManager->getTexture(mPositionIndex);
 	rayGenVars["gNorm"]   = mpResManager->getTexture(mNormalIndex);
 	rayGenVars["gOutput"] = pDstTex;
+	rayGenVars["gBlueNoiseMasks"] = mpResManager->getBlueNoise()->getTexture();
 
 	// Shoot our AO rays
 	mpRays->execute( pRenderContext, uvec2(pDstTex->getWidth(), pDstTex->getHeight()) );
@@ -53,6 +53,7 @@ protected:
 	float                                   mAORadius = 0.0f;       ///< What radius are we using for AO rays (i.e., maxT when ray tracing)
 	uint32_t                                mFrameCount = 0;        ///< Frame count used to help seed our shaders' random number generator
 	int32_t                                 mNumRaysPerPixel = 1;   ///< How many ambient occlusion rays should we shot per pixel?
+	bool                                    mUseBlueNoise = true;   ///< Draw samples from the blue-noise masks (or from a white-noise LCG)?
 
 	// Indices we can use to query the resource manager for various texture resources
 	int32_t                                 mPositionIndex;         ///< An index for the G-Buffer wsPosition buffer
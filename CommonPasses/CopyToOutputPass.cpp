@@ -37,8 +37,13 @@ bool CopyToOutputPass::initialize(RenderContext* pRenderContext, ResourceManager
 
 void CopyToOutputPass::renderGui(Gui* pGui)
 {
-	// Add a widget to allow us to select our buffer to display
-	pGui->addDropdown("Displayed", mDisplayableBuffers, mSelectedBuffer);
+	// Add a widget to allow us to select our buffer to display.  If it changes, the pipeline's pass graph
+	//     needs rebuilding, since different passes now feed the output.
+	if (pGui->addDropdown("Displayed", mDisplayableBuffers, mSelectedBuffer))
+	{
+		declareSelectedChannel();
+		setRebindFlag();
+	}
 }
 
 void CopyToOutputPass::execute(RenderContext* pRenderContext)
@@ -99,4 +104,13 @@ void CopyToOutputPass::pipelineUpdated(ResourceManager::SharedPtr pResManager)
 		mDisplayableBuffers.push_back({ -1, "< None >" });
 		mSelectedBuffer = uint32_t(-1);
 	}
+
+	declareSelectedChannel();
+}
+
+void CopyToOutputPass::declareSelectedChannel()
+{
+	clearDeclaredChannels();
+	if (mSelectedBuffer != uint32_t(-1)) declareInputs({ mpResManager->getTextureName(mSelectedBuffer) });
+	declareOutputs({ ResourceManager::kOutputChannel });
 }
\ No newline at end of file
@@ -43,11 +43,15 @@ protected:
 	// When the pipeline is updated, we will need to update the list of buffers we can copy from
 	void pipelineUpdated(ResourceManager::SharedPtr pResManager) override;
 
+	// Let the pipeline know which buffer we're currently copying from
+	void declareSelectedChannel();
+
 	// The execute() callback is invoked during frame render when it is this pass' turn to execute
     void execute(RenderContext* pRenderContext) override;
 
 	// Override some functions that provide information to the RenderPipeline class
 	bool appliesPostprocess() override { return true; }
+	bool canRecordInParallel() override { return true; }
 
 	Gui::DropdownList mDisplayableBuffers;  
 	uint32_t          mSelectedBuffer = 0xFFFFFFFFu;
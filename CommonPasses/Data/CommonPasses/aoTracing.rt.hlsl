@@ -26,6 +26,9 @@ import Shading;                      // Shading functions, etc
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "aoCommonUtils.hlsli"
 
+// Per-pixel sample sequences, drawn from the LCG or from blue-noise masks
+#include "BlueNoise.slang"
+
 // Payload for our primary rays.  We really don't use this for this g-buffer pass
 struct AORayPayload
 {
@@ -39,12 +42,14 @@ cbuffer RayGenCB
 	uint  gFrameCount;
 	float gMinT;
 	uint  gNumRays;
+	uint  gBlueNoise;       // Draw samples from the blue-noise masks instead of the LCG?
 }
 
 // Input and out textures that need to be set by the C++ code
 Texture2D<float4> gPos;
 Texture2D<float4> gNorm;
 RWTexture2D<float4> gOutput;
+Texture2DArray<float4> gBlueNoiseMasks; // Spatiotemporal blue noise, one slice per frame (see BlueNoise.slang)
 
 
 [shader("miss")]
@@ -77,8 +82,10 @@ void AoRayGen()
 	uint2 launchIndex = DispatchRaysIndex().xy;
 	uint2 launchDim   = DispatchRaysDimensions().xy;
 
-	// Initialize random seed per sample based on a screen position and temporally varying count
+	// Initialize random seed per sample based on a screen position and temporally varying count.  With blue noise, the
+	//     error left in each frame is mostly high frequency, so it averages out over neighboring pixels and frames.
 	uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
+	SampleSequence samples = initSampleSequence(launchIndex, gFrameCount, randSeed, gBlueNoise != 0);
 
 	// Load the position and normal from our g-buffer
 	float4 worldPos = gPos[launchIndex];
@@ -96,7 +103,7 @@ void AoRayGen()
 		for (int i = 0; i < gNumRays; i++)
 		{
 			// Sample cosine-weighted hemisphere around the surface normal
-			float3 worldDir = getCosHemisphereSample(randSeed, worldNorm.xyz);
+			float3 worldDir = getCosHemisphereSample(nextSample2D(samples, gBlueNoiseMasks), worldNorm.xyz);
 
 			// Setup ambient occlusion ray
 			RayDesc rayAO;
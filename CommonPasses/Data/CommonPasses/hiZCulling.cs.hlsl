@@ -0,0 +1,158 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Two-phase Hi-Z occlusion culling of scene mesh instances (see SharedUtils/HiZOcclusionCuller.h for the order these
+//     kernels run in).  Each instance box gets one DrawIndexedArguments record per phase in gDrawArgs; the CPU
+//     records an indirect draw for every frustum-visible instance in both phases, and these kernels set
+//     InstanceCount to 0 for the draws that should be skipped.
+
+#include "hiZCulling.hlsli"
+
+#define DRAW_ARGS_SIZE  20       // sizeof(D3D12_DRAW_INDEXED_ARGUMENTS)
+
+cbuffer HiZCB
+{
+	float4x4 gViewProj;          // This frame's camera
+	float4x4 gPrevInvViewProj;   // Last frame's camera (HiZReproject only)
+	uint2    gBaseSize;          // Size of the depth buffer, i.e., of pyramid level 0
+	uint     gDstLevel;          // Level HiZDownsample writes (it reads gDstLevel - 1)
+	uint     gBoxCount;
+	uint     gPyramidValid;      // 0 when there was no usable depth last frame, so phase 1 can't cull anything
+}
+
+Texture2D<float>    gDepth;            // Last frame's depth in HiZReproject, this frame's in HiZCopyDepth
+RWBuffer<uint>      gReprojected;      // Bits of the reprojected depth, 0 where nothing landed
+RWBuffer<float>     gHiZ;
+Buffer<float4>      gBoxes;            // World-space center and half extent of each box
+ByteAddressBuffer   gDrawTemplates;    // Draw arguments per box, written by the CPU.  InstanceCount is 0 for boxes it doesn't draw.
+RWByteAddressBuffer gDrawArgs;         // Phase 1 arguments for all boxes, then phase 2 arguments for all boxes
+RWBuffer<uint>      gRetest;           // 1 for boxes phase 1 culled, which phase 2 tests again
+RWBuffer<uint>      gCounters;         // Boxes tested, culled in phase 1, drawn in phase 2, culled in both phases
+
+// Splat each pixel of last frame's depth into the pixel it lands in this frame, keeping the farthest depth
+[numthreads(16, 16, 1)]
+void HiZReproject(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 pixel = threadId.xy;
+	if (any(pixel >= gBaseSize)) return;
+
+	float depth = gDepth[pixel];
+	if (depth >= 1.0f) return;
+
+	float2 ndcXY = (float2(pixel) + 0.5f) / float2(gBaseSize) * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f);
+	float4 world = mul(float4(ndcXY, depth, 1.0f), gPrevInvViewProj);
+	float4 clip = mul(float4(world.xyz / world.w, 1.0f), gViewProj);
+	if (clip.w <= 0.0f) return;
+
+	float3 pos = clip.xyz / clip.w;
+	if (pos.z <= 0.0f || pos.z >= 1.0f) return;
+	float2 uv = float2(pos.x * 0.5f + 0.5f, 0.5f - pos.y * 0.5f);
+	if (any(uv < 0.0f) || any(uv >= 1.0f)) return;
+
+	// Positive floats compare like their bits do
+	uint2 dst = uint2(uv * float2(gBaseSize));
+	InterlockedMax(gReprojected[dst.x + dst.y * gBaseSize.x], asuint(pos.z));
+}
+
+// Fill level 0 from the reprojected depth.  Holes get the far plane, so they never occlude anything.
+[numthreads(16, 16, 1)]
+void HiZResolveReprojection(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 pixel = threadId.xy;
+	if (any(pixel >= gBaseSize)) return;
+
+	uint bits = gReprojected[pixel.x + pixel.y * gBaseSize.x];
+	gHiZ[pixel.x + pixel.y * gBaseSize.x] = (bits != 0) ? asfloat(bits) : 1.0f;
+}
+
+// Fill level 0 from this frame's depth
+[numthreads(16, 16, 1)]
+void HiZCopyDepth(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 pixel = threadId.xy;
+	if (any(pixel >= gBaseSize)) return;
+
+	gHiZ[pixel.x + pixel.y * gBaseSize.x] = gDepth[pixel];
+}
+
+[numthreads(16, 16, 1)]
+void HiZDownsample(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 dstSize = hiZLevelSize(gBaseSize, gDstLevel);
+	uint2 cell = threadId.xy;
+	if (any(cell >= dstSize)) return;
+
+	uint2 srcSize = hiZLevelSize(gBaseSize, gDstLevel - 1);
+	uint srcOffset = hiZLevelOffset(gBaseSize, gDstLevel - 1);
+
+	// Take the maximum over the (up to) 2x2 source cells.  Odd-sized levels clamp at the edge.
+	float depth = 0.0f;
+	[unroll]
+	for (uint i = 0; i < 4; i++)
+	{
+		uint2 src = min(cell * 2 + uint2(i & 1, i >> 1), srcSize - 1);
+		depth = max(depth, gHiZ[srcOffset + src.x + src.y * srcSize.x]);
+	}
+	gHiZ[hiZLevelOffset(gBaseSize, gDstLevel) + cell.x + cell.y * dstSize.x] = depth;
+}
+
+bool isBoxOccluded(uint box)
+{
+	return hiZIsOccluded(gHiZ, gBaseSize, gBoxes[2 * box].xyz, gBoxes[2 * box + 1].xyz, gViewProj);
+}
+
+// Copy the CPU's draw arguments, keeping the draw only if <draw> is set
+void writeDrawArgs(uint dstOffset, uint box, bool draw)
+{
+	uint4 args = gDrawTemplates.Load4(box * DRAW_ARGS_SIZE);
+	args.y = draw ? 1 : 0;
+	gDrawArgs.Store4(dstOffset, args);
+	gDrawArgs.Store(dstOffset + 16, gDrawTemplates.Load(box * DRAW_ARGS_SIZE + 16));
+}
+
+// Phase 1: test against last frame's depth, reprojected to this frame's camera
+[numthreads(64, 1, 1)]
+void HiZCullPhase1(uint3 threadId : SV_DispatchThreadID)
+{
+	uint box = threadId.x;
+	if (box >= gBoxCount) return;
+
+	bool drawn = gDrawTemplates.Load(box * DRAW_ARGS_SIZE + 4) != 0;
+	bool occluded = drawn && (gPyramidValid != 0) && isBoxOccluded(box);
+	writeDrawArgs(box * DRAW_ARGS_SIZE, box, drawn && !occluded);
+	gRetest[box] = occluded ? 1 : 0;
+
+	if (drawn) InterlockedAdd(gCounters[0], 1);
+	if (occluded) InterlockedAdd(gCounters[1], 1);
+}
+
+// Phase 2: test what phase 1 culled against this frame's depth, which holds everything phase 1 drew.  Boxes that
+//     are visible now were disoccluded (or moved) since last frame.
+[numthreads(64, 1, 1)]
+void HiZCullPhase2(uint3 threadId : SV_DispatchThreadID)
+{
+	uint box = threadId.x;
+	if (box >= gBoxCount) return;
+
+	bool retest = gRetest[box] != 0;
+	bool occluded = retest && isBoxOccluded(box);
+	writeDrawArgs((gBoxCount + box) * DRAW_ARGS_SIZE, box, retest && !occluded);
+
+	if (retest && !occluded) InterlockedAdd(gCounters[2], 1);
+	if (occluded) InterlockedAdd(gCounters[3], 1);
+}
@@ -0,0 +1,92 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Hi-Z occlusion test for instance bounds.  SharedUtils/HiZCulling.cpp is the CPU reference and must stay in sync.
+//     The pyramid holds hardware depth in a flat buffer.  Level 0 is one value per pixel; each higher level holds the
+//     maximum (i.e., farthest) depth of the 2x2 cells below it.  Levels are stored one after another, each row-major.
+
+#define HIZ_MAX_LEVELS   16
+
+// Dimensions of a level of the pyramid
+uint2 hiZLevelSize(uint2 baseSize, uint level)
+{
+	return max(uint2(1, 1), (baseSize + (1u << level) - 1u) >> level);
+}
+
+// Where a level of the pyramid starts in the buffer
+uint hiZLevelOffset(uint2 baseSize, uint level)
+{
+	uint offset = 0;
+	for (uint l = 0; l < level; l++)
+	{
+		uint2 size = hiZLevelSize(baseSize, l);
+		offset += size.x * size.y;
+	}
+	return offset;
+}
+
+// How many levels does a pyramid over a <baseSize> image have (down to and including 1x1)?
+uint hiZLevelCount(uint2 baseSize)
+{
+	uint levels = 1;
+	while (any(hiZLevelSize(baseSize, levels - 1) > 1u) && levels < HIZ_MAX_LEVELS) levels++;
+	return levels;
+}
+
+// Is the world-space box (center, half extent) hidden behind the depths in the pyramid?  The box's closest depth is
+//     compared to the farthest depth of the (at most 2x2) cells covering its screen rectangle, at the finest level
+//     where a cell is wider than the rectangle.  Boxes crossing the near plane are never occluded.
+bool hiZIsOccluded(RWBuffer<float> hiZ, uint2 baseSize, float3 center, float3 extent, float4x4 viewProj)
+{
+	float2 uvMin = float2(1.0f, 1.0f);
+	float2 uvMax = float2(0.0f, 0.0f);
+	float minDepth = 1.0f;
+	for (uint i = 0; i < 8; i++)
+	{
+		float3 corner = center + extent * float3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+		float4 clip = mul(float4(corner, 1.0f), viewProj);
+		if (clip.w <= 0.0f || clip.z < 0.0f) return false;
+
+		float3 pos = clip.xyz / clip.w;
+		float2 uv = float2(pos.x * 0.5f + 0.5f, 0.5f - pos.y * 0.5f);
+		uvMin = min(uvMin, uv);
+		uvMax = max(uvMax, uv);
+		minDepth = min(minDepth, pos.z);
+	}
+
+	uint2 pixelMin = min(uint2(saturate(uvMin) * float2(baseSize)), baseSize - 1u);
+	uint2 pixelMax = min(uint2(saturate(uvMax) * float2(baseSize)), baseSize - 1u);
+
+	uint span = max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y);
+	uint level = (span == 0) ? 0 : firstbithigh(span) + 1;
+	level = min(level, hiZLevelCount(baseSize) - 1);
+
+	uint2 size = hiZLevelSize(baseSize, level);
+	uint offset = hiZLevelOffset(baseSize, level);
+	uint2 cellMin = pixelMin >> level;
+	uint2 cellMax = pixelMax >> level;
+	float maxDepth = 0.0f;
+	for (uint y = cellMin.y; y <= cellMax.y; y++)
+	{
+		for (uint x = cellMin.x; x <= cellMax.x; x++)
+		{
+			maxDepth = max(maxDepth, hiZ[offset + x + y * size.x]);
+		}
+	}
+	return minDepth > maxDepth;
+}
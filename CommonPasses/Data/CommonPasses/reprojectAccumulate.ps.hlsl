@@ -0,0 +1,122 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Accumulates like accumulate.ps.hlsl, but follows the G-buffer's motion vectors into last frame's accumulated result
+//     instead of throwing it away when the camera moves.  Each pixel keeps its own sample count, and only the pixels whose
+//     history doesn't match their current surface (by depth and normal) start over.
+
+import MathHelpers;         // For oct_to_ndir_snorm()
+
+cbuffer PerFrameCB
+{
+	int2  gRenderDim;       // Pixels rendered this frame (the top-left part of the textures, see ResourceManager::getRenderSize())
+	int2  gPrevRenderDim;   // Pixels rendered last frame, which the history covers
+	uint  gResetHistory;    // Ignore all history (e.g., the scene or pipeline changed)
+	uint  gCameraMoved;     // Did the view change since last frame?  (Background pixels have no motion vectors to follow.)
+	float gMaxSamples;      // Stop growing the per-pixel count here, so history fades out slowly (0 for unlimited)
+	float gDepthTolerance;  // Allowed depth difference, in multiples of the pixel's depth derivative
+	float gNormalTolerance; // Allowed normal difference, in multiples of the pixel's normal derivative
+}
+
+Texture2D<float4>   gCurFrame;
+Texture2D<float4>   gLastFrame;
+Texture2D<float>    gLastSampleCount;
+Texture2D<float4>   gMotionAndFWidth;       // xy: motion in UVs, w: normal derivative
+Texture2D<float4>   gLinearZAndNormal;      // x: linear depth, y: its derivative, zw: octahedral normal
+Texture2D<float4>   gPrevLinearZAndNormal;
+
+struct PsOut
+{
+	float4 color       : SV_Target0;
+	float  sampleCount : SV_Target1;
+};
+
+// Is the history at this (last frame) pixel the same surface as our current pixel?
+bool isHistoryValid(int2 prevPixel, float depth, float depthFwidth, float3 normal, float normalFwidth)
+{
+	if (any(prevPixel < int2(0, 0)) || any(prevPixel >= gPrevRenderDim)) return false;
+
+	float4 prevZAndNormal = gPrevLinearZAndNormal[prevPixel];
+	if (prevZAndNormal.x <= 0.0f) return false;    // Background (or cleared) last frame
+	if (abs(prevZAndNormal.x - depth) > gDepthTolerance * (depthFwidth + 1e-2f) ) return false;
+	if (distance(normal, oct_to_ndir_snorm(prevZAndNormal.zw)) > gNormalTolerance * (normalFwidth + 1e-2f)) return false;
+	return true;
+}
+
+PsOut main(float2 texC : TEXCOORD, float4 pos : SV_Position)
+{
+	int2 pixelPos = int2(pos.xy);
+	float4 curColor = gCurFrame[pixelPos];
+
+	PsOut result;
+	result.color = curColor;
+	result.sampleCount = 1.0f;
+	if (gResetHistory != 0) return result;
+
+	float4 zAndNormal = gLinearZAndNormal[pixelPos];
+	float4 motionAndFWidth = gMotionAndFWidth[pixelPos];
+	float3 normal = oct_to_ndir_snorm(zAndNormal.zw);
+
+	// Pixels with no geometry have no motion to follow, so they only keep their history if the view didn't change at all
+	if (zAndNormal.x <= 0.0f)
+	{
+		bool sameView = gCameraMoved == 0 && all(gRenderDim == gPrevRenderDim);
+		float count = (sameView && gPrevLinearZAndNormal[pixelPos].x <= 0.0f) ? gLastSampleCount[pixelPos] : 0.0f;
+		if (gMaxSamples > 0.0f) count = min(count, gMaxSamples - 1.0f);
+		result.color = (count * gLastFrame[pixelPos] + curColor) / (count + 1.0f);
+		result.sampleCount = count + 1.0f;
+		return result;
+	}
+
+	// Motion is in UVs, so find where our pixel center was in last frame's render size.  Then bilinearly gather the
+	//     surrounding history texels that saw the same surface.  A static camera lands exactly on one texel, so this
+	//     reduces to plain accumulation.
+	float2 prevCenter = ((float2(pixelPos) + 0.5f) / float2(gRenderDim) + motionAndFWidth.xy) * float2(gPrevRenderDim);
+	float2 prevPos = prevCenter - 0.5f;
+	int2 prevBase = int2(floor(prevPos));
+	float2 f = prevPos - float2(prevBase);
+
+	const int2 offsets[4] = { int2(0, 0), int2(1, 0), int2(0, 1), int2(1, 1) };
+	const float weights[4] = { (1 - f.x) * (1 - f.y), f.x * (1 - f.y), (1 - f.x) * f.y, f.x * f.y };
+
+	float4 prevColor = float4(0, 0, 0, 0);
+	float prevCount = 0.0f;
+	float sumW = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		int2 tap = prevBase + offsets[i];
+		if (weights[i] > 0.0f && isHistoryValid(tap, zAndNormal.x, zAndNormal.y, normal, motionAndFWidth.w))
+		{
+			prevColor += weights[i] * gLastFrame[tap];
+			prevCount += weights[i] * gLastSampleCount[tap];
+			sumW += weights[i];
+		}
+	}
+
+	// Disoccluded?  Start this pixel over.
+	if (sumW < 0.01f) return result;
+
+	// Our history is now a blend of neighbouring histories; credit it with their (rounded down) average sample count
+	prevColor /= sumW;
+	float count = floor(prevCount / sumW);
+	if (gMaxSamples > 0.0f) count = min(count, gMaxSamples - 1.0f);
+
+	result.color = (count * prevColor + curColor) / (count + 1.0f);
+	result.sampleCount = count + 1.0f;
+	return result;
+}
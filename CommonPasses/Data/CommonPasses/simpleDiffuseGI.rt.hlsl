@@ -29,6 +29,12 @@ import Lights;                       // Light structures for our current scene
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "simpleDiffuseGIUtils.hlsli"
 
+// Falcor's helpers to sample directions towards bright regions of the environment map
+#include "EnvMapSampling.slang"
+
+// Per-pixel sample sequences, drawn from the LCG or from blue-noise masks
+#include "BlueNoise.slang"
+
 // Include shader entries, data structures, and utility function to spawn shadow rays
 #include "standardShadowRay.hlsli"
 
@@ -39,6 +45,8 @@ cbuffer RayGenCB
 	uint  gFrameCount;     // An integer changing every frame to update the random number
 	bool  gDoIndirectGI;   // A boolean determining if we should shoot indirect GI rays
 	bool  gCosSampling;    // Use cosine sampling (true) or uniform sampling (false)
+	bool  gEnvSampling;    // Also sample the environment map for direct lighting
+	bool  gBlueNoise;      // Draw the ray generation shader's samples from the blue-noise masks instead of the LCG
 }
 
 // Input and out textures that need to be set by the C++ code (for the ray gen shader)
@@ -46,16 +54,26 @@ Texture2D<float4> gPos;
 Texture2D<float4> gNorm;
 Texture2D<float4> gDiffuseMatl;
 RWTexture2D<float4> gOutput;
+Texture2DArray<float4> gBlueNoiseMasks; // Spatiotemporal blue noise, one slice per frame (see BlueNoise.slang)
 
 // The payload used for our indirect global illumination rays
 struct IndirectRayPayload
 {
 	float3 color;    // The (returned) color in the ray's direction
 	uint   rndSeed;  // Our random seed, so we pick uncorrelated RNGs along our ray
+	float  bsdfPdf;  // Probability of selecting this ray, if direct lighting also sampled the environment map (0 otherwise)
 };
 
-// Our environment map, used for the miss shader for indirect rays
+// Our environment map, used for the miss shader for indirect rays, and the alias tables to importance sample it
 Texture2D<float4> gEnvMap;
+ByteAddressBuffer gEnvMarginal;
+ByteAddressBuffer gEnvConditional;
+
+// Power heuristic weight of a sample drawn with probability pdf, when another strategy could have drawn it with otherPdf
+float misWeight(float pdf, float otherPdf)
+{
+	return (pdf * pdf) / (pdf * pdf + otherPdf * otherPdf);
+}
 
 // What code is executed when our ray misses all geometry?
 [shader("miss")]
@@ -70,6 +88,13 @@ void IndirectMiss(inout IndirectRayPayload rayData)
 
 	// Load our background color, then store it into our ray payload
 	rayData.color = gEnvMap[uint2(uv * dims)].rgb;
+
+	// Direct lighting sampled the environment map too.  Weight our contribution against it
+	if (rayData.bsdfPdf > 0.0f)
+	{
+		float envPdf = evalEnvMapPdf(gEnvMarginal, gEnvConditional, uint2(dims), WorldRayDirection(), uv);
+		rayData.color *= misWeight(rayData.bsdfPdf, envPdf);
+	}
 }
 
 [shader("anyhit")]
@@ -109,7 +134,7 @@ void IndirectClosestHit(inout IndirectRayPayload rayData, BuiltInTriangleInterse
 
 // A utility function to trace an idirect ray and return the color it sees.
 //    -> Note:  This assumes the indirect hit programs and miss programs are index 1!
-float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint seed)
+float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint seed, float bsdfPdf)
 {
 	// Setup shadow ray
 	RayDesc rayColor;
@@ -122,6 +147,7 @@ float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint seed)
 	IndirectRayPayload payload;
 	payload.color = float3(0, 0, 0);  
 	payload.rndSeed = seed;
+	payload.bsdfPdf = bsdfPdf;
 
 	// Trace our ray to get a color in the indirect direction.  Use hit group #1 and miss shader #1
 	TraceRay(gRtScene, 0, 0xFF, 1, hitProgramCount, 1, rayColor, payload);
@@ -145,14 +171,16 @@ void SimpleDiffuseGIRayGen()
 	// If we don't hit any geometry, our difuse material contains our background color.
 	float3 shadeColor = difMatlColor.rgb;
 
-	// Initialize our random number generator
+	// Initialize our random number generator.  The samples taken here come from the blue-noise masks if enabled; the
+	//     indirect rays' hits keep using the LCG, since their samples aren't laid out on the screen.
 	uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
+	SampleSequence samples = initSampleSequence(launchIndex, gFrameCount, randSeed, gBlueNoise);
 
 	// Our camera sees the background if worldPos.w is 0, only do diffuse shading & GI elsewhere
 	if (worldPos.w != 0.0f)
 	{
 		// Pick a random light from our scene to sample for direct lighting
-		int lightToSample = min(int(nextRand(randSeed) * gLightsCount), gLightsCount - 1);
+		int lightToSample = min(int(nextSample1D(samples, gBlueNoiseMasks) * gLightsCount), gLightsCount - 1);
 
 		// We need to query our scene to find info about the current light
 		float distToLight;
@@ -169,25 +197,43 @@ void SimpleDiffuseGIRayGen()
 		// Compute our Lambertian shading color using the physically based Lambertian term (albedo / pi)
 		shadeColor = shadowMult * LdotN * lightIntensity * difMatlColor.rgb / M_PI;
 
+		// Pick a direction towards a bright region of the environment map, and light with it if it's visible
+		if (gEnvSampling)
+		{
+			float2 envDims;
+			gEnvMap.GetDimensions(envDims.x, envDims.y);
+
+			float envPdf;
+			float3 envDir = sampleEnvMap(gEnvMarginal, gEnvConditional, uint2(envDims), nextSample2D(samples, gBlueNoiseMasks), envPdf);
+			float NdotE = saturate(dot(worldNorm.xyz, envDir));
+			if (NdotE > 0.0f && envPdf > 0.0f)
+			{
+				float3 envColor = gEnvMap[uint2(wsVectorToLatLong(envDir) * envDims)].rgb;
+				float bsdfPdf = gCosSampling ? (NdotE / M_PI) : (1.0f / (2.0f * M_PI));
+				float envVis = shadowRayVisibility(worldPos.xyz, envDir, gMinT, 1.0e38f);
+				shadeColor += envVis * NdotE * envColor * difMatlColor.rgb / M_PI * misWeight(envPdf, bsdfPdf) / envPdf;
+			}
+		}
+
 		// Now do our indirect illumination
 		if (gDoIndirectGI)
 		{
 			// Select a random direction for our diffuse interreflection ray.
 			float3 bounceDir;
 			if (gCosSampling)
-				bounceDir = getCosHemisphereSample(randSeed, worldNorm.xyz);      // Use cosine sampling
+				bounceDir = getCosHemisphereSample(nextSample2D(samples, gBlueNoiseMasks), worldNorm.xyz);      // Use cosine sampling
 			else
-				bounceDir = getUniformHemisphereSample(randSeed, worldNorm.xyz);  // Use uniform random samples
+				bounceDir = getUniformHemisphereSample(nextSample2D(samples, gBlueNoiseMasks), worldNorm.xyz);  // Use uniform random samples
 
 			// Get NdotL for our selected ray direction
 			float NdotL = saturate(dot(worldNorm.xyz, bounceDir));
 
-			// Shoot our indirect global illumination ray
-			float3 bounceColor = shootIndirectRay(worldPos.xyz, bounceDir, gMinT, randSeed);
-
 			// Probability of selecting this ray ( cos/pi for cosine sampling, 1/2pi for uniform sampling )
 			float sampleProb = gCosSampling ? (NdotL / M_PI) : (1.0f / (2.0f * M_PI));
 
+			// Shoot our indirect global illumination ray
+			float3 bounceColor = shootIndirectRay(worldPos.xyz, bounceDir, gMinT, samples.lcgState, gEnvSampling ? sampleProb : 0.0f);
+
 			// Accumulate the color.  For performance, terms could (and should) be cancelled here.
 			shadeColor += (NdotL * bounceColor * difMatlColor.rgb / M_PI) / sampleProb;
 		}
@@ -110,13 +110,10 @@ float nextRand(inout uint s)
 	return float(s & 0x00FFFFFF) / float(0x01000000);
 }
 
-// Get a cosine-weighted random vector centered around a specified normal direction.
-float3 getCosHemisphereSample(inout uint randSeed, float3 hitNorm)
+// Get a cosine-weighted vector centered around a specified normal direction, from 2 random numbers in [0..1)
+float3 getCosHemisphereSample(float2 randVal, float3 hitNorm)
 {
-	// Get 2 random numbers to select our sample with
-	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
-
-	// Cosine weighted hemisphere sample from RNG
+	// Cosine weighted hemisphere sample
 	float3 bitangent = getPerpendicularVector(hitNorm);
 	float3 tangent = cross(bitangent, hitNorm);
 	float r = sqrt(randVal.x);
@@ -126,13 +123,18 @@ float3 getCosHemisphereSample(inout uint randSeed, float3 hitNorm)
 	return tangent * (r * cos(phi).x) + bitangent * (r * sin(phi)) + hitNorm.xyz * sqrt(max(0.0,1.0f - randVal.x));
 }
 
-// Get a uniform weighted random vector centered around a specified normal direction.
-float3 getUniformHemisphereSample(inout uint randSeed, float3 hitNorm)
+// Get a cosine-weighted random vector centered around a specified normal direction.
+float3 getCosHemisphereSample(inout uint randSeed, float3 hitNorm)
 {
 	// Get 2 random numbers to select our sample with
 	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
+	return getCosHemisphereSample(randVal, hitNorm);
+}
 
-	// Cosine weighted hemisphere sample from RNG
+// Get a uniform weighted vector centered around a specified normal direction, from 2 random numbers in [0..1)
+float3 getUniformHemisphereSample(float2 randVal, float3 hitNorm)
+{
+	// Uniform hemisphere sample
 	float3 bitangent = getPerpendicularVector(hitNorm);
 	float3 tangent = cross(bitangent, hitNorm);
 	float r = sqrt(max(0.0f,1.0f - randVal.x*randVal.x));
@@ -142,6 +144,14 @@ float3 getUniformHemisphereSample(inout uint randSeed, float3 hitNorm)
 	return tangent * (r * cos(phi).x) + bitangent * (r * sin(phi)) + hitNorm.xyz * randVal.x;
 }
 
+// Get a uniform weighted random vector centered around a specified normal direction.
+float3 getUniformHemisphereSample(inout uint randSeed, float3 hitNorm)
+{
+	// Get 2 random numbers to select our sample with
+	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
+	return getUniformHemisphereSample(randVal, hitNorm);
+}
+
 // This function tests if the alpha test fails, given the attributes of the current hit. 
 //   -> Can legally be called in a DXR any-hit shader or a DXR closest-hit shader, and 
 //      accesses Falcor helpers and data structures to extract and perform the alpha test.
@@ -25,6 +25,7 @@ import Shading;                      // Shading functions, etc
 
 // Include utility functions for sampling random numbers
 #include "thinLensUtils.hlsli"
+#include "LowDiscrepancy.slang"
 
 // Define pi
 #define M_PI  3.14159265358979323846264338327950288
@@ -51,6 +52,9 @@ cbuffer RayGenCB
 	float2  gPixelJitter;   // in [0..1]^2.  Should be (0.5,0.5) if no jittering used
 }
 
+// Sobol direction numbers for our lens samples (see LowDiscrepancy.slang)
+Buffer<uint> gSobolDirections;
+
 // Our output textures, where we store our G-buffer results
 RWTexture2D<float4> gWsPos;
 RWTexture2D<float4> gWsNorm;
@@ -125,11 +129,13 @@ void GBufferRayGen()
 	// Find the focal point for this pixel.
 	float3 focalPoint = gCamera.posW + gFocalLen * rayDir;
 
-	// Initialize a random number generator
-	uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
+	// Our lens sample is the frame's point of this pixel's Owen-scrambled Sobol sequence, so lens samples stay stratified
+	//     as frames accumulate
+	LowDiscrepancySequence samples = initLowDiscrepancySequence(LD_SEQUENCE_SOBOL, gFrameCount, ldPixelSeed(launchIndex));
+	float2 lensSample = nextLowDiscrepancy2D(samples, gSobolDirections);
 
-	// Get random numbers (polar coordinates), convert to random cartesian uv on the lens
-	float2 rnd = float2(2.0f * M_PI * nextRand(randSeed), gLensRadius * nextRand(randSeed));
+	// Get polar coordinates from our sample, convert to cartesian uv on the lens
+	float2 rnd = float2(2.0f * M_PI * lensSample.x, gLensRadius * lensSample.y);
 	float2 uv  = float2(cos(rnd.x) * rnd.y, sin(rnd.x) * rnd.y);
 
 	// Use uv coordinate to compute a random origin on the camera lens
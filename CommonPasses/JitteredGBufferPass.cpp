@@ -6,9 +6,23 @@ namespace {
 	const char *kGbufVertShader = "CommonPasses\\gBuffer.vs.hlsl";
     const char *kGbufFragShader = "CommonPasses\\gBuffer.ps.hlsl";
 
-	// If we want to jitter the camera to antialias using traditional a traditional 8x MSAA pattern, 
-	//     use these positions (which are in the range [-8.0...8.0], so divide by 16 before use)
-	const float kMSAA[8][2] = { {1,-3}, {-1,3}, {5,1}, {-3,-5}, {-5,5}, {-7,-1}, {3,7}, {7,-7} };
+	// Patterns we can jitter the camera with.  The 8x MSAA pattern is the traditional D3D one; the low-discrepancy
+	//     patterns (see Utils/LowDiscrepancy.h) cycle through kJitterSampleCount samples
+	enum JitterPattern : uint32_t { kJitterMSAA = 0, kJitterRandom, kJitterHalton, kJitterSobol, kJitterR2 };
+	const Gui::DropdownList kJitterPatterns = { { kJitterMSAA, "8x MSAA" }, { kJitterRandom, "Random" }, { kJitterHalton, "Halton" }, { kJitterSobol, "Sobol" }, { kJitterR2, "R2" } };
+	const uint32_t kJitterSampleCount = 16;
+
+	PatternGenerator::SharedPtr createJitterPattern(uint32_t pattern)
+	{
+		switch (pattern)
+		{
+		case kJitterMSAA:   return DxSamplePattern::create();
+		case kJitterHalton: return HaltonSamplePattern::create(kJitterSampleCount);
+		case kJitterSobol:  return SobolSamplePattern::create(kJitterSampleCount);
+		case kJitterR2:     return R2SamplePattern::create(kJitterSampleCount);
+		default:            return nullptr;
+		}
+	}
 };
 
 bool JitteredGBufferPass::initialize(RenderContext::SharedPtr pRenderContext, ResourceManager::SharedPtr pResManager)
@@ -33,6 +47,7 @@ bool JitteredGBufferPass::initialize(RenderContext::SharedPtr pRenderContext, Re
 	auto currentTime    = std::chrono::high_resolution_clock::now();
 	auto timeInMillisec = std::chrono::time_point_cast<std::chrono::milliseconds>(currentTime);
 	mRng                = std::mt19937( uint32_t(timeInMillisec.time_since_epoch().count()) );
+	mpJitterSamples     = createJitterPattern(mJitterPattern);
 	
     return true;
 }
@@ -51,10 +66,11 @@ void JitteredGBufferPass::renderGui(Gui* pGui)
 	// Determine whether we're jittering at all
 	dirty |= (int)pGui->addCheckBox(mUseJitter ? "Camera jitter enabled" : "Camera jitter disabled", mUseJitter);
 
-	// Select what kind of jitter to use.  Right now, the choices are: 8x MSAA or completely random
-	if (mUseJitter)
+	// Select what kind of jitter to use:  8x MSAA, completely random, or a low-discrepancy pattern
+	if (mUseJitter && pGui->addDropdown("Jitter pattern", kJitterPatterns, mJitterPattern))
 	{
-		dirty |= (int)pGui->addCheckBox(mUseRandom ? "Using randomized camera position" : "Using 8x MSAA pattern", mUseRandom);
+		mpJitterSamples = createJitterPattern(mJitterPattern);
+		dirty = 1;
 	}
 
 	// If UI parameters change, let the pipeline know we're doing something different next frame
@@ -78,8 +94,9 @@ void JitteredGBufferPass::execute(RenderContext::SharedPtr pRenderContext)
 		mFrameCount++;
 
 		// Determine our offset in the pixel in the range [-0.5...0.5]
-		float xOff = mUseRandom ? mRngDist(mRng) - 0.5f : kMSAA[mFrameCount % 8][0]*0.0625f;
-		float yOff = mUseRandom ? mRngDist(mRng) - 0.5f : kMSAA[mFrameCount % 8][1]*0.0625f;
+		vec2 offset = mpJitterSamples ? mpJitterSamples->next() : vec2(mRngDist(mRng), mRngDist(mRng)) - 0.5f;
+		float xOff = offset.x;
+		float yOff = offset.y;
 
 		// Give our jitter to the scene camera
 		mpScene->getActiveCamera()->setJitter( xOff / float(outputFbo->getWidth()), yOff / float(outputFbo->getHeight()));
@@ -30,7 +30,8 @@ protected:
 	Scene::SharedPtr            mpScene;                ///< A pointer to the scene we're rendering
 	RasterPass::SharedPtr       mpRaster;               ///< A wrapper managing the shader for our g-buffer creation
 	bool                        mUseJitter = true;      ///< Jitter the camera?
-	bool                        mUseRandom = false;     ///< If jittering, use random samples or 8x MSAA pattern?
+	uint32_t                    mJitterPattern = 0;     ///< If jittering, which pattern?  (8x MSAA, random, Halton, Sobol or R2)
+	PatternGenerator::SharedPtr mpJitterSamples;        ///< Generates the jitter of every pattern except random
 	int                         mFrameCount = 0;        ///< If jittering the camera, which frame in our jitter are we on?
 
 	// Our random number generator (if we're doing randomized samples)
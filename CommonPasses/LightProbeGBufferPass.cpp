@@ -32,9 +32,23 @@ namespace {
 	const char* kEntryPrimaryAnyHit     = "PrimaryAnyHit";
 	const char* kEntryPrimaryClosestHit = "PrimaryClosestHit";
 
-	// If we want to jitter the camera to antialias using traditional a traditional 8x MSAA pattern, 
-	//     use these positions (which are in the range [-8.0...8.0], so divide by 16 before use)
-	const float kMSAA[8][2] = { { 1,-3 },{ -1,3 },{ 5,1 },{ -3,-5 },{ -5,5 },{ -7,-1 },{ 3,7 },{ 7,-7 } };
+	// Patterns we can jitter the camera with.  The 8x MSAA pattern is the traditional D3D one; the low-discrepancy
+	//     patterns (see Utils/LowDiscrepancy.h) cycle through kJitterSampleCount samples
+	enum JitterPattern : uint32_t { kJitterMSAA = 0, kJitterRandom, kJitterHalton, kJitterSobol, kJitterR2 };
+	const Gui::DropdownList kJitterPatterns = { { kJitterMSAA, "8x MSAA" }, { kJitterRandom, "Random" }, { kJitterHalton, "Halton" }, { kJitterSobol, "Sobol" }, { kJitterR2, "R2" } };
+	const uint32_t kJitterSampleCount = 16;
+
+	PatternGenerator::SharedPtr createJitterPattern(uint32_t pattern)
+	{
+		switch (pattern)
+		{
+		case kJitterMSAA:   return DxSamplePattern::create();
+		case kJitterHalton: return HaltonSamplePattern::create(kJitterSampleCount);
+		case kJitterSobol:  return SobolSamplePattern::create(kJitterSampleCount);
+		case kJitterR2:     return R2SamplePattern::create(kJitterSampleCount);
+		default:            return nullptr;
+		}
+	}
 };
 
 bool LightProbeGBufferPass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
@@ -61,6 +75,7 @@ bool LightProbeGBufferPass::initialize(RenderContext* pRenderContext, ResourceMa
 	auto currentTime = std::chrono::high_resolution_clock::now();
 	auto timeInMillisec = std::chrono::time_point_cast<std::chrono::milliseconds>(currentTime);
 	mRng = std::mt19937(uint32_t(timeInMillisec.time_since_epoch().count()));
+	mpJitterSamples = createJitterPattern(mJitterPattern);
 
 	// Our GUI needs more space than other passes, so enlarge the GUI window.
 	setGuiSize(ivec2(250, 220));
@@ -94,7 +109,11 @@ void LightProbeGBufferPass::renderGui(Gui* pGui)
 	if (mUseJitter)
 	{
 		pGui->addText("     ");
-		dirty |= (int)pGui->addCheckBox(mUseRandomJitter ? "Randomized jitter" : "8x MSAA jitter", mUseRandomJitter, true);
+		if (pGui->addDropdown("Jitter pattern", kJitterPatterns, mJitterPattern, true))
+		{
+			mpJitterSamples = createJitterPattern(mJitterPattern);
+			dirty = 1;
+		}
 	}
 
 	// If any of our UI parameters changed, let the pipeline know we're doing something different next frame
@@ -138,12 +157,14 @@ void LightProbeGBufferPass::execute(RenderContext* pRenderContext)
 	rayGenVars["RayGenCB"]["gFrameCount"]  = mFrameCount++;
 	rayGenVars["RayGenCB"]["gLensRadius"]  = mLensRadius;
 	rayGenVars["RayGenCB"]["gFocalLen"]    = mFocalLength;
+	rayGenVars["gSobolDirections"]         = mpResManager->getSobolDirections();
 
 	if (mUseJitter)
 	{
 		// Determine our offset in the pixel
-		float xOff = mUseRandomJitter ? mRngDist(mRng) - 0.5f : kMSAA[mFrameCount % 8][0] * 0.0625f;
-		float yOff = mUseRandomJitter ? mRngDist(mRng) - 0.5f : kMSAA[mFrameCount % 8][1] * 0.0625f;
+		vec2 offset = mpJitterSamples ? mpJitterSamples->next() : vec2(mRngDist(mRng), mRngDist(mRng)) - 0.5f;
+		float xOff = offset.x;
+		float yOff = offset.y;
 
 		// Set our shader and the scene camera to use the computed jitter
 		rayGenVars["RayGenCB"]["gPixelJitter"] = vec2( xOff + 0.5f, yOff + 0.5f );
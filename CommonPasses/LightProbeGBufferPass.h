@@ -57,7 +57,8 @@ protected:
 
 	// State for our camera jitter and random number generator (if we're doing randomized samples)
 	bool      mUseJitter = false;
-	bool      mUseRandomJitter = false;
+	uint32_t  mJitterPattern = 0;                       ///< 8x MSAA, random, Halton, Sobol or R2
+	PatternGenerator::SharedPtr mpJitterSamples;        ///< Generates the jitter of every pattern except random
 	std::uniform_real_distribution<float> mRngDist;     ///< We're going to want random #'s in [0...1] (the default distribution)
 	std::mt19937 mRng;                                  ///< Our random number generate.  Set up in initialize()
 
@@ -20,6 +20,7 @@
 
 namespace {
     const char *kAccumShader = "CommonPasses\\accumulate.ps.hlsl";
+    const char *kReprojectShader = "CommonPasses\\reprojectAccumulate.ps.hlsl";
 };
 
 SimpleAccumulationPass::SimpleAccumulationPass(const std::string &bufferToAccumulate)
@@ -35,10 +36,15 @@ bool SimpleAccumulationPass::initialize(RenderContext* pRenderContext, ResourceM
 	// Stash our resource manager; ask for the texture the developer asked us to accumulate
 	mpResManager = pResManager;
 	mpResManager->requestTextureResource(mAccumChannel);
+	if (mReprojectHistory) mpResManager->requestTextureResources({ "MotiveVectorsAndFWidth", "linearZAndNormal" });
 
-	// Create our graphics state and accumulation shader
+	// Tell the pipeline which channels we read and write
+	declareChannels();
+
+	// Create our graphics state and accumulation shaders
 	mpGfxState = GraphicsState::create();
 	mpAccumShader = FullscreenLaunch::create(kAccumShader);
+	mpReprojectShader = FullscreenLaunch::create(kReprojectShader);
 
 	// Our GUI needs less space than other passes, so shrink the GUI window.
 	setGuiSize(ivec2(250, 135));
@@ -68,10 +74,40 @@ void SimpleAccumulationPass::resize(uint32_t width, uint32_t height)
 	mpInternalFbo = ResourceManager::createFbo(width, height, ResourceFormat::RGBA32Float);
     mpGfxState->setFbo(mpInternalFbo);
 
+	allocateReprojectionResources(width, height);
+
     // Whenever we resize, we'd better force accumulation to restart
 	mAccumCount = 0;
 }
 
+void SimpleAccumulationPass::allocateReprojectionResources(uint32_t width, uint32_t height)
+{
+	if (!mReprojectHistory)
+	{
+		mpReprojectFbo = nullptr;
+		mpLastSampleCount = nullptr;
+		mpPrevLinearZAndNormal = nullptr;
+		return;
+	}
+
+	// Reprojection writes the per-pixel sample count alongside the color, and needs copies of both (plus depth) from last frame
+	Fbo::Desc desc;
+	desc.setColorTarget(0, ResourceFormat::RGBA32Float);   // accumulated color
+	desc.setColorTarget(1, ResourceFormat::R32Float);      // sample count
+	mpReprojectFbo = FboHelper::create2D(width, height, desc);
+	mpLastSampleCount = Texture::create2D(width, height, ResourceFormat::R32Float, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::RenderTarget);
+	mpPrevLinearZAndNormal = Texture::create2D(width, height, ResourceFormat::RGBA32Float, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::RenderTarget);
+}
+
+void SimpleAccumulationPass::declareChannels()
+{
+	// We modify our channel in place, so we both read and write it.  Reprojection also reads the G-buffer's motion and depth.
+	clearDeclaredChannels();
+	declareInputs({ mAccumChannel });
+	if (mReprojectHistory) declareInputs({ "MotiveVectorsAndFWidth", "linearZAndNormal" });
+	declareOutputs({ mAccumChannel });
+}
+
 void SimpleAccumulationPass::renderGui(Gui* pGui)
 {
 	// Print the name of the buffer we're accumulating from and into.  Add a blank line below that for clarity
@@ -86,9 +122,30 @@ void SimpleAccumulationPass::renderGui(Gui* pGui)
         setRefreshFlag();
     }
 
+	// Follow the motion vectors instead of restarting when the camera moves?  Pixels keep their own sample counts then.
+	if (pGui->addCheckBox("Reproject history under camera motion", mReprojectHistory))
+	{
+		// The G-buffer's motion and depth channels are only created once something asks for them
+		if (mReprojectHistory)
+		{
+			mpResManager->requestTextureResources({ "MotiveVectorsAndFWidth", "linearZAndNormal" });
+			mpResManager->initializeResources();
+		}
+		if (mpLastFrame) allocateReprojectionResources(mpLastFrame->getWidth(), mpLastFrame->getHeight());
+		declareChannels();
+		setRebindFlag();
+		mAccumCount = 0;
+	}
+	if (mReprojectHistory)
+	{
+		pGui->addIntVar("Max samples per pixel (0 = no limit)", mMaxSamples, 0);
+		pGui->addFloatVar("Depth tolerance", mDepthTolerance, 0.1f, 100.0f);
+		pGui->addFloatVar("Normal tolerance", mNormalTolerance, 0.1f, 100.0f);
+	}
+
 	// Display a count of accumulated frames
 	pGui->addText("");
-	pGui->addText((std::string("Frames accumulated: ") + std::to_string(mAccumCount)).c_str());
+	pGui->addText((std::string(mReprojectHistory ? "Frames since reset: " : "Frames accumulated: ") + std::to_string(mAccumCount)).c_str());
 }
 
 bool SimpleAccumulationPass::hasCameraMoved()
@@ -106,6 +163,18 @@ void SimpleAccumulationPass::execute(RenderContext* pRenderContext)
 
 	// If our input texture is invalid, or we've been asked to skip accumulation, do nothing.
     if (!inputTexture || !mDoAccumulation) return;
+
+	// Reprojecting?  Then camera motion (and resolution changes) only reset the pixels that lost their history.
+	if (mReprojectHistory && mpReprojectFbo)
+	{
+		Texture::SharedPtr motionTexture = mpResManager->getTexture("MotiveVectorsAndFWidth");
+		Texture::SharedPtr linearZTexture = mpResManager->getTexture("linearZAndNormal");
+		if (motionTexture && linearZTexture)
+		{
+			executeReprojected(pRenderContext, inputTexture, motionTexture, linearZTexture);
+			return;
+		}
+	}
    
 	// If the camera in our current scene has moved, we want to reset accumulation
 	if (hasCameraMoved())
@@ -114,20 +183,66 @@ void SimpleAccumulationPass::execute(RenderContext* pRenderContext)
 		mpLastCameraMatrix = mpScene->getActiveCamera()->getViewMatrix();
 	}
 
+	// Same if dynamic resolution changed the render size: last frame's pixels don't line up with this frame's
+	if (mpResManager->getRenderSize() != mpResManager->getPrevRenderSize())
+	{
+		mAccumCount = 0;
+	}
+
     // Set shader parameters for our accumulation
 	auto shaderVars = mpAccumShader->getVars();
 	shaderVars["PerFrameCB"]["gAccumCount"] = mAccumCount++;
 	shaderVars["gLastFrame"] = mpLastFrame;
 	shaderVars["gCurFrame"]  = inputTexture;
 
-    // Do the accumulation
+    // Do the accumulation, over the pixels the G-buffer rendered
+    mpGfxState->setFbo(mpInternalFbo);
+    mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
     mpAccumShader->execute(pRenderContext, mpGfxState);
 
     // We've accumulated our result.  Copy that back to the input/output buffer
-    pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), inputTexture->getRTV());
+    pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), inputTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 
     // Keep a copy for next frame (we need this to avoid reading & writing to the same resource)
-    pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), mpLastFrame->getRTV());
+    pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), mpLastFrame->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
+}
+
+void SimpleAccumulationPass::executeReprojected(RenderContext* pRenderContext, Texture::SharedPtr pInputTex, Texture::SharedPtr pMotionTex, Texture::SharedPtr pLinearZTex)
+{
+	// Background pixels have no motion vectors, so the shader still needs to know if the view changed
+	bool cameraMoved = hasCameraMoved();
+	if (cameraMoved)
+	{
+		mpLastCameraMatrix = mpScene->getActiveCamera()->getViewMatrix();
+	}
+
+	auto shaderVars = mpReprojectShader->getVars();
+	shaderVars["PerFrameCB"]["gRenderDim"] = ivec2(mpResManager->getRenderSize());
+	shaderVars["PerFrameCB"]["gPrevRenderDim"] = ivec2(mpResManager->getPrevRenderSize());
+	shaderVars["PerFrameCB"]["gResetHistory"] = uint32_t(mAccumCount == 0 ? 1 : 0);
+	shaderVars["PerFrameCB"]["gCameraMoved"] = uint32_t(cameraMoved ? 1 : 0);
+	shaderVars["PerFrameCB"]["gMaxSamples"] = float(mMaxSamples);
+	shaderVars["PerFrameCB"]["gDepthTolerance"] = mDepthTolerance;
+	shaderVars["PerFrameCB"]["gNormalTolerance"] = mNormalTolerance;
+	shaderVars["gCurFrame"] = pInputTex;
+	shaderVars["gLastFrame"] = mpLastFrame;
+	shaderVars["gLastSampleCount"] = mpLastSampleCount;
+	shaderVars["gMotionAndFWidth"] = pMotionTex;
+	shaderVars["gLinearZAndNormal"] = pLinearZTex;
+	shaderVars["gPrevLinearZAndNormal"] = mpPrevLinearZAndNormal;
+	mAccumCount++;
+
+	// Accumulate over the pixels the G-buffer rendered
+	mpGfxState->setFbo(mpReprojectFbo);
+	mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
+	mpReprojectShader->execute(pRenderContext, mpGfxState);
+
+	// Copy the result back to our channel, and keep the color, sample counts and depth around to reproject next frame
+	uvec4 rect = mpResManager->getRenderRect();
+	pRenderContext->blit(mpReprojectFbo->getColorTexture(0)->getSRV(), pInputTex->getRTV(), rect, rect);
+	pRenderContext->blit(mpReprojectFbo->getColorTexture(0)->getSRV(), mpLastFrame->getRTV(), rect, rect);
+	pRenderContext->blit(mpReprojectFbo->getColorTexture(1)->getSRV(), mpLastSampleCount->getRTV(), rect, rect);
+	pRenderContext->blit(pLinearZTex->getSRV(), mpPrevLinearZAndNormal->getRTV(), rect, rect);
 }
 
 void SimpleAccumulationPass::stateRefreshed()
@@ -44,10 +44,20 @@ protected:
 	// Override some functions that provide information to the RenderPipeline class
 	bool appliesPostprocess() override { return true; }
 	bool hasAnimation() override { return false; }
+	ResourceManager::ResolutionGroup getResolutionGroup() override { return ResourceManager::ResolutionGroup::Denoise; }
 
 	// A helper utility to determine if the current scene (if any) has had any camera motion
 	bool hasCameraMoved();
 
+	// Declares our channels to the pipeline; the G-buffer's motion and depth are only inputs when mReprojectHistory is set
+	void declareChannels();
+
+	// (Re)creates the history reprojection needs, or releases it if mReprojectHistory is off
+	void allocateReprojectionResources(uint32_t width, uint32_t height);
+
+	// Accumulate into history reprojected with the G-buffer's motion vectors, instead of resetting on camera motion
+	void executeReprojected(RenderContext* pRenderContext, Texture::SharedPtr pInputTex, Texture::SharedPtr pMotionTex, Texture::SharedPtr pLinearZTex);
+
     // Information about the rendering texture we're accumulating into
 	std::string                   mAccumChannel;
 
@@ -57,6 +67,12 @@ protected:
 	Texture::SharedPtr            mpLastFrame;
 	Fbo::SharedPtr                mpInternalFbo;
 
+	// State for accumulating along the G-buffer's motion vectors, so camera motion only resets disoccluded pixels.  Only allocated when reprojecting.
+	FullscreenLaunch::SharedPtr   mpReprojectShader;
+	Fbo::SharedPtr                mpReprojectFbo;           ///< Accumulated color, plus per-pixel sample count
+	Texture::SharedPtr            mpLastSampleCount;
+	Texture::SharedPtr            mpPrevLinearZAndNormal;   ///< Last frame's G-buffer depth and normal, to validate the history
+
 	// We stash a copy of our current scene.  Why?  To detect if changes have occurred.
 	Scene::SharedPtr              mpScene;
 	mat4                          mpLastCameraMatrix;
@@ -64,6 +80,12 @@ protected:
 	// Is our accumulation enabled?
 	bool                          mDoAccumulation = true;
 
+	// Reprojection options
+	bool                          mReprojectHistory = false;   ///< Keep (reprojected) history when the camera moves?
+	int32_t                       mMaxSamples = 0;             ///< Per-pixel sample count cap when reprojecting (0 for unlimited)
+	float                         mDepthTolerance = 10.0f;     ///< History depth mismatch allowed, in multiples of the depth derivative
+	float                         mNormalTolerance = 16.0f;    ///< History normal mismatch allowed, in multiples of the normal derivative
+
 	// How many frames have we accumulated so far?
 	uint32_t                      mAccumCount = 0;
 };
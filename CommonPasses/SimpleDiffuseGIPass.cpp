@@ -82,6 +82,8 @@ void SimpleDiffuseGIPass::renderGui(Gui* pGui)
 	dirty |= (int)pGui->addCheckBox(mDoIndirectGI ? "Shooting global illumination rays" : "Skipping global illumination", 
 		                            mDoIndirectGI);
 	dirty |= (int)pGui->addCheckBox(mDoCosSampling ? "Use cosine sampling" : "Use uniform sampling", mDoCosSampling);
+	dirty |= (int)pGui->addCheckBox(mDoEnvSampling ? "Importance sampling environment map" : "Environment map only lights indirect rays", mDoEnvSampling);
+	dirty |= (int)pGui->addCheckBox(mUseBlueNoise ? "Using blue-noise samples" : "Using white-noise samples", mUseBlueNoise);
 	if (dirty) setRefreshFlag();
 }
 
@@ -101,17 +103,35 @@ void SimpleDiffuseGIPass::execute(RenderContext* pRenderContext)
 	rayGenVars["RayGenCB"]["gDoIndirectGI"] = mDoIndirectGI;
 	rayGenVars["RayGenCB"]["gCosSampling"]  = mDoCosSampling;
 	rayGenVars["RayGenCB"]["gDirectShadow"] = mDoDirectShadows;
+	rayGenVars["RayGenCB"]["gBlueNoise"]    = mUseBlueNoise;
+
+	// Without the environment map's alias tables, it can only be hit by indirect rays
+	EnvMapSampler::SharedPtr pEnvSampler = mpResManager->getEnvironmentMapSampler();
+	rayGenVars["RayGenCB"]["gEnvSampling"]  = mDoEnvSampling && pEnvSampler;
 
 	// Pass our G-buffer textures down to the HLSL so we can shade
 	rayGenVars["gPos"]         = mpResManager->getTexture("WorldPosition");
 	rayGenVars["gNorm"]        = mpResManager->getTexture("WorldNormal");
 	rayGenVars["gDiffuseMatl"] = mpResManager->getTexture("MaterialDiffuse");
 	rayGenVars["gOutput"]      = pDstTex;
+	rayGenVars["gBlueNoiseMasks"] = mpResManager->getBlueNoise()->getTexture();
 
 	// Set our environment map texture for indirect rays that miss geometry 
 	auto missVars = mpRays->getMissVars(1);       // Remember, indirect rays are ray type #1
 	missVars["gEnvMap"] = mpResManager->getTexture(ResourceManager::kEnvironmentMap);
 
+	// Direct lighting samples the environment map with its alias tables, and misses weight themselves against it
+	if (pEnvSampler)
+	{
+		Buffer::SharedPtr pEnvMarginal = pEnvSampler->getMarginalBuffer();
+		Buffer::SharedPtr pEnvConditional = pEnvSampler->getConditionalBuffer();
+		rayGenVars["gEnvMap"]         = mpResManager->getTexture(ResourceManager::kEnvironmentMap);
+		rayGenVars["gEnvMarginal"]    = pEnvMarginal;
+		rayGenVars["gEnvConditional"] = pEnvConditional;
+		missVars["gEnvMarginal"]      = pEnvMarginal;
+		missVars["gEnvConditional"]   = pEnvConditional;
+	}
+
 	// Execute our shading pass and shoot indirect rays
 	mpRays->execute( pRenderContext, uvec2(pDstTex->getWidth(), pDstTex->getHeight()) );
 }
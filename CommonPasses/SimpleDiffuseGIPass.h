@@ -57,6 +57,8 @@ protected:
 	bool                                    mDoIndirectGI = true;
 	bool                                    mDoCosSampling = true;
 	bool                                    mDoDirectShadows = true;
+	bool                                    mDoEnvSampling = true;
+	bool                                    mUseBlueNoise = true;   ///< Draw samples from the blue-noise masks (or from a white-noise LCG)?
     
 	// Various internal parameters
 	uint32_t                                mFrameCount = 0x1337u;  ///< A frame counter to vary random numbers over time
@@ -39,12 +39,18 @@ bool SimpleGBufferPass::initialize(RenderContext* pRenderContext, ResourceManage
   mpResManager->requestTextureResource("MotiveVectorsAndFWidth"); // float4: xy for motive vector and z for posFwidth, w for normalFwidth
 	mpResManager->requestTextureResource("Z-Buffer", ResourceFormat::D24UnormS8, ResourceManager::kDepthBufferFlags);
 
+	// Tell the pipeline what we write (and how), so it can order (or cull) later passes appropriately
+	declareOutputs({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough",
+	                 "MaterialEmissive", "linearZAndNormal", "MotiveVectorsAndFWidth" });
+	declareOutputs({ "Z-Buffer" }, Resource::State::DepthStencil);
+
   // Since we're rasterizing, we need to define our raster pipeline state (though we use the defaults)
   mpGfxState = GraphicsState::create();
 
 	// Create our wrapper for a scene-rasterization pass.
 	mpRaster = RasterLaunch::createFromFiles(kGbufVertShader, kGbufFragShader);
-	mpRaster->setScene(mpScene);                   
+	mpOcclusionCuller = HiZOcclusionCuller::create();
+	initScene(pRenderContext, mpScene);
 
   return true;
 }
@@ -55,9 +61,19 @@ void SimpleGBufferPass::initScene(RenderContext* pRenderContext, Scene::SharedPt
 	if (pScene) 
 		mpScene = pScene;
 
-	// Update our raster pass wrapper with this scene
-	if (mpRaster) 
+	// Update our raster pass wrapper with this scene.  When occlusion culling, it draws with the culler's scene renderer.
+	if (mpOcclusionCuller)
+		mpOcclusionCuller->setScene(mpScene);
+	if (mpScene && (!mpGpuDrivenRenderer || mpGpuDrivenRenderer->getScene() != mpScene))
+		mpGpuDrivenRenderer = GpuDrivenSceneRenderer::create(mpScene);
+	if (mpRaster)
+	{
 		mpRaster->setScene(mpScene);
+		if (mGpuDriven && mpScene)
+			mpRaster->setSceneRenderer(mpGpuDrivenRenderer);
+		else if (mOcclusionCulling && mpScene)
+			mpRaster->setSceneRenderer(mpOcclusionCuller->getSceneRenderer());
+	}
 }
 
 void SimpleGBufferPass::execute(RenderContext* pRenderContext)
@@ -72,13 +88,72 @@ void SimpleGBufferPass::execute(RenderContext* pRenderContext)
 		"Z-Buffer"
 	);
   if (!mpInternalFbo) return;
+
+	// The Z-buffer still holds last frame's depth.  Test the instances against it before we clear it.  That depth only
+	//     covers the whole screen if both frames rendered at full resolution, so skip culling under dynamic resolution.
+	uvec2 renderSize = mpResManager->getRenderSize();
+	bool fullResolution = renderSize == mpResManager->getScreenSize() && mpResManager->getPrevRenderSize() == renderSize;
+	bool occlusionCulling = mOcclusionCulling && fullResolution && !mGpuDriven && mpScene && mpScene->getActiveCamera();
+	if (occlusionCulling)
+		mpOcclusionCuller->cullFirstPhase(pRenderContext, mpInternalFbo->getDepthStencilTexture(), mpScene->getActiveCamera().get());
+
 	// Clear our g-buffer.  All color buffers to (0,0,0,0), depth to 1, stencil to 0
 	pRenderContext->clearFbo(mpInternalFbo.get(), vec4(0, 0, 0, 0), 1.0f, 0);
 
 	// Separately clear our diffuse color buffer to the background color, rather than black
 	pRenderContext->clearUAV(mpInternalFbo->getColorTexture(2)->getUAV().get(), vec4(mBgColor, 1.0f));
 	auto shaderVars = mpRaster->getVars();
-	shaderVars["PerImageCB"]["gRenderTargetDim"] = float2(mpInternalFbo->getWidth(), mpInternalFbo->getHeight());
+	shaderVars["PerImageCB"]["gRenderTargetDim"] = float2(renderSize);
+
+	// Rasterize into the top-left corner of our buffers, at the current render size.  (Setting the FBO resets the viewport.)
+	mpGfxState->setFbo(mpInternalFbo);
+	mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
+
 	// Execute our rasterization pass.  Note: Falcor will populate many built-in shader variables
-	mpRaster->execute(pRenderContext, mpGfxState, mpInternalFbo);
+	mpRaster->execute(pRenderContext, mpGfxState, nullptr);
+
+	// Draw whatever phase 1 culled that's visible after all, on top of what we just drew
+	if (occlusionCulling)
+	{
+		mpOcclusionCuller->cullSecondPhase(pRenderContext, mpInternalFbo->getDepthStencilTexture());
+		mpRaster->execute(pRenderContext, mpGfxState, nullptr);
+		mpOcclusionCuller->endFrame(pRenderContext);
+	}
+}
+
+void SimpleGBufferPass::renderGui(Gui* pGui)
+{
+	// Culling never changes the image, so there's no need to tell the pipeline when this toggles.  Re-initializing
+	//     swaps the scene renderer and makes the culler forget the depth it didn't see drawn.
+	if (pGui->addCheckBox("Hi-Z occlusion culling", mOcclusionCulling))
+	{
+		mGpuDriven = mGpuDriven && !mOcclusionCulling;
+		initScene(nullptr, mpScene);
+	}
+
+	// Compare this pass' CPU recording time in the pipeline's profiling window with this on and off
+	if (pGui->addCheckBox("GPU-driven draws", mGpuDriven))
+	{
+		mOcclusionCulling = mOcclusionCulling && !mGpuDriven;
+		initScene(nullptr, mpScene);
+	}
+
+	char buf[256];
+	if (mGpuDriven && mpGpuDrivenRenderer)
+	{
+		const GpuDrivenSceneRenderer::Stats& stats = mpGpuDrivenRenderer->getStats();
+		sprintf_s(buf, "Indirect draws: %u for %u instances", stats.drawCommands, stats.instances);
+		pGui->addText(buf);
+		sprintf_s(buf, "Instance records uploaded: %u", stats.uploadedInstances);
+		pGui->addText(buf);
+	}
+	if (!mOcclusionCulling) return;
+
+	const HiZOcclusionCuller::Stats& stats = mpOcclusionCuller->getStats();
+	sprintf_s(buf, "Instances: %u, outside frustum: %u", stats.instances, stats.frustumCulled);
+	pGui->addText(buf);
+	sprintf_s(buf, "Occlusion culled: %u of %u tested", stats.occlusionCulled, stats.tested);
+	pGui->addText(buf);
+	sprintf_s(buf, "Culled by last frame's depth: %u (%u drawn in phase 2)", stats.culledFirstPhase, stats.drawnSecondPhase);
+	pGui->addText(buf);
 }
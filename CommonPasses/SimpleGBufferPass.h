@@ -19,6 +19,7 @@
 #pragma once
 #include "../SharedUtils/RenderPass.h"
 #include "../SharedUtils/RasterLaunch.h"
+#include "../SharedUtils/HiZOcclusionCuller.h"
 
 class SimpleGBufferPass : public ::RenderPass, inherit_shared_from_this<::RenderPass, SimpleGBufferPass>
 {
@@ -36,6 +37,7 @@ protected:
   bool initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager) override;
   void execute(RenderContext* pRenderContext) override;
 	void initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene) override;
+	void renderGui(Gui* pGui) override;
 
 	// Override some functions that provide information to the RenderPipeline class
 	bool requiresScene() override     { return true; }
@@ -47,6 +49,14 @@ protected:
 	RasterLaunch::SharedPtr     mpRaster;               ///< A wrapper managing the shader for our g-buffer creation
   Fbo::SharedPtr              mpInternalFbo;
 
+	// Two-phase Hi-Z occlusion culling against last frame's depth
+	HiZOcclusionCuller::SharedPtr mpOcclusionCuller;
+	bool                        mOcclusionCulling = true;
+
+	// GPU culling and LOD selection feeding one indirect draw per mesh LOD.  Exclusive with Hi-Z culling.
+	GpuDrivenSceneRenderer::SharedPtr mpGpuDrivenRenderer;
+	bool                        mGpuDriven = false;
+
 	// What's our "background" color?
 	vec3                        mBgColor = vec3(0.48, 0.75, 0.85);  ///<  Color stored into our diffuse G-buffer channel if we hit no geometry
 };
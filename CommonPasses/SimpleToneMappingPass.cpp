@@ -32,6 +32,10 @@ bool SimpleToneMappingPass::initialize(RenderContext* pRenderContext, ResourceMa
 	mpResManager->requestTextureResource(mInChannel);
 	mpResManager->requestTextureResource(mOutChannel);
 
+	// Tell the pipeline which channels we read and write, so it can order (or cull) us appropriately
+	declareInputs({ mInChannel });
+	declareOutputs({ mOutChannel });
+
 	// The Falcor tonemapper can screw with DX pipeline state, so we'll want to create a disposible state object.
 	mpGfxState = GraphicsState::create();
 
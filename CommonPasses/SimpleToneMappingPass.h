@@ -39,6 +39,7 @@ protected:
 
 	// Override some functions that provide information to the RenderPipeline class
 	bool appliesPostprocess() override { return true; }
+	bool canRecordInParallel() override { return true; }
 
       
 	GraphicsState::SharedPtr    mpGfxState;
@@ -50,11 +50,14 @@ namespace Falcor
     {
         if (mDynamicData.pResourceHandle)
         {
-            gpDevice->getResourceAllocator()->release(mDynamicData);
+            mpDynamicAllocator->release(mDynamicData);
         }
         else
         {
             gpDevice->releaseResource(mApiHandle);
+#ifdef FALCOR_D3D12
+            if (mHeapAllocation.isValid() && gpDevice && gpDevice->getHeapAllocator()) gpDevice->getHeapAllocator()->release(mHeapAllocation);
+#endif
         }
     }
 
@@ -84,9 +87,10 @@ namespace Falcor
             // Allocate a new buffer
             if (mDynamicData.pResourceHandle)
             {
-                gpDevice->getResourceAllocator()->release(mDynamicData);
+                mpDynamicAllocator->release(mDynamicData);
             }
-            mDynamicData = gpDevice->getResourceAllocator()->allocate(mSize, getBufferDataAlignment(this));
+            mpDynamicAllocator = gpDevice->getResourceAllocator();
+            mDynamicData = mpDynamicAllocator->allocate(mSize, getBufferDataAlignment(this));
             mApiHandle = mDynamicData.pResourceHandle;
             invalidateViews();
             return mDynamicData.pData;
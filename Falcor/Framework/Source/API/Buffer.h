@@ -146,6 +146,7 @@ namespace Falcor
         size_t mSize = 0;
         CpuAccess mCpuAccess;
         ResourceAllocator::AllocationData mDynamicData;
+        ResourceAllocator::SharedPtr mpDynamicAllocator;    // Where mDynamicData came from. Recording threads can have their own allocators (see Device::setThreadAllocators())
         Buffer::SharedPtr mpStagingResource; // For buffers that have both CPU read flag and can be used by the GPU
     };
 }
\ No newline at end of file
@@ -74,8 +74,18 @@ namespace Falcor
         return pTask->getData();
     }
 
+    Resource::State CopyContext::getQueueState(const Resource* pResource, Resource::State newState) const
+    {
+        // Compute queues can't transition into or out of pixel-shader states. ShaderResource already covers reads from compute
+        // shaders, so a resource in that state is left as is; anything else becomes NonPixelShader instead.
+        if (newState != Resource::State::ShaderResource || mpLowLevelData->getType() != LowLevelContextData::CommandQueueType::Compute) return newState;
+        bool readable = pResource->isStateGlobal() && pResource->getGlobalState() == Resource::State::ShaderResource;
+        return readable ? Resource::State::ShaderResource : Resource::State::NonPixelShader;
+    }
+
     void CopyContext::resourceBarrier(const Resource* pResource, Resource::State newState, const ResourceViewInfo* pViewInfo)
     {
+        newState = getQueueState(pResource, newState);
         const Texture* pTexture = dynamic_cast<const Texture*>(pResource);
         if (pTexture)
         {
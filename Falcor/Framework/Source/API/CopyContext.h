@@ -81,6 +81,19 @@ namespace Falcor
         */
         virtual void resourceBarrier(const Resource* pResource, Resource::State newState, const ResourceViewInfo* pViewInfo = nullptr);
 
+        /** A whole-resource state change, for resourceBarriers()
+        */
+        struct Transition
+        {
+            const Resource* pResource;
+            Resource::State newState;
+        };
+
+        /** Insert a batch of resource barriers with a single API call.
+            Resources which are already in the requested state are skipped. Textures whose subresources are in different states are transitioned one by one, like resourceBarrier() does
+        */
+        void resourceBarriers(const std::vector<Transition>& transitions);
+
         /** Insert a UAV barrier
         */
         virtual void uavBarrier(const Resource* pResource);
@@ -137,6 +150,10 @@ namespace Falcor
         void bindDescriptorHeaps();
 
     protected:
+        /** The state a barrier to newState should actually use on this context's queue
+        */
+        Resource::State getQueueState(const Resource* pResource, Resource::State newState) const;
+
         void textureBarrier(const Texture* pTexture, Resource::State newState);
         void bufferBarrier(const Buffer* pBuffer, Resource::State newState);
         void subresourceBarriers(const Texture* pTexture, Resource::State newState, const ResourceViewInfo* pViewInfo);
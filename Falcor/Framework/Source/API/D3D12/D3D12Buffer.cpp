@@ -34,11 +34,8 @@
 namespace Falcor
 {
 
-    ID3D12ResourcePtr createBuffer(Buffer::State initState, size_t size, const D3D12_HEAP_PROPERTIES& heapProps, Buffer::BindFlags bindFlags)
+    static D3D12_RESOURCE_DESC getBufferDesc(size_t size, Buffer::BindFlags bindFlags)
     {
-        ID3D12Device* pDevice = gpDevice->getApiHandle();
-
-        // Create the buffer
         D3D12_RESOURCE_DESC bufDesc = {};
         bufDesc.Alignment = 0;
         bufDesc.DepthOrArraySize = 1;
@@ -51,7 +48,15 @@ namespace Falcor
         bufDesc.SampleDesc.Count = 1;
         bufDesc.SampleDesc.Quality = 0;
         bufDesc.Width = size;
+        return bufDesc;
+    }
+
+    ID3D12ResourcePtr createBuffer(Buffer::State initState, size_t size, const D3D12_HEAP_PROPERTIES& heapProps, Buffer::BindFlags bindFlags)
+    {
+        ID3D12Device* pDevice = gpDevice->getApiHandle();
 
+        // Create the buffer
+        D3D12_RESOURCE_DESC bufDesc = getBufferDesc(size, bindFlags);
         D3D12_RESOURCE_STATES d3dState = getD3D12ResourceState(initState);
         ID3D12ResourcePtr pApiHandle;
         d3d_call(pDevice->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufDesc, d3dState, nullptr, IID_PPV_ARGS(&pApiHandle)));
@@ -60,6 +65,26 @@ namespace Falcor
         return pApiHandle;
     }
 
+    /** Create a GPU-only buffer, placed in one of the device's shared heaps if possible (committed otherwise)
+    */
+    static ID3D12ResourcePtr createDefaultHeapBuffer(Buffer::State initState, size_t size, Buffer::BindFlags bindFlags, D3D12HeapAllocator::Allocation& heapAllocation)
+    {
+        const D3D12HeapAllocator::SharedPtr& pHeapAllocator = gpDevice->getHeapAllocator();
+        if (pHeapAllocator)
+        {
+            ID3D12Device* pDevice = gpDevice->getApiHandle();
+            D3D12_RESOURCE_DESC bufDesc = getBufferDesc(size, bindFlags);
+            heapAllocation = pHeapAllocator->allocate(D3D12HeapAllocator::Usage::Buffer, pDevice->GetResourceAllocationInfo(0, 1, &bufDesc));
+            if (heapAllocation.isValid())
+            {
+                ID3D12ResourcePtr pApiHandle;
+                d3d_call(pDevice->CreatePlacedResource(heapAllocation.pHeap, heapAllocation.offset, &bufDesc, getD3D12ResourceState(initState), nullptr, IID_PPV_ARGS(&pApiHandle)));
+                return pApiHandle;
+            }
+        }
+        return createBuffer(initState, size, kDefaultHeapProps, bindFlags);
+    }
+
     size_t getBufferDataAlignment(const Buffer* pBuffer)
     {
         // This in order of the alignment size
@@ -90,7 +115,8 @@ namespace Falcor
             mState.global = Resource::State::GenericRead;
             if(hasInitData == false) // Else the allocation will happen when updating the data
             {
-                mDynamicData = gpDevice->getResourceAllocator()->allocate(mSize, getBufferDataAlignment(this));
+                mpDynamicAllocator = gpDevice->getResourceAllocator();
+                mDynamicData = mpDynamicAllocator->allocate(mSize, getBufferDataAlignment(this));
                 mApiHandle = mDynamicData.pResourceHandle;
             }
         }
@@ -98,12 +124,14 @@ namespace Falcor
         {
             mState.global = Resource::State::CopyDest;
             mApiHandle = createBuffer(mState.global, mSize, kReadbackHeapProps, mBindFlags);
+            trackGpuMemory(mSize);
         }
         else
         {
             mState.global = Resource::State::Common;
             if (is_set(mBindFlags, BindFlags::AccelerationStructure)) mState.global = Resource::State::AccelerationStructure;
-            mApiHandle = createBuffer(mState.global, mSize, kDefaultHeapProps, mBindFlags);
+            mApiHandle = createDefaultHeapBuffer(mState.global, mSize, mBindFlags, mHeapAllocation);
+            trackGpuMemory(mSize);
         }
 
         return true;
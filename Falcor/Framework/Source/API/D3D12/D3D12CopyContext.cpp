@@ -180,7 +180,8 @@ namespace Falcor
 
         //Get buffer data
         std::vector<uint8> result;
-        uint32_t actualRowSize = footprint.Footprint.Width * getFormatBytesPerBlock(mTextureFormat);
+        // Rows of block-compressed formats are rows of blocks
+        uint32_t actualRowSize = (footprint.Footprint.Width / getFormatWidthCompressionRatio(mTextureFormat)) * getFormatBytesPerBlock(mTextureFormat);
         result.resize(mRowCount * actualRowSize);
         uint8* pData = reinterpret_cast<uint8*>(mpBuffer->map(Buffer::MapType::Read));
 
@@ -200,7 +201,7 @@ namespace Falcor
         return result;
     }
 
-    static void d3d12ResourceBarrier(const Resource* pResource, Resource::State newState, Resource::State oldState, uint32_t subresourceIndex, ID3D12GraphicsCommandList* pCmdList)
+    static D3D12_RESOURCE_BARRIER createD3D12TransitionBarrier(const Resource* pResource, Resource::State newState, uint32_t subresourceIndex)
     {
         D3D12_RESOURCE_BARRIER barrier;
         barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -225,7 +226,12 @@ namespace Falcor
         {
             assert(is_set(pResource->getBindFlags(), Resource::BindFlags::UnorderedAccess));
         }
+        return barrier;
+    }
 
+    static void d3d12ResourceBarrier(const Resource* pResource, Resource::State newState, Resource::State oldState, uint32_t subresourceIndex, ID3D12GraphicsCommandList* pCmdList)
+    {
+        D3D12_RESOURCE_BARRIER barrier = createD3D12TransitionBarrier(pResource, newState, subresourceIndex);
         pCmdList->ResourceBarrier(1, &barrier);
     }
 
@@ -254,6 +260,34 @@ namespace Falcor
         mCommandsPending = mCommandsPending || recorded;
     }
 
+    void CopyContext::resourceBarriers(const std::vector<Transition>& transitions)
+    {
+        std::vector<D3D12_RESOURCE_BARRIER> barriers;
+        barriers.reserve(transitions.size());
+        for (const Transition& t : transitions)
+        {
+            const Texture* pTexture = dynamic_cast<const Texture*>(t.pResource);
+            const Buffer* pBuffer = dynamic_cast<const Buffer*>(t.pResource);
+            if (pTexture && pTexture->isStateGlobal() == false)
+            {
+                resourceBarrier(pTexture, t.newState);
+                continue;
+            }
+            if (pBuffer && pBuffer->getCpuAccess() != Buffer::CpuAccess::None) continue;
+            Resource::State newState = getQueueState(t.pResource, t.newState);
+            if (t.pResource->getGlobalState() == newState) continue;
+
+            barriers.push_back(createD3D12TransitionBarrier(t.pResource, newState, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES));
+            t.pResource->setGlobalState(newState);
+        }
+
+        if (barriers.size())
+        {
+            mpLowLevelData->getCommandList()->ResourceBarrier((uint32_t)barriers.size(), barriers.data());
+            mCommandsPending = true;
+        }
+    }
+
     void CopyContext::apiSubresourceBarrier(const Texture* pTexture, Resource::State newState, Resource::State oldState, uint32_t arraySlice, uint32_t mipLevel)
     {
         uint32_t subresourceIndex = pTexture->getSubresourceIndex(arraySlice, mipLevel);
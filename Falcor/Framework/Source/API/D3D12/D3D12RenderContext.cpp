@@ -34,9 +34,13 @@
 #include "API/DescriptorSet.h"
 #include "Raytracing/RtProgramVars.h"
 #include "Raytracing/RtState.h"
+#include <mutex>
 
 namespace Falcor
 {
+    // The blit data is shared by all the render contexts, which can be recording on different threads
+    static std::mutex gBlitMutex;
+
     static void initBlitData()
     {
         if (gBlitData.pVars == nullptr)
@@ -72,20 +76,28 @@ namespace Falcor
         gpDrawIndexCommandSig = nullptr;
     }
 
+    // The blit data and command signatures are shared by all the render contexts, so only the last one releases them
+    static uint32_t gRenderContextCount = 0;
+
     RenderContext::~RenderContext()
     {
-        releaseApiData();
+        if (--gRenderContextCount == 0) releaseApiData();
     }
 
 
-    RenderContext::SharedPtr RenderContext::create(CommandQueueHandle queue)
+    RenderContext::SharedPtr RenderContext::create(CommandQueueHandle queue, LowLevelContextData::CommandQueueType type)
     {
+        assert(type == LowLevelContextData::CommandQueueType::Direct || type == LowLevelContextData::CommandQueueType::Compute);
         SharedPtr pCtx = SharedPtr(new RenderContext());
-        pCtx->mpLowLevelData = LowLevelContextData::create(LowLevelContextData::CommandQueueType::Direct, queue);
+        gRenderContextCount++;
+        pCtx->mpLowLevelData = LowLevelContextData::create(type, queue);
         if (pCtx->mpLowLevelData == nullptr)
         {
             return nullptr;
         }
+
+        // The device's own context binds the heaps once it created them (see Device::init())
+        if (gpDevice && gpDevice->getGpuDescriptorPool()) pCtx->bindDescriptorHeaps();
         return pCtx;
     }
     
@@ -406,6 +418,7 @@ namespace Falcor
 
     void RenderContext::blit(ShaderResourceView::SharedPtr pSrc, RenderTargetView::SharedPtr pDst, const uvec4& srcRect, const uvec4& dstRect, Sampler::Filter filter)
     {
+        std::lock_guard<std::mutex> lock(gBlitMutex);
         initBlitData(); // This has to be here and can't be in the constructor. FullScreenPass will allocate some buffers which depends on the ResourceAllocator which depends on the fence inside the RenderContext. Dependencies are fun!
         if (filter == Sampler::Filter::Linear)
         {
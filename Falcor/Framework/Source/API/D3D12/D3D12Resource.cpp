@@ -117,7 +117,7 @@ namespace Falcor
         case Resource::State::ResolveSource:
             return D3D12_RESOURCE_STATE_RESOLVE_SOURCE;
         case Resource::State::ShaderResource:
-            return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE; // Need the shader usage mask in case the SRV is used by non-PS
+            return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE; // Readable by every stage, and by a compute queue without another transition
         case Resource::State::StreamOut:
             return D3D12_RESOURCE_STATE_STREAM_OUT;
         case Resource::State::UnorderedAccess:
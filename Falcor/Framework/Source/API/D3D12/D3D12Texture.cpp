@@ -144,7 +144,50 @@ namespace Falcor
             pClearVal = nullptr;
         }
 
-        d3d_call(gpDevice->getApiHandle()->CreateCommittedResource(&kDefaultHeapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON, pClearVal, IID_PPV_ARGS(&mApiHandle)));
+        // Try to place the texture in one of the device's shared heaps; fall back to a committed resource
+        ID3D12Device* pDevice = gpDevice->getApiHandle();
+        const D3D12HeapAllocator::SharedPtr& pHeapAllocator = gpDevice->getHeapAllocator();
+        bool isRenderTargetOrDepth = (mBindFlags & (Texture::BindFlags::RenderTarget | Texture::BindFlags::DepthStencil)) != Texture::BindFlags::None;
+        D3D12_RESOURCE_ALLOCATION_INFO info = {};
+        if (pHeapAllocator)
+        {
+            // Small textures may use 4KB alignment instead of 64KB, if the driver agrees
+            if (!isRenderTargetOrDepth && mSampleCount == 1)
+            {
+                desc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+                info = pDevice->GetResourceAllocationInfo(0, 1, &desc);
+            }
+            if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+            {
+                desc.Alignment = 0;
+                info = pDevice->GetResourceAllocationInfo(0, 1, &desc);
+            }
+            mHeapAllocation = pHeapAllocator->allocate(isRenderTargetOrDepth ? D3D12HeapAllocator::Usage::RenderTargetOrDepth : D3D12HeapAllocator::Usage::Texture, info);
+        }
+
+        if (mHeapAllocation.isValid())
+        {
+            if (isRenderTargetOrDepth)
+            {
+                // Placed render-targets and depth buffers must be initialized before use. Discarding is the cheapest way.
+                bool isDepth = is_set(mBindFlags, Texture::BindFlags::DepthStencil);
+                D3D12_RESOURCE_STATES initState = isDepth ? D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_RENDER_TARGET;
+                d3d_call(pDevice->CreatePlacedResource(mHeapAllocation.pHeap, mHeapAllocation.offset, &desc, initState, pClearVal, IID_PPV_ARGS(&mApiHandle)));
+                gpDevice->getRenderContext()->getLowLevelData()->getCommandList()->DiscardResource(mApiHandle, nullptr);
+                setGlobalState(isDepth ? Resource::State::DepthStencil : Resource::State::RenderTarget);
+            }
+            else
+            {
+                d3d_call(pDevice->CreatePlacedResource(mHeapAllocation.pHeap, mHeapAllocation.offset, &desc, D3D12_RESOURCE_STATE_COMMON, pClearVal, IID_PPV_ARGS(&mApiHandle)));
+            }
+        }
+        else
+        {
+            desc.Alignment = 0;
+            info = pDevice->GetResourceAllocationInfo(0, 1, &desc);
+            d3d_call(pDevice->CreateCommittedResource(&kDefaultHeapProps, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON, pClearVal, IID_PPV_ARGS(&mApiHandle)));
+        }
+        trackGpuMemory(info.SizeInBytes);
 
         if (pData)
         {
@@ -155,5 +198,6 @@ namespace Falcor
     Texture::~Texture()
     {
         gpDevice->releaseResource(mApiHandle);
+        if (mHeapAllocation.isValid() && gpDevice && gpDevice->getHeapAllocator()) gpDevice->getHeapAllocator()->release(mHeapAllocation);
     }
 }
@@ -129,6 +129,7 @@ namespace Falcor
     MAKE_SMART_COM_PTR(ID3D12CommandAllocator);
     MAKE_SMART_COM_PTR(ID3D12DescriptorHeap);
     MAKE_SMART_COM_PTR(ID3D12Resource);
+    MAKE_SMART_COM_PTR(ID3D12Heap);
     MAKE_SMART_COM_PTR(ID3D12Fence);
     MAKE_SMART_COM_PTR(ID3D12PipelineState);
     MAKE_SMART_COM_PTR(ID3D12RootSignature);
@@ -152,6 +153,7 @@ namespace Falcor
     using CommandSignatureHandle = ID3D12CommandSignaturePtr;
     using FenceHandle = ID3D12FencePtr;
     using ResourceHandle = ID3D12ResourcePtr;
+    using MemoryHeapHandle = ID3D12HeapPtr;
     using RtvHandle = std::shared_ptr<DescriptorSet>;
     using DsvHandle = std::shared_ptr<DescriptorSet>;
     using SrvHandle = std::shared_ptr<DescriptorSet>;
@@ -0,0 +1,151 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/D3D12/LowLevel/D3D12HeapAllocator.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    D3D12HeapAllocator::SharedPtr D3D12HeapAllocator::create(GpuFence::SharedPtr pFence, uint64_t heapSize)
+    {
+        return SharedPtr(new D3D12HeapAllocator(pFence, heapSize));
+    }
+
+    D3D12HeapAllocator::D3D12HeapAllocator(GpuFence::SharedPtr pFence, uint64_t heapSize) : mpFence(pFence), mHeapSize(heapSize)
+    {
+        D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+        HRESULT hr = gpDevice->getApiHandle()->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+        mMixedResourceHeaps = SUCCEEDED(hr) && options.ResourceHeapTier >= D3D12_RESOURCE_HEAP_TIER_2;
+    }
+
+    bool D3D12HeapAllocator::createHeap(Usage usage)
+    {
+        D3D12_HEAP_DESC desc = {};
+        desc.SizeInBytes = mHeapSize;
+        desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+        desc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        desc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        switch (usage)
+        {
+        case Usage::Buffer:
+            desc.Flags = mMixedResourceHeaps ? D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES : D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+            break;
+        case Usage::Texture:
+            desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+            break;
+        case Usage::RenderTargetOrDepth:
+            desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+            break;
+        default:
+            should_not_get_here();
+        }
+
+        Heap heap;
+        if (FAILED(gpDevice->getApiHandle()->CreateHeap(&desc, IID_PPV_ARGS(&heap.pApiHandle))))
+        {
+            logWarning("D3D12HeapAllocator: failed to create a " + std::to_string(mHeapSize) + " byte heap, falling back to committed resources");
+            return false;
+        }
+        heap.usage = usage;
+        heap.pAllocator = std::make_unique<TlsfAllocator>(mHeapSize, D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT);
+        mHeaps.push_back(std::move(heap));
+        return true;
+    }
+
+    D3D12HeapAllocator::Allocation D3D12HeapAllocator::allocate(Usage usage, const D3D12_RESOURCE_ALLOCATION_INFO& info)
+    {
+        Allocation allocation;
+
+        // Big resources would waste most of a heap (and fragment it when they go away), so they stay committed.
+        // So do resources needing more than the heap's alignment (i.e., MSAA textures).
+        if (info.SizeInBytes == 0 || info.SizeInBytes > mHeapSize / 2 || info.Alignment > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) return allocation;
+
+        usage = getHeapUsage(usage);
+        for (uint32_t pass = 0; pass < 2; pass++)
+        {
+            for (uint32_t i = 0; i < mHeaps.size(); i++)
+            {
+                if (mHeaps[i].usage != usage) continue;
+                TlsfAllocator::Allocation block = mHeaps[i].pAllocator->allocate(info.SizeInBytes, info.Alignment);
+                if (block.isValid())
+                {
+                    allocation.pHeap = mHeaps[i].pApiHandle;
+                    allocation.offset = block.offset;
+                    allocation.heapIndex = i;
+                    allocation.block = block;
+                    return allocation;
+                }
+            }
+
+            // Nothing fits. Add a heap and try again.
+            if (pass == 0 && createHeap(usage) == false) break;
+        }
+        return allocation;
+    }
+
+    void D3D12HeapAllocator::release(const Allocation& allocation)
+    {
+        if (!allocation.isValid()) return;
+        mDeferredReleases.push({ mpFence->getCpuValue(), allocation });
+        mPendingReleaseBytes += allocation.block.size;
+        mPendingReleaseCount++;
+    }
+
+    void D3D12HeapAllocator::executeDeferredReleases()
+    {
+        uint64_t gpuVal = mpFence->getGpuValue();
+        while (mDeferredReleases.size() && mDeferredReleases.front().fenceValue <= gpuVal)
+        {
+            const Allocation& allocation = mDeferredReleases.front().allocation;
+            mHeaps[allocation.heapIndex].pAllocator->release(allocation.block);
+            mPendingReleaseBytes -= allocation.block.size;
+            mPendingReleaseCount--;
+            mDeferredReleases.pop();
+        }
+    }
+
+    D3D12HeapAllocator::Stats D3D12HeapAllocator::getStats() const
+    {
+        Stats stats;
+        stats.heapCount = (uint32_t)mHeaps.size();
+        stats.pendingReleaseBytes = mPendingReleaseBytes;
+        for (const auto& heap : mHeaps)
+        {
+            TlsfAllocator::Stats heapStats = heap.pAllocator->getStats();
+            stats.reservedBytes += heapStats.capacity;
+            stats.usedBytes += heapStats.usedBytes;
+            stats.allocationCount += heapStats.allocationCount;
+            stats.fragmentation = std::max(stats.fragmentation, heapStats.fragmentation());
+        }
+        // Ranges waiting on the GPU are still allocated as far as the heaps know
+        stats.usedBytes -= mPendingReleaseBytes;
+        stats.allocationCount -= mPendingReleaseCount;
+        return stats;
+    }
+}
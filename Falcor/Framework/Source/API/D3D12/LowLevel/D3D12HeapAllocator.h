@@ -0,0 +1,126 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <queue>
+#include "API/LowLevel/GpuFence.h"
+#include "Utils/TlsfAllocator.h"
+
+namespace Falcor
+{
+    /** Suballocates placed resources out of large memory heaps, instead of giving every texture and buffer its own
+        committed allocation.
+        Each heap is carved up with a TlsfAllocator. Released ranges are only recycled once the frame fence shows the
+        GPU is done with them, matching Device::releaseResource() for the resource objects themselves.
+        On resource heap tier 1 hardware, buffers, render-target/depth textures and other textures can't share a heap,
+        so each gets its own set of heaps. On tier 2 everything shares.
+    */
+    class D3D12HeapAllocator : public std::enable_shared_from_this<D3D12HeapAllocator>
+    {
+    public:
+        using SharedPtr = std::shared_ptr<D3D12HeapAllocator>;
+        using SharedConstPtr = std::shared_ptr<const D3D12HeapAllocator>;
+
+        /** Which kind of resource is being placed. Determines which heaps it may live in.
+        */
+        enum class Usage
+        {
+            Buffer,
+            Texture,
+            RenderTargetOrDepth,
+            Count
+        };
+
+        struct Allocation
+        {
+            MemoryHeapHandle pHeap;             ///< Heap to create the placed resource in
+            uint64_t offset = 0;                ///< Offset into pHeap
+            uint32_t heapIndex = uint32_t(-1);
+            TlsfAllocator::Allocation block;
+            bool isValid() const { return block.isValid(); }
+        };
+
+        struct Stats
+        {
+            uint32_t heapCount = 0;
+            uint64_t reservedBytes = 0;         ///< Total size of all heaps
+            uint64_t usedBytes = 0;             ///< Bytes handed out to live resources
+            uint64_t pendingReleaseBytes = 0;   ///< Bytes released but still waiting on the GPU
+            uint32_t allocationCount = 0;           ///< Live resources (not counting pending releases)
+            float fragmentation = 0;            ///< Worst fragmentation (see TlsfAllocator::Stats) of any heap
+        };
+
+        /** Create the allocator.
+            \param[in] pFence Fence released ranges wait on (the device's frame fence)
+            \param[in] heapSize Size of each heap. Resources larger than half of this are not suballocated.
+        */
+        static SharedPtr create(GpuFence::SharedPtr pFence, uint64_t heapSize);
+
+        /** Find room for a resource, creating a new heap if needed.
+            Returns an invalid allocation if the resource should be committed instead (too large, or heap creation failed).
+        */
+        Allocation allocate(Usage usage, const D3D12_RESOURCE_ALLOCATION_INFO& info);
+
+        /** Queue a range for release once the GPU is done with the current frame
+        */
+        void release(const Allocation& allocation);
+
+        /** Recycle all released ranges the GPU is done with. Called by the device every frame.
+        */
+        void executeDeferredReleases();
+
+        Stats getStats() const;
+        uint64_t getHeapSize() const { return mHeapSize; }
+
+    private:
+        D3D12HeapAllocator(GpuFence::SharedPtr pFence, uint64_t heapSize);
+
+        struct Heap
+        {
+            MemoryHeapHandle pApiHandle;
+            Usage usage;
+            std::unique_ptr<TlsfAllocator> pAllocator;
+        };
+
+        struct PendingRelease
+        {
+            uint64_t fenceValue;
+            Allocation allocation;
+        };
+
+        Usage getHeapUsage(Usage usage) const { return mMixedResourceHeaps ? Usage::Buffer : usage; }
+        bool createHeap(Usage usage);
+
+        GpuFence::SharedPtr mpFence;
+        uint64_t mHeapSize;
+        bool mMixedResourceHeaps = false;       ///< Can buffers and all kinds of textures share a heap (resource heap tier 2)?
+        std::vector<Heap> mHeaps;
+        std::queue<PendingRelease> mDeferredReleases;
+        uint64_t mPendingReleaseBytes = 0;
+        uint32_t mPendingReleaseCount = 0;
+    };
+}
@@ -57,6 +57,7 @@ namespace Falcor
         SharedPtr pThis = SharedPtr(new LowLevelContextData);
         pThis->mpFence = GpuFence::create();
         pThis->mpQueue = queue;
+        pThis->mType = type;
         pThis->mpApiData = new LowLevelContextApiData;
 
         // Create a command allocator
@@ -94,6 +94,7 @@ namespace Falcor
         CpuHandle getCpuHandle(uint32_t rangeIndex, uint32_t descInRange = 0) const;
         GpuHandle getGpuHandle(uint32_t rangeIndex, uint32_t descInRange = 0) const;
         const ApiHandle& getApiHandle() const { return mApiHandle; }
+        const DescriptorPool* getPool() const { return mpPool.get(); }
 
         void setSrv(uint32_t rangeIndex, uint32_t descIndex, const ShaderResourceView* pSrv);
         void setUav(uint32_t rangeIndex, uint32_t descIndex, const UnorderedAccessView* pUav);
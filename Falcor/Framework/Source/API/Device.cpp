@@ -43,6 +43,21 @@ namespace Falcor
         return gpDevice;
     }
 
+    // The descriptor pools' sizes.  <scale> lets the recording threads' pools be smaller than the device's.
+    static DescriptorPool::Desc getPoolDesc(bool shaderVisible, uint32_t scale)
+    {
+        DescriptorPool::Desc poolDesc;
+        // For DX12 there is no difference between the different SRV/UAV types. For Vulkan it matters, hence the #ifdef
+        // DX12 guarantees at least 1,000,000 descriptors
+        poolDesc.setDescCount(DescriptorPool::Type::TextureSrv, 1000000 / scale).setDescCount(DescriptorPool::Type::Sampler, 2048).setShaderVisible(shaderVisible);
+#ifndef FALCOR_D3D12
+        poolDesc.setDescCount(DescriptorPool::Type::Cbv, 16 * 1024 / scale).setDescCount(DescriptorPool::Type::TextureUav, 16 * 1024 / scale);
+        poolDesc.setDescCount(DescriptorPool::Type::StructuredBufferSrv, 2 * 1024 / scale).setDescCount(DescriptorPool::Type::StructuredBufferUav, 2 * 1024 / scale).setDescCount(DescriptorPool::Type::TypedBufferSrv, 2 * 1024 / scale).setDescCount(DescriptorPool::Type::TypedBufferUav, 2 * 1024 / scale);
+#endif
+        if (shaderVisible == false) poolDesc.setDescCount(DescriptorPool::Type::Rtv, 16 * 1024 / scale).setDescCount(DescriptorPool::Type::Dsv, 1024 / scale);
+        return poolDesc;
+    }
+
     bool Device::init(const Desc& desc)
     {
         if (desc.enableVR) VRSystem::start(desc.enableVsync);
@@ -52,25 +67,22 @@ namespace Falcor
         if (apiInit(desc) == false) return false;
 
         // Create the descriptor pools
-        DescriptorPool::Desc poolDesc;
-        // For DX12 there is no difference between the different SRV/UAV types. For Vulkan it matters, hence the #ifdef
-        // DX12 guarantees at least 1,000,000 descriptors
-        poolDesc.setDescCount(DescriptorPool::Type::TextureSrv, 1000000).setDescCount(DescriptorPool::Type::Sampler, 2048).setShaderVisible(true);
-#ifndef FALCOR_D3D12
-        poolDesc.setDescCount(DescriptorPool::Type::Cbv, 16 * 1024).setDescCount(DescriptorPool::Type::TextureUav, 16 * 1024);
-        poolDesc.setDescCount(DescriptorPool::Type::StructuredBufferSrv, 2 * 1024).setDescCount(DescriptorPool::Type::StructuredBufferUav, 2 * 1024).setDescCount(DescriptorPool::Type::TypedBufferSrv, 2 * 1024).setDescCount(DescriptorPool::Type::TypedBufferUav, 2 * 1024);
-#endif
-        mpGpuDescPool = DescriptorPool::create(poolDesc, mpRenderContext->getLowLevelData()->getFence());
-        poolDesc.setShaderVisible(false).setDescCount(DescriptorPool::Type::Rtv, 16 * 1024).setDescCount(DescriptorPool::Type::Dsv, 1024);
-        mpCpuDescPool = DescriptorPool::create(poolDesc, mpRenderContext->getLowLevelData()->getFence());
+        // The pools and the upload allocator are fenced per frame rather than by the render context.  Commands can also be recorded
+        // into other contexts (see setThreadRenderContext()), e.g. on a compute queue that the render context's fence knows nothing
+        // about, but every queue's work for a frame is done once the frame fence passes it.
+        mpFrameFence = GpuFence::create();
+        mpGpuDescPool = DescriptorPool::create(getPoolDesc(true, 1), mpFrameFence);
+        mpCpuDescPool = DescriptorPool::create(getPoolDesc(false, 1), mpFrameFence);
 
         if (mpRenderContext) mpRenderContext->flush();  // This will bind the descriptor heaps
 
         mVsyncOn = desc.enableVsync;
 
-        mpResourceAllocator = ResourceAllocator::create(1024 * 1024 * 2, mpRenderContext->getLowLevelData()->getFence());
+        mpResourceAllocator = ResourceAllocator::create(1024 * 1024 * 2, mpFrameFence);
 
-        mpFrameFence = GpuFence::create();
+#ifdef FALCOR_D3D12
+        if (desc.placedResourceHeapSize) mpHeapAllocator = D3D12HeapAllocator::create(mpFrameFence, desc.placedResourceHeapSize);
+#endif
 
         // Update the FBOs
         if (updateDefaultFBO(mpWindow->getClientAreaWidth(), mpWindow->getClientAreaHeight(), desc.colorFormat, desc.depthFormat) == false)
@@ -128,6 +140,63 @@ namespace Falcor
         return true;
     }
 
+    // The context the calling thread records into, if it isn't the device's
+    static RenderContext::SharedPtr& threadRenderContext()
+    {
+        static thread_local RenderContext::SharedPtr pContext;
+        return pContext;
+    }
+
+    const RenderContext::SharedPtr& Device::getRenderContext() const
+    {
+        const RenderContext::SharedPtr& pThreadContext = threadRenderContext();
+        return pThreadContext ? pThreadContext : mpRenderContext;
+    }
+
+    void Device::setThreadRenderContext(const RenderContext::SharedPtr& pContext)
+    {
+        threadRenderContext() = pContext;
+    }
+
+    // The allocators the calling thread uses, if they aren't the device's
+    static Device::ThreadAllocators& threadAllocators()
+    {
+        static thread_local Device::ThreadAllocators allocators;
+        return allocators;
+    }
+
+    Device::ThreadAllocators Device::createThreadAllocators() const
+    {
+        ThreadAllocators allocators;
+        allocators.pGpuDescPool = DescriptorPool::create(getPoolDesc(true, 16), mpFrameFence);
+        allocators.pCpuDescPool = DescriptorPool::create(getPoolDesc(false, 16), mpFrameFence);
+        allocators.pResourceAllocator = ResourceAllocator::create(1024 * 1024 * 2, mpFrameFence);
+        return allocators;
+    }
+
+    void Device::setThreadAllocators(const ThreadAllocators& allocators)
+    {
+        threadAllocators() = allocators;
+    }
+
+    const DescriptorPool::SharedPtr& Device::getCpuDescriptorPool() const
+    {
+        const DescriptorPool::SharedPtr& pThreadPool = threadAllocators().pCpuDescPool;
+        return pThreadPool ? pThreadPool : mpCpuDescPool;
+    }
+
+    const DescriptorPool::SharedPtr& Device::getGpuDescriptorPool() const
+    {
+        const DescriptorPool::SharedPtr& pThreadPool = threadAllocators().pGpuDescPool;
+        return pThreadPool ? pThreadPool : mpGpuDescPool;
+    }
+
+    const ResourceAllocator::SharedPtr& Device::getResourceAllocator() const
+    {
+        const ResourceAllocator::SharedPtr& pThreadAllocator = threadAllocators().pResourceAllocator;
+        return pThreadAllocator ? pThreadAllocator : mpResourceAllocator;
+    }
+
     Fbo::SharedPtr Device::getSwapChainFbo() const
     {
         return mpSwapChainFbos[mCurrentBackBufferIndex];
@@ -140,6 +209,7 @@ namespace Falcor
             // Some static objects get here when the application exits
             if(this)
             {
+                std::lock_guard<std::mutex> lock(mDeferredReleasesMutex);
                 mDeferredReleases.push({ mpFrameFence->getCpuValue(), pResource });
             }
         }
@@ -154,10 +224,16 @@ namespace Falcor
     {
         mpResourceAllocator->executeDeferredReleases();
         uint64_t gpuVal = mpFrameFence->getGpuValue();
-        while (mDeferredReleases.size() && mDeferredReleases.front().frameID <= gpuVal)
         {
-            mDeferredReleases.pop();
+            std::lock_guard<std::mutex> lock(mDeferredReleasesMutex);
+            while (mDeferredReleases.size() && mDeferredReleases.front().frameID <= gpuVal)
+            {
+                mDeferredReleases.pop();
+            }
         }
+#ifdef FALCOR_D3D12
+        if (mpHeapAllocator) mpHeapAllocator->executeDeferredReleases();
+#endif
         mpCpuDescPool->executeDeferredReleases();
         mpGpuDescPool->executeDeferredReleases();
     }
@@ -183,6 +259,9 @@ namespace Falcor
 
         mpRenderContext.reset();
         mpResourceAllocator.reset();
+#ifdef FALCOR_D3D12
+        mpHeapAllocator.reset();
+#endif
         mpCpuDescPool.reset();
         mpGpuDescPool.reset();
         mpFrameFence.reset();
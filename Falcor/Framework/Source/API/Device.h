@@ -33,6 +33,7 @@
 #include "API/LowLevel/DescriptorPool.h"
 #include "API/LowLevel/ResourceAllocator.h"
 #include "API/QueryHeap.h"
+#include <mutex>
 
 namespace Falcor
 {
@@ -71,6 +72,8 @@ namespace Falcor
 #ifdef FALCOR_D3D12
             // GUID list for experimental features
             std::vector<UUID> experimentalFeatures;
+
+            uint64_t placedResourceHeapSize = 64 * 1024 * 1024;             ///< Size of the heaps GPU-only textures and buffers are suballocated from. 0 creates every resource committed.
 #endif
         };
 
@@ -113,8 +116,15 @@ namespace Falcor
 
         /** Get the default render-context.
             The default render-context is managed completely by the device. The user should just queue commands into it, the device will take care of allocation, submission and synchronization
+            If the calling thread set its own context with setThreadRenderContext(), that one is returned instead.
+        */
+        const RenderContext::SharedPtr& getRenderContext() const;
+
+        /** Make getRenderContext() return another context on the calling thread, so work the framework records on its own (buffer uploads, acceleration structure builds, GPU timers)
+            lands in the command list the caller is recording into, e.g. one that is submitted on a compute queue. The caller submits and synchronizes that context itself.
+            Pass nullptr to go back to the device's context.
         */
-        const RenderContext::SharedPtr& getRenderContext() const { return mpRenderContext; }
+        static void setThreadRenderContext(const RenderContext::SharedPtr& pContext);
 
         /** Get the command queue handle
         */
@@ -145,9 +155,32 @@ namespace Falcor
         */
         Fbo::SharedPtr resizeSwapChain(uint32_t width, uint32_t height);
 
-        const DescriptorPool::SharedPtr& getCpuDescriptorPool() const { return mpCpuDescPool; }
-        const DescriptorPool::SharedPtr& getGpuDescriptorPool() const { return mpGpuDescPool; }
-        const ResourceAllocator::SharedPtr& getResourceAllocator() const { return mpResourceAllocator; }
+        /** Descriptor pools and upload allocator of a thread that records commands in parallel with other threads (see setThreadAllocators())
+        */
+        struct ThreadAllocators
+        {
+            DescriptorPool::SharedPtr pCpuDescPool;
+            DescriptorPool::SharedPtr pGpuDescPool;
+            ResourceAllocator::SharedPtr pResourceAllocator;
+        };
+
+        /** Create a set of allocators for a recording thread. They are smaller than the device's, and fenced by the frame fence like the device's.
+        */
+        ThreadAllocators createThreadAllocators() const;
+
+        /** Make getCpuDescriptorPool(), getGpuDescriptorPool() and getResourceAllocator() return <allocators> on the calling thread. A context recording on that thread must bind the thread's GPU pool (see CopyContext::bindDescriptorHeaps()).
+            The caller runs executeDeferredReleases() on them once a frame, while no thread allocates from them. Pass an empty struct to go back to the device's allocators.
+        */
+        static void setThreadAllocators(const ThreadAllocators& allocators);
+
+        /** The allocators below are the calling thread's, if it set its own with setThreadAllocators()
+        */
+        const DescriptorPool::SharedPtr& getCpuDescriptorPool() const;
+        const DescriptorPool::SharedPtr& getGpuDescriptorPool() const;
+        const ResourceAllocator::SharedPtr& getResourceAllocator() const;
+#ifdef FALCOR_D3D12
+        const D3D12HeapAllocator::SharedPtr& getHeapAllocator() const { return mpHeapAllocator; }
+#endif
         const QueryHeap::SharedPtr& getTimestampQueryHeap() const { return mTimestampQueryHeap; }
         void releaseResource(ApiObjectHandle pResource);
         double getGpuTimestampFrequency() const { return mGpuTimestampFrequency; } // ms/tick
@@ -178,6 +211,7 @@ namespace Falcor
             ApiObjectHandle pApiObject;
         };
         std::queue<ResourceRelease> mDeferredReleases;
+        std::mutex mDeferredReleasesMutex;      ///< Resources can be released on any recording thread
 
         uint32_t mCurrentBackBufferIndex;
         std::vector<Fbo::SharedPtr> mpSwapChainFbos;
@@ -191,6 +225,9 @@ namespace Falcor
 
         ApiHandle mApiHandle;
         ResourceAllocator::SharedPtr mpResourceAllocator;
+#ifdef FALCOR_D3D12
+        D3D12HeapAllocator::SharedPtr mpHeapAllocator;
+#endif
         DescriptorPool::SharedPtr mpCpuDescPool;
         DescriptorPool::SharedPtr mpGpuDescPool;
         bool mIsWindowOccluded = false;
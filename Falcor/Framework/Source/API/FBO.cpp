@@ -28,10 +28,12 @@
 #include "Framework.h"
 #include "API/FBO.h"
 #include "API/Texture.h"
+#include <mutex>
 
 namespace Falcor
 {
     std::unordered_set<Fbo::Desc, Fbo::DescHash> Fbo::sDescs;
+    static std::mutex sDescsMutex;      // FBOs can be validated on several recording threads
 
     size_t Fbo::DescHash::operator()(const Fbo::Desc& d) const
     {
@@ -284,6 +286,7 @@ namespace Falcor
         }
 
         // Insert the attachment into the static array and initialize the address
+        std::lock_guard<std::mutex> lock(sDescsMutex);
         mpDesc = &(*(sDescs.insert(mTempDesc).first));
 
         return true;
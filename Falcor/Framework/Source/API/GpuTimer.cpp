@@ -69,6 +69,9 @@ namespace Falcor
             logWarning("GpuTimer::begin() was followed by a call to GpuTimer::end() without querying the data first. The previous results will be discarded.");
         }
         mStatus = Status::Begin;
+
+        // Time whichever context this thread is recording into (see Device::setThreadRenderContext())
+        mpLowLevelData = gpDevice->getRenderContext()->getLowLevelData();
         apiBegin();
     }
 
@@ -43,6 +43,7 @@ namespace Falcor
     void DescriptorPool::executeDeferredReleases()
     {
         uint64_t gpuVal = mpFence->getGpuValue();
+        std::lock_guard<std::mutex> lock(mDeferredReleasesMutex);
         while (mpDeferredReleases.size() && mpDeferredReleases.top().fenceValue <= gpuVal)
         {
             mpDeferredReleases.pop();
@@ -54,6 +55,7 @@ namespace Falcor
         DeferredRelease d;
         d.pData = pData;
         d.fenceValue = mpFence->getCpuValue();
+        std::lock_guard<std::mutex> lock(mDeferredReleasesMutex);
         mpDeferredReleases.push(d);
     }
 }
@@ -30,6 +30,7 @@
 #include <queue>
 #include "API/LowLevel/GpuFence.h"
 #include <functional>
+#include <mutex>
 
 namespace Falcor
 {
@@ -112,5 +113,6 @@ namespace Falcor
         };
 
         std::priority_queue<DeferredRelease, std::vector<DeferredRelease>, std::greater<DeferredRelease>> mpDeferredReleases;
+        std::mutex mDeferredReleasesMutex;  ///< Sets can be released on another thread than the one allocating from the pool
     };
 }
@@ -54,6 +54,7 @@ namespace Falcor
         const CommandQueueHandle& getCommandQueue() const { return mpQueue; }
         const CommandAllocatorHandle& getCommandAllocator() const { return mpAllocator; }
         const GpuFence::SharedPtr& getFence() const { return mpFence; }
+        CommandQueueType getType() const { return mType; }
         LowLevelContextApiData* getApiData() const { return mpApiData; }
 
 #ifdef FALCOR_D3D12
@@ -100,12 +100,14 @@ namespace Falcor
     void ResourceAllocator::release(AllocationData& data)
     {
         assert(data.pResourceHandle);
+        std::lock_guard<std::mutex> lock(mDeferredReleasesMutex);
         mDeferredReleases.push(data);
     }
 
     void ResourceAllocator::executeDeferredReleases()
     {
         uint64_t gpuVal = mpFence->getGpuValue();
+        std::lock_guard<std::mutex> lock(mDeferredReleasesMutex);
         while (mDeferredReleases.size() && mDeferredReleases.top().fenceValue <= gpuVal)
         {
             const AllocationData& data = mDeferredReleases.top();
@@ -28,6 +28,7 @@
 #pragma once
 #include <unordered_map>
 #include <queue>
+#include <mutex>
 #include "GpuFence.h"
 
 namespace Falcor
@@ -77,6 +78,7 @@ namespace Falcor
         PageData::UniquePtr mpActivePage;
 
         std::priority_queue<AllocationData> mDeferredReleases;
+        std::mutex mDeferredReleasesMutex;      ///< Buffers can release their data on another thread than the one allocating from us
         std::unordered_map<size_t, PageData::UniquePtr> mUsedPages;
         std::queue<PageData::UniquePtr> mAvailablePages;
 
@@ -71,8 +71,10 @@ namespace Falcor
         };
 
         /** Create a new object.
+            \param[in] queue The queue the context submits to
+            \param[in] type Direct, or Compute for a context that submits to a compute queue.  A compute context can dispatch, ray trace, copy and clear UAVs, but not rasterize, blit or clear render targets.
         */
-        static SharedPtr create(CommandQueueHandle queue);
+        static SharedPtr create(CommandQueueHandle queue, LowLevelContextData::CommandQueueType type = LowLevelContextData::CommandQueueType::Direct);
 
         /** Clear an FBO.
             \param[in] pFbo The FBO to clear
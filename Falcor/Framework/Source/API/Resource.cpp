@@ -31,7 +31,20 @@
 
 namespace Falcor
 {
-    Resource::~Resource() = default;
+    Resource::~Resource()
+    {
+        if (mTrackedBytes)
+        {
+            GpuMemoryTracker::untrack(mMemoryOwner, mType == Type::Buffer ? GpuMemoryTracker::Category::Buffer : GpuMemoryTracker::Category::Texture, mTrackedBytes);
+        }
+    }
+
+    void Resource::trackGpuMemory(uint64_t bytes)
+    {
+        assert(mTrackedBytes == 0);
+        mTrackedBytes = bytes;
+        mMemoryOwner = GpuMemoryTracker::track(mType == Type::Buffer ? GpuMemoryTracker::Category::Buffer : GpuMemoryTracker::Category::Texture, bytes);
+    }
 
     const std::string to_string(Resource::Type type)
     {
@@ -222,8 +235,28 @@ namespace Falcor
         mDsvs.clear();
     }
 
+    // The calling thread's own states for some resources (see Resource::setThreadStates())
+    static thread_local Resource::StateMap* gpThreadStates = nullptr;
+
+    void Resource::setThreadStates(StateMap* pStates)
+    {
+        gpThreadStates = pStates;
+    }
+
+    bool Resource::isStateGlobal() const
+    {
+        if (gpThreadStates && gpThreadStates->count(this)) return true;
+        return mState.isGlobal;
+    }
+
     Resource::State Resource::getGlobalState() const
     {
+        if (gpThreadStates)
+        {
+            auto it = gpThreadStates->find(this);
+            if (it != gpThreadStates->end()) return it->second;
+        }
+
         if (mState.isGlobal == false)
         {
             logWarning("Resource::getGlobalState() - the resource doesn't have a global state. The subresoruces are in a different state, use getSubResourceState() instead");
@@ -234,6 +267,12 @@ namespace Falcor
 
     Resource::State Resource::getSubresourceState(uint32_t arraySlice, uint32_t mipLevel) const
     {
+        if (gpThreadStates)
+        {
+            auto it = gpThreadStates->find(this);
+            if (it != gpThreadStates->end()) return it->second;
+        }
+
         const Texture* pTexture = dynamic_cast<const Texture*>(this);
         if (pTexture)
         {
@@ -250,6 +289,16 @@ namespace Falcor
 
     void Resource::setGlobalState(State newState) const
     {
+        if (gpThreadStates)
+        {
+            auto it = gpThreadStates->find(this);
+            if (it != gpThreadStates->end())
+            {
+                it->second = newState;
+                return;
+            }
+        }
+
         mState.isGlobal = true;
         mState.global = newState;
     }
@@ -263,6 +312,12 @@ namespace Falcor
             return;
         }
 
+        if (gpThreadStates && gpThreadStates->count(this))
+        {
+            logWarning("Resource::setSubresourceState() - the calling thread tracks this resource's state, which only works for global states. Ignoring call");
+            return;
+        }
+
         // If we are transitioning from a global to local state, initialize the subresource array
         if (mState.isGlobal)
         {
@@ -28,6 +28,10 @@
 #pragma once
 #include "ResourceViews.h"
 #include <unordered_map>
+#include "Utils/GpuMemoryTracker.h"
+#ifdef FALCOR_D3D12
+#include "API/D3D12/LowLevel/D3D12HeapAllocator.h"
+#endif
 
 namespace Falcor
 {
@@ -110,7 +114,7 @@ namespace Falcor
         */
         BindFlags getBindFlags() const { return mBindFlags; }
 
-        bool isStateGlobal() const { return mState.isGlobal; }
+        bool isStateGlobal() const;
 
         /** Get the current state. This is only valid if isStateGlobal() returns true
         */
@@ -120,6 +124,17 @@ namespace Falcor
         */
         State getSubresourceState(uint32_t arraySlice, uint32_t mipLevel) const;
 
+        /** States a thread tracks on its own for some resources (see setThreadStates())
+        */
+        using StateMap = std::unordered_map<const Resource*, State>;
+
+        /** Track the state of the resources in <pStates> in that map instead of the resources, on the calling thread.
+            Lets a thread record commands that get submitted after commands other threads are recording at the same time: the map holds the states the resources
+            will be in when the thread's commands execute, and the thread has to transition them back to those states before it is done.
+            Only global states are tracked. Pass nullptr to go back to the resources' own states.
+        */
+        static void setThreadStates(StateMap* pStates);
+
         /** Get the resource type
         */
         Type getType() const { return mType; }
@@ -180,6 +195,10 @@ namespace Falcor
         */
         const std::string& getName() const { return mName; }
 
+        /** Get the amount of GPU memory backing the resource, as reported to the GpuMemoryTracker. 0 for resources suballocated from shared pools.
+        */
+        uint64_t getTrackedMemorySize() const { return mTrackedBytes; }
+
     protected:
         friend class CopyContext;
 
@@ -198,8 +217,17 @@ namespace Falcor
         void setGlobalState(State newState) const;
         void apiSetName();
 
+        /** Report the memory backing the resource to the GpuMemoryTracker. Called by the API backends once the resource is created.
+        */
+        void trackGpuMemory(uint64_t bytes);
+
         ApiHandle mApiHandle;
         std::string mName;
+        uint32_t mMemoryOwner = GpuMemoryTracker::kUntracked;   ///< Owner the memory was attributed to
+        uint64_t mTrackedBytes = 0;
+#ifdef FALCOR_D3D12
+        D3D12HeapAllocator::Allocation mHeapAllocation;     ///< Where the resource lives, if it was placed in a shared heap
+#endif
 
         mutable std::unordered_map<ResourceViewInfo, ShaderResourceView::SharedPtr, ViewInfoHashFunc> mSrvs;
         mutable std::unordered_map<ResourceViewInfo, RenderTargetView::SharedPtr, ViewInfoHashFunc> mRtvs;
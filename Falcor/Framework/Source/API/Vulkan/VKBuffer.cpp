@@ -104,7 +104,8 @@ namespace Falcor
     {
         if (mCpuAccess == CpuAccess::Write)
         {
-            mDynamicData = gpDevice->getResourceAllocator()->allocate(mSize);
+            mpDynamicAllocator = gpDevice->getResourceAllocator();
+            mDynamicData = mpDynamicAllocator->allocate(mSize);
             mApiHandle = mDynamicData.pResourceHandle;
         }
         else
@@ -117,6 +118,7 @@ namespace Falcor
             {
                 mApiHandle = createBuffer(mSize, mBindFlags, Device::MemoryType::Default);
             }
+            trackGpuMemory(mSize);
         }
         return true;
     }
@@ -255,6 +255,15 @@ namespace Falcor
         UNSUPPORTED_IN_VULKAN("uavBarrier");
     }
 
+    void CopyContext::resourceBarriers(const std::vector<Transition>& transitions)
+    {
+        // Each image barrier carries its own stage masks, so there's nothing to gain from batching them here
+        for (const Transition& t : transitions)
+        {
+            resourceBarrier(t.pResource, t.newState);
+        }
+    }
+
     void CopyContext::apiSubresourceBarrier(const Texture* pTexture, Resource::State newState, Resource::State oldState, uint32_t arraySlice, uint32_t mipLevel)
     {
         VkImageMemoryBarrier barrier = {};
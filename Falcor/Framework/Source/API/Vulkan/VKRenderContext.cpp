@@ -37,10 +37,10 @@ namespace Falcor
     VkImageAspectFlags getAspectFlagsFromFormat(ResourceFormat format);
     VkImageLayout getImageLayout(Resource::State state);
       
-    RenderContext::SharedPtr RenderContext::create(CommandQueueHandle queue)
+    RenderContext::SharedPtr RenderContext::create(CommandQueueHandle queue, LowLevelContextData::CommandQueueType type)
     {
         SharedPtr pCtx = SharedPtr(new RenderContext());
-        pCtx->mpLowLevelData = LowLevelContextData::create(LowLevelContextData::CommandQueueType::Direct, queue);
+        pCtx->mpLowLevelData = LowLevelContextData::create(type, queue);
         if (pCtx->mpLowLevelData == nullptr)
         {
             return nullptr;
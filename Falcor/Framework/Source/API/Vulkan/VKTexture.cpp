@@ -144,6 +144,7 @@ namespace Falcor
         vkGetImageMemoryRequirements(gpDevice->getApiHandle(), image, &memRequirements);
         VkDeviceMemory deviceMem = allocateDeviceMemory(Device::MemoryType::Default, memRequirements.memoryTypeBits, memRequirements.size);
         vkBindImageMemory(gpDevice->getApiHandle(), image, deviceMem, 0);
+        trackGpuMemory(memRequirements.size);
 
         mApiHandle = ApiHandle::create(image, deviceMem);
         if (pData != nullptr)
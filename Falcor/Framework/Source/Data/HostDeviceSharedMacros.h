@@ -34,6 +34,7 @@
 
 #define MAX_INSTANCES 64    ///< Max supported instances per draw call
 #define MAX_BONES 256       ///< Max supported bones per model
+#define GPU_DRIVEN_INSTANCE_STRIDE 224  ///< Size in bytes of a GpuDrivenSceneRenderer instance record
 
 /*******************************************************************
                     Glue code for CPU/GPU compilation
@@ -76,6 +76,9 @@
 #include "Graphics/GraphicsState.h"
 #include "Graphics/FullScreenPass.h"
 #include "Graphics/TextureHelper.h"
+#include "Graphics/TextureCooker.h"
+#include "Graphics/TextureStreamer.h"
+#include "Graphics/EnvMapSampler.h"
 #include "Graphics/Light.h"
 #include "Graphics/LightProbe.h"
 #include "Graphics/FboHelper.h"
@@ -101,6 +104,7 @@
 // Scene
 #include "Graphics/Scene/Scene.h"
 #include "Graphics/Scene/SceneRenderer.h"
+#include "Graphics/Scene/GpuDrivenSceneRenderer.h"
 #include "Graphics/Scene/Editor/SceneEditor.h"
 
 // Math
@@ -130,6 +134,7 @@
 #include "Utils/Logger.h"
 #include "Utils/TextRenderer.h"
 #include "Utils/CpuTimer.h"
+#include "Utils/GpuMemoryTracker.h"
 #include "Utils/UserInput.h"
 #include "Utils/Profiler.h"
 #include "Utils/StringUtils.h"
@@ -142,6 +147,15 @@
 #include "Utils/ThreadPool.h"
 #include "Utils/PatternGenerators/DxSamplePattern.h"
 #include "Utils/PatternGenerators/HaltonSamplePattern.h"
+#include "Utils/PatternGenerators/SobolSamplePattern.h"
+#include "Utils/PatternGenerators/R2SamplePattern.h"
+#include "Utils/BlueNoise.h"
+#include "Utils/PathTracerReference.h"
+#include "Utils/Reservoir.h"
+#include "Utils/DynamicResolution.h"
+#include "Utils/DistributedReference.h"
+#include "Utils/LowDiscrepancy.h"
+#include "Utils/TemporalUpscaleReference.h"
 
 // VR
 #include "VR/OpenVR/VRSystem.h"
@@ -204,6 +204,12 @@ namespace Falcor
         return !isInside;
     }
 
+    glm::vec4 Camera::getFrustumPlane(uint32_t index) const
+    {
+        calculateCameraParameters();
+        return glm::vec4(mFrustumPlanes[index].xyz, -mFrustumPlanes[index].negW);
+    }
+
     void Camera::setRightEyeMatrices(const glm::mat4& view, const glm::mat4& proj)
     {
         mData.rightEyeViewMat = view;
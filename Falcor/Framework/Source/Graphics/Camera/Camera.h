@@ -195,6 +195,12 @@ namespace Falcor
         */
         bool isObjectCulled(const BoundingBox& box) const;
 
+        /** Get one of the world-space frustum planes used by isObjectCulled()
+            \param[in] index Plane index, 0 to 5
+            \return The plane normal, pointing into the frustum, in xyz, and the plane offset in w. A point p is inside the plane when dot(p, xyz) + w > 0.
+        */
+        glm::vec4 getFrustumPlane(uint32_t index) const;
+
         /** Set camera data into a program's constant buffer.
             \param[in] pBuffer The constant buffer to set the parameters into.
             \param[in] varName The name of the light variable in the program.
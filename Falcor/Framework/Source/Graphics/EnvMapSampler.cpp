@@ -0,0 +1,278 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "EnvMapSampler.h"
+#include "API/RenderContext.h"
+#include "Utils/BcEncoder.h"
+#include "glm/gtc/packing.hpp"
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <atomic>
+#include <thread>
+
+namespace Falcor
+{
+    static_assert(sizeof(EnvMapSampler::Entry) == 12, "EnvMapSampler::Entry must match the layout in EnvMapSampling.slang");
+
+    namespace
+    {
+        float texelLuminance(const float* pTexel)
+        {
+            float lum = 0.2126f * pTexel[0] + 0.7152f * pTexel[1] + 0.0722f * pTexel[2];
+            return (lum > 0) ? lum : 0.0f;  // Also gets rid of NaNs
+        }
+
+        // Row y covers v in [y, y + 1] / height
+        float rowSinTheta(uint32_t y, uint32_t height)
+        {
+            return std::sin(float(M_PI) * (float(y) + 0.5f) / float(height));
+        }
+
+        /** Vose's alias method. Weights with a zero sum give a uniform table.
+            The scratch vectors are passed in so each thread allocates them once.
+        */
+        void buildAliasTable(const double* pWeights, uint32_t count, EnvMapSampler::Entry* pTable, std::vector<double>& scaled, std::vector<uint32_t>& small, std::vector<uint32_t>& large)
+        {
+            double sum = 0;
+            for (uint32_t i = 0; i < count; i++) sum += pWeights[i];
+
+            scaled.resize(count);
+            small.clear();
+            large.clear();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                double p = (sum > 0) ? pWeights[i] / sum : 1.0 / count;
+                pTable[i] = { 1.0f, i, float(p) };
+                scaled[i] = p * count;
+                (scaled[i] < 1.0 ? small : large).push_back(i);
+            }
+
+            // Pair each under-full entry with an over-full one, which donates the rest of the slot
+            while (small.empty() == false && large.empty() == false)
+            {
+                uint32_t s = small.back();
+                small.pop_back();
+                uint32_t l = large.back();
+                large.pop_back();
+
+                pTable[s].threshold = float(scaled[s]);
+                pTable[s].alias = l;
+                scaled[l] -= 1.0 - scaled[s];
+                (scaled[l] < 1.0 ? small : large).push_back(l);
+            }
+            // What's left is full up to rounding errors, and keeps the threshold of 1 it was initialized with
+        }
+
+        // Pick an entry with one uniform number. What's left of the number after the pick is uniform too and is returned in residual.
+        uint32_t pickEntry(const EnvMapSampler::Entry* pTable, uint32_t count, float u, float& residual)
+        {
+            float scaled = u * float(count);
+            uint32_t i = std::min(uint32_t(scaled), count - 1);
+            float f = std::min(scaled - float(i), 1.0f);
+            const EnvMapSampler::Entry& e = pTable[i];
+            if (f < e.threshold)
+            {
+                residual = f / e.threshold;
+                return i;
+            }
+            residual = (f - e.threshold) / (1.0f - e.threshold);
+            return e.alias;
+        }
+    }
+
+    EnvMapSampler::SharedPtr EnvMapSampler::create(const float* pRgba, uint32_t width, uint32_t height, uint32_t threadCount)
+    {
+        if (width == 0 || height == 0)
+        {
+            logError("EnvMapSampler::create() - the environment map is empty");
+            return nullptr;
+        }
+
+        SharedPtr pSampler = SharedPtr(new EnvMapSampler(width, height));
+        pSampler->build(pRgba, threadCount);
+        pSampler->upload();
+        return pSampler;
+    }
+
+    EnvMapSampler::SharedPtr EnvMapSampler::create(RenderContext* pContext, const Texture::SharedPtr& pTexture, uint32_t threadCount)
+    {
+        if (pTexture == nullptr) return nullptr;
+
+        uint32_t width = pTexture->getWidth();
+        uint32_t height = pTexture->getHeight();
+        size_t texelCount = size_t(width) * height;
+        std::vector<float> rgba(texelCount * 4, 1.0f);
+
+        ResourceFormat format = pTexture->getFormat();
+        switch (format)
+        {
+        case ResourceFormat::RGBA32Float:
+        case ResourceFormat::RGB32Float:
+        {
+            std::vector<uint8_t> data = pContext->readTextureSubresource(pTexture.get(), 0);
+            uint32_t channels = (format == ResourceFormat::RGBA32Float) ? 4 : 3;
+            const float* pFloats = reinterpret_cast<const float*>(data.data());
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                for (uint32_t c = 0; c < 3; c++) rgba[i * 4 + c] = pFloats[i * channels + c];
+            }
+            break;
+        }
+        case ResourceFormat::RGBA16Float:
+        case ResourceFormat::RGB16Float:
+        {
+            std::vector<uint8_t> data = pContext->readTextureSubresource(pTexture.get(), 0);
+            uint32_t channels = (format == ResourceFormat::RGBA16Float) ? 4 : 3;
+            const uint16_t* pHalfs = reinterpret_cast<const uint16_t*>(data.data());
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                for (uint32_t c = 0; c < 3; c++) rgba[i * 4 + c] = glm::unpackHalf1x16(pHalfs[i * channels + c]);
+            }
+            break;
+        }
+        case ResourceFormat::BC6HU16:
+        {
+            // Cooked environment maps. Decode mip 0 block by block; partial blocks at the edges are cut off.
+            std::vector<uint8_t> data = pContext->readTextureSubresource(pTexture.get(), 0);
+            uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+            for (uint32_t by = 0; by < blocksY; by++)
+            {
+                for (uint32_t bx = 0; bx < blocksX; bx++)
+                {
+                    BcEncoder::Block block;
+                    BcEncoder::decodeBlock(BcEncoder::Format::BC6H, &data[(size_t(by) * blocksX + bx) * 16], block);
+                    for (uint32_t i = 0; i < 16; i++)
+                    {
+                        uint32_t x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                        if (x >= width || y >= height) continue;
+                        float* pTexel = &rgba[(size_t(y) * width + x) * 4];
+                        pTexel[0] = block.r[i];
+                        pTexel[1] = block.g[i];
+                        pTexel[2] = block.b[i];
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            logWarning("EnvMapSampler::create() - unsupported format " + to_string(format) + ", the environment map will be sampled like a constant map");
+            break;
+        }
+
+        return create(rgba.data(), width, height, threadCount);
+    }
+
+    void EnvMapSampler::build(const float* pRgba, uint32_t threadCount)
+    {
+        mMarginal.resize(mHeight);
+        mConditional.resize(size_t(mWidth) * mHeight);
+        std::vector<double> rowWeights(mHeight);
+
+        // The conditional tables only need the luminance; sin(theta) is the same for every texel in a row and goes into the row's weight.
+        // Threads grab rows until there are none left.
+        std::atomic<uint32_t> nextRow(0);
+        auto buildRows = [&]()
+        {
+            std::vector<double> weights(mWidth);
+            std::vector<double> scaled;
+            std::vector<uint32_t> small, large;
+            for (uint32_t y = nextRow++; y < mHeight; y = nextRow++)
+            {
+                double rowSum = 0;
+                for (uint32_t x = 0; x < mWidth; x++)
+                {
+                    weights[x] = texelLuminance(pRgba + (size_t(y) * mWidth + x) * 4);
+                    rowSum += weights[x];
+                }
+                rowWeights[y] = rowSum * rowSinTheta(y, mHeight);
+                buildAliasTable(weights.data(), mWidth, mConditional.data() + size_t(y) * mWidth, scaled, small, large);
+            }
+        };
+
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::min(threadCount, mHeight);
+
+        std::vector<std::thread> workers;
+        for (uint32_t i = 1; i < threadCount; i++) workers.emplace_back(buildRows);
+        buildRows();
+        for (auto& t : workers) t.join();
+
+        // A black map is sampled uniformly over the sphere rather than uniformly over its texels
+        double total = 0;
+        for (double w : rowWeights) total += w;
+        if (total <= 0)
+        {
+            for (uint32_t y = 0; y < mHeight; y++) rowWeights[y] = rowSinTheta(y, mHeight);
+        }
+
+        std::vector<double> scaled;
+        std::vector<uint32_t> small, large;
+        buildAliasTable(rowWeights.data(), mHeight, mMarginal.data(), scaled, small, large);
+    }
+
+    void EnvMapSampler::upload()
+    {
+        mpMarginalBuffer = Buffer::create(mMarginal.size() * sizeof(Entry), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mMarginal.data());
+        mpConditionalBuffer = Buffer::create(mConditional.size() * sizeof(Entry), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, mConditional.data());
+    }
+
+    float EnvMapSampler::getTexelProbability(uint32_t x, uint32_t y) const
+    {
+        return mMarginal[y].pdf * mConditional[size_t(y) * mWidth + x].pdf;
+    }
+
+    glm::vec3 EnvMapSampler::sample(const glm::vec2& u, float& pdf) const
+    {
+        glm::vec2 residual;
+        uint32_t y = pickEntry(mMarginal.data(), mHeight, u.x, residual.y);
+        uint32_t x = pickEntry(mConditional.data() + size_t(y) * mWidth, mWidth, u.y, residual.x);
+
+        // Spread the samples over the texel with what's left of the random numbers
+        glm::vec2 uv = (glm::vec2(x, y) + glm::min(residual, glm::vec2(0.99999994f))) / glm::vec2(mWidth, mHeight);
+        float phi = float(M_PI) * (2.0f * uv.x - 1.0f);
+        float theta = float(M_PI) * uv.y;
+        float sinTheta = std::sin(theta);
+
+        // The texel covers (2 pi / width) * (pi / height) * sin(theta) steradians
+        pdf = (sinTheta > 0) ? getTexelProbability(x, y) * float(mWidth) * float(mHeight) / (2.0f * float(M_PI * M_PI) * sinTheta) : 0.0f;
+        return glm::vec3(sinTheta * std::sin(phi), std::cos(theta), -sinTheta * std::cos(phi));
+    }
+
+    float EnvMapSampler::evalPdf(const glm::vec3& dir) const
+    {
+        glm::vec3 p = glm::normalize(dir);
+        glm::vec2 uv;
+        uv.x = (1.0f + std::atan2(p.x, -p.z) * float(M_1_PI)) * 0.5f;
+        uv.y = std::acos(glm::clamp(p.y, -1.0f, 1.0f)) * float(M_1_PI);
+
+        uint32_t x = std::min(uint32_t(uv.x * mWidth), mWidth - 1);
+        uint32_t y = std::min(uint32_t(uv.y * mHeight), mHeight - 1);
+        float sinTheta = std::sqrt(std::max(0.0f, 1.0f - p.y * p.y));
+        return (sinTheta > 0) ? getTexelProbability(x, y) * float(mWidth) * float(mHeight) / (2.0f * float(M_PI * M_PI) * sinTheta) : 0.0f;
+    }
+}
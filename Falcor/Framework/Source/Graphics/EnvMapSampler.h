@@ -0,0 +1,108 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "API/Buffer.h"
+#include "API/Texture.h"
+#include <vector>
+
+namespace Falcor
+{
+    class RenderContext;
+
+    /** Importance sampling of latitude-longitude environment maps.
+        The map is turned into a 2D distribution proportional to texel luminance times sin(theta), the solid angle a texel covers: a marginal
+        distribution picks a row, then the row's conditional distribution picks a texel in it. Both are stored as alias tables, so drawing a
+        direction costs two table lookups whatever the size of the map, and so does evaluating the pdf of a direction.
+        Directions follow wsVectorToLatLong() in the ray tracing samples: u = (1 + atan2(x, -z) / pi) / 2 and v = acos(y) / pi, with row 0 at +Y.
+        The shader side is in ShadingUtils/EnvMapSampling.slang.
+    */
+    class EnvMapSampler
+    {
+    public:
+        using SharedPtr = std::shared_ptr<EnvMapSampler>;
+        using SharedConstPtr = std::shared_ptr<const EnvMapSampler>;
+
+        /** An alias table entry, as the shaders read it (three dwords)
+        */
+        struct Entry
+        {
+            float threshold;    ///< Keep this entry when the fraction of the scaled random number is below the threshold, otherwise take the alias
+            uint32_t alias;
+            float pdf;          ///< Probability of the entry within its table: of the row for the marginal table, of the texel given its row for the conditional ones
+        };
+
+        /** Build the tables from linear RGBA texels, top row first.
+            \param[in] threadCount Number of threads building the rows' tables. 0 uses one per hardware thread.
+        */
+        static SharedPtr create(const float* pRgba, uint32_t width, uint32_t height, uint32_t threadCount = 0);
+
+        /** Build the tables from the first mip of a texture, which is read back to the CPU. RGBA32Float, RGB32Float, RGBA16Float and RGB16Float are
+            supported; other formats are sampled like a constant map.
+        */
+        static SharedPtr create(RenderContext* pContext, const Texture::SharedPtr& pTexture, uint32_t threadCount = 0);
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getHeight() const { return mHeight; }
+
+        /** Get the probability of picking a texel
+        */
+        float getTexelProbability(uint32_t x, uint32_t y) const;
+
+        /** Draw a direction from two uniform numbers in [0, 1)
+            \param[out] pdf Probability density of the direction, per unit solid angle
+        */
+        glm::vec3 sample(const glm::vec2& u, float& pdf) const;
+
+        /** Evaluate the probability density sample() returns a direction with, per unit solid angle
+        */
+        float evalPdf(const glm::vec3& dir) const;
+
+        /** The marginal table, one Entry per row. Bind as a ByteAddressBuffer.
+        */
+        const Buffer::SharedPtr& getMarginalBuffer() const { return mpMarginalBuffer; }
+
+        /** The conditional tables, width Entries per row, rows top to bottom. Bind as a ByteAddressBuffer.
+        */
+        const Buffer::SharedPtr& getConditionalBuffer() const { return mpConditionalBuffer; }
+
+        const std::vector<Entry>& getMarginalTable() const { return mMarginal; }
+        const std::vector<Entry>& getConditionalTable() const { return mConditional; }
+
+    private:
+        EnvMapSampler(uint32_t width, uint32_t height) : mWidth(width), mHeight(height) {}
+        void build(const float* pRgba, uint32_t threadCount);
+        void upload();
+
+        uint32_t mWidth;
+        uint32_t mHeight;
+        std::vector<Entry> mMarginal;
+        std::vector<Entry> mConditional;
+        Buffer::SharedPtr mpMarginalBuffer;
+        Buffer::SharedPtr mpConditionalBuffer;
+    };
+}
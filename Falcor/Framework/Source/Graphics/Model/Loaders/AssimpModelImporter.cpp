@@ -43,6 +43,11 @@
 #include "Data/VertexAttrib.h"
 #include "Utils/StringUtils.h"
 #include "API/Device.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/MeshSimplifier.h"
+#include <fstream>
+#include "glm/gtc/packing.hpp"
+#include "glm/gtx/transform.hpp"
 
 namespace Falcor
 {
@@ -194,6 +199,39 @@ namespace Falcor
         { VERTEX_DIFFUSE_COLOR_LOC, VERTEX_DIFFUSE_COLOR_NAME,  ResourceFormat::RGBA32Float },
     };
 
+    // Formats used by Model::LoadFlags::CompactVertexLayout. Other locations keep the format from kLayoutData.
+    ResourceFormat getElementFormat(uint32_t location, bool compact)
+    {
+        if (compact)
+        {
+            switch (location)
+            {
+            case VERTEX_POSITION_LOC:
+                return ResourceFormat::RGBA16Unorm;     // Relative to the mesh bounds
+            case VERTEX_NORMAL_LOC:
+            case VERTEX_BITANGENT_LOC:
+                return ResourceFormat::RG16Snorm;       // Octahedral
+            case VERTEX_TEXCOORD_LOC:
+            case VERTEX_LIGHTMAP_UV_LOC:
+                return ResourceFormat::RG16Float;
+            default:
+                break;
+            }
+        }
+        return kLayoutData[location].format;
+    }
+
+    // Positions are quantized to [0, 1] over the bounds. Flat axes get a unit size so that nothing divides by zero.
+    void getCompactBounds(const BoundingBox& box, vec3& boxMin, vec3& boxSize)
+    {
+        boxMin = box.getMinPos();
+        boxSize = box.extent * 2.0f;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            if (boxSize[i] <= 0) boxSize[i] = 1;
+        }
+    }
+
 
     glm::mat4 aiMatToGLM(const aiMatrix4x4& aiMat)
     {
@@ -523,6 +561,19 @@ namespace Falcor
         // Never use Assimp's tangent gen code
         assimpFlags &= ~(aiProcess_CalcTangentSpace);
 
+        // Meshes are reordered by optimizeMesh()
+        if (is_set(mFlags, Model::LoadFlags::DontOptimizeMeshes) == false) assimpFlags &= ~aiProcess_ImproveCacheLocality;
+
+        if (is_set(mFlags, Model::LoadFlags::GenerateLods))
+        {
+            loadLodCache(fullpath);
+        }
+
+        if (is_set(mFlags, Model::LoadFlags::CompactVertexLayout) && is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource))
+        {
+            logWarning("AssimpModelImporter: CompactVertexLayout is ignored when loading with BuffersAsShaderResource");
+        }
+
         Assimp::Importer importer;
         const aiScene* pScene = importer.ReadFile(fullpath, assimpFlags);
 
@@ -553,6 +604,22 @@ namespace Falcor
             return false;
         }
 
+        if (mLodCacheDirty)
+        {
+            saveLodCache();
+        }
+
+        if (mMeshStats.vertexCount > 0)
+        {
+            std::string msg = "Loaded model '" + filename + "'";
+            if (mMeshStats.triangleCount > 0)
+            {
+                msg += ": ACMR " + std::to_string(mMeshStats.acmrBefore / mMeshStats.triangleCount) + " -> " + std::to_string(mMeshStats.acmrAfter / mMeshStats.triangleCount);
+            }
+            msg += ", " + std::to_string(mMeshStats.vertexBytesBefore / mMeshStats.vertexCount) + " -> " + std::to_string(mMeshStats.vertexBytesAfter / mMeshStats.vertexCount) + " bytes per vertex";
+            logInfo(msg);
+        }
+
         return true;
     }
 
@@ -763,20 +830,148 @@ namespace Falcor
         return BoundingBox::fromMinMax(boxMin, boxMax);
     }
 
+    float computeMeshUvScale(const aiMesh* pAiMesh)
+    {
+        if (pAiMesh->mTextureCoords[0] == nullptr) return 0;
+
+        // Ratio between the surface area and the area covered in texture space
+        double area = 0;
+        double uvArea = 0;
+        for (uint32_t faceID = 0; faceID < pAiMesh->mNumFaces; faceID++)
+        {
+            const aiFace& face = pAiMesh->mFaces[faceID];
+            if (face.mNumIndices != 3) continue;
+
+            const aiVector3D& p0 = pAiMesh->mVertices[face.mIndices[0]];
+            const aiVector3D& uv0 = pAiMesh->mTextureCoords[0][face.mIndices[0]];
+            aiVector3D e1 = pAiMesh->mVertices[face.mIndices[1]] - p0;
+            aiVector3D e2 = pAiMesh->mVertices[face.mIndices[2]] - p0;
+            aiVector3D t1 = pAiMesh->mTextureCoords[0][face.mIndices[1]] - uv0;
+            aiVector3D t2 = pAiMesh->mTextureCoords[0][face.mIndices[2]] - uv0;
+
+            area += 0.5 * glm::length(glm::cross(glm::vec3(e1.x, e1.y, e1.z), glm::vec3(e2.x, e2.y, e2.z)));
+            uvArea += 0.5 * std::abs(t1.x * t2.y - t1.y * t2.x);
+        }
+
+        return (uvArea > 0) ? float(std::sqrt(area / uvArea)) : 0;
+    }
+
+    bool isElementUsed(const aiMesh* pAiMesh, uint32_t location)
+    {
+        switch (location)
+        {
+        case VERTEX_POSITION_LOC:
+            return true;
+        case VERTEX_NORMAL_LOC:
+            return pAiMesh->HasNormals();
+        case VERTEX_BITANGENT_LOC:
+            return (pAiMesh->mBitangents != nullptr); // ASSIMP doesn't have a function that checks only for bitangents
+        case VERTEX_BONE_WEIGHT_LOC:
+        case VERTEX_BONE_ID_LOC:
+            return pAiMesh->HasBones();
+        case VERTEX_DIFFUSE_COLOR_LOC:
+            return pAiMesh->HasVertexColors(0);
+        case VERTEX_TEXCOORD_LOC:
+            return pAiMesh->HasTextureCoords(0);
+        case VERTEX_LIGHTMAP_UV_LOC:
+            return pAiMesh->HasTextureCoords(1);
+        case VERTEX_PREV_POSITION_LOC:
+            return false;
+        default:
+            should_not_get_here();
+            return false;
+        }
+    }
+
+    void AssimpModelImporter::optimizeMesh(const aiMesh* pAiMesh)
+    {
+        if (pAiMesh->mFaces[0].mNumIndices != 3) return;
+
+        aiMesh* pMesh = const_cast<aiMesh*>(pAiMesh);
+        const uint32_t vertexCount = pMesh->mNumVertices;
+        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
+        float acmrBefore = MeshOptimizer::computeAcmr(indices.data(), indices.size(), vertexCount);
+
+        std::vector<uint32_t> clusters = MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+        MeshOptimizer::optimizeOverdraw(indices.data(), indices.size(), &pMesh->mVertices[0].x, sizeof(aiVector3D), vertexCount, clusters);
+        float acmrAfter = MeshOptimizer::computeAcmr(indices.data(), indices.size(), vertexCount);
+
+        // Renumber the vertices in the new triangle order, across every attribute stream
+        std::vector<uint32_t> remap = MeshOptimizer::optimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+        MeshOptimizer::remapVertices(pMesh->mVertices, sizeof(aiVector3D), remap);
+        if (pMesh->mNormals) MeshOptimizer::remapVertices(pMesh->mNormals, sizeof(aiVector3D), remap);
+        if (pMesh->mTangents) MeshOptimizer::remapVertices(pMesh->mTangents, sizeof(aiVector3D), remap);
+        if (pMesh->mBitangents) MeshOptimizer::remapVertices(pMesh->mBitangents, sizeof(aiVector3D), remap);
+        for (uint32_t i = 0; i < AI_MAX_NUMBER_OF_TEXTURECOORDS; i++)
+        {
+            if (pMesh->mTextureCoords[i]) MeshOptimizer::remapVertices(pMesh->mTextureCoords[i], sizeof(aiVector3D), remap);
+        }
+        for (uint32_t i = 0; i < AI_MAX_NUMBER_OF_COLOR_SETS; i++)
+        {
+            if (pMesh->mColors[i]) MeshOptimizer::remapVertices(pMesh->mColors[i], sizeof(aiColor4D), remap);
+        }
+
+        std::vector<uint32_t> oldToNew(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            oldToNew[remap[i]] = i;
+        }
+        for (uint32_t i = 0; i < pMesh->mNumBones; i++)
+        {
+            aiBone* pBone = pMesh->mBones[i];
+            for (uint32_t j = 0; j < pBone->mNumWeights; j++)
+            {
+                pBone->mWeights[j].mVertexId = oldToNew[pBone->mWeights[j].mVertexId];
+            }
+        }
+
+        for (uint32_t i = 0; i < pMesh->mNumFaces; i++)
+        {
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                pMesh->mFaces[i].mIndices[j] = indices[i * 3 + j];
+            }
+        }
+
+        mMeshStats.triangleCount += pMesh->mNumFaces;
+        mMeshStats.acmrBefore += acmrBefore * pMesh->mNumFaces;
+        mMeshStats.acmrAfter += acmrAfter * pMesh->mNumFaces;
+    }
+
+    bool AssimpModelImporter::useCompactVertexLayout(const aiMesh* pAiMesh) const
+    {
+        // Skinning and the ray-tracing shaders read the vertex buffers as floats
+        return is_set(mFlags, Model::LoadFlags::CompactVertexLayout) && (is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource) == false) && (pAiMesh->HasBones() == false);
+    }
+
     Mesh::SharedPtr AssimpModelImporter::createMesh(const aiMesh* pAiMesh)
     {
+        if (is_set(mFlags, Model::LoadFlags::DontOptimizeMeshes) == false)
+        {
+            optimizeMesh(pAiMesh);
+        }
+
         uint32_t vertexCount = pAiMesh->mNumVertices;
         uint32_t indexCount = pAiMesh->mNumFaces * pAiMesh->mFaces[0].mNumIndices;
-        auto pIB = createIndexBuffer(pAiMesh);
         BoundingBox boundingBox = createMeshBbox(pAiMesh);
 
+        // The LOD chain is appended to the full-detail indices
+        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
+        std::vector<Mesh::Lod> lods;
+        if (is_set(mFlags, Model::LoadFlags::GenerateLods) && pAiMesh->mFaces[0].mNumIndices == 3)
+        {
+            generateLods(pAiMesh, indices, lods);
+        }
+        auto pIB = createIndexBuffer(indices);
+
         const bool generateTangentSpace = (pAiMesh->HasTangentsAndBitangents() == false) && (is_set(mFlags, Model::LoadFlags::DontGenerateTangentSpace) == false);
         if (generateTangentSpace)
         {
             genTangentSpace(pAiMesh);
         }
 
-        VertexLayout::SharedPtr pLayout = createVertexLayout(pAiMesh);
+        const bool compact = useCompactVertexLayout(pAiMesh);
+        VertexLayout::SharedPtr pLayout = createVertexLayout(pAiMesh, compact);
         if (pLayout == nullptr)
         {
             assert(0);
@@ -797,8 +992,18 @@ namespace Falcor
         for (uint32_t i = 0; i < pLayout->getBufferCount(); i++)
         {
             const VertexBufferLayout* pVbLayout = pLayout->getBufferLayout(i).get();
-            pVBs[i] = createVertexBuffer(pAiMesh, pVbLayout, (uint8_t*)ids.data(), weights.data());
+            pVBs[i] = createVertexBuffer(pAiMesh, pVbLayout, (uint8_t*)ids.data(), weights.data(), compact ? &boundingBox : nullptr);
+        }
+
+        for (uint32_t location = 0; location < VERTEX_LOCATION_COUNT; ++location)
+        {
+            if (isElementUsed(pAiMesh, location))
+            {
+                mMeshStats.vertexBytesBefore += uint64_t(getFormatBytesPerBlock(kLayoutData[location].format)) * vertexCount;
+                mMeshStats.vertexBytesAfter += uint64_t(getFormatBytesPerBlock(getElementFormat(location, compact))) * vertexCount;
+            }
         }
+        mMeshStats.vertexCount += vertexCount;
 
         Vao::Topology topology = Vao::Topology::TriangleList;
         switch (pAiMesh->mFaces[0].mNumIndices)
@@ -821,6 +1026,16 @@ namespace Falcor
         assert(pMaterial);
 
         Mesh::SharedPtr pMesh = Mesh::create(pVBs, vertexCount, pIB, indexCount, pLayout, topology, pMaterial, boundingBox, pAiMesh->HasBones());
+        pMesh->mUvScale = computeMeshUvScale(pAiMesh);
+        pMesh->mLods.insert(pMesh->mLods.end(), lods.begin(), lods.end());
+
+        if (compact)
+        {
+            vec3 boxMin, boxSize;
+            getCompactBounds(boundingBox, boxMin, boxSize);
+            pMesh->mHasCompactVertexLayout = true;
+            pMesh->mPositionDequantMat = glm::translate(boxMin) * glm::scale(boxSize);
+        }
 
         if (generateTangentSpace)
         {
@@ -831,9 +1046,8 @@ namespace Falcor
         return pMesh;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createIndexBuffer(const aiMesh* pAiMesh)
+    Buffer::SharedPtr AssimpModelImporter::createIndexBuffer(const std::vector<uint32_t>& indices)
     {
-        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
         const uint32_t size = (uint32_t)(sizeof(uint32_t) * indices.size());
         Buffer::BindFlags bindFlags = Buffer::BindFlags::Index;
         if (is_set(mFlags, Model::LoadFlags::BuffersAsShaderResource))
@@ -843,35 +1057,159 @@ namespace Falcor
         return Buffer::create(size, bindFlags, Buffer::CpuAccess::None, indices.data());;
     }
 
+    // Model::LoadFlags::GenerateLods settings
+    static const uint32_t kMaxLodCount = 5;             // Including the full-detail mesh
+    static const uint32_t kMinLodTriangleCount = 64;    // Don't simplify below this
+    static const float kLodAttributeWeight = 0.1f;      // Attribute distance to position units, relative to the mesh radius
+    static const uint32_t kLodCacheMagic = 0x444f4c46;  // 'FLOD'
+    static const uint32_t kLodCacheVersion = 1;
 
-    bool isElementUsed(const aiMesh* pAiMesh, uint32_t location)
+    // Identifies a mesh in the LOD cache by the data the simplifier reads
+    static uint64_t hashMeshForLods(const aiMesh* pAiMesh, const std::vector<uint32_t>& indices)
     {
-        switch (location)
+        uint64_t hash = 14695981039346656037ull;
+        auto hashBytes = [&hash](const void* pData, size_t size)
         {
-        case VERTEX_POSITION_LOC:
-            return true;
-        case VERTEX_NORMAL_LOC:
-            return pAiMesh->HasNormals();
-        case VERTEX_BITANGENT_LOC:
-            return (pAiMesh->mBitangents != nullptr); // ASSIMP doesn't have a function that checks only for bitangents
-        case VERTEX_BONE_WEIGHT_LOC:
-        case VERTEX_BONE_ID_LOC:
-            return pAiMesh->HasBones();
-        case VERTEX_DIFFUSE_COLOR_LOC:
-            return pAiMesh->HasVertexColors(0);
-        case VERTEX_TEXCOORD_LOC:
-            return pAiMesh->HasTextureCoords(0);
-        case VERTEX_LIGHTMAP_UV_LOC:
-            return pAiMesh->HasTextureCoords(1);
-        case VERTEX_PREV_POSITION_LOC:
-            return false;
-        default:
-            should_not_get_here();
-            return false;
+            const uint8_t* pBytes = (const uint8_t*)pData;
+            for (size_t i = 0; i < size; i++) hash = (hash ^ pBytes[i]) * 1099511628211ull;
+        };
+        hashBytes(&pAiMesh->mNumVertices, sizeof(pAiMesh->mNumVertices));
+        hashBytes(indices.data(), indices.size() * sizeof(uint32_t));
+        hashBytes(pAiMesh->mVertices, pAiMesh->mNumVertices * sizeof(aiVector3D));
+        return hash;
+    }
+
+    void AssimpModelImporter::generateLods(const aiMesh* pAiMesh, std::vector<uint32_t>& indices, std::vector<Mesh::Lod>& lods)
+    {
+        const uint32_t lod0IndexCount = (uint32_t)indices.size();
+        uint64_t key = hashMeshForLods(pAiMesh, indices);
+
+        auto it = mLodCache.find(key);
+        if (it == mLodCache.end())
+        {
+            const uint32_t vertexCount = pAiMesh->mNumVertices;
+
+            // Collapses that change the shading or the texture mapping cost extra
+            std::vector<float> attributes;
+            MeshSimplifier::Attributes attribs;
+            attribs.count = (pAiMesh->HasNormals() ? 3 : 0) + (pAiMesh->HasTextureCoords(0) ? 2 : 0);
+            if (attribs.count)
+            {
+                attributes.reserve(vertexCount * attribs.count);
+                for (uint32_t v = 0; v < vertexCount; v++)
+                {
+                    if (pAiMesh->HasNormals())
+                    {
+                        attributes.insert(attributes.end(), { pAiMesh->mNormals[v].x, pAiMesh->mNormals[v].y, pAiMesh->mNormals[v].z });
+                    }
+                    if (pAiMesh->HasTextureCoords(0))
+                    {
+                        attributes.insert(attributes.end(), { pAiMesh->mTextureCoords[0][v].x, pAiMesh->mTextureCoords[0][v].y });
+                    }
+                }
+                attribs.pData = attributes.data();
+                attribs.stride = attribs.count * sizeof(float);
+                attribs.weight = kLodAttributeWeight * glm::length(createMeshBbox(pAiMesh).extent);
+            }
+
+            // Every level is simplified from the full-detail mesh, halving the triangle count each time
+            std::vector<LodLevel> levels;
+            size_t targetIndexCount = lod0IndexCount;
+            for (uint32_t lod = 1; lod < kMaxLodCount; lod++)
+            {
+                targetIndexCount = (targetIndexCount / 6) * 3;
+                if (targetIndexCount < kMinLodTriangleCount * 3) break;
+
+                LodLevel level;
+                level.indices = MeshSimplifier::simplify(indices.data(), lod0IndexCount, &pAiMesh->mVertices[0].x, sizeof(aiVector3D), vertexCount, targetIndexCount, FLT_MAX, attribs, &level.error);
+
+                // Stop once the simplifier runs out of collapses it is allowed to make
+                size_t previousIndexCount = levels.size() ? levels.back().indices.size() : lod0IndexCount;
+                if (level.indices.size() * 10 > previousIndexCount * 9) break;
+
+                if (levels.size()) level.error = std::max(level.error, levels.back().error);
+                MeshOptimizer::optimizeVertexCache(level.indices.data(), level.indices.size(), vertexCount);
+                levels.push_back(std::move(level));
+            }
+
+            it = mLodCache.emplace(key, std::move(levels)).first;
+            mLodCacheDirty = true;
+        }
+
+        for (const LodLevel& level : it->second)
+        {
+            Mesh::Lod lod;
+            lod.firstIndex = (uint32_t)indices.size();
+            lod.indexCount = (uint32_t)level.indices.size();
+            lod.error = level.error;
+            lods.push_back(lod);
+            indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+        }
+    }
+
+    void AssimpModelImporter::loadLodCache(const std::string& modelPath)
+    {
+        mLodCacheFile = modelPath + ".lods";
+        if (doesFileExist(mLodCacheFile) == false || getFileModifiedTime(mLodCacheFile) < getFileModifiedTime(modelPath)) return;
+
+        std::ifstream file(mLodCacheFile, std::ios::binary);
+        uint32_t header[3] = {};
+        file.read((char*)header, sizeof(header));
+        if (!file || header[0] != kLodCacheMagic || header[1] != kLodCacheVersion) return;
+
+        for (uint32_t i = 0; i < header[2]; i++)
+        {
+            uint64_t key = 0;
+            uint32_t levelCount = 0;
+            file.read((char*)&key, sizeof(key));
+            file.read((char*)&levelCount, sizeof(levelCount));
+            std::vector<LodLevel> levels(levelCount);
+            for (LodLevel& level : levels)
+            {
+                uint32_t indexCount = 0;
+                file.read((char*)&level.error, sizeof(level.error));
+                file.read((char*)&indexCount, sizeof(indexCount));
+                level.indices.resize(indexCount);
+                file.read((char*)level.indices.data(), indexCount * sizeof(uint32_t));
+            }
+
+            if (!file)
+            {
+                logWarning("AssimpModelImporter: LOD cache '" + mLodCacheFile + "' is truncated. Regenerating it.");
+                mLodCache.clear();
+                return;
+            }
+            mLodCache[key] = std::move(levels);
+        }
+    }
+
+    void AssimpModelImporter::saveLodCache()
+    {
+        std::ofstream file(mLodCacheFile, std::ios::binary);
+        uint32_t header[3] = { kLodCacheMagic, kLodCacheVersion, (uint32_t)mLodCache.size() };
+        file.write((const char*)header, sizeof(header));
+        for (const auto& entry : mLodCache)
+        {
+            uint32_t levelCount = (uint32_t)entry.second.size();
+            file.write((const char*)&entry.first, sizeof(entry.first));
+            file.write((const char*)&levelCount, sizeof(levelCount));
+            for (const LodLevel& level : entry.second)
+            {
+                uint32_t indexCount = (uint32_t)level.indices.size();
+                file.write((const char*)&level.error, sizeof(level.error));
+                file.write((const char*)&indexCount, sizeof(indexCount));
+                file.write((const char*)level.indices.data(), indexCount * sizeof(uint32_t));
+            }
+        }
+
+        if (!file)
+        {
+            logWarning("AssimpModelImporter: Can't write the LOD cache '" + mLodCacheFile + "'");
         }
     }
 
-    VertexLayout::SharedPtr AssimpModelImporter::createVertexLayout(const aiMesh* pAiMesh)
+
+    VertexLayout::SharedPtr AssimpModelImporter::createVertexLayout(const aiMesh* pAiMesh, bool compact)
     {
         static const uint32_t kMaxSupportedUVs = 2;
         // Must have position!!!
@@ -903,7 +1241,7 @@ namespace Falcor
             if (isElementUsed(pAiMesh, location))
             {
                 VertexBufferLayout::SharedPtr pVbLayout = VertexBufferLayout::create();
-                pVbLayout->addElement(kLayoutData[location].name, 0, kLayoutData[location].format, 1, location);
+                pVbLayout->addElement(kLayoutData[location].name, 0, getElementFormat(location, compact), 1, location);
                 pLayout->addBufferLayout(bufferCount, pVbLayout);
                 bufferCount++;
             }
@@ -912,11 +1250,19 @@ namespace Falcor
         return pLayout;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights)
+    Buffer::SharedPtr AssimpModelImporter::createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights, const BoundingBox* pCompactBounds)
     {
         const uint32_t vertexStride = pLayout->getStride();
         std::vector<uint8_t> initData(vertexStride * pAiMesh->mNumVertices, 0);
 
+        vec3 boxMin, boxSize;
+        if (pCompactBounds)
+        {
+            getCompactBounds(*pCompactBounds, boxMin, boxSize);
+        }
+        uint16_t packed[4];
+        int16_t octahedral[2];
+
         for (uint32_t vertexID = 0; vertexID < pAiMesh->mNumVertices; vertexID++)
         {
             uint8_t* pVertex = &initData[vertexStride * vertexID];
@@ -932,14 +1278,35 @@ namespace Falcor
                 switch (location)
                 {
                 case VERTEX_POSITION_LOC:
+                    if (pCompactBounds)
+                    {
+                        MeshOptimizer::quantizePosition(&pAiMesh->mVertices[vertexID].x, &boxMin.x, &boxSize.x, packed);
+                        pSrc = (uint8_t*)packed;
+                        size = sizeof(uint16_t) * 4;
+                        break;
+                    }
                     pSrc = (uint8_t*)(&pAiMesh->mVertices[vertexID]);
                     size = sizeof(pAiMesh->mVertices[0]);
                     break;
                 case VERTEX_NORMAL_LOC:
+                    if (pCompactBounds)
+                    {
+                        MeshOptimizer::encodeOctahedral(&pAiMesh->mNormals[vertexID].x, octahedral);
+                        pSrc = (uint8_t*)octahedral;
+                        size = sizeof(octahedral);
+                        break;
+                    }
                     pSrc = (uint8_t*)(&pAiMesh->mNormals[vertexID]);
                     size = sizeof(pAiMesh->mNormals[0]);
                     break;
                 case VERTEX_BITANGENT_LOC:
+                    if (pCompactBounds)
+                    {
+                        MeshOptimizer::encodeOctahedral(&pAiMesh->mBitangents[vertexID].x, octahedral);
+                        pSrc = (uint8_t*)octahedral;
+                        size = sizeof(octahedral);
+                        break;
+                    }
                     pSrc = (uint8_t*)(&pAiMesh->mBitangents[vertexID]);
                     size = sizeof(pAiMesh->mBitangents[0]);
                     break;
@@ -952,6 +1319,14 @@ namespace Falcor
                     {
                         Falcor::logErrorAndExit("AssimpModelImporter::createVertexBuffer: Texcoord[0].z != 0.0");
                     }
+                    if (pCompactBounds)
+                    {
+                        packed[0] = glm::packHalf1x16(pAiMesh->mTextureCoords[0][vertexID].x);
+                        packed[1] = glm::packHalf1x16(pAiMesh->mTextureCoords[0][vertexID].y);
+                        pSrc = (uint8_t*)packed;
+                        size = sizeof(uint16_t) * 2;
+                        break;
+                    }
                     pSrc = (uint8_t*)(&pAiMesh->mTextureCoords[0][vertexID]);
                     size = sizeof(pAiMesh->mTextureCoords[0][vertexID]);
                     break;
@@ -960,6 +1335,14 @@ namespace Falcor
                     {
                         Falcor::logErrorAndExit("AssimpModelImporter::createVertexBuffer: Texcoord[1].z != 0.0");
                     }
+                    if (pCompactBounds)
+                    {
+                        packed[0] = glm::packHalf1x16(pAiMesh->mTextureCoords[1][vertexID].x);
+                        packed[1] = glm::packHalf1x16(pAiMesh->mTextureCoords[1][vertexID].y);
+                        pSrc = (uint8_t*)packed;
+                        size = sizeof(uint16_t) * 2;
+                        break;
+                    }
                     pSrc = (uint8_t*)(&pAiMesh->mTextureCoords[1][vertexID]);
                     size = sizeof(pAiMesh->mTextureCoords[1][vertexID]);
                     break;
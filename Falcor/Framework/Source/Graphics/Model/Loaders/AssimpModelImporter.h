@@ -86,9 +86,14 @@ namespace Falcor
         Animation::UniquePtr createAnimation(const aiAnimation* pAiAnim);
 
         Mesh::SharedPtr createMesh(const aiMesh* pAiMesh);
-        VertexLayout::SharedPtr createVertexLayout(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createIndexBuffer(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights);
+        void optimizeMesh(const aiMesh* pAiMesh);
+        bool useCompactVertexLayout(const aiMesh* pAiMesh) const;
+        VertexLayout::SharedPtr createVertexLayout(const aiMesh* pAiMesh, bool compact);
+        Buffer::SharedPtr createIndexBuffer(const std::vector<uint32_t>& indices);
+        void generateLods(const aiMesh* pAiMesh, std::vector<uint32_t>& indices, std::vector<Mesh::Lod>& lods);
+        void loadLodCache(const std::string& modelPath);
+        void saveLodCache();
+        Buffer::SharedPtr createVertexBuffer(const aiMesh* pAiMesh, const VertexBufferLayout* pLayout, const uint8_t* pBoneIds, const vec4* pBoneWeights, const BoundingBox* pCompactBounds);
         void loadTextures(const aiMaterial* pAiMaterial, const std::string& folder, Material* pMaterial, bool isObjFile, bool useSrgb);
         Material::SharedPtr createMaterial(const aiMaterial* pAiMaterial, const std::string& folder, bool isObjFile, bool useSrgb);
 
@@ -106,5 +111,26 @@ namespace Falcor
         std::vector<Bone> mBones;
         Model::LoadFlags mFlags;
         std::map<const std::string, Texture::SharedPtr> mTextureCache;
+
+        // Simplified index lists for Model::LoadFlags::GenerateLods, by mesh hash. Kept on disk in mLodCacheFile so that reloading the model doesn't simplify again.
+        struct LodLevel
+        {
+            float error;
+            std::vector<uint32_t> indices;
+        };
+        std::unordered_map<uint64_t, std::vector<LodLevel>> mLodCache;
+        std::string mLodCacheFile;
+        bool mLodCacheDirty = false;
+
+        // Totals over the model's meshes, reported once the model is loaded
+        struct
+        {
+            uint64_t triangleCount = 0;
+            double acmrBefore = 0;          ///< Sum of each triangle mesh's ACMR weighted by its triangle count
+            double acmrAfter = 0;
+            uint64_t vertexCount = 0;
+            uint64_t vertexBytesBefore = 0; ///< Vertex data size with the full-precision layout
+            uint64_t vertexBytesAfter = 0;
+        } mMeshStats;
     };
 }
@@ -86,6 +86,7 @@ namespace Falcor
         }
 
         mPrimitiveCount = mIndexCount / VertsPerPrim;
+        mLods.push_back({ 0, mIndexCount, 0.0f });
 
         mpVao = Vao::create(topology, pLayout, vertexBuffers, pIndexBuffer, ResourceFormat::R32Uint);
     }
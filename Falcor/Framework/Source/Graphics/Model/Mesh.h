@@ -84,6 +84,19 @@ namespace Falcor
         */
         const BoundingBox& getBoundingBox() const { return mBoundingBox; }
 
+        /** Get the object-space length covered by one unit of texture coordinates, averaged over the mesh surface.
+            Used to estimate how many texels a texture needs on screen. 0 if the mesh has no texture coordinates or the importer didn't compute it.
+        */
+        float getUvScale() const { return mUvScale; }
+
+        /** Does the mesh use the compact vertex layout (see Model::LoadFlags::CompactVertexLayout)?
+        */
+        bool hasCompactVertexLayout() const { return mHasCompactVertexLayout; }
+
+        /** Get the transform from the quantized positions stored in the vertex buffer to object space. Identity unless the mesh uses the compact vertex layout.
+        */
+        const glm::mat4& getPositionDequantMatrix() const { return mPositionDequantMat; }
+
         /** Get the number of vertices in the vertex buffer. If you want to draw, use GetIndexCount() instead.
         */
         uint32_t getVertexCount() const { return mVertexCount; }
@@ -96,6 +109,23 @@ namespace Falcor
         */
         uint32_t getIndexCount() const { return mIndexCount; }
 
+        /** A level of detail. Every level indexes the mesh's vertex buffers, and level 0 is the full-detail mesh at the start of the index buffer.
+        */
+        struct Lod
+        {
+            uint32_t firstIndex = 0;    ///< Offset of the level in the index buffer
+            uint32_t indexCount = 0;
+            float error = 0;            ///< Object-space simplification error
+        };
+
+        /** Get the number of levels of detail. 1 unless the model was loaded with Model::LoadFlags::GenerateLods.
+        */
+        uint32_t getLodCount() const { return (uint32_t)mLods.size(); }
+
+        /** Get a level of detail. Levels get coarser as the index grows.
+        */
+        const Lod& getLod(uint32_t lod) const { return mLods[lod]; }
+
         /** Get a pointer to the mesh's material
         */
         const Material::SharedPtr& getMaterial() const { return mpMaterial; }
@@ -148,7 +178,11 @@ namespace Falcor
         uint32_t mIndexCount = 0;
         uint32_t mVertexCount = 0;
         uint32_t mPrimitiveCount = 0;
+        float mUvScale = 0;
         bool mHasBones = false;
+        bool mHasCompactVertexLayout = false;
+        glm::mat4 mPositionDequantMat;
+        std::vector<Lod> mLods;
         Material::SharedPtr mpMaterial;
         BoundingBox mBoundingBox;
         Vao::SharedPtr mpVao;
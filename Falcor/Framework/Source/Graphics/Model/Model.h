@@ -67,6 +67,9 @@ namespace Falcor
             BuffersAsShaderResource     = 0x10,   ///< Generate the VBs and IB with the shader-resource-view bind flag
             RemoveInstancing            = 0x20,   ///< Flatten mesh instances
             UseSpecGlossMaterials       = 0x40,   ///< Set materials to use Spec-Gloss shading model. Otherwise default is Metal-Rough.
+            DontOptimizeMeshes          = 0x80,   ///< Keep the triangle and vertex order of the file. Otherwise triangles are reordered for the vertex cache and overdraw, and vertices for fetch locality.
+            CompactVertexLayout         = 0x100,  ///< Store 16-bit quantized positions, octahedral normals and bitangents, and half-float texture coordinates. Ignored for skinned meshes and with BuffersAsShaderResource, since skinning and ray-tracing shaders read the vertex buffers as floats.
+            GenerateLods                = 0x200,  ///< Generate a chain of simplified index buffers per triangle mesh. SceneRenderer picks one per mesh instance from its projected error. The chain is cached next to the model file.
         };
 
         /** Create a new model from file
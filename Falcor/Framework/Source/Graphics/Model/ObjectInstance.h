@@ -204,6 +204,14 @@ namespace Falcor
             return mPrevFinalTransformMatrix;
         }
 
+        /** Gets a counter that changes every time the transform matrix changes. Lets caches of world-space data skip instances that didn't move.
+        */
+        uint32_t getTransformVersion() const
+        {
+            updateInstanceProperties();
+            return mTransformVersion;
+        }
+
         /** Gets the bounding box
             \return Bounding box
         */
@@ -256,6 +264,7 @@ namespace Falcor
                 mPrevFinalTransformMatrix = mPrevMovable.matrix * mBase.matrix;
 
                 mBoundingBox = mpObject->getBoundingBox().transform(mFinalTransformMatrix);
+                mTransformVersion++;
             }
         }
 
@@ -332,5 +341,6 @@ namespace Falcor
         mutable glm::mat4 mFinalTransformMatrix;
         mutable glm::mat4 mPrevFinalTransformMatrix;
         mutable BoundingBox mBoundingBox;
+        mutable uint32_t mTransformVersion = 0;
     };
 }
@@ -642,9 +642,12 @@ namespace Falcor
             }
         }
 
-        // Allocate the missing sets
+        // Allocate the missing sets.  Sets from another pool than the current one are useless too: a thread recording in parallel with others binds
+        // its own GPU pool (see Device::setThreadAllocators()).
+        const DescriptorPool* pGpuPool = gpDevice->getGpuDescriptorPool().get();
         for (uint32_t i = 0; i < mRootSets.size(); i++)
         {
+            if (mRootSets[i].pSet && mRootSets[i].pSet->getPool() != pGpuPool) mRootSets[i].pSet = nullptr;
             mRootSets[i].dirty = (mRootSets[i].pSet == nullptr);
             if (mRootSets[i].pSet == nullptr)
             {
@@ -38,6 +38,7 @@
 #include "API/RenderContext.h"
 #include "Utils/StringUtils.h"
 #include "ShaderLibrary.h"
+#include <mutex>
 
 namespace Falcor
 {
@@ -615,6 +616,10 @@ namespace Falcor
 
     bool Program::link() const
     {
+        // Programs share the Slang session, and can get linked by passes recording on different threads
+        static std::mutex sLinkMutex;
+        std::lock_guard<std::mutex> lock(sLinkMutex);
+
         while(1)
         {
             // create the program
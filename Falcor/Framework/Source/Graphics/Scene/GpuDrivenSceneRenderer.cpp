@@ -0,0 +1,389 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "GpuDrivenSceneRenderer.h"
+#include "API/RenderContext.h"
+#include "API/Device.h"
+#include "Graphics/Camera/Camera.h"
+
+namespace Falcor
+{
+    static const char* kShaderFilenameCulling = "Data/Framework/Shaders/GpuDrivenCulling.cs.slang";
+    static const char* kCullCbName = "CullCB";
+    static const char* kRecordsName = "gDrivenInstances";
+    static const char* kVisibleName = "gVisibleInstances";
+
+    static const uint32_t kCullGroupSize = 64;  // threads per group
+    static const uint32_t kDrawArgsSize = sizeof(D3D12_DRAW_INDEXED_ARGUMENTS);
+    static const uint32_t kGroupRecordSize = 8; // LOD error, first visible-list slot
+
+    static_assert(kDrawArgsSize == 20, "DRAW_ARGS_SIZE in GpuDrivenCulling.cs.slang is out of date");
+
+    GpuDrivenSceneRenderer::SharedPtr GpuDrivenSceneRenderer::create(const Scene::SharedPtr& pScene)
+    {
+        return SharedPtr(new GpuDrivenSceneRenderer(pScene));
+    }
+
+    GpuDrivenSceneRenderer::GpuDrivenSceneRenderer(const Scene::SharedPtr& pScene) : SceneRenderer(pScene)
+    {
+        static_assert(sizeof(InstanceRecord) == GPU_DRIVEN_INSTANCE_STRIDE, "Instance records don't match the shaders");
+
+        mCullPass.pProgram = ComputeProgram::createFromFile(kShaderFilenameCulling, "main");
+        assert(mCullPass.pProgram);
+        mCullPass.pVars = ComputeVars::create(mCullPass.pProgram->getReflector());
+        mCullPass.pState = ComputeState::create();
+        mCullPass.pState->setProgram(mCullPass.pProgram);
+    }
+
+    bool GpuDrivenSceneRenderer::layoutMatches() const
+    {
+        if (mpScene->getModelCount() != mModels.size()) return false;
+
+        for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            const ModelLayout& model = mModels[modelID];
+            const Model* pModel = mpScene->getModel(modelID).get();
+            if (pModel != model.pModel || mpScene->getModelInstanceCount(modelID) != model.instanceCount) return false;
+
+            uint32_t record = 0;
+            for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+            {
+                for (uint32_t instanceID = 0; instanceID < pModel->getMeshInstanceCount(meshID); instanceID++, record++)
+                {
+                    if (record >= model.meshInstances.size() || pModel->getMeshInstance(meshID, instanceID).get() != model.meshInstances[record]) return false;
+                }
+            }
+            if (record != model.meshInstances.size()) return false;
+
+            for (uint32_t instanceID = 0; instanceID < model.instanceCount; instanceID++)
+            {
+                if (mpScene->getModelInstance(modelID, instanceID).get() != mModelInstances[model.firstInstance + instanceID].pInstance) return false;
+            }
+        }
+        return true;
+    }
+
+    void GpuDrivenSceneRenderer::createLayout(RenderContext* pContext)
+    {
+        mModels.resize(mpScene->getModelCount());
+        mModelInstances.clear();
+        mGroupFirstSlot.clear();
+        std::vector<float> groupErrors;
+        std::vector<D3D12_DRAW_INDEXED_ARGUMENTS> argTemplate;
+        mRecordCount = 0;
+        uint32_t slotCount = 0;
+
+        for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            ModelLayout& model = mModels[modelID];
+            model.pModel = mpScene->getModel(modelID).get();
+            model.firstInstance = (uint32_t)mModelInstances.size();
+            model.instanceCount = mpScene->getModelInstanceCount(modelID);
+            model.meshFirstGroup.clear();
+            model.meshInstanceMesh.clear();
+            model.meshInstances.clear();
+            model.meshInstanceVersions.clear();
+            model.meshInstanceVisible.clear();
+            for (uint32_t meshID = 0; meshID < model.pModel->getMeshCount(); meshID++)
+            {
+                const Mesh* pMesh = model.pModel->getMesh(meshID).get();
+                const uint32_t meshInstanceCount = model.pModel->getMeshInstanceCount(meshID);
+                for (uint32_t instanceID = 0; instanceID < meshInstanceCount; instanceID++)
+                {
+                    const Model::MeshInstance* pMeshInstance = model.pModel->getMeshInstance(meshID, instanceID).get();
+                    model.meshInstanceMesh.push_back(meshID);
+                    model.meshInstances.push_back(pMeshInstance);
+                    model.meshInstanceVersions.push_back(pMeshInstance->getTransformVersion());
+                    model.meshInstanceVisible.push_back(pMeshInstance->isVisible());
+                }
+
+                // Every instance of the mesh may pick the same LOD, so each LOD gets room for all of them
+                model.meshFirstGroup.push_back((uint32_t)mGroupFirstSlot.size());
+                for (uint32_t lod = 0; lod < pMesh->getLodCount(); lod++)
+                {
+                    const Mesh::Lod& meshLod = pMesh->getLod(lod);
+                    mGroupFirstSlot.push_back(slotCount);
+                    groupErrors.push_back(meshLod.error);
+                    argTemplate.push_back({ meshLod.indexCount, 0, meshLod.firstIndex, 0, 0 });
+                    slotCount += model.instanceCount * meshInstanceCount;
+                }
+            }
+
+            for (uint32_t instanceID = 0; instanceID < model.instanceCount; instanceID++)
+            {
+                ModelInstanceLayout instance;
+                instance.pInstance = mpScene->getModelInstance(modelID, instanceID).get();
+                instance.transformVersion = instance.pInstance->getTransformVersion();
+                instance.visible = instance.pInstance->isVisible();
+                instance.firstRecord = mRecordCount;
+                mModelInstances.push_back(instance);
+                mRecordCount += (uint32_t)model.meshInstances.size();
+            }
+        }
+
+        mGroupCount = (uint32_t)mGroupFirstSlot.size();
+        if (mRecordCount == 0) return;
+
+        std::vector<uint32_t> groups(2 * mGroupCount);
+        for (uint32_t i = 0; i < mGroupCount; i++)
+        {
+            groups[2 * i] = glm::floatBitsToUint(groupErrors[i]);
+            groups[2 * i + 1] = mGroupFirstSlot[i];
+        }
+        std::vector<uint32_t> lods(mRecordCount, 0);
+
+        const Resource::BindFlags shaderBindFlags = Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess;
+        mpRecords = Buffer::create(mRecordCount * sizeof(InstanceRecord), Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None);
+        mpGroups = Buffer::create(mGroupCount * kGroupRecordSize, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, groups.data());
+        mpInstanceLods = Buffer::create(mRecordCount * sizeof(uint32_t), shaderBindFlags, Buffer::CpuAccess::None, lods.data());
+        mpVisible = Buffer::create(slotCount * sizeof(uint32_t), shaderBindFlags, Buffer::CpuAccess::None);
+        mpArgTemplate = Buffer::create(mGroupCount * kDrawArgsSize, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, argTemplate.data());
+        mpDrawArgs = Buffer::create(mGroupCount * kDrawArgsSize, Resource::BindFlags::IndirectArg | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
+
+        mCullPass.pVars->setRawBuffer(kRecordsName, mpRecords);
+        mCullPass.pVars->setRawBuffer("gGroups", mpGroups);
+        mCullPass.pVars->setRawBuffer("gInstanceLods", mpInstanceLods);
+        mCullPass.pVars->setRawBuffer(kVisibleName, mpVisible);
+        mCullPass.pVars->setRawBuffer("gDrawArgs", mpDrawArgs);
+
+        for (const ModelLayout& model : mModels)
+        {
+            for (uint32_t i = 0; i < model.instanceCount; i++)
+            {
+                mStats.uploadedInstances += writeModelInstanceRecords(pContext, model, mModelInstances[model.firstInstance + i]);
+            }
+        }
+    }
+
+    uint32_t GpuDrivenSceneRenderer::writeModelInstanceRecords(RenderContext* pContext, const ModelLayout& model, const ModelInstanceLayout& instance)
+    {
+        const uint32_t count = (uint32_t)model.meshInstances.size();
+        if (count == 0) return 0;
+
+        const glm::mat4& transform = instance.pInstance->getTransformMatrix();
+        const glm::mat4& prevTransform = instance.pInstance->getPrevTransformMatrix();
+        mRecordData.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            // Same transforms as SceneRenderer::setPerMeshInstanceData() and bounds as InstanceCuller
+            const Model::MeshInstance* pMeshInstance = model.meshInstances[i];
+            const Mesh* pMesh = pMeshInstance->getObject().get();
+            InstanceRecord& record = mRecordData[i];
+
+            record.worldMat = transform;
+            record.prevWorldMat = prevTransform;
+            if (pMesh->hasBones() == false)
+            {
+                record.worldMat = record.worldMat * pMeshInstance->getTransformMatrix();
+                record.prevWorldMat = record.prevWorldMat * pMeshInstance->getPrevTransformMatrix();
+            }
+            record.worldInvTransposeMat = transpose(inverse(glm::mat3(record.worldMat)));
+            if (pMesh->hasCompactVertexLayout())
+            {
+                record.worldMat = record.worldMat * pMesh->getPositionDequantMatrix();
+                record.prevWorldMat = record.prevWorldMat * pMesh->getPositionDequantMatrix();
+            }
+
+            BoundingBox box = pMeshInstance->getBoundingBox().transform(transform);
+            record.boxCenter = box.center;
+            record.boxExtent = box.extent;
+            record.firstGroup = model.meshFirstGroup[model.meshInstanceMesh[i]];
+            record.lodCount = (instance.visible && model.meshInstanceVisible[i]) ? pMesh->getLodCount() : 0;
+
+            glm::mat4 lodMat = transform * pMeshInstance->getTransformMatrix();
+            record.scale = glm::max(glm::length(glm::vec3(lodMat[0])), glm::max(glm::length(glm::vec3(lodMat[1])), glm::length(glm::vec3(lodMat[2]))));
+        }
+
+        // A model instance's records are contiguous
+        pContext->updateBuffer(mpRecords.get(), mRecordData.data(), instance.firstRecord * sizeof(InstanceRecord), count * sizeof(InstanceRecord));
+        return count;
+    }
+
+    void GpuDrivenSceneRenderer::updateRecords(RenderContext* pContext)
+    {
+        for (ModelLayout& model : mModels)
+        {
+            // A moved or hidden mesh instance changes its records in every instance of the model
+            bool meshInstanceChanged = false;
+            for (uint32_t i = 0; i < model.meshInstances.size(); i++)
+            {
+                uint32_t version = model.meshInstances[i]->getTransformVersion();
+                bool visible = model.meshInstances[i]->isVisible();
+                meshInstanceChanged |= (version != model.meshInstanceVersions[i]) || (visible != model.meshInstanceVisible[i]);
+                model.meshInstanceVersions[i] = version;
+                model.meshInstanceVisible[i] = visible;
+            }
+
+            for (uint32_t i = 0; i < model.instanceCount; i++)
+            {
+                ModelInstanceLayout& instance = mModelInstances[model.firstInstance + i];
+                uint32_t version = instance.pInstance->getTransformVersion();
+                bool visible = instance.pInstance->isVisible();
+                if (meshInstanceChanged || version != instance.transformVersion || visible != instance.visible)
+                {
+                    instance.transformVersion = version;
+                    instance.visible = visible;
+                    mStats.uploadedInstances += writeModelInstanceRecords(pContext, model, instance);
+                }
+            }
+        }
+    }
+
+    void GpuDrivenSceneRenderer::cull(const CurrentWorkingData& currentData)
+    {
+        const Camera* pCamera = currentData.pCamera;
+        ConstantBuffer* pCB = mCullPass.pVars->getConstantBuffer(kCullCbName).get();
+
+        glm::vec4 planes[6];
+        for (uint32_t i = 0; i < 6; i++) planes[i] = pCamera->getFrustumPlane(i);
+        pCB->setVariableArray(pCB->getVariableOffset("gFrustumPlanes[0]"), planes, 6);
+
+        // Pixels covered by one unit at the instance's closest point, as in SceneRenderer::selectMeshInstanceLod()
+        const glm::mat4& proj = pCamera->getProjMatrix();
+        pCB->setVariable("gCameraPos", pCamera->getPosition());
+        pCB->setVariable("gNearZ", pCamera->getNearPlane());
+        pCB->setVariable("gPixelScale", proj[1][1] * 0.5f * currentData.pState->getViewport(0).height);
+        pCB->setVariable("gPerspective", uint32_t(proj[2][3] != 0 ? 1 : 0));
+        pCB->setVariable("gLodThreshold", mLodErrorThreshold);
+        pCB->setVariable("gLodHysteresis", mLodHysteresis);
+        pCB->setVariable("gRecordCount", mRecordCount);
+        pCB->setVariable("gCullEnabled", uint32_t(mCullEnabled ? 1 : 0));
+        pCB->setVariable("gLodEnabled", uint32_t(mLodEnabled ? 1 : 0));
+
+        // Start every draw with no instances
+        RenderContext* pContext = currentData.pContext;
+        pContext->copyBufferRegion(mpDrawArgs.get(), 0, mpArgTemplate.get(), 0, mGroupCount * kDrawArgsSize);
+
+        assert(mRecordCount <= 65535 * kCullGroupSize);
+        pContext->pushComputeState(mCullPass.pState);
+        pContext->pushComputeVars(mCullPass.pVars);
+        pContext->dispatch((mRecordCount + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+        pContext->popComputeVars();
+        pContext->popComputeState();
+    }
+
+    bool GpuDrivenSceneRenderer::isGpuDrivenSupported(const GraphicsVars* pVars) const
+    {
+        const ParameterBlockReflection* pBlock = pVars->getReflection()->getDefaultParameterBlock().get();
+        return pBlock->getResource(kRecordsName) && pBlock->getResource(kVisibleName) && pVars->getConstantBuffer(kPerMeshCbName) && (sFirstVisibleInstanceOffset != ConstantBuffer::kInvalidOffset);
+    }
+
+    void GpuDrivenSceneRenderer::executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex)
+    {
+        if (mDrawIndirect)
+        {
+            currentData.pContext->drawIndexedIndirect(mpDrawArgs.get(), mCurrentGroup * kDrawArgsSize);
+            mStats.drawCommands++;
+        }
+        else
+        {
+            SceneRenderer::executeDraw(currentData, indexCount, instanceCount, startIndex);
+        }
+    }
+
+    void GpuDrivenSceneRenderer::renderScene(CurrentWorkingData& currentData)
+    {
+        mStats.drawCommands = 0;
+        mStats.uploadedInstances = 0;
+        if (isGpuDrivenSupported(currentData.pVars) == false || currentData.pCamera == nullptr)
+        {
+            SceneRenderer::renderScene(currentData);
+            return;
+        }
+
+        setPerFrameData(currentData);
+
+        if (layoutMatches() == false)
+        {
+            createLayout(currentData.pContext);
+        }
+        else
+        {
+            updateRecords(currentData.pContext);
+        }
+        mStats.instances = mRecordCount;
+        if (mRecordCount == 0) return;
+
+        cull(currentData);
+
+        Program* pProgram = currentData.pState->getProgram().get();
+        pProgram->addDefine("_GPU_DRIVEN_INSTANCES");
+        currentData.pVars->setRawBuffer(kRecordsName, mpRecords);
+        currentData.pVars->setRawBuffer(kVisibleName, mpVisible);
+        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kPerMeshCbName).get();
+
+        // One draw per LOD of each mesh. The instances of every model instance are drawn together, so per-model-instance hooks aren't called.
+        mDrawIndirect = true;
+        for (uint32_t modelID = 0; modelID < mModels.size(); modelID++)
+        {
+            const ModelLayout& model = mModels[modelID];
+            if (model.instanceCount == 0) continue;
+
+            currentData.pModel = model.pModel;
+            currentData.modelID = modelID;
+            if (setPerModelData(currentData) == false) continue;
+            mpLastMaterial = nullptr;
+
+            for (uint32_t meshID = 0; meshID < model.pModel->getMeshCount(); meshID++)
+            {
+                const Mesh* pMesh = model.pModel->getMesh(meshID).get();
+                if (model.pModel->getMeshInstanceCount(meshID) == 0 || setPerMeshData(currentData, pMesh) == false) continue;
+
+                bool useVsSkinning = pMesh->hasBones() && !model.pModel->getSkinningCache();
+                if (useVsSkinning)
+                {
+                    pProgram->addDefine("_VERTEX_BLENDING");
+                }
+                if (pMesh->hasCompactVertexLayout())
+                {
+                    pProgram->addDefine("_COMPACT_VERTEX_LAYOUT");
+                }
+                currentData.pState->setVao(useVsSkinning ? pMesh->getVao() : model.pModel->getMeshVao(pMesh));
+                pCB->setVariable(sMeshIdOffset, pMesh->getId());
+
+                for (uint32_t lod = 0; lod < pMesh->getLodCount(); lod++)
+                {
+                    mCurrentGroup = model.meshFirstGroup[meshID] + lod;
+                    pCB->setVariable(sFirstVisibleInstanceOffset, mGroupFirstSlot[mCurrentGroup]);
+                    draw(currentData, pMesh, 0, lod);
+                }
+
+                if (useVsSkinning)
+                {
+                    pProgram->removeDefine("_VERTEX_BLENDING");
+                }
+                if (pMesh->hasCompactVertexLayout())
+                {
+                    pProgram->removeDefine("_COMPACT_VERTEX_LAYOUT");
+                }
+            }
+        }
+        mDrawIndirect = false;
+        pProgram->removeDefine("_GPU_DRIVEN_INSTANCES");
+    }
+}
@@ -0,0 +1,138 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Graphics/Scene/SceneRenderer.h"
+#include "Graphics/Program/ComputeProgram.h"
+#include "Graphics/ComputeState.h"
+#include "Graphics/Program/ProgramVars.h"
+
+namespace Falcor
+{
+    /** Scene renderer which culls and selects LODs on the GPU and draws with ExecuteIndirect.
+        Per-instance data (transforms, world-space bounds, LOD info) lives in a persistent buffer. Only the records of instances which moved or changed visibility are uploaded.
+        Every call to renderScene() dispatches a compute pass which frustum culls the instances, picks their LOD (with the same error metric and hysteresis as SceneRenderer)
+        and appends the visible ones to a list per (mesh, LOD) draw, counting them in that draw's indirect arguments.
+        The CPU then records one indirect draw per mesh LOD of each model, so the number of commands doesn't depend on the number of instances or on the camera.
+
+        Shaders fetch the per-instance data with getInstanceWorldMat() and friends from ShaderCommon.slang, which read the buffers when _GPU_DRIVEN_INSTANCES is defined.
+        gDrawId is the instance's index in the scene rather than the draw order.
+        Programs which don't declare the buffers are drawn like SceneRenderer does.
+    */
+    class GpuDrivenSceneRenderer : public SceneRenderer
+    {
+    public:
+        using SharedPtr = std::shared_ptr<GpuDrivenSceneRenderer>;
+        using SharedConstPtr = std::shared_ptr<const GpuDrivenSceneRenderer>;
+
+        static SharedPtr create(const Scene::SharedPtr& pScene);
+
+        using SceneRenderer::renderScene;
+
+        struct Stats
+        {
+            uint32_t instances = 0;         ///< Mesh instances in the scene
+            uint32_t drawCommands = 0;      ///< Indirect draws recorded by the last renderScene()
+            uint32_t uploadedInstances = 0; ///< Instance records uploaded by the last renderScene()
+        };
+
+        const Stats& getStats() const { return mStats; }
+
+    protected:
+        GpuDrivenSceneRenderer(const Scene::SharedPtr& pScene);
+
+        void renderScene(CurrentWorkingData& currentData) override;
+        void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex) override;
+
+        struct ModelLayout
+        {
+            const Model* pModel;
+            uint32_t firstInstance;                                 ///< In mModelInstances
+            uint32_t instanceCount;
+            std::vector<uint32_t> meshFirstGroup;                   ///< First draw of each mesh. A mesh has one draw per LOD.
+            std::vector<uint32_t> meshInstanceMesh;                 ///< Mesh of each mesh instance, in record order
+            std::vector<const Model::MeshInstance*> meshInstances;  ///< In record order
+            std::vector<uint32_t> meshInstanceVersions;
+            std::vector<bool> meshInstanceVisible;
+        };
+
+        struct ModelInstanceLayout
+        {
+            const Scene::ModelInstance* pInstance;
+            uint32_t transformVersion;
+            bool visible;
+            uint32_t firstRecord;
+        };
+
+        bool layoutMatches() const;
+        void createLayout(RenderContext* pContext);
+        void updateRecords(RenderContext* pContext);
+        uint32_t writeModelInstanceRecords(RenderContext* pContext, const ModelLayout& model, const ModelInstanceLayout& instance);
+        void cull(const CurrentWorkingData& currentData);
+        bool isGpuDrivenSupported(const GraphicsVars* pVars) const;
+
+        std::vector<ModelLayout> mModels;
+        std::vector<ModelInstanceLayout> mModelInstances;
+        uint32_t mRecordCount = 0;
+        uint32_t mGroupCount = 0;
+        std::vector<uint32_t> mGroupFirstSlot;  ///< First slot of each draw in mpVisible
+
+        /** A mesh instance, as GpuDrivenCulling.cs.slang and ShaderCommon.slang read it
+        */
+        struct InstanceRecord
+        {
+            glm::mat4 worldMat;
+            glm::mat4 prevWorldMat;
+            glm::mat3x4 worldInvTransposeMat;
+            glm::vec3 boxCenter;        ///< World space
+            uint32_t firstGroup;        ///< Draw of the mesh's first LOD
+            glm::vec3 boxExtent;
+            uint32_t lodCount;          ///< 0 when the instance is hidden
+            float scale;                ///< Largest axis scale of the instance's transform, for LOD selection
+            uint32_t pad[3];
+        };
+        std::vector<InstanceRecord> mRecordData;    ///< Staging for writeModelInstanceRecords()
+
+        Buffer::SharedPtr mpRecords;        ///< GPU_DRIVEN_INSTANCE_STRIDE bytes per mesh instance
+        Buffer::SharedPtr mpGroups;         ///< LOD error and first visible-list slot of each draw
+        Buffer::SharedPtr mpInstanceLods;   ///< Current LOD of each mesh instance, for the hysteresis
+        Buffer::SharedPtr mpVisible;        ///< Visible mesh instances of each draw
+        Buffer::SharedPtr mpArgTemplate;    ///< Indirect arguments with no instances, copied over mpDrawArgs before culling
+        Buffer::SharedPtr mpDrawArgs;
+
+        struct
+        {
+            ComputeProgram::SharedPtr pProgram;
+            ComputeVars::SharedPtr pVars;
+            ComputeState::SharedPtr pState;
+        } mCullPass;
+
+        bool mDrawIndirect = false;         ///< Whether executeDraw() issues the indirect draw of mCurrentGroup
+        uint32_t mCurrentGroup = 0;
+        Stats mStats;
+    };
+}
@@ -0,0 +1,448 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "InstanceCuller.h"
+#include "Graphics/Camera/Camera.h"
+#include <algorithm>
+#include <cfloat>
+#include <emmintrin.h>
+
+namespace Falcor
+{
+    static const uint32_t kGroupSize = 8;   // Boxes tested per iteration, as two SSE vectors
+    static const float kEmptyExtent = -FLT_MAX;
+
+    // A frustum plane in the form of Camera::isObjectCulled(): a box is inside when dot(center + extent * sign, xyz) > negW
+    struct InstanceCuller::Plane
+    {
+        __m128 xyz[3];
+        __m128 sign[3];
+        __m128 negW;
+        glm::vec3 scalarXyz;
+        glm::vec3 scalarSign;
+        float scalarNegW;
+    };
+
+    InstanceCuller::SharedPtr InstanceCuller::create(bool useBvh)
+    {
+        return SharedPtr(new InstanceCuller(useBvh));
+    }
+
+    bool InstanceCuller::layoutMatches(const Scene* pScene) const
+    {
+        if (pScene->getModelCount() != mModels.size()) return false;
+
+        for (uint32_t modelID = 0; modelID < pScene->getModelCount(); modelID++)
+        {
+            const ModelLayout& model = mModels[modelID];
+            const Model* pModel = pScene->getModel(modelID).get();
+            if (pModel != model.pModel || pScene->getModelInstanceCount(modelID) != model.instanceCount) return false;
+
+            uint32_t box = 0;
+            for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+            {
+                for (uint32_t instanceID = 0; instanceID < pModel->getMeshInstanceCount(meshID); instanceID++, box++)
+                {
+                    if (box >= model.meshInstances.size() || pModel->getMeshInstance(meshID, instanceID).get() != model.meshInstances[box]) return false;
+                }
+            }
+            if (box != model.meshInstances.size()) return false;
+
+            for (uint32_t instanceID = 0; instanceID < model.instanceCount; instanceID++)
+            {
+                if (pScene->getModelInstance(modelID, instanceID).get() != mModelInstances[model.firstInstance + instanceID].pInstance) return false;
+            }
+        }
+        return true;
+    }
+
+    void InstanceCuller::createLayout(const Scene* pScene)
+    {
+        mModels.resize(pScene->getModelCount());
+        mModelInstances.clear();
+        uint32_t boxCount = 0;
+
+        for (uint32_t modelID = 0; modelID < pScene->getModelCount(); modelID++)
+        {
+            ModelLayout& model = mModels[modelID];
+            model.pModel = pScene->getModel(modelID).get();
+            model.firstInstance = (uint32_t)mModelInstances.size();
+            model.instanceCount = pScene->getModelInstanceCount(modelID);
+            model.meshFirstBox.clear();
+            model.meshInstances.clear();
+            model.meshInstanceVersions.clear();
+            for (uint32_t meshID = 0; meshID < model.pModel->getMeshCount(); meshID++)
+            {
+                model.meshFirstBox.push_back((uint32_t)model.meshInstances.size());
+                for (uint32_t instanceID = 0; instanceID < model.pModel->getMeshInstanceCount(meshID); instanceID++)
+                {
+                    const Model::MeshInstance* pMeshInstance = model.pModel->getMeshInstance(meshID, instanceID).get();
+                    model.meshInstances.push_back(pMeshInstance);
+                    model.meshInstanceVersions.push_back(pMeshInstance->getTransformVersion());
+                }
+            }
+
+            for (uint32_t instanceID = 0; instanceID < model.instanceCount; instanceID++)
+            {
+                ModelInstanceLayout instance;
+                instance.pInstance = pScene->getModelInstance(modelID, instanceID).get();
+                instance.transformVersion = instance.pInstance->getTransformVersion();
+                instance.firstBox = boxCount;
+                mModelInstances.push_back(instance);
+                boxCount += (uint32_t)model.meshInstances.size();
+            }
+        }
+
+        resize(boxCount);
+        for (const ModelLayout& model : mModels)
+        {
+            for (uint32_t i = 0; i < model.instanceCount; i++) updateModelInstanceBoxes(model, mModelInstances[model.firstInstance + i]);
+        }
+    }
+
+    void InstanceCuller::updateModelInstanceBoxes(const ModelLayout& model, const ModelInstanceLayout& instance)
+    {
+        const glm::mat4& transform = instance.pInstance->getTransformMatrix();
+        for (uint32_t i = 0; i < model.meshInstances.size(); i++)
+        {
+            setBox(instance.firstBox + i, model.meshInstances[i]->getBoundingBox().transform(transform));
+        }
+    }
+
+    void InstanceCuller::update(const Scene* pScene)
+    {
+        if (layoutMatches(pScene) == false)
+        {
+            createLayout(pScene);
+            return;
+        }
+
+        for (ModelLayout& model : mModels)
+        {
+            // A moved mesh instance moves its boxes in every instance of the model
+            bool meshInstanceMoved = false;
+            for (uint32_t i = 0; i < model.meshInstances.size(); i++)
+            {
+                uint32_t version = model.meshInstances[i]->getTransformVersion();
+                meshInstanceMoved |= (version != model.meshInstanceVersions[i]);
+                model.meshInstanceVersions[i] = version;
+            }
+
+            for (uint32_t i = 0; i < model.instanceCount; i++)
+            {
+                ModelInstanceLayout& instance = mModelInstances[model.firstInstance + i];
+                uint32_t version = instance.pInstance->getTransformVersion();
+                if (meshInstanceMoved || version != instance.transformVersion)
+                {
+                    instance.transformVersion = version;
+                    updateModelInstanceBoxes(model, instance);
+                }
+            }
+        }
+    }
+
+    uint32_t InstanceCuller::getFirstBox(uint32_t modelID, uint32_t modelInstanceID, uint32_t meshID) const
+    {
+        const ModelLayout& model = mModels[modelID];
+        return mModelInstances[model.firstInstance + modelInstanceID].firstBox + model.meshFirstBox[meshID];
+    }
+
+    void InstanceCuller::resize(uint32_t boxCount)
+    {
+        BoundingBox empty;
+        empty.center = glm::vec3(0);
+        empty.extent = glm::vec3(kEmptyExtent);
+        mBoxes.assign(boxCount, empty);
+        mVisible.assign(boxCount, 0);
+        mLods.assign(boxCount, 0);
+        mVisibleBoxes.clear();
+
+        // Reading a group never goes past the padding, wherever it starts
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            mCenter[axis].assign(boxCount + kGroupSize, 0.0f);
+            mExtent[axis].assign(boxCount + kGroupSize, kEmptyExtent);
+        }
+        mOrder.resize(boxCount);
+        mSlot.resize(boxCount);
+        for (uint32_t i = 0; i < boxCount; i++) mOrder[i] = mSlot[i] = i;
+        mNodes.clear();
+        mBvhDirty = true;
+    }
+
+    void InstanceCuller::writeBox(uint32_t slot, const BoundingBox& box)
+    {
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            mCenter[axis][slot] = box.center[axis];
+            mExtent[axis][slot] = box.extent[axis];
+        }
+    }
+
+    void InstanceCuller::setBox(uint32_t index, const BoundingBox& box)
+    {
+        mBoxes[index] = box;
+        writeBox(mSlot[index], box);
+        mRefitNeeded = true;
+    }
+
+    void InstanceCuller::setBvhEnabled(bool enabled)
+    {
+        if (enabled != mUseBvh)
+        {
+            mUseBvh = enabled;
+            mBvhDirty = true;
+        }
+    }
+
+    void InstanceCuller::setNodeBounds(Node& node, const glm::vec3& boxMin, const glm::vec3& boxMax)
+    {
+        if (boxMin.x > boxMax.x)
+        {
+            // Only empty boxes
+            node.center = glm::vec3(0);
+            node.extent = glm::vec3(kEmptyExtent);
+        }
+        else
+        {
+            node.center = (boxMin + boxMax) * 0.5f;
+            node.extent = (boxMax - boxMin) * 0.5f;
+        }
+    }
+
+    uint32_t InstanceCuller::buildNode(uint32_t first, uint32_t count, std::vector<glm::vec3>& centroids)
+    {
+        uint32_t nodeIndex = (uint32_t)mNodes.size();
+        mNodes.push_back({});
+        mNodes[nodeIndex].first = first;
+        mNodes[nodeIndex].count = count;
+        mNodes[nodeIndex].rightChild = 0;
+        if (count <= kLeafSize) return nodeIndex;
+
+        // Median split along the widest axis of the box centers
+        glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            centroidMin = glm::min(centroidMin, centroids[mOrder[i]]);
+            centroidMax = glm::max(centroidMax, centroids[mOrder[i]]);
+        }
+        glm::vec3 size = centroidMax - centroidMin;
+        uint32_t axis = (size.x > size.y && size.x > size.z) ? 0 : ((size.y > size.z) ? 1 : 2);
+
+        uint32_t half = count / 2;
+        std::nth_element(mOrder.begin() + first, mOrder.begin() + first + half, mOrder.begin() + first + count,
+            [&centroids, axis](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+        buildNode(first, half, centroids);
+        uint32_t rightChild = buildNode(first + half, count - half, centroids);
+        mNodes[nodeIndex].rightChild = rightChild;
+        return nodeIndex;
+    }
+
+    void InstanceCuller::buildBvh()
+    {
+        const uint32_t boxCount = getBoxCount();
+        for (uint32_t i = 0; i < boxCount; i++) mOrder[i] = i;
+        mNodes.clear();
+
+        if (mUseBvh && boxCount > 0)
+        {
+            std::vector<glm::vec3> centroids(boxCount);
+            for (uint32_t i = 0; i < boxCount; i++) centroids[i] = mBoxes[i].center;
+            mNodes.reserve(2 * (boxCount / kLeafSize + 1));
+            buildNode(0, boxCount, centroids);
+        }
+
+        for (uint32_t i = 0; i < boxCount; i++)
+        {
+            mSlot[mOrder[i]] = i;
+            writeBox(i, mBoxes[mOrder[i]]);
+        }
+        mBvhDirty = false;
+        mRefitNeeded = true;
+    }
+
+    void InstanceCuller::refitBvh()
+    {
+        // Children are stored after their parent
+        for (size_t n = mNodes.size(); n-- > 0;)
+        {
+            Node& node = mNodes[n];
+            glm::vec3 boxMin(FLT_MAX), boxMax(-FLT_MAX);
+            if (node.rightChild == 0)
+            {
+                for (uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    if (mExtent[0][i] < 0) continue;
+                    glm::vec3 center(mCenter[0][i], mCenter[1][i], mCenter[2][i]);
+                    glm::vec3 extent(mExtent[0][i], mExtent[1][i], mExtent[2][i]);
+                    boxMin = glm::min(boxMin, center - extent);
+                    boxMax = glm::max(boxMax, center + extent);
+                }
+            }
+            else
+            {
+                for (const Node* pChild : { &mNodes[n + 1], &mNodes[node.rightChild] })
+                {
+                    if (pChild->extent.x < 0) continue;
+                    boxMin = glm::min(boxMin, pChild->center - pChild->extent);
+                    boxMax = glm::max(boxMax, pChild->center + pChild->extent);
+                }
+            }
+            setNodeBounds(node, boxMin, boxMax);
+        }
+        mRefitNeeded = false;
+    }
+
+    uint32_t InstanceCuller::testGroup(uint32_t first, const Plane* pPlanes) const
+    {
+        __m128 center[2][3], extent[2][3];
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            center[0][axis] = _mm_loadu_ps(&mCenter[axis][first]);
+            center[1][axis] = _mm_loadu_ps(&mCenter[axis][first + 4]);
+            extent[0][axis] = _mm_loadu_ps(&mExtent[axis][first]);
+            extent[1][axis] = _mm_loadu_ps(&mExtent[axis][first + 4]);
+        }
+
+        __m128 inside[2] = { _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()), _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps()) };
+        for (uint32_t p = 0; p < 6; p++)
+        {
+            const Plane& plane = pPlanes[p];
+            for (uint32_t g = 0; g < 2; g++)
+            {
+                // Same operations in the same order as Camera::isObjectCulled(), so the results match exactly
+                __m128 d = _mm_mul_ps(_mm_add_ps(center[g][0], _mm_mul_ps(extent[g][0], plane.sign[0])), plane.xyz[0]);
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_add_ps(center[g][1], _mm_mul_ps(extent[g][1], plane.sign[1])), plane.xyz[1]));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_add_ps(center[g][2], _mm_mul_ps(extent[g][2], plane.sign[2])), plane.xyz[2]));
+                inside[g] = _mm_and_ps(inside[g], _mm_cmpgt_ps(d, plane.negW));
+            }
+        }
+        return uint32_t(_mm_movemask_ps(inside[0])) | (uint32_t(_mm_movemask_ps(inside[1])) << 4);
+    }
+
+    uint32_t InstanceCuller::cullRange(uint32_t first, uint32_t count, const Plane* pPlanes, uint32_t visibleCount)
+    {
+        uint32_t* pVisible = mVisibleBoxes.data();
+        for (uint32_t group = 0; group < count; group += kGroupSize)
+        {
+            uint32_t mask = testGroup(first + group, pPlanes);
+            uint32_t groupCount = std::min(count - group, kGroupSize);
+            for (uint32_t i = 0; i < groupCount; i++)
+            {
+                // Always write, only advance for visible boxes
+                pVisible[visibleCount] = mOrder[first + group + i];
+                visibleCount += (mask >> i) & 1;
+            }
+        }
+        return visibleCount;
+    }
+
+    const std::vector<uint32_t>& InstanceCuller::cull(const glm::vec4 planes[6])
+    {
+        if (mBvhDirty) buildBvh();
+        if (mRefitNeeded) refitBvh();
+
+        Plane simdPlanes[6];
+        for (uint32_t p = 0; p < 6; p++)
+        {
+            Plane& plane = simdPlanes[p];
+            plane.scalarXyz = glm::vec3(planes[p]);
+            plane.scalarSign = glm::sign(plane.scalarXyz);
+            plane.scalarNegW = -planes[p].w;
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                plane.xyz[axis] = _mm_set1_ps(plane.scalarXyz[axis]);
+                plane.sign[axis] = _mm_set1_ps(plane.scalarSign[axis]);
+            }
+            plane.negW = _mm_set1_ps(plane.scalarNegW);
+        }
+
+        const uint32_t boxCount = getBoxCount();
+        mVisibleBoxes.resize(boxCount + 1);
+        uint32_t visibleCount = 0;
+
+        if (mNodes.empty())
+        {
+            visibleCount = cullRange(0, boxCount, simdPlanes, 0);
+        }
+        else
+        {
+            uint32_t stack[64];
+            uint32_t stackSize = 0;
+            stack[stackSize++] = 0;
+            while (stackSize > 0)
+            {
+                const Node& node = mNodes[stack[--stackSize]];
+
+                // Classify the node against each plane from its nearest and farthest corners
+                bool outside = false;
+                bool contained = true;
+                for (uint32_t p = 0; p < 6 && outside == false; p++)
+                {
+                    const Plane& plane = simdPlanes[p];
+                    glm::vec3 signedExtent = node.extent * plane.scalarSign;
+                    outside = glm::dot(node.center + signedExtent, plane.scalarXyz) <= plane.scalarNegW;
+                    contained = contained && (glm::dot(node.center - signedExtent, plane.scalarXyz) > plane.scalarNegW);
+                }
+                if (outside) continue;
+
+                if (contained)
+                {
+                    // Every non-empty box under the node is visible
+                    for (uint32_t i = node.first; i < node.first + node.count; i++)
+                    {
+                        mVisibleBoxes[visibleCount] = mOrder[i];
+                        visibleCount += (mExtent[0][i] >= 0) ? 1 : 0;
+                    }
+                }
+                else if (node.rightChild == 0)
+                {
+                    visibleCount = cullRange(node.first, node.count, simdPlanes, visibleCount);
+                }
+                else
+                {
+                    stack[stackSize++] = node.rightChild;
+                    stack[stackSize++] = uint32_t(&node - mNodes.data()) + 1;
+                }
+            }
+        }
+
+        mVisibleBoxes.resize(visibleCount);
+        std::fill(mVisible.begin(), mVisible.end(), uint8_t(0));
+        for (uint32_t index : mVisibleBoxes) mVisible[index] = 1;
+        return mVisibleBoxes;
+    }
+
+    const std::vector<uint32_t>& InstanceCuller::cull(const Camera* pCamera)
+    {
+        glm::vec4 planes[6];
+        for (uint32_t p = 0; p < 6; p++) planes[p] = pCamera->getFrustumPlane(p);
+        return cull(planes);
+    }
+}
@@ -0,0 +1,167 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Graphics/Scene/Scene.h"
+#include "Utils/AABB.h"
+#include <vector>
+
+namespace Falcor
+{
+    class Camera;
+
+    /** Frustum culling of scene mesh instances.
+        World-space bounds are kept in structure-of-arrays form and only recomputed for instances whose transform changed (see ObjectInstance::getTransformVersion()).
+        cull() tests 8 boxes per iteration with SSE. It either tests every box, or walks a bounding volume hierarchy over the boxes which skips whole groups
+        outside the frustum and accepts whole groups inside it. Moving boxes refit the hierarchy; it is only rebuilt when boxes are added or removed.
+        The boxes can also be set directly with resize() and setBox(), without a scene.
+    */
+    class InstanceCuller
+    {
+    public:
+        using SharedPtr = std::shared_ptr<InstanceCuller>;
+
+        static const uint32_t kLeafSize = 16;   ///< Maximum number of boxes in a hierarchy leaf
+
+        /** Create a culler
+            \param[in] useBvh Whether to walk a hierarchy over the boxes, or test all of them
+        */
+        static SharedPtr create(bool useBvh = true);
+
+        /** Match the boxes to the mesh instances of a scene. Only instances whose transform changed since the last call are updated.
+            Boxes are in SceneRenderer's order: model, model instance, mesh, mesh instance. Use getFirstBox() to find them.
+        */
+        void update(const Scene* pScene);
+
+        /** Get the box of the first instance of a mesh in a model instance. The mesh's other instances follow it.
+        */
+        uint32_t getFirstBox(uint32_t modelID, uint32_t modelInstanceID, uint32_t meshID) const;
+
+        /** Set the number of boxes. New boxes are empty, always culled and at LOD 0.
+        */
+        void resize(uint32_t boxCount);
+
+        /** Set a world-space box
+        */
+        void setBox(uint32_t index, const BoundingBox& box);
+
+        uint32_t getBoxCount() const { return (uint32_t)mBoxes.size(); }
+
+        /** Get a world-space box
+        */
+        const BoundingBox& getBox(uint32_t index) const { return mBoxes[index]; }
+
+        /** Get or set the LOD a box's mesh instance was last drawn with. Reset to 0 whenever the boxes are rebuilt, so a new scene never sees stale LODs.
+        */
+        uint32_t getLod(uint32_t index) const { return mLods[index]; }
+        void setLod(uint32_t index, uint32_t lod) { mLods[index] = lod; }
+
+        /** Enable or disable the hierarchy
+        */
+        void setBvhEnabled(bool enabled);
+        bool isBvhEnabled() const { return mUseBvh; }
+
+        /** Cull the boxes against the planes of a frustum
+            \param[in] planes Normals pointing inside in xyz and offsets in w, as returned by Camera::getFrustumPlane(). A box is visible when it is at least partially inside all of them.
+            \return The indices of the visible boxes, in no particular order
+        */
+        const std::vector<uint32_t>& cull(const glm::vec4 planes[6]);
+
+        /** Cull the boxes against a camera's frustum. Gives the same result as Camera::isObjectCulled() for every box.
+        */
+        const std::vector<uint32_t>& cull(const Camera* pCamera);
+
+        /** Check whether a box was visible in the last call to cull()
+        */
+        bool isVisible(uint32_t index) const { return mVisible[index] != 0; }
+
+        /** Get the visible boxes found by the last call to cull()
+        */
+        const std::vector<uint32_t>& getVisibleBoxes() const { return mVisibleBoxes; }
+
+    private:
+        InstanceCuller(bool useBvh) : mUseBvh(useBvh) {}
+
+        struct Plane;
+
+        struct Node
+        {
+            glm::vec3 center;
+            glm::vec3 extent;
+            uint32_t first;         ///< First box of the node, in hierarchy order
+            uint32_t count;         ///< Number of boxes under the node
+            uint32_t rightChild;    ///< 0 for leaves. The left child follows its parent.
+        };
+
+        struct ModelLayout
+        {
+            const Model* pModel;
+            uint32_t firstInstance;                                 ///< In mModelInstances
+            uint32_t instanceCount;
+            std::vector<uint32_t> meshFirstBox;                     ///< Relative to the model instance's first box
+            std::vector<const Model::MeshInstance*> meshInstances;  ///< In box order
+            std::vector<uint32_t> meshInstanceVersions;
+        };
+
+        struct ModelInstanceLayout
+        {
+            const Scene::ModelInstance* pInstance;
+            uint32_t transformVersion;
+            uint32_t firstBox;
+        };
+
+        bool layoutMatches(const Scene* pScene) const;
+        void createLayout(const Scene* pScene);
+        void updateModelInstanceBoxes(const ModelLayout& model, const ModelInstanceLayout& instance);
+
+        void buildBvh();
+        uint32_t buildNode(uint32_t first, uint32_t count, std::vector<glm::vec3>& centroids);
+        void refitBvh();
+        void writeBox(uint32_t slot, const BoundingBox& box);
+        void setNodeBounds(Node& node, const glm::vec3& boxMin, const glm::vec3& boxMax);
+        uint32_t testGroup(uint32_t first, const Plane* pPlanes) const;
+        uint32_t cullRange(uint32_t first, uint32_t count, const Plane* pPlanes, uint32_t visibleCount);
+
+        bool mUseBvh;
+        bool mBvhDirty = true;      ///< Boxes were added or removed
+        bool mRefitNeeded = false;  ///< Boxes moved
+
+        std::vector<BoundingBox> mBoxes;
+        std::vector<uint32_t> mOrder;   ///< Box index at each position of the SoA arrays. The hierarchy groups neighbors together.
+        std::vector<uint32_t> mSlot;    ///< Position of each box in the SoA arrays
+        std::vector<float> mCenter[3];  ///< Padded to a whole number of SIMD groups
+        std::vector<float> mExtent[3];
+        std::vector<Node> mNodes;
+
+        std::vector<uint32_t> mVisibleBoxes;
+        std::vector<uint8_t> mVisible;
+        std::vector<uint32_t> mLods;
+
+        std::vector<ModelLayout> mModels;
+        std::vector<ModelInstanceLayout> mModelInstances;
+    };
+}
@@ -48,6 +48,7 @@ namespace Falcor
     size_t SceneRenderer::sWorldInvTransposeMatOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sMeshIdOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sDrawIDOffset = ConstantBuffer::kInvalidOffset;
+    size_t SceneRenderer::sFirstVisibleInstanceOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sLightCountOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sLightArrayOffset = ConstantBuffer::kInvalidOffset;
 
@@ -66,6 +67,7 @@ namespace Falcor
 
     SceneRenderer::SceneRenderer(const Scene::SharedPtr& pScene) : mpScene(pScene)
     {
+        mpCuller = InstanceCuller::create();
         setCameraControllerType(CameraControllerType::SixDof);
     }
 
@@ -91,6 +93,7 @@ namespace Falcor
                 sMeshIdOffset = pType->findMember("gMeshId")->getOffset();
                 sDrawIDOffset = pType->findMember("gDrawId[0]")->getOffset();
                 sPrevWorldMatOffset = pType->findMember("gPrevWorldMat[0]")->getOffset();
+                sFirstVisibleInstanceOffset = pType->findMember("gFirstVisibleInstance")->getOffset();
             }
         }
 
@@ -216,6 +219,14 @@ namespace Falcor
 
             glm::mat3x4 worldInvTransposeMat = transpose(inverse(glm::mat3(worldMat)));
 
+            // Compact meshes store positions relative to their bounds. Normals and bitangents are stored unscaled, so fold the dequantization in after
+            // computing the inverse transpose (DefaultVS rebuilds the bitangent transform from it).
+            if (pMesh->hasCompactVertexLayout())
+            {
+                worldMat = worldMat * pMesh->getPositionDequantMatrix();
+                prevWorldMat = prevWorldMat * pMesh->getPositionDequantMatrix();
+            }
+
             assert(drawInstanceID < sWorldMatArraySize);
             pCB->setBlob(&worldMat, sWorldMatOffset + drawInstanceID * sizeof(glm::mat4), sizeof(glm::mat4));
             pCB->setBlob(&worldInvTransposeMat, sWorldInvTransposeMatOffset + drawInstanceID * sizeof(glm::mat3x4), sizeof(glm::mat3x4)); // HLSL uses column-major and packing rules require 16B alignment, hence use glm:mat3x4
@@ -234,13 +245,13 @@ namespace Falcor
         return true;
     }
 
-    void SceneRenderer::executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount)
+    void SceneRenderer::executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex)
     {
         // Draw
-        currentData.pContext->drawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
+        currentData.pContext->drawIndexedInstanced(indexCount, instanceCount, startIndex, 0, 0);
     }
 
-    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount)
+    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount, uint32_t lod)
     {
         currentData.pMaterial = pMesh->getMaterial().get();
         // Bind material
@@ -258,7 +269,8 @@ namespace Falcor
             }
         }
 
-        executeDraw(currentData, pMesh->getIndexCount(), instanceCount);
+        const Mesh::Lod& meshLod = pMesh->getLod(lod);
+        executeDraw(currentData, meshLod.indexCount, instanceCount, meshLod.firstIndex);
         postFlushDraw(currentData);
         currentData.pState->getProgram()->removeDefine("_MS_STATIC_MATERIAL_FLAGS");
     }
@@ -268,10 +280,42 @@ namespace Falcor
 
     }
 
-    bool SceneRenderer::cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance)
+    bool SceneRenderer::cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t cullBox)
+    {
+        return mpCuller->isVisible(cullBox) == false;
+    }
+
+    uint32_t SceneRenderer::selectMeshInstanceLod(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t cullBox)
     {
+        const Mesh* pMesh = pMeshInstance->getObject().get();
+        if (mLodEnabled == false || pMesh->getLodCount() == 1) return 0;
+
+        // Pixels covered by one object-space unit at the instance's closest point. Perspective projections divide by the distance, orthographic ones don't.
+        glm::mat4 worldMat = pModelInstance->getTransformMatrix() * pMeshInstance->getTransformMatrix();
+        float scale = glm::max(glm::length(glm::vec3(worldMat[0])), glm::max(glm::length(glm::vec3(worldMat[1])), glm::length(glm::vec3(worldMat[2]))));
         BoundingBox box = pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix());
-        return currentData.pCamera->isObjectCulled(box);
+        glm::vec3 offset = glm::max(glm::abs(currentData.pCamera->getPosition() - box.center) - box.extent, glm::vec3(0));
+        float distance = glm::max(glm::length(offset), currentData.pCamera->getNearPlane());
+
+        const glm::mat4& proj = currentData.pCamera->getProjMatrix();
+        float w = (proj[2][3] != 0) ? distance : 1.0f;
+        float pixelsPerUnit = scale * proj[1][1] * 0.5f * currentData.pState->getViewport(0).height / w;
+
+        // The coarsest LOD within the threshold. Coarser than the current LOD needs the extra hysteresis margin.
+        uint32_t currentLod = glm::min(mpCuller->getLod(cullBox), pMesh->getLodCount() - 1);
+        uint32_t lod = 0;
+        for (uint32_t i = pMesh->getLodCount() - 1; i > 0; i--)
+        {
+            float threshold = (i > currentLod) ? mLodErrorThreshold * (1.0f - mLodHysteresis) : mLodErrorThreshold;
+            if (pMesh->getLod(i).error * pixelsPerUnit <= threshold)
+            {
+                lod = i;
+                break;
+            }
+        }
+
+        mpCuller->setLod(cullBox, lod);
+        return lod;
     }
 
     void SceneRenderer::renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID)
@@ -287,11 +331,17 @@ namespace Falcor
             {
                 pProgram->addDefine("_VERTEX_BLENDING");
             }
+            if (pMesh->hasCompactVertexLayout())
+            {
+                pProgram->addDefine("_COMPACT_VERTEX_LAYOUT");
+            }
 
             // Bind VAO and set topology            
             currentData.pState->setVao(useVsSkinning ? pMesh->getVao() : pModel->getMeshVao(pMesh));
 
             uint32_t activeInstances = 0;
+            uint32_t activeLod = 0;
+            const uint32_t firstCullBox = mpCuller->getFirstBox(currentData.modelID, currentData.modelInstanceID, meshID);
 
             const uint32_t instanceCount = pModel->getMeshInstanceCount(meshID);
             for (uint32_t instanceID = 0; instanceID < instanceCount; instanceID++)
@@ -300,8 +350,17 @@ namespace Falcor
 
                 if (pMeshInstance->isVisible())
                 {
-                    if ((mCullEnabled == false) || (cullMeshInstance(currentData, pModelInstance, pMeshInstance) == false))
+                    if ((mCullEnabled == false) || (cullMeshInstance(currentData, pModelInstance, pMeshInstance, firstCullBox + instanceID) == false))
                     {
+                        // Instances drawn together share a LOD, flush the batch when it changes
+                        uint32_t lod = selectMeshInstanceLod(currentData, pModelInstance, pMeshInstance, firstCullBox + instanceID);
+                        if (activeInstances != 0 && lod != activeLod)
+                        {
+                            draw(currentData, pMesh, activeInstances, activeLod);
+                            activeInstances = 0;
+                        }
+                        activeLod = lod;
+
                         if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
                         {
                             currentData.drawID++;
@@ -311,7 +370,7 @@ namespace Falcor
                             {
                                 // DISABLED_FOR_D3D12
                                 //pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
-                                draw(currentData, pMesh, activeInstances);
+                                draw(currentData, pMesh, activeInstances, activeLod);
                                 activeInstances = 0;
                             }
                         }
@@ -320,7 +379,7 @@ namespace Falcor
             }
             if(activeInstances != 0)
             {
-                draw(currentData, pMesh, activeInstances);
+                draw(currentData, pMesh, activeInstances, activeLod);
             }
 
             // Restore the program state
@@ -328,6 +387,10 @@ namespace Falcor
             {
                 pProgram->removeDefine("_VERTEX_BLENDING");
             }
+            if (pMesh->hasCompactVertexLayout())
+            {
+                pProgram->removeDefine("_COMPACT_VERTEX_LAYOUT");
+            }
         }
     }
 
@@ -356,9 +419,18 @@ namespace Falcor
     {
         setPerFrameData(currentData);
 
+        // Cull every mesh instance at once. renderMeshInstances() then only looks the results up.
+        // The boxes are kept up to date even without culling, they also hold the LOD of each mesh instance.
+        mpCuller->update(mpScene.get());
+        if (mCullEnabled)
+        {
+            mpCuller->cull(currentData.pCamera);
+        }
+
         for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
         {
             currentData.pModel = mpScene->getModel(modelID).get();
+            currentData.modelID = modelID;
 
             if (setPerModelData(currentData))
             {
@@ -367,6 +439,7 @@ namespace Falcor
                     const auto pInstance = mpScene->getModelInstance(modelID, instanceID).get();
                     if (pInstance->isVisible())
                     {
+                        currentData.modelInstanceID = instanceID;
                         if (setPerModelInstanceData(currentData, pInstance, instanceID))
                         {
                             renderModelInstance(currentData, pInstance);
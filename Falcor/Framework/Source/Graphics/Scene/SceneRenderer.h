@@ -29,6 +29,7 @@
 #include <vector>
 #include "Utils/Gui.h"
 #include "Graphics/Camera/CameraController.h"
+#include "Graphics/Scene/InstanceCuller.h"
 #include "Graphics/Scene/Scene.h"
 #include "Utils/CpuTimer.h"
 #include "API/ConstantBuffer.h"
@@ -81,6 +82,23 @@ namespace Falcor
         */
         bool isMeshCullingEnabled() const { return mCullEnabled; }
 
+        /** Get the culler which keeps the world-space bounds of the scene's mesh instances. Can be used to disable its hierarchy.
+        */
+        const InstanceCuller::SharedPtr& getInstanceCuller() const { return mpCuller; }
+
+        /** Enable/disable LOD selection for meshes loaded with Model::LoadFlags::GenerateLods. When disabled, meshes are drawn at full detail.
+        */
+        void toggleLodSelection(bool enable) { mLodEnabled = enable; }
+
+        /** Check if LOD selection is enabled
+        */
+        bool isLodSelectionEnabled() const { return mLodEnabled; }
+
+        /** Set how far a mesh instance's LOD may deviate from the full-detail mesh on screen, in pixels.
+            An instance only switches to a coarser LOD once that LOD's error is below (1 - hysteresis) times the threshold, so instances near the threshold don't flicker between levels.
+        */
+        void setLodErrorThreshold(float pixels, float hysteresis = 0.25f) { mLodErrorThreshold = pixels; mLodHysteresis = hysteresis; }
+
         /** Set the maximal number of mesh instance to dispatch in a single draw call.
         */
         void setMaxInstanceCount(uint32_t instanceCount) { mMaxInstanceCount = instanceCount; }
@@ -110,6 +128,8 @@ namespace Falcor
             const Camera* pCamera = nullptr;
             const Model* pModel = nullptr;
             const Material* pMaterial = nullptr;
+            uint32_t modelID = 0;
+            uint32_t modelInstanceID = 0;
 
             uint32_t drawID; // Zero-based mesh instance draw order/ID. Resets at the beginning of renderScene, and increments per mesh instance drawn.
         };
@@ -135,6 +155,7 @@ namespace Falcor
         static size_t sWorldInvTransposeMatOffset;
         static size_t sMeshIdOffset;
         static size_t sDrawIDOffset;
+        static size_t sFirstVisibleInstanceOffset;
 
         static void updateVariableOffsets(const ProgramReflection* pReflector);
 
@@ -144,15 +165,16 @@ namespace Falcor
         virtual bool setPerMeshData(const CurrentWorkingData& currentData, const Mesh* pMesh);
         virtual bool setPerMeshInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t drawInstanceID);
         virtual bool setPerMaterialData(const CurrentWorkingData& currentData, const Material* pMaterial);
-        virtual void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount);
+        virtual void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex);
         virtual void postFlushDraw(const CurrentWorkingData& currentData);
-        virtual bool cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance);
+        virtual bool cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t cullBox);
+        virtual uint32_t selectMeshInstanceLod(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t cullBox);
 
         void renderModelInstance(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance);
         void renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID);
-        void draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount);
+        void draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount, uint32_t lod);
 
-        void renderScene(CurrentWorkingData& currentData);
+        virtual void renderScene(CurrentWorkingData& currentData);
 
         CameraControllerType mCamControllerType = CameraControllerType::SixDof;
         CameraController::SharedPtr mpCameraController;
@@ -160,6 +182,11 @@ namespace Falcor
         uint32_t mMaxInstanceCount = 64;
         const Material* mpLastMaterial = nullptr;
         bool mCullEnabled = true;
+        InstanceCuller::SharedPtr mpCuller;
         bool mCompileMaterialWithProgram = true;
+
+        bool mLodEnabled = true;
+        float mLodErrorThreshold = 1.0f;
+        float mLodHysteresis = 0.25f;   ///< The current LOD of each mesh instance is kept in mpCuller's boxes
     };
 }
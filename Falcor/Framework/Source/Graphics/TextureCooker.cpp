@@ -0,0 +1,292 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TextureCooker.h"
+#include "Utils/BcEncoder.h"
+#include "Utils/Bitmap.h"
+#include "Utils/DDSHeader.h"
+#include "Utils/StringUtils.h"
+#include "glm/gtc/packing.hpp"
+#include <fstream>
+
+namespace Falcor
+{
+    using namespace DdsHelper;
+
+    static bool sEnabled = false;
+    static TextureCooker::Quality sQuality = TextureCooker::Quality::Fast;
+
+    static const uint32_t kDdsMagicNumber = 0x20534444;
+    static const uint32_t kDx10FourCC = 0x30315844;    // "DX10"
+    static const char* kSourceExtensions[] = { "png", "jpg", "jpeg", "tga", "bmp", "hdr", "exr" };
+
+    struct SourceImage
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<float> rgba;                            ///< 4 floats per texel, top row first
+        BcEncoder::Format format = BcEncoder::Format::BC1;
+    };
+
+    static DXFormat getDxFormat(BcEncoder::Format format)
+    {
+        switch (format)
+        {
+        case BcEncoder::Format::BC1: return FORMAT_BC1_UNORM;
+        case BcEncoder::Format::BC3: return FORMAT_BC3_UNORM;
+        case BcEncoder::Format::BC4: return FORMAT_BC4_UNORM;
+        case BcEncoder::Format::BC5: return FORMAT_BC5_UNORM;
+        case BcEncoder::Format::BC6H: return FORMAT_BC6H_UF16;
+        case BcEncoder::Format::BC7: return FORMAT_BC7_UNORM;
+        default:
+            should_not_get_here();
+            return FORMAT_UNKNOWN;
+        }
+    }
+
+    // Load the source image as RGBA floats and pick the format to encode it to
+    static bool loadSourceImage(const std::string& fullpath, TextureCooker::Quality quality, SourceImage& image)
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullpath, true);
+        if (!pBitmap) return false;
+
+        image.width = pBitmap->getWidth();
+        image.height = pBitmap->getHeight();
+        size_t texelCount = size_t(image.width) * image.height;
+        image.rgba.resize(texelCount * 4);
+
+        const uint8_t* pData = pBitmap->getData();
+        bool hasAlpha = false;
+        switch (pBitmap->getFormat())
+        {
+        case ResourceFormat::BGRA8Unorm:
+        case ResourceFormat::BGRX8Unorm:
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                image.rgba[i * 4 + 0] = pData[i * 4 + 2] / 255.0f;
+                image.rgba[i * 4 + 1] = pData[i * 4 + 1] / 255.0f;
+                image.rgba[i * 4 + 2] = pData[i * 4 + 0] / 255.0f;
+                image.rgba[i * 4 + 3] = pData[i * 4 + 3] / 255.0f;
+                hasAlpha |= (pData[i * 4 + 3] != 255);
+            }
+            hasAlpha &= (pBitmap->getFormat() == ResourceFormat::BGRA8Unorm);
+            if (quality == TextureCooker::Quality::High) image.format = BcEncoder::Format::BC7;
+            else image.format = hasAlpha ? BcEncoder::Format::BC3 : BcEncoder::Format::BC1;
+            break;
+        case ResourceFormat::RG8Unorm:
+        case ResourceFormat::R8Unorm:
+        {
+            uint32_t channels = (pBitmap->getFormat() == ResourceFormat::RG8Unorm) ? 2 : 1;
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                image.rgba[i * 4 + 0] = pData[i * channels] / 255.0f;
+                image.rgba[i * 4 + 1] = (channels == 2) ? pData[i * channels + 1] / 255.0f : 0.0f;
+                image.rgba[i * 4 + 2] = 0.0f;
+                image.rgba[i * 4 + 3] = 1.0f;
+            }
+            image.format = (channels == 2) ? BcEncoder::Format::BC5 : BcEncoder::Format::BC4;
+            break;
+        }
+        case ResourceFormat::RGBA32Float:
+        case ResourceFormat::RGB32Float:
+        {
+            uint32_t channels = (pBitmap->getFormat() == ResourceFormat::RGBA32Float) ? 4 : 3;
+            const float* pFloats = reinterpret_cast<const float*>(pData);
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                for (uint32_t c = 0; c < 3; c++) image.rgba[i * 4 + c] = pFloats[i * channels + c];
+                image.rgba[i * 4 + 3] = 1.0f;
+            }
+            image.format = BcEncoder::Format::BC6H;
+            break;
+        }
+        case ResourceFormat::RGBA16Float:
+        case ResourceFormat::RGB16Float:
+        {
+            uint32_t channels = (pBitmap->getFormat() == ResourceFormat::RGBA16Float) ? 4 : 3;
+            const uint16_t* pHalfs = reinterpret_cast<const uint16_t*>(pData);
+            for (size_t i = 0; i < texelCount; i++)
+            {
+                for (uint32_t c = 0; c < 3; c++) image.rgba[i * 4 + c] = glm::unpackHalf1x16(pHalfs[i * channels + c]);
+                image.rgba[i * 4 + 3] = 1.0f;
+            }
+            image.format = BcEncoder::Format::BC6H;
+            break;
+        }
+        default:
+            return false;
+        }
+        return true;
+    }
+
+    // 2x2 box filter. Odd dimensions repeat the last row/column.
+    static std::vector<float> downsample(const std::vector<float>& src, uint32_t width, uint32_t height, uint32_t& newWidth, uint32_t& newHeight)
+    {
+        newWidth = std::max(width / 2, 1u);
+        newHeight = std::max(height / 2, 1u);
+        std::vector<float> dst(size_t(newWidth) * newHeight * 4);
+        for (uint32_t y = 0; y < newHeight; y++)
+        {
+            uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+            for (uint32_t x = 0; x < newWidth; x++)
+            {
+                uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    float sum = src[(size_t(y0) * width + x0) * 4 + c] + src[(size_t(y0) * width + x1) * 4 + c] +
+                                src[(size_t(y1) * width + x0) * 4 + c] + src[(size_t(y1) * width + x1) * 4 + c];
+                    dst[(size_t(y) * newWidth + x) * 4 + c] = sum * 0.25f;
+                }
+            }
+        }
+        return dst;
+    }
+
+    static bool writeDds(const std::string& filename, const SourceImage& image, uint32_t mipCount, const std::vector<uint8_t>& data)
+    {
+        DdsHeader header = {};
+        header.headerSize = sizeof(DdsHeader);
+        header.flags = DdsHeader::kCapsMask | DdsHeader::kHeightMask | DdsHeader::kWidthMask | DdsHeader::kPixelFormatMask | DdsHeader::kMipCountMask | DdsHeader::kLinearSizeMask;
+        header.width = image.width;
+        header.height = image.height;
+        header.linearSize = uint32_t(BcEncoder::getImageSize(image.format, image.width, image.height));
+        header.mipCount = mipCount;
+        header.pixelFormat.structSize = sizeof(DdsHeader::PixelFormat);
+        header.pixelFormat.flags = DdsHeader::PixelFormat::kFourCCFlag;
+        header.pixelFormat.fourCC = kDx10FourCC;
+        header.caps[0] = DdsHeader::kCapsTextureMask | ((mipCount > 1) ? (DdsHeader::kCapsMipMapMask | DdsHeader::kCapsComplexMask) : 0);
+
+        DdsHeaderDX10 dx10Header = {};
+        dx10Header.dxgiFormat = getDxFormat(image.format);
+        dx10Header.resourceDimension = RESOURCE_DIMENSION_TEXTURE2D;
+        dx10Header.arraySize = 1;
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(&kDdsMagicNumber), sizeof(kDdsMagicNumber));
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&dx10Header), sizeof(dx10Header));
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        return file.good();
+    }
+
+    void TextureCooker::setEnabled(bool enabled)
+    {
+        sEnabled = enabled;
+    }
+
+    bool TextureCooker::isEnabled()
+    {
+        return sEnabled;
+    }
+
+    void TextureCooker::setQuality(Quality quality)
+    {
+        sQuality = quality;
+    }
+
+    TextureCooker::Quality TextureCooker::getQuality()
+    {
+        return sQuality;
+    }
+
+    std::string TextureCooker::getCacheFilename(const std::string& fullpath, Quality quality)
+    {
+        return fullpath + ((quality == Quality::High) ? ".bchq.dds" : ".bc.dds");
+    }
+
+    std::string TextureCooker::getCookedFile(const std::string& filename, Quality quality)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false) return "";
+
+        std::string cacheFile = getCacheFilename(fullpath, quality);
+        if (doesFileExist(cacheFile) && getFileModifiedTime(cacheFile) >= getFileModifiedTime(fullpath))
+        {
+            return cacheFile;
+        }
+        return cook(fullpath, quality);
+    }
+
+    std::string TextureCooker::cook(const std::string& filename, Quality quality)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false) return "";
+
+        SourceImage image;
+        if (loadSourceImage(fullpath, quality, image) == false) return "";
+
+        // D3D requires the top level of a block-compressed texture to be made of whole blocks
+        if ((image.width % 4) || (image.height % 4))
+        {
+            logWarning("TextureCooker: " + filename + " is " + std::to_string(image.width) + "x" + std::to_string(image.height) + ", which is not a multiple of 4. Not cooking it.");
+            return "";
+        }
+
+        // Encode the full mip chain, mip 0 first
+        std::vector<uint8_t> data;
+        std::vector<float> level = image.rgba;
+        uint32_t width = image.width, height = image.height;
+        uint32_t mipCount = 0;
+        while (true)
+        {
+            size_t offset = data.size();
+            data.resize(offset + BcEncoder::getImageSize(image.format, width, height));
+            BcEncoder::encodeImage(image.format, level.data(), width, height, data.data() + offset);
+            mipCount++;
+
+            if (width == 1 && height == 1) break;
+            level = downsample(level, width, height, width, height);
+        }
+
+        std::string cacheFile = getCacheFilename(fullpath, quality);
+        if (writeDds(cacheFile, image, mipCount, data) == false)
+        {
+            logWarning("TextureCooker: Can't write " + cacheFile);
+            return "";
+        }
+        return cacheFile;
+    }
+
+    uint32_t TextureCooker::cookDirectory(const std::string& directory, Quality quality, bool force)
+    {
+        uint32_t count = 0;
+        for (const char* ext : kSourceExtensions)
+        {
+            std::vector<std::string> files;
+            enumerateFiles(directory + "/*." + ext, files);
+            for (const auto& file : files)
+            {
+                std::string fullpath = directory + "/" + file;
+                std::string cooked = force ? cook(fullpath, quality) : getCookedFile(fullpath, quality);
+                if (cooked.size()) count++;
+            }
+        }
+        return count;
+    }
+}
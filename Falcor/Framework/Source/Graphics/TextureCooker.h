@@ -0,0 +1,84 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+
+namespace Falcor
+{
+    /** Converts source images (PNG, JPG, TGA, HDR, EXR...) to block-compressed DDS files with a pre-built mip chain.
+        The result is cached next to the source and reused for as long as it is newer than the source.
+        The format is chosen from the source:
+        - HDR images use BC6H
+        - One and two channel images use BC4 and BC5
+        - Color images use BC1 (opaque) or BC3 (with alpha) in Quality::Fast, BC7 in Quality::High
+        When enabled, createTextureFromFile() loads cooked images instead of the sources, cooking them on first use. This skips
+        the image decode and the GPU mip generation, and the textures take 4-8x less memory.
+    */
+    class TextureCooker
+    {
+    public:
+        enum class Quality
+        {
+            Fast,   ///< BC1/BC3 for color images
+            High,   ///< BC7 for color images
+        };
+
+        /** Enable or disable loading cooked images in createTextureFromFile(). Disabled by default.
+        */
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+
+        /** Set the quality createTextureFromFile() cooks images with
+        */
+        static void setQuality(Quality quality);
+        static Quality getQuality();
+
+        /** Get the filename of the cooked version of an image
+        */
+        static std::string getCacheFilename(const std::string& fullpath, Quality quality);
+
+        /** Get the cooked version of an image, cooking it if the cache is missing or older than the source.
+            \param[in] filename Source image. Can be relative to a data directory.
+            \param[in] quality The quality to cook with
+            \return The full path of the cooked DDS file, or an empty string if the image can't be cooked (unknown format, dimensions not a multiple of 4...)
+        */
+        static std::string getCookedFile(const std::string& filename, Quality quality);
+
+        /** Cook an image, even if the cache is valid. Same return value as getCookedFile().
+        */
+        static std::string cook(const std::string& filename, Quality quality);
+
+        /** Cook all the images in a directory.
+            \param[in] directory The directory to search
+            \param[in] quality The quality to cook with
+            \param[in] force Cook images even if their cache is valid
+            \return The number of images cooked
+        */
+        static uint32_t cookDirectory(const std::string& directory, Quality quality, bool force = false);
+    };
+}
@@ -27,12 +27,15 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "TextureHelper.h"
+#include "TextureCooker.h"
+#include "TextureStreamer.h"
 #include "API/Texture.h"
 #include "Utils/Bitmap.h"
 #include "Utils/DDSHeader.h"
 #include "Utils/BinaryFileStream.h"
 #include "Utils/StringUtils.h"
 #include <cstring>
+#include <fstream>
 
 static const bool kTopDown = true;
 
@@ -697,6 +700,68 @@ namespace Falcor
         return nullptr;
     }
 
+    bool readDdsMipChain(const std::string& filename, bool loadAsSrgb, DdsMipChain& chain)
+    {
+        if (findFileInDataDirectories(filename, chain.fullpath) == false) return false;
+
+        std::ifstream file(chain.fullpath, std::ios::binary);
+        uint32_t magic = 0;
+        DdsData ddsData;
+        file.read((char*)&magic, sizeof(magic));
+        file.read((char*)&ddsData.header, sizeof(ddsData.header));
+        if (!file || magic != kDdsMagicNumber) return false;
+
+        uint64_t dataOffset = sizeof(magic) + sizeof(ddsData.header);
+        ddsData.hasDX10Header = (ddsData.header.pixelFormat.flags & DdsHeader::PixelFormat::kFourCCFlag) && (makeFourCC("DX10") == ddsData.header.pixelFormat.fourCC);
+        if (ddsData.hasDX10Header)
+        {
+            file.read((char*)&ddsData.dx10Header, sizeof(ddsData.dx10Header));
+            if (!file) return false;
+            dataOffset += sizeof(ddsData.dx10Header);
+
+            if (ddsData.dx10Header.resourceDimension != RESOURCE_DIMENSION_TEXTURE2D || ddsData.dx10Header.arraySize != 1 || (ddsData.dx10Header.miscFlag & DdsHeaderDX10::kCubeMapMask)) return false;
+        }
+        else if ((ddsData.header.flags & DdsHeader::kDepthMask) || (ddsData.header.caps[1] & DdsHeader::kCaps2CubeMapMask))
+        {
+            return false;
+        }
+
+        chain.format = getDdsResourceFormat(ddsData);
+        if (chain.format == ResourceFormat::Unknown || chain.format == ResourceFormat::BGRX8Unorm || chain.format == ResourceFormat::BGRX8UnormSrgb) return false;
+        if (loadAsSrgb) chain.format = linearToSrgbFormat(chain.format);
+
+        chain.width = ddsData.header.width;
+        chain.height = ddsData.header.height;
+        chain.mipCount = (ddsData.header.flags & DdsHeader::kMipCountMask) ? max(ddsData.header.mipCount, 1U) : 1;
+        chain.mipOffsets.resize(chain.mipCount + 1);
+        chain.mipOffsets[0] = dataOffset;
+
+        uint32_t blockWidth = getFormatWidthCompressionRatio(chain.format);
+        uint32_t blockHeight = getFormatHeightCompressionRatio(chain.format);
+        for (uint32_t mip = 0; mip < chain.mipCount; mip++)
+        {
+            uint64_t blocksX = (max(chain.width >> mip, 1U) + blockWidth - 1) / blockWidth;
+            uint64_t blocksY = (max(chain.height >> mip, 1U) + blockHeight - 1) / blockHeight;
+            chain.mipOffsets[mip + 1] = chain.mipOffsets[mip] + blocksX * blocksY * getFormatBytesPerBlock(chain.format);
+        }
+
+        // Make sure the file actually holds all the mips
+        file.seekg(0, std::ios::end);
+        return uint64_t(file.tellg()) >= chain.mipOffsets[chain.mipCount];
+    }
+
+    bool readDdsMips(const DdsMipChain& chain, uint32_t firstMip, uint32_t mipCount, std::vector<uint8_t>& data)
+    {
+        assert(firstMip + mipCount <= chain.mipCount);
+        uint64_t offset = chain.mipOffsets[firstMip];
+        data.resize(size_t(chain.mipOffsets[firstMip + mipCount] - offset));
+
+        std::ifstream file(chain.fullpath, std::ios::binary);
+        file.seekg(offset);
+        file.read((char*)data.data(), data.size());
+        return file.good();
+    }
+
     Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
     {
 #define no_srgb()   \
@@ -705,14 +770,29 @@ namespace Falcor
         logWarning("createTexture2DFromFile() warning. " + std::to_string(pBitmap->getBytesPerPixel()) + " channel images doesn't have a matching sRGB format. Loading in linear space.");  \
     }
 
+        // Streamed textures only get their low-resolution mips here. The TextureStreamer loads the rest when they're needed.
+        const bool canStream = TextureStreamer::isEnabled() && generateMipLevels && bindFlags == Texture::BindFlags::ShaderResource;
+
         Texture::SharedPtr pTex;
         if (hasSuffix(filename, ".dds"))
         {
-            pTex = createTextureFromDDSFile(filename, generateMipLevels, loadAsSrgb, bindFlags);
+            if (canStream) pTex = TextureStreamer::createTailTexture(filename, loadAsSrgb, bindFlags);
+            if (pTex == nullptr) pTex = createTextureFromDDSFile(filename, generateMipLevels, loadAsSrgb, bindFlags);
         }
         else
         {
-            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, kTopDown);
+            // Cooked images come with their full mip chain, so only use them when mips were requested
+            if (TextureCooker::isEnabled() && generateMipLevels && bindFlags == Texture::BindFlags::ShaderResource)
+            {
+                std::string cookedFile = TextureCooker::getCookedFile(filename, TextureCooker::getQuality());
+                if (cookedFile.size())
+                {
+                    if (canStream) pTex = TextureStreamer::createTailTexture(cookedFile, loadAsSrgb, bindFlags);
+                    if (pTex == nullptr) pTex = createTextureFromDDSFile(cookedFile, true, loadAsSrgb, bindFlags);
+                }
+            }
+
+            Bitmap::UniqueConstPtr pBitmap = pTex ? nullptr : Bitmap::createFromFile(filename, kTopDown);
             if(pBitmap)
             {
                 ResourceFormat texFormat = pBitmap->getFormat();
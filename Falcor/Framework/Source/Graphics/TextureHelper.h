@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include <string>
+#include <vector>
 #include "API/Texture.h"
 namespace Falcor
 {
@@ -43,5 +44,34 @@ namespace Falcor
     */
     Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
 
+    /** Mip layout of a DDS file holding a single 2D texture. Used to load a subset of the mips.
+    */
+    struct DdsMipChain
+    {
+        std::string fullpath;
+        ResourceFormat format = ResourceFormat::Unknown;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipCount = 0;
+        std::vector<uint64_t> mipOffsets;   ///< File offset of each mip, plus one extra entry for the end of the last mip
+
+        /** Number of bytes used by mips [firstMip, mipCount)
+        */
+        uint64_t getSize(uint32_t firstMip) const { return mipOffsets[mipCount] - mipOffsets[firstMip]; }
+    };
+
+    /** Read the header of a DDS file.
+        \param[in] filename Filename of the image. Can also include a full path or relative path from a data directory
+        \param[in] loadAsSrgb Use the sRGB version of the format
+        \param[out] chain The mip layout
+        eturn false if the file can't be read, or doesn't hold a single 2D texture which can be used as-is (cubemaps, arrays, volumes, formats which need conversion)
+    */
+    bool readDdsMipChain(const std::string& filename, bool loadAsSrgb, DdsMipChain& chain);
+
+    /** Read mips [firstMip, firstMip + mipCount) of a DDS file. Thread-safe.
+        \param[out] data Tightly packed texels, most detailed mip first. Can be passed as the initial data to Texture::create2D().
+    */
+    bool readDdsMips(const DdsMipChain& chain, uint32_t firstMip, uint32_t mipCount, std::vector<uint8_t>& data);
+
     /*! @} */
 }
\ No newline at end of file
@@ -0,0 +1,402 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TextureStreamer.h"
+#include "TextureCooker.h"
+#include "API/RenderContext.h"
+#include "Graphics/Camera/Camera.h"
+#include "Utils/StringUtils.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <unordered_set>
+
+namespace Falcor
+{
+    static bool sEnabled = false;
+
+    // D3D requires the most detailed mip of a block-compressed texture to be made of whole blocks
+    static bool isValidTopMip(const DdsMipChain& chain, uint32_t mip)
+    {
+        uint32_t width = max(chain.width >> mip, 1U);
+        uint32_t height = max(chain.height >> mip, 1U);
+        return (width % getFormatWidthCompressionRatio(chain.format) == 0) && (height % getFormatHeightCompressionRatio(chain.format) == 0);
+    }
+
+    // Closest mip at or above 'mip' (more detailed) which can be the top of a texture
+    static uint32_t getValidTopMip(const DdsMipChain& chain, uint32_t mip)
+    {
+        while (mip > 0 && isValidTopMip(chain, mip) == false) mip--;
+        return mip;
+    }
+
+    static uint32_t getTailMip(const DdsMipChain& chain)
+    {
+        uint32_t mip = 0;
+        while (mip + 1 < chain.mipCount && max(chain.width >> mip, chain.height >> mip) > TextureStreamer::kTailSize) mip++;
+        return getValidTopMip(chain, mip);
+    }
+
+    TextureStreamer::SharedPtr TextureStreamer::create(uint64_t budgetBytes)
+    {
+        return SharedPtr(new TextureStreamer(budgetBytes));
+    }
+
+    TextureStreamer::TextureStreamer(uint64_t budgetBytes)
+    {
+        mStats.budgetBytes = budgetBytes;
+    }
+
+    TextureStreamer::~TextureStreamer() = default;
+
+    void TextureStreamer::setEnabled(bool enabled)
+    {
+        sEnabled = enabled;
+    }
+
+    bool TextureStreamer::isEnabled()
+    {
+        return sEnabled;
+    }
+
+    Texture::SharedPtr TextureStreamer::createTailTexture(const std::string& filename, bool loadAsSrgb, Texture::BindFlags bindFlags)
+    {
+        DdsMipChain chain;
+        if (readDdsMipChain(filename, loadAsSrgb, chain) == false) return nullptr;
+
+        uint32_t tailMip = getTailMip(chain);
+        if (tailMip == 0) return nullptr;
+
+        std::vector<uint8_t> data;
+        if (readDdsMips(chain, tailMip, chain.mipCount - tailMip, data) == false) return nullptr;
+        return Texture::create2D(max(chain.width >> tailMip, 1U), max(chain.height >> tailMip, 1U), chain.format, 1, chain.mipCount - tailMip, data.data(), bindFlags);
+    }
+
+    Texture::SharedPtr TextureStreamer::getTexture(const Material* pMaterial, Slot slot)
+    {
+        switch (slot)
+        {
+        case Slot::BaseColor: return pMaterial->getBaseColorTexture();
+        case Slot::Specular: return pMaterial->getSpecularTexture();
+        case Slot::Emissive: return pMaterial->getEmissiveTexture();
+        case Slot::NormalMap: return pMaterial->getNormalMap();
+        case Slot::OcclusionMap: return pMaterial->getOcclusionMap();
+        case Slot::LightMap: return pMaterial->getLightMap();
+        case Slot::HeightMap: return pMaterial->getHeightMap();
+        default:
+            should_not_get_here();
+            return nullptr;
+        }
+    }
+
+    void TextureStreamer::setTexture(Material* pMaterial, Slot slot, Texture::SharedPtr pTexture)
+    {
+        switch (slot)
+        {
+        case Slot::BaseColor: pMaterial->setBaseColorTexture(pTexture); break;
+        case Slot::Specular: pMaterial->setSpecularTexture(pTexture); break;
+        case Slot::Emissive: pMaterial->setEmissiveTexture(pTexture); break;
+        case Slot::NormalMap: pMaterial->setNormalMap(pTexture); break;
+        case Slot::OcclusionMap: pMaterial->setOcclusionMap(pTexture); break;
+        case Slot::LightMap: pMaterial->setLightMap(pTexture); break;
+        case Slot::HeightMap: pMaterial->setHeightMap(pTexture); break;
+        default:
+            should_not_get_here();
+        }
+    }
+
+    void TextureStreamer::setScene(const Scene::SharedPtr& pScene)
+    {
+        mpScene = pScene;
+        mTextures.clear();
+        mMeshTextures.clear();
+        mPendingBytes = 0;
+        uint64_t budgetBytes = mStats.budgetBytes;
+        mStats = Stats();
+        mStats.budgetBytes = budgetBytes;
+        if (pScene == nullptr) return;
+
+        std::unordered_map<const Texture*, uint32_t> textureIndices;
+        std::unordered_set<const Texture*> ignored;
+
+        for (uint32_t modelID = 0; modelID < pScene->getModelCount(); modelID++)
+        {
+            const Model* pModel = pScene->getModel(modelID).get();
+            for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+            {
+                const Mesh* pMesh = pModel->getMesh(meshID).get();
+                const Material::SharedPtr& pMaterial = pMesh->getMaterial();
+                if (pMaterial == nullptr) continue;
+
+                for (uint32_t slot = 0; slot < (uint32_t)Slot::Count; slot++)
+                {
+                    Texture::SharedPtr pTexture = getTexture(pMaterial.get(), (Slot)slot);
+                    if (pTexture == nullptr || ignored.count(pTexture.get())) continue;
+
+                    auto it = textureIndices.find(pTexture.get());
+                    if (it == textureIndices.end())
+                    {
+                        // Find the DDS file the texture was loaded from
+                        std::string filename = pTexture->getSourceFilename();
+                        if (hasSuffix(filename, ".dds") == false)
+                        {
+                            std::string fullpath;
+                            if (TextureCooker::isEnabled() == false || findFileInDataDirectories(filename, fullpath) == false) filename.clear();
+                            else filename = TextureCooker::getCacheFilename(fullpath, TextureCooker::getQuality());
+                        }
+
+                        StreamedTexture tex;
+                        bool streamable = filename.size() && readDdsMipChain(filename, isSrgbFormat(pTexture->getFormat()), tex.chain);
+                        streamable = streamable && tex.chain.format == pTexture->getFormat() && pTexture->getArraySize() == 1 && pTexture->getMipCount() <= tex.chain.mipCount;
+                        if (streamable)
+                        {
+                            tex.residentMip = tex.chain.mipCount - pTexture->getMipCount();
+                            tex.tailMip = std::max(getTailMip(tex.chain), tex.residentMip);
+                            streamable = (max(tex.chain.width >> tex.residentMip, 1U) == pTexture->getWidth()) && (tex.tailMip > 0);
+                        }
+                        if (streamable == false)
+                        {
+                            ignored.insert(pTexture.get());
+                            continue;
+                        }
+
+                        tex.pTexture = pTexture;
+                        tex.requiredMip = tex.tailMip;
+                        mStats.residentBytes += tex.chain.getSize(tex.residentMip);
+                        it = textureIndices.emplace(pTexture.get(), (uint32_t)mTextures.size()).first;
+                        mTextures.push_back(std::move(tex));
+                    }
+
+                    StreamedTexture& tex = mTextures[it->second];
+                    auto use = std::find_if(tex.uses.begin(), tex.uses.end(), [&](const Use& u) { return u.pMaterial == pMaterial && u.slot == (Slot)slot; });
+                    if (use == tex.uses.end()) tex.uses.push_back({ pMaterial, (Slot)slot });
+
+                    std::vector<uint32_t>& meshTextures = mMeshTextures[pMesh];
+                    if (std::find(meshTextures.begin(), meshTextures.end(), it->second) == meshTextures.end()) meshTextures.push_back(it->second);
+                }
+            }
+        }
+        mStats.textureCount = (uint32_t)mTextures.size();
+    }
+
+    void TextureStreamer::update(RenderContext* pContext, const Camera* pCamera, uint32_t viewportHeight)
+    {
+        if (mTextures.empty()) return;
+        mFrame++;
+
+        if (pCamera) estimateRequiredMips(pCamera, viewportHeight);
+        completeRequests(pContext);
+        issueRequests(pContext);
+    }
+
+    void TextureStreamer::estimateRequiredMips(const Camera* pCamera, uint32_t viewportHeight)
+    {
+        for (auto& tex : mTextures)
+        {
+            tex.requiredMip = tex.tailMip;
+            tex.distance = FLT_MAX;
+        }
+
+        // Pixels covered by a unit length at unit distance
+        const float pixelsPerUnit = float(viewportHeight) * pCamera->getFocalLength() / pCamera->getFrameHeight();
+        const vec3 eyePos = pCamera->getPosition();
+
+        for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            const Model* pModel = mpScene->getModel(modelID).get();
+            for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+            {
+                const Scene::ModelInstance* pModelInstance = mpScene->getModelInstance(modelID, instanceID).get();
+                for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+                {
+                    const Mesh* pMesh = pModel->getMesh(meshID).get();
+                    auto meshTextures = mMeshTextures.find(pMesh);
+                    if (meshTextures == mMeshTextures.end()) continue;
+
+                    for (uint32_t meshInstanceID = 0; meshInstanceID < pModel->getMeshInstanceCount(meshID); meshInstanceID++)
+                    {
+                        const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, meshInstanceID).get();
+                        BoundingBox box = pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix());
+                        if (pCamera->isObjectCulled(box)) continue;
+
+                        // Closest point of the box. The mesh might be closer than that, but never further.
+                        vec3 offset = max(abs(eyePos - box.center) - box.extent, vec3(0));
+                        float distance = std::max(length(offset), pCamera->getNearPlane());
+
+                        // World-space length of one unit of texture coordinates. Without UV information, assume the texture covers the mesh once.
+                        mat4 worldMat = pModelInstance->getTransformMatrix() * pMeshInstance->getTransformMatrix();
+                        float scale = std::max(length(vec3(worldMat[0])), std::max(length(vec3(worldMat[1])), length(vec3(worldMat[2]))));
+                        float uvLength = (pMesh->getUvScale() > 0) ? pMesh->getUvScale() * scale : length(box.extent) * 2.0f;
+                        float pixelsPerUv = uvLength * pixelsPerUnit / distance;
+
+                        for (uint32_t index : meshTextures->second)
+                        {
+                            StreamedTexture& tex = mTextures[index];
+                            float texelsPerUv = float(std::max(tex.chain.width, tex.chain.height));
+                            float mip = std::log2(texelsPerUv / pixelsPerUv) + mMipBias;
+                            uint32_t requiredMip = (mip <= 0) ? 0 : std::min(uint32_t(mip), tex.tailMip);
+
+                            tex.requiredMip = getValidTopMip(tex.chain, std::min(tex.requiredMip, requiredMip));
+                            tex.distance = std::min(tex.distance, distance);
+                            tex.lastUsedFrame = mFrame;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void TextureStreamer::setResidentMip(RenderContext* pContext, StreamedTexture& tex, uint32_t firstMip, const std::vector<uint8_t>* pNewMips)
+    {
+        const DdsMipChain& chain = tex.chain;
+        assert(firstMip != tex.residentMip && isValidTopMip(chain, firstMip));
+        assert(firstMip > tex.residentMip || pNewMips);
+
+        Texture::SharedPtr pTexture = Texture::create2D(max(chain.width >> firstMip, 1U), max(chain.height >> firstMip, 1U), chain.format, 1, chain.mipCount - firstMip, nullptr, tex.pTexture->getBindFlags());
+        for (uint32_t mip = firstMip; mip < chain.mipCount; mip++)
+        {
+            uint32_t dstSubresource = pTexture->getSubresourceIndex(0, mip - firstMip);
+            if (mip < tex.residentMip)
+            {
+                pContext->updateSubresourceData(pTexture.get(), dstSubresource, pNewMips->data() + (chain.mipOffsets[mip] - chain.mipOffsets[firstMip]));
+            }
+            else
+            {
+                pContext->copySubresource(pTexture.get(), dstSubresource, tex.pTexture.get(), tex.pTexture->getSubresourceIndex(0, mip - tex.residentMip));
+            }
+        }
+        pTexture->setSourceFilename(tex.pTexture->getSourceFilename());
+
+        for (auto& use : tex.uses)
+        {
+            setTexture(use.pMaterial.get(), use.slot, pTexture);
+        }
+
+        mStats.residentBytes = mStats.residentBytes - chain.getSize(tex.residentMip) + chain.getSize(firstMip);
+        tex.pTexture = pTexture;
+        tex.residentMip = firstMip;
+    }
+
+    void TextureStreamer::completeRequests(RenderContext* pContext)
+    {
+        for (auto& tex : mTextures)
+        {
+            if (tex.pRequest == nullptr || tex.pRequest->data.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+
+            uint32_t firstMip = tex.pRequest->firstMip;
+            std::vector<uint8_t> data = tex.pRequest->data.get();
+            tex.pRequest = nullptr;
+            mPendingBytes -= tex.chain.getSize(firstMip) - tex.chain.getSize(tex.residentMip);
+
+            if (data.empty())
+            {
+                logWarning("TextureStreamer: Can't read " + tex.chain.fullpath);
+                continue;
+            }
+            mStats.loadedBytes += data.size();
+            setResidentMip(pContext, tex, firstMip, &data);
+        }
+    }
+
+    bool TextureStreamer::evict(RenderContext* pContext, uint64_t bytes, const StreamedTexture* pRequester)
+    {
+        while (mStats.residentBytes + mPendingBytes + bytes > mStats.budgetBytes)
+        {
+            // Least recently used texture with more mips resident than it needs
+            StreamedTexture* pVictim = nullptr;
+            for (auto& tex : mTextures)
+            {
+                if (&tex == pRequester || tex.pRequest || tex.residentMip >= tex.requiredMip) continue;
+                if (pVictim == nullptr || tex.lastUsedFrame < pVictim->lastUsedFrame || (tex.lastUsedFrame == pVictim->lastUsedFrame && tex.distance > pVictim->distance))
+                {
+                    pVictim = &tex;
+                }
+            }
+            if (pVictim == nullptr) return false;
+
+            setResidentMip(pContext, *pVictim, pVictim->requiredMip, nullptr);
+            mStats.evictions++;
+        }
+        return true;
+    }
+
+    void TextureStreamer::issueRequests(RenderContext* pContext)
+    {
+        mStats.requestedBytes = 0;
+        mStats.deniedRequests = 0;
+        mStats.inFlightRequests = 0;
+
+        std::vector<StreamedTexture*> candidates;
+        for (auto& tex : mTextures)
+        {
+            mStats.requestedBytes += tex.chain.getSize(tex.requiredMip);
+            if (tex.pRequest) mStats.inFlightRequests++;
+            else if (tex.requiredMip < tex.residentMip) candidates.push_back(&tex);
+        }
+
+        // The textures missing the most mips first, then the closest ones
+        std::sort(candidates.begin(), candidates.end(), [](const StreamedTexture* pA, const StreamedTexture* pB)
+        {
+            uint32_t missingA = pA->residentMip - pA->requiredMip;
+            uint32_t missingB = pB->residentMip - pB->requiredMip;
+            return (missingA != missingB) ? (missingA > missingB) : (pA->distance < pB->distance);
+        });
+
+        uint32_t queued = 0;
+        for (StreamedTexture* pTex : candidates)
+        {
+            if (mStats.inFlightRequests >= kMaxRequestsInFlight)
+            {
+                queued++;
+                continue;
+            }
+
+            uint32_t firstMip = pTex->requiredMip;
+            uint64_t bytes = pTex->chain.getSize(firstMip) - pTex->chain.getSize(pTex->residentMip);
+            if (evict(pContext, bytes, pTex) == false)
+            {
+                mStats.deniedRequests++;
+                continue;
+            }
+
+            DdsMipChain chain = pTex->chain;
+            uint32_t mipCount = pTex->residentMip - firstMip;
+            pTex->pRequest = std::make_unique<Request>();
+            pTex->pRequest->firstMip = firstMip;
+            pTex->pRequest->data = std::async(std::launch::async, [chain, firstMip, mipCount]()
+            {
+                std::vector<uint8_t> data;
+                if (readDdsMips(chain, firstMip, mipCount, data) == false) data.clear();
+                return data;
+            });
+            mPendingBytes += bytes;
+            mStats.inFlightRequests++;
+        }
+        mStats.pendingRequests = mStats.inFlightRequests + queued + mStats.deniedRequests;
+    }
+}
@@ -0,0 +1,167 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "API/Texture.h"
+#include "Graphics/TextureHelper.h"
+#include "Graphics/Scene/Scene.h"
+#include <future>
+#include <unordered_map>
+
+namespace Falcor
+{
+    class RenderContext;
+    class Camera;
+
+    /** Streams the mips of scene textures in and out within a memory budget.
+        When enabled, createTextureFromFile() only loads the mips of DDS (or cooked, see TextureCooker) textures up to kTailSize. Every frame,
+        update() estimates the mip each visible mesh needs from its distance to the camera, its size in texture space (Mesh::getUvScale()) and
+        the viewport resolution. The missing mips are read from disk on worker threads and the texture is replaced with a more detailed one
+        once they arrive. When the budget is exceeded, the textures used least recently lose the mips they don't need.
+    */
+    class TextureStreamer
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TextureStreamer>;
+
+        static const uint32_t kTailSize = 128;          ///< Mips no larger than this are always resident
+        static const uint32_t kMaxRequestsInFlight = 8; ///< Number of mip requests being read from disk at the same time
+
+        struct Stats
+        {
+            uint64_t residentBytes = 0;     ///< Memory used by the streamed textures
+            uint64_t requestedBytes = 0;    ///< Memory the streamed textures would use if all the requested mips were resident
+            uint64_t budgetBytes = 0;
+            uint32_t textureCount = 0;      ///< Number of streamed textures
+            uint32_t pendingRequests = 0;   ///< Textures waiting for more detailed mips (being read or queued)
+            uint32_t inFlightRequests = 0;  ///< Requests being read from disk
+            uint32_t deniedRequests = 0;    ///< Requests which didn't fit in the budget this frame
+            uint64_t evictions = 0;         ///< Total number of times a texture lost mips to make room for another one
+            uint64_t loadedBytes = 0;       ///< Total bytes read from disk since the scene was set
+
+            /** Requested memory relative to the budget. Above 1, the streamer can't keep every texture at the resolution it needs.
+            */
+            float getBudgetPressure() const { return budgetBytes ? float(double(requestedBytes) / double(budgetBytes)) : 0.0f; }
+        };
+
+        /** Create a streamer
+            \param[in] budgetBytes Memory the streamed textures can use
+        */
+        static SharedPtr create(uint64_t budgetBytes);
+        ~TextureStreamer();
+
+        /** Enable or disable loading only the low-resolution mips in createTextureFromFile(). Disabled by default.
+        */
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+
+        /** Create a texture from the mips of a DDS file up to kTailSize.
+            \return nullptr if the texture is small enough to be loaded in full, or can't be streamed
+        */
+        static Texture::SharedPtr createTailTexture(const std::string& filename, bool loadAsSrgb, Texture::BindFlags bindFlags);
+
+        /** Start streaming the material textures of a scene. Textures which weren't loaded from a DDS file are ignored.
+        */
+        void setScene(const Scene::SharedPtr& pScene);
+
+        /** Estimate the required mips, swap in the mips which finished loading, evict and issue new requests. Call once per frame.
+            \param[in] pContext Used to upload the new mips
+            \param[in] pCamera The camera the scene is rendered from
+            \param[in] viewportHeight Height of the render target in pixels
+        */
+        void update(RenderContext* pContext, const Camera* pCamera, uint32_t viewportHeight);
+
+        /** Set the memory budget
+        */
+        void setBudget(uint64_t budgetBytes) { mStats.budgetBytes = budgetBytes; }
+        uint64_t getBudget() const { return mStats.budgetBytes; }
+
+        /** Bias added to the estimated mip level. Positive values trade sharpness for memory.
+        */
+        void setMipBias(float bias) { mMipBias = bias; }
+        float getMipBias() const { return mMipBias; }
+
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        TextureStreamer(uint64_t budgetBytes);
+
+        enum class Slot
+        {
+            BaseColor,
+            Specular,
+            Emissive,
+            NormalMap,
+            OcclusionMap,
+            LightMap,
+            HeightMap,
+            Count
+        };
+
+        struct Use
+        {
+            Material::SharedPtr pMaterial;
+            Slot slot;
+        };
+
+        struct Request
+        {
+            uint32_t firstMip;
+            std::future<std::vector<uint8_t>> data;
+        };
+
+        struct StreamedTexture
+        {
+            Texture::SharedPtr pTexture;
+            DdsMipChain chain;
+            std::vector<Use> uses;
+            uint32_t residentMip = 0;   ///< Most detailed resident mip
+            uint32_t tailMip = 0;       ///< Least detailed mip the texture can be reduced to
+            uint32_t requiredMip = 0;   ///< Most detailed mip needed this frame (tailMip if not visible)
+            uint64_t lastUsedFrame = 0;
+            float distance = 0;         ///< Distance to the closest mesh using the texture this frame
+            std::unique_ptr<Request> pRequest;
+        };
+
+        static Texture::SharedPtr getTexture(const Material* pMaterial, Slot slot);
+        static void setTexture(Material* pMaterial, Slot slot, Texture::SharedPtr pTexture);
+
+        void estimateRequiredMips(const Camera* pCamera, uint32_t viewportHeight);
+        void completeRequests(RenderContext* pContext);
+        void issueRequests(RenderContext* pContext);
+        bool evict(RenderContext* pContext, uint64_t bytes, const StreamedTexture* pRequester);
+        void setResidentMip(RenderContext* pContext, StreamedTexture& tex, uint32_t firstMip, const std::vector<uint8_t>* pNewMips);
+
+        Scene::SharedPtr mpScene;
+        std::vector<StreamedTexture> mTextures;
+        std::unordered_map<const Mesh*, std::vector<uint32_t>> mMeshTextures;   ///< Indices in mTextures of the textures each mesh uses
+        uint64_t mFrame = 0;
+        float mMipBias = 0;
+        uint64_t mPendingBytes = 0;     ///< Memory the requests in flight will add once they complete
+        Stats mStats;
+    };
+}
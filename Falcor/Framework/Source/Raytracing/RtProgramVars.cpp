@@ -176,6 +176,9 @@ namespace Falcor
 
     bool RtProgramVars::apply(RenderContext* pCtx, RtStateObject* pRtso)
     {
+        // Resources the records reference are transitioned in the list we're raytracing from, which isn't always the device's context
+        mpRtVarsHelper->setRayTraceContext(pCtx);
+
         // We always have a ray-gen program, apply it first
         uint8_t* pRayGenRecord = getRayGenRecordPtr();
         if (!applyRtProgramVars(pRayGenRecord, mpProgram->getRayGenProgram()->getActiveVersion().get(), pRtso, getRayGenVars().get(), mpRtVarsHelper.get()))
@@ -143,11 +143,17 @@ namespace Falcor
         static SharedPtr create(CopyContext::SharedPtr pRtContext);
 
         const LowLevelContextData::SharedPtr& getLowLevelData() const override { return mpLowLevelData; }
-        void resourceBarrier(const Resource* pResource, Resource::State newState, const ResourceViewInfo* pViewInfo = nullptr) override { return mpRayTraceContext->resourceBarrier(pResource, newState, pViewInfo); }
+        void resourceBarrier(const Resource* pResource, Resource::State newState, const ResourceViewInfo* pViewInfo = nullptr) override { return getRayTraceContext()->resourceBarrier(pResource, newState, pViewInfo); }
         RtVarsCmdList::SharedPtr getRtVarsCmdList() const { return mpList; }
+
+        /** Set the context the shader table is being applied for, so barriers land in its command list. nullptr reverts to the context passed to create()
+        */
+        void setRayTraceContext(CopyContext* pCtx) { mpTargetContext = pCtx; }
     private:
         RtVarsContext(CopyContext::SharedPtr pRtContext);
+        CopyContext* getRayTraceContext() const { return mpTargetContext ? mpTargetContext : mpRayTraceContext.get(); }
         RtVarsCmdList::SharedPtr mpList;
         CopyContext::SharedPtr mpRayTraceContext;
+        CopyContext* mpTargetContext = nullptr;
     };
 }
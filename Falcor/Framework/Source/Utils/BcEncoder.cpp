@@ -0,0 +1,771 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "BcEncoder.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BC_ENCODER_USE_SSE2
+#endif
+
+namespace Falcor
+{
+    namespace BcEncoder
+    {
+        namespace
+        {
+            // Interpolation weights of the 4-bit index modes of BC6H and BC7, out of 64
+            const uint32_t kWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+            const float kWeights4f[16] = { 0.0f, 4 / 64.0f, 9 / 64.0f, 13 / 64.0f, 17 / 64.0f, 21 / 64.0f, 26 / 64.0f, 30 / 64.0f, 34 / 64.0f, 38 / 64.0f, 43 / 64.0f, 47 / 64.0f, 51 / 64.0f, 55 / 64.0f, 60 / 64.0f, 1.0f };
+
+            // Position of each index between the two endpoints, for BC1 (4-color mode) and BC4 (8-value mode)
+            const float kBC1Weights[4] = { 0.0f, 1.0f, 1 / 3.0f, 2 / 3.0f };
+            const float kBC4Weights[8] = { 0.0f, 1.0f, 1 / 7.0f, 2 / 7.0f, 3 / 7.0f, 4 / 7.0f, 5 / 7.0f, 6 / 7.0f };
+
+            float saturate(float v) { return std::min(std::max(v, 0.0f), 1.0f); }
+
+            struct BitWriter
+            {
+                BitWriter(uint8_t* pDst) : mpDst(pDst) { std::memset(pDst, 0, 16); }
+                void write(uint32_t value, uint32_t bitCount)
+                {
+                    for (uint32_t i = 0; i < bitCount; i++, mPos++)
+                    {
+                        if ((value >> i) & 1) mpDst[mPos >> 3] |= uint8_t(1 << (mPos & 7));
+                    }
+                }
+            private:
+                uint8_t* mpDst;
+                uint32_t mPos = 0;
+            };
+
+            struct BitReader
+            {
+                BitReader(const uint8_t* pSrc) : mpSrc(pSrc) {}
+                uint32_t read(uint32_t bitCount)
+                {
+                    uint32_t value = 0;
+                    for (uint32_t i = 0; i < bitCount; i++, mPos++)
+                    {
+                        value |= uint32_t((mpSrc[mPos >> 3] >> (mPos & 7)) & 1) << i;
+                    }
+                    return value;
+                }
+            private:
+                const uint8_t* mpSrc;
+                uint32_t mPos = 0;
+            };
+
+            // Half-float bits of a non-negative float, rounded to nearest and clamped to the largest finite half. BC6H UF16 can't store negatives.
+            uint16_t floatToHalfUnsigned(float f)
+            {
+                if (!(f > 0.0f)) return 0;
+                if (f >= 65504.0f) return 0x7BFF;
+                uint32_t bits;
+                std::memcpy(&bits, &f, sizeof(bits));
+                int32_t exp = int32_t((bits >> 23) & 0xFF) - 127 + 15;
+                uint32_t mant = bits & 0x7FFFFF;
+                if (exp <= 0)
+                {
+                    // Denormal half
+                    if (exp < -10) return 0;
+                    mant |= 0x800000;
+                    uint32_t shift = uint32_t(14 - exp);
+                    uint32_t h = mant >> shift;
+                    uint32_t rem = mant & ((1u << shift) - 1);
+                    uint32_t halfway = 1u << (shift - 1);
+                    if (rem > halfway || (rem == halfway && (h & 1))) h++;
+                    return uint16_t(h);
+                }
+                uint32_t h = (uint32_t(exp) << 10) | (mant >> 13);
+                uint32_t rem = mant & 0x1FFF;
+                if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) h++;
+                return uint16_t(std::min(h, 0x7BFFu));
+            }
+
+            float halfToFloat(uint16_t h)
+            {
+                uint32_t sign = uint32_t(h & 0x8000) << 16;
+                uint32_t exp = (h >> 10) & 0x1F;
+                uint32_t mant = h & 0x3FF;
+                if (exp == 0)
+                {
+                    float v = float(mant) / 16777216.0f;
+                    return sign ? -v : v;
+                }
+                uint32_t bits = sign | ((exp == 31) ? (0x7F800000 | (mant << 13)) : (((exp + 112) << 23) | (mant << 13)));
+                float f;
+                std::memcpy(&f, &bits, sizeof(f));
+                return f;
+            }
+
+            /** Pick the closest palette entry for every texel.
+                \return The total squared error
+            */
+            float selectIndices(const float* const* pChannels, uint32_t channelCount, const float palette[16][4], uint32_t paletteSize, uint8_t indices[16])
+            {
+#ifdef BC_ENCODER_USE_SSE2
+                __m128 totalError = _mm_setzero_ps();
+                for (uint32_t i = 0; i < 16; i += 4)
+                {
+                    __m128 texel[4];
+                    for (uint32_t c = 0; c < channelCount; c++) texel[c] = _mm_loadu_ps(pChannels[c] + i);
+
+                    __m128 bestDist = _mm_set1_ps(FLT_MAX);
+                    __m128i bestIndex = _mm_setzero_si128();
+                    for (uint32_t p = 0; p < paletteSize; p++)
+                    {
+                        __m128 dist = _mm_setzero_ps();
+                        for (uint32_t c = 0; c < channelCount; c++)
+                        {
+                            __m128 d = _mm_sub_ps(texel[c], _mm_set1_ps(palette[p][c]));
+                            dist = _mm_add_ps(dist, _mm_mul_ps(d, d));
+                        }
+                        __m128i closer = _mm_castps_si128(_mm_cmplt_ps(dist, bestDist));
+                        bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(int32_t(p))), _mm_andnot_si128(closer, bestIndex));
+                        bestDist = _mm_min_ps(dist, bestDist);
+                    }
+                    totalError = _mm_add_ps(totalError, bestDist);
+
+                    int32_t best[4];
+                    _mm_storeu_si128((__m128i*)best, bestIndex);
+                    for (uint32_t j = 0; j < 4; j++) indices[i + j] = uint8_t(best[j]);
+                }
+                float error[4];
+                _mm_storeu_ps(error, totalError);
+                return error[0] + error[1] + error[2] + error[3];
+#else
+                float totalError = 0;
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    float bestDist = FLT_MAX;
+                    for (uint32_t p = 0; p < paletteSize; p++)
+                    {
+                        float dist = 0;
+                        for (uint32_t c = 0; c < channelCount; c++)
+                        {
+                            float d = pChannels[c][i] - palette[p][c];
+                            dist += d * d;
+                        }
+                        if (dist < bestDist)
+                        {
+                            bestDist = dist;
+                            indices[i] = uint8_t(p);
+                        }
+                    }
+                    totalError += bestDist;
+                }
+                return totalError;
+#endif
+            }
+
+            /** Fit a line through the texels (principal axis) and return its extent as two endpoints
+            */
+            void fitLine(const float* const* pChannels, uint32_t channelCount, float e0[4], float e1[4])
+            {
+                float mean[4] = {};
+                for (uint32_t c = 0; c < channelCount; c++)
+                {
+                    for (uint32_t i = 0; i < 16; i++) mean[c] += pChannels[c][i];
+                    mean[c] /= 16.0f;
+                }
+
+                float cov[4][4] = {};
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    for (uint32_t c = 0; c < channelCount; c++)
+                    {
+                        for (uint32_t k = 0; k < channelCount; k++)
+                        {
+                            cov[c][k] += (pChannels[c][i] - mean[c]) * (pChannels[k][i] - mean[k]);
+                        }
+                    }
+                }
+
+                // Start from the covariance row of the channel with the most variance, then refine with power iterations
+                uint32_t start = 0;
+                for (uint32_t c = 1; c < channelCount; c++) if (cov[c][c] > cov[start][start]) start = c;
+                float axis[4] = {};
+                for (uint32_t c = 0; c < channelCount; c++) axis[c] = cov[start][c];
+                for (uint32_t iter = 0; iter < 8; iter++)
+                {
+                    float v[4] = {};
+                    float length = 0;
+                    for (uint32_t c = 0; c < channelCount; c++)
+                    {
+                        for (uint32_t k = 0; k < channelCount; k++) v[c] += cov[c][k] * axis[k];
+                        length += v[c] * v[c];
+                    }
+                    if (length < 1e-20f) break;
+                    length = std::sqrt(length);
+                    for (uint32_t c = 0; c < channelCount; c++) axis[c] = v[c] / length;
+                }
+
+                float length = 0;
+                for (uint32_t c = 0; c < channelCount; c++) length += axis[c] * axis[c];
+                if (length < 1e-20f)
+                {
+                    // All texels are the same
+                    for (uint32_t c = 0; c < channelCount; c++) e0[c] = e1[c] = mean[c];
+                    return;
+                }
+                length = std::sqrt(length);
+                for (uint32_t c = 0; c < channelCount; c++) axis[c] /= length;
+
+                float tMin = FLT_MAX, tMax = -FLT_MAX;
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    float t = 0;
+                    for (uint32_t c = 0; c < channelCount; c++) t += (pChannels[c][i] - mean[c]) * axis[c];
+                    tMin = std::min(tMin, t);
+                    tMax = std::max(tMax, t);
+                }
+                for (uint32_t c = 0; c < channelCount; c++)
+                {
+                    e0[c] = mean[c] + tMin * axis[c];
+                    e1[c] = mean[c] + tMax * axis[c];
+                }
+            }
+
+            /** Least-squares endpoints for a given index assignment. pWeights maps an index to its position between e0 (0) and e1 (1).
+            */
+            void refitEndpoints(const float* const* pChannels, uint32_t channelCount, const uint8_t indices[16], const float* pWeights, float e0[4], float e1[4])
+            {
+                float aa = 0, ab = 0, bb = 0;
+                float x0[4] = {}, x1[4] = {};
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    float w = pWeights[indices[i]];
+                    float a = 1.0f - w;
+                    aa += a * a;
+                    ab += a * w;
+                    bb += w * w;
+                    for (uint32_t c = 0; c < channelCount; c++)
+                    {
+                        x0[c] += a * pChannels[c][i];
+                        x1[c] += w * pChannels[c][i];
+                    }
+                }
+
+                float det = aa * bb - ab * ab;
+                if (std::abs(det) < 1e-6f) return;
+                for (uint32_t c = 0; c < channelCount; c++)
+                {
+                    e0[c] = (x0[c] * bb - x1[c] * ab) / det;
+                    e1[c] = (x1[c] * aa - x0[c] * ab) / det;
+                }
+            }
+
+            uint16_t quantize565(const float c[4])
+            {
+                uint32_t r = uint32_t(saturate(c[0]) * 31.0f + 0.5f);
+                uint32_t g = uint32_t(saturate(c[1]) * 63.0f + 0.5f);
+                uint32_t b = uint32_t(saturate(c[2]) * 31.0f + 0.5f);
+                return uint16_t((r << 11) | (g << 5) | b);
+            }
+
+            void expand565(uint16_t v, float c[4])
+            {
+                uint32_t r = (v >> 11) & 0x1F, g = (v >> 5) & 0x3F, b = v & 0x1F;
+                c[0] = float((r << 3) | (r >> 2)) / 255.0f;
+                c[1] = float((g << 2) | (g >> 4)) / 255.0f;
+                c[2] = float((b << 3) | (b >> 2)) / 255.0f;
+                c[3] = 1.0f;
+            }
+
+            void encodeBC1Color(const Block& block, uint8_t* pDst)
+            {
+                const float* pChannels[3] = { block.r, block.g, block.b };
+                float e0[4], e1[4];
+                fitLine(pChannels, 3, e0, e1);
+
+                float bestError = FLT_MAX;
+                for (uint32_t pass = 0; pass < 2; pass++)
+                {
+                    // c0 > c1 selects the 4-color mode
+                    uint16_t c0 = quantize565(e0), c1 = quantize565(e1);
+                    if (c0 < c1)
+                    {
+                        std::swap(c0, c1);
+                        std::swap(e0, e1);
+                    }
+
+                    float palette[16][4];
+                    expand565(c0, palette[0]);
+                    expand565(c1, palette[1]);
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3.0f;
+                        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3.0f;
+                    }
+
+                    uint8_t indices[16];
+                    float error = selectIndices(pChannels, 3, palette, (c0 == c1) ? 1 : 4, indices);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        uint32_t bits = 0;
+                        for (uint32_t i = 0; i < 16; i++) bits |= uint32_t(indices[i]) << (2 * i);
+                        pDst[0] = uint8_t(c0); pDst[1] = uint8_t(c0 >> 8);
+                        pDst[2] = uint8_t(c1); pDst[3] = uint8_t(c1 >> 8);
+                        std::memcpy(pDst + 4, &bits, 4);
+                    }
+
+                    if (pass == 0 && c0 != c1) refitEndpoints(pChannels, 3, indices, kBC1Weights, e0, e1);
+                }
+            }
+
+            void decodeBC1Color(const uint8_t* pSrc, Block& block, bool alwaysFourColors)
+            {
+                uint16_t c0 = uint16_t(pSrc[0] | (pSrc[1] << 8));
+                uint16_t c1 = uint16_t(pSrc[2] | (pSrc[3] << 8));
+                float palette[4][4];
+                expand565(c0, palette[0]);
+                expand565(c1, palette[1]);
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    if (c0 > c1 || alwaysFourColors)
+                    {
+                        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3.0f;
+                        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3.0f;
+                    }
+                    else
+                    {
+                        palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+                        palette[3][c] = 0;
+                    }
+                }
+                palette[2][3] = 1.0f;
+                palette[3][3] = (c0 > c1 || alwaysFourColors) ? 1.0f : 0.0f;
+
+                uint32_t bits;
+                std::memcpy(&bits, pSrc + 4, 4);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    const float* p = palette[(bits >> (2 * i)) & 3];
+                    block.r[i] = p[0];
+                    block.g[i] = p[1];
+                    block.b[i] = p[2];
+                    block.a[i] = p[3];
+                }
+            }
+
+            void encodeBC4Channel(const float* pValues, uint8_t* pDst)
+            {
+                const float* pChannels[1] = { pValues };
+                float e0[4] = { pValues[0] }, e1[4] = { pValues[0] };
+                for (uint32_t i = 1; i < 16; i++)
+                {
+                    e0[0] = std::max(e0[0], pValues[i]);
+                    e1[0] = std::min(e1[0], pValues[i]);
+                }
+
+                float bestError = FLT_MAX;
+                for (uint32_t pass = 0; pass < 2; pass++)
+                {
+                    // a0 > a1 selects the 8-value mode
+                    uint32_t a0 = uint32_t(saturate(e0[0]) * 255.0f + 0.5f);
+                    uint32_t a1 = uint32_t(saturate(e1[0]) * 255.0f + 0.5f);
+                    if (a0 < a1)
+                    {
+                        std::swap(a0, a1);
+                        std::swap(e0, e1);
+                    }
+
+                    float palette[16][4];
+                    palette[0][0] = a0 / 255.0f;
+                    palette[1][0] = a1 / 255.0f;
+                    for (uint32_t i = 2; i < 8; i++) palette[i][0] = ((8 - i) * a0 + (i - 1) * a1) / (7.0f * 255.0f);
+
+                    uint8_t indices[16];
+                    float error = selectIndices(pChannels, 1, palette, (a0 == a1) ? 1 : 8, indices);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        uint64_t bits = 0;
+                        for (uint32_t i = 0; i < 16; i++) bits |= uint64_t(indices[i]) << (3 * i);
+                        pDst[0] = uint8_t(a0);
+                        pDst[1] = uint8_t(a1);
+                        for (uint32_t i = 0; i < 6; i++) pDst[2 + i] = uint8_t(bits >> (8 * i));
+                    }
+
+                    if (pass == 0 && a0 != a1) refitEndpoints(pChannels, 1, indices, kBC4Weights, e0, e1);
+                }
+            }
+
+            void decodeBC4Channel(const uint8_t* pSrc, float* pValues)
+            {
+                uint32_t a0 = pSrc[0], a1 = pSrc[1];
+                float palette[8];
+                palette[0] = a0 / 255.0f;
+                palette[1] = a1 / 255.0f;
+                if (a0 > a1)
+                {
+                    for (uint32_t i = 2; i < 8; i++) palette[i] = ((8 - i) * a0 + (i - 1) * a1) / (7.0f * 255.0f);
+                }
+                else
+                {
+                    for (uint32_t i = 2; i < 6; i++) palette[i] = ((6 - i) * a0 + (i - 1) * a1) / (5.0f * 255.0f);
+                    palette[6] = 0.0f;
+                    palette[7] = 1.0f;
+                }
+
+                uint64_t bits = 0;
+                for (uint32_t i = 0; i < 6; i++) bits |= uint64_t(pSrc[2 + i]) << (8 * i);
+                for (uint32_t i = 0; i < 16; i++) pValues[i] = palette[(bits >> (3 * i)) & 7];
+            }
+
+            // BC7 mode 6: one partition, RGBA endpoints with 7 bits per channel and a unique p-bit each, 4-bit indices
+            void quantizeBC7Endpoint(const float e[4], uint32_t q[4], uint32_t& pBit)
+            {
+                float bestError = FLT_MAX;
+                for (uint32_t p = 0; p < 2; p++)
+                {
+                    uint32_t candidate[4];
+                    float error = 0;
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        float v = saturate(e[c]) * 255.0f;
+                        int32_t qc = std::min(std::max(int32_t(std::floor((v - p) * 0.5f + 0.5f)), 0), 127);
+                        float d = float((qc << 1) | p) - v;
+                        error += d * d;
+                        candidate[c] = uint32_t(qc);
+                    }
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        pBit = p;
+                        std::memcpy(q, candidate, sizeof(candidate));
+                    }
+                }
+            }
+
+            void encodeBC7(const Block& block, uint8_t* pDst)
+            {
+                const float* pChannels[4] = { block.r, block.g, block.b, block.a };
+                float e0[4], e1[4];
+                fitLine(pChannels, 4, e0, e1);
+
+                float bestError = FLT_MAX;
+                for (uint32_t pass = 0; pass < 2; pass++)
+                {
+                    uint32_t q0[4], q1[4], p0, p1;
+                    quantizeBC7Endpoint(e0, q0, p0);
+                    quantizeBC7Endpoint(e1, q1, p1);
+
+                    float palette[16][4];
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        uint32_t end0 = (q0[c] << 1) | p0, end1 = (q1[c] << 1) | p1;
+                        for (uint32_t k = 0; k < 16; k++)
+                        {
+                            palette[k][c] = float(((64 - kWeights4[k]) * end0 + kWeights4[k] * end1 + 32) >> 6) / 255.0f;
+                        }
+                    }
+
+                    uint8_t indices[16];
+                    float error = selectIndices(pChannels, 4, palette, 16, indices);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+
+                        // The anchor index is stored without its top bit; swap the endpoints if it is set
+                        uint8_t stored[16];
+                        bool swapEndpoints = (indices[0] & 8) != 0;
+                        for (uint32_t i = 0; i < 16; i++) stored[i] = swapEndpoints ? uint8_t(15 - indices[i]) : indices[i];
+                        const uint32_t* pA = swapEndpoints ? q1 : q0;
+                        const uint32_t* pB = swapEndpoints ? q0 : q1;
+
+                        BitWriter bits(pDst);
+                        bits.write(1u << 6, 7);
+                        for (uint32_t c = 0; c < 4; c++)
+                        {
+                            bits.write(pA[c], 7);
+                            bits.write(pB[c], 7);
+                        }
+                        bits.write(swapEndpoints ? p1 : p0, 1);
+                        bits.write(swapEndpoints ? p0 : p1, 1);
+                        bits.write(stored[0], 3);
+                        for (uint32_t i = 1; i < 16; i++) bits.write(stored[i], 4);
+                    }
+
+                    if (pass == 0) refitEndpoints(pChannels, 4, indices, kWeights4f, e0, e1);
+                }
+            }
+
+            void decodeBC7(const uint8_t* pSrc, Block& block)
+            {
+                BitReader bits(pSrc);
+                if (bits.read(7) != (1u << 6))
+                {
+                    // Not produced by this encoder
+                    std::memset(&block, 0, sizeof(block));
+                    return;
+                }
+
+                uint32_t q[2][4];
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    q[0][c] = bits.read(7);
+                    q[1][c] = bits.read(7);
+                }
+                uint32_t p0 = bits.read(1), p1 = bits.read(1);
+
+                float* pChannels[4] = { block.r, block.g, block.b, block.a };
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint32_t index = bits.read(i == 0 ? 3 : 4);
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        uint32_t end0 = (q[0][c] << 1) | p0, end1 = (q[1][c] << 1) | p1;
+                        pChannels[c][i] = float(((64 - kWeights4[index]) * end0 + kWeights4[index] * end1 + 32) >> 6) / 255.0f;
+                    }
+                }
+            }
+
+            // BC6H mode 11: one region, untransformed 10-bit endpoints, 4-bit indices. Everything is done on half-float bit patterns.
+            uint32_t unquantizeBC6H(uint32_t x)
+            {
+                if (x == 0) return 0;
+                if (x == 1023) return 0xFFFF;
+                return ((x << 16) + 0x8000) >> 10;
+            }
+
+            uint32_t finishBC6H(uint32_t x)
+            {
+                return (x * 31) >> 6;
+            }
+
+            uint32_t quantizeBC6H(float halfBits)
+            {
+                // finishBC6H(unquantizeBC6H(x)) == 31 * x + 15 for all but the two extreme values
+                return uint32_t(std::min(std::max(std::floor((halfBits - 15.0f) / 31.0f + 0.5f), 0.0f), 1023.0f));
+            }
+
+            void encodeBC6H(const Block& block, uint8_t* pDst)
+            {
+                float halfBits[3][16];
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    halfBits[0][i] = float(floatToHalfUnsigned(block.r[i]));
+                    halfBits[1][i] = float(floatToHalfUnsigned(block.g[i]));
+                    halfBits[2][i] = float(floatToHalfUnsigned(block.b[i]));
+                }
+                const float* pChannels[3] = { halfBits[0], halfBits[1], halfBits[2] };
+                float e0[4], e1[4];
+                fitLine(pChannels, 3, e0, e1);
+
+                float bestError = FLT_MAX;
+                for (uint32_t pass = 0; pass < 2; pass++)
+                {
+                    uint32_t x0[3], x1[3];
+                    float palette[16][4];
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        x0[c] = quantizeBC6H(e0[c]);
+                        x1[c] = quantizeBC6H(e1[c]);
+                        uint32_t u0 = unquantizeBC6H(x0[c]), u1 = unquantizeBC6H(x1[c]);
+                        for (uint32_t k = 0; k < 16; k++)
+                        {
+                            palette[k][c] = float(finishBC6H(((64 - kWeights4[k]) * u0 + kWeights4[k] * u1 + 32) >> 6));
+                        }
+                    }
+
+                    uint8_t indices[16];
+                    float error = selectIndices(pChannels, 3, palette, 16, indices);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+
+                        uint8_t stored[16];
+                        bool swapEndpoints = (indices[0] & 8) != 0;
+                        for (uint32_t i = 0; i < 16; i++) stored[i] = swapEndpoints ? uint8_t(15 - indices[i]) : indices[i];
+                        const uint32_t* pA = swapEndpoints ? x1 : x0;
+                        const uint32_t* pB = swapEndpoints ? x0 : x1;
+
+                        BitWriter bits(pDst);
+                        bits.write(0x03, 5);
+                        for (uint32_t c = 0; c < 3; c++) bits.write(pA[c], 10);
+                        for (uint32_t c = 0; c < 3; c++) bits.write(pB[c], 10);
+                        bits.write(stored[0], 3);
+                        for (uint32_t i = 1; i < 16; i++) bits.write(stored[i], 4);
+                    }
+
+                    if (pass == 0) refitEndpoints(pChannels, 3, indices, kWeights4f, e0, e1);
+                }
+            }
+
+            void decodeBC6H(const uint8_t* pSrc, Block& block)
+            {
+                BitReader bits(pSrc);
+                if (bits.read(5) != 0x03)
+                {
+                    // Not produced by this encoder
+                    std::memset(&block, 0, sizeof(block));
+                    return;
+                }
+
+                uint32_t u[2][3];
+                for (uint32_t e = 0; e < 2; e++)
+                {
+                    for (uint32_t c = 0; c < 3; c++) u[e][c] = unquantizeBC6H(bits.read(10));
+                }
+
+                float* pChannels[3] = { block.r, block.g, block.b };
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    uint32_t index = bits.read(i == 0 ? 3 : 4);
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        uint32_t h = finishBC6H(((64 - kWeights4[index]) * u[0][c] + kWeights4[index] * u[1][c] + 32) >> 6);
+                        pChannels[c][i] = halfToFloat(uint16_t(h));
+                    }
+                    block.a[i] = 1.0f;
+                }
+            }
+        }
+
+        uint32_t getBlockSize(Format format)
+        {
+            return (format == Format::BC1 || format == Format::BC4) ? 8 : 16;
+        }
+
+        size_t getImageSize(Format format, uint32_t width, uint32_t height)
+        {
+            return size_t((width + 3) / 4) * size_t((height + 3) / 4) * getBlockSize(format);
+        }
+
+        void encodeBlock(Format format, const Block& block, uint8_t* pDst)
+        {
+            switch (format)
+            {
+            case Format::BC1:
+                encodeBC1Color(block, pDst);
+                break;
+            case Format::BC3:
+                encodeBC4Channel(block.a, pDst);
+                encodeBC1Color(block, pDst + 8);
+                break;
+            case Format::BC4:
+                encodeBC4Channel(block.r, pDst);
+                break;
+            case Format::BC5:
+                encodeBC4Channel(block.r, pDst);
+                encodeBC4Channel(block.g, pDst + 8);
+                break;
+            case Format::BC6H:
+                encodeBC6H(block, pDst);
+                break;
+            case Format::BC7:
+                encodeBC7(block, pDst);
+                break;
+            }
+        }
+
+        void decodeBlock(Format format, const uint8_t* pSrc, Block& block)
+        {
+            switch (format)
+            {
+            case Format::BC1:
+                decodeBC1Color(pSrc, block, false);
+                break;
+            case Format::BC3:
+                decodeBC1Color(pSrc + 8, block, true);
+                decodeBC4Channel(pSrc, block.a);
+                break;
+            case Format::BC4:
+                decodeBC4Channel(pSrc, block.r);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    block.g[i] = block.b[i] = 0.0f;
+                    block.a[i] = 1.0f;
+                }
+                break;
+            case Format::BC5:
+                decodeBC4Channel(pSrc, block.r);
+                decodeBC4Channel(pSrc + 8, block.g);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    block.b[i] = 0.0f;
+                    block.a[i] = 1.0f;
+                }
+                break;
+            case Format::BC6H:
+                decodeBC6H(pSrc, block);
+                break;
+            case Format::BC7:
+                decodeBC7(pSrc, block);
+                break;
+            }
+        }
+
+        void encodeImage(Format format, const float* pRgba, uint32_t width, uint32_t height, uint8_t* pDst, uint32_t threadCount)
+        {
+            uint32_t blocksX = (width + 3) / 4;
+            uint32_t blocksY = (height + 3) / 4;
+            uint32_t blockSize = getBlockSize(format);
+
+            // Threads grab rows of blocks until there are none left
+            std::atomic<uint32_t> nextRow(0);
+            auto encodeRows = [&]()
+            {
+                for (uint32_t by = nextRow++; by < blocksY; by = nextRow++)
+                {
+                    for (uint32_t bx = 0; bx < blocksX; bx++)
+                    {
+                        Block block;
+                        for (uint32_t i = 0; i < 16; i++)
+                        {
+                            uint32_t x = std::min(bx * 4 + (i & 3), width - 1);
+                            uint32_t y = std::min(by * 4 + (i >> 2), height - 1);
+                            const float* pTexel = pRgba + (size_t(y) * width + x) * 4;
+                            block.r[i] = pTexel[0];
+                            block.g[i] = pTexel[1];
+                            block.b[i] = pTexel[2];
+                            block.a[i] = pTexel[3];
+                        }
+                        encodeBlock(format, block, pDst + (size_t(by) * blocksX + bx) * blockSize);
+                    }
+                }
+            };
+
+            if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+            threadCount = std::min(threadCount, blocksY);
+
+            std::vector<std::thread> workers;
+            for (uint32_t i = 1; i < threadCount; i++) workers.emplace_back(encodeRows);
+            encodeRows();
+            for (auto& t : workers) t.join();
+        }
+    }
+}
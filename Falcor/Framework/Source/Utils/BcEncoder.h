@@ -0,0 +1,90 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace Falcor
+{
+    /** CPU encoders (and reference decoders) for the block-compressed texture formats.
+        Every format is encoded with a single-partition endpoint fit: a principal-axis line fit, followed by one
+        least-squares refinement of the endpoints, keeping whichever quantizes better. That covers all of BC1/BC3/BC4/BC5,
+        mode 6 of BC7 and mode 11 of BC6H - the multi-partition modes are left out to keep the encoder fast enough to run
+        at scene load. The decoders only understand the modes the encoder produces; they exist to measure encoding error.
+        Index selection, the hot loop, is vectorized with SSE2 when available.
+    */
+    namespace BcEncoder
+    {
+        enum class Format
+        {
+            BC1,    ///< RGB, 8 bytes per block
+            BC3,    ///< RGBA (BC1 color and BC4 alpha), 16 bytes per block
+            BC4,    ///< R, 8 bytes per block
+            BC5,    ///< RG (two BC4 blocks), 16 bytes per block
+            BC6H,   ///< Unsigned half-float RGB, 16 bytes per block
+            BC7,    ///< RGBA, 16 bytes per block
+        };
+
+        /** A 4x4 block of texels, row major, one array per channel. LDR formats expect values in [0, 1]; BC6H takes
+            linear HDR values (negative values are clamped to 0).
+        */
+        struct Block
+        {
+            float r[16];
+            float g[16];
+            float b[16];
+            float a[16];
+        };
+
+        /** Get the size in bytes of an encoded block
+        */
+        uint32_t getBlockSize(Format format);
+
+        /** Get the size in bytes of an encoded image. Partial blocks on the right and bottom edges are padded.
+        */
+        size_t getImageSize(Format format, uint32_t width, uint32_t height);
+
+        /** Encode a single block
+        */
+        void encodeBlock(Format format, const Block& block, uint8_t* pDst);
+
+        /** Decode a single block
+        */
+        void decodeBlock(Format format, const uint8_t* pSrc, Block& block);
+
+        /** Encode an image, spreading rows of blocks over multiple threads.
+            \param[in] format The format to encode to
+            \param[in] pRgba Source texels, 4 floats per texel, row major, top row first
+            \param[in] width Width of the image. Doesn't have to be a multiple of 4; edge texels are replicated to fill partial blocks.
+            \param[in] height Height of the image
+            \param[out] pDst Destination. Must hold getImageSize() bytes.
+            \param[in] threadCount Number of threads to use. 0 uses one thread per hardware thread.
+        */
+        void encodeImage(Format format, const float* pRgba, uint32_t width, uint32_t height, uint8_t* pDst, uint32_t threadCount = 0);
+    }
+}
@@ -0,0 +1,321 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "BlueNoise.h"
+#include "Utils/BinaryFileStream.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kFileMagic = 0x314E4C42; // "BLN1"
+        const uint32_t kInvalid = uint32_t(-1);
+
+        /** The state of one void-and-cluster run: which texels are set and the energy of every texel.
+            The texels are grouped by row, and each row caches its tightest cluster and largest void, so a query only scans the rows and an
+            update only refreshes the rows its filter footprint touches.
+        */
+        class VoidAndCluster
+        {
+        public:
+            VoidAndCluster(uint32_t size, uint32_t depth, float sigmaSpatial, float sigmaTemporal) : mSize(size), mDepth(depth)
+            {
+                // Truncate the filters at 3 sigma, and to a period so a texel is never counted twice
+                mRadius = std::min(uint32_t(std::ceil(3.0f * sigmaSpatial)), (size - 1) / 2);
+
+                uint32_t width = 2 * mRadius + 1;
+                mSpatialFilter.resize(width * width);
+                for (int32_t dy = -int32_t(mRadius); dy <= int32_t(mRadius); dy++)
+                {
+                    for (int32_t dx = -int32_t(mRadius); dx <= int32_t(mRadius); dx++)
+                    {
+                        mSpatialFilter[(dy + mRadius) * width + dx + mRadius] = std::exp(-float(dx * dx + dy * dy) / (2.0f * sigmaSpatial * sigmaSpatial));
+                    }
+                }
+
+                // Slices dt before and after a slice are slice + dt and slice + depth - dt. With an even depth, both are the same slice at dt = depth / 2.
+                uint32_t temporalRadius = std::min(uint32_t(std::ceil(3.0f * sigmaTemporal)), depth / 2);
+                for (uint32_t dt = 1; dt <= temporalRadius; dt++)
+                {
+                    float weight = std::exp(-float(dt * dt) / (2.0f * sigmaTemporal * sigmaTemporal));
+                    mTemporalFilter.push_back({ dt, weight });
+                    if (2 * dt != depth) mTemporalFilter.push_back({ depth - dt, weight });
+                }
+
+                size_t texelCount = size_t(size) * size * depth;
+                mEnergy.assign(texelCount, 0.0f);
+                mSet.assign(texelCount, 0);
+                mRowCluster.assign(size * depth, kInvalid);
+                mRowVoid.resize(size * depth);
+                for (uint32_t r = 0; r < size * depth; r++) mRowVoid[r] = r * size;
+            }
+
+            bool isSet(uint32_t texel) const { return mSet[texel] != 0; }
+
+            // Set or clear a texel and add or remove its contribution to the energy
+            void toggle(uint32_t texel)
+            {
+                float sign = mSet[texel] ? -1.0f : 1.0f;
+                mSet[texel] ^= 1;
+
+                uint32_t area = mSize * mSize;
+                uint32_t slice = texel / area;
+                uint32_t x = texel % mSize;
+                uint32_t y = (texel % area) / mSize;
+                uint32_t width = 2 * mRadius + 1;
+
+                // Within the slice
+                for (uint32_t fy = 0; fy < width; fy++)
+                {
+                    uint32_t row = slice * mSize + (y + mSize + fy - mRadius) % mSize;
+                    float* pRow = mEnergy.data() + size_t(row) * mSize;
+                    const float* pFilter = mSpatialFilter.data() + fy * width;
+                    for (uint32_t fx = 0; fx < width; fx++)
+                    {
+                        pRow[(x + mSize + fx - mRadius) % mSize] += sign * pFilter[fx];
+                    }
+                    refreshRow(row);
+                }
+
+                // The same pixel in the other slices
+                for (const auto& tap : mTemporalFilter)
+                {
+                    uint32_t other = (slice + tap.offset) % mDepth;
+                    mEnergy[size_t(other) * area + y * mSize + x] += sign * tap.weight;
+                    refreshRow(other * mSize + y);
+                }
+            }
+
+            // The set texel with the highest energy
+            uint32_t findTightestCluster() const
+            {
+                uint32_t best = kInvalid;
+                for (uint32_t texel : mRowCluster)
+                {
+                    if (texel != kInvalid && (best == kInvalid || mEnergy[texel] > mEnergy[best])) best = texel;
+                }
+                return best;
+            }
+
+            // The empty texel with the lowest energy
+            uint32_t findLargestVoid() const
+            {
+                uint32_t best = kInvalid;
+                for (uint32_t texel : mRowVoid)
+                {
+                    if (texel != kInvalid && (best == kInvalid || mEnergy[texel] < mEnergy[best])) best = texel;
+                }
+                return best;
+            }
+
+        private:
+            void refreshRow(uint32_t row)
+            {
+                uint32_t cluster = kInvalid;
+                uint32_t largestVoid = kInvalid;
+                uint32_t first = row * mSize;
+                for (uint32_t texel = first; texel < first + mSize; texel++)
+                {
+                    if (mSet[texel])
+                    {
+                        if (cluster == kInvalid || mEnergy[texel] > mEnergy[cluster]) cluster = texel;
+                    }
+                    else if (largestVoid == kInvalid || mEnergy[texel] < mEnergy[largestVoid])
+                    {
+                        largestVoid = texel;
+                    }
+                }
+                mRowCluster[row] = cluster;
+                mRowVoid[row] = largestVoid;
+            }
+
+            uint32_t mSize;
+            uint32_t mDepth;
+            struct TemporalTap
+            {
+                uint32_t offset;    ///< Slice offset, modulo the depth
+                float weight;
+            };
+
+            uint32_t mRadius;
+            std::vector<float> mSpatialFilter;
+            std::vector<TemporalTap> mTemporalFilter;
+            std::vector<float> mEnergy;
+            std::vector<uint8_t> mSet;
+            std::vector<uint32_t> mRowCluster;
+            std::vector<uint32_t> mRowVoid;
+        };
+    }
+
+    std::vector<uint32_t> BlueNoise::generateMask(uint32_t size, uint32_t depth, float sigmaSpatial, float sigmaTemporal, float initialDensity, uint32_t seed)
+    {
+        uint32_t texelCount = size * size * depth;
+        std::vector<uint32_t> ranks(texelCount);
+        VoidAndCluster initial(size, depth, sigmaSpatial, sigmaTemporal);
+
+        // Random initial binary pattern
+        uint32_t setCount = std::max(1u, std::min(uint32_t(float(texelCount) * initialDensity), texelCount / 2));
+        std::vector<uint32_t> order(texelCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937 rng(seed);
+        std::shuffle(order.begin(), order.end(), rng);
+        for (uint32_t i = 0; i < setCount; i++) initial.toggle(order[i]);
+
+        // Move the tightest cluster to the largest void until that puts it back where it was
+        for (uint32_t i = 0; i < texelCount; i++)
+        {
+            uint32_t cluster = initial.findTightestCluster();
+            initial.toggle(cluster);
+            uint32_t largestVoid = initial.findLargestVoid();
+            initial.toggle(largestVoid);
+            if (largestVoid == cluster) break;
+        }
+
+        // Phase 1: rank the initial pattern by removing its tightest clusters one by one
+        VoidAndCluster removal = initial;
+        for (uint32_t rank = setCount; rank-- > 0;)
+        {
+            uint32_t cluster = removal.findTightestCluster();
+            removal.toggle(cluster);
+            ranks[cluster] = rank;
+        }
+
+        // Phase 2: fill the largest voids. Past half full, the largest void is also the tightest cluster of empty texels, so this covers
+        // the last phase of the original algorithm too.
+        for (uint32_t rank = setCount; rank < texelCount; rank++)
+        {
+            uint32_t largestVoid = initial.findLargestVoid();
+            initial.toggle(largestVoid);
+            ranks[largestVoid] = rank;
+        }
+        return ranks;
+    }
+
+    BlueNoise::SharedPtr BlueNoise::create(const Desc& desc, uint32_t threadCount)
+    {
+        if (desc.size == 0 || desc.depth == 0 || (desc.channels != 1 && desc.channels != 2 && desc.channels != 4))
+        {
+            logError("BlueNoise::create() - invalid description. The size and depth can't be 0, and there must be 1, 2 or 4 channels.");
+            return nullptr;
+        }
+
+        SharedPtr pNoise = SharedPtr(new BlueNoise(desc));
+        pNoise->mRanks.resize(desc.channels);
+
+        // The channels are independent, so threads grab channels until there are none left
+        std::atomic<uint32_t> nextChannel(0);
+        auto generateChannels = [&]()
+        {
+            for (uint32_t c = nextChannel++; c < desc.channels; c = nextChannel++)
+            {
+                pNoise->mRanks[c] = generateMask(desc.size, desc.depth, desc.sigmaSpatial, desc.sigmaTemporal, desc.initialDensity, desc.seed + c * 0x9E3779B9u);
+            }
+        };
+
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::min(threadCount, desc.channels);
+
+        std::vector<std::thread> workers;
+        for (uint32_t i = 1; i < threadCount; i++) workers.emplace_back(generateChannels);
+        generateChannels();
+        for (auto& t : workers) t.join();
+
+        return pNoise;
+    }
+
+    BlueNoise::SharedPtr BlueNoise::createFromFile(const std::string& filename)
+    {
+        BinaryFileStream stream(filename, BinaryFileStream::Mode::Read);
+        uint32_t magic = 0;
+        Desc desc;
+        stream >> magic >> desc.size >> desc.depth >> desc.channels >> desc.sigmaSpatial >> desc.sigmaTemporal >> desc.initialDensity >> desc.seed;
+        if (stream.isFail() || magic != kFileMagic || desc.size == 0 || desc.depth == 0 || (desc.channels != 1 && desc.channels != 2 && desc.channels != 4))
+        {
+            return nullptr;
+        }
+
+        SharedPtr pNoise = SharedPtr(new BlueNoise(desc));
+        size_t texelCount = size_t(desc.size) * desc.size * desc.depth;
+        pNoise->mRanks.resize(desc.channels);
+        for (auto& ranks : pNoise->mRanks)
+        {
+            ranks.resize(texelCount);
+            stream.read(ranks.data(), texelCount * sizeof(uint32_t));
+        }
+        if (stream.isFail())
+        {
+            logWarning("BlueNoise::createFromFile() - " + filename + " is truncated");
+            return nullptr;
+        }
+        return pNoise;
+    }
+
+    bool BlueNoise::writeToFile(const std::string& filename) const
+    {
+        BinaryFileStream stream(filename, BinaryFileStream::Mode::Write);
+        stream << kFileMagic << mDesc.size << mDesc.depth << mDesc.channels << mDesc.sigmaSpatial << mDesc.sigmaTemporal << mDesc.initialDensity << mDesc.seed;
+        for (const auto& ranks : mRanks)
+        {
+            stream.write(ranks.data(), ranks.size() * sizeof(uint32_t));
+        }
+        return stream.isFail() == false;
+    }
+
+    float BlueNoise::getValue(uint32_t x, uint32_t y, uint32_t slice, uint32_t channel) const
+    {
+        size_t texelCount = mRanks[channel].size();
+        size_t texel = (size_t(slice) * mDesc.size + y) * mDesc.size + x;
+        return float((double(mRanks[channel][texel]) + 0.5) / double(texelCount));
+    }
+
+    Texture::SharedPtr BlueNoise::getTexture()
+    {
+        if (mpTexture) return mpTexture;
+
+        // Quantize the ranks to 8 bits, which keeps the same number of texels at every level
+        size_t texelCount = size_t(mDesc.size) * mDesc.size * mDesc.depth;
+        std::vector<uint8_t> texels(texelCount * mDesc.channels);
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            for (uint32_t c = 0; c < mDesc.channels; c++)
+            {
+                texels[i * mDesc.channels + c] = uint8_t((uint64_t(mRanks[c][i]) * 256) / texelCount);
+            }
+        }
+
+        ResourceFormat format = (mDesc.channels == 1) ? ResourceFormat::R8Unorm : ((mDesc.channels == 2) ? ResourceFormat::RG8Unorm : ResourceFormat::RGBA8Unorm);
+        mpTexture = Texture::create2D(mDesc.size, mDesc.size, format, mDesc.depth, 1, texels.data());
+        return mpTexture;
+    }
+}
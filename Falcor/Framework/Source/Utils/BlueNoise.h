@@ -0,0 +1,100 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "API/Texture.h"
+#include <vector>
+
+namespace Falcor
+{
+    /** Spatiotemporal blue-noise masks, generated with void-and-cluster.
+        A mask is a stack of depth slices of size x size texels. Every texel holds a rank; the ranks are a permutation of 0..N-1 over the whole
+        stack, so thresholding the mask at any level gives a point set which is evenly spread in each slice and, at each pixel, evenly spread over
+        the slices. The energy of a texel is the sum of a Gaussian of the toroidal distance to the set texels of its slice, plus a Gaussian of the
+        toroidal slice distance to the set texels of the same pixel in the other slices. Distances wrap in both space and time, so the masks tile.
+        Each channel is a separate mask with its own seed. Masks with one slice are plain spatial blue noise.
+        The shader side is in ShadingUtils/BlueNoise.slang: the masks are uploaded as a texture array with one slice per frame.
+    */
+    class BlueNoise
+    {
+    public:
+        using SharedPtr = std::shared_ptr<BlueNoise>;
+        using SharedConstPtr = std::shared_ptr<const BlueNoise>;
+
+        struct Desc
+        {
+            uint32_t size = 64;             ///< Width and height of the slices
+            uint32_t depth = 16;            ///< Number of slices
+            uint32_t channels = 2;          ///< Number of independent masks. 1, 2 or 4, to match the texture formats.
+            float sigmaSpatial = 1.9f;      ///< Standard deviation of the energy filter within a slice, in texels
+            float sigmaTemporal = 1.9f;     ///< Standard deviation of the energy filter across slices
+            float initialDensity = 0.1f;    ///< Fraction of the texels in the initial binary pattern
+            uint32_t seed = 0;
+        };
+
+        /** Generate the masks
+            \param[in] threadCount Number of threads generating the channels. 0 uses one per hardware thread.
+            \return nullptr if the description is invalid
+        */
+        static SharedPtr create(const Desc& desc, uint32_t threadCount = 0);
+
+        /** Load masks written with writeToFile()
+            \return nullptr if the file can't be read
+        */
+        static SharedPtr createFromFile(const std::string& filename);
+
+        /** Write the masks to a binary file, so they can be generated offline
+        */
+        bool writeToFile(const std::string& filename) const;
+
+        /** Generate a single mask
+            \return The rank of each texel, slice after slice, row major
+        */
+        static std::vector<uint32_t> generateMask(uint32_t size, uint32_t depth, float sigmaSpatial, float sigmaTemporal, float initialDensity, uint32_t seed);
+
+        const Desc& getDesc() const { return mDesc; }
+
+        /** Get the ranks of a channel, slice after slice, row major
+        */
+        const std::vector<uint32_t>& getRanks(uint32_t channel) const { return mRanks[channel]; }
+
+        /** Get the value of a texel in [0, 1), (rank + 0.5) / N
+        */
+        float getValue(uint32_t x, uint32_t y, uint32_t slice, uint32_t channel) const;
+
+        /** Get the masks as a 2D texture array, one slice per array element, in R8Unorm, RG8Unorm or RGBA8Unorm. Created on first use.
+        */
+        Texture::SharedPtr getTexture();
+
+    private:
+        BlueNoise(const Desc& desc) : mDesc(desc) {}
+
+        Desc mDesc;
+        std::vector<std::vector<uint32_t>> mRanks;
+        Texture::SharedPtr mpTexture;
+    };
+}
@@ -0,0 +1,534 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "DistributedReference.h"
+#include "Utils/BinaryFileStream.h"
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kCheckpointMagic = 0x43524446;  // "FDRC"
+        const uint32_t kCheckpointVersion = 1;
+
+#ifndef _WIN32
+        // Sockets are blocking: these only return early if the other side is gone
+        bool readAll(int fd, void* pData, size_t size)
+        {
+            uint8_t* pBytes = (uint8_t*)pData;
+            while (size > 0)
+            {
+                ssize_t count = read(fd, pBytes, size);
+                if (count < 0 && errno == EINTR) continue;
+                if (count <= 0) return false;
+                pBytes += count;
+                size -= size_t(count);
+            }
+            return true;
+        }
+
+        bool writeAll(int fd, const void* pData, size_t size)
+        {
+            const uint8_t* pBytes = (const uint8_t*)pData;
+            while (size > 0)
+            {
+                // Don't raise SIGPIPE if the other side is gone
+                ssize_t count = send(fd, pBytes, size, MSG_NOSIGNAL);
+                if (count < 0 && errno == EINTR) continue;
+                if (count <= 0) return false;
+                pBytes += count;
+                size -= size_t(count);
+            }
+            return true;
+        }
+
+        // Worker side of the protocol: read a job, send back its ID followed by its sums, until the coordinator closes the socket
+        void workerMain(int fd, const DistributedReference::RenderFunc& renderFunc)
+        {
+            DistributedReference::Job job;
+            std::vector<double> sums;
+            while (readAll(fd, &job, sizeof(job)))
+            {
+                sums.assign(job.width * job.height * 3, 0.0);
+                renderFunc(job, sums);
+                if (!writeAll(fd, &job.id, sizeof(job.id)) || !writeAll(fd, sums.data(), sums.size() * sizeof(double))) break;
+            }
+        }
+
+        struct Worker
+        {
+            pid_t pid = -1;
+            int fd = -1;                    // Coordinator's end of the socket pair
+            std::deque<uint32_t> inFlight;  // Jobs sent, in the order the results will come back
+        };
+#endif
+    }
+
+    DistributedReference::SharedPtr DistributedReference::create(const Settings& settings, const RenderFunc& renderFunc)
+    {
+        return SharedPtr(new DistributedReference(settings, renderFunc));
+    }
+
+    DistributedReference::DistributedReference(const Settings& settings, const RenderFunc& renderFunc) : mSettings(settings), mRenderFunc(renderFunc)
+    {
+        mSettings.tileSize = std::max(mSettings.tileSize, 1u);
+        mSettings.samplesPerJob = std::max(mSettings.samplesPerJob, 1u);
+        mSettings.jobsInFlight = std::max(mSettings.jobsInFlight, 1u);
+        mTilesX = (mSettings.width + mSettings.tileSize - 1) / mSettings.tileSize;
+        mTilesY = (mSettings.height + mSettings.tileSize - 1) / mSettings.tileSize;
+
+        mSums.assign(mSettings.width * mSettings.height * 3, 0.0);
+        mSampleCounts.assign(mSettings.width * mSettings.height, 0);
+        mJobDone.assign(getJobCount(), 0);
+    }
+
+    DistributedReference::Job DistributedReference::getJob(uint32_t id) const
+    {
+        uint32_t tile = id % getTileCount();
+        uint32_t pass = id / getTileCount();
+
+        Job job;
+        job.id = id;
+        job.x = (tile % mTilesX) * mSettings.tileSize;
+        job.y = (tile / mTilesX) * mSettings.tileSize;
+        job.width = std::min(mSettings.tileSize, mSettings.width - job.x);
+        job.height = std::min(mSettings.tileSize, mSettings.height - job.y);
+        job.sampleBegin = pass * mSettings.samplesPerJob;
+        job.sampleCount = std::min(mSettings.samplesPerJob, mSettings.totalSamples - job.sampleBegin);
+        return job;
+    }
+
+    std::vector<std::deque<uint32_t>> DistributedReference::createQueues(uint32_t queueCount) const
+    {
+        // Queue q gets a contiguous block of tiles, pass after pass
+        std::vector<std::deque<uint32_t>> queues(queueCount);
+        uint32_t tileCount = getTileCount();
+        for (uint32_t pass = 0; pass < getPassCount(); pass++)
+        {
+            for (uint32_t tile = 0; tile < tileCount; tile++)
+            {
+                uint32_t id = pass * tileCount + tile;
+                if (mJobDone[id] == 0) queues[uint64_t(tile) * queueCount / tileCount].push_back(id);
+            }
+        }
+        return queues;
+    }
+
+    bool DistributedReference::render()
+    {
+        if (mResumeChecked == false)
+        {
+            mResumeChecked = true;
+            if (mSettings.checkpointFile.size() && loadCheckpoint())
+            {
+                mStats.resumedJobs = mDoneJobs;
+                logInfo("DistributedReference: resuming from " + mSettings.checkpointFile + " with " + std::to_string(mDoneJobs) + " of " + std::to_string(getJobCount()) + " jobs done");
+            }
+        }
+        if (isComplete()) return true;
+
+        mLastCheckpoint = std::chrono::steady_clock::now();
+        uint32_t jobBudget = mSettings.jobLimit ? mSettings.jobLimit : uint32_t(-1);
+
+        std::vector<std::deque<uint32_t>> queues = createQueues(std::max(mSettings.workerCount, 1u));
+        if (mSettings.workerCount > 0)
+        {
+#ifdef _WIN32
+            renderThreads(queues, jobBudget);
+#else
+            renderWorkers(queues, jobBudget);
+#endif
+        }
+        // Nothing is left unless there were no workers, or all of them failed
+        renderLocal(queues, jobBudget);
+
+        checkpointIfDue(true);
+        return isComplete();
+    }
+
+    void DistributedReference::renderLocal(std::vector<std::deque<uint32_t>>& queues, uint32_t& jobBudget)
+    {
+        std::vector<double> sums;
+        for (auto& queue : queues)
+        {
+            while (queue.size() && jobBudget > 0)
+            {
+                Job job = getJob(queue.front());
+                queue.pop_front();
+                jobBudget--;
+
+                sums.assign(job.width * job.height * 3, 0.0);
+                mRenderFunc(job, sums);
+                addResult(job, sums);
+                mStats.localJobs++;
+                checkpointIfDue(false);
+            }
+        }
+    }
+
+    bool DistributedReference::takeJob(std::vector<std::deque<uint32_t>>& queues, uint32_t worker, uint32_t& jobBudget, uint32_t& id)
+    {
+        // Take the next job of the worker's queue, or steal the last one of the longest queue
+        if (jobBudget == 0) return false;
+        uint32_t victim = worker;
+        if (queues[worker].empty())
+        {
+            for (uint32_t q = 0; q < uint32_t(queues.size()); q++)
+            {
+                if (queues[q].size() > queues[victim].size()) victim = q;
+            }
+            if (queues[victim].empty()) return false;
+        }
+
+        if (victim == worker)
+        {
+            id = queues[worker].front();
+            queues[worker].pop_front();
+        }
+        else
+        {
+            id = queues[victim].back();
+            queues[victim].pop_back();
+            mStats.workers[worker].stolenJobs++;
+        }
+        jobBudget--;
+        return true;
+    }
+
+    void DistributedReference::renderThreads(std::vector<std::deque<uint32_t>>& queues, uint32_t& jobBudget)
+    {
+        mStats.workers.assign(mSettings.workerCount, WorkerStats());
+
+        // The queues, the image and the checkpoints are shared by the threads.  Only rendering runs outside the lock.
+        std::mutex mutex;
+        auto workerMain = [&](uint32_t w)
+        {
+            std::vector<double> sums;
+            std::unique_lock<std::mutex> lock(mutex);
+            uint32_t id;
+            while (takeJob(queues, w, jobBudget, id))
+            {
+                Job job = getJob(id);
+                lock.unlock();
+                sums.assign(job.width * job.height * 3, 0.0);
+                mRenderFunc(job, sums);
+                lock.lock();
+
+                addResult(job, sums);
+                mStats.workers[w].jobs++;
+                checkpointIfDue(false);
+            }
+        };
+
+        // A worker that can't start leaves its queue to the others to steal from
+        std::vector<std::thread> threads;
+        for (uint32_t w = 0; w < mSettings.workerCount; w++)
+        {
+            try
+            {
+                threads.emplace_back(workerMain, w);
+            }
+            catch (const std::system_error&)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                mStats.workers[w].failed = true;
+                logWarning("DistributedReference: can't start worker thread " + std::to_string(w));
+            }
+        }
+        for (auto& thread : threads) thread.join();
+    }
+
+    void DistributedReference::renderWorkers(std::vector<std::deque<uint32_t>>& queues, uint32_t& jobBudget)
+    {
+#ifndef _WIN32
+        std::vector<Worker> workers(mSettings.workerCount);
+        mStats.workers.assign(mSettings.workerCount, WorkerStats());
+
+        for (uint32_t w = 0; w < mSettings.workerCount; w++)
+        {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            {
+                mStats.workers[w].failed = true;
+                continue;
+            }
+
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                // Close the coordinator's ends of the other workers' sockets, or they wouldn't see it close them
+                close(fds[0]);
+                for (uint32_t i = 0; i < w; i++)
+                {
+                    if (workers[i].fd >= 0) close(workers[i].fd);
+                }
+                workerMain(fds[1], mRenderFunc);
+                _exit(0);
+            }
+
+            close(fds[1]);
+            if (pid < 0)
+            {
+                close(fds[0]);
+                mStats.workers[w].failed = true;
+                continue;
+            }
+            workers[w].pid = pid;
+            workers[w].fd = fds[0];
+        }
+
+        auto failWorker = [&](uint32_t w)
+        {
+            Worker& worker = workers[w];
+            close(worker.fd);
+            kill(worker.pid, SIGKILL);
+            waitpid(worker.pid, nullptr, 0);
+            worker.fd = -1;
+            mStats.workers[w].failed = true;
+
+            // Put its jobs back at the front of its queue, where the other workers will steal them
+            mStats.requeuedJobs += uint32_t(worker.inFlight.size());
+            jobBudget += uint32_t(worker.inFlight.size());
+            queues[w].insert(queues[w].begin(), worker.inFlight.begin(), worker.inFlight.end());
+            worker.inFlight.clear();
+            logWarning("DistributedReference: worker " + std::to_string(w) + " failed, its jobs were given to the other workers");
+        };
+
+        std::vector<pollfd> pollFds;
+        std::vector<uint32_t> pollWorkers;
+        std::vector<double> sums;
+        while (true)
+        {
+            // Keep every worker busy
+            for (uint32_t w = 0; w < uint32_t(workers.size()); w++)
+            {
+                uint32_t id;
+                while (workers[w].fd >= 0 && workers[w].inFlight.size() < mSettings.jobsInFlight && takeJob(queues, w, jobBudget, id))
+                {
+                    workers[w].inFlight.push_back(id);
+                    Job job = getJob(id);
+                    if (!writeAll(workers[w].fd, &job, sizeof(job))) failWorker(w);
+                }
+            }
+
+            pollFds.clear();
+            pollWorkers.clear();
+            for (uint32_t w = 0; w < uint32_t(workers.size()); w++)
+            {
+                if (workers[w].fd >= 0 && workers[w].inFlight.size())
+                {
+                    pollFds.push_back({ workers[w].fd, POLLIN, 0 });
+                    pollWorkers.push_back(w);
+                }
+            }
+            if (pollFds.empty()) break;
+
+            if (poll(pollFds.data(), pollFds.size(), -1) < 0)
+            {
+                if (errno == EINTR) continue;
+                logError("DistributedReference: poll() failed, rendering the remaining jobs locally");
+                for (uint32_t w : pollWorkers) failWorker(w);
+                break;
+            }
+
+            for (size_t i = 0; i < pollFds.size(); i++)
+            {
+                if (pollFds[i].revents == 0) continue;
+                uint32_t w = pollWorkers[i];
+                Worker& worker = workers[w];
+
+                uint32_t id;
+                if (!readAll(worker.fd, &id, sizeof(id)) || id != worker.inFlight.front())
+                {
+                    failWorker(w);
+                    continue;
+                }
+                Job job = getJob(id);
+                sums.resize(job.width * job.height * 3);
+                if (!readAll(worker.fd, sums.data(), sums.size() * sizeof(double)))
+                {
+                    failWorker(w);
+                    continue;
+                }
+
+                worker.inFlight.pop_front();
+                addResult(job, sums);
+                mStats.workers[w].jobs++;
+                checkpointIfDue(false);
+            }
+        }
+
+        // Closing the sockets lets the workers exit
+        for (auto& worker : workers)
+        {
+            if (worker.fd < 0) continue;
+            close(worker.fd);
+            waitpid(worker.pid, nullptr, 0);
+        }
+#endif
+    }
+
+    void DistributedReference::addResult(const Job& job, const std::vector<double>& sums)
+    {
+        if (mJobDone[job.id]) return;
+        mJobDone[job.id] = 1;
+        mDoneJobs++;
+
+        for (uint32_t y = 0; y < job.height; y++)
+        {
+            for (uint32_t x = 0; x < job.width; x++)
+            {
+                uint32_t pixel = (job.x + x) + (job.y + y) * mSettings.width;
+                uint32_t tilePixel = x + y * job.width;
+                for (uint32_t c = 0; c < 3; c++) mSums[pixel * 3 + c] += sums[tilePixel * 3 + c];
+                mSampleCounts[pixel] += job.sampleCount;
+            }
+        }
+    }
+
+    std::vector<glm::vec3> DistributedReference::getImage() const
+    {
+        std::vector<glm::vec3> image(mSampleCounts.size(), glm::vec3(0.0f));
+        for (size_t pixel = 0; pixel < image.size(); pixel++)
+        {
+            if (mSampleCounts[pixel] == 0) continue;
+            double scale = 1.0 / double(mSampleCounts[pixel]);
+            image[pixel] = glm::vec3(float(mSums[pixel * 3] * scale), float(mSums[pixel * 3 + 1] * scale), float(mSums[pixel * 3 + 2] * scale));
+        }
+        return image;
+    }
+
+    void DistributedReference::checkpointIfDue(bool force)
+    {
+        if (mSettings.checkpointFile.empty()) return;
+        auto now = std::chrono::steady_clock::now();
+        if (force == false && std::chrono::duration<float>(now - mLastCheckpoint).count() < mSettings.checkpointSeconds) return;
+
+        mLastCheckpoint = now;
+        if (saveCheckpoint()) mStats.checkpoints++;
+        else logWarning("DistributedReference: can't write the checkpoint file " + mSettings.checkpointFile);
+    }
+
+    bool DistributedReference::saveCheckpoint() const
+    {
+        std::string tempFile = mSettings.checkpointFile + ".tmp";
+        BinaryFileStream stream(tempFile, BinaryFileStream::Mode::Write);
+        stream << kCheckpointMagic << kCheckpointVersion;
+        stream << mSettings.width << mSettings.height << mSettings.tileSize << mSettings.samplesPerJob << mSettings.totalSamples;
+        stream.write(mJobDone.data(), mJobDone.size());
+        stream.write(mSums.data(), mSums.size() * sizeof(double));
+        bool written = stream.isGood();
+        stream.close();
+
+        // Only replace the last checkpoint once the new one is complete
+        if (written)
+        {
+#ifdef _WIN32
+            std::remove(mSettings.checkpointFile.c_str());
+#endif
+            written = std::rename(tempFile.c_str(), mSettings.checkpointFile.c_str()) == 0;
+        }
+        if (!written) std::remove(tempFile.c_str());
+        return written;
+    }
+
+    bool DistributedReference::loadCheckpoint()
+    {
+        BinaryFileStream stream(mSettings.checkpointFile, BinaryFileStream::Mode::Read);
+        if (!stream.isGood()) return false;
+
+        uint32_t header[7];
+        stream.read(header, sizeof(header));
+        const uint32_t expected[7] = { kCheckpointMagic, kCheckpointVersion, mSettings.width, mSettings.height, mSettings.tileSize, mSettings.samplesPerJob, mSettings.totalSamples };
+        if (!stream.isGood() || !std::equal(header, header + 7, expected))
+        {
+            logWarning("DistributedReference: " + mSettings.checkpointFile + " was written with other settings, ignoring it");
+            return false;
+        }
+
+        std::vector<uint8_t> jobDone(mJobDone.size());
+        std::vector<double> sums(mSums.size());
+        stream.read(jobDone.data(), jobDone.size());
+        stream.read(sums.data(), sums.size() * sizeof(double));
+        if (stream.isFail())
+        {
+            logWarning("DistributedReference: " + mSettings.checkpointFile + " is truncated, ignoring it");
+            return false;
+        }
+
+        // The sample counts follow from the finished jobs
+        mJobDone = jobDone;
+        mSums = sums;
+        mDoneJobs = 0;
+        std::fill(mSampleCounts.begin(), mSampleCounts.end(), 0);
+        for (uint32_t id = 0; id < getJobCount(); id++)
+        {
+            if (mJobDone[id] == 0) continue;
+            mDoneJobs++;
+            Job job = getJob(id);
+            for (uint32_t y = job.y; y < job.y + job.height; y++)
+            {
+                for (uint32_t x = job.x; x < job.x + job.width; x++) mSampleCounts[x + y * mSettings.width] += job.sampleCount;
+            }
+        }
+        return true;
+    }
+
+    DistributedReference::RenderFunc DistributedReference::pathTracerBackend(const PathTracerReference::Scene& scene, const PathTracerReference::Settings& settings)
+    {
+        // Built once here, so the workers inherit the hierarchy instead of each building their own
+        PathTracerReference::Scene bvhScene = scene;
+        if (bvhScene.bvh.empty()) PathTracerReference::buildBvh(bvhScene);
+
+        return [bvhScene, settings](const Job& job, std::vector<double>& sums)
+        {
+            for (uint32_t s = job.sampleBegin; s < job.sampleBegin + job.sampleCount; s++)
+            {
+                std::vector<glm::vec3> tile = PathTracerReference::renderRecursive(bvhScene, settings, s, job.x, job.y, job.width, job.height);
+                for (size_t i = 0; i < tile.size(); i++)
+                {
+                    for (uint32_t c = 0; c < 3; c++) sums[i * 3 + c] += double(tile[i][c]);
+                }
+            }
+        };
+    }
+}
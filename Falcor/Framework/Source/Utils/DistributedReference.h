@@ -0,0 +1,170 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "glm/vec3.hpp"
+#include "Utils/PathTracerReference.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Offline reference renderer which spreads a frame over worker processes on the local machine.
+        The frame is split into tiles, and the samples of each pixel into passes of samplesPerJob samples. A job is one pass over one tile,
+        and jobs are numbered pass by pass, so the whole frame gets its first samples before any tile gets its second pass.
+        Every worker starts with a queue holding a contiguous block of tiles, for all passes. Workers which run out of jobs steal from the back
+        of the longest queue left. The coordinator sends a few jobs ahead to each worker over a socket pair and adds the partial sums they
+        send back to the image as they arrive, so getImage() converges progressively.
+        The state of the render is regularly written to a checkpoint file, and a later render() with the same settings resumes from it.
+        On Linux, workers are processes forked from the calling process. Windows can't fork, so there they are threads of the calling
+        process, which share the image under a lock and only render outside of it. With a worker count of 0, jobs are rendered in the
+        calling process. A worker process that dies, or a thread that can't be started, has its jobs handed to the others.
+    */
+    class DistributedReference
+    {
+    public:
+        using SharedPtr = std::shared_ptr<DistributedReference>;
+
+        struct Job
+        {
+            uint32_t id = 0;
+            uint32_t x = 0;                 ///< Top left pixel of the tile
+            uint32_t y = 0;
+            uint32_t width = 0;             ///< Tiles on the right and bottom edges can be smaller than the tile size
+            uint32_t height = 0;
+            uint32_t sampleBegin = 0;       ///< Index of the job's first sample in every pixel
+            uint32_t sampleCount = 0;
+        };
+
+        /** Renders the samples of a job and adds their radiance to sums, which holds 3 values per pixel of the tile, row by row.
+            Called from the worker processes, which inherit everything the function uses when they start. On Windows, several worker
+            threads call it at once.
+        */
+        using RenderFunc = std::function<void(const Job& job, std::vector<double>& sums)>;
+
+        struct Settings
+        {
+            uint32_t width = 64;
+            uint32_t height = 64;
+            uint32_t tileSize = 16;
+            uint32_t samplesPerJob = 4;
+            uint32_t totalSamples = 64;         ///< Samples per pixel of the finished image
+            uint32_t workerCount = 4;           ///< Worker processes (threads on Windows) to start, 0 to render in the calling process
+            uint32_t jobsInFlight = 2;          ///< Jobs sent to a worker ahead of its results, to hide the round trips
+            std::string checkpointFile;         ///< Empty to disable checkpoints
+            float checkpointSeconds = 60.0f;    ///< Time between checkpoints. One is always written when render() returns.
+            uint32_t jobLimit = 0;              ///< Stop render() after this many jobs (0 for no limit), e.g. to split a render over several runs
+        };
+
+        struct WorkerStats
+        {
+            uint32_t jobs = 0;              ///< Jobs the worker finished
+            uint32_t stolenJobs = 0;        ///< Jobs it took from another worker's queue
+            bool failed = false;            ///< The worker died or couldn't be started
+        };
+
+        struct Stats
+        {
+            std::vector<WorkerStats> workers;   ///< Of the last render() call
+            uint32_t resumedJobs = 0;           ///< Jobs loaded from the checkpoint file
+            uint32_t requeuedJobs = 0;          ///< Jobs of failed workers which were given to another one
+            uint32_t localJobs = 0;             ///< Jobs rendered in the calling process
+            uint32_t checkpoints = 0;           ///< Checkpoint files written
+        };
+
+        /** Create a renderer. Nothing is rendered until render() is called.
+        */
+        static SharedPtr create(const Settings& settings, const RenderFunc& renderFunc);
+
+        /** Render all jobs which aren't done yet, resuming from the checkpoint file if there is one
+            \return true if the image is complete, false if the job limit stopped the render
+        */
+        bool render();
+
+        /** Get the average radiance of every pixel over the samples rendered so far, row by row
+        */
+        std::vector<glm::vec3> getImage() const;
+
+        /** Get the number of samples rendered so far in every pixel, row by row
+        */
+        const std::vector<uint32_t>& getSampleCounts() const { return mSampleCounts; }
+
+        bool isComplete() const { return mDoneJobs == getJobCount(); }
+        uint32_t getJobCount() const { return getTileCount() * getPassCount(); }
+        uint32_t getDoneJobCount() const { return mDoneJobs; }
+        uint32_t getTileCount() const { return mTilesX * mTilesY; }
+        uint32_t getPassCount() const { return (mSettings.totalSamples + mSettings.samplesPerJob - 1) / mSettings.samplesPerJob; }
+        Job getJob(uint32_t id) const;
+
+        const Stats& getStats() const { return mStats; }
+        const Settings& getSettings() const { return mSettings; }
+
+        /** Write the sums and the finished jobs, to a temporary file which then replaces the checkpoint file
+            \return false if the file couldn't be written
+        */
+        bool saveCheckpoint() const;
+
+        /** Replace the state of the render with the checkpoint file's
+            \return false if there's no checkpoint file, or it was written with other settings
+        */
+        bool loadCheckpoint();
+
+        /** Get a render function tracing PathTracerReference's paths. Sample s of a pixel is rendered as frame s.
+            The path tracer settings' width and height must be the renderer's. The function builds the scene's hierarchy if it doesn't have one.
+        */
+        static RenderFunc pathTracerBackend(const PathTracerReference::Scene& scene, const PathTracerReference::Settings& settings);
+
+    private:
+        DistributedReference(const Settings& settings, const RenderFunc& renderFunc);
+
+        std::vector<std::deque<uint32_t>> createQueues(uint32_t queueCount) const;
+        void renderLocal(std::vector<std::deque<uint32_t>>& queues, uint32_t& jobBudget);
+        void renderWorkers(std::vector<std::deque<uint32_t>>& queues, uint32_t& jobBudget);
+        void renderThreads(std::vector<std::deque<uint32_t>>& queues, uint32_t& jobBudget);
+        bool takeJob(std::vector<std::deque<uint32_t>>& queues, uint32_t worker, uint32_t& jobBudget, uint32_t& id);
+        void addResult(const Job& job, const std::vector<double>& sums);
+        void checkpointIfDue(bool force);
+
+        Settings mSettings;
+        RenderFunc mRenderFunc;
+        uint32_t mTilesX = 0;
+        uint32_t mTilesY = 0;
+
+        std::vector<double> mSums;          ///< Radiance sums, 3 per pixel
+        std::vector<uint32_t> mSampleCounts;
+        std::vector<uint8_t> mJobDone;      ///< Indexed by job ID
+        uint32_t mDoneJobs = 0;
+        bool mResumeChecked = false;
+        std::chrono::steady_clock::time_point mLastCheckpoint;
+        Stats mStats;
+    };
+}
@@ -0,0 +1,202 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    DynamicResolution::SharedPtr DynamicResolution::create(const Settings& settings)
+    {
+        return SharedPtr(new DynamicResolution(settings));
+    }
+
+    uint32_t DynamicResolution::addGroup(const GroupDesc& desc)
+    {
+        Group group;
+        group.desc = desc;
+        if (desc.parent != kNoParent && desc.parent >= mGroups.size())
+        {
+            logWarning("DynamicResolution: the parent of group '" + desc.name + "' must be added first. Ignoring it.");
+            group.desc.parent = kNoParent;
+        }
+        group.desc.minScale = std::max(desc.minScale, 0.01f);
+        group.desc.maxScale = std::max(desc.maxScale, group.desc.minScale);
+        group.desc.priority = std::max(desc.priority, 0.01f);
+        mGroups.push_back(group);
+        reset();
+        return uint32_t(mGroups.size() - 1);
+    }
+
+    void DynamicResolution::reset()
+    {
+        std::vector<float> scales;
+        for (auto& group : mGroups)
+        {
+            group.scale = group.desc.maxScale;
+            group.cost = 0;
+            group.hasCost = false;
+            scales.push_back(group.scale);
+        }
+        mScaleHistory.assign(mSettings.latency + 1, scales);
+        mFrameMs = 0;
+        mFixedMs = 0;
+        mError = 0;
+        mIntegral = 0;
+        mHasTimings = false;
+    }
+
+    float DynamicResolution::effectiveScale(const std::vector<float>& scales, uint32_t group) const
+    {
+        float scale = scales[group];
+        for (uint32_t p = mGroups[group].desc.parent; p != kNoParent; p = mGroups[p].desc.parent)
+        {
+            scale *= scales[p];
+        }
+        return scale;
+    }
+
+    float DynamicResolution::getScale(uint32_t group) const
+    {
+        float scale = mGroups[group].scale;
+        for (uint32_t p = mGroups[group].desc.parent; p != kNoParent; p = mGroups[p].desc.parent)
+        {
+            scale *= mGroups[p].scale;
+        }
+        return scale;
+    }
+
+    float DynamicResolution::idealScale(const Group& group, float level) const
+    {
+        // A higher priority bends the curve up, so the group only gives up resolution once the others went down a good deal
+        return group.desc.minScale + (group.desc.maxScale - group.desc.minScale) * std::pow(level, 1.0f / group.desc.priority);
+    }
+
+    float DynamicResolution::quantize(const GroupDesc& desc, float scale)
+    {
+        // Round down, so the scales never cost more than the level they come from
+        if (desc.scaleStep > 0) scale = desc.minScale + std::floor((scale - desc.minScale) / desc.scaleStep + 1e-3f) * desc.scaleStep;
+        return glm::clamp(scale, desc.minScale, desc.maxScale);
+    }
+
+    float DynamicResolution::predictGroups(float level) const
+    {
+        std::vector<float> scales(mGroups.size());
+        for (size_t i = 0; i < mGroups.size(); i++) scales[i] = quantize(mGroups[i].desc, idealScale(mGroups[i], level));
+
+        float time = 0;
+        for (uint32_t i = 0; i < uint32_t(mGroups.size()); i++)
+        {
+            float s = effectiveScale(scales, i);
+            time += mGroups[i].cost * s * s;
+        }
+        return time;
+    }
+
+    float DynamicResolution::getPredictedFrameTime() const
+    {
+        float time = mFixedMs;
+        for (uint32_t i = 0; i < uint32_t(mGroups.size()); i++)
+        {
+            float s = getScale(i);
+            time += mGroups[i].cost * s * s;
+        }
+        return time;
+    }
+
+    void DynamicResolution::update(float frameMs, const std::vector<float>& groupMs)
+    {
+        if (groupMs.size() != mGroups.size())
+        {
+            logWarning("DynamicResolution::update() expects one time per group. Ignoring the frame.");
+            return;
+        }
+        const float a = mHasTimings ? mSettings.smoothing : 1.0f;
+
+        // The timings belong to the frame rendered 'latency' frames ago, so that's the scales the costs are relative to
+        const std::vector<float>& measuredScales = mScaleHistory.front();
+        float groupSum = 0;
+        for (uint32_t i = 0; i < uint32_t(mGroups.size()); i++)
+        {
+            Group& group = mGroups[i];
+            float s = effectiveScale(measuredScales, i);
+            float cost = std::max(groupMs[i], 0.0f) / std::max(s * s, 1e-4f);
+            group.cost = group.hasCost ? group.cost + (cost - group.cost) * mSettings.smoothing : cost;
+            group.hasCost = true;
+            groupSum += std::max(groupMs[i], 0.0f);
+        }
+        mFixedMs += (std::max(frameMs - groupSum, 0.0f) - mFixedMs) * a;
+        mFrameMs += (frameMs - mFrameMs) * a;
+
+        // PID on the frame time error. With an exact cost model the correction settles at zero; otherwise the integral makes up for the model.
+        float error = mSettings.targetMs - mFrameMs;
+        float derivative = mHasTimings ? error - mError : 0.0f;
+        mError = error;
+        mHasTimings = true;
+        float budget = mSettings.targetMs - mFixedMs + mSettings.kp * error + mSettings.ki * mIntegral + mSettings.kd * derivative;
+
+        // Every group's scale grows with the level, so find the highest level which fits in the budget by bisection
+        float level = 1.0f;
+        if (predictGroups(1.0f) > budget)
+        {
+            float lo = 0.0f, hi = 1.0f;
+            for (uint32_t i = 0; i < 24; i++)
+            {
+                float mid = 0.5f * (lo + hi);
+                if (predictGroups(mid) > budget) hi = mid;
+                else lo = mid;
+            }
+            level = lo;
+        }
+
+        // Don't wind up the integral while the scales can't move in the direction it asks for
+        bool saturated = (level >= 1.0f && error > 0) || (level <= 0.0f && error < 0);
+        if (!saturated && mSettings.ki > 0)
+        {
+            float maxIntegral = 0.25f * mSettings.targetMs / mSettings.ki;
+            mIntegral = glm::clamp(mIntegral + error, -maxIntegral, maxIntegral);
+        }
+
+        // Shrink as soon as the level asks for it, but only grow with some headroom to spare
+        for (auto& group : mGroups)
+        {
+            const GroupDesc& desc = group.desc;
+            float ideal = idealScale(group, level);
+            float shrunk = quantize(desc, ideal);
+            float grown = (ideal >= desc.maxScale) ? desc.maxScale : quantize(desc, ideal - mSettings.hysteresis * desc.scaleStep);
+            if (shrunk < group.scale) group.scale = shrunk;
+            else if (grown > group.scale) group.scale = grown;
+        }
+
+        std::vector<float> scales;
+        for (const auto& group : mGroups) scales.push_back(group.scale);
+        mScaleHistory.push_back(scales);
+        while (mScaleHistory.size() > mSettings.latency + 1) mScaleHistory.pop_front();
+    }
+}
@@ -0,0 +1,145 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Picks the internal resolution of groups of render passes so that frames hit a target GPU time.
+        Each group is modeled as costing C * s^2, where s is its resolution scale. C is estimated every frame from the measured group times,
+        and whatever the groups don't account for is treated as a fixed cost. The scales are then chosen so the predicted frame time matches
+        the budget, corrected by a PID loop on the measured frame time to absorb what the model gets wrong.
+        A group can be the child of another one, in which case its scale is relative to its parent's (e.g. rays traced per G-buffer pixel).
+        Scales are rounded down to steps, and only grow back once there is some headroom left, so they don't flicker between frames.
+        The controller only does arithmetic, so it can run against measured or simulated timings alike.
+    */
+    class DynamicResolution
+    {
+    public:
+        using SharedPtr = std::shared_ptr<DynamicResolution>;
+
+        static const uint32_t kNoParent = uint32_t(-1);
+
+        struct GroupDesc
+        {
+            std::string name;
+            float minScale = 0.5f;          ///< Smallest scale, relative to the parent's if there is one
+            float maxScale = 1.0f;          ///< Largest scale, relative to the parent's if there is one
+            float scaleStep = 0.05f;        ///< Scales are multiples of this (from minScale)
+            float priority = 1.0f;          ///< Groups with a higher priority keep more of their resolution when over budget
+            uint32_t parent = kNoParent;    ///< Must be added before its children
+        };
+
+        struct Settings
+        {
+            float targetMs = 16.6f;         ///< Frame time to hit
+            float kp = 0.25f;               ///< Proportional gain, in budget ms per ms of error
+            float ki = 0.1f;                ///< Integral gain
+            float kd = 0.05f;               ///< Derivative gain
+            float smoothing = 0.2f;         ///< Weight of the newest measurement in the cost and frame time averages
+            float hysteresis = 0.5f;        ///< Additional steps of headroom needed before a scale grows
+            uint32_t latency = 1;           ///< Frames between changing the scales and measuring their effect
+        };
+
+        /** Create a controller without any group. Every group starts at its largest scale.
+        */
+        static SharedPtr create(const Settings& settings);
+        static SharedPtr create() { return create(Settings()); }
+
+        /** Add a group of passes whose resolution the controller picks
+            \return The group index, used to pass its times to update() and to get its scale
+        */
+        uint32_t addGroup(const GroupDesc& desc);
+
+        /** Feed the timings of a frame and pick the scales of the next one
+            \param[in] frameMs GPU time of the frame
+            \param[in] groupMs GPU time of each group during that frame, indexed like the groups
+        */
+        void update(float frameMs, const std::vector<float>& groupMs);
+
+        /** Forget the cost estimates and go back to the largest scales (e.g. when the pipeline changes)
+        */
+        void reset();
+
+        /** Get the scale of a group, relative to the output resolution
+        */
+        float getScale(uint32_t group) const;
+
+        /** Get the scale of a group, relative to its parent's
+        */
+        float getRelativeScale(uint32_t group) const { return mGroups[group].scale; }
+
+        /** Get the frame time the model predicts for the current scales
+        */
+        float getPredictedFrameTime() const;
+
+        /** Get the smoothed frame time the PID loop is working with
+        */
+        float getFrameTime() const { return mFrameMs; }
+
+        /** Get the time of the passes outside of any group
+        */
+        float getFixedTime() const { return mFixedMs; }
+
+        uint32_t getGroupCount() const { return uint32_t(mGroups.size()); }
+        const GroupDesc& getGroupDesc(uint32_t group) const { return mGroups[group].desc; }
+
+        void setSettings(const Settings& settings) { mSettings = settings; }
+        const Settings& getSettings() const { return mSettings; }
+
+    private:
+        DynamicResolution(const Settings& settings) : mSettings(settings) {}
+
+        struct Group
+        {
+            GroupDesc desc;
+            float scale = 1;        ///< Current scale, relative to the parent's
+            float cost = 0;         ///< Estimated time at full resolution
+            bool hasCost = false;
+        };
+
+        static float quantize(const GroupDesc& desc, float scale);
+        float idealScale(const Group& group, float level) const;
+        float predictGroups(float level) const;
+        float effectiveScale(const std::vector<float>& scales, uint32_t group) const;
+
+        Settings mSettings;
+        std::vector<Group> mGroups;
+        std::deque<std::vector<float>> mScaleHistory;   ///< Scales of the last frames, the oldest being the ones the timings were measured with
+
+        float mFrameMs = 0;
+        float mFixedMs = 0;
+        float mError = 0;
+        float mIntegral = 0;
+        bool mHasTimings = false;
+    };
+}
@@ -0,0 +1,220 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "GpuMemoryTracker.h"
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct TrackerData
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, uint32_t> ownerIds;
+            std::vector<GpuMemoryTracker::OwnerStats> owners;
+            uint64_t liveBytes = 0;
+            uint64_t peakBytes = 0;
+
+            TrackerData()
+            {
+                ownerIds["Untracked"] = GpuMemoryTracker::kUntracked;
+                owners.resize(1);
+                owners[0].name = "Untracked";
+            }
+        };
+
+        // Resources can be created and destroyed during static destruction, so the data is never freed
+        TrackerData& getData()
+        {
+            static TrackerData* pData = new TrackerData;
+            return *pData;
+        }
+
+        std::vector<uint32_t>& getScopeStack()
+        {
+            static thread_local std::vector<uint32_t> stack;
+            return stack;
+        }
+
+        std::string escapeJson(const std::string& s)
+        {
+            std::string out;
+            for (char c : s)
+            {
+                if (c == '"' || c == '\\') out += '\\';
+                if (uint8_t(c) < 0x20) continue;
+                out += c;
+            }
+            return out;
+        }
+    }
+
+    GpuMemoryTracker::Scope::Scope(const std::string& owner)
+    {
+        getScopeStack().push_back(getOwnerId(owner));
+    }
+
+    GpuMemoryTracker::Scope::~Scope()
+    {
+        assert(getScopeStack().size());
+        getScopeStack().pop_back();
+    }
+
+    uint32_t GpuMemoryTracker::getOwnerId(const std::string& owner)
+    {
+        TrackerData& data = getData();
+        std::lock_guard<std::mutex> lock(data.mutex);
+        auto it = data.ownerIds.find(owner);
+        if (it != data.ownerIds.end()) return it->second;
+
+        uint32_t id = uint32_t(data.owners.size());
+        data.ownerIds[owner] = id;
+        data.owners.emplace_back();
+        data.owners.back().name = owner;
+        return id;
+    }
+
+    uint32_t GpuMemoryTracker::getCurrentOwner()
+    {
+        const auto& stack = getScopeStack();
+        return stack.empty() ? kUntracked : stack.back();
+    }
+
+    uint32_t GpuMemoryTracker::track(Category category, uint64_t bytes)
+    {
+        uint32_t ownerId = getCurrentOwner();
+        TrackerData& data = getData();
+        std::lock_guard<std::mutex> lock(data.mutex);
+
+        OwnerStats& owner = data.owners[ownerId];
+        if (category == Category::Texture)
+        {
+            owner.textureBytes += bytes;
+            owner.textureCount++;
+        }
+        else
+        {
+            owner.bufferBytes += bytes;
+            owner.bufferCount++;
+        }
+        owner.liveBytes += bytes;
+        owner.peakBytes = std::max(owner.peakBytes, owner.liveBytes);
+        data.liveBytes += bytes;
+        data.peakBytes = std::max(data.peakBytes, data.liveBytes);
+        return ownerId;
+    }
+
+    void GpuMemoryTracker::untrack(uint32_t ownerId, Category category, uint64_t bytes)
+    {
+        TrackerData& data = getData();
+        std::lock_guard<std::mutex> lock(data.mutex);
+        assert(ownerId < data.owners.size());
+
+        OwnerStats& owner = data.owners[ownerId];
+        if (category == Category::Texture)
+        {
+            assert(owner.textureBytes >= bytes && owner.textureCount > 0);
+            owner.textureBytes -= bytes;
+            owner.textureCount--;
+        }
+        else
+        {
+            assert(owner.bufferBytes >= bytes && owner.bufferCount > 0);
+            owner.bufferBytes -= bytes;
+            owner.bufferCount--;
+        }
+        owner.liveBytes -= bytes;
+        data.liveBytes -= bytes;
+    }
+
+    GpuMemoryTracker::Report GpuMemoryTracker::getReport()
+    {
+        Report report;
+        {
+            TrackerData& data = getData();
+            std::lock_guard<std::mutex> lock(data.mutex);
+            report.liveBytes = data.liveBytes;
+            report.peakBytes = data.peakBytes;
+            for (const auto& owner : data.owners)
+            {
+                if (owner.peakBytes > 0) report.owners.push_back(owner);
+            }
+        }
+
+        std::stable_sort(report.owners.begin(), report.owners.end(), [](const OwnerStats& a, const OwnerStats& b) { return a.liveBytes > b.liveBytes; });
+        return report;
+    }
+
+    void GpuMemoryTracker::resetPeaks()
+    {
+        TrackerData& data = getData();
+        std::lock_guard<std::mutex> lock(data.mutex);
+        data.peakBytes = data.liveBytes;
+        for (auto& owner : data.owners) owner.peakBytes = owner.liveBytes;
+    }
+
+    std::string GpuMemoryTracker::toJson(const std::string& label)
+    {
+        Report report = getReport();
+
+        std::ostringstream json;
+        json << "{\n";
+        json << "    \"label\": \"" << escapeJson(label) << "\",\n";
+        json << "    \"liveBytes\": " << report.liveBytes << ",\n";
+        json << "    \"peakBytes\": " << report.peakBytes << ",\n";
+        json << "    \"owners\": [";
+        for (size_t i = 0; i < report.owners.size(); i++)
+        {
+            const OwnerStats& owner = report.owners[i];
+            json << (i ? ",\n" : "\n");
+            json << "        { \"name\": \"" << escapeJson(owner.name) << "\""
+                 << ", \"liveBytes\": " << owner.liveBytes
+                 << ", \"peakBytes\": " << owner.peakBytes
+                 << ", \"textureBytes\": " << owner.textureBytes
+                 << ", \"textureCount\": " << owner.textureCount
+                 << ", \"bufferBytes\": " << owner.bufferBytes
+                 << ", \"bufferCount\": " << owner.bufferCount << " }";
+        }
+        json << (report.owners.empty() ? "]\n" : "\n    ]\n");
+        json << "}\n";
+        return json.str();
+    }
+
+    bool GpuMemoryTracker::dumpJson(const std::string& filename, const std::string& label)
+    {
+        std::ofstream file(filename);
+        if (!file.is_open()) return false;
+        file << toJson(label);
+        return file.good();
+    }
+}
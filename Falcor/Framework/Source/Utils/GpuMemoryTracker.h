@@ -0,0 +1,116 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Accounts for GPU memory by owner.
+        Textures and buffers report their size when they are created and when they are destroyed. The owner is the
+        innermost GpuMemoryTracker::Scope that is open on the creating thread, so a render pass or subsystem can claim
+        everything it allocates (including FBOs and acceleration structures created deep inside helpers) by opening
+        a scope around its callbacks. Allocations made outside of any scope are reported as "Untracked".
+        The tracker is pure bookkeeping and doesn't depend on the device.
+    */
+    class GpuMemoryTracker
+    {
+    public:
+        static const uint32_t kUntracked = 0;   ///< Owner ID of allocations made outside of any scope
+
+        enum class Category
+        {
+            Texture,
+            Buffer,
+        };
+
+        struct OwnerStats
+        {
+            std::string name;
+            uint64_t liveBytes = 0;             ///< Bytes currently allocated by this owner
+            uint64_t peakBytes = 0;             ///< Highest value liveBytes reached since the last resetPeaks()
+            uint64_t textureBytes = 0;
+            uint64_t bufferBytes = 0;
+            uint32_t textureCount = 0;
+            uint32_t bufferCount = 0;
+        };
+
+        struct Report
+        {
+            uint64_t liveBytes = 0;             ///< Bytes currently allocated, over all owners
+            uint64_t peakBytes = 0;             ///< Highest total since the last resetPeaks()
+            std::vector<OwnerStats> owners;     ///< Owners that ever allocated something, sorted by decreasing liveBytes
+        };
+
+        /** Attributes allocations made on this thread to an owner, for the lifetime of the object. Scopes nest.
+        */
+        class Scope
+        {
+        public:
+            Scope(const std::string& owner);
+            ~Scope();
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+
+        /** Get the ID of an owner, registering it if this is the first time we see it
+        */
+        static uint32_t getOwnerId(const std::string& owner);
+
+        /** Get the owner new allocations on this thread will be attributed to
+        */
+        static uint32_t getCurrentOwner();
+
+        /** Record an allocation.
+            \return The owner it was attributed to. Pass it back to untrack() when the memory is released.
+        */
+        static uint32_t track(Category category, uint64_t bytes);
+
+        /** Record a release
+        */
+        static void untrack(uint32_t ownerId, Category category, uint64_t bytes);
+
+        /** Get a snapshot of the current accounting
+        */
+        static Report getReport();
+
+        /** Restart peak tracking from the current live values, e.g. after a resolution change
+        */
+        static void resetPeaks();
+
+        /** Serialize the report as JSON.
+            \param[in] label Optional free-form label stored in the report (resolution, scene, build...)
+        */
+        static std::string toJson(const std::string& label = "");
+
+        /** Write the JSON report to a file. Returns false if the file can't be opened.
+        */
+        static bool dumpJson(const std::string& filename, const std::string& label = "");
+    };
+}
@@ -0,0 +1,255 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "LowDiscrepancy.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kPrimes[LowDiscrepancy::kHaltonDimensions] =
+        {
+            2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131
+        };
+
+        // Primitive polynomials and initial direction numbers of the dimensions after the first, from Joe and Kuo's new-joe-kuo-6.21201.
+        //     The polynomial has the given degree, and its coefficients other than the first and last are the bits of 'a'.
+        struct SobolPolynomial
+        {
+            uint32_t degree;
+            uint32_t a;
+            uint32_t m[7];
+        };
+
+        const SobolPolynomial kSobolPolynomials[LowDiscrepancy::kSobolDimensions - 1] =
+        {
+            { 1,  0, { 1 } },
+            { 2,  1, { 1, 3 } },
+            { 3,  1, { 1, 3, 1 } },
+            { 3,  2, { 1, 1, 1 } },
+            { 4,  1, { 1, 1, 3, 3 } },
+            { 4,  4, { 1, 3, 5, 13 } },
+            { 5,  2, { 1, 1, 5, 5, 17 } },
+            { 5,  4, { 1, 1, 5, 5, 5 } },
+            { 5,  7, { 1, 1, 7, 11, 19 } },
+            { 5, 11, { 1, 1, 5, 1, 1 } },
+            { 5, 13, { 1, 1, 1, 3, 11 } },
+            { 5, 14, { 1, 3, 5, 5, 31 } },
+            { 6,  1, { 1, 3, 3, 9, 7, 49 } },
+            { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+            { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+            { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+            { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+            { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+            { 7,  1, { 1, 3, 7, 11, 23, 15, 103 } },
+            { 7,  4, { 1, 3, 7, 13, 13, 15, 69 } },
+            { 7,  7, { 1, 1, 3, 13, 7, 35, 63 } },
+            { 7,  8, { 1, 3, 5, 9, 1, 25, 53 } },
+            { 7, 14, { 1, 3, 1, 13, 9, 35, 107 } },
+            { 7, 19, { 1, 3, 1, 5, 27, 61, 31 } },
+            { 7, 21, { 1, 1, 5, 11, 19, 41, 61 } },
+            { 7, 28, { 1, 3, 5, 3, 3, 13, 69 } },
+            { 7, 31, { 1, 1, 7, 13, 1, 19, 1 } },
+            { 7, 32, { 1, 3, 7, 5, 13, 19, 59 } },
+            { 7, 37, { 1, 1, 3, 9, 25, 29, 41 } },
+            { 7, 41, { 1, 3, 5, 13, 23, 1, 55 } },
+            { 7, 42, { 1, 3, 7, 3, 13, 59, 17 } },
+        };
+
+        // 1 / g and 1 / g^2 for the plastic number g, in 0.32 fixed point
+        const uint32_t kR2Alpha[2] = { 0xC13FA9A9u, 0x91E10DA5u };
+
+        std::vector<uint32_t> computeSobolDirections()
+        {
+            std::vector<uint32_t> directions(LowDiscrepancy::kSobolDimensions * 32);
+
+            // The first dimension is the van der Corput sequence
+            for (uint32_t bit = 0; bit < 32; bit++) directions[bit] = 1u << (31 - bit);
+
+            for (uint32_t dim = 1; dim < LowDiscrepancy::kSobolDimensions; dim++)
+            {
+                const SobolPolynomial& poly = kSobolPolynomials[dim - 1];
+                uint32_t* v = &directions[dim * 32];
+                for (uint32_t bit = 0; bit < 32; bit++)
+                {
+                    if (bit < poly.degree)
+                    {
+                        v[bit] = poly.m[bit] << (31 - bit);
+                        continue;
+                    }
+                    v[bit] = v[bit - poly.degree] ^ (v[bit - poly.degree] >> poly.degree);
+                    for (uint32_t k = 1; k < poly.degree; k++)
+                    {
+                        if ((poly.a >> (poly.degree - 1 - k)) & 1) v[bit] ^= v[bit - k];
+                    }
+                }
+            }
+            return directions;
+        }
+
+        uint32_t reverseBits(uint32_t x)
+        {
+            x = (x << 16) | (x >> 16);
+            x = ((x & 0x00ff00ff) << 8) | ((x & 0xff00ff00) >> 8);
+            x = ((x & 0x0f0f0f0f) << 4) | ((x & 0xf0f0f0f0) >> 4);
+            x = ((x & 0x33333333) << 2) | ((x & 0xcccccccc) >> 2);
+            x = ((x & 0x55555555) << 1) | ((x & 0xaaaaaaaa) >> 1);
+            return x;
+        }
+
+        // Keep 24 bits, so the result is exactly representable and below 1
+        float toFloat(uint32_t bits)
+        {
+            return float(bits >> 8) * (1.0f / 16777216.0f);
+        }
+
+        uint32_t toBits(float x)
+        {
+            return uint32_t(x * 16777216.0f) << 8;
+        }
+    }
+
+    uint32_t LowDiscrepancy::hash(uint32_t x)
+    {
+        // PCG hash, from Jarzynski and Olano's "Hash Functions for GPU Rendering"
+        uint32_t state = x * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    uint32_t LowDiscrepancy::hashCombine(uint32_t seed, uint32_t value)
+    {
+        return hash(seed ^ hash(value));
+    }
+
+    uint32_t LowDiscrepancy::nestedUniformScramble(uint32_t x, uint32_t seed)
+    {
+        // Laine and Karras' permutation flips each bit depending on the ones below it, so reverse the bits around it
+        x = reverseBits(x);
+        x += seed;
+        x ^= x * 0x6c50b47cu;
+        x ^= x * 0xb82f1e52u;
+        x ^= x * 0xc7afe638u;
+        x ^= x * 0x8d22f6e6u;
+        return reverseBits(x);
+    }
+
+    const std::vector<uint32_t>& LowDiscrepancy::getSobolDirections()
+    {
+        static const std::vector<uint32_t> directions = computeSobolDirections();
+        return directions;
+    }
+
+    float LowDiscrepancy::radicalInverse(uint32_t base, uint32_t index)
+    {
+        float invBase = 1.0f / float(base);
+        float mult = invBase;
+        float result = 0.0f;
+        for (; index != 0; index /= base, mult *= invBase) result += float(index % base) * mult;
+        // Long runs of the last digit round up to 1
+        return std::min(result, 16777215.0f / 16777216.0f);
+    }
+
+    float LowDiscrepancy::halton(uint32_t dimension, uint32_t index)
+    {
+        return radicalInverse(kPrimes[dimension % kHaltonDimensions], index);
+    }
+
+    uint32_t LowDiscrepancy::sobolBits(uint32_t dimension, uint32_t index)
+    {
+        const uint32_t* v = &getSobolDirections()[(dimension % kSobolDimensions) * 32];
+        uint32_t result = 0;
+        for (uint32_t bit = 0; index != 0; bit++, index >>= 1)
+        {
+            if (index & 1) result ^= v[bit];
+        }
+        return result;
+    }
+
+    float LowDiscrepancy::sobol(uint32_t dimension, uint32_t index)
+    {
+        return toFloat(sobolBits(dimension, index));
+    }
+
+    glm::vec2 LowDiscrepancy::r2(uint32_t index)
+    {
+        return glm::vec2(toFloat(0x80000000u + index * kR2Alpha[0]), toFloat(0x80000000u + index * kR2Alpha[1]));
+    }
+
+    float LowDiscrepancy::sample(Sequence sequence, uint32_t dimension, uint32_t index, uint32_t seed)
+    {
+        // Even salts seed the values of a dimension, odd ones the index shuffles
+        switch (sequence)
+        {
+        case Sequence::Halton:
+        {
+            if (dimension >= kHaltonDimensions) index = nestedUniformScramble(index, hashCombine(seed, 2 * (dimension / kHaltonDimensions) + 1));
+            return toFloat(toBits(halton(dimension, index)) + hashCombine(seed, 2 * dimension));
+        }
+        case Sequence::Sobol:
+        {
+            // Every dimension of a sample must use the same shuffle to keep the points stratified
+            uint32_t shuffled = nestedUniformScramble(index, hashCombine(seed, 2 * (dimension / kSobolDimensions) + 1));
+            return toFloat(nestedUniformScramble(sobolBits(dimension, shuffled), hashCombine(seed, 2 * dimension)));
+        }
+        case Sequence::R2:
+        {
+            uint32_t pair = dimension / 2;
+            uint32_t shuffled = nestedUniformScramble(index, hashCombine(seed, 2 * pair + 1));
+            return toFloat(shuffled * kR2Alpha[dimension & 1] + hashCombine(seed, 2 * dimension));
+        }
+        default:
+            should_not_get_here();
+            return 0.0f;
+        }
+    }
+
+    LowDiscrepancy::SampleState LowDiscrepancy::initSampleState(Sequence sequence, uint32_t index, uint32_t seed)
+    {
+        SampleState state;
+        state.sequence = sequence;
+        state.index = index;
+        state.seed = seed;
+        state.dimension = 0;
+        return state;
+    }
+
+    float LowDiscrepancy::next1D(SampleState& state)
+    {
+        return sample(state.sequence, state.dimension++, state.index, state.seed);
+    }
+
+    glm::vec2 LowDiscrepancy::next2D(SampleState& state)
+    {
+        // Keep R2 pairs together
+        if (state.sequence == Sequence::R2) state.dimension = (state.dimension + 1) & ~1u;
+        float x = next1D(state);
+        return glm::vec2(x, next1D(state));
+    }
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "glm/vec2.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Low-discrepancy sequences, for sample indices of any length. ShadingUtils/LowDiscrepancy.slang implements the same functions
+        for the shaders, and returns the same values.
+        - Halton: radical inverses in the first 32 prime bases. Dimensions past 32 reuse the bases with a shuffled sample index.
+          Two large bases are correlated until there are many more samples than their product, so Halton is best kept to the first
+          few dimensions, like camera jitter.
+        - Sobol: 32 dimensions from Joe and Kuo's direction numbers, Owen-scrambled with the hash-based nested uniform scramble
+          from Burley's "Practical Hash-based Owen Scrambling". The sample index is scrambled as well, which shuffles the order of the
+          points but keeps every aligned power-of-two block of them stratified. Dimensions past 32 are padded with another shuffle.
+        - R2: Roberts' additive recurrence on the plastic number, in 32 bit fixed point so large indices don't lose precision.
+          Pairs of dimensions are R2 points, and each pair shuffles the sample index differently so the pairs are uncorrelated.
+        The seed decorrelates the sequences of different pixels: it rotates Halton and R2 samples and scrambles Sobol samples.
+        The shaders read the Sobol direction numbers from a buffer filled with getSobolDirections().
+    */
+    class LowDiscrepancy
+    {
+    public:
+        /** Matches the LD_SEQUENCE_* defines of LowDiscrepancy.slang
+        */
+        enum class Sequence : uint32_t
+        {
+            Halton = 0,
+            Sobol = 1,
+            R2 = 2,
+        };
+
+        static const uint32_t kHaltonDimensions = 32;
+        static const uint32_t kSobolDimensions = 32;
+
+        /** Draws the dimensions of one sample one after the other, like LowDiscrepancySequence in the shaders
+        */
+        struct SampleState
+        {
+            Sequence sequence = Sequence::Sobol;
+            uint32_t index = 0;         ///< Sample index, e.g. the frame number
+            uint32_t seed = 0;          ///< Per-pixel seed
+            uint32_t dimension = 0;     ///< Next dimension to draw
+        };
+
+        static SampleState initSampleState(Sequence sequence, uint32_t index, uint32_t seed);
+        static float next1D(SampleState& state);
+        static glm::vec2 next2D(SampleState& state);
+
+        /** Get a dimension of a sample, in [0, 1)
+        */
+        static float sample(Sequence sequence, uint32_t dimension, uint32_t index, uint32_t seed);
+
+        /** Unscrambled sequences, in [0, 1)
+        */
+        static float radicalInverse(uint32_t base, uint32_t index);
+        static float halton(uint32_t dimension, uint32_t index);
+        static float sobol(uint32_t dimension, uint32_t index);
+        static glm::vec2 r2(uint32_t index);
+
+        /** Get the 32 bits of a dimension of a Sobol point. The dimension is taken modulo kSobolDimensions.
+        */
+        static uint32_t sobolBits(uint32_t dimension, uint32_t index);
+
+        /** Owen-scramble a 32 bit fixed point value: each bit is flipped depending on the seed and the bits above it
+        */
+        static uint32_t nestedUniformScramble(uint32_t x, uint32_t seed);
+
+        static uint32_t hash(uint32_t x);
+        static uint32_t hashCombine(uint32_t seed, uint32_t value);
+
+        /** Get a seed for the samples of a pixel
+        */
+        static uint32_t pixelSeed(uint32_t x, uint32_t y) { return hashCombine(hash(x), y); }
+
+        /** Get the Sobol direction numbers, 32 per dimension, dimension after dimension, with the most significant bit first
+        */
+        static const std::vector<uint32_t>& getSobolDirections();
+    };
+}
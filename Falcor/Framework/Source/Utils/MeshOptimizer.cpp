@@ -0,0 +1,377 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace Falcor
+{
+    namespace MeshOptimizer
+    {
+        namespace
+        {
+            // Vertex to triangle adjacency, CSR style
+            struct Adjacency
+            {
+                std::vector<uint32_t> offsets;
+                std::vector<uint32_t> triangles;
+
+                Adjacency(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indexCount)
+                {
+                    for (size_t i = 0; i < indexCount; i++) offsets[pIndices[i] + 1]++;
+                    for (uint32_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+
+                    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+                    for (size_t i = 0; i < indexCount; i++) triangles[cursor[pIndices[i]]++] = uint32_t(i / 3);
+                }
+            };
+
+            // Cache misses of a run of triangles, starting with an empty cache
+            struct FifoCache
+            {
+                std::vector<uint32_t> timestamps;
+                uint32_t time;
+                uint32_t size;
+
+                FifoCache(uint32_t vertexCount, uint32_t cacheSize) : timestamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+                void reset() { time += size + 1; }
+
+                uint32_t addTriangle(const uint32_t* pTriangle)
+                {
+                    uint32_t misses = 0;
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint32_t v = pTriangle[i];
+                        if (time - timestamps[v] > size)
+                        {
+                            timestamps[v] = time++;
+                            misses++;
+                        }
+                    }
+                    return misses;
+                }
+            };
+        }
+
+        float computeAcmr(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+        {
+            if (indexCount < 3) return 0;
+
+            FifoCache cache(vertexCount, cacheSize);
+            uint64_t misses = 0;
+            for (size_t i = 0; i + 2 < indexCount; i += 3) misses += cache.addTriangle(pIndices + i);
+            return float(double(misses) / double(indexCount / 3));
+        }
+
+        std::vector<uint32_t> optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+        {
+            assert(indexCount % 3 == 0);
+            const uint32_t triangleCount = uint32_t(indexCount / 3);
+            std::vector<uint32_t> clusters;
+            if (triangleCount == 0) return clusters;
+
+            Adjacency adjacency(pIndices, indexCount, vertexCount);
+            std::vector<uint32_t> liveTriangles(vertexCount);
+            for (uint32_t v = 0; v < vertexCount; v++) liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+            std::vector<uint32_t> cacheTime(vertexCount, 0);
+            std::vector<bool> emitted(triangleCount, false);
+            std::vector<uint32_t> deadEnd;
+            std::vector<uint32_t> candidates;
+            std::vector<uint32_t> result;
+            result.reserve(indexCount);
+
+            uint32_t time = cacheSize + 1;
+            uint32_t cursor = 0;
+
+            // Next vertex with live triangles: the most recent dead-end vertex, or the next one in input order. Either way, the cache is cold.
+            auto skipDeadEnd = [&]() -> int64_t
+            {
+                while (deadEnd.size())
+                {
+                    uint32_t v = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (liveTriangles[v] > 0) return v;
+                }
+                while (cursor < vertexCount)
+                {
+                    if (liveTriangles[cursor] > 0) return cursor;
+                    cursor++;
+                }
+                return -1;
+            };
+
+            int64_t fanVertex = skipDeadEnd();
+            while (fanVertex >= 0)
+            {
+                // Emit all the remaining triangles around the fanning vertex
+                candidates.clear();
+                for (uint32_t a = adjacency.offsets[fanVertex]; a < adjacency.offsets[fanVertex + 1]; a++)
+                {
+                    uint32_t t = adjacency.triangles[a];
+                    if (emitted[t]) continue;
+
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint32_t v = pIndices[t * 3 + i];
+                        result.push_back(v);
+                        deadEnd.push_back(v);
+                        candidates.push_back(v);
+                        liveTriangles[v]--;
+                        if (time - cacheTime[v] > cacheSize) cacheTime[v] = time++;
+                    }
+                    emitted[t] = true;
+                }
+
+                // Pick the candidate that will still be in the cache once its triangles are emitted, oldest first
+                int64_t next = -1;
+                uint32_t bestPriority = 0;
+                for (uint32_t v : candidates)
+                {
+                    if (liveTriangles[v] == 0) continue;
+                    uint32_t priority = 0;
+                    if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) priority = time - cacheTime[v];
+                    if (priority > bestPriority)
+                    {
+                        bestPriority = priority;
+                        next = v;
+                    }
+                }
+
+                // Nothing in the cache left to fan around. The next triangles start a new cluster.
+                if (next < 0)
+                {
+                    next = skipDeadEnd();
+                    if (next >= 0) clusters.push_back(uint32_t(result.size() / 3));
+                }
+                fanVertex = next;
+            }
+
+            assert(result.size() == indexCount);
+            std::memcpy(pIndices, result.data(), indexCount * sizeof(uint32_t));
+            clusters.insert(clusters.begin(), 0);
+            return clusters;
+        }
+
+        void optimizeOverdraw(uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride, uint32_t vertexCount, const std::vector<uint32_t>& clusters, float threshold, uint32_t cacheSize)
+        {
+            const uint32_t triangleCount = uint32_t(indexCount / 3);
+            if (clusters.size() == 0 || triangleCount == 0) return;
+
+            auto getPosition = [&](uint32_t v) { return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(pPositions) + v * positionStride); };
+
+            // Split the clusters wherever restarting with a cold cache costs little
+            std::vector<uint32_t> boundaries;
+            FifoCache cache(vertexCount, cacheSize);
+            for (size_t c = 0; c < clusters.size(); c++)
+            {
+                uint32_t begin = clusters[c];
+                uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+
+                cache.reset();
+                uint32_t clusterMisses = 0;
+                for (uint32_t t = begin; t < end; t++) clusterMisses += cache.addTriangle(pIndices + t * 3);
+                float clusterAcmr = float(clusterMisses) / float(end - begin);
+
+                boundaries.push_back(begin);
+                cache.reset();
+                uint32_t misses = 0;
+                uint32_t start = begin;
+                for (uint32_t t = begin; t < end; t++)
+                {
+                    misses += cache.addTriangle(pIndices + t * 3);
+                    if (t + 1 < end && float(misses) / float(t + 1 - start) <= clusterAcmr * threshold)
+                    {
+                        boundaries.push_back(t + 1);
+                        cache.reset();
+                        misses = 0;
+                        start = t + 1;
+                    }
+                }
+            }
+            boundaries.push_back(triangleCount);
+
+            // Area-weighted mesh centroid
+            double meshCentroid[3] = { 0, 0, 0 };
+            double meshArea = 0;
+            struct Cluster
+            {
+                uint32_t begin;
+                uint32_t end;
+                float sortKey;
+            };
+            std::vector<Cluster> sorted(boundaries.size() - 1);
+            std::vector<float> clusterData(sorted.size() * 7, 0.0f);    // Centroid * area, area, normal * area
+
+            for (size_t c = 0; c + 1 < boundaries.size(); c++)
+            {
+                sorted[c] = { boundaries[c], boundaries[c + 1], 0.0f };
+                float* pData = &clusterData[c * 7];
+                for (uint32_t t = boundaries[c]; t < boundaries[c + 1]; t++)
+                {
+                    const float* p0 = getPosition(pIndices[t * 3 + 0]);
+                    const float* p1 = getPosition(pIndices[t * 3 + 1]);
+                    const float* p2 = getPosition(pIndices[t * 3 + 2]);
+                    float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                    float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                    float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                    float area = 0.5f * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        float centroid = (p0[i] + p1[i] + p2[i]) / 3.0f;
+                        pData[i] += centroid * area;
+                        pData[4 + i] += n[i];
+                        meshCentroid[i] += centroid * area;
+                    }
+                    pData[3] += area;
+                    meshArea += area;
+                }
+            }
+            if (meshArea <= 0) return;
+            for (uint32_t i = 0; i < 3; i++) meshCentroid[i] /= meshArea;
+
+            // Clusters on the outside of the mesh, facing away from its center, are the most likely to occlude others
+            for (size_t c = 0; c < sorted.size(); c++)
+            {
+                const float* pData = &clusterData[c * 7];
+                if (pData[3] <= 0) continue;
+                float normalLength = std::sqrt(pData[4] * pData[4] + pData[5] * pData[5] + pData[6] * pData[6]);
+                if (normalLength <= 0) continue;
+
+                float key = 0;
+                for (uint32_t i = 0; i < 3; i++) key += (pData[i] / pData[3] - float(meshCentroid[i])) * pData[4 + i] / normalLength;
+                sorted[c].sortKey = key;
+            }
+            std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+            std::vector<uint32_t> result;
+            result.reserve(indexCount);
+            for (const auto& cluster : sorted)
+            {
+                result.insert(result.end(), pIndices + cluster.begin * 3, pIndices + cluster.end * 3);
+            }
+            std::memcpy(pIndices, result.data(), indexCount * sizeof(uint32_t));
+        }
+
+        std::vector<uint32_t> optimizeVertexFetch(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount)
+        {
+            const uint32_t kUnused = uint32_t(-1);
+            std::vector<uint32_t> newIndex(vertexCount, kUnused);
+            std::vector<uint32_t> remap;
+            remap.reserve(vertexCount);
+
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                uint32_t& v = newIndex[pIndices[i]];
+                if (v == kUnused)
+                {
+                    v = uint32_t(remap.size());
+                    remap.push_back(pIndices[i]);
+                }
+                pIndices[i] = v;
+            }
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                if (newIndex[v] == kUnused) remap.push_back(v);
+            }
+            return remap;
+        }
+
+        void remapVertices(void* pData, size_t elementSize, const std::vector<uint32_t>& remap)
+        {
+            const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(pData);
+            std::vector<uint8_t> result(remap.size() * elementSize);
+            for (size_t i = 0; i < remap.size(); i++)
+            {
+                std::memcpy(&result[i * elementSize], pSrc + remap[i] * elementSize, elementSize);
+            }
+            std::memcpy(pData, result.data(), result.size());
+        }
+
+        static int16_t toSnorm16(float f)
+        {
+            f = std::max(-1.0f, std::min(1.0f, f));
+            return int16_t(std::lround(f * 32767.0f));
+        }
+
+        void encodeOctahedral(const float v[3], int16_t out[2])
+        {
+            float l1 = std::abs(v[0]) + std::abs(v[1]) + std::abs(v[2]);
+            if (l1 <= 0)
+            {
+                out[0] = 0;
+                out[1] = 0;
+                return;
+            }
+            float x = v[0] / l1;
+            float y = v[1] / l1;
+            if (v[2] < 0)
+            {
+                // Fold the lower hemisphere over the diagonals
+                float fx = (1.0f - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+                float fy = (1.0f - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+                x = fx;
+                y = fy;
+            }
+            out[0] = toSnorm16(x);
+            out[1] = toSnorm16(y);
+        }
+
+        void decodeOctahedral(const int16_t in[2], float v[3])
+        {
+            float x = std::max(-1.0f, in[0] / 32767.0f);
+            float y = std::max(-1.0f, in[1] / 32767.0f);
+            float z = 1.0f - std::abs(x) - std::abs(y);
+            if (z < 0)
+            {
+                float fx = (1.0f - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+                float fy = (1.0f - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+                x = fx;
+                y = fy;
+            }
+            float length = std::sqrt(x * x + y * y + z * z);
+            v[0] = x / length;
+            v[1] = y / length;
+            v[2] = z / length;
+        }
+
+        void quantizePosition(const float p[3], const float boxMin[3], const float boxSize[3], uint16_t out[4])
+        {
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                float u = boxSize[i] > 0 ? (p[i] - boxMin[i]) / boxSize[i] : 0.0f;
+                out[i] = (uint16_t)(std::min(std::max(u, 0.0f), 1.0f) * 65535.0f + 0.5f);
+            }
+            out[3] = 65535;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Falcor
+{
+    /** Index and vertex reordering for triangle meshes, plus the encoders used by the compact vertex layout.
+        The triangle order comes from Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007):
+        a linear-time vertex cache optimization whose cache flushes split the mesh into clusters, which are then sorted front-to-back
+        from the outside of the mesh to cut overdraw.
+    */
+    namespace MeshOptimizer
+    {
+        static const uint32_t kDefaultCacheSize = 16;   ///< Post-transform cache size (in vertices) the reordering and the ACMR assume
+
+        /** Simulate a FIFO post-transform cache
+            \return The average cache miss ratio: transformed vertices per triangle. 0.5 is the best possible, 3 the worst.
+        */
+        float computeAcmr(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultCacheSize);
+
+        /** Reorder triangles for the post-transform cache. Returns the first triangle of each cluster (a run of triangles that doesn't flush the cache).
+        */
+        std::vector<uint32_t> optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultCacheSize);
+
+        /** Reorder the clusters produced by optimizeVertexCache() to reduce overdraw. Clusters are split further wherever that costs
+            less than 'threshold' times the cluster's ACMR, then sorted so that clusters facing away from the mesh center come first.
+            \param[in] pPositions Vertex positions, 'positionStride' bytes apart
+            \param[in] clusters The result of optimizeVertexCache()
+        */
+        void optimizeOverdraw(uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride, uint32_t vertexCount, const std::vector<uint32_t>& clusters, float threshold = 1.05f, uint32_t cacheSize = kDefaultCacheSize);
+
+        /** Renumber vertices in the order the index buffer first uses them, for vertex fetch locality. Updates the indices.
+            \return For each new vertex, the index of the old vertex. Unused vertices are moved to the end.
+        */
+        std::vector<uint32_t> optimizeVertexFetch(uint32_t* pIndices, size_t indexCount, uint32_t vertexCount);
+
+        /** Gather 'elementSize'-byte elements of an array in the order given by a remap returned by optimizeVertexFetch()
+        */
+        void remapVertices(void* pData, size_t elementSize, const std::vector<uint32_t>& remap);
+
+        /** Encode a unit vector in octahedral coordinates, as two snorm16 values
+        */
+        void encodeOctahedral(const float v[3], int16_t out[2]);
+
+        /** Decode a vector encoded with encodeOctahedral()
+        */
+        void decodeOctahedral(const int16_t in[2], float v[3]);
+
+        /** Quantize a position into unorm16 relative to the mesh bounds. The 4th component is 1.
+        */
+        void quantizePosition(const float p[3], const float boxMin[3], const float boxSize[3], uint16_t out[4]);
+    }
+}
@@ -0,0 +1,549 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Falcor
+{
+    namespace MeshSimplifier
+    {
+        namespace
+        {
+            // Border edges are kept in place by planes through them, perpendicular to their triangle. This is their weight relative to the triangle planes.
+            const double kBorderWeight = 10.0;
+            const uint32_t kNoChild = uint32_t(-1);
+
+            struct Vec3
+            {
+                double x, y, z;
+            };
+
+            Vec3 operator-(const Vec3& a, const Vec3& b) { return{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+            double dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+            Vec3 cross(const Vec3& a, const Vec3& b) { return{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+            double length(const Vec3& a) { return std::sqrt(dot(a, a)); }
+
+            // Weighted sum of squared distances to a set of planes
+            struct Quadric
+            {
+                double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+                double ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+                double weight = 0;
+
+                // 'n' must be normalized
+                void addPlane(const Vec3& n, double d, double w)
+                {
+                    a2 += w * n.x * n.x; b2 += w * n.y * n.y; c2 += w * n.z * n.z; d2 += w * d * d;
+                    ab += w * n.x * n.y; ac += w * n.x * n.z; ad += w * n.x * d;
+                    bc += w * n.y * n.z; bd += w * n.y * d; cd += w * n.z * d;
+                    weight += w;
+                }
+
+                void add(const Quadric& q)
+                {
+                    a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+                    ab += q.ab; ac += q.ac; ad += q.ad;
+                    bc += q.bc; bd += q.bd; cd += q.cd;
+                    weight += q.weight;
+                }
+
+                // Weighted mean of the squared distances
+                double evaluate(const Vec3& p) const
+                {
+                    if (weight <= 0) return 0;
+                    double e = a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z + d2
+                        + 2 * (ab * p.x * p.y + ac * p.x * p.z + ad * p.x + bc * p.y * p.z + bd * p.y + cd * p.z);
+                    return std::max(e, 0.0) / weight;
+                }
+            };
+
+            enum class VertexKind : uint8_t
+            {
+                Manifold,   ///< Can collapse onto any neighbor
+                Border,     ///< Can only collapse along a border edge
+                Locked      ///< Seam, non-manifold or unreferenced vertex. Never moves.
+            };
+
+            struct PositionKey
+            {
+                float p[3];
+                bool operator==(const PositionKey& other) const { return std::memcmp(p, other.p, sizeof(p)) == 0; }
+            };
+
+            struct PositionKeyHash
+            {
+                size_t operator()(const PositionKey& k) const
+                {
+                    // The float bits of grid-aligned positions share most of their low bits, so mix them thoroughly (MurmurHash3 finalizer)
+                    uint32_t h[3];
+                    std::memcpy(h, k.p, sizeof(h));
+                    uint64_t x = (uint64_t(h[0]) << 32 | h[1]) ^ (uint64_t(h[2]) * 0x9e3779b97f4a7c15ull);
+                    x ^= x >> 33; x *= 0xff51afd7ed558ccdull;
+                    x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ull;
+                    x ^= x >> 33;
+                    return size_t(x);
+                }
+            };
+
+            // Real-Time Collision Detection, 5.1.5
+            double distanceToTriangle(const Vec3& p, const Vec3& a, const Vec3& b, const Vec3& c)
+            {
+                Vec3 ab = b - a, ac = c - a, ap = p - a;
+                double d1 = dot(ab, ap), d2 = dot(ac, ap);
+                if (d1 <= 0 && d2 <= 0) return length(ap);
+                Vec3 bp = p - b;
+                double d3 = dot(ab, bp), d4 = dot(ac, bp);
+                if (d3 >= 0 && d4 <= d3) return length(bp);
+                Vec3 cp = p - c;
+                double d5 = dot(ab, cp), d6 = dot(ac, cp);
+                if (d6 >= 0 && d5 <= d6) return length(cp);
+
+                double vc = d1 * d4 - d3 * d2;
+                double vb = d5 * d2 - d1 * d6;
+                double va = d3 * d6 - d5 * d4;
+                double v, w;
+                if (vc <= 0 && d1 >= 0 && d3 <= 0) { v = d1 / (d1 - d3); w = 0; }
+                else if (vb <= 0 && d2 >= 0 && d6 <= 0) { v = 0; w = d2 / (d2 - d6); }
+                else if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) { w = (d4 - d3) / ((d4 - d3) + (d5 - d6)); v = 1 - w; }
+                else { double denom = 1 / (va + vb + vc); v = vb * denom; w = vc * denom; }
+                Vec3 q = { a.x + ab.x * v + ac.x * w, a.y + ab.y * v + ac.y * w, a.z + ab.z * v + ac.z * w };
+                return length(p - q);
+            }
+
+            uint64_t edgeKey(uint32_t a, uint32_t b) { return (uint64_t(a) << 32) | b; }
+
+            struct Collapse
+            {
+                uint32_t from;
+                uint32_t to;
+                double cost;
+            };
+        }
+
+        float measureError(const uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride, const std::vector<uint32_t>& simplified)
+        {
+            auto position = [&](uint32_t v) -> Vec3
+            {
+                const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(pPositions) + v * positionStride);
+                return{ p[0], p[1], p[2] };
+            };
+            if (indexCount == 0) return 0;
+            if (simplified.empty()) return FLT_MAX;
+
+            // Bin the simplified triangles in a uniform grid with about one triangle per cell
+            Vec3 boxMin = position(pIndices[0]);
+            Vec3 boxMax = boxMin;
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                Vec3 p = position(pIndices[i]);
+                boxMin = { std::min(boxMin.x, p.x), std::min(boxMin.y, p.y), std::min(boxMin.z, p.z) };
+                boxMax = { std::max(boxMax.x, p.x), std::max(boxMax.y, p.y), std::max(boxMax.z, p.z) };
+            }
+            Vec3 size = boxMax - boxMin;
+            const size_t triangleCount = simplified.size() / 3;
+
+            // Cells about the size of a triangle, but no more cells than triangles
+            double area = 0;
+            for (size_t t = 0; t < triangleCount; t++)
+            {
+                Vec3 p0 = position(simplified[t * 3]);
+                area += length(cross(position(simplified[t * 3 + 1]) - p0, position(simplified[t * 3 + 2]) - p0)) * 0.5;
+            }
+            double cellSize = std::sqrt(area / triangleCount);
+            cellSize = std::max(cellSize, std::cbrt((size.x + cellSize) * (size.y + cellSize) * (size.z + cellSize) / triangleCount));
+            if (cellSize <= 0) return 0;
+
+            int32_t dims[3] = { int32_t(size.x / cellSize) + 1, int32_t(size.y / cellSize) + 1, int32_t(size.z / cellSize) + 1 };
+            auto cellOf = [&](const Vec3& p, int32_t cell[3])
+            {
+                double rel[3] = { (p.x - boxMin.x) / cellSize, (p.y - boxMin.y) / cellSize, (p.z - boxMin.z) / cellSize };
+                for (uint32_t k = 0; k < 3; k++) cell[k] = std::min(std::max(int32_t(rel[k]), 0), dims[k] - 1);
+            };
+
+            std::vector<std::vector<uint32_t>> cells(size_t(dims[0]) * dims[1] * dims[2]);
+            for (size_t t = 0; t < triangleCount; t++)
+            {
+                Vec3 p[3] = { position(simplified[t * 3]), position(simplified[t * 3 + 1]), position(simplified[t * 3 + 2]) };
+                int32_t lo[3], hi[3], c[3];
+                cellOf(p[0], lo);
+                cellOf(p[0], hi);
+                for (uint32_t k = 1; k < 3; k++)
+                {
+                    cellOf(p[k], c);
+                    for (uint32_t d = 0; d < 3; d++)
+                    {
+                        lo[d] = std::min(lo[d], c[d]);
+                        hi[d] = std::max(hi[d], c[d]);
+                    }
+                }
+                for (int32_t z = lo[2]; z <= hi[2]; z++)
+                    for (int32_t y = lo[1]; y <= hi[1]; y++)
+                        for (int32_t x = lo[0]; x <= hi[0]; x++) cells[(size_t(z) * dims[1] + y) * dims[0] + x].push_back(uint32_t(t));
+            }
+
+            // Search shells of cells around each original vertex until the closest triangle found is closer than the unsearched cells
+            double maxDistance = 0;
+            const int32_t maxRadius = std::max({ dims[0], dims[1], dims[2] });
+            std::unordered_set<uint32_t> measured;
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                if (measured.insert(pIndices[i]).second == false) continue;
+                Vec3 p = position(pIndices[i]);
+                int32_t center[3];
+                cellOf(p, center);
+                double distance = DBL_MAX;
+                for (int32_t r = 0; r <= maxRadius; r++)
+                {
+                    for (int32_t z = std::max(center[2] - r, 0); z <= std::min(center[2] + r, dims[2] - 1); z++)
+                        for (int32_t y = std::max(center[1] - r, 0); y <= std::min(center[1] + r, dims[1] - 1); y++)
+                            for (int32_t x = std::max(center[0] - r, 0); x <= std::min(center[0] + r, dims[0] - 1); x++)
+                            {
+                                if (std::max({ std::abs(x - center[0]), std::abs(y - center[1]), std::abs(z - center[2]) }) != r) continue;
+                                for (uint32_t t : cells[(size_t(z) * dims[1] + y) * dims[0] + x])
+                                {
+                                    distance = std::min(distance, distanceToTriangle(p, position(simplified[t * 3]), position(simplified[t * 3 + 1]), position(simplified[t * 3 + 2])));
+                                }
+                            }
+
+                    // Anything outside the searched block is at least as far as the nearest block face that isn't on the grid boundary
+                    double outside = DBL_MAX;
+                    const double rel[3] = { p.x - boxMin.x, p.y - boxMin.y, p.z - boxMin.z };
+                    for (uint32_t k = 0; k < 3; k++)
+                    {
+                        if (center[k] - r > 0) outside = std::min(outside, rel[k] - (center[k] - r) * cellSize);
+                        if (center[k] + r < dims[k] - 1) outside = std::min(outside, (center[k] + r + 1) * cellSize - rel[k]);
+                    }
+                    if (distance <= outside) break;
+                }
+                maxDistance = std::max(maxDistance, distance);
+            }
+            return float(maxDistance);
+        }
+
+        std::vector<uint32_t> simplify(const uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride, uint32_t vertexCount,
+            size_t targetIndexCount, float targetError, const Attributes& attributes, float* pResultError)
+        {
+            std::vector<uint32_t> indices(pIndices, pIndices + indexCount);
+
+            auto position = [&](uint32_t v) -> Vec3
+            {
+                const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(pPositions) + v * positionStride);
+                return{ p[0], p[1], p[2] };
+            };
+
+            // Vertices sharing a position form one surface point. More than one of them means an attribute seam.
+            std::vector<uint32_t> positionId(vertexCount);
+            std::vector<uint32_t> wedgeCount(vertexCount, 0);
+            {
+                std::unordered_map<PositionKey, uint32_t, PositionKeyHash> positionMap;
+                positionMap.reserve(vertexCount);
+                for (uint32_t v = 0; v < vertexCount; v++)
+                {
+                    PositionKey key;
+                    std::memcpy(key.p, reinterpret_cast<const uint8_t*>(pPositions) + v * positionStride, sizeof(key.p));
+                    positionId[v] = positionMap.emplace(key, v).first->second;
+                    wedgeCount[positionId[v]]++;
+                }
+            }
+
+            // Classify the vertices from the edges' use counts
+            std::unordered_map<uint64_t, uint32_t> directedEdges;
+            directedEdges.reserve(indexCount);
+            for (size_t i = 0; i < indexCount; i += 3)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    directedEdges[edgeKey(positionId[indices[i + k]], positionId[indices[i + (k + 1) % 3]])]++;
+                }
+            }
+
+            std::vector<VertexKind> kind(vertexCount, VertexKind::Locked);
+            std::vector<uint32_t> borderEdgeCount(vertexCount, 0);
+            std::vector<bool> nonManifold(vertexCount, false);
+            std::vector<bool> referenced(vertexCount, false);
+            for (const auto& edge : directedEdges)
+            {
+                uint32_t a = uint32_t(edge.first >> 32);
+                uint32_t b = uint32_t(edge.first & 0xffffffff);
+                auto it = directedEdges.find(edgeKey(b, a));
+                uint32_t opposite = (it == directedEdges.end()) ? 0 : it->second;
+                if (edge.second + opposite > 2 || edge.second > 1)
+                {
+                    nonManifold[a] = nonManifold[b] = true;
+                }
+                else if (opposite == 0)
+                {
+                    borderEdgeCount[a]++;
+                    borderEdgeCount[b]++;
+                }
+            }
+            for (size_t i = 0; i < indexCount; i++) referenced[indices[i]] = true;
+
+            for (uint32_t v = 0; v < vertexCount; v++)
+            {
+                uint32_t p = positionId[v];
+                if (referenced[v] == false || wedgeCount[p] > 1 || nonManifold[p]) continue;
+                if (borderEdgeCount[p] == 0) kind[v] = VertexKind::Manifold;
+                else if (borderEdgeCount[p] == 2) kind[v] = VertexKind::Border;
+            }
+
+            auto isBorderEdge = [&](uint32_t a, uint32_t b)
+            {
+                if (borderEdgeCount[positionId[a]] == 0 || borderEdgeCount[positionId[b]] == 0) return false;
+                return (directedEdges.count(edgeKey(positionId[a], positionId[b])) != 0) != (directedEdges.count(edgeKey(positionId[b], positionId[a])) != 0);
+            };
+
+            // Accumulate the planes of the triangles around each vertex, weighted by area
+            std::vector<Quadric> quadrics(vertexCount);
+            for (size_t i = 0; i < indexCount; i += 3)
+            {
+                Vec3 p[3] = { position(indices[i]), position(indices[i + 1]), position(indices[i + 2]) };
+                Vec3 n = cross(p[1] - p[0], p[2] - p[0]);
+                double area = length(n) * 0.5;
+                if (area <= 0) continue;
+                Vec3 un = { n.x / (2 * area), n.y / (2 * area), n.z / (2 * area) };
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    quadrics[indices[i + k]].addPlane(un, -dot(un, p[0]), area);
+                }
+
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    uint32_t a = indices[i + k];
+                    uint32_t b = indices[i + (k + 1) % 3];
+                    if (isBorderEdge(a, b) == false) continue;
+                    Vec3 e = p[(k + 1) % 3] - p[k];
+                    Vec3 m = cross(e, un);
+                    double l = length(m);
+                    if (l <= 0) continue;
+                    m = { m.x / l, m.y / l, m.z / l };
+                    double w = dot(e, e) * kBorderWeight;
+                    quadrics[a].addPlane(m, -dot(m, p[k]), w);
+                    quadrics[b].addPlane(m, -dot(m, p[k]), w);
+                }
+            }
+
+            auto attributeDistance = [&](uint32_t a, uint32_t b)
+            {
+                if (attributes.pData == nullptr) return 0.0;
+                const float* pa = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(attributes.pData) + a * attributes.stride);
+                const float* pb = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(attributes.pData) + b * attributes.stride);
+                double d = 0;
+                for (uint32_t i = 0; i < attributes.count; i++) d += double(pa[i] - pb[i]) * double(pa[i] - pb[i]);
+                return d * attributes.weight * attributes.weight;
+            };
+
+            const double maxCost = double(targetError) * double(targetError);
+            const bool checkError = targetError < FLT_MAX;
+
+            // Every vertex keeps a list of the original vertices collapsed into it, to measure how far they end up from the surface
+            std::vector<uint32_t> childNext(vertexCount, kNoChild);
+            std::vector<uint32_t> childTail(vertexCount);
+            for (uint32_t v = 0; v < vertexCount; v++) childTail[v] = v;
+
+            std::vector<uint32_t> remap(vertexCount);
+            std::vector<bool> touched(vertexCount);
+            std::vector<uint32_t> adjOffsets(vertexCount + 1);
+            std::vector<uint32_t> adjTriangles;
+            std::vector<Collapse> collapses;
+            std::vector<uint32_t> ring;
+
+            while (indices.size() > targetIndexCount)
+            {
+                // Vertex to triangle adjacency of the current mesh
+                std::fill(adjOffsets.begin(), adjOffsets.end(), 0);
+                for (uint32_t v : indices) adjOffsets[v + 1]++;
+                for (uint32_t v = 0; v < vertexCount; v++) adjOffsets[v + 1] += adjOffsets[v];
+                adjTriangles.resize(indices.size());
+                {
+                    std::vector<uint32_t> cursor(adjOffsets.begin(), adjOffsets.end() - 1);
+                    for (size_t i = 0; i < indices.size(); i++) adjTriangles[cursor[indices[i]]++] = uint32_t(i / 3);
+                }
+
+                // Cost every allowed collapse along the triangles' edges
+                collapses.clear();
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    for (uint32_t k = 0; k < 3; k++)
+                    {
+                        uint32_t a = indices[i + k];
+                        uint32_t b = indices[i + (k + 1) % 3];
+                        for (uint32_t dir = 0; dir < 2; dir++)
+                        {
+                            uint32_t from = dir ? b : a;
+                            uint32_t to = dir ? a : b;
+                            if (kind[from] == VertexKind::Locked) continue;
+                            // Interior edges are seen once from each side, so only border edges need the reverse direction
+                            bool border = kind[from] == VertexKind::Border && kind[to] == VertexKind::Border && isBorderEdge(from, to);
+                            if (dir && border == false) continue;
+                            if (kind[from] == VertexKind::Border && border == false) continue;
+
+                            Quadric q = quadrics[from];
+                            q.add(quadrics[to]);
+                            collapses.push_back({ from, to, q.evaluate(position(to)) + attributeDistance(from, to) });
+                        }
+                    }
+                }
+
+                // Apply the cheapest collapses, at most one per vertex
+                for (uint32_t v = 0; v < vertexCount; v++) remap[v] = v;
+                std::fill(touched.begin(), touched.end(), false);
+                size_t triangleCount = indices.size() / 3;
+                const size_t targetTriangleCount = targetIndexCount / 3;
+                uint32_t collapseCount = 0;
+
+                // A pass rarely gets far down the list, so sort it a chunk at a time
+                const auto cheaper = [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; };
+                const size_t chunkSize = std::max<size_t>(triangleCount - targetTriangleCount, 1024);
+                size_t sorted = 0;
+                for (size_t i = 0; i < collapses.size(); i++)
+                {
+                    if (i == sorted)
+                    {
+                        sorted = std::min(collapses.size(), sorted + chunkSize);
+                        std::nth_element(collapses.begin() + i, collapses.begin() + sorted - 1, collapses.end(), cheaper);
+                        std::sort(collapses.begin() + i, collapses.begin() + sorted, cheaper);
+                    }
+                    const Collapse& c = collapses[i];
+                    if (c.cost > maxCost || triangleCount <= targetTriangleCount) break;
+                    if (touched[c.from] || touched[c.to]) continue;
+
+                    // The adjacency is from the start of the pass. Earlier collapses of this pass are applied through the remap table.
+                    auto currentTriangle = [&](uint32_t triangle, uint32_t tri[3])
+                    {
+                        for (uint32_t k = 0; k < 3; k++) tri[k] = remap[indices[triangle * 3 + k]];
+                        return tri[0] != tri[1] && tri[1] != tri[2] && tri[2] != tri[0];
+                    };
+
+                    // Reject collapses that flip a triangle, and count the ones that degenerate
+                    Vec3 pTo = position(c.to);
+                    bool flips = false;
+                    uint32_t removed = 0;
+                    ring.clear();
+                    for (uint32_t j = adjOffsets[c.from]; j < adjOffsets[c.from + 1] && flips == false; j++)
+                    {
+                        uint32_t tri[3];
+                        if (currentTriangle(adjTriangles[j], tri) == false) continue;
+                        for (uint32_t k = 0; k < 3; k++)
+                        {
+                            if (tri[k] != c.from && std::find(ring.begin(), ring.end(), tri[k]) == ring.end()) ring.push_back(tri[k]);
+                        }
+                        if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+                        {
+                            removed++;
+                            continue;
+                        }
+                        Vec3 p[3] = { position(tri[0]), position(tri[1]), position(tri[2]) };
+                        Vec3 before = cross(p[1] - p[0], p[2] - p[0]);
+                        for (uint32_t k = 0; k < 3; k++)
+                        {
+                            if (tri[k] == c.from) p[k] = pTo;
+                        }
+                        Vec3 after = cross(p[1] - p[0], p[2] - p[0]);
+                        flips = dot(before, after) <= 0;
+                    }
+                    if (flips) continue;
+
+                    // The quadric is an average. Keep every vertex merged so far within the target distance of the triangles around
+                    // the vertex it was merged into. The vertices of the ring are the ones whose triangles change. A ring vertex that
+                    // already received a collapse this pass misses some of its triangles here, which only makes the check stricter.
+                    if (checkError)
+                    {
+                        auto distanceToRing = [&](uint32_t child, uint32_t owner)
+                        {
+                            Vec3 p = position(child);
+                            double distance = DBL_MAX;
+                            for (uint32_t side = 0; side < 2; side++)
+                            {
+                                uint32_t v = side ? c.from : owner;
+                                if (side && owner != c.to) break;
+                                for (uint32_t j = adjOffsets[v]; j < adjOffsets[v + 1]; j++)
+                                {
+                                    uint32_t tri[3];
+                                    if (currentTriangle(adjTriangles[j], tri) == false) continue;
+                                    for (uint32_t& t : tri) if (t == c.from) t = c.to;
+                                    if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) continue;
+                                    distance = std::min(distance, distanceToTriangle(p, position(tri[0]), position(tri[1]), position(tri[2])));
+                                }
+                            }
+                            return distance;
+                        };
+
+                        bool tooFar = false;
+                        for (uint32_t child = c.from; child != kNoChild && tooFar == false; child = childNext[child])
+                        {
+                            tooFar = distanceToRing(child, c.to) > targetError;
+                        }
+                        for (size_t r = 0; r < ring.size() && tooFar == false; r++)
+                        {
+                            for (uint32_t child = childNext[ring[r]]; child != kNoChild && tooFar == false; child = childNext[child])
+                            {
+                                tooFar = distanceToRing(child, ring[r]) > targetError;
+                            }
+                        }
+                        if (tooFar) continue;
+                    }
+
+                    // 'to' now owns the triangles of 'from', which the adjacency doesn't know about, so neither collapses again this pass
+                    touched[c.from] = true;
+                    touched[c.to] = true;
+                    remap[c.from] = c.to;
+                    quadrics[c.to].add(quadrics[c.from]);
+                    childNext[childTail[c.to]] = c.from;
+                    childTail[c.to] = childTail[c.from];
+                    triangleCount -= removed;
+                    collapseCount++;
+                }
+
+                if (collapseCount == 0) break;
+
+                // Rebuild the index list without the degenerate triangles
+                size_t writeIndex = 0;
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    uint32_t a = remap[indices[i]];
+                    uint32_t b = remap[indices[i + 1]];
+                    uint32_t c = remap[indices[i + 2]];
+                    if (a == b || b == c || c == a) continue;
+                    indices[writeIndex++] = a;
+                    indices[writeIndex++] = b;
+                    indices[writeIndex++] = c;
+                }
+                indices.resize(writeIndex);
+            }
+
+            if (pResultError) *pResultError = measureError(pIndices, indexCount, pPositions, positionStride, indices);
+            return indices;
+        }
+    }
+}
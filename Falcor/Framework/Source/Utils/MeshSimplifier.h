@@ -0,0 +1,60 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Falcor
+{
+    /** Triangle mesh simplification with quadric error metrics (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997).
+        Vertices are collapsed onto one of their neighbors, so the result indexes the original vertex buffer and every level of a LOD chain can share it.
+        Border vertices only slide along the border, and vertices on attribute seams (several vertices at the same position) are kept.
+    */
+    namespace MeshSimplifier
+    {
+        /** Optional per-vertex attributes that add to the cost of a collapse, to keep creases and texture detail
+        */
+        struct Attributes
+        {
+            const float* pData = nullptr;   ///< First attribute of the first vertex
+            size_t stride = 0;              ///< Distance between vertices, in bytes
+            uint32_t count = 0;             ///< Number of floats per vertex
+            float weight = 1;               ///< Scale from attribute distance to position units
+        };
+
+        /** Simplify a triangle list
+            \param[in] targetIndexCount Stop once the result has this many indices or fewer
+            \param[in] targetError Largest distance allowed between an original vertex and the result, in position units. FLT_MAX to only stop at the index count.
+            \param[out] pResultError Optional. The largest distance between an original vertex and the result, in position units.
+            \return The simplified index list
+        */
+        std::vector<uint32_t> simplify(const uint32_t* pIndices, size_t indexCount, const float* pPositions, size_t positionStride, uint32_t vertexCount,
+            size_t targetIndexCount, float targetError, const Attributes& attributes = Attributes(), float* pResultError = nullptr);
+    }
+}
@@ -0,0 +1,654 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "PathTracerReference.h"
+#include "Utils/BinaryFileStream.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kPi = 3.14159265358979323846f;
+        const float kMaxT = 1.0e38f;
+        const uint32_t kSceneMagic = 0x53545046;   // "FPTS"
+        const uint32_t kSceneVersion = 1;
+
+        // What a ray found: the shading data the closest-hit shaders pass back
+        struct Hit
+        {
+            bool valid = false;
+            vec3 posW;
+            vec3 N;                 // Shading normal, facing the ray origin
+            vec3 diffuse;
+            vec3 specular;
+            vec3 emissive;
+            float linearRoughness = 0;
+        };
+
+        float saturate(float x) { return std::min(std::max(x, 0.0f), 1.0f); }
+        float luminance(const vec3& c) { return dot(c, vec3(0.2126f, 0.7152f, 0.0722f)); }
+
+        const uint32_t kBvhLeafSize = 4;       // Maximum number of triangles in a hierarchy leaf
+        const uint32_t kBvhMaxDepth = 64;
+
+        // Moller-Trumbore. Returns true and updates closestT if the triangle is hit between minT and closestT.
+        bool intersectTriangle(const PathTracerReference::Triangle& tri, const vec3& origin, const vec3& dir, float minT, float& closestT)
+        {
+            vec3 e1 = tri.p1 - tri.p0;
+            vec3 e2 = tri.p2 - tri.p0;
+            vec3 p = cross(dir, e2);
+            float det = dot(e1, p);
+            if (std::abs(det) < 1e-12f) return false;
+            float invDet = 1.0f / det;
+            vec3 s = origin - tri.p0;
+            float u = dot(s, p) * invDet;
+            if (u < 0.0f || u > 1.0f) return false;
+            vec3 q = cross(s, e1);
+            float v = dot(dir, q) * invDet;
+            if (v < 0.0f || u + v > 1.0f) return false;
+            float t = dot(e2, q) * invDet;
+            if (!(t > minT && t < closestT)) return false;
+            closestT = t;
+            return true;
+        }
+
+        // Entry distance of a ray into a node's box, or kMaxT if it misses the box between minT and maxT.
+        // An axis where the ray starts on a slab plane and runs parallel to it gives NaNs, which are ignored, so the box is kept.
+        float intersectBox(const PathTracerReference::BvhNode& node, const vec3& origin, const vec3& invDir, float minT, float maxT)
+        {
+            float tNear = minT;
+            float tFar = maxT;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float t0 = (node.boxMin[axis] - origin[axis]) * invDir[axis];
+                float t1 = (node.boxMax[axis] - origin[axis]) * invDir[axis];
+                tNear = std::max(tNear, std::min(t0, t1));
+                tFar = std::min(tFar, std::max(t0, t1));
+            }
+            return (tNear <= tFar) ? tNear : kMaxT;
+        }
+
+        // Median split on the longest axis of the triangles' centroids
+        uint32_t buildBvhNode(PathTracerReference::Scene& scene, uint32_t first, uint32_t count)
+        {
+            uint32_t nodeIndex = (uint32_t)scene.bvh.size();
+            scene.bvh.push_back({});
+            vec3 boxMin(std::numeric_limits<float>::max()), boxMax(-std::numeric_limits<float>::max());
+            vec3 centroidMin = boxMin, centroidMax = boxMax;
+            for (uint32_t i = first; i < first + count; i++)
+            {
+                const PathTracerReference::Triangle& tri = scene.triangles[i];
+                boxMin = min(boxMin, min(tri.p0, min(tri.p1, tri.p2)));
+                boxMax = max(boxMax, max(tri.p0, max(tri.p1, tri.p2)));
+                vec3 centroid = (tri.p0 + tri.p1 + tri.p2) / 3.0f;
+                centroidMin = min(centroidMin, centroid);
+                centroidMax = max(centroidMax, centroid);
+            }
+            // Moller-Trumbore can accept hits a rounding error outside a triangle, which must not fall outside its box
+            vec3 padding = 1e-5f * (vec3(1.0f) + max(abs(boxMin), abs(boxMax)));
+            scene.bvh[nodeIndex] = { boxMin - padding, boxMax + padding, first, count, 0 };
+            if (count <= kBvhLeafSize) return nodeIndex;
+
+            vec3 size = centroidMax - centroidMin;
+            int axis = (size.x > size.y && size.x > size.z) ? 0 : ((size.y > size.z) ? 1 : 2);
+            uint32_t half = count / 2;
+            auto begin = scene.triangles.begin() + first;
+            std::nth_element(begin, begin + half, begin + count, [axis](const PathTracerReference::Triangle& a, const PathTracerReference::Triangle& b)
+            {
+                return (a.p0[axis] + a.p1[axis] + a.p2[axis]) < (b.p0[axis] + b.p1[axis] + b.p2[axis]);
+            });
+
+            buildBvhNode(scene, first, half);
+            uint32_t rightChild = buildBvhNode(scene, first + half, count - half);
+            scene.bvh[nodeIndex].rightChild = rightChild;
+            return nodeIndex;
+        }
+
+        // The closest triangle hit between minT and maxT, walking the hierarchy near child first when there is one
+        const PathTracerReference::Triangle* findClosest(const PathTracerReference::Scene& scene, const vec3& origin, const vec3& dir, float minT, float& closestT)
+        {
+            const PathTracerReference::Triangle* pClosest = nullptr;
+            if (scene.bvh.empty())
+            {
+                for (const auto& tri : scene.triangles)
+                {
+                    if (intersectTriangle(tri, origin, dir, minT, closestT)) pClosest = &tri;
+                }
+                return pClosest;
+            }
+
+            vec3 invDir = vec3(1.0f) / dir;
+            uint32_t stack[kBvhMaxDepth];
+            float stackT[kBvhMaxDepth];     // Where the ray enters each node's box
+            uint32_t stackSize = 0;
+            float rootT = intersectBox(scene.bvh[0], origin, invDir, minT, closestT);
+            if (rootT < kMaxT)
+            {
+                stack[0] = 0;
+                stackT[0] = rootT;
+                stackSize = 1;
+            }
+            while (stackSize > 0)
+            {
+                stackSize--;
+                if (stackT[stackSize] >= closestT) continue;    // A closer hit was found since the node was pushed
+                const PathTracerReference::BvhNode& node = scene.bvh[stack[stackSize]];
+                if (node.rightChild == 0)
+                {
+                    for (uint32_t i = node.first; i < node.first + node.count; i++)
+                    {
+                        if (intersectTriangle(scene.triangles[i], origin, dir, minT, closestT)) pClosest = &scene.triangles[i];
+                    }
+                    continue;
+                }
+
+                // Push the far child first, so the near one is walked first and tightens closestT for the other
+                uint32_t children[2] = { stack[stackSize] + 1, node.rightChild };
+                float childT[2] = { intersectBox(scene.bvh[children[0]], origin, invDir, minT, closestT), intersectBox(scene.bvh[children[1]], origin, invDir, minT, closestT) };
+                uint32_t nearChild = (childT[0] <= childT[1]) ? 0 : 1;
+                for (uint32_t c : { 1 - nearChild, nearChild })
+                {
+                    if (childT[c] >= kMaxT) continue;
+                    stack[stackSize] = children[c];
+                    stackT[stackSize] = childT[c];
+                    stackSize++;
+                }
+            }
+            return pClosest;
+        }
+
+        // The closest hit, and its shading data
+        Hit trace(const PathTracerReference::Scene& scene, const vec3& origin, const vec3& dir, float minT, float maxT)
+        {
+            Hit hit;
+            float closestT = maxT;
+            const PathTracerReference::Triangle* pClosest = findClosest(scene, origin, dir, minT, closestT);
+            if (!pClosest) return hit;
+
+            const PathTracerReference::Material& m = scene.materials[pClosest->material];
+            hit.valid = true;
+            hit.posW = origin + closestT * dir;
+            hit.N = normalize(cross(pClosest->p1 - pClosest->p0, pClosest->p2 - pClosest->p0));
+            if (dot(hit.N, -dir) <= 0.0f) hit.N = -hit.N;
+            hit.diffuse = m.diffuse;
+            hit.specular = m.specular;
+            hit.emissive = m.emissive;
+            hit.linearRoughness = m.linearRoughness;
+            return hit;
+        }
+
+        bool isVisible(const PathTracerReference::Scene& scene, const vec3& origin, const vec3& dir, float minT, float maxT)
+        {
+            return !trace(scene, origin, dir, minT, maxT).valid;
+        }
+
+        // The rest mirrors the shader helpers of the same names (GlobalIlluminationUtils.hlsli, microfacetBRDFUtils.hlsli,
+        //     standardShadowRay.hlsli), down to the order in which they draw random numbers
+        vec3 getPerpendicularVector(const vec3& u)
+        {
+            vec3 a = vec3(std::abs(u.x), std::abs(u.y), std::abs(u.z));
+            uint32_t xm = ((a.x - a.y) < 0 && (a.x - a.z) < 0) ? 1 : 0;
+            uint32_t ym = (a.y - a.z) < 0 ? (1 ^ xm) : 0;
+            uint32_t zm = 1 ^ (xm | ym);
+            return cross(u, vec3(float(xm), float(ym), float(zm)));
+        }
+
+        vec3 getCosHemisphereSample(uint32_t& seed, const vec3& N)
+        {
+            float r1 = PathTracerReference::nextRand(seed);
+            float r2 = PathTracerReference::nextRand(seed);
+            vec3 bitangent = getPerpendicularVector(N);
+            vec3 tangent = cross(bitangent, N);
+            float r = std::sqrt(r1);
+            float phi = 2.0f * 3.14159265f * r2;
+            return tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + N * std::sqrt(std::max(0.0f, 1.0f - r1));
+        }
+
+        vec3 getConeSample(uint32_t& seed, const vec3& N, float cosThetaMax)
+        {
+            float r1 = PathTracerReference::nextRand(seed);
+            float r2 = PathTracerReference::nextRand(seed);
+            vec3 bitangent = getPerpendicularVector(N);
+            vec3 tangent = cross(bitangent, N);
+            float cosTheta = (1.0f - r1) + r1 * cosThetaMax;
+            float r = std::sqrt(1.0f - cosTheta * cosTheta);
+            float phi = r2 * 2.0f * 3.14159265f;
+            return tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + N * cosTheta;
+        }
+
+        vec3 getGGXMicrofacet(uint32_t& seed, float roughness, const vec3& N)
+        {
+            float r1 = PathTracerReference::nextRand(seed);
+            float r2 = PathTracerReference::nextRand(seed);
+            vec3 B = getPerpendicularVector(N);
+            vec3 T = cross(B, N);
+            float a2 = roughness * roughness;
+            float cosThetaH = std::sqrt(std::max(0.0f, (1.0f - r1) / ((a2 - 1.0f) * r1 + 1.0f)));
+            float sinThetaH = std::sqrt(std::max(0.0f, 1.0f - cosThetaH * cosThetaH));
+            float phiH = r2 * kPi * 2.0f;
+            return T * (sinThetaH * std::cos(phiH)) + B * (sinThetaH * std::sin(phiH)) + N * cosThetaH;
+        }
+
+        float ggxNormalDistribution(float NdotH, float roughness)
+        {
+            float a2 = roughness * roughness;
+            float d = ((NdotH * a2 - NdotH) * NdotH + 1);
+            return a2 / std::max(0.001f, d * d * kPi);
+        }
+
+        float ggxSchlickMaskingTerm(float NdotL, float NdotV, float roughness)
+        {
+            float k = roughness * roughness / 2;
+            float g_v = NdotV / (NdotV * (1 - k) + k);
+            float g_l = NdotL / (NdotL * (1 - k) + k);
+            return g_v * g_l;
+        }
+
+        vec3 schlickFresnel(const vec3& f0, float u)
+        {
+            return f0 + (vec3(1.0f) - f0) * std::pow(1.0f - u, 5.0f);
+        }
+
+        float probabilityToSampleDiffuse(const vec3& dif, const vec3& spec)
+        {
+            float lumDiffuse = std::max(0.01f, luminance(dif));
+            float lumSpecular = std::max(0.01f, luminance(spec));
+            return lumDiffuse / (lumDiffuse + lumSpecular);
+        }
+
+        // A shadow ray towards a random light, as ggxDirect() sets it up.  Its contribution counts if nothing is in the way.
+        struct ShadowRay
+        {
+            vec3 dir;
+            float maxT = 0;
+            vec3 contribution = vec3(0.0f);
+            bool valid = true;      ///< False for lights below the horizon, which ggxDirect() doesn't shoot at
+        };
+
+        ShadowRay sampleDirect(const PathTracerReference::Scene& scene, uint32_t& seed, const Hit& hit, const vec3& V, float rough)
+        {
+            ShadowRay ray;
+            int lightCount = int(scene.lights.size());
+            int lightToSample = std::min(int(PathTracerReference::nextRand(seed) * lightCount), lightCount - 1);
+            const PathTracerReference::PointLight& light = scene.lights[lightToSample];
+
+            // Falcor's evalPointLight()
+            vec3 toLight = light.position - hit.posW;
+            float distSquared = dot(toLight, toLight);
+            vec3 L = (distSquared > 1e-5f) ? normalize(toLight) : vec3(0.0f);
+            vec3 lightIntensity = light.intensity * (1.0f / ((0.01f * 0.01f) + distSquared));
+            ray.maxT = std::sqrt(distSquared);
+
+            float NdotL = saturate(dot(hit.N, L));
+            if (NdotL <= 0.0f)
+            {
+                ray.valid = false;
+                return ray;
+            }
+            ray.dir = normalize(getConeSample(seed, L, 0.995f));
+
+            vec3 H = normalize(V + L);
+            float NdotH = saturate(dot(hit.N, H));
+            float LdotH = saturate(dot(L, H));
+            float NdotV = saturate(dot(hit.N, V));
+            float D = ggxNormalDistribution(NdotH, rough);
+            float G = ggxSchlickMaskingTerm(NdotL, NdotV, rough);
+            vec3 F = schlickFresnel(hit.specular, LdotH);
+            vec3 ggxTerm = D * G * F / (4 * NdotV);
+            ray.contribution = float(lightCount) * lightIntensity * (ggxTerm + NdotL * hit.diffuse / kPi);
+            return ray;
+        }
+
+        // The direction ggxIndirect() continues the path in, and the throughput weight of that sample
+        struct BsdfSample
+        {
+            vec3 dir;
+            vec3 weight = vec3(0.0f);
+            bool valid = true;      ///< False for GGX samples below the horizon, which ggxIndirect() doesn't trace
+        };
+
+        BsdfSample sampleIndirect(uint32_t& seed, const Hit& hit, const vec3& V, float rough)
+        {
+            BsdfSample s;
+            float probDiffuse = probabilityToSampleDiffuse(hit.diffuse, hit.specular);
+            bool chooseDiffuse = PathTracerReference::nextRand(seed) < probDiffuse;
+            float NdotV = saturate(dot(hit.N, V));
+            if (chooseDiffuse)
+            {
+                s.dir = getCosHemisphereSample(seed, hit.N);
+                s.weight = hit.diffuse / probDiffuse;
+            }
+            else
+            {
+                vec3 H = getGGXMicrofacet(seed, rough, hit.N);
+                s.dir = normalize(2.0f * dot(V, H) * H - V);
+                float NdotL = saturate(dot(hit.N, s.dir));
+                if (NdotL <= 0.0f)
+                {
+                    s.valid = false;
+                    return s;
+                }
+                float NdotH = saturate(dot(hit.N, H));
+                float LdotH = saturate(dot(s.dir, H));
+                float D = ggxNormalDistribution(NdotH, rough);
+                float G = ggxSchlickMaskingTerm(NdotL, NdotV, rough);
+                vec3 F = schlickFresnel(hit.specular, LdotH);
+                vec3 ggxTerm = D * G * F / (4 * NdotL * NdotV);
+                float ggxProb = D * NdotH / (4 * LdotH);
+                s.weight = NdotL * ggxTerm / (ggxProb * (1.0f - probDiffuse));
+            }
+            return s;
+        }
+
+        // The G-buffer stores the material's linear roughness, which the primary hit squares.  Secondary hits clamp it first.
+        float primaryRoughness(const Hit& hit) { return hit.linearRoughness * hit.linearRoughness; }
+        float secondaryRoughness(const Hit& hit) { float r = std::max(0.08f, hit.linearRoughness); return r * r; }
+
+        vec3 cameraRayDir(const PathTracerReference::Scene& scene, const PathTracerReference::Settings& settings, uint32_t x, uint32_t y)
+        {
+            vec3 forward = normalize(scene.cameraTarget - scene.cameraPos);
+            vec3 right = normalize(cross(forward, scene.cameraUp));
+            vec3 up = cross(right, forward);
+            float tanHalf = std::tan(0.5f * scene.fovY);
+            float aspect = float(settings.width) / float(settings.height);
+            float u = ((float(x) + 0.5f) / float(settings.width) * 2.0f - 1.0f) * tanHalf * aspect;
+            float v = (1.0f - (float(y) + 0.5f) / float(settings.height) * 2.0f) * tanHalf;
+            return normalize(forward + u * right + v * up);
+        }
+
+        bool isNaN(const vec3& c)
+        {
+            return std::isnan(c.x) || std::isnan(c.y) || std::isnan(c.z);
+        }
+
+        vec3 removeNaNs(const vec3& c)
+        {
+            return isNaN(c) ? vec3(0.0f) : c;
+        }
+
+        // IndirectClosestHit() and IndirectMiss(), recursing through ggxIndirect()
+        vec3 shadeRecursive(const PathTracerReference::Scene& scene, const PathTracerReference::Settings& settings, uint32_t seed,
+                            const vec3& origin, const vec3& dir, uint32_t rayDepth)
+        {
+            Hit hit = trace(scene, origin, dir, settings.minT, kMaxT);
+            if (!hit.valid) return scene.skyColor;
+
+            vec3 V = -dir;
+            vec3 color = settings.emitMult * hit.emissive;
+            if (settings.doDirect && !scene.lights.empty())
+            {
+                // The megakernel evaluates direct light at secondary hits with a roughness of 0 (its specular lobe drops out)
+                ShadowRay ray = sampleDirect(scene, seed, hit, V, 0.0f);
+                if (ray.valid && isVisible(scene, hit.posW, ray.dir, settings.minT, ray.maxT)) color += ray.contribution;
+            }
+            if (rayDepth < settings.maxDepth)
+            {
+                BsdfSample s = sampleIndirect(seed, hit, V, secondaryRoughness(hit));
+                if (s.valid) color += s.weight * shadeRecursive(scene, settings, seed, hit.posW, s.dir, rayDepth + 1);
+            }
+            return color;
+        }
+    }
+
+    void PathTracerReference::buildBvh(Scene& scene)
+    {
+        scene.bvh.clear();
+        if (scene.triangles.empty()) return;
+        scene.bvh.reserve(2 * (scene.triangles.size() / kBvhLeafSize) + 1);
+        buildBvhNode(scene, 0, (uint32_t)scene.triangles.size());
+    }
+
+    bool PathTracerReference::saveScene(const Scene& scene, const std::string& filename)
+    {
+        BinaryFileStream stream(filename, BinaryFileStream::Mode::Write);
+        if (!stream.isGood()) return false;
+
+        stream << kSceneMagic << kSceneVersion;
+        stream << uint32_t(scene.triangles.size()) << uint32_t(scene.materials.size()) << uint32_t(scene.lights.size());
+        stream.write(scene.triangles.data(), scene.triangles.size() * sizeof(Triangle));
+        stream.write(scene.materials.data(), scene.materials.size() * sizeof(Material));
+        stream.write(scene.lights.data(), scene.lights.size() * sizeof(PointLight));
+        stream << scene.cameraPos << scene.cameraTarget << scene.cameraUp << scene.fovY << scene.backgroundColor << scene.skyColor;
+        bool written = stream.isGood();
+        stream.close();
+        return written;
+    }
+
+    bool PathTracerReference::loadScene(const std::string& filename, Scene& scene)
+    {
+        BinaryFileStream stream(filename, BinaryFileStream::Mode::Read);
+        if (!stream.isGood()) return false;
+
+        uint32_t header[5];
+        stream.read(header, sizeof(header));
+        if (!stream.isGood() || header[0] != kSceneMagic || header[1] != kSceneVersion) return false;
+
+        // Check the counts before allocating, so a corrupt file can't ask for gigabytes
+        const uint64_t arraySize = uint64_t(header[2]) * sizeof(Triangle) + uint64_t(header[3]) * sizeof(Material) + uint64_t(header[4]) * sizeof(PointLight);
+        if (arraySize > stream.getRemainingStreamSize()) return false;
+
+        Scene loaded;
+        loaded.triangles.resize(header[2]);
+        loaded.materials.resize(header[3]);
+        loaded.lights.resize(header[4]);
+        stream.read(loaded.triangles.data(), loaded.triangles.size() * sizeof(Triangle));
+        stream.read(loaded.materials.data(), loaded.materials.size() * sizeof(Material));
+        stream.read(loaded.lights.data(), loaded.lights.size() * sizeof(PointLight));
+        stream >> loaded.cameraPos >> loaded.cameraTarget >> loaded.cameraUp >> loaded.fovY >> loaded.backgroundColor >> loaded.skyColor;
+        if (stream.isFail()) return false;
+
+        for (const auto& triangle : loaded.triangles)
+        {
+            if (triangle.material >= loaded.materials.size()) return false;
+        }
+        scene = std::move(loaded);
+        return true;
+    }
+
+    uint32_t PathTracerReference::initRand(uint32_t val0, uint32_t val1, uint32_t backoff)
+    {
+        uint32_t v0 = val0, v1 = val1, s0 = 0;
+        for (uint32_t n = 0; n < backoff; n++)
+        {
+            s0 += 0x9e3779b9;
+            v0 += ((v1 << 4) + 0xa341316c) ^ (v1 + s0) ^ ((v1 >> 5) + 0xc8013ea4);
+            v1 += ((v0 << 4) + 0xad90777d) ^ (v0 + s0) ^ ((v0 >> 5) + 0x7e95761e);
+        }
+        return v0;
+    }
+
+    float PathTracerReference::nextRand(uint32_t& s)
+    {
+        s = (1664525u * s + 1013904223u);
+        return float(s & 0x00FFFFFF) / float(0x01000000);
+    }
+
+    std::vector<vec3> PathTracerReference::renderRecursive(const Scene& scene, const Settings& settings, uint32_t frameCount)
+    {
+        return renderRecursive(scene, settings, frameCount, 0, 0, settings.width, settings.height);
+    }
+
+    std::vector<vec3> PathTracerReference::renderRecursive(const Scene& scene, const Settings& settings, uint32_t frameCount, uint32_t tileX, uint32_t tileY, uint32_t tileWidth, uint32_t tileHeight)
+    {
+        std::vector<vec3> image(tileWidth * tileHeight);
+        for (uint32_t y = tileY; y < tileY + tileHeight; y++)
+        {
+            for (uint32_t x = tileX; x < tileX + tileWidth; x++)
+            {
+                uint32_t pixel = x + y * settings.width;
+                uint32_t tilePixel = (x - tileX) + (y - tileY) * tileWidth;
+                Hit hit = trace(scene, scene.cameraPos, cameraRayDir(scene, settings, x, y), 0.0f, kMaxT);
+                if (!hit.valid)
+                {
+                    image[tilePixel] = scene.backgroundColor;
+                    continue;
+                }
+
+                // SimpleDiffuseGIRayGen()
+                uint32_t seed = initRand(pixel, frameCount, 16);
+                vec3 V = normalize(scene.cameraPos - hit.posW);
+                float rough = primaryRoughness(hit);
+                vec3 color = settings.emitMult * hit.emissive;
+                if (settings.doDirect && !scene.lights.empty())
+                {
+                    ShadowRay ray = sampleDirect(scene, seed, hit, V, rough);
+                    if (ray.valid && isVisible(scene, hit.posW, ray.dir, settings.minT, ray.maxT)) color += ray.contribution;
+                }
+                if (settings.doIndirect && settings.maxDepth > 0)
+                {
+                    BsdfSample s = sampleIndirect(seed, hit, V, rough);
+                    if (s.valid) color += s.weight * shadeRecursive(scene, settings, seed, hit.posW, s.dir, 1);
+                }
+                image[tilePixel] = removeNaNs(color);
+            }
+        }
+        return image;
+    }
+
+    std::vector<vec3> PathTracerReference::renderWavefront(const Scene& scene, const Settings& settings, uint32_t frameCount, Stats* pStats)
+    {
+        const uint32_t pathCount = settings.width * settings.height;
+
+        // Path state, one path per pixel, structure-of-arrays like the GPU buffers
+        std::vector<vec3> origin(pathCount), dir(pathCount), throughput(pathCount), radiance(pathCount);
+        std::vector<uint32_t> seed(pathCount);
+        std::vector<Hit> hits(pathCount);
+        std::vector<ShadowRay> shadowRays(pathCount);
+
+        std::vector<uint32_t> queue, nextQueue, shadowQueue;
+        queue.reserve(pathCount);
+        nextQueue.reserve(pathCount);
+        shadowQueue.reserve(pathCount);
+
+        // Generate: the primary hits come from the G-buffer, so every path starts at its first shading stage
+        for (uint32_t y = 0; y < settings.height; y++)
+        {
+            for (uint32_t x = 0; x < settings.width; x++)
+            {
+                uint32_t path = x + y * settings.width;
+                hits[path] = trace(scene, scene.cameraPos, cameraRayDir(scene, settings, x, y), 0.0f, kMaxT);
+                if (!hits[path].valid)
+                {
+                    radiance[path] = scene.backgroundColor;
+                    continue;
+                }
+                origin[path] = scene.cameraPos;
+                throughput[path] = vec3(1.0f);
+                radiance[path] = settings.emitMult * hits[path].emissive;
+                seed[path] = initRand(path, frameCount, 16);
+                queue.push_back(path);
+            }
+        }
+
+        if (pStats)
+        {
+            pStats->activePaths.clear();
+            pStats->shadowRays.clear();
+        }
+
+        for (uint32_t bounce = 0; bounce <= settings.maxDepth && !queue.empty(); bounce++)
+        {
+            // Shade: add what this vertex emits, set up its shadow ray, and pick the direction to continue in
+            shadowQueue.clear();
+            nextQueue.clear();
+            for (uint32_t path : queue)
+            {
+                const Hit& hit = hits[path];
+                if (bounce > 0)
+                {
+                    if (!hit.valid)
+                    {
+                        radiance[path] += throughput[path] * scene.skyColor;
+                        continue;
+                    }
+                    radiance[path] += throughput[path] * settings.emitMult * hit.emissive;
+                }
+
+                vec3 V = normalize(origin[path] - hit.posW);
+                float rough = (bounce == 0) ? primaryRoughness(hit) : secondaryRoughness(hit);
+                if (settings.doDirect && !scene.lights.empty())
+                {
+                    shadowRays[path] = sampleDirect(scene, seed[path], hit, V, (bounce == 0) ? rough : 0.0f);
+                    shadowRays[path].contribution *= throughput[path];
+                    if (shadowRays[path].valid) shadowQueue.push_back(path);
+                }
+
+                if (!settings.doIndirect || bounce >= settings.maxDepth) continue;
+                BsdfSample s = sampleIndirect(seed[path], hit, V, rough);
+                if (!s.valid) continue;
+                throughput[path] *= s.weight;
+
+                // Any other 0/0 the megakernel carries into the pixel's color, which then gets zeroed out.  Do the same,
+                //     before Russian roulette gets a chance to drop the path.
+                if (isNaN(s.weight))
+                {
+                    radiance[path] = vec3(std::numeric_limits<float>::quiet_NaN());
+                    continue;
+                }
+
+                // Russian roulette: keep the path with a probability that follows its throughput, and boost the survivors
+                if (settings.russianRoulette && bounce + 1 >= settings.rouletteStartDepth)
+                {
+                    const vec3& t = throughput[path];
+                    float q = std::min(1.0f, std::max(settings.rouletteMinProbability, std::max(t.x, std::max(t.y, t.z))));
+                    if (nextRand(seed[path]) >= q) continue;
+                    throughput[path] /= q;
+                }
+                origin[path] = hit.posW;
+                dir[path] = s.dir;
+                nextQueue.push_back(path);
+            }
+
+            // Shadow: trace the queued shadow rays
+            for (uint32_t path : shadowQueue)
+            {
+                const ShadowRay& ray = shadowRays[path];
+                if (isVisible(scene, hits[path].posW, ray.dir, settings.minT, ray.maxT)) radiance[path] += ray.contribution;
+            }
+
+            // Extension: trace the surviving paths to their next vertex.  Appending in order is a stable compaction of the queue.
+            for (uint32_t path : nextQueue)
+            {
+                hits[path] = trace(scene, origin[path], dir[path], settings.minT, kMaxT);
+            }
+
+            if (pStats)
+            {
+                pStats->activePaths.push_back(uint32_t(queue.size()));
+                pStats->shadowRays.push_back(uint32_t(shadowQueue.size()));
+            }
+            std::swap(queue, nextQueue);
+        }
+
+        for (auto& c : radiance) c = removeNaNs(c);
+        return radiance;
+    }
+}
@@ -0,0 +1,148 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "glm/vec3.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU reference of PathTracingPipeline's GGX path tracer (GlobalIllumination.rt.hlsl and its wavefront mode), for small scenes.
+        renderRecursive() follows each path to its end before starting the next one, like the megakernel ray generation shader.
+        renderWavefront() advances all paths one bounce at a time: a shade stage over the queue of live paths writes shadow rays and
+        extension rays, the shadow and extension stages trace them, and the survivors are compacted into the next bounce's queue.
+        Both draw from the shaders' random number generator in the same order, so without Russian roulette they produce the same image.
+        Scenes are lists of double-sided triangles lit by point lights and a constant sky; there is no environment map lighting.
+        Rays test every triangle until buildBvh() puts a bounding volume hierarchy over them.
+    */
+    class PathTracerReference
+    {
+    public:
+        struct Material
+        {
+            glm::vec3 diffuse = glm::vec3(0.5f);
+            glm::vec3 specular = glm::vec3(0.04f);
+            float linearRoughness = 0.5f;
+            glm::vec3 emissive = glm::vec3(0.0f);
+        };
+
+        struct Triangle
+        {
+            glm::vec3 p0, p1, p2;
+            uint32_t material = 0;
+        };
+
+        /** Node of the bounding volume hierarchy built by buildBvh()
+        */
+        struct BvhNode
+        {
+            glm::vec3 boxMin;
+            glm::vec3 boxMax;
+            uint32_t first;         ///< First triangle under the node
+            uint32_t count;         ///< Number of triangles under the node
+            uint32_t rightChild;    ///< 0 for leaves. The left child follows its parent.
+        };
+
+        struct PointLight
+        {
+            glm::vec3 position;
+            glm::vec3 intensity;
+        };
+
+        struct Scene
+        {
+            std::vector<Triangle> triangles;
+            std::vector<Material> materials;
+            std::vector<PointLight> lights;
+            std::vector<BvhNode> bvh;                       ///< Empty until buildBvh() is called
+            glm::vec3 cameraPos = glm::vec3(0.0f);
+            glm::vec3 cameraTarget = glm::vec3(0.0f, 0.0f, -1.0f);
+            glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+            float fovY = 0.8f;                              ///< Vertical field of view, in radians
+            glm::vec3 backgroundColor = glm::vec3(0.0f);    ///< Seen by camera rays that miss (the G-buffer's clear color)
+            glm::vec3 skyColor = glm::vec3(0.0f);           ///< Returned by indirect rays that miss
+        };
+
+        struct Settings
+        {
+            uint32_t width = 64;
+            uint32_t height = 64;
+            uint32_t maxDepth = 1;              ///< Number of indirect bounces
+            bool doDirect = true;               ///< Shoot shadow rays to a random light at every vertex
+            bool doIndirect = true;
+            float minT = 1.0e-4f;
+            float emitMult = 1.0f;
+            bool russianRoulette = false;       ///< Only used by renderWavefront()
+            uint32_t rouletteStartDepth = 2;    ///< First bounce whose paths can be terminated
+            float rouletteMinProbability = 0.05f;
+        };
+
+        /** Number of paths and shadow rays at each bounce of renderWavefront()
+        */
+        struct Stats
+        {
+            std::vector<uint32_t> activePaths;  ///< Paths shaded at each bounce (bounce 0 is the primary hit)
+            std::vector<uint32_t> shadowRays;   ///< Paths which traced a shadow ray at each bounce
+        };
+
+        /** Build a bounding volume hierarchy over a scene's triangles, which reorders them. Call it again after changing the triangles.
+        */
+        static void buildBvh(Scene& scene);
+
+        /** Write a scene to a binary file, so a process without a GPU device can render it (see DistributedReferenceCoordinator). The hierarchy isn't saved.
+            \return false if the file couldn't be written
+        */
+        static bool saveScene(const Scene& scene, const std::string& filename);
+
+        /** Read a scene written by saveScene(). Call buildBvh() on it before rendering large scenes.
+            \return false if the file is missing, truncated or not a scene file. The scene isn't modified then.
+        */
+        static bool loadScene(const std::string& filename, Scene& scene);
+
+        /** Render a frame one path at a time, like the megakernel ray generation shader
+            \return Linear radiance, row by row
+        */
+        static std::vector<glm::vec3> renderRecursive(const Scene& scene, const Settings& settings, uint32_t frameCount);
+
+        /** Render the tile of a frame with its top left pixel at (x, y). Pixels draw the same random numbers as in the whole frame.
+            \return Linear radiance of the tile's width * height pixels, row by row
+        */
+        static std::vector<glm::vec3> renderRecursive(const Scene& scene, const Settings& settings, uint32_t frameCount, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+        /** Render a frame one bounce at a time over queues of live paths, like the wavefront mode
+            \return Linear radiance, row by row
+        */
+        static std::vector<glm::vec3> renderWavefront(const Scene& scene, const Settings& settings, uint32_t frameCount, Stats* pStats = nullptr);
+
+        /** The random number generator the shaders use (GlobalIlluminationUtils.hlsli)
+        */
+        static uint32_t initRand(uint32_t val0, uint32_t val1, uint32_t backoff = 16);
+        static float nextRand(uint32_t& s);
+    };
+}
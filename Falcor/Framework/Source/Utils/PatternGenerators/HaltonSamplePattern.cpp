@@ -27,15 +27,14 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "HaltonSamplePattern.h"
+#include "Utils/LowDiscrepancy.h"
 
 namespace Falcor
 {
-    const vec2 HaltonSamplePattern::kPattern[8] = { { 1.0f / 2.0f - 0.5f, 1.0f / 3.0f - 0.5f },
-    { 1.0f / 4.0f - 0.5f, 2.0f / 3.0f - 0.5f },
-    { 3.0f / 4.0f - 0.5f, 1.0f / 9.0f - 0.5f },
-    { 1.0f / 8.0f - 0.5f, 4.0f / 9.0f - 0.5f },
-    { 5.0f / 8.0f - 0.5f, 7.0f / 9.0f - 0.5f },
-    { 3.0f / 8.0f - 0.5f, 2.0f / 9.0f - 0.5f },
-    { 7.0f / 8.0f - 0.5f, 5.0f / 9.0f - 0.5f },
-    { 0.5f / 8.0f - 0.5f, 8.0f / 9.0f - 0.5f } };
+    vec2 HaltonSamplePattern::next()
+    {
+        // Index 0 would be the pixel's corner, so start at 1
+        uint32_t index = (mCurSample++) % mSampleCount + 1;
+        return vec2(LowDiscrepancy::halton(0, index), LowDiscrepancy::halton(1, index)) - 0.5f;
+    }
 }
\ No newline at end of file
@@ -30,6 +30,8 @@
 
 namespace Falcor
 {
+    /** Halton points in bases 2 and 3, as offsets in [-0.5, 0.5). The pattern repeats after sampleCount samples, which can be any number.
+    */
     class HaltonSamplePattern : public PatternGenerator, public inherit_shared_from_this<PatternGenerator, HaltonSamplePattern>
     {
     public:
@@ -42,18 +44,14 @@ namespace Falcor
 
         virtual void reset(uint32_t startID = 0) { mCurSample = 0; }
 
-        virtual vec2 next()
-        {
-            return kPattern[(mCurSample++) % mSampleCount];
-        }
+        virtual vec2 next();
     protected:
         HaltonSamplePattern(uint32_t sampleCount) : mSampleCount(sampleCount)
         {
-            assert(sampleCount == 8);
+            assert(sampleCount > 0);
         }
 
         uint32_t mCurSample = 0;
         const uint32_t mSampleCount = 8;
-        static const vec2 kPattern[];
     };
 }
\ No newline at end of file
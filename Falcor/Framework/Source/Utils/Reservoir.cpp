@@ -0,0 +1,70 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Reservoir.h"
+
+namespace Falcor
+{
+    bool Reservoir::update(uint32_t candidate, float weight, float candidateTargetPdf, float u)
+    {
+        weightSum += weight;
+        M += 1;
+        if (weight > 0 && u * weightSum < weight)
+        {
+            sample = candidate;
+            targetPdf = candidateTargetPdf;
+            return true;
+        }
+        return false;
+    }
+
+    bool Reservoir::merge(const Reservoir& other, float targetPdfHere, float u)
+    {
+        // The other reservoir's sample stands for its M candidates, and is resampled with the target pdf of this pixel
+        float weight = targetPdfHere * other.W * other.M;
+        weightSum += weight;
+        M += other.M;
+        if (weight > 0 && u * weightSum < weight)
+        {
+            sample = other.sample;
+            targetPdf = targetPdfHere;
+            return true;
+        }
+        return false;
+    }
+
+    void Reservoir::finalize()
+    {
+        W = (targetPdf > 0 && M > 0) ? weightSum / (M * targetPdf) : 0.0f;
+    }
+
+    void Reservoir::capHistory(float maxM)
+    {
+        if (M > maxM) M = maxM;
+    }
+}
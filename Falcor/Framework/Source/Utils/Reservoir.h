@@ -0,0 +1,72 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+
+namespace Falcor
+{
+    /** Weighted reservoir sampling for resampled importance sampling (RIS), as used by ReSTIR.
+        A reservoir streams candidates and keeps one of them with a probability proportional to its resampling weight, targetPdf / sourcePdf.
+        Reservoirs combine with merge(), which is how temporal and spatial reuse share samples between frames and pixels.
+        Once all candidates went in, finalize() computes W, the unbiased contribution weight of the kept sample: f(sample) * W estimates the
+        integral of f when the target pdf is proportional to (or approximates) f.
+        This is the CPU reference of the reservoir math in the ReSTIR shaders; both must stay in sync.
+    */
+    struct Reservoir
+    {
+        static const uint32_t kInvalidSample = uint32_t(-1);
+
+        uint32_t sample = kInvalidSample;   ///< The kept candidate
+        float targetPdf = 0;                ///< Target pdf of the kept candidate, at the pixel the reservoir belongs to
+        float weightSum = 0;                ///< Sum of the resampling weights of the candidates
+        float M = 0;                        ///< Number of candidates the reservoir has seen
+        float W = 0;                        ///< Contribution weight of the kept candidate, set by finalize()
+
+        /** Stream a candidate
+            \param[in] weight The candidate's resampling weight, targetPdf / sourcePdf
+            \param[in] u Uniform random number in [0, 1)
+            \return Whether the candidate replaced the kept sample
+        */
+        bool update(uint32_t candidate, float weight, float candidateTargetPdf, float u);
+
+        /** Stream all the candidates another, finalized, reservoir has seen, represented by its kept sample
+            \param[in] targetPdfHere Target pdf of the other reservoir's sample at this reservoir's pixel
+            \param[in] u Uniform random number in [0, 1)
+            \return Whether the other reservoir's sample replaced the kept sample
+        */
+        bool merge(const Reservoir& other, float targetPdfHere, float u);
+
+        /** Compute the contribution weight of the kept sample, weightSum / (M * targetPdf)
+        */
+        void finalize();
+
+        /** Limit the number of candidates a reservoir stands for, so a sample reused over many frames doesn't outweigh new ones
+        */
+        void capHistory(float maxM);
+    };
+}
@@ -0,0 +1,252 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TemporalUpscaleReference.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Clamping in YCoCg keeps the box tight around the luminance of the neighborhood, where most of the variation is
+        vec3 rgbToYCoCg(const vec3& c)
+        {
+            return vec3(0.25f * c.x + 0.5f * c.y + 0.25f * c.z, 0.5f * c.x - 0.5f * c.z, -0.25f * c.x + 0.5f * c.y - 0.25f * c.z);
+        }
+
+        vec3 yCoCgToRgb(const vec3& c)
+        {
+            float t = c.x - c.z;
+            return vec3(t + c.y, c.x + c.z, t - c.y);
+        }
+
+        // Weights of the 4 texels around a position, which is t past the second one
+        void catmullRomWeights(float t, float w[4])
+        {
+            w[0] = t * (-0.5f + t * (1.0f - 0.5f * t));
+            w[1] = 1.0f + t * t * (-2.5f + 1.5f * t);
+            w[2] = t * (0.5f + t * (2.0f - 1.5f * t));
+            w[3] = t * t * (-0.5f + 0.5f * t);
+        }
+
+        uint32_t clampIndex(int32_t i, uint32_t size)
+        {
+            return uint32_t(std::min(std::max(i, 0), int32_t(size) - 1));
+        }
+    }
+
+    TemporalUpscaleReference::SharedPtr TemporalUpscaleReference::create(uvec2 outputSize, const Settings& settings)
+    {
+        return SharedPtr(new TemporalUpscaleReference(outputSize, settings));
+    }
+
+    TemporalUpscaleReference::TemporalUpscaleReference(uvec2 outputSize, const Settings& settings) : mSettings(settings), mOutputSize(outputSize)
+    {
+        mColor.assign(outputSize.x * outputSize.y, vec3(0.0f));
+        mWeight.assign(outputSize.x * outputSize.y, 0.0f);
+    }
+
+    void TemporalUpscaleReference::reset()
+    {
+        std::fill(mWeight.begin(), mWeight.end(), 0.0f);
+        mPrevLinearZ.clear();
+        mPrevRenderSize = uvec2(0);
+    }
+
+    const std::vector<vec3>& TemporalUpscaleReference::upscale(const Frame& frame)
+    {
+        const uvec2 renderSize = frame.renderSize;
+        const vec2 outputPerRender = vec2(mOutputSize) / vec2(renderSize);
+        const float kernelScale = -0.5f / (mSettings.kernelRadius * mSettings.kernelRadius);
+        const bool hasHistory = !mPrevLinearZ.empty();
+
+        std::vector<vec3> color(mColor.size());
+        std::vector<float> weight(mWeight.size());
+        for (uint32_t y = 0; y < mOutputSize.y; y++)
+        {
+            for (uint32_t x = 0; x < mOutputSize.x; x++)
+            {
+                const vec2 uv = (vec2(float(x), float(y)) + 0.5f) / vec2(mOutputSize);
+                const vec2 renderPos = uv * vec2(renderSize);
+                const ivec2 center = ivec2(glm::floor(renderPos));
+
+                // Gather the render samples around the pixel, and the color statistics of the neighborhood
+                vec3 sum = vec3(0.0f);
+                float sumWeight = 0.0f;
+                vec3 m1 = vec3(0.0f), m2 = vec3(0.0f);
+                float count = 0.0f;
+                float closestZ = std::numeric_limits<float>::max();
+                uint32_t closest = 0;
+                for (int32_t dy = -1; dy <= 1; dy++)
+                {
+                    for (int32_t dx = -1; dx <= 1; dx++)
+                    {
+                        ivec2 p = center + ivec2(dx, dy);
+                        if (p.x < 0 || p.y < 0 || p.x >= int32_t(renderSize.x) || p.y >= int32_t(renderSize.y)) continue;
+                        uint32_t index = uint32_t(p.y) * renderSize.x + uint32_t(p.x);
+                        const vec3& c = frame.color[index];
+
+                        vec2 d = (vec2(p) + 0.5f + frame.jitter - renderPos) * outputPerRender;
+                        float w = std::exp(kernelScale * dot(d, d));
+                        sum += w * c;
+                        sumWeight += w;
+
+                        vec3 ycocg = rgbToYCoCg(c);
+                        m1 += ycocg;
+                        m2 += ycocg * ycocg;
+                        count += 1.0f;
+
+                        // Foreground motion wins at edges, so silhouettes reproject with the object that covers them
+                        if (frame.linearZ[index].x < closestZ)
+                        {
+                            closestZ = frame.linearZ[index].x;
+                            closest = index;
+                        }
+                    }
+                }
+                vec3 current = sum / std::max(sumWeight, 1e-20f);
+
+                // Find the pixel in the previous frame, and check it saw the same surface
+                vec2 prevUV = uv + frame.motion[closest];
+                bool valid = hasHistory && prevUV.x >= 0.0f && prevUV.y >= 0.0f && prevUV.x <= 1.0f && prevUV.y <= 1.0f;
+                if (valid && mSettings.depthTest)
+                {
+                    const vec2 z = frame.linearZ[closest];
+                    const float tolerance = mSettings.depthTolerance * (z.y + 1e-2f);
+                    vec2 prevPos = prevUV * vec2(mPrevRenderSize) - 0.5f;
+                    ivec2 base = ivec2(glm::floor(prevPos));
+                    valid = false;
+                    for (int32_t i = 0; i < 4; i++)
+                    {
+                        ivec2 p = base + ivec2(i & 1, i >> 1);
+                        if (p.x < 0 || p.y < 0 || p.x >= int32_t(mPrevRenderSize.x) || p.y >= int32_t(mPrevRenderSize.y)) continue;
+                        float prevZ = mPrevLinearZ[uint32_t(p.y) * mPrevRenderSize.x + uint32_t(p.x)].x;
+                        if (std::abs(prevZ - z.x) <= tolerance) valid = true;
+                    }
+                }
+
+                float historyWeight = 0.0f;
+                vec3 history = vec3(0.0f);
+                if (valid)
+                {
+                    // Catmull-Rom keeps the history sharp through the many resamplings it goes through; its weight is filtered bilinearly
+                    vec2 pos = prevUV * vec2(mOutputSize) - 0.5f;
+                    ivec2 base = ivec2(glm::floor(pos));
+                    vec2 f = pos - vec2(base);
+                    float wx[4], wy[4];
+                    catmullRomWeights(f.x, wx);
+                    catmullRomWeights(f.y, wy);
+                    for (int32_t j = 0; j < 4; j++)
+                    {
+                        uint32_t row = clampIndex(base.y + j - 1, mOutputSize.y) * mOutputSize.x;
+                        for (int32_t i = 0; i < 4; i++)
+                        {
+                            history += (wx[i] * wy[j]) * mColor[row + clampIndex(base.x + i - 1, mOutputSize.x)];
+                        }
+                    }
+                    history = glm::max(history, vec3(0.0f));
+                    for (int32_t i = 0; i < 4; i++)
+                    {
+                        uint32_t index = clampIndex(base.y + (i >> 1), mOutputSize.y) * mOutputSize.x + clampIndex(base.x + (i & 1), mOutputSize.x);
+                        historyWeight += ((i & 1) ? f.x : 1.0f - f.x) * ((i >> 1) ? f.y : 1.0f - f.y) * mWeight[index];
+                    }
+
+                    // Every frame of motion resamples the history, which blurs it a little more: keep less of it the further it moved
+                    vec2 motionPixels = frame.motion[closest] * vec2(mOutputSize);
+                    float motionFactor = std::min(std::sqrt(dot(motionPixels, motionPixels)) / mSettings.motionWeightDistance, 1.0f);
+                    float maxWeight = mSettings.maxHistoryWeight + (mSettings.maxMotionHistoryWeight - mSettings.maxHistoryWeight) * motionFactor;
+                    historyWeight = std::min(historyWeight, maxWeight);
+
+                    if (mSettings.neighborhoodClamp)
+                    {
+                        vec3 mean = m1 / count;
+                        vec3 sigma = glm::sqrt(glm::max(m2 / count - mean * mean, vec3(0.0f)));
+                        vec3 h = glm::clamp(rgbToYCoCg(history), mean - mSettings.clampGamma * sigma, mean + mSettings.clampGamma * sigma);
+                        history = yCoCgToRgb(h);
+                    }
+                }
+
+                uint32_t out = y * mOutputSize.x + x;
+                weight[out] = historyWeight + sumWeight;
+                color[out] = (history * historyWeight + current * sumWeight) / std::max(weight[out], 1e-20f);
+            }
+        }
+
+        mColor = std::move(color);
+        mWeight = std::move(weight);
+        mPrevLinearZ = frame.linearZ;
+        mPrevRenderSize = renderSize;
+        return mColor;
+    }
+
+    uvec2 TemporalUpscaleReference::getRenderSize(uvec2 outputSize, float upscaleFactor)
+    {
+        vec2 size = glm::ceil(vec2(outputSize) / upscaleFactor);
+        return glm::clamp(uvec2(size), uvec2(1), glm::max(outputSize, uvec2(1)));
+    }
+
+    uint32_t TemporalUpscaleReference::getJitterSampleCount(float upscaleFactor)
+    {
+        return uint32_t(std::ceil(8.0f * upscaleFactor * upscaleFactor));
+    }
+
+    std::vector<vec3> TemporalUpscaleReference::bilinearUpscale(const std::vector<vec3>& image, uvec2 size, uvec2 outputSize)
+    {
+        std::vector<vec3> result(outputSize.x * outputSize.y);
+        for (uint32_t y = 0; y < outputSize.y; y++)
+        {
+            for (uint32_t x = 0; x < outputSize.x; x++)
+            {
+                vec2 pos = (vec2(float(x), float(y)) + 0.5f) / vec2(outputSize) * vec2(size) - 0.5f;
+                ivec2 base = ivec2(glm::floor(pos));
+                vec2 f = pos - vec2(base);
+                uint32_t x0 = clampIndex(base.x, size.x), x1 = clampIndex(base.x + 1, size.x);
+                uint32_t y0 = clampIndex(base.y, size.y), y1 = clampIndex(base.y + 1, size.y);
+                vec3 top = image[y0 * size.x + x0] * (1.0f - f.x) + image[y0 * size.x + x1] * f.x;
+                vec3 bottom = image[y1 * size.x + x0] * (1.0f - f.x) + image[y1 * size.x + x1] * f.x;
+                result[y * outputSize.x + x] = top * (1.0f - f.y) + bottom * f.y;
+            }
+        }
+        return result;
+    }
+
+    double TemporalUpscaleReference::psnr(const std::vector<vec3>& image, const std::vector<vec3>& reference, float peak)
+    {
+        double sum = 0;
+        for (size_t i = 0; i < image.size(); i++)
+        {
+            vec3 d = image[i] - reference[i];
+            sum += double(dot(d, d));
+        }
+        double mse = sum / (3.0 * double(image.size()));
+        if (mse <= 0) return std::numeric_limits<double>::infinity();
+        return 10.0 * std::log10(double(peak) * peak / mse);
+    }
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "glm/vec2.hpp"
+#include "glm/vec3.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Falcor
+{
+    /** CPU reference of HybridRenderingPipeline's temporal upscaler (TemporalUpscalePass and temporalUpscale.ps.hlsl), to compare its
+        reconstruction against native renders.
+        The upstream passes render at a fraction of the output resolution, with the camera jittered by a different sub-pixel offset every
+        frame. Each output pixel gathers the 3x3 render samples around it, weighted by how close their jittered positions landed, and adds
+        them to a history reprojected with the G-buffer's motion vectors. Over a jitter cycle, every output pixel gets samples close to it,
+        which rebuilds detail the render resolution can't hold.
+        The history is dropped where the previous frame's depth doesn't match the current one (disocclusions), and clamped to the color
+        range of the render neighborhood elsewhere, so colors which are no longer there don't ghost. History which moved gets resampled,
+        which blurs it a little every frame, so it is given less weight the more it moves.
+        Images are stored row by row, with the top left pixel first. Colors are linear.
+    */
+    class TemporalUpscaleReference
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TemporalUpscaleReference>;
+
+        struct Settings
+        {
+            float maxHistoryWeight = 16.0f;         ///< Cap of the accumulated sample weight, so the history keeps following changes
+            float maxMotionHistoryWeight = 2.0f;    ///< Cap of the weight of history which moved motionWeightDistance or more since last frame
+            float motionWeightDistance = 0.5f;      ///< In output pixels
+            float kernelRadius = 0.4f;              ///< Standard deviation of the Gaussian weighting render samples, in output pixels
+            float clampGamma = 1.25f;               ///< Half size of the neighborhood color box, in standard deviations
+            float depthTolerance = 10.0f;           ///< Depth changes over this many times the depth slope are disocclusions (as in SVGF)
+            bool neighborhoodClamp = true;
+            bool depthTest = true;
+        };
+
+        /** One frame of the upstream passes, at the render resolution
+        */
+        struct Frame
+        {
+            glm::uvec2 renderSize;
+            std::vector<glm::vec3> color;
+            std::vector<glm::vec2> linearZ;     ///< Linear depth and its screen-space slope (linearZAndNormal.xy)
+            std::vector<glm::vec2> motion;      ///< Previous minus current UV of the surface seen by each sample, without jitter
+            glm::vec2 jitter;                   ///< Offset of the samples from the pixel centers, in render pixels (+y is down)
+        };
+
+        static SharedPtr create(glm::uvec2 outputSize, const Settings& settings);
+        static SharedPtr create(glm::uvec2 outputSize) { return create(outputSize, Settings()); }
+
+        /** Reconstruct an output frame, and keep it as the history of the next one
+            \return The output image
+        */
+        const std::vector<glm::vec3>& upscale(const Frame& frame);
+
+        /** Forget the history, e.g. on a camera cut
+        */
+        void reset();
+
+        const std::vector<glm::vec3>& getOutput() const { return mColor; }
+
+        /** Get the sample weight accumulated by each output pixel. It drops to the current frame's weight at disocclusions.
+        */
+        const std::vector<float>& getHistoryWeight() const { return mWeight; }
+
+        glm::uvec2 getOutputSize() const { return mOutputSize; }
+
+        void setSettings(const Settings& settings) { mSettings = settings; }
+        const Settings& getSettings() const { return mSettings; }
+
+        /** Get the render resolution of an upscaling factor, rounded up like ResourceManager's render sizes
+        */
+        static glm::uvec2 getRenderSize(glm::uvec2 outputSize, float upscaleFactor);
+
+        /** Get the length of the jitter sequence of an upscaling factor, so a cycle puts about 8 samples in every output pixel
+        */
+        static uint32_t getJitterSampleCount(float upscaleFactor);
+
+        /** Bilinearly stretch an image to the output size, like the pipeline's final blit does without the upscaler
+        */
+        static std::vector<glm::vec3> bilinearUpscale(const std::vector<glm::vec3>& image, glm::uvec2 size, glm::uvec2 outputSize);
+
+        /** Get the peak signal-to-noise ratio of an image against a reference, in dB, for colors in [0, peak]
+        */
+        static double psnr(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference, float peak = 1.0f);
+
+    private:
+        TemporalUpscaleReference(glm::uvec2 outputSize, const Settings& settings);
+
+        Settings mSettings;
+        glm::uvec2 mOutputSize;
+        std::vector<glm::vec3> mColor;      ///< Last output, and the history of the next frame
+        std::vector<float> mWeight;
+        std::vector<glm::vec2> mPrevLinearZ;
+        glm::uvec2 mPrevRenderSize = glm::uvec2(0);
+    };
+}
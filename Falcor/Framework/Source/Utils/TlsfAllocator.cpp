@@ -0,0 +1,287 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TlsfAllocator.h"
+#include <cassert>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        uint32_t findLowestBit(uint64_t v)
+        {
+            assert(v);
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward64(&index, v);
+            return index;
+#else
+            return uint32_t(__builtin_ctzll(v));
+#endif
+        }
+
+        uint32_t findHighestBit(uint64_t v)
+        {
+            assert(v);
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanReverse64(&index, v);
+            return index;
+#else
+            return 63 - uint32_t(__builtin_clzll(v));
+#endif
+        }
+
+        uint64_t alignUp(uint64_t v, uint64_t alignment)
+        {
+            return (v + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    TlsfAllocator::TlsfAllocator(uint64_t capacity, uint64_t granularity) : mGranularity(granularity)
+    {
+        assert(granularity && (granularity & (granularity - 1)) == 0);
+        mCapacity = capacity & ~(granularity - 1);
+        for (auto& fl : mFreeHeads)
+        {
+            for (auto& head : fl) head = kNullBlock;
+        }
+
+        // Start with a single free block covering everything
+        if (mCapacity)
+        {
+            uint32_t blockId = newBlock();
+            mBlocks[blockId].offset = 0;
+            mBlocks[blockId].size = mCapacity;
+            insertFree(blockId);
+        }
+    }
+
+    void TlsfAllocator::mapping(uint64_t size, uint32_t& fl, uint32_t& sl)
+    {
+        // The first level is the power of two; the second level linearly subdivides it
+        fl = findHighestBit(size);
+        uint64_t subdivision = (fl >= kSlLog2) ? (size >> (fl - kSlLog2)) : (size << (kSlLog2 - fl));
+        sl = uint32_t(subdivision) & (kSlCount - 1);
+    }
+
+    bool TlsfAllocator::findFreeList(uint64_t size, uint32_t& fl, uint32_t& sl) const
+    {
+        // Round the request up to the next list boundary, so any block in the list we find is large enough
+        uint32_t rawFl = findHighestBit(size);
+        if (rawFl > kSlLog2)
+        {
+            uint64_t round = (1ull << (rawFl - kSlLog2)) - 1;
+            if (size > ~round) return false;
+            size += round;
+        }
+        mapping(size, fl, sl);
+
+        // Any non-empty list at this first level, at or above our second level?
+        uint32_t slMap = mSlBitmap[fl] & (~0u << sl);
+        if (slMap == 0)
+        {
+            // No, so take the smallest non-empty list at a higher first level
+            uint64_t flMap = (fl + 1 < kFlCount) ? (mFlBitmap & (~0ull << (fl + 1))) : 0;
+            if (flMap == 0) return false;
+            fl = findLowestBit(flMap);
+            slMap = mSlBitmap[fl];
+        }
+        sl = findLowestBit(slMap);
+        return true;
+    }
+
+    void TlsfAllocator::insertFree(uint32_t blockId)
+    {
+        Block& block = mBlocks[blockId];
+        uint32_t fl, sl;
+        mapping(block.size, fl, sl);
+
+        block.isFree = true;
+        block.prevFree = kNullBlock;
+        block.nextFree = mFreeHeads[fl][sl];
+        if (block.nextFree != kNullBlock) mBlocks[block.nextFree].prevFree = blockId;
+        mFreeHeads[fl][sl] = blockId;
+        mFlBitmap |= 1ull << fl;
+        mSlBitmap[fl] |= 1u << sl;
+    }
+
+    void TlsfAllocator::removeFree(uint32_t blockId)
+    {
+        Block& block = mBlocks[blockId];
+        uint32_t fl, sl;
+        mapping(block.size, fl, sl);
+
+        if (block.prevFree != kNullBlock) mBlocks[block.prevFree].nextFree = block.nextFree;
+        if (block.nextFree != kNullBlock) mBlocks[block.nextFree].prevFree = block.prevFree;
+        if (mFreeHeads[fl][sl] == blockId)
+        {
+            mFreeHeads[fl][sl] = block.nextFree;
+            if (block.nextFree == kNullBlock)
+            {
+                mSlBitmap[fl] &= ~(1u << sl);
+                if (mSlBitmap[fl] == 0) mFlBitmap &= ~(1ull << fl);
+            }
+        }
+        block.isFree = false;
+        block.prevFree = block.nextFree = kNullBlock;
+    }
+
+    uint32_t TlsfAllocator::newBlock()
+    {
+        if (mUnusedBlocks.size())
+        {
+            uint32_t blockId = mUnusedBlocks.back();
+            mUnusedBlocks.pop_back();
+            mBlocks[blockId] = Block();
+            return blockId;
+        }
+        mBlocks.push_back(Block());
+        return uint32_t(mBlocks.size() - 1);
+    }
+
+    void TlsfAllocator::deleteBlock(uint32_t blockId)
+    {
+        mUnusedBlocks.push_back(blockId);
+    }
+
+    uint32_t TlsfAllocator::splitBlock(uint32_t blockId, uint64_t size)
+    {
+        uint32_t restId = newBlock();
+        // newBlock() may have grown mBlocks, so only take references afterwards
+        Block& block = mBlocks[blockId];
+        Block& rest = mBlocks[restId];
+        rest.offset = block.offset + size;
+        rest.size = block.size - size;
+        rest.prevPhys = blockId;
+        rest.nextPhys = block.nextPhys;
+        if (rest.nextPhys != kNullBlock) mBlocks[rest.nextPhys].prevPhys = restId;
+        block.nextPhys = restId;
+        block.size = size;
+        insertFree(restId);
+        return restId;
+    }
+
+    uint32_t TlsfAllocator::mergeBlocks(uint32_t first, uint32_t second)
+    {
+        Block& a = mBlocks[first];
+        Block& b = mBlocks[second];
+        assert(a.nextPhys == second && b.prevPhys == first);
+        a.size += b.size;
+        a.nextPhys = b.nextPhys;
+        if (a.nextPhys != kNullBlock) mBlocks[a.nextPhys].prevPhys = first;
+        deleteBlock(second);
+        return first;
+    }
+
+    TlsfAllocator::Allocation TlsfAllocator::allocate(uint64_t size, uint64_t alignment)
+    {
+        assert(alignment && (alignment & (alignment - 1)) == 0);
+        size = alignUp(size ? size : 1, mGranularity);
+        alignment = alignment > mGranularity ? alignment : mGranularity;
+
+        // Every block offset is granularity-aligned, so we never need more padding than this
+        uint64_t searchSize = size + (alignment - mGranularity);
+        uint32_t fl, sl;
+        if (size > mCapacity || !findFreeList(searchSize, fl, sl)) return Allocation();
+
+        uint32_t blockId = mFreeHeads[fl][sl];
+        removeFree(blockId);
+
+        // Split off any padding at the front, so the allocation itself starts aligned
+        uint64_t padding = alignUp(mBlocks[blockId].offset, alignment) - mBlocks[blockId].offset;
+        if (padding)
+        {
+            uint32_t alignedId = splitBlock(blockId, padding);
+            removeFree(alignedId);
+            insertFree(blockId);
+            blockId = alignedId;
+        }
+
+        // Return whatever's left at the end to the free lists
+        if (mBlocks[blockId].size > size) splitBlock(blockId, size);
+
+        mUsedBytes += size;
+        mAllocationCount++;
+
+        Allocation allocation;
+        allocation.offset = mBlocks[blockId].offset;
+        allocation.size = size;
+        allocation.blockId = blockId;
+        return allocation;
+    }
+
+    void TlsfAllocator::release(const Allocation& allocation)
+    {
+        if (!allocation.isValid()) return;
+        uint32_t blockId = allocation.blockId;
+        assert(blockId < mBlocks.size() && !mBlocks[blockId].isFree && mBlocks[blockId].offset == allocation.offset);
+
+        mUsedBytes -= mBlocks[blockId].size;
+        mAllocationCount--;
+
+        // Merge with free neighbors so free space stays as contiguous as possible
+        uint32_t prev = mBlocks[blockId].prevPhys;
+        if (prev != kNullBlock && mBlocks[prev].isFree)
+        {
+            removeFree(prev);
+            blockId = mergeBlocks(prev, blockId);
+        }
+        uint32_t next = mBlocks[blockId].nextPhys;
+        if (next != kNullBlock && mBlocks[next].isFree)
+        {
+            removeFree(next);
+            blockId = mergeBlocks(blockId, next);
+        }
+        insertFree(blockId);
+    }
+
+    TlsfAllocator::Stats TlsfAllocator::getStats() const
+    {
+        Stats stats;
+        stats.capacity = mCapacity;
+        stats.usedBytes = mUsedBytes;
+        stats.allocationCount = mAllocationCount;
+        for (uint32_t fl = 0; fl < kFlCount; fl++)
+        {
+            for (uint32_t sl = 0; sl < kSlCount; sl++)
+            {
+                for (uint32_t blockId = mFreeHeads[fl][sl]; blockId != kNullBlock; blockId = mBlocks[blockId].nextFree)
+                {
+                    const Block& block = mBlocks[blockId];
+                    stats.freeBytes += block.size;
+                    stats.freeBlockCount++;
+                    if (block.size > stats.largestFreeBlock) stats.largestFreeBlock = block.size;
+                }
+            }
+        }
+        return stats;
+    }
+}
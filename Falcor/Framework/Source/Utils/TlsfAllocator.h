@@ -0,0 +1,130 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Two-Level Segregated Fit allocator for a linear address range.
+        This is pure bookkeeping - it never touches memory, it only hands out offsets - so it can be used to
+        suballocate anything addressable (GPU heaps, buffers, descriptor ranges) and tested without a device.
+        Allocation and release are O(1): free blocks live in size-segregated lists indexed by two bitmaps, and
+        adjacent free blocks are merged as soon as they are released.
+    */
+    class TlsfAllocator
+    {
+    public:
+        static const uint64_t kInvalidOffset = uint64_t(-1);
+
+        struct Allocation
+        {
+            uint64_t offset = kInvalidOffset;   ///< Offset of the (aligned) allocation
+            uint64_t size = 0;                  ///< Size of the allocation, rounded up to the granularity
+            uint32_t blockId = uint32_t(-1);    ///< Internal block index, needed to release the allocation
+            bool isValid() const { return offset != kInvalidOffset; }
+        };
+
+        struct Stats
+        {
+            uint64_t capacity = 0;
+            uint64_t usedBytes = 0;
+            uint64_t freeBytes = 0;
+            uint64_t largestFreeBlock = 0;
+            uint32_t allocationCount = 0;
+            uint32_t freeBlockCount = 0;
+
+            /** 0 when all free space is one contiguous block, approaching 1 as it gets split into small pieces
+            */
+            float fragmentation() const { return freeBytes ? 1.0f - float(double(largestFreeBlock) / double(freeBytes)) : 0.0f; }
+        };
+
+        /** Create an allocator managing [0, capacity).
+            \param[in] capacity Size of the range to manage
+            \param[in] granularity Smallest unit of allocation. Must be a power of two; all offsets and sizes are multiples of it.
+        */
+        TlsfAllocator(uint64_t capacity, uint64_t granularity = 256);
+
+        /** Allocate a range. Returns an invalid allocation if there is no free block large enough.
+            \param[in] size Requested size in bytes
+            \param[in] alignment Required alignment of the offset. Must be a power of two.
+        */
+        Allocation allocate(uint64_t size, uint64_t alignment = 1);
+
+        /** Return a range to the allocator. The range can be handed out again by the next allocate() call, so
+            callers sharing the memory with the GPU must defer this until the GPU is done with it.
+        */
+        void release(const Allocation& allocation);
+
+        uint64_t getCapacity() const { return mCapacity; }
+        uint64_t getUsedBytes() const { return mUsedBytes; }
+        uint32_t getAllocationCount() const { return mAllocationCount; }
+        bool isEmpty() const { return mAllocationCount == 0; }
+
+        /** Gather usage statistics. This walks the free lists, so it isn't meant for every allocation.
+        */
+        Stats getStats() const;
+
+    private:
+        static const uint32_t kSlLog2 = 4;                      ///< log2 of the number of second-level lists per first-level list
+        static const uint32_t kSlCount = 1u << kSlLog2;
+        static const uint32_t kFlCount = 64;
+        static const uint32_t kNullBlock = uint32_t(-1);
+
+        struct Block
+        {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            uint32_t prevPhys = kNullBlock;     ///< Neighbors in address order
+            uint32_t nextPhys = kNullBlock;
+            uint32_t prevFree = kNullBlock;     ///< Neighbors in the free list this block is in (if free)
+            uint32_t nextFree = kNullBlock;
+            bool isFree = false;
+        };
+
+        static void mapping(uint64_t size, uint32_t& fl, uint32_t& sl);
+        bool findFreeList(uint64_t size, uint32_t& fl, uint32_t& sl) const;
+        void insertFree(uint32_t blockId);
+        void removeFree(uint32_t blockId);
+        uint32_t newBlock();
+        void deleteBlock(uint32_t blockId);
+        uint32_t splitBlock(uint32_t blockId, uint64_t size);   ///< Splits off [size, end) as a new free block, returns it
+        uint32_t mergeBlocks(uint32_t first, uint32_t second);  ///< Merges two physically adjacent blocks into the first
+
+        uint64_t mCapacity;
+        uint64_t mGranularity;
+        uint64_t mUsedBytes = 0;
+        uint32_t mAllocationCount = 0;
+
+        std::vector<Block> mBlocks;
+        std::vector<uint32_t> mUnusedBlocks;                ///< Recycled indices into mBlocks
+        uint64_t mFlBitmap = 0;                             ///< Bit i set if any list in first-level i is non-empty
+        uint32_t mSlBitmap[kFlCount] = {};                  ///< Bit j set if list [i][j] is non-empty
+        uint32_t mFreeHeads[kFlCount][kSlCount];
+    };
+}
@@ -0,0 +1,115 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ArgList.h"
+#include "Utils/Bitmap.h"
+#include "Utils/CpuTimer.h"
+#include "Utils/DistributedReference.h"
+#include "Utils/StringUtils.h"
+#include <cstdio>
+
+using namespace Falcor;
+
+// Renders a scene exported by PathTracingPipeline's -export-reference-scene over worker processes, and writes the image to an EXR file.
+// It doesn't create a window or a device, so it runs on render nodes without a GPU.
+//     DistributedReferenceCoordinator -scene <file> -output <file.exr> -width <w> -height <h> [-spp <n>] [-workers <n>] [-depth <n>] [-tile <size>] [-checkpoint <file>]
+// A run stopped before it finishes resumes from its checkpoint file when started again with the same arguments.
+
+namespace
+{
+    uint32_t getUint(const ArgList& args, const std::string& key, uint32_t defaultValue)
+    {
+        std::vector<ArgList::Arg> values = args.getValues(key);
+        return values.size() == 1 ? values[0].asUint() : defaultValue;
+    }
+
+    std::string getString(const ArgList& args, const std::string& key)
+    {
+        std::vector<ArgList::Arg> values = args.getValues(key);
+        return values.size() == 1 ? values[0].asString() : "";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // Errors go to the console, there is no one to click a message box away
+    Logger::showBoxOnError(false);
+
+    ArgList args;
+    args.parseCommandLine(concatCommandLine(argc, argv));
+    std::string sceneFile = getString(args, "scene");
+    std::string outputFile = getString(args, "output");
+
+    PathTracerReference::Settings ptSettings;
+    ptSettings.width = getUint(args, "width", 0);
+    ptSettings.height = getUint(args, "height", 0);
+    ptSettings.maxDepth = getUint(args, "depth", ptSettings.maxDepth);
+    if (sceneFile.empty() || outputFile.empty() || ptSettings.width == 0 || ptSettings.height == 0)
+    {
+        std::printf("Usage: DistributedReferenceCoordinator -scene <file> -output <file.exr> -width <w> -height <h> [-spp <n>] [-workers <n>] [-depth <n>] [-tile <size>] [-checkpoint <file>]\n");
+        return 1;
+    }
+
+    PathTracerReference::Scene scene;
+    if (!PathTracerReference::loadScene(sceneFile, scene))
+    {
+        std::printf("Can't read the scene file %s\n", sceneFile.c_str());
+        return 1;
+    }
+
+    DistributedReference::Settings settings;
+    settings.width = ptSettings.width;
+    settings.height = ptSettings.height;
+    settings.totalSamples = getUint(args, "spp", settings.totalSamples);
+    settings.workerCount = getUint(args, "workers", settings.workerCount);
+    settings.tileSize = getUint(args, "tile", settings.tileSize);
+    settings.checkpointFile = getString(args, "checkpoint");
+
+    std::printf("Rendering %u triangles at %ux%u, %u samples per pixel on %u workers\n", uint32_t(scene.triangles.size()), settings.width, settings.height,
+        settings.totalSamples, settings.workerCount);
+    CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+    DistributedReference::SharedPtr pRenderer = DistributedReference::create(settings, DistributedReference::pathTracerBackend(scene, ptSettings));
+    bool complete = pRenderer->render();
+    float seconds = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / 1000.0f;
+
+    const DistributedReference::Stats& stats = pRenderer->getStats();
+    for (uint32_t w = 0; w < uint32_t(stats.workers.size()); w++)
+    {
+        std::printf("Worker %u: %u jobs, %u stolen%s\n", w, stats.workers[w].jobs, stats.workers[w].stolenJobs, stats.workers[w].failed ? ", failed" : "");
+    }
+    if (!complete)
+    {
+        std::printf("The image isn't complete after %.1f s\n", seconds);
+        return 1;
+    }
+
+    std::vector<glm::vec3> image = pRenderer->getImage();
+    Bitmap::saveImage(outputFile, settings.width, settings.height, Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::None, ResourceFormat::RGB32Float, true, image.data());
+    std::printf("Wrote %s after %.1f s\n", outputFile.c_str(), seconds);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TextureCookerTool.h"
+
+static const char* kImageFileString = "Image files\0*.jpg;*.jpeg;*.bmp;*.png;*.tga;*.hdr;*.exr\0\0";
+
+void TextureCookerTool::onLoad(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext)
+{
+    // Cook the directories passed on the command line and exit. This is what a content build runs.
+    const ArgList& args = pSample->getArgList();
+    std::vector<ArgList::Arg> dirs = args.getValues("cook");
+    if (dirs.size())
+    {
+        TextureCooker::Quality quality = args.argExists("fast") ? TextureCooker::Quality::Fast : TextureCooker::Quality::High;
+        mForce = args.argExists("force");
+        for (const auto& dir : dirs)
+        {
+            uint32_t count = TextureCooker::cookDirectory(dir.asString(), quality, mForce);
+            logInfo("Cooked " + std::to_string(count) + " images in " + dir.asString());
+        }
+        pSample->shutdown();
+    }
+}
+
+void TextureCookerTool::cookFile(const std::string& filename)
+{
+    CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+    TextureCooker::Quality quality = (TextureCooker::Quality)mQuality;
+    std::string cooked = mForce ? TextureCooker::cook(filename, quality) : TextureCooker::getCookedFile(filename, quality);
+    float ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    if (cooked.empty())
+    {
+        mStatus = "Can't cook " + getFilenameFromPath(filename);
+        mpPreview = nullptr;
+        return;
+    }
+    mStatus = getFilenameFromPath(cooked) + " in " + std::to_string(ms) + "ms";
+    mpPreview = createTextureFromFile(cooked, false, false);
+}
+
+void TextureCookerTool::cookDirectory(const std::string& directory)
+{
+    CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+    uint32_t count = TextureCooker::cookDirectory(directory, (TextureCooker::Quality)mQuality, mForce);
+    float ms = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    mStatus = std::to_string(count) + " images in " + std::to_string(ms) + "ms";
+}
+
+void TextureCookerTool::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
+{
+    Gui::DropdownList qualityList;
+    qualityList.push_back({ (uint32_t)TextureCooker::Quality::Fast, "Fast (BC1/BC3)" });
+    qualityList.push_back({ (uint32_t)TextureCooker::Quality::High, "High (BC7)" });
+    pGui->addDropdown("Quality", qualityList, mQuality);
+    pGui->addCheckBox("Ignore Cache", mForce);
+
+    std::string filename;
+    if (pGui->addButton("Cook Image") && openFileDialog(kImageFileString, filename))
+    {
+        cookFile(filename);
+    }
+    if (pGui->addButton("Cook Directory", true) && openFileDialog(kImageFileString, filename))
+    {
+        cookDirectory(getDirectoryFromFile(filename));
+    }
+
+    if (mStatus.size()) pGui->addText(mStatus.c_str());
+    if (mpPreview)
+    {
+        std::string info = std::to_string(mpPreview->getWidth()) + "x" + std::to_string(mpPreview->getHeight()) + ", " + std::to_string(mpPreview->getMipCount()) + " mips, " + to_string(mpPreview->getFormat());
+        pGui->addText(info.c_str());
+    }
+}
+
+void TextureCookerTool::onFrameRender(SampleCallbacks* pSample, const RenderContext::SharedPtr& pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+{
+    const glm::vec4 clearColor(0.38f, 0.52f, 0.10f, 1);
+    pRenderContext->clearFbo(pTargetFbo.get(), clearColor, 1.0f, 0, FboAttachmentType::All);
+    if (mpPreview)
+    {
+        pRenderContext->blit(mpPreview->getSRV(), pTargetFbo->getRenderTargetView(0));
+    }
+}
+
+void TextureCookerTool::onDroppedFile(SampleCallbacks* pSample, const std::string& filename)
+{
+    cookFile(filename);
+}
+
+#ifdef _WIN32
+int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nShowCmd)
+#else
+int main(int argc, char** argv)
+#endif
+{
+    TextureCookerTool::UniquePtr pRenderer = std::make_unique<TextureCookerTool>();
+
+    SampleConfig config;
+    config.windowDesc.title = "Texture Cooker";
+    config.windowDesc.resizableWindow = true;
+#ifdef _WIN32
+    Sample::run(config, pRenderer);
+#else
+    config.argc = (uint32_t)argc;
+    config.argv = argv;
+    Sample::run(config, pRenderer);
+#endif
+    return 0;
+}
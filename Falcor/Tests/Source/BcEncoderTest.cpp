@@ -0,0 +1,417 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "BcEncoderTest.h"
+#include "Graphics/TextureCooker.h"
+#include "Utils/DDSHeader.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+using namespace Falcor::BcEncoder;
+
+namespace
+{
+    const char* kFormatNames[] = { "BC1", "BC3", "BC4", "BC5", "BC6H", "BC7" };
+
+    uint32_t getChannelCount(Format format)
+    {
+        switch (format)
+        {
+        case Format::BC4: return 1;
+        case Format::BC5: return 2;
+        case Format::BC1:
+        case Format::BC6H: return 3;
+        default: return 4;
+        }
+    }
+
+    float* getChannel(Block& block, uint32_t c)
+    {
+        float* channels[] = { block.r, block.g, block.b, block.a };
+        return channels[c];
+    }
+
+    /** Blocks along a random color gradient with a little noise, like most texture blocks. BC6H gets the same blocks
+        scaled into HDR.
+    */
+    Block createGradientBlock(Format format, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        float base[4], dir[4];
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            base[c] = unit(rng);
+            dir[c] = unit(rng) - 0.5f;
+        }
+
+        Block block;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float s = unit(rng);
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                float v = std::min(std::max(base[c] + dir[c] * s + 0.02f * (unit(rng) - 0.5f), 0.0f), 1.0f);
+                getChannel(block, c)[i] = (format == Format::BC6H) ? (0.05f + v) * 50.0f : v;
+            }
+            if (format == Format::BC1 || format == Format::BC6H) block.a[i] = 1.0f;
+        }
+        return block;
+    }
+
+    // RMS error over the channels the format stores. BC6H error is relative, since it is HDR.
+    double blockError(Format format, const Block& src, const Block& decoded, double& maxError)
+    {
+        double sum = 0.0;
+        for (uint32_t c = 0; c < getChannelCount(format); c++)
+        {
+            const float* a = getChannel(const_cast<Block&>(src), c);
+            const float* b = getChannel(const_cast<Block&>(decoded), c);
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                double e = std::abs(double(a[i]) - double(b[i]));
+                if (format == Format::BC6H) e /= double(a[i]) + 0.05;
+                sum += e * e;
+                maxError = std::max(maxError, e);
+            }
+        }
+        return sum / double(16 * getChannelCount(format));
+    }
+
+    /** Write a flat (not run-length encoded) Radiance .hdr file. Bitmap can't save them.
+    */
+    void writeRadianceFile(const std::string& path, const float* pRgb, uint32_t width, uint32_t height)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << height << " +X " << width << "\n";
+        for (uint32_t i = 0; i < width * height; i++)
+        {
+            const float* p = pRgb + i * 3;
+            float maxValue = std::max(p[0], std::max(p[1], p[2]));
+            uint8_t rgbe[4] = { 0, 0, 0, 0 };
+            if (maxValue > 1e-32f)
+            {
+                int exponent;
+                float scale = std::frexp(maxValue, &exponent) * 256.0f / maxValue;
+                for (uint32_t c = 0; c < 3; c++) rgbe[c] = uint8_t(p[c] * scale);
+                rgbe[3] = uint8_t(exponent + 128);
+            }
+            file.write(reinterpret_cast<const char*>(rgbe), 4);
+        }
+    }
+
+    template<typename T>
+    bool read(std::ifstream& file, T& value)
+    {
+        file.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return file.good();
+    }
+}
+
+void BcEncoderTest::addTests()
+{
+    addTestToList<TestBlockError>();
+    addTestToList<TestConstantBlocks>();
+    addTestToList<TestImageEdges>();
+    addTestToList<TestDdsLayout>();
+    addTestToList<TestHdrEnvMap>();
+}
+
+testing_func(BcEncoderTest, TestBlockError)
+{
+    // RMS error budgets for gradient blocks. BC1/BC3 are limited by 565 endpoints and 4 indices, BC7 mode 6 does much better.
+    const double kMaxRms[] = { 0.05, 0.05, 0.015, 0.02, 0.1, 0.03 };
+    const uint32_t kBlockCount = 2000;
+    double rms[6];
+
+    for (uint32_t f = 0; f < 6; f++)
+    {
+        Format format = Format(f);
+        std::mt19937 rng(1);
+        double sum = 0.0, maxError = 0.0;
+        for (uint32_t i = 0; i < kBlockCount; i++)
+        {
+            Block block = createGradientBlock(format, rng);
+            uint8_t encoded[16];
+            encodeBlock(format, block, encoded);
+            Block decoded;
+            decodeBlock(format, encoded, decoded);
+            sum += blockError(format, block, decoded, maxError);
+        }
+        rms[f] = std::sqrt(sum / kBlockCount);
+        logInfo(std::string("BcEncoder ") + kFormatNames[f] + ": RMS error " + std::to_string(rms[f]) + ", max " + std::to_string(maxError));
+        if (rms[f] > kMaxRms[f]) return test_fail(std::string(kFormatNames[f]) + " RMS error " + std::to_string(rms[f]) + " is over " + std::to_string(kMaxRms[f]));
+    }
+
+    if (rms[uint32_t(Format::BC7)] >= rms[uint32_t(Format::BC3)]) return test_fail("BC7 should be more accurate than BC3");
+    return test_pass();
+}
+
+testing_func(BcEncoderTest, TestConstantBlocks)
+{
+    // A flat block decodes to the quantized color: within a 565 step for BC1/BC3, and an 8-bit step for the rest
+    const float value[4] = { 0.5f, 0.25f, 1.0f, 0.75f };
+    Block block;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        for (uint32_t c = 0; c < 4; c++) getChannel(block, c)[i] = value[c];
+    }
+
+    for (uint32_t f = 0; f < 6; f++)
+    {
+        Format format = Format(f);
+        uint8_t encoded[16];
+        encodeBlock(format, block, encoded);
+        Block decoded;
+        decodeBlock(format, encoded, decoded);
+
+        bool is565 = (format == Format::BC1 || format == Format::BC3);
+        for (uint32_t c = 0; c < getChannelCount(format); c++)
+        {
+            float tolerance = (is565 && c < 3) ? ((c == 1) ? 1.0f / 63.0f : 1.0f / 31.0f) + 1e-3f : 1.0f / 255.0f + 1e-3f;
+            if (format == Format::BC6H) tolerance = value[c] * 0.01f;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                if (std::abs(getChannel(decoded, c)[i] - value[c]) > tolerance)
+                {
+                    return test_fail(std::string(kFormatNames[f]) + " changed a constant channel " + std::to_string(c) + " to " + std::to_string(getChannel(decoded, c)[i]));
+                }
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(BcEncoderTest, TestImageEdges)
+{
+    // Image sizes pad to whole blocks, and partial blocks replicate the edge texels
+    if (getImageSize(Format::BC1, 3, 5) != 2 * 8 || getImageSize(Format::BC7, 8, 8) != 4 * 16 || getImageSize(Format::BC4, 1, 1) != 8)
+    {
+        return test_fail("Wrong image sizes");
+    }
+
+    const uint32_t width = 6, height = 5;
+    std::vector<float> rgba(width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float* p = &rgba[(y * width + x) * 4];
+            p[0] = float(x) / float(width - 1);
+            p[1] = float(y) / float(height - 1);
+            p[2] = 0.5f;
+            p[3] = 1.0f;
+        }
+    }
+
+    // Multi-threaded and single-threaded encoding must agree, and match encoding the blocks one by one
+    std::vector<uint8_t> threaded(getImageSize(Format::BC7, width, height)), serial(threaded.size());
+    encodeImage(Format::BC7, rgba.data(), width, height, threaded.data());
+    encodeImage(Format::BC7, rgba.data(), width, height, serial.data(), 1);
+    if (threaded != serial) return test_fail("Threaded encoding differs from serial encoding");
+
+    for (uint32_t by = 0; by < 2; by++)
+    {
+        for (uint32_t bx = 0; bx < 2; bx++)
+        {
+            Block block;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                uint32_t x = std::min(bx * 4 + i % 4, width - 1), y = std::min(by * 4 + i / 4, height - 1);
+                for (uint32_t c = 0; c < 4; c++) getChannel(block, c)[i] = rgba[(y * width + x) * 4 + c];
+            }
+            uint8_t expected[16];
+            encodeBlock(Format::BC7, block, expected);
+            if (memcmp(expected, &serial[(by * 2 + bx) * 16], 16) != 0) return test_fail("Block " + std::to_string(bx) + "," + std::to_string(by) + " doesn't replicate the edge texels");
+        }
+    }
+    return test_pass();
+}
+
+testing_func(BcEncoderTest, TestDdsLayout)
+{
+    using namespace Falcor::DdsHelper;
+
+    // Cook a 64x32 image with alpha, then walk the DDS: header, DX10 header, and the full mip chain packed mip 0 first
+    const uint32_t width = 64, height = 32;
+    std::vector<uint8_t> texels(width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t* p = &texels[(y * width + x) * 4];
+            p[0] = uint8_t(x * 4);
+            p[1] = uint8_t(y * 8);
+            p[2] = uint8_t(255 - x * 2);
+            p[3] = uint8_t(128 + (x + y) % 64);
+        }
+    }
+    std::string source = getExecutableDirectory() + "/BcEncoderTest.png";
+    std::vector<uint8_t> saved = texels;     // saveImage() swizzles in place
+    Bitmap::saveImage(source, width, height, Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, true, saved.data());
+
+    const struct { TextureCooker::Quality quality; Format format; DXFormat dxFormat; } kCases[] =
+    {
+        { TextureCooker::Quality::Fast, Format::BC3, FORMAT_BC3_UNORM },
+        { TextureCooker::Quality::High, Format::BC7, FORMAT_BC7_UNORM },
+    };
+    for (const auto& testCase : kCases)
+    {
+        std::string cooked = TextureCooker::cook(source, testCase.quality);
+        if (cooked != TextureCooker::getCacheFilename(source, testCase.quality)) return test_fail("The image wasn't cooked to its cache file");
+        if (TextureCooker::getCookedFile(source, testCase.quality) != cooked) return test_fail("The fresh cache wasn't reused");
+
+        std::ifstream file(cooked, std::ios::binary);
+        uint32_t magic = 0;
+        DdsHeader header;
+        DdsHeaderDX10 dx10Header;
+        if (!read(file, magic) || !read(file, header) || !read(file, dx10Header)) return test_fail("Truncated DDS headers");
+        if (magic != 0x20534444 || header.headerSize != 124 || header.pixelFormat.structSize != 32) return test_fail("Bad DDS magic or header sizes");
+        if (!(header.pixelFormat.flags & DdsHeader::PixelFormat::kFourCCFlag) || header.pixelFormat.fourCC != 0x30315844) return test_fail("Missing the DX10 FourCC");
+        if (header.width != width || header.height != height) return test_fail("Wrong DDS dimensions");
+        if (header.mipCount != 7 || !(header.flags & DdsHeader::kMipCountMask) || !(header.caps[0] & DdsHeader::kCapsMipMapMask)) return test_fail("Expected a full 7-level mip chain");
+        if (header.linearSize != getImageSize(testCase.format, width, height)) return test_fail("Linear size isn't the size of mip 0");
+        if (dx10Header.dxgiFormat != testCase.dxFormat || dx10Header.resourceDimension != RESOURCE_DIMENSION_TEXTURE2D || dx10Header.arraySize != 1)
+        {
+            return test_fail("Wrong DX10 header for " + std::string(kFormatNames[uint32_t(testCase.format)]));
+        }
+
+        // The payload is exactly the mips, each padded to whole blocks
+        size_t payloadSize = 0;
+        for (uint32_t mip = 0; mip < header.mipCount; mip++) payloadSize += getImageSize(testCase.format, std::max(width >> mip, 1u), std::max(height >> mip, 1u));
+        std::vector<uint8_t> payload(payloadSize);
+        file.read(reinterpret_cast<char*>(payload.data()), payloadSize);
+        if (!file.good() || file.peek() != EOF) return test_fail("The DDS payload isn't exactly the mip chain");
+
+        // Mip 0 decodes back to the source (in block order, top row first)
+        double sum = 0.0;
+        for (uint32_t by = 0; by < height / 4; by++)
+        {
+            for (uint32_t bx = 0; bx < width / 4; bx++)
+            {
+                Block decoded;
+                decodeBlock(testCase.format, &payload[(by * (width / 4) + bx) * 16], decoded);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    const uint8_t* p = &texels[((by * 4 + i / 4) * width + bx * 4 + i % 4) * 4];
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        double e = getChannel(decoded, c)[i] - p[c] / 255.0;
+                        sum += e * e;
+                    }
+                }
+            }
+        }
+        double rms = std::sqrt(sum / double(width * height * 4));
+        if (rms > 0.03) return test_fail("Mip 0 of the cooked " + std::string(kFormatNames[uint32_t(testCase.format)]) + " image doesn't match the source (RMS " + std::to_string(rms) + ")");
+
+        file.close();
+        std::remove(cooked.c_str());
+    }
+    std::remove(source.c_str());
+    return test_pass();
+}
+
+testing_func(BcEncoderTest, TestHdrEnvMap)
+{
+    using namespace Falcor::DdsHelper;
+
+    // A 32x16 lat-long map with a bright spot, like an environment map. The red channel is the brightest everywhere,
+    // so the first texel can't be mistaken for a run-length encoded scanline.
+    const uint32_t width = 32, height = 16;
+    std::vector<float> rgb(width * height * 3);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float sun = (x / 4 == 5 && y / 4 == 1) ? 40.0f : 0.0f;
+            float* p = &rgb[(y * width + x) * 3];
+            p[0] = 1.0f + 0.1f * x + sun;
+            p[1] = 0.5f + 0.05f * y + 0.5f * sun;
+            p[2] = 0.25f + 0.02f * x;
+        }
+    }
+    std::string source = getExecutableDirectory() + "/BcEncoderTest.hdr";
+    writeRadianceFile(source, rgb.data(), width, height);
+
+    // HDR sources are cooked to BC6H whatever the quality, with the full mip chain, and load back as BC6H
+    for (auto quality : { TextureCooker::Quality::Fast, TextureCooker::Quality::High })
+    {
+        std::string cooked = TextureCooker::getCookedFile(source, quality);
+        if (cooked.empty()) return test_fail("The .hdr image wasn't cooked");
+
+        std::ifstream file(cooked, std::ios::binary);
+        uint32_t magic = 0;
+        DdsHeader header;
+        DdsHeaderDX10 dx10Header;
+        if (!read(file, magic) || !read(file, header) || !read(file, dx10Header)) return test_fail("Truncated DDS headers");
+        if (dx10Header.dxgiFormat != FORMAT_BC6H_UF16) return test_fail("The .hdr image wasn't cooked to BC6H");
+
+        DdsMipChain chain;
+        if (!readDdsMipChain(cooked, false, chain)) return test_fail("Can't read the cooked mip chain");
+        if (chain.format != ResourceFormat::BC6HU16 || chain.width != width || chain.height != height || chain.mipCount != 6) return test_fail("The cooked .hdr image doesn't load as a full BC6H mip chain");
+
+        // Mip 0 decodes back to the source, within BC6H's relative error (the sun block is the hard one)
+        std::vector<uint8_t> texels;
+        if (!readDdsMips(chain, 0, 1, texels)) return test_fail("Can't read mip 0");
+        double sum = 0.0;
+        for (uint32_t by = 0; by < height / 4; by++)
+        {
+            for (uint32_t bx = 0; bx < width / 4; bx++)
+            {
+                Block decoded;
+                decodeBlock(Format::BC6H, &texels[(by * (width / 4) + bx) * 16], decoded);
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    const float* p = &rgb[((by * 4 + i / 4) * width + bx * 4 + i % 4) * 3];
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        double e = (getChannel(decoded, c)[i] - p[c]) / (double(p[c]) + 0.05);
+                        sum += e * e;
+                    }
+                }
+            }
+        }
+        double rms = std::sqrt(sum / double(width * height * 3));
+        if (rms > 0.1) return test_fail("Mip 0 of the cooked .hdr image doesn't match the source (relative RMS " + std::to_string(rms) + ")");
+
+        file.close();
+        std::remove(cooked.c_str());
+    }
+    std::remove(source.c_str());
+    return test_pass();
+}
+
+int main()
+{
+    BcEncoderTest bet;
+    bet.init(false);
+    bet.run();
+    return 0;
+}
@@ -0,0 +1,415 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "BlueNoiseTest.h"
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <algorithm>
+#include <complex>
+#include <random>
+
+namespace
+{
+    const uint32_t kSize = 64;
+    const uint32_t kDepth = 16;
+
+    BlueNoise::SharedPtr createNoise()
+    {
+        BlueNoise::Desc desc;
+        desc.size = kSize;
+        desc.depth = kDepth;
+        desc.channels = 2;
+        desc.seed = 3;
+        return BlueNoise::create(desc);
+    }
+
+    // 1D DFT of n values with a stride, into pOut
+    void dft(const std::complex<double>* pIn, uint32_t n, uint32_t stride, std::complex<double>* pOut)
+    {
+        for (uint32_t k = 0; k < n; k++)
+        {
+            std::complex<double> sum = 0;
+            for (uint32_t i = 0; i < n; i++)
+            {
+                sum += pIn[i * stride] * std::polar(1.0, -2.0 * M_PI * double(k * i % n) / double(n));
+            }
+            pOut[k * stride] = sum;
+        }
+    }
+
+    /** Power spectrum of a size x size image with its mean removed, averaged in two radial bands of frequencies:
+        the low band is (0, size / 8], the high band is [size / 4, size / 2]. Returns low / high, which is about 1 for white noise.
+    */
+    double spatialBandRatio(const std::vector<double>& image, uint32_t size)
+    {
+        double mean = 0;
+        for (double v : image) mean += v;
+        mean /= image.size();
+
+        std::vector<std::complex<double>> pixels(image.size()), rows(image.size()), spectrum(image.size());
+        for (size_t i = 0; i < image.size(); i++) pixels[i] = image[i] - mean;
+        for (uint32_t y = 0; y < size; y++) dft(pixels.data() + y * size, size, 1, rows.data() + y * size);
+        for (uint32_t x = 0; x < size; x++) dft(rows.data() + x, size, size, spectrum.data() + x);
+
+        double low = 0, high = 0;
+        uint32_t lowCount = 0, highCount = 0;
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                double fx = (x <= size / 2) ? x : double(size) - x;
+                double fy = (y <= size / 2) ? y : double(size) - y;
+                double r = std::sqrt(fx * fx + fy * fy);
+                double power = std::norm(spectrum[y * size + x]);
+                if (r > 0 && r <= size / 8)
+                {
+                    low += power;
+                    lowCount++;
+                }
+                else if (r >= size / 4 && r <= size / 2)
+                {
+                    high += power;
+                    highCount++;
+                }
+            }
+        }
+        return (low / lowCount) / (high / highCount);
+    }
+
+    // Same as spatialBandRatio() for the sequence of values of each pixel over the slices, averaged over the pixels
+    double temporalBandRatio(const BlueNoise* pNoise, uint32_t channel)
+    {
+        uint32_t depth = pNoise->getDesc().depth;
+        uint32_t size = pNoise->getDesc().size;
+        std::vector<std::complex<double>> sequence(depth), spectrum(depth);
+        double low = 0, high = 0;
+        uint32_t lowCount = 0, highCount = 0;
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                double mean = 0;
+                for (uint32_t t = 0; t < depth; t++) mean += pNoise->getValue(x, y, t, channel);
+                mean /= depth;
+                for (uint32_t t = 0; t < depth; t++) sequence[t] = pNoise->getValue(x, y, t, channel) - mean;
+                dft(sequence.data(), depth, 1, spectrum.data());
+
+                for (uint32_t f = 1; f <= depth / 2; f++)
+                {
+                    if (f <= depth / 8)
+                    {
+                        low += std::norm(spectrum[f]);
+                        lowCount++;
+                    }
+                    else if (f >= depth / 4)
+                    {
+                        high += std::norm(spectrum[f]);
+                        highCount++;
+                    }
+                }
+            }
+        }
+        return (low / lowCount) / (high / highCount);
+    }
+
+    // initRand() and nextRand() of the ray tracing shaders, the white noise BlueNoise.slang falls back to
+    uint32_t initRand(uint32_t val0, uint32_t val1, uint32_t backoff = 16)
+    {
+        uint32_t v0 = val0, v1 = val1, s0 = 0;
+        for (uint32_t n = 0; n < backoff; n++)
+        {
+            s0 += 0x9e3779b9;
+            v0 += ((v1 << 4) + 0xa341316c) ^ (v1 + s0) ^ ((v1 >> 5) + 0xc8013ea4);
+            v1 += ((v0 << 4) + 0xad90777d) ^ (v0 + s0) ^ ((v0 >> 5) + 0x7e95761e);
+        }
+        return v0;
+    }
+
+    float nextRand(uint32_t& s)
+    {
+        s = (1664525u * s + 1013904223u);
+        return float(s & 0x00FFFFFF) / float(0x01000000);
+    }
+
+    // The first nextSample1D() of a pixel in BlueNoise.slang, reading the masks quantized like BlueNoise::getTexture()
+    float blueNoiseSample(const BlueNoise* pNoise, uint32_t x, uint32_t y, uint32_t frame)
+    {
+        uint32_t size = pNoise->getDesc().size;
+        uint32_t depth = pNoise->getDesc().depth;
+        size_t texelCount = size_t(size) * size * depth;
+        uint32_t rank = pNoise->getRanks(0)[(size_t(frame % depth) * size + (y + size / 2) % size) * size + (x + size / 2) % size];
+        float value = float((uint64_t(rank) * 256) / texelCount) / 256.0f + 0.5f / 256.0f;
+        value += float(frame / depth) * 0.61803398874989485f;
+        return value - std::floor(value);
+    }
+
+    /** Estimate the visibility of a soft shadow with one ray per pixel and frame, like VisibilityPass's shadow rays, over a screen twice
+        as wide as the masks. The estimates of <temporalFrames> consecutive frames are averaged, then filtered with a box of the given radius.
+        Returns the mean squared error of the unfiltered and of the filtered estimates, against the equally filtered visibility.
+    */
+    void visibilityError(const BlueNoise* pNoise, bool blueNoise, uint32_t frameCount, uint32_t temporalFrames, int32_t radius, double& rawError, double& filteredError)
+    {
+        const uint32_t width = 2 * pNoise->getDesc().size;
+        const uint32_t height = width;
+        auto visibility = [](uint32_t x, uint32_t y) { return glm::clamp((float(x) - 24.0f + 12.0f * std::sin(float(y) * 0.1f)) / 80.0f, 0.0f, 1.0f); };
+
+        rawError = 0;
+        filteredError = 0;
+        size_t count = 0;
+        std::vector<float> estimate(width * height);
+        for (uint32_t firstFrame = 0; firstFrame + temporalFrames <= frameCount; firstFrame += temporalFrames)
+        {
+            std::fill(estimate.begin(), estimate.end(), 0.0f);
+            for (uint32_t frame = firstFrame; frame < firstFrame + temporalFrames; frame++)
+            {
+                for (uint32_t y = 0; y < height; y++)
+                {
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        uint32_t seed = initRand(x + y * width, frame, 16);
+                        float u = blueNoise ? blueNoiseSample(pNoise, x, y, frame) : nextRand(seed);
+                        estimate[y * width + x] += (u < visibility(x, y) ? 1.0f : 0.0f) / float(temporalFrames);
+                    }
+                }
+            }
+
+            for (uint32_t y = radius; y + radius < height; y++)
+            {
+                for (uint32_t x = radius; x + radius < width; x++)
+                {
+                    double error = estimate[y * width + x] - visibility(x, y);
+                    rawError += error * error;
+
+                    double sum = 0;
+                    for (int32_t j = -radius; j <= radius; j++)
+                    {
+                        for (int32_t i = -radius; i <= radius; i++) sum += estimate[(y + j) * width + x + i] - visibility(x + i, y + j);
+                    }
+                    error = sum / double((2 * radius + 1) * (2 * radius + 1));
+                    filteredError += error * error;
+                    count++;
+                }
+            }
+        }
+        rawError /= count;
+        filteredError /= count;
+    }
+
+    std::vector<double> getSlice(const BlueNoise* pNoise, uint32_t slice, uint32_t channel)
+    {
+        uint32_t size = pNoise->getDesc().size;
+        std::vector<double> image(size * size);
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++) image[y * size + x] = pNoise->getValue(x, y, slice, channel);
+        }
+        return image;
+    }
+}
+
+void BlueNoiseTest::addTests()
+{
+    addTestToList<TestRanksArePermutation>();
+    addTestToList<TestSpatialSpectrum>();
+    addTestToList<TestTemporalSpectrum>();
+    addTestToList<TestTiling>();
+    addTestToList<TestThreadCount>();
+    addTestToList<TestFilteredError>();
+}
+
+testing_func(BlueNoiseTest, TestRanksArePermutation)
+{
+    BlueNoise::SharedPtr pNoise = createNoise();
+    for (uint32_t c = 0; c < 2; c++)
+    {
+        // Every rank appears exactly once, so any threshold lets through exactly that fraction of the texels
+        const std::vector<uint32_t>& ranks = pNoise->getRanks(c);
+        std::vector<uint8_t> seen(ranks.size(), 0);
+        for (uint32_t r : ranks)
+        {
+            if (r >= ranks.size() || seen[r]) return test_fail("The ranks of channel " + std::to_string(c) + " are not a permutation");
+            seen[r] = 1;
+        }
+    }
+
+    // A mask with a single slice is spatial blue noise, and must be a permutation too
+    BlueNoise::Desc desc;
+    desc.size = 32;
+    desc.depth = 1;
+    desc.channels = 1;
+    std::vector<uint32_t> ranks = BlueNoise::create(desc)->getRanks(0);
+    std::sort(ranks.begin(), ranks.end());
+    for (uint32_t i = 0; i < ranks.size(); i++)
+    {
+        if (ranks[i] != i) return test_fail("The ranks of a single slice mask are not a permutation");
+    }
+    return test_pass();
+}
+
+testing_func(BlueNoiseTest, TestSpatialSpectrum)
+{
+    // Check the metric first: white noise has a flat spectrum
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> dist;
+    std::vector<double> white(kSize * kSize);
+    for (auto& v : white) v = dist(rng);
+    double whiteRatio = spatialBandRatio(white, kSize);
+    if (whiteRatio < 0.5)
+    {
+        return test_fail("White noise has a low to high frequency power ratio of " + std::to_string(whiteRatio));
+    }
+
+    // Blue noise has almost no power at low frequencies, in every slice
+    BlueNoise::SharedPtr pNoise = createNoise();
+    for (uint32_t c = 0; c < 2; c++)
+    {
+        for (uint32_t t = 0; t < kDepth; t++)
+        {
+            double ratio = spatialBandRatio(getSlice(pNoise.get(), t, c), kSize);
+            if (ratio > 0.1)
+            {
+                return test_fail("Slice " + std::to_string(t) + " of channel " + std::to_string(c) + " has a low to high frequency power ratio of " + std::to_string(ratio));
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(BlueNoiseTest, TestTemporalSpectrum)
+{
+    BlueNoise::SharedPtr pNoise = createNoise();
+    for (uint32_t c = 0; c < 2; c++)
+    {
+        double ratio = temporalBandRatio(pNoise.get(), c);
+        if (ratio > 0.2)
+        {
+            return test_fail("The pixels of channel " + std::to_string(c) + " have a low to high frequency power ratio of " + std::to_string(ratio) + " over time");
+        }
+    }
+    return test_pass();
+}
+
+testing_func(BlueNoiseTest, TestTiling)
+{
+    // Blue noise averages out quickly: the average of a 4x4 box of texels varies much less than it would for white noise.
+    // Boxes which wrap around the edges of the tile must average out just as well as the boxes inside it.
+    const uint32_t kBox = 4;
+    BlueNoise::SharedPtr pNoise = createNoise();
+    double edgeVariance = 0, innerVariance = 0;
+    uint32_t edgeCount = 0, innerCount = 0;
+    for (uint32_t t = 0; t < kDepth; t++)
+    {
+        for (uint32_t y = 0; y < kSize; y++)
+        {
+            for (uint32_t x = 0; x < kSize; x++)
+            {
+                double average = 0;
+                for (uint32_t j = 0; j < kBox; j++)
+                {
+                    for (uint32_t i = 0; i < kBox; i++) average += pNoise->getValue((x + i) % kSize, (y + j) % kSize, t, 0);
+                }
+                double deviation = average / (kBox * kBox) - 0.5;
+                if (x + kBox > kSize || y + kBox > kSize)
+                {
+                    edgeVariance += deviation * deviation;
+                    edgeCount++;
+                }
+                else
+                {
+                    innerVariance += deviation * deviation;
+                    innerCount++;
+                }
+            }
+        }
+    }
+    edgeVariance /= edgeCount;
+    innerVariance /= innerCount;
+
+    double whiteVariance = 1.0 / (12.0 * kBox * kBox);
+    if (edgeVariance > 0.4 * whiteVariance || std::abs(edgeVariance / innerVariance - 1) > 0.25)
+    {
+        return test_fail("The variance of 4x4 box averages is " + std::to_string(edgeVariance) + " across the edges of the tile, " + std::to_string(innerVariance) + " inside it and " + std::to_string(whiteVariance) + " for white noise");
+    }
+    return test_pass();
+}
+
+testing_func(BlueNoiseTest, TestThreadCount)
+{
+    BlueNoise::Desc desc;
+    desc.size = 32;
+    desc.depth = 4;
+    desc.channels = 4;
+    BlueNoise::SharedPtr pSingle = BlueNoise::create(desc, 1);
+    BlueNoise::SharedPtr pMulti = BlueNoise::create(desc, 4);
+    for (uint32_t c = 0; c < desc.channels; c++)
+    {
+        if (pSingle->getRanks(c) != pMulti->getRanks(c))
+        {
+            return test_fail("Channel " + std::to_string(c) + " depends on the number of threads");
+        }
+    }
+
+    // Each channel has its own seed
+    if (pSingle->getRanks(0) == pSingle->getRanks(1))
+    {
+        return test_fail("Two channels are the same mask");
+    }
+    return test_pass();
+}
+
+testing_func(BlueNoiseTest, TestFilteredError)
+{
+    // The sample sequences of the shaders draw as many rays from blue noise as from the LCG, so each pixel is as noisy. Once the
+    // denoiser averages neighboring pixels (and frames), the blue-noise error must be well below the LCG's.
+    const uint32_t kFrames = 32;
+    BlueNoise::SharedPtr pNoise = createNoise();
+    for (uint32_t temporalFrames : { 1u, 4u })
+    {
+        double blueRaw, blueFiltered, whiteRaw, whiteFiltered;
+        visibilityError(pNoise.get(), true, kFrames, temporalFrames, 2, blueRaw, blueFiltered);
+        visibilityError(pNoise.get(), false, kFrames, temporalFrames, 2, whiteRaw, whiteFiltered);
+
+        std::string frames = std::to_string(temporalFrames) + " frame(s) averaged: ";
+        if (temporalFrames == 1 && std::abs(blueRaw / whiteRaw - 1) > 0.1)
+        {
+            return test_fail(frames + "the unfiltered error is " + std::to_string(blueRaw) + " with blue noise and " + std::to_string(whiteRaw) + " with the LCG");
+        }
+        if (blueFiltered > 0.5 * whiteFiltered)
+        {
+            return test_fail(frames + "the error after a 5x5 box filter is " + std::to_string(blueFiltered) + " with blue noise and " + std::to_string(whiteFiltered) + " with the LCG");
+        }
+    }
+    return test_pass();
+}
+
+int main()
+{
+    BlueNoiseTest bnt;
+    bnt.init(false);
+    bnt.run();
+    return 0;
+}
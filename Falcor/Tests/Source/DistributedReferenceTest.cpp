@@ -0,0 +1,262 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "DistributedReferenceTest.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using Falcor::DistributedReference;
+using Falcor::PathTracerReference;
+
+namespace
+{
+    const char* kCheckpointFile = "DistributedReferenceTest.checkpoint";
+
+    // Width and height aren't multiples of the tile size, and the last pass is shorter than the others
+    DistributedReference::Settings createSettings(uint32_t workerCount)
+    {
+        DistributedReference::Settings settings;
+        settings.width = 21;
+        settings.height = 13;
+        settings.tileSize = 8;
+        settings.samplesPerJob = 3;
+        settings.totalSamples = 7;
+        settings.workerCount = workerCount;
+        return settings;
+    }
+
+    // Radiance which depends on the pixel and the sample, so misplaced or missing sums show up
+    glm::vec3 syntheticSample(uint32_t x, uint32_t y, uint32_t sample)
+    {
+        return glm::vec3(float(x), float(y), float(sample + 1));
+    }
+
+    void renderSynthetic(const DistributedReference::Job& job, std::vector<double>& sums)
+    {
+        for (uint32_t s = job.sampleBegin; s < job.sampleBegin + job.sampleCount; s++)
+        {
+            for (uint32_t y = 0; y < job.height; y++)
+            {
+                for (uint32_t x = 0; x < job.width; x++)
+                {
+                    glm::vec3 c = syntheticSample(job.x + x, job.y + y, s);
+                    for (uint32_t i = 0; i < 3; i++) sums[(x + y * job.width) * 3 + i] += c[i];
+                }
+            }
+        }
+    }
+
+    std::string checkSynthetic(const DistributedReference& renderer)
+    {
+        const auto& settings = renderer.getSettings();
+        std::vector<glm::vec3> image = renderer.getImage();
+        for (uint32_t y = 0; y < settings.height; y++)
+        {
+            for (uint32_t x = 0; x < settings.width; x++)
+            {
+                uint32_t pixel = x + y * settings.width;
+                if (renderer.getSampleCounts()[pixel] != settings.totalSamples) return "Pixel " + std::to_string(pixel) + " has " + std::to_string(renderer.getSampleCounts()[pixel]) + " samples";
+                glm::vec3 expected(0.0f);
+                for (uint32_t s = 0; s < settings.totalSamples; s++) expected += syntheticSample(x, y, s) / float(settings.totalSamples);
+                if (glm::length(image[pixel] - expected) > 1e-4f) return "Pixel " + std::to_string(pixel) + " has the wrong value";
+            }
+        }
+        return "";
+    }
+
+    // A floor, a back wall and a glossy box, under a point light
+    PathTracerReference::Scene createScene()
+    {
+        PathTracerReference::Scene scene;
+        PathTracerReference::Material white, glossy;
+        white.diffuse = glm::vec3(0.7f);
+        glossy.diffuse = glm::vec3(0.2f, 0.3f, 0.6f);
+        glossy.specular = glm::vec3(0.6f);
+        glossy.linearRoughness = 0.25f;
+        scene.materials = { white, glossy };
+
+        auto addQuad = [&scene](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d, uint32_t material)
+        {
+            PathTracerReference::Triangle t0, t1;
+            t0.p0 = a; t0.p1 = b; t0.p2 = c; t0.material = material;
+            t1.p0 = a; t1.p1 = c; t1.p2 = d; t1.material = material;
+            scene.triangles.push_back(t0);
+            scene.triangles.push_back(t1);
+        };
+        addQuad(glm::vec3(-2, -1, -2), glm::vec3(2, -1, -2), glm::vec3(2, -1, 2), glm::vec3(-2, -1, 2), 0);
+        addQuad(glm::vec3(-2, -1, -2), glm::vec3(-2, 2, -2), glm::vec3(2, 2, -2), glm::vec3(2, -1, -2), 0);
+        addQuad(glm::vec3(-0.5f, 0.0f, -0.5f), glm::vec3(0.5f, 0.0f, -0.5f), glm::vec3(0.5f, 0.0f, 0.5f), glm::vec3(-0.5f, 0.0f, 0.5f), 1);
+        addQuad(glm::vec3(-0.5f, -1.0f, 0.5f), glm::vec3(0.5f, -1.0f, 0.5f), glm::vec3(0.5f, 0.0f, 0.5f), glm::vec3(-0.5f, 0.0f, 0.5f), 1);
+
+        PathTracerReference::PointLight light;
+        light.position = glm::vec3(1.0f, 1.5f, 1.0f);
+        light.intensity = glm::vec3(4.0f);
+        scene.lights.push_back(light);
+
+        scene.cameraPos = glm::vec3(0.0f, 0.5f, 4.0f);
+        scene.cameraTarget = glm::vec3(0.0f, -0.2f, 0.0f);
+        scene.backgroundColor = glm::vec3(0.3f, 0.3f, 0.5f);
+        scene.skyColor = glm::vec3(0.1f, 0.15f, 0.2f);
+        return scene;
+    }
+}
+
+void DistributedReferenceTest::addTests()
+{
+    addTestToList<TestMatchesFullFrames>();
+    addTestToList<TestWorkStealing>();
+    addTestToList<TestCheckpointResume>();
+    addTestToList<TestFailedWorker>();
+}
+
+testing_func(DistributedReferenceTest, TestMatchesFullFrames)
+{
+    // The path tracer backend renders sample s as frame s, so the image is the average of the full frames
+    PathTracerReference::Scene scene = createScene();
+    DistributedReference::Settings settings = createSettings(3);
+    PathTracerReference::Settings ptSettings;
+    ptSettings.width = settings.width;
+    ptSettings.height = settings.height;
+    ptSettings.maxDepth = 2;
+
+    auto pRenderer = DistributedReference::create(settings, DistributedReference::pathTracerBackend(scene, ptSettings));
+    if (!pRenderer->render()) return test_fail("The render didn't complete");
+
+    std::vector<glm::vec3> expected(settings.width * settings.height, glm::vec3(0.0f));
+    for (uint32_t s = 0; s < settings.totalSamples; s++)
+    {
+        std::vector<glm::vec3> frame = PathTracerReference::renderRecursive(scene, ptSettings, s);
+        for (size_t i = 0; i < frame.size(); i++) expected[i] += frame[i] / float(settings.totalSamples);
+    }
+
+    std::vector<glm::vec3> image = pRenderer->getImage();
+    for (size_t i = 0; i < image.size(); i++)
+    {
+        if (glm::length(image[i] - expected[i]) > 1e-4f * std::max(1.0f, glm::length(expected[i]))) return test_fail("Pixel " + std::to_string(i) + " differs from the full frames");
+    }
+
+    uint32_t workerJobs = 0;
+    for (const auto& worker : pRenderer->getStats().workers) workerJobs += worker.jobs;
+    if (workerJobs != pRenderer->getJobCount()) return test_fail("The workers didn't render every job");
+    return test_pass();
+}
+
+testing_func(DistributedReferenceTest, TestWorkStealing)
+{
+    // Worker 0's tiles are slow, so the others run out of work and steal them
+    DistributedReference::Settings settings = createSettings(3);
+    settings.samplesPerJob = 1;
+    auto slowFirstTiles = [](const DistributedReference::Job& job, std::vector<double>& sums)
+    {
+        if (job.x == 0 && job.y == 0) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        renderSynthetic(job, sums);
+    };
+
+    auto pRenderer = DistributedReference::create(settings, slowFirstTiles);
+    if (!pRenderer->render()) return test_fail("The render didn't complete");
+    std::string error = checkSynthetic(*pRenderer);
+    if (error.size()) return test_fail(error);
+
+    const auto& workers = pRenderer->getStats().workers;
+    if (workers.size() != settings.workerCount) return test_fail("Expected stats for every worker");
+    uint32_t stolen = workers[1].stolenJobs + workers[2].stolenJobs;
+    if (stolen == 0) return test_fail("No job was stolen from the slow worker");
+    if (workers[0].stolenJobs != 0) return test_fail("The slow worker stole jobs");
+    if (workers[0].jobs >= workers[1].jobs + workers[2].jobs) return test_fail("The slow worker rendered most of the jobs");
+    return test_pass();
+}
+
+testing_func(DistributedReferenceTest, TestCheckpointResume)
+{
+    std::remove(kCheckpointFile);
+    DistributedReference::Settings settings = createSettings(2);
+    settings.checkpointFile = kCheckpointFile;
+
+    // Stop halfway, as if the render had been killed
+    settings.jobLimit = 5;
+    auto pInterrupted = DistributedReference::create(settings, renderSynthetic);
+    if (pInterrupted->render()) return test_fail("The job limit didn't stop the render");
+    if (pInterrupted->getDoneJobCount() != settings.jobLimit) return test_fail("Expected " + std::to_string(settings.jobLimit) + " jobs to be done");
+    if (pInterrupted->getStats().checkpoints == 0) return test_fail("No checkpoint was written");
+
+    // A checkpoint written with other settings is ignored
+    DistributedReference::Settings other = settings;
+    other.totalSamples++;
+    if (DistributedReference::create(other, renderSynthetic)->loadCheckpoint()) return test_fail("Loaded a checkpoint with another sample count");
+
+    settings.jobLimit = 0;
+    auto pResumed = DistributedReference::create(settings, renderSynthetic);
+    if (!pResumed->render()) return test_fail("The resumed render didn't complete");
+    std::remove(kCheckpointFile);
+    if (pResumed->getStats().resumedJobs != 5) return test_fail("Resumed " + std::to_string(pResumed->getStats().resumedJobs) + " jobs instead of 5");
+
+    std::string error = checkSynthetic(*pResumed);
+    if (error.size()) return test_fail("Resumed render: " + error);
+    return test_pass();
+}
+
+testing_func(DistributedReferenceTest, TestFailedWorker)
+{
+#ifdef _WIN32
+    return test_pass();
+#else
+    // Every worker dies on job 4, so it's requeued until none is left, and the coordinator renders what remains
+    const pid_t coordinator = getpid();
+    auto crashOnJob4 = [coordinator](const DistributedReference::Job& job, std::vector<double>& sums)
+    {
+        if (job.id == 4 && getpid() != coordinator) _exit(1);
+        renderSynthetic(job, sums);
+    };
+
+    DistributedReference::Settings settings = createSettings(3);
+    auto pRenderer = DistributedReference::create(settings, crashOnJob4);
+    if (!pRenderer->render()) return test_fail("The render didn't complete");
+    std::string error = checkSynthetic(*pRenderer);
+    if (error.size()) return test_fail(error);
+
+    const auto& stats = pRenderer->getStats();
+    for (const auto& worker : stats.workers)
+    {
+        if (!worker.failed) return test_fail("A worker survived job 4");
+    }
+    if (stats.requeuedJobs < settings.workerCount) return test_fail("The failed workers' jobs weren't requeued");
+    if (stats.localJobs == 0) return test_fail("Nothing was left for the coordinator");
+    return test_pass();
+#endif
+}
+
+int main()
+{
+    DistributedReferenceTest drt;
+    drt.init(false);
+    drt.run();
+    return 0;
+}
@@ -0,0 +1,312 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "DynamicResolutionTest.h"
+#include <deque>
+#include <random>
+
+using namespace Falcor;
+
+namespace
+{
+    enum Group { GBuffer, Visibility, Reflection, Denoise };
+
+    // A GPU whose groups cost fullMs * scale^exponent on top of a fixed cost, with some noise.
+    // The timings of a frame only reach the controller a frame later, like the profiler's.
+    struct SimulatedGpu
+    {
+        float fixedMs = 4.0f;
+        std::vector<float> fullMs = { 3.0f, 4.0f, 5.0f, 3.0f };
+        float exponent = 2.0f;
+        float noise = 0.02f;
+        std::mt19937 rng{ 7 };
+        std::deque<std::vector<float>> inFlight;
+
+        // Render a frame with the controller's current scales, feed it the timings of the previous one, and return the frame time
+        float renderFrame(DynamicResolution& controller)
+        {
+            std::normal_distribution<float> dist(1.0f, noise);
+            std::vector<float> times;
+            float frameMs = fixedMs * dist(rng);
+            for (uint32_t i = 0; i < controller.getGroupCount(); i++)
+            {
+                float t = fullMs[i] * std::pow(controller.getScale(i), exponent) * dist(rng);
+                times.push_back(t);
+                frameMs += t;
+            }
+            times.push_back(frameMs);
+            inFlight.push_back(times);
+            if (inFlight.size() > controller.getSettings().latency)
+            {
+                std::vector<float> measured = inFlight.front();
+                inFlight.pop_front();
+                float measuredFrame = measured.back();
+                measured.pop_back();
+                controller.update(measuredFrame, measured);
+            }
+            return frameMs;
+        }
+    };
+
+    // The groups the hybrid pipeline uses: rays and denoising run at a fraction of the G-buffer resolution
+    DynamicResolution::SharedPtr createController(float targetMs)
+    {
+        DynamicResolution::Settings settings;
+        settings.targetMs = targetMs;
+        DynamicResolution::SharedPtr pController = DynamicResolution::create(settings);
+
+        DynamicResolution::GroupDesc desc;
+        desc.name = "G-buffer";
+        pController->addGroup(desc);
+        desc.name = "Visibility";
+        desc.parent = GBuffer;
+        pController->addGroup(desc);
+        desc.name = "Reflection";
+        desc.scaleStep = 0.5f;
+        pController->addGroup(desc);
+        desc.name = "Denoise";
+        desc.minScale = 1.0f;
+        pController->addGroup(desc);
+        return pController;
+    }
+
+    float runFrames(DynamicResolution& controller, SimulatedGpu& gpu, uint32_t frameCount, std::vector<float>* pFrameTimes = nullptr)
+    {
+        float sum = 0;
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            float t = gpu.renderFrame(controller);
+            sum += t;
+            if (pFrameTimes) pFrameTimes->push_back(t);
+        }
+        return sum / float(frameCount);
+    }
+
+    bool isNear(float value, float target, float tolerance)
+    {
+        return std::abs(value - target) <= tolerance * target;
+    }
+}
+
+void DynamicResolutionTest::addTests()
+{
+    addTestToList<TestConvergesToTarget>();
+    addTestToList<TestScaleLimits>();
+    addTestToList<TestLoadStep>();
+    addTestToList<TestNoOscillation>();
+    addTestToList<TestUnderBudget>();
+    addTestToList<TestPriority>();
+    addTestToList<TestModelMismatch>();
+}
+
+testing_func(DynamicResolutionTest, TestConvergesToTarget)
+{
+    // 19ms at full resolution, against a 14ms budget
+    DynamicResolution::SharedPtr pController = createController(14.0f);
+    SimulatedGpu gpu;
+    runFrames(*pController, gpu, 150);
+    std::vector<float> frameTimes;
+    float average = runFrames(*pController, gpu, 50, &frameTimes);
+    if (!isNear(average, 14.0f, 0.03f))
+    {
+        return test_fail("Frames took " + std::to_string(average) + "ms on average instead of 14ms");
+    }
+    float worst = *std::max_element(frameTimes.begin(), frameTimes.end());
+    if (worst > 14.0f * 1.1f)
+    {
+        return test_fail("A frame took " + std::to_string(worst) + "ms once the scales settled");
+    }
+    if (pController->getScale(GBuffer) >= 1.0f)
+    {
+        return test_fail("The G-buffer is still at full resolution while over budget");
+    }
+    if (pController->getScale(Denoise) != pController->getScale(GBuffer))
+    {
+        return test_fail("Denoising doesn't follow the G-buffer resolution");
+    }
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestScaleLimits)
+{
+    // Five times too slow even at the smallest scales
+    DynamicResolution::SharedPtr pController = createController(14.0f);
+    SimulatedGpu gpu;
+    for (auto& t : gpu.fullMs) t *= 5.0f;
+    for (uint32_t frame = 0; frame < 200; frame++)
+    {
+        gpu.renderFrame(*pController);
+        for (uint32_t i = 0; i < pController->getGroupCount(); i++)
+        {
+            const DynamicResolution::GroupDesc& desc = pController->getGroupDesc(i);
+            float scale = pController->getRelativeScale(i);
+            if (scale < desc.minScale || scale > desc.maxScale)
+            {
+                return test_fail(desc.name + " went out of its range, to " + std::to_string(scale));
+            }
+        }
+    }
+    for (uint32_t i = 0; i < pController->getGroupCount(); i++)
+    {
+        if (pController->getRelativeScale(i) != pController->getGroupDesc(i).minScale)
+        {
+            return test_fail(pController->getGroupDesc(i).name + " isn't at its smallest scale while over budget");
+        }
+    }
+
+    // Once the load goes away, the integral mustn't keep the scales down
+    gpu.fullMs = { 1.0f, 1.0f, 1.0f, 1.0f };
+    runFrames(*pController, gpu, 30);
+    if (pController->getScale(GBuffer) != 1.0f || pController->getScale(Reflection) != 1.0f)
+    {
+        return test_fail("The scales didn't recover after a long time over budget");
+    }
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestLoadStep)
+{
+    DynamicResolution::SharedPtr pController = createController(14.0f);
+    SimulatedGpu gpu;
+    runFrames(*pController, gpu, 150);
+
+    // The camera turns to a much heavier view
+    for (auto& t : gpu.fullMs) t *= 1.4f;
+    runFrames(*pController, gpu, 20);
+    float average = runFrames(*pController, gpu, 30);
+    if (!isNear(average, 14.0f, 0.05f))
+    {
+        return test_fail("After the load increased, frames took " + std::to_string(average) + "ms on average");
+    }
+
+    // And back
+    for (auto& t : gpu.fullMs) t /= 1.4f;
+    runFrames(*pController, gpu, 20);
+    average = runFrames(*pController, gpu, 30);
+    if (!isNear(average, 14.0f, 0.05f))
+    {
+        return test_fail("After the load decreased, frames took " + std::to_string(average) + "ms on average");
+    }
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestNoOscillation)
+{
+    DynamicResolution::SharedPtr pController = createController(14.0f);
+    SimulatedGpu gpu;
+    runFrames(*pController, gpu, 150);
+
+    // Noisy timings shouldn't make the resolution bounce around
+    uint32_t changes = 0;
+    std::vector<float> scales(pController->getGroupCount());
+    for (uint32_t i = 0; i < scales.size(); i++) scales[i] = pController->getRelativeScale(i);
+    for (uint32_t frame = 0; frame < 300; frame++)
+    {
+        gpu.renderFrame(*pController);
+        for (uint32_t i = 0; i < scales.size(); i++)
+        {
+            if (pController->getRelativeScale(i) != scales[i]) changes++;
+            scales[i] = pController->getRelativeScale(i);
+        }
+    }
+    if (changes > 10)
+    {
+        return test_fail("The scales changed " + std::to_string(changes) + " times in 300 frames at a steady load");
+    }
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestUnderBudget)
+{
+    DynamicResolution::SharedPtr pController = createController(30.0f);
+    SimulatedGpu gpu;
+    runFrames(*pController, gpu, 100);
+    for (uint32_t i = 0; i < pController->getGroupCount(); i++)
+    {
+        if (pController->getScale(i) != 1.0f)
+        {
+            return test_fail(pController->getGroupDesc(i).name + " isn't at full resolution while under budget");
+        }
+    }
+
+    // Having had headroom for a long time mustn't delay the reaction to a heavier load
+    for (auto& t : gpu.fullMs) t *= 2.5f;
+    runFrames(*pController, gpu, 10);
+    float average = runFrames(*pController, gpu, 10);
+    if (average > 30.0f * 1.05f)
+    {
+        return test_fail("Frames still took " + std::to_string(average) + "ms 10 frames after going over budget");
+    }
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestPriority)
+{
+    DynamicResolution::Settings settings;
+    settings.targetMs = 8.0f;
+    DynamicResolution::SharedPtr pController = DynamicResolution::create(settings);
+    DynamicResolution::GroupDesc desc;
+    desc.name = "Low";
+    pController->addGroup(desc);
+    desc.name = "High";
+    desc.priority = 3.0f;
+    pController->addGroup(desc);
+
+    SimulatedGpu gpu;
+    gpu.fixedMs = 2.0f;
+    gpu.fullMs = { 4.0f, 4.0f };
+    runFrames(*pController, gpu, 150);
+    if (pController->getScale(1) <= pController->getScale(0))
+    {
+        return test_fail("The high-priority group is at " + std::to_string(pController->getScale(1)) + ", the low-priority one at " + std::to_string(pController->getScale(0)));
+    }
+    return test_pass();
+}
+
+testing_func(DynamicResolutionTest, TestModelMismatch)
+{
+    // Costs don't scale with the pixel count (e.g. BVH traversal and fixed-size dispatches); the PID has to make up for the model
+    DynamicResolution::SharedPtr pController = createController(14.0f);
+    SimulatedGpu gpu;
+    gpu.exponent = 1.2f;
+    for (auto& t : gpu.fullMs) t *= 1.5f;
+    runFrames(*pController, gpu, 200);
+    float average = runFrames(*pController, gpu, 50);
+    if (!isNear(average, 14.0f, 0.03f))
+    {
+        return test_fail("With costs not proportional to the pixel count, frames took " + std::to_string(average) + "ms on average");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    DynamicResolutionTest drt;
+    drt.init(false);
+    drt.run();
+    return 0;
+}
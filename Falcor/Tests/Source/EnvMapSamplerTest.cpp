@@ -0,0 +1,200 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "EnvMapSamplerTest.h"
+#include <random>
+
+namespace
+{
+    const uint32_t kWidth = 64;
+    const uint32_t kHeight = 32;
+
+    // Dim noise with one bright texel, like a sun in a sky probe
+    std::vector<float> createEnvMap()
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> dist(0.0f, 0.1f);
+        std::vector<float> rgba(kWidth * kHeight * 4);
+        for (auto& c : rgba) c = dist(rng);
+        for (uint32_t c = 0; c < 3; c++) rgba[(5 * kWidth + 40) * 4 + c] = 500.0f;
+        return rgba;
+    }
+
+    glm::vec3 latLongToDir(double u, double v)
+    {
+        double phi = M_PI * (2 * u - 1);
+        double theta = M_PI * v;
+        return glm::vec3(float(sin(theta) * sin(phi)), float(cos(theta)), float(-sin(theta) * cos(phi)));
+    }
+
+    // Integrate the pdf over the sphere with the midpoint rule
+    double integratePdf(const EnvMapSampler* pSampler, uint32_t steps)
+    {
+        double sum = 0;
+        for (uint32_t y = 0; y < steps; y++)
+        {
+            double v = (y + 0.5) / steps;
+            for (uint32_t x = 0; x < steps * 2; x++)
+            {
+                double u = (x + 0.5) / (steps * 2);
+                sum += pSampler->evalPdf(latLongToDir(u, v)) * sin(M_PI * v);
+            }
+        }
+        return sum * (M_PI / steps) * (M_PI / steps);
+    }
+}
+
+void EnvMapSamplerTest::addTests()
+{
+    addTestToList<TestPdfSumsToOne>();
+    addTestToList<TestSampleFrequencies>();
+    addTestToList<TestThreadCount>();
+    addTestToList<TestBlackMap>();
+}
+
+testing_func(EnvMapSamplerTest, TestPdfSumsToOne)
+{
+    std::vector<float> rgba = createEnvMap();
+    EnvMapSampler::SharedPtr pSampler = EnvMapSampler::create(rgba.data(), kWidth, kHeight);
+
+    double sum = 0;
+    for (uint32_t y = 0; y < kHeight; y++)
+    {
+        for (uint32_t x = 0; x < kWidth; x++) sum += pSampler->getTexelProbability(x, y);
+    }
+    if (std::abs(sum - 1) > 1e-5)
+    {
+        return test_fail("Texel probabilities sum to " + std::to_string(sum));
+    }
+
+    // Solid angle density is per texel, so the integral is exact up to where the quadrature points fall
+    double integral = integratePdf(pSampler.get(), 1024);
+    if (std::abs(integral - 1) > 1e-3)
+    {
+        return test_fail("The pdf integrates to " + std::to_string(integral) + " over the sphere");
+    }
+    return test_pass();
+}
+
+testing_func(EnvMapSamplerTest, TestSampleFrequencies)
+{
+    std::vector<float> rgba = createEnvMap();
+    EnvMapSampler::SharedPtr pSampler = EnvMapSampler::create(rgba.data(), kWidth, kHeight);
+
+    const uint32_t sampleCount = 1 << 21;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<uint32_t> histogram(kWidth * kHeight, 0);
+    uint32_t pdfMismatches = 0;
+    for (uint32_t i = 0; i < sampleCount; i++)
+    {
+        float pdf;
+        glm::vec3 dir = pSampler->sample(glm::vec2(dist(rng), dist(rng)), pdf);
+
+        // Directions landing exactly on a texel edge can be rounded into the neighbor
+        float evalPdf = pSampler->evalPdf(dir);
+        if (std::abs(evalPdf - pdf) > 1e-3f * pdf) pdfMismatches++;
+
+        float u = (1.0f + atan2(dir.x, -dir.z) * float(M_1_PI)) * 0.5f;
+        float v = acos(glm::clamp(dir.y, -1.0f, 1.0f)) * float(M_1_PI);
+        uint32_t x = std::min(uint32_t(u * kWidth), kWidth - 1);
+        uint32_t y = std::min(uint32_t(v * kHeight), kHeight - 1);
+        histogram[y * kWidth + x]++;
+    }
+
+    if (pdfMismatches > sampleCount / 1000)
+    {
+        return test_fail(std::to_string(pdfMismatches) + " samples have a pdf different from evalPdf() of their direction");
+    }
+
+    // The standard deviation of a frequency is at most 0.5 / sqrt(sampleCount), ~0.00035
+    for (uint32_t y = 0; y < kHeight; y++)
+    {
+        for (uint32_t x = 0; x < kWidth; x++)
+        {
+            double frequency = double(histogram[y * kWidth + x]) / sampleCount;
+            double expected = pSampler->getTexelProbability(x, y);
+            if (std::abs(frequency - expected) > 0.002)
+            {
+                return test_fail("Texel (" + std::to_string(x) + ", " + std::to_string(y) + ") was sampled with frequency " + std::to_string(frequency) + " instead of " + std::to_string(expected));
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(EnvMapSamplerTest, TestThreadCount)
+{
+    std::vector<float> rgba = createEnvMap();
+    EnvMapSampler::SharedPtr pSingle = EnvMapSampler::create(rgba.data(), kWidth, kHeight, 1);
+    EnvMapSampler::SharedPtr pMulti = EnvMapSampler::create(rgba.data(), kWidth, kHeight, 7);
+
+    auto sameTable = [](const std::vector<EnvMapSampler::Entry>& a, const std::vector<EnvMapSampler::Entry>& b)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (a[i].threshold != b[i].threshold || a[i].alias != b[i].alias || a[i].pdf != b[i].pdf) return false;
+        }
+        return true;
+    };
+
+    if (sameTable(pSingle->getMarginalTable(), pMulti->getMarginalTable()) == false || sameTable(pSingle->getConditionalTable(), pMulti->getConditionalTable()) == false)
+    {
+        return test_fail("The tables depend on the number of threads building them");
+    }
+    return test_pass();
+}
+
+testing_func(EnvMapSamplerTest, TestBlackMap)
+{
+    // A black map has nothing to importance sample and should be sampled uniformly over the sphere
+    std::vector<float> rgba(kWidth * kHeight * 4, 0.0f);
+    EnvMapSampler::SharedPtr pSampler = EnvMapSampler::create(rgba.data(), kWidth, kHeight);
+
+    double integral = integratePdf(pSampler.get(), 1024);
+    if (std::abs(integral - 1) > 1e-3)
+    {
+        return test_fail("The pdf of a black map integrates to " + std::to_string(integral) + " over the sphere");
+    }
+
+    // Rows are weighted by the sin(theta) at their center, so the density is only constant up to the row discretization
+    float pdf = pSampler->evalPdf(glm::vec3(0.3f, 0.2f, 0.5f));
+    if (std::abs(pdf * 4 * M_PI - 1) > 0.01)
+    {
+        return test_fail("The pdf of a black map is " + std::to_string(pdf) + " instead of 1 / (4 pi)");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    EnvMapSamplerTest emst;
+    emst.init(true);
+    emst.run();
+    return 0;
+}
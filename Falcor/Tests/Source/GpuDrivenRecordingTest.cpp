@@ -0,0 +1,131 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "GpuDrivenRecordingTest.h"
+#include "Utils/CpuTimer.h"
+
+namespace
+{
+    const uint32_t kFrames = 50;
+    const float kSpacing = 3.0f;
+
+    // A square grid of cubes, each its own model instance, seen from straight above
+    Scene::SharedPtr createGridScene(const Model::SharedPtr& pModel, uint32_t gridSize)
+    {
+        Scene::SharedPtr pScene = Scene::create();
+        for (uint32_t z = 0; z < gridSize; z++)
+        {
+            for (uint32_t x = 0; x < gridSize; x++)
+            {
+                pScene->addModelInstance(pModel, "Cube" + std::to_string(z * gridSize + x), glm::vec3(x * kSpacing, 0, z * kSpacing));
+            }
+        }
+
+        glm::vec3 center = glm::vec3(gridSize * kSpacing * 0.5f, 0, gridSize * kSpacing * 0.5f);
+        Camera::SharedPtr pCamera = Camera::create();
+        pCamera->setPosition(center + glm::vec3(0, gridSize * kSpacing * 1.5f, 0));
+        pCamera->setTarget(center);
+        pCamera->setUpVector(glm::vec3(0, 0, 1));
+        pCamera->setDepthRange(0.1f, gridSize * kSpacing * 4.0f);
+        pScene->setActiveCamera(pScene->addCamera(pCamera));
+        return pScene;
+    }
+
+    /** Average CPU time (ms) to record a renderScene() call, the way SimpleGBufferPass records it.
+        The first frame uploads the instance records and isn't timed. The GPU work is flushed outside the timed region.
+    */
+    double measureRecording(SceneRenderer* pRenderer, const GraphicsState::SharedPtr& pState, const GraphicsVars::SharedPtr& pVars)
+    {
+        RenderContext* pContext = gpDevice->getRenderContext().get();
+        pContext->pushGraphicsState(pState);
+        pContext->pushGraphicsVars(pVars);
+        pRenderer->renderScene(pContext);
+        pContext->flush(true);
+
+        double totalMs = 0;
+        for (uint32_t i = 0; i < kFrames; i++)
+        {
+            CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+            pRenderer->renderScene(pContext);
+            totalMs += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            pContext->flush(true);
+        }
+
+        pContext->popGraphicsVars();
+        pContext->popGraphicsState();
+        return totalMs / kFrames;
+    }
+}
+
+void GpuDrivenRecordingTest::addTests()
+{
+    addTestToList<TestRecordingCost>();
+}
+
+testing_func(GpuDrivenRecordingTest, TestRecordingCost)
+{
+    Model::SharedPtr pModel = Model::createFromFile("Effects/cube.obj");
+    if (pModel == nullptr) return test_fail("Can't load the cube model");
+
+    GraphicsProgram::SharedPtr pProgram = GraphicsProgram::createFromFile("GpuDrivenRecordingTest.slang", "", "main");
+    GraphicsState::SharedPtr pState = GraphicsState::create();
+    pState->setProgram(pProgram);
+    pState->setFbo(FboHelper::create2D(256, 256, Fbo::Desc().setColorTarget(0, ResourceFormat::RGBA8Unorm).setDepthStencilTarget(ResourceFormat::D32Float)));
+    GraphicsVars::SharedPtr pVars = GraphicsVars::create(pProgram->getReflector());
+
+    // The same G-buffer style draw with SceneRenderer and GpuDrivenSceneRenderer, at 16x more instances. SceneRenderer records
+    // per instance, so its cost should grow with the instance count; GpuDrivenSceneRenderer records the same draws either way.
+    const uint32_t kGridSizes[] = { 16, 64 };
+    double sceneRendererMs[2], gpuDrivenMs[2];
+    uint32_t drawCommands[2];
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Scene::SharedPtr pScene = createGridScene(pModel, kGridSizes[i]);
+        sceneRendererMs[i] = measureRecording(SceneRenderer::create(pScene).get(), pState, pVars);
+
+        GpuDrivenSceneRenderer::SharedPtr pGpuDriven = GpuDrivenSceneRenderer::create(pScene);
+        gpuDrivenMs[i] = measureRecording(pGpuDriven.get(), pState, pVars);
+        drawCommands[i] = pGpuDriven->getStats().drawCommands;
+
+        uint32_t instances = kGridSizes[i] * kGridSizes[i];
+        if (pGpuDriven->getStats().instances != instances) return test_fail("GpuDrivenSceneRenderer sees " + std::to_string(pGpuDriven->getStats().instances) + " instances instead of " + std::to_string(instances));
+        logInfo("G-buffer CPU recording, " + std::to_string(instances) + " instances: SceneRenderer " + std::to_string(sceneRendererMs[i]) + " ms, GPU-driven " +
+            std::to_string(gpuDrivenMs[i]) + " ms (" + std::to_string(drawCommands[i]) + " indirect draws)");
+    }
+
+    if (drawCommands[0] == 0 || drawCommands[0] != drawCommands[1]) return test_fail("The number of indirect draws depends on the instance count");
+    if (gpuDrivenMs[1] >= sceneRendererMs[1]) return test_fail("GPU-driven recording isn't cheaper than SceneRenderer with " + std::to_string(kGridSizes[1] * kGridSizes[1]) + " instances");
+    return test_pass();
+}
+
+int main()
+{
+    GpuDrivenRecordingTest gdrt;
+    gdrt.init(true);
+    gdrt.run();
+    return 0;
+}
@@ -0,0 +1,189 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "HiZCullingTest.h"
+#include <random>
+
+namespace
+{
+    const glm::uvec2 kSize(160, 90);
+    const float kWallZ = -10.0f;
+    const float kWallHalfSize = 8.0f;
+
+    glm::mat4 createViewProj(const glm::vec3& eye)
+    {
+        glm::mat4 proj = glm::perspective(1.0f, float(kSize.x) / float(kSize.y), 0.1f, 100.0f);
+        return proj * glm::lookAt(eye, eye + glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+    }
+
+    // Ray cast the depth of a square wall facing the camera at z = kWallZ. Pixels missing it get the far plane.
+    std::vector<float> renderWall(const glm::mat4& viewProj)
+    {
+        glm::mat4 invViewProj = glm::inverse(viewProj);
+        std::vector<float> depth(kSize.x * kSize.y, 1.0f);
+        for (uint32_t y = 0; y < kSize.y; y++)
+        {
+            for (uint32_t x = 0; x < kSize.x; x++)
+            {
+                float ndcX = (x + 0.5f) / kSize.x * 2 - 1;
+                float ndcY = 1 - (y + 0.5f) / kSize.y * 2;
+                glm::vec4 nearPoint = invViewProj * glm::vec4(ndcX, ndcY, 0, 1);
+                glm::vec4 farPoint = invViewProj * glm::vec4(ndcX, ndcY, 1, 1);
+                glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+                glm::vec3 dir = glm::vec3(farPoint) / farPoint.w - origin;
+                if (std::abs(dir.z) < 1e-6f) continue;
+
+                float t = (kWallZ - origin.z) / dir.z;
+                glm::vec3 hit = origin + dir * t;
+                if (t < 0 || t > 1 || std::abs(hit.x) > kWallHalfSize || std::abs(hit.y) > kWallHalfSize) continue;
+
+                glm::vec4 clip = viewProj * glm::vec4(hit, 1);
+                depth[x + y * kSize.x] = clip.z / clip.w;
+            }
+        }
+        return depth;
+    }
+
+    // Check a culled box against every pixel of its screen rectangle. Empty string if all of them are in front of it.
+    std::string checkConservative(const std::vector<float>& depth, const Falcor::BoundingBox& box, const glm::mat4& viewProj)
+    {
+        glm::vec2 rectMin(1.0f), rectMax(0.0f);
+        float minDepth = 1.0f;
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            glm::vec3 corner = box.center + box.extent * glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+            glm::vec4 clip = viewProj * glm::vec4(corner, 1);
+            if (clip.w <= 0) return "a box crossing the near plane was culled";
+            glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            glm::vec2 uv(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f);
+            rectMin = glm::min(rectMin, uv);
+            rectMax = glm::max(rectMax, uv);
+            minDepth = std::min(minDepth, ndc.z);
+        }
+
+        glm::vec2 first = glm::max(rectMin, glm::vec2(0.0f)) * glm::vec2(kSize);
+        glm::vec2 last = glm::min(rectMax, glm::vec2(1.0f)) * glm::vec2(kSize);
+        for (uint32_t y = uint32_t(first.y); y <= std::min(kSize.y - 1, uint32_t(last.y)); y++)
+        {
+            for (uint32_t x = uint32_t(first.x); x <= std::min(kSize.x - 1, uint32_t(last.x)); x++)
+            {
+                if (depth[x + y * kSize.x] >= minDepth) return "pixel (" + std::to_string(x) + ", " + std::to_string(y) + ") sees past a culled box";
+            }
+        }
+        return "";
+    }
+}
+
+void HiZCullingTest::addTests()
+{
+    addTestToList<TestWallScene>();
+    addTestToList<TestRandomBoxes>();
+    addTestToList<TestReprojection>();
+}
+
+testing_func(HiZCullingTest, TestWallScene)
+{
+    glm::mat4 viewProj = createViewProj(glm::vec3(0));
+    std::vector<float> pyramid = HiZCulling::buildPyramid(renderWall(viewProj), kSize);
+    if (pyramid.size() != HiZCulling::pyramidSize(kSize)) return test_fail("Pyramid has the wrong size");
+
+    struct Case
+    {
+        const char* name;
+        Falcor::BoundingBox box;
+        bool occluded;
+    };
+    const Case cases[] =
+    {
+        { "Box behind the wall", { glm::vec3(0, 0, -20), glm::vec3(1) }, true },
+        { "Small box behind the wall", { glm::vec3(1, 1, -30), glm::vec3(0.01f) }, true },
+        { "Box in front of the wall", { glm::vec3(0, 0, -5), glm::vec3(1) }, false },
+        { "Box through the wall", { glm::vec3(0, 0, kWallZ), glm::vec3(1) }, false },
+        { "Box behind the wall, past its edge", { glm::vec3(19, 0, -20), glm::vec3(2) }, false },
+        { "Box crossing the near plane", { glm::vec3(0), glm::vec3(1) }, false },
+    };
+    for (const Case& c : cases)
+    {
+        if (HiZCulling::isOccluded(pyramid, kSize, c.box, viewProj) != c.occluded) return test_fail(std::string(c.name) + (c.occluded ? " wasn't culled" : " was culled"));
+    }
+    return test_pass();
+}
+
+testing_func(HiZCullingTest, TestRandomBoxes)
+{
+    glm::mat4 viewProj = createViewProj(glm::vec3(0));
+    std::vector<float> depth = renderWall(viewProj);
+    std::vector<float> pyramid = HiZCulling::buildPyramid(depth, kSize);
+
+    // Every culled box must be hidden in every pixel, checked against the full resolution depth
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    uint32_t culled = 0;
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        Falcor::BoundingBox box;
+        box.center = glm::vec3(unit(rng) * 30 - 15, unit(rng) * 20 - 10, -unit(rng) * 40 - 1);
+        box.extent = glm::vec3(unit(rng) * 2 + 0.05f);
+        if (HiZCulling::isOccluded(pyramid, kSize, box, viewProj) == false) continue;
+
+        culled++;
+        std::string error = checkConservative(depth, box, viewProj);
+        if (error.size()) return test_fail("Box " + std::to_string(i) + ": " + error);
+    }
+
+    logInfo("HiZCulling, wall scene: " + std::to_string(culled) + " of 20000 random boxes culled");
+    if (culled == 0) return test_fail("Nothing was culled behind the wall");
+    return test_pass();
+}
+
+testing_func(HiZCullingTest, TestReprojection)
+{
+    // Last frame's depth moved to a camera that stepped sideways and back
+    glm::mat4 prevViewProj = createViewProj(glm::vec3(0));
+    glm::mat4 viewProj = createViewProj(glm::vec3(0.5f, 0, 1));
+    std::vector<float> reprojected = HiZCulling::reprojectDepth(renderWall(prevViewProj), kSize, glm::inverse(prevViewProj), viewProj);
+    std::vector<float> truth = renderWall(viewProj);
+
+    // Disocclusions are left at the far plane. Everything else lands on the wall where the new camera sees it.
+    for (size_t i = 0; i < truth.size(); i++)
+    {
+        if (reprojected[i] < truth[i] - 1e-3f) return test_fail("Reprojected depth is in front of the wall at pixel " + std::to_string(i));
+    }
+
+    std::vector<float> pyramid = HiZCulling::buildPyramid(reprojected, kSize);
+    Falcor::BoundingBox box = { glm::vec3(0, 0, -20), glm::vec3(1) };
+    if (HiZCulling::isOccluded(pyramid, kSize, box, viewProj) == false) return test_fail("Box behind the wall wasn't culled after reprojection");
+    return test_pass();
+}
+
+int main()
+{
+    HiZCullingTest hzt;
+    hzt.init(false);
+    hzt.run();
+    return 0;
+}
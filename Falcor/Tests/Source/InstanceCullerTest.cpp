@@ -0,0 +1,234 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "InstanceCullerTest.h"
+#include "Utils/CpuTimer.h"
+#include <algorithm>
+#include <functional>
+#include <random>
+
+namespace
+{
+    // Boxes scattered over a square field, with a camera near the middle looking along it
+    std::vector<BoundingBox> createField(uint32_t boxCount, float fieldSize, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(-fieldSize * 0.5f, fieldSize * 0.5f);
+        std::uniform_real_distribution<float> height(0.0f, 20.0f);
+        std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+        std::vector<BoundingBox> boxes(boxCount);
+        for (BoundingBox& box : boxes)
+        {
+            box.center = glm::vec3(position(rng), height(rng), position(rng));
+            box.extent = glm::vec3(size(rng), size(rng), size(rng));
+        }
+        return boxes;
+    }
+
+    Camera::SharedPtr createCamera()
+    {
+        Camera::SharedPtr pCamera = Camera::create();
+        pCamera->setPosition(glm::vec3(10, 5, -20));
+        pCamera->setTarget(glm::vec3(40, 0, 100));
+        pCamera->setUpVector(glm::vec3(0, 1, 0));
+        pCamera->setAspectRatio(16.0f / 9.0f);
+        pCamera->setDepthRange(0.1f, 200.0f);
+        return pCamera;
+    }
+
+    InstanceCuller::SharedPtr createCuller(const std::vector<BoundingBox>& boxes, bool useBvh)
+    {
+        InstanceCuller::SharedPtr pCuller = InstanceCuller::create(useBvh);
+        pCuller->resize((uint32_t)boxes.size());
+        for (uint32_t i = 0; i < boxes.size(); i++) pCuller->setBox(i, boxes[i]);
+        return pCuller;
+    }
+
+    // Empty string if the culler's results match Camera::isObjectCulled()
+    std::string compareWithCamera(InstanceCuller* pCuller, const std::vector<BoundingBox>& boxes, const Camera* pCamera)
+    {
+        std::vector<uint32_t> visible = pCuller->cull(pCamera);
+        std::sort(visible.begin(), visible.end());
+        if (std::adjacent_find(visible.begin(), visible.end()) != visible.end()) return "A box was reported visible twice";
+
+        uint32_t expected = 0;
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            bool visibleRef = pCamera->isObjectCulled(boxes[i]) == false;
+            if (visibleRef != pCuller->isVisible(i) || visibleRef != std::binary_search(visible.begin(), visible.end(), i))
+            {
+                return "Box " + std::to_string(i) + (visibleRef ? " should be visible" : " should be culled");
+            }
+            expected += visibleRef ? 1 : 0;
+        }
+        if (expected == 0 || expected == boxes.size()) return "The test camera should see some of the boxes, but not all of them";
+        return "";
+    }
+}
+
+void InstanceCullerTest::addTests()
+{
+    addTestToList<TestMatchesCamera>();
+    addTestToList<TestMovedBoxes>();
+    addTestToList<TestLodReset>();
+    addTestToList<TestBenchmark>();
+}
+
+testing_func(InstanceCullerTest, TestMatchesCamera)
+{
+    std::vector<BoundingBox> boxes = createField(20000, 300.0f, 1);
+    Camera::SharedPtr pCamera = createCamera();
+
+    for (bool useBvh : { false, true })
+    {
+        InstanceCuller::SharedPtr pCuller = createCuller(boxes, useBvh);
+        std::string error = compareWithCamera(pCuller.get(), boxes, pCamera.get());
+        if (error.size()) return test_fail(std::string(useBvh ? "BVH: " : "Linear: ") + error);
+    }
+
+    // Counts that don't fill the last SIMD group or BVH leaf
+    for (uint32_t count : { 1u, 7u, 9u, 17u, 1001u })
+    {
+        std::vector<BoundingBox> few(boxes.begin(), boxes.begin() + count);
+        InstanceCuller::SharedPtr pCuller = createCuller(few, true);
+        pCuller->cull(pCamera.get());
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (pCuller->isVisible(i) == pCamera->isObjectCulled(few[i]))
+            {
+                return test_fail("Wrong result for box " + std::to_string(i) + " of " + std::to_string(count));
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(InstanceCullerTest, TestMovedBoxes)
+{
+    std::vector<BoundingBox> boxes = createField(20000, 300.0f, 2);
+    Camera::SharedPtr pCamera = createCamera();
+    InstanceCuller::SharedPtr pCuller = createCuller(boxes, true);
+    pCuller->cull(pCamera.get());
+
+    // Moving boxes refits the hierarchy instead of rebuilding it, which must stay conservative
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<uint32_t> pick(0, (uint32_t)boxes.size() - 1);
+    std::uniform_real_distribution<float> offset(-100.0f, 100.0f);
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        for (uint32_t i = 0; i < 2000; i++)
+        {
+            uint32_t index = pick(rng);
+            boxes[index].center += glm::vec3(offset(rng), 0, offset(rng));
+            pCuller->setBox(index, boxes[index]);
+        }
+        std::string error = compareWithCamera(pCuller.get(), boxes, pCamera.get());
+        if (error.size()) return test_fail("Frame " + std::to_string(frame) + ": " + error);
+    }
+    return test_pass();
+}
+
+testing_func(InstanceCullerTest, TestLodReset)
+{
+    std::vector<BoundingBox> boxes = createField(1000, 300.0f, 5);
+    InstanceCuller::SharedPtr pCuller = createCuller(boxes, true);
+    for (uint32_t i = 0; i < pCuller->getBoxCount(); i++) pCuller->setLod(i, 1 + i % 3);
+
+    // Moving a box keeps its LOD
+    pCuller->setBox(7, boxes[8]);
+    if (pCuller->getLod(7) != 1 + 7 % 3) return test_fail("Moving a box changed its LOD");
+
+    // Rebuilding the boxes, as for a new scene, starts every mesh instance at LOD 0
+    pCuller->resize(pCuller->getBoxCount());
+    for (uint32_t i = 0; i < pCuller->getBoxCount(); i++)
+    {
+        if (pCuller->getLod(i) != 0) return test_fail("Box " + std::to_string(i) + " kept its LOD after resize()");
+    }
+    return test_pass();
+}
+
+testing_func(InstanceCullerTest, TestBenchmark)
+{
+    const uint32_t kBoxCount = 100000;
+    const uint32_t kIterations = 20;
+    std::vector<BoundingBox> boxes = createField(kBoxCount, 1000.0f, 4);
+    Camera::SharedPtr pCamera = createCamera();
+    InstanceCuller::SharedPtr pLinear = createCuller(boxes, false);
+    InstanceCuller::SharedPtr pBvh = createCuller(boxes, true);
+    pLinear->cull(pCamera.get());
+    pBvh->cull(pCamera.get());
+
+    // Average time of one cull, in ms
+    auto measure = [&](const std::function<uint32_t()>& cull)
+    {
+        uint32_t visibleCount = 0;
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < kIterations; i++) visibleCount += cull();
+        float time = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / kIterations;
+        return std::make_pair(time, visibleCount / kIterations);
+    };
+
+    std::vector<uint8_t> scalarVisible(kBoxCount);
+    auto scalar = measure([&]()
+    {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < kBoxCount; i++)
+        {
+            scalarVisible[i] = pCamera->isObjectCulled(boxes[i]) ? 0 : 1;
+            count += scalarVisible[i];
+        }
+        return count;
+    });
+    auto linear = measure([&]() { return (uint32_t)pLinear->cull(pCamera.get()).size(); });
+    auto bvh = measure([&]() { return (uint32_t)pBvh->cull(pCamera.get()).size(); });
+
+    logInfo("InstanceCuller, " + std::to_string(kBoxCount) + " boxes, " + std::to_string(scalar.second) + " visible: Camera::isObjectCulled() " + std::to_string(scalar.first) +
+        " ms, SIMD " + std::to_string(linear.first) + " ms, SIMD with BVH " + std::to_string(bvh.first) + " ms");
+
+    if (linear.second != scalar.second || bvh.second != scalar.second)
+    {
+        return test_fail("Visible counts differ: " + std::to_string(scalar.second) + " scalar, " + std::to_string(linear.second) + " SIMD, " + std::to_string(bvh.second) + " BVH");
+    }
+    if (linear.first >= scalar.first)
+    {
+        return test_fail("Testing every box with SIMD is slower than the scalar test");
+    }
+    if (bvh.first >= linear.first)
+    {
+        return test_fail("The BVH is slower than testing every box, with most of the boxes outside the frustum");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    InstanceCullerTest ict;
+    ict.init(false);
+    ict.run();
+    return 0;
+}
@@ -0,0 +1,277 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "LowDiscrepancyTest.h"
+#include "Utils/PatternGenerators/HaltonSamplePattern.h"
+#include "Utils/PatternGenerators/R2SamplePattern.h"
+#include "Utils/PatternGenerators/SobolSamplePattern.h"
+#include <random>
+#include <set>
+
+using Falcor::LowDiscrepancy;
+
+namespace
+{
+    using Sequence = LowDiscrepancy::Sequence;
+
+    std::vector<glm::vec2> generate(Sequence sequence, uint32_t dimension, uint32_t count, uint32_t seed, uint32_t firstIndex = 0)
+    {
+        std::vector<glm::vec2> points(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            points[i].x = LowDiscrepancy::sample(sequence, dimension, firstIndex + i, seed);
+            points[i].y = LowDiscrepancy::sample(sequence, dimension + 1, firstIndex + i, seed);
+        }
+        return points;
+    }
+
+    // Every elementary interval of area 1 / N (2^a by 2^b cells, a + b = log2(N)) holds exactly one point
+    bool isNet(const std::vector<glm::vec2>& points)
+    {
+        uint32_t m = 0;
+        while ((1u << m) < points.size()) m++;
+        for (uint32_t a = 0; a <= m; a++)
+        {
+            std::vector<uint32_t> counts(points.size(), 0);
+            for (const auto& p : points)
+            {
+                uint32_t cx = uint32_t(p.x * float(1u << a));
+                uint32_t cy = uint32_t(p.y * float(1u << (m - a)));
+                if (counts[(cx << (m - a)) | cy]++) return false;
+            }
+        }
+        return true;
+    }
+
+    // L2 star discrepancy, with Warnock's formula
+    double l2StarDiscrepancy(const std::vector<glm::vec2>& points)
+    {
+        double n = double(points.size());
+        double sum1 = 0, sum2 = 0;
+        for (const auto& p : points)
+        {
+            sum1 += (1.0 - double(p.x) * p.x) * (1.0 - double(p.y) * p.y);
+            for (const auto& q : points) sum2 += (1.0 - std::max(p.x, q.x)) * (1.0 - std::max(p.y, q.y));
+        }
+        return std::sqrt(1.0 / 9.0 - sum1 / (2.0 * n) + sum2 / (n * n));
+    }
+}
+
+void LowDiscrepancyTest::addTests()
+{
+    addTestToList<TestSobolDirections>();
+    addTestToList<TestSobolNets>();
+    addTestToList<TestDiscrepancy>();
+    addTestToList<TestSampleState>();
+    addTestToList<TestSamplePatterns>();
+}
+
+testing_func(LowDiscrepancyTest, TestSobolDirections)
+{
+    // The first points of Joe and Kuo's sequence, in eighths
+    const uint32_t kExpected[8][8] =
+    {
+        { 0, 4, 2, 6, 1, 5, 3, 7 },
+        { 0, 4, 6, 2, 5, 1, 3, 7 },
+        { 0, 4, 6, 2, 3, 7, 5, 1 },
+        { 0, 4, 6, 2, 1, 5, 7, 3 },
+        { 0, 4, 2, 6, 1, 5, 3, 7 },
+        { 0, 4, 2, 6, 3, 7, 1, 5 },
+        { 0, 4, 6, 2, 5, 1, 3, 7 },
+        { 0, 4, 2, 6, 5, 1, 7, 3 },
+    };
+    for (uint32_t dim = 0; dim < 8; dim++)
+    {
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            if (LowDiscrepancy::sobol(dim, i) != float(kExpected[dim][i]) / 8.0f) return test_fail("Wrong Sobol point " + std::to_string(i) + " in dimension " + std::to_string(dim));
+        }
+    }
+
+    // Direction number k is an odd integer below 2^(k + 1), shifted up to the top bits, and is the point of index 2^k
+    const auto& directions = LowDiscrepancy::getSobolDirections();
+    if (directions.size() != LowDiscrepancy::kSobolDimensions * 32) return test_fail("Wrong number of direction numbers");
+    for (uint32_t dim = 0; dim < LowDiscrepancy::kSobolDimensions; dim++)
+    {
+        for (uint32_t bit = 0; bit < 32; bit++)
+        {
+            uint32_t v = directions[dim * 32 + bit];
+            if ((v & ((2u << (31 - bit)) - 1)) != (1u << (31 - bit))) return test_fail("Direction number " + std::to_string(bit) + " of dimension " + std::to_string(dim) + " has the wrong lowest bit");
+            if (LowDiscrepancy::sobolBits(dim, 1u << bit) != v) return test_fail("Point 2^" + std::to_string(bit) + " isn't its direction number");
+        }
+    }
+    return test_pass();
+}
+
+testing_func(LowDiscrepancyTest, TestSobolNets)
+{
+    // The first two dimensions are a (0, 2)-sequence: aligned power-of-two blocks are (0, m, 2)-nets, scrambled or not
+    for (uint32_t m = 1; m <= 10; m++)
+    {
+        uint32_t count = 1u << m;
+        for (uint32_t block = 0; block < 3; block++)
+        {
+            std::vector<glm::vec2> points(count);
+            for (uint32_t i = 0; i < count; i++) points[i] = glm::vec2(LowDiscrepancy::sobol(0, block * count + i), LowDiscrepancy::sobol(1, block * count + i));
+            if (!isNet(points)) return test_fail("Block " + std::to_string(block) + " of " + std::to_string(count) + " points isn't a net");
+
+            for (uint32_t seed : { 1u, 77u, 0xdeadbeefu })
+            {
+                if (!isNet(generate(Sequence::Sobol, 0, count, seed, block * count))) return test_fail("Scrambled block of " + std::to_string(count) + " points isn't a net");
+            }
+        }
+    }
+
+    // Every dimension, including the padded ones, is stratified on its own
+    for (uint32_t dim = 0; dim < LowDiscrepancy::kSobolDimensions + 8; dim++)
+    {
+        const uint32_t count = 256;
+        std::vector<uint32_t> strata(count, 0);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (strata[uint32_t(LowDiscrepancy::sample(Sequence::Sobol, dim, count + i, 5) * count)]++) return test_fail("Dimension " + std::to_string(dim) + " isn't stratified");
+        }
+    }
+    return test_pass();
+}
+
+testing_func(LowDiscrepancyTest, TestDiscrepancy)
+{
+    // Average discrepancy of uniform random points
+    const uint32_t count = 256;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> uniform;
+    double randomDiscrepancy = 0;
+    for (uint32_t trial = 0; trial < 8; trial++)
+    {
+        std::vector<glm::vec2> points(count);
+        for (auto& p : points) p = glm::vec2(uniform(rng), uniform(rng));
+        randomDiscrepancy += l2StarDiscrepancy(points) / 8.0;
+    }
+
+    // Pairs of dimensions, including some past the tables. Halton's bases are correlated from 17 and 19 on at this sample count.
+    const std::vector<uint32_t> kDimensions[] = { { 0, 2, 4 }, { 0, 2, 6, 14, 30, 40 }, { 0, 2, 6, 14, 30, 40 } };
+    const char* kNames[] = { "Halton", "Sobol", "R2" };
+    for (uint32_t s = 0; s < 3; s++)
+    {
+        for (uint32_t dim : kDimensions[s])
+        {
+            for (uint32_t seed : { 3u, 1000u })
+            {
+                double discrepancy = l2StarDiscrepancy(generate(Sequence(s), dim, count, seed));
+                if (discrepancy > 0.75 * randomDiscrepancy)
+                {
+                    return test_fail(std::string(kNames[s]) + " dimensions " + std::to_string(dim) + " and " + std::to_string(dim + 1) + " have a discrepancy of " + std::to_string(discrepancy) + ", random points " + std::to_string(randomDiscrepancy));
+                }
+            }
+        }
+    }
+
+    // Sobol samples between pixels are uncorrelated: pairing a pixel's dimension with another pixel's is about as good as random
+    std::vector<glm::vec2> crossed(count);
+    for (uint32_t i = 0; i < count; i++) crossed[i] = glm::vec2(LowDiscrepancy::sample(Sequence::Sobol, 0, i, 1), LowDiscrepancy::sample(Sequence::Sobol, 0, i, 2));
+    if (l2StarDiscrepancy(crossed) < 0.25 * randomDiscrepancy) return test_fail("Samples of different pixels are correlated");
+    return test_pass();
+}
+
+testing_func(LowDiscrepancyTest, TestSampleState)
+{
+    for (uint32_t s = 0; s < 3; s++)
+    {
+        // Large indices still give samples in [0, 1)
+        for (uint32_t index : { 0u, 1u, 12345u, 0x7fffffffu, 0xffffffffu })
+        {
+            LowDiscrepancy::SampleState state = LowDiscrepancy::initSampleState(Sequence(s), index, 42);
+            for (uint32_t dim = 0; dim < 80; dim++)
+            {
+                float value = LowDiscrepancy::next1D(state);
+                if (!(value >= 0.0f && value < 1.0f)) return test_fail("Sample outside [0, 1) at index " + std::to_string(index));
+                if (value != LowDiscrepancy::sample(Sequence(s), dim, index, 42)) return test_fail("next1D() doesn't match sample()");
+            }
+        }
+
+        // next2D() draws two dimensions, and R2 keeps them in the same pair
+        LowDiscrepancy::SampleState state = LowDiscrepancy::initSampleState(Sequence(s), 7, 42);
+        LowDiscrepancy::next1D(state);
+        glm::vec2 value = LowDiscrepancy::next2D(state);
+        uint32_t first = (Sequence(s) == Sequence::R2) ? 2 : 1;
+        if (state.dimension != first + 2) return test_fail("next2D() drew the wrong dimensions");
+        if (value.x != LowDiscrepancy::sample(Sequence(s), first, 7, 42) || value.y != LowDiscrepancy::sample(Sequence(s), first + 1, 7, 42)) return test_fail("next2D() doesn't match sample()");
+    }
+
+    // Halton radical inverses are exact for small indices
+    if (LowDiscrepancy::halton(0, 6) != 0.375f || LowDiscrepancy::halton(1, 5) != 7.0f / 9.0f || LowDiscrepancy::halton(2, 3) != 0.6f) return test_fail("Wrong radical inverse");
+    return test_pass();
+}
+
+testing_func(LowDiscrepancyTest, TestSamplePatterns)
+{
+    // 8 samples are the table HaltonSamplePattern used to be limited to
+    const glm::vec2 kHalton8[8] =
+    {
+        { 1.0f / 2.0f, 1.0f / 3.0f }, { 1.0f / 4.0f, 2.0f / 3.0f }, { 3.0f / 4.0f, 1.0f / 9.0f }, { 1.0f / 8.0f, 4.0f / 9.0f },
+        { 5.0f / 8.0f, 7.0f / 9.0f }, { 3.0f / 8.0f, 2.0f / 9.0f }, { 7.0f / 8.0f, 5.0f / 9.0f }, { 0.5f / 8.0f, 8.0f / 9.0f }
+    };
+    auto pHalton = Falcor::HaltonSamplePattern::create(8);
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        glm::vec2 expected = kHalton8[i % 8] - 0.5f;
+        glm::vec2 value = pHalton->next();
+        if (std::abs(value.x - expected.x) > 1e-6f || std::abs(value.y - expected.y) > 1e-6f) return test_fail("Halton sample " + std::to_string(i) + " differs from the 8 sample table");
+    }
+
+    std::vector<Falcor::PatternGenerator::SharedPtr> patterns = { Falcor::HaltonSamplePattern::create(37), Falcor::SobolSamplePattern::create(64, 9), Falcor::R2SamplePattern::create(23) };
+    for (const auto& pPattern : patterns)
+    {
+        std::vector<glm::vec2> samples;
+        std::set<std::pair<float, float>> distinct;
+        for (uint32_t i = 0; i < pPattern->getSampleCount(); i++)
+        {
+            glm::vec2 value = pPattern->next();
+            if (value.x < -0.5f || value.x >= 0.5f || value.y < -0.5f || value.y >= 0.5f) return test_fail("Sample outside the pixel");
+            samples.push_back(value);
+            distinct.insert({ value.x, value.y });
+        }
+        if (distinct.size() != samples.size()) return test_fail("Repeated samples within a period");
+        if (!(pPattern->next() == samples[0])) return test_fail("The pattern doesn't repeat after its sample count");
+    }
+
+    // A power-of-two period of Sobol samples is a net
+    auto pSobol = Falcor::SobolSamplePattern::create(16, 3);
+    std::vector<glm::vec2> points(16);
+    for (auto& p : points) p = pSobol->next() + glm::vec2(0.5f);
+    if (!isNet(points)) return test_fail("16 Sobol samples aren't a net");
+    return test_pass();
+}
+
+int main()
+{
+    LowDiscrepancyTest ldt;
+    ldt.init(false);
+    ldt.run();
+    return 0;
+}
@@ -0,0 +1,295 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "MeshOptimizerTest.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    struct TestMesh
+    {
+        std::vector<float> positions;   ///< xyz per vertex
+        std::vector<uint32_t> indices;
+        uint32_t vertexCount = 0;
+    };
+
+    // A UV sphere, with its triangles shuffled like an exporter that doesn't care about order
+    TestMesh createShuffledSphere(uint32_t rings, uint32_t segments, uint32_t seed)
+    {
+        TestMesh mesh;
+        for (uint32_t j = 0; j <= rings; j++)
+        {
+            for (uint32_t i = 0; i <= segments; i++)
+            {
+                float theta = 3.14159265f * float(j) / float(rings), phi = 6.28318531f * float(i) / float(segments);
+                mesh.positions.insert(mesh.positions.end(), { sinf(theta) * cosf(phi), sinf(theta) * sinf(phi), cosf(theta) });
+            }
+        }
+        mesh.vertexCount = uint32_t(mesh.positions.size() / 3);
+
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (uint32_t j = 0; j < rings; j++)
+        {
+            for (uint32_t i = 0; i < segments; i++)
+            {
+                uint32_t a = j * (segments + 1) + i, b = a + 1, c = a + segments + 1, d = c + 1;
+                triangles.push_back({ a, c, b });
+                triangles.push_back({ b, c, d });
+            }
+        }
+        std::mt19937 rng(seed);
+        std::shuffle(triangles.begin(), triangles.end(), rng);
+        for (const auto& t : triangles) mesh.indices.insert(mesh.indices.end(), t.begin(), t.end());
+        return mesh;
+    }
+
+    // Triangles as a sorted list, each rotated to start at its smallest index (which keeps the winding), to compare meshes
+    std::vector<std::array<uint32_t, 3>> getTriangleSet(const std::vector<uint32_t>& indices)
+    {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            std::array<uint32_t, 3> t = { indices[i], indices[i + 1], indices[i + 2] };
+            std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+            triangles.push_back(t);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    void normalize(float v[3])
+    {
+        float l = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        for (uint32_t i = 0; i < 3; i++) v[i] /= l;
+    }
+
+    float angleDegrees(const float a[3], const float b[3])
+    {
+        float d = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / sqrtf((a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) * (b[0] * b[0] + b[1] * b[1] + b[2] * b[2]));
+        return acosf(std::min(std::max(d, -1.0f), 1.0f)) * 57.2957795f;
+    }
+}
+
+void MeshOptimizerTest::addTests()
+{
+    addTestToList<TestVertexCache>();
+    addTestToList<TestOverdraw>();
+    addTestToList<TestVertexFetch>();
+    addTestToList<TestOctahedral>();
+    addTestToList<TestCompactBitangent>();
+}
+
+testing_func(MeshOptimizerTest, TestVertexCache)
+{
+    // ACMR bounds: a single triangle misses 3 times, and a random order of a big mesh misses for nearly every vertex
+    uint32_t triangle[] = { 0, 1, 2 };
+    if (MeshOptimizer::computeAcmr(triangle, 3, 3) != 3.0f) return test_fail("One triangle should have an ACMR of 3");
+
+    TestMesh mesh = createShuffledSphere(100, 200, 1);
+    const auto triangles = getTriangleSet(mesh.indices);
+    float shuffledAcmr = MeshOptimizer::computeAcmr(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    std::vector<uint32_t> clusters = MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    float optimizedAcmr = MeshOptimizer::computeAcmr(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    logInfo("MeshOptimizer, " + std::to_string(mesh.indices.size() / 3) + " triangles: ACMR " + std::to_string(shuffledAcmr) + " shuffled, " + std::to_string(optimizedAcmr) +
+        " after Tipsify, " + std::to_string(clusters.size()) + " clusters");
+
+    // A regular grid can get close to 0.5; Tipsify with a 16-entry cache reaches about 0.6-0.7
+    if (shuffledAcmr < 2.5f) return test_fail("The shuffled mesh should thrash the cache");
+    if (optimizedAcmr > 0.75f) return test_fail("ACMR after optimization is " + std::to_string(optimizedAcmr));
+    if (getTriangleSet(mesh.indices) != triangles) return test_fail("Reordering changed the triangles or their winding");
+    if (clusters.empty() || clusters[0] != 0) return test_fail("The first cluster must start at triangle 0");
+    for (size_t i = 1; i < clusters.size(); i++)
+    {
+        if (clusters[i] <= clusters[i - 1] || clusters[i] >= mesh.indices.size() / 3) return test_fail("Cluster starts are not increasing triangle indices");
+    }
+    return test_pass();
+}
+
+testing_func(MeshOptimizerTest, TestOverdraw)
+{
+    TestMesh mesh = createShuffledSphere(100, 200, 2);
+    const auto triangles = getTriangleSet(mesh.indices);
+    std::vector<uint32_t> clusters = MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    float cacheAcmr = MeshOptimizer::computeAcmr(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+
+    // Cluster sorting may only give back a little of the cache efficiency (the threshold bounds each split)
+    const float kThreshold = 1.05f;
+    MeshOptimizer::optimizeOverdraw(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), sizeof(float) * 3, mesh.vertexCount, clusters, kThreshold);
+    float overdrawAcmr = MeshOptimizer::computeAcmr(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    if (overdrawAcmr > cacheAcmr * kThreshold + 0.01f) return test_fail("Overdraw sorting raised ACMR from " + std::to_string(cacheAcmr) + " to " + std::to_string(overdrawAcmr));
+    if (getTriangleSet(mesh.indices) != triangles) return test_fail("Overdraw sorting changed the triangles or their winding");
+    return test_pass();
+}
+
+testing_func(MeshOptimizerTest, TestVertexFetch)
+{
+    // Vertices are renumbered in first-use order, and unused vertices go last
+    uint32_t indices[] = { 4, 2, 0 };
+    std::vector<uint32_t> remap = MeshOptimizer::optimizeVertexFetch(indices, 3, 6);
+    if (remap.size() != 6 || remap[0] != 4 || remap[1] != 2 || remap[2] != 0) return test_fail("Vertices are not in first-use order");
+    if (indices[0] != 0 || indices[1] != 1 || indices[2] != 2) return test_fail("Indices were not updated");
+    std::vector<uint32_t> sorted = remap;
+    std::sort(sorted.begin(), sorted.end());
+    for (uint32_t i = 0; i < 6; i++) if (sorted[i] != i) return test_fail("The remap is not a permutation");
+
+    // Remapped vertex data follows the renumbered indices
+    TestMesh mesh = createShuffledSphere(20, 40, 3);
+    std::vector<uint32_t> oldIndices = mesh.indices;
+    remap = MeshOptimizer::optimizeVertexFetch(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount);
+    std::vector<float> positions = mesh.positions;
+    MeshOptimizer::remapVertices(positions.data(), sizeof(float) * 3, remap);
+    for (size_t i = 0; i < mesh.indices.size(); i++)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            if (positions[mesh.indices[i] * 3 + c] != mesh.positions[oldIndices[i] * 3 + c]) return test_fail("Index " + std::to_string(i) + " points at a different position after remapping");
+        }
+    }
+    return test_pass();
+}
+
+testing_func(MeshOptimizerTest, TestOctahedral)
+{
+    // Two snorm16 values hold a direction to within a few hundredths of a degree, over the whole sphere
+    std::mt19937 rng(4);
+    std::normal_distribution<float> gaussian;
+    float maxError = 0.0f;
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        float v[3] = { gaussian(rng), gaussian(rng), gaussian(rng) };
+        normalize(v);
+        int16_t encoded[2];
+        MeshOptimizer::encodeOctahedral(v, encoded);
+        float decoded[3];
+        MeshOptimizer::decodeOctahedral(encoded, decoded);
+        maxError = std::max(maxError, angleDegrees(v, decoded));
+    }
+    logInfo("MeshOptimizer, octahedral encoding: max error " + std::to_string(maxError) + " degrees");
+    if (maxError > 0.05f) return test_fail("Octahedral encoding error of " + std::to_string(maxError) + " degrees");
+
+    // The axes (including the folded lower hemisphere) are exact
+    const float kAxes[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    for (const auto& axis : kAxes)
+    {
+        int16_t encoded[2];
+        MeshOptimizer::encodeOctahedral(axis, encoded);
+        float decoded[3];
+        MeshOptimizer::decodeOctahedral(encoded, decoded);
+        if (angleDegrees(axis, decoded) > 1e-3f) return test_fail("An axis didn't survive encoding");
+    }
+
+    // Positions quantize over the bounds, with w = 1
+    float p[3] = { 1, 2, 3 }, boxMin[3] = { 0, 2, -1 }, boxSize[3] = { 2, 1, 8 };
+    uint16_t q[4];
+    MeshOptimizer::quantizePosition(p, boxMin, boxSize, q);
+    if (q[0] != 32768 || q[1] != 0 || q[2] != 32768 || q[3] != 65535) return test_fail("Wrong quantized position");
+    return test_pass();
+}
+
+testing_func(MeshOptimizerTest, TestCompactBitangent)
+{
+    // The world matrix of a compact mesh is world * translate(boxMin) * scale(boxSize), so DefaultVS can't transform bitangents with it.
+    //     It rebuilds the plain world matrix from the inverse transpose (which SceneRenderer computes before folding in the
+    //     dequantization) as the cofactor matrix over the determinant. Do the same here and compare with the uncompressed path.
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> logSize(-2.0f, 2.0f);
+    float maxError = 0.0f, maxSkew = 0.0f;
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        // Rows of a random, possibly mirrored, world matrix; bitangents are transformed as row vectors, like mul(b, M) in HLSL
+        float world[3][3], boxSize[3], b[3];
+        float mirror = (i % 2) ? -1.0f : 1.0f;
+        for (uint32_t r = 0; r < 3; r++)
+        {
+            for (uint32_t c = 0; c < 3; c++) world[r][c] = unit(rng) + (r == c ? 2.0f * (r == 0 ? mirror : 1.0f) : 0.0f);
+            boxSize[r] = powf(10.0f, logSize(rng));
+            b[r] = unit(rng);
+        }
+        normalize(b);
+
+        auto mul = [](const float v[3], const float m[3][3], float out[3])
+        {
+            for (uint32_t c = 0; c < 3; c++) out[c] = v[0] * m[0][c] + v[1] * m[1][c] + v[2] * m[2][c];
+        };
+        auto cross = [](const float a[3], const float b[3], float out[3])
+        {
+            out[0] = a[1] * b[2] - a[2] * b[1];
+            out[1] = a[2] * b[0] - a[0] * b[2];
+            out[2] = a[0] * b[1] - a[1] * b[0];
+        };
+
+        // Inverse transpose of the world matrix: the cofactor matrix over the determinant
+        float invTranspose[3][3];
+        cross(world[1], world[2], invTranspose[0]);
+        cross(world[2], world[0], invTranspose[1]);
+        cross(world[0], world[1], invTranspose[2]);
+        float det = world[0][0] * invTranspose[0][0] + world[0][1] * invTranspose[0][1] + world[0][2] * invTranspose[0][2];
+        for (auto& row : invTranspose) for (float& x : row) x /= det;
+
+        float expected[3];
+        mul(b, world, expected);
+
+        // What DefaultVS does with a compact bitangent
+        int16_t encoded[2];
+        float decoded[3], bitangentMat[3][3], result[3];
+        MeshOptimizer::encodeOctahedral(b, encoded);
+        MeshOptimizer::decodeOctahedral(encoded, decoded);
+        cross(invTranspose[1], invTranspose[2], bitangentMat[0]);
+        cross(invTranspose[2], invTranspose[0], bitangentMat[1]);
+        cross(invTranspose[0], invTranspose[1], bitangentMat[2]);
+        float invDet = invTranspose[0][0] * bitangentMat[0][0] + invTranspose[0][1] * bitangentMat[0][1] + invTranspose[0][2] * bitangentMat[0][2];
+        mul(decoded, bitangentMat, result);
+        for (float& x : result) x /= invDet;
+        maxError = std::max(maxError, angleDegrees(expected, result));
+        float length = sqrtf(result[0] * result[0] + result[1] * result[1] + result[2] * result[2]);
+        float expectedLength = sqrtf(expected[0] * expected[0] + expected[1] * expected[1] + expected[2] * expected[2]);
+        if (std::abs(length / expectedLength - 1.0f) > 1e-3f) return test_fail("The rebuilt world matrix doesn't preserve the bitangent's length");
+
+        // What the world matrix with the dequantization folded in would do
+        float dequantWorld[3][3];
+        for (uint32_t r = 0; r < 3; r++) for (uint32_t c = 0; c < 3; c++) dequantWorld[r][c] = boxSize[r] * world[r][c];
+        mul(decoded, dequantWorld, result);
+        maxSkew = std::max(maxSkew, angleDegrees(expected, result));
+    }
+    logInfo("MeshOptimizer, compact bitangents: max error " + std::to_string(maxError) + " degrees (" + std::to_string(maxSkew) + " with the dequantized world matrix)");
+
+    if (maxError > 0.2f) return test_fail("Compact bitangents are off by up to " + std::to_string(maxError) + " degrees");
+    if (maxSkew < 10.0f) return test_fail("The test bounds are not skewed enough to catch the dequantization");
+    return test_pass();
+}
+
+int main()
+{
+    MeshOptimizerTest mot;
+    mot.init(false);
+    mot.run();
+    return 0;
+}
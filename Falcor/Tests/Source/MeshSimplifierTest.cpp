@@ -0,0 +1,236 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "MeshSimplifierTest.h"
+#include <map>
+
+namespace
+{
+    struct TestMesh
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    // Unit sphere made by subdividing an icosahedron, with no seams or borders
+    TestMesh createSphere(uint32_t subdivisions)
+    {
+        const float t = (1.0f + sqrtf(5.0f)) * 0.5f;
+        TestMesh mesh;
+        mesh.positions = { {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1} };
+        mesh.indices = { 0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1 };
+        for (auto& p : mesh.positions) p = glm::normalize(p);
+
+        for (uint32_t s = 0; s < subdivisions; s++)
+        {
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> midpoints;
+            auto midpoint = [&](uint32_t a, uint32_t b)
+            {
+                auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                auto it = midpoints.find(key);
+                if (it != midpoints.end()) return it->second;
+                mesh.positions.push_back(glm::normalize(mesh.positions[a] + mesh.positions[b]));
+                return midpoints[key] = (uint32_t)mesh.positions.size() - 1;
+            };
+
+            std::vector<uint32_t> indices;
+            for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            {
+                uint32_t a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+                uint32_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+                indices.insert(indices.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+            }
+            mesh.indices = indices;
+        }
+        return mesh;
+    }
+
+    // Unit square in the XY plane, displaced along Z by 'bumpHeight'
+    TestMesh createGrid(uint32_t size, float bumpHeight)
+    {
+        TestMesh mesh;
+        for (uint32_t y = 0; y <= size; y++)
+        {
+            for (uint32_t x = 0; x <= size; x++)
+            {
+                float fx = float(x) / size;
+                float fy = float(y) / size;
+                mesh.positions.push_back({ fx, fy, bumpHeight * sinf(fx * 9) * cosf(fy * 7) });
+            }
+        }
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                uint32_t a = y * (size + 1) + x;
+                mesh.indices.insert(mesh.indices.end(), { a, a + 1, a + size + 2, a, a + size + 2, a + size + 1 });
+            }
+        }
+        return mesh;
+    }
+
+    std::vector<uint32_t> simplify(const TestMesh& mesh, size_t targetIndexCount, float targetError, float& error)
+    {
+        return MeshSimplifier::simplify(mesh.indices.data(), mesh.indices.size(), &mesh.positions[0].x, sizeof(glm::vec3), (uint32_t)mesh.positions.size(), targetIndexCount, targetError, MeshSimplifier::Attributes(), &error);
+    }
+
+    glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        // Real-Time Collision Detection, 5.1.5
+        glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+        float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+        if (d1 <= 0 && d2 <= 0) return a;
+        glm::vec3 bp = p - b;
+        float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+        if (d3 >= 0 && d4 <= d3) return b;
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0 && d1 >= 0 && d3 <= 0) return a + ab * (d1 / (d1 - d3));
+        glm::vec3 cp = p - c;
+        float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+        if (d6 >= 0 && d5 <= d6) return c;
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0 && d2 >= 0 && d6 <= 0) return a + ac * (d2 / (d2 - d6));
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        float denom = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+
+    // Largest distance from a vertex of the original mesh to the simplified surface
+    float measureError(const TestMesh& mesh, const std::vector<uint32_t>& simplified)
+    {
+        float maxDistance = 0;
+        for (const glm::vec3& p : mesh.positions)
+        {
+            float distance = FLT_MAX;
+            for (size_t i = 0; i < simplified.size(); i += 3)
+            {
+                glm::vec3 q = closestPointOnTriangle(p, mesh.positions[simplified[i]], mesh.positions[simplified[i + 1]], mesh.positions[simplified[i + 2]]);
+                distance = std::min(distance, glm::length(p - q));
+            }
+            maxDistance = std::max(maxDistance, distance);
+        }
+        return maxDistance;
+    }
+}
+
+void MeshSimplifierTest::addTests()
+{
+    addTestToList<TestTriangleReduction>();
+    addTestToList<TestErrorBound>();
+    addTestToList<TestFlatPlane>();
+}
+
+testing_func(MeshSimplifierTest, TestTriangleReduction)
+{
+    TestMesh sphere = createSphere(4);
+    for (size_t divisor : { 2, 4, 8, 16 })
+    {
+        size_t target = (sphere.indices.size() / divisor / 3) * 3;
+        float error = 0;
+        std::vector<uint32_t> result = simplify(sphere, target, FLT_MAX, error);
+        if (result.size() > target || result.size() < target * 9 / 10)
+        {
+            return test_fail("Simplifying a sphere to 1/" + std::to_string(divisor) + " of its triangles gave " + std::to_string(result.size() / 3) + " triangles instead of " + std::to_string(target / 3));
+        }
+    }
+    return test_pass();
+}
+
+testing_func(MeshSimplifierTest, TestErrorBound)
+{
+    // The reported error is the largest vertex to surface distance, which the brute force search below should reproduce up to rounding
+    const float kTolerance = 1e-5f;
+
+    TestMesh sphere = createSphere(4);
+    TestMesh grid = createGrid(48, 0.02f);
+    for (const TestMesh* pMesh : { &sphere, &grid })
+    {
+        for (float targetError : { 0.001f, 0.01f, 0.05f })
+        {
+            float error = 0;
+            std::vector<uint32_t> result = simplify(*pMesh, 0, targetError, error);
+            if (error > targetError)
+            {
+                return test_fail("Simplification error " + std::to_string(error) + " is above the target " + std::to_string(targetError));
+            }
+            if (result.size() >= pMesh->indices.size() && targetError >= 0.01f)
+            {
+                return test_fail("No triangles were removed with an error target of " + std::to_string(targetError));
+            }
+
+            float measured = measureError(*pMesh, result);
+            if (measured > error * 1.001f + kTolerance)
+            {
+                return test_fail("Measured error " + std::to_string(measured) + " is above the reported error " + std::to_string(error));
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(MeshSimplifierTest, TestFlatPlane)
+{
+    TestMesh grid = createGrid(20, 0);
+    float error = 0;
+    std::vector<uint32_t> result = simplify(grid, 0, 1e-6f, error);
+
+    if (error > 1e-6f || result.size() * 10 > grid.indices.size())
+    {
+        return test_fail("A flat grid should simplify to a few triangles with no error, got " + std::to_string(result.size() / 3) + " triangles and error " + std::to_string(error));
+    }
+
+    // The border only slides along itself, so the corners stay
+    const uint32_t corners[] = { 0, 20, 21 * 20, 21 * 21 - 1 };
+    for (uint32_t corner : corners)
+    {
+        if (std::find(result.begin(), result.end(), corner) == result.end())
+        {
+            return test_fail("Corner vertex " + std::to_string(corner) + " was collapsed");
+        }
+    }
+
+    // No triangle may flip
+    for (size_t i = 0; i < result.size(); i += 3)
+    {
+        glm::vec3 n = glm::cross(grid.positions[result[i + 1]] - grid.positions[result[i]], grid.positions[result[i + 2]] - grid.positions[result[i]]);
+        if (n.z <= 0)
+        {
+            return test_fail("Triangle " + std::to_string(i / 3) + " flipped");
+        }
+    }
+    return test_pass();
+}
+
+int main()
+{
+    MeshSimplifierTest mst;
+    mst.init(false);
+    mst.run();
+    return 0;
+}
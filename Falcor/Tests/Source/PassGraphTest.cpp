@@ -0,0 +1,191 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "PassGraphTest.h"
+#include <algorithm>
+
+namespace
+{
+    using State = Resource::State;
+
+    // A cut-down hybrid pipeline: a G-buffer, lighting, SVGF-filtered reflections with temporal history, and a debug view nobody displays
+    std::vector<PassGraph::PassDesc> createPipeline()
+    {
+        return {
+            { "GBuffer",    {},                                             { "WorldPosition", "WorldNormal", "LinearZ", "Z-Buffer" }, { State::RenderTarget, State::RenderTarget, State::RenderTarget, State::DepthStencil } },
+            { "Lighting",   { "WorldPosition", "WorldNormal" },             { "Direct" } },
+            { "Reflection", { "WorldPosition", "WorldNormal" },             { "ReflectionOut" }, { State::UnorderedAccess } },
+            { "SVGF",       { "ReflectionOut", "LinearZ", "PrevLinearZ" },  { "ReflectionFiltered", "PrevLinearZ" } },
+            { "DebugView",  { "WorldNormal" },                              { "Debug" } },
+            { "Final",      { "Direct", "ReflectionFiltered" },             { "PipelineOutput" } },
+        };
+    }
+
+    uint32_t findPass(const std::vector<PassGraph::PassDesc>& passes, const std::string& name)
+    {
+        for (uint32_t i = 0; i < passes.size(); i++)
+        {
+            if (passes[i].name == name) return i;
+        }
+        return uint32_t(-1);
+    }
+
+    bool hasTransition(const PassGraph* pGraph, uint32_t passIdx, const std::string& channel, State state)
+    {
+        for (const auto& t : pGraph->getTransitions(passIdx))
+        {
+            if (t.channel == channel && t.state == state) return true;
+        }
+        return false;
+    }
+}
+
+void PassGraphTest::addTests()
+{
+    addTestToList<TestCulling>();
+    addTestToList<TestReadBeforeWrite>();
+    addTestToList<TestTransitions>();
+}
+
+testing_func(PassGraphTest, TestCulling)
+{
+    std::vector<PassGraph::PassDesc> passes = createPipeline();
+    PassGraph::SharedPtr pGraph = PassGraph::create();
+    if (pGraph->compile(passes, { "PipelineOutput" }) == false) return test_fail("Compilation failed");
+
+    // Only the debug view is dead; SVGF's history write keeps it alive even though the history is only read next frame
+    if (pGraph->getCulledPassCount() != 1 || pGraph->isCulled(findPass(passes, "DebugView")) == false)
+    {
+        return test_fail("Expected only the debug view to be culled, " + std::to_string(pGraph->getCulledPassCount()) + " passes were");
+    }
+    const std::vector<uint32_t>& order = pGraph->getExecutionOrder();
+    if (std::is_sorted(order.begin(), order.end()) == false) return test_fail("Culling changed the order of the surviving passes");
+
+    // Displaying the debug view keeps it, and a pass that declared nothing is never culled
+    if (pGraph->compile(passes, { "PipelineOutput", "Debug" }) == false || pGraph->getCulledPassCount() != 0)
+    {
+        return test_fail("The debug view was culled while it was displayed");
+    }
+    passes[findPass(passes, "DebugView")].declared = false;
+    passes[findPass(passes, "DebugView")].outputs.clear();
+    if (pGraph->compile(passes, { "PipelineOutput" }) == false || pGraph->getCulledPassCount() != 0)
+    {
+        return test_fail("A pass which declared nothing was culled");
+    }
+
+    // Nothing shown: only undeclared passes survive
+    passes = createPipeline();
+    pGraph->compile(passes, { "Nothing" });
+    if (pGraph->getCulledPassCount() != passes.size()) return test_fail("Passes survived with no sink");
+
+    // Every surviving edge must point forwards in pipeline order
+    pGraph->compile(passes, { "PipelineOutput" });
+    DirectedGraph::SharedPtr pDag = pGraph->getGraph();
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        const DirectedGraph::Node* pNode = pDag->getNode(i);
+        for (uint32_t e = 0; e < pNode->getOutgoingEdgeCount(); e++)
+        {
+            if (pDag->getEdge(pNode->getOutgoingEdge(e))->getDestNode() <= i) return test_fail("An edge points backwards from pass " + passes[i].name);
+        }
+    }
+    return test_pass();
+}
+
+testing_func(PassGraphTest, TestReadBeforeWrite)
+{
+    // The clean pipeline reads nothing before it's written (SVGF's own history doesn't count)
+    std::vector<PassGraph::PassDesc> passes = createPipeline();
+    PassGraph::SharedPtr pGraph = PassGraph::create();
+    pGraph->compile(passes, { "PipelineOutput" });
+    if (pGraph->getMessages().size()) return test_fail("Unexpected warning: " + pGraph->getMessages()[0]);
+
+    // Reflections reading a shadow channel which a later pass writes see last frame's shadows
+    passes[findPass(passes, "Reflection")].inputs.push_back("Shadow");
+    passes.insert(passes.begin() + findPass(passes, "Final"), PassGraph::PassDesc{ "Shadow", { "WorldPosition" }, { "Shadow" } });
+    passes[findPass(passes, "Final")].inputs.push_back("Shadow");
+    pGraph->compile(passes, { "PipelineOutput" });
+    if (pGraph->getMessages().size() != 1 || pGraph->getMessages()[0].find("before 'Shadow' writes it") == std::string::npos)
+    {
+        return test_fail("Expected one read-before-write warning for the shadow channel");
+    }
+
+    // Reading a channel nobody writes is reported, unless it is external
+    passes = createPipeline();
+    passes[findPass(passes, "Lighting")].inputs.push_back("EnvMap");
+    pGraph->compile(passes, { "PipelineOutput" });
+    if (pGraph->getMessages().size() != 1 || pGraph->getMessages()[0].find("which no active pass writes") == std::string::npos)
+    {
+        return test_fail("Expected a warning for a channel which no pass writes");
+    }
+    pGraph->compile(passes, { "PipelineOutput" }, { "EnvMap" });
+    if (pGraph->getMessages().size()) return test_fail("External channels should not produce warnings");
+    return test_pass();
+}
+
+testing_func(PassGraphTest, TestTransitions)
+{
+    std::vector<PassGraph::PassDesc> passes = createPipeline();
+    PassGraph::SharedPtr pGraph = PassGraph::create();
+    pGraph->compile(passes, { "PipelineOutput" });
+
+    const uint32_t gbuffer = findPass(passes, "GBuffer");
+    const uint32_t lighting = findPass(passes, "Lighting");
+    const uint32_t reflection = findPass(passes, "Reflection");
+    const uint32_t svgf = findPass(passes, "SVGF");
+
+    // Writers get their output state, the first reader flips it to a shader resource, later readers need nothing
+    if (!hasTransition(pGraph.get(), reflection, "ReflectionOut", State::UnorderedAccess)) return test_fail("Reflections don't move their output to UnorderedAccess");
+    if (!hasTransition(pGraph.get(), lighting, "WorldPosition", State::ShaderResource)) return test_fail("Lighting doesn't read the G-buffer as a shader resource");
+    if (hasTransition(pGraph.get(), reflection, "WorldPosition", State::ShaderResource)) return test_fail("The G-buffer was transitioned twice for two readers");
+
+    // The frame loops: the G-buffer starts every frame as a shader resource, so it must be moved back to RenderTarget, while the
+    //     depth buffer nobody reads stays in DepthStencil from frame to frame
+    if (!hasTransition(pGraph.get(), gbuffer, "WorldPosition", State::RenderTarget)) return test_fail("The end-of-frame state was not carried into the next frame");
+    if (pGraph->getTransitions(gbuffer).size() != 3) return test_fail("Expected transitions for the three G-buffer render targets only");
+
+    // Read-modify-write channels are left to the pass, and culled passes get nothing
+    for (const auto& t : pGraph->getTransitions(svgf))
+    {
+        if (t.channel == "PrevLinearZ") return test_fail("SVGF's history was transitioned by the graph");
+    }
+    if (pGraph->getTransitions(findPass(passes, "DebugView")).size()) return test_fail("A culled pass has transitions");
+
+    // The total is the sum of the per-pass lists
+    uint32_t total = 0;
+    for (uint32_t i : pGraph->getExecutionOrder()) total += uint32_t(pGraph->getTransitions(i).size());
+    if (total != pGraph->getTransitionCount()) return test_fail("getTransitionCount() doesn't match the per-pass lists");
+    return test_pass();
+}
+
+int main()
+{
+    PassGraphTest pgt;
+    pgt.init(false);
+    pgt.run();
+    return 0;
+}
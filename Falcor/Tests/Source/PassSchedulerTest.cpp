@@ -0,0 +1,201 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "PassSchedulerTest.h"
+
+namespace
+{
+    using State = Resource::State;
+    using Queue = PassScheduler::Queue;
+
+    // The hybrid pipeline's shape: reflections, AO and shadows are ray traced (async-capable), everything else rasterizes
+    std::vector<PassGraph::PassDesc> createPipeline()
+    {
+        return {
+            { "GBuffer",     {},                                                  { "WorldPosition", "WorldNormal", "LinearZ", "Z-Buffer" }, { State::RenderTarget, State::RenderTarget, State::RenderTarget, State::DepthStencil } },
+            { "Lighting",    { "WorldPosition", "WorldNormal" },                  { "Direct" } },
+            { "Reflection",  { "WorldPosition", "WorldNormal" },                  { "ReflectionOut" }, { State::UnorderedAccess } },
+            { "SVGF",        { "ReflectionOut", "LinearZ", "ReflectionHistory" }, { "ReflectionFiltered", "ReflectionHistory" } },
+            { "AO",          { "WorldPosition", "WorldNormal" },                  { "AO" }, { State::UnorderedAccess } },
+            { "Shadow",      { "WorldPosition" },                                 { "Shadow" }, { State::UnorderedAccess } },
+            { "ShadowSVGF",  { "Shadow", "AO", "LinearZ", "ShadowHistory" },      { "ShadowFiltered", "ShadowHistory" } },
+            { "Final",       { "Direct", "ReflectionFiltered", "ShadowFiltered" }, { "PipelineOutput" } },
+        };
+    }
+
+    const std::vector<bool> kAsyncCapable = { false, false, true, false, true, true, false, false };
+
+    PassScheduler::SharedPtr createScheduler(const std::vector<PassGraph::PassDesc>& passes, const std::vector<bool>& asyncCapable, const std::vector<std::string>& sinks = { "PipelineOutput" })
+    {
+        PassGraph::SharedPtr pGraph = PassGraph::create();
+        pGraph->compile(passes, sinks);
+        PassScheduler::SharedPtr pScheduler = PassScheduler::create();
+        pScheduler->build(pGraph, asyncCapable);
+        return pScheduler;
+    }
+
+    bool hasFence(const PassScheduler* pScheduler, uint32_t signalPass, uint32_t waitPass)
+    {
+        for (const auto& fence : pScheduler->getFences())
+        {
+            if (fence.signalPass == signalPass && fence.waitPass == waitPass) return true;
+        }
+        return false;
+    }
+
+    std::string describe(const PassScheduler* pScheduler, const std::vector<PassGraph::PassDesc>& passes)
+    {
+        std::string s;
+        for (const auto& fence : pScheduler->getFences())
+        {
+            s += " " + (fence.signalPass < passes.size() ? passes[fence.signalPass].name : std::string("<frame start>")) + "->" +
+                (fence.waitPass < passes.size() ? passes[fence.waitPass].name : std::string("<frame end>"));
+        }
+        return s;
+    }
+}
+
+void PassSchedulerTest::addTests()
+{
+    addTestToList<TestFencePlacement>();
+    addTestToList<TestUndeclaredPasses>();
+    addTestToList<TestTimeline>();
+}
+
+testing_func(PassSchedulerTest, TestFencePlacement)
+{
+    std::vector<PassGraph::PassDesc> passes = createPipeline();
+    PassScheduler::SharedPtr pScheduler = createScheduler(passes, kAsyncCapable);
+
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        if ((pScheduler->getQueue(i) == Queue::Async) != kAsyncCapable[i]) return test_fail(passes[i].name + " is on the wrong queue");
+    }
+
+    // The async queue waits for the G-buffer once; AO and shadows are covered by that wait because the queue runs in order.
+    //     The graphics queue waits for reflections before SVGF, and for shadows (which also covers AO) before the shadow filter.
+    //     That last wait is on the final async pass, so no separate end-of-frame join is needed.
+    if (pScheduler->getFences().size() != 3 || !hasFence(pScheduler.get(), 0, 2) || !hasFence(pScheduler.get(), 2, 3) || !hasFence(pScheduler.get(), 5, 6))
+    {
+        return test_fail("Unexpected fences:" + describe(pScheduler.get(), passes));
+    }
+    if (!pScheduler->needsSignal(5) || pScheduler->needsSignal(4)) return test_fail("Wrong passes signal");
+    if (pScheduler->getWaits(6).size() != 1 || pScheduler->getWaits(4).size() != 0) return test_fail("Wrong passes wait");
+
+    // Waits move with the readers: with the shadow filter only reading AO, the final pass waits for shadows itself
+    passes[6].inputs = { "AO", "LinearZ", "ShadowHistory" };
+    passes[7].inputs.push_back("Shadow");
+    pScheduler = createScheduler(passes, kAsyncCapable);
+    if (!hasFence(pScheduler.get(), 4, 6) || !hasFence(pScheduler.get(), 5, 7))
+    {
+        return test_fail("Expected the final pass to wait for shadows:" + describe(pScheduler.get(), passes));
+    }
+
+    // Nothing on the graphics queue reads the last async pass's output (it is displayed directly): the graphics queue must
+    //     join it before the frame ends
+    passes[7].inputs.pop_back();
+    pScheduler = createScheduler(passes, kAsyncCapable, { "PipelineOutput", "Shadow" });
+    if (!hasFence(pScheduler.get(), 5, PassScheduler::kFrameEnd)) return test_fail("Missing the end-of-frame join:" + describe(pScheduler.get(), passes));
+
+    // Without async passes, there is nothing to synchronize
+    pScheduler = createScheduler(createPipeline(), std::vector<bool>(passes.size(), false));
+    if (pScheduler->getAsyncPassCount() != 0 || pScheduler->getFences().size() != 0) return test_fail("Fences without an async queue");
+    return test_pass();
+}
+
+testing_func(PassSchedulerTest, TestUndeclaredPasses)
+{
+    // An async-capable pass that declared nothing has no edges, so it stays on the graphics queue and joins with the async queue
+    std::vector<PassGraph::PassDesc> passes = createPipeline();
+    passes.insert(passes.begin() + 5, PassGraph::PassDesc{ "Undeclared", {}, {} });
+    passes[5].declared = false;
+    std::vector<bool> asyncCapable = kAsyncCapable;
+    asyncCapable.insert(asyncCapable.begin() + 5, true);
+    PassScheduler::SharedPtr pScheduler = createScheduler(passes, asyncCapable);
+
+    if (pScheduler->getQueue(5) != Queue::Graphics) return test_fail("An undeclared pass was put on the async queue");
+    if (!hasFence(pScheduler.get(), 4, 5)) return test_fail("The undeclared pass doesn't wait for earlier async work:" + describe(pScheduler.get(), passes));
+    if (!hasFence(pScheduler.get(), 5, 6)) return test_fail("Later async work doesn't wait for the undeclared pass:" + describe(pScheduler.get(), passes));
+    return test_pass();
+}
+
+testing_func(PassSchedulerTest, TestTimeline)
+{
+    std::vector<PassGraph::PassDesc> passes = createPipeline();
+    PassScheduler::SharedPtr pScheduler = createScheduler(passes, kAsyncCapable);
+    const std::vector<double> cost = { 2.0, 1.0, 3.0, 1.5, 2.0, 1.0, 1.5, 0.5 };
+
+    // Reflections, AO and shadows (6 ms) overlap lighting and SVGF on the graphics queue
+    PassScheduler::Timeline timeline = pScheduler->simulate(cost);
+    if (timeline.serialTime != 12.5) return test_fail("Serial time " + std::to_string(timeline.serialTime) + ", expected 12.5");
+    if (timeline.frameTime != 10.0) return test_fail("Frame time " + std::to_string(timeline.frameTime) + ", expected 10");
+    if (timeline.queueBusy[uint32_t(Queue::Async)] != 6.0) return test_fail("The async queue should be busy for 6 ms");
+
+    // Nothing starts before what it waits on has finished, and queues never run two passes at once
+    for (const auto& fence : pScheduler->getFences())
+    {
+        if (fence.waitPass < passes.size() && fence.signalPass < passes.size() && timeline.passStart[fence.waitPass] < timeline.passEnd[fence.signalPass])
+        {
+            return test_fail(passes[fence.waitPass].name + " starts before " + passes[fence.signalPass].name + " ends");
+        }
+    }
+    for (uint32_t q = 0; q < uint32_t(Queue::Count); q++)
+    {
+        const std::vector<uint32_t>& queuePasses = pScheduler->getQueuePasses(Queue(q));
+        for (size_t i = 1; i < queuePasses.size(); i++)
+        {
+            if (timeline.passStart[queuePasses[i]] < timeline.passEnd[queuePasses[i - 1]]) return test_fail("Passes overlap on queue " + std::to_string(q));
+        }
+    }
+
+    // Fence latency and contention for the shader cores eat into the overlap, but never make it worse than serial
+    PassScheduler::Timeline slow = pScheduler->simulate(cost, 0.25, 1.2);
+    if (slow.frameTime <= timeline.frameTime || slow.frameTime >= slow.serialTime) return test_fail("Latency and slowdown modeled wrongly: " + std::to_string(slow.frameTime));
+
+    // Culled passes cost nothing, whatever they are given
+    passes.push_back({ "DebugView", { "WorldNormal" }, { "Debug" } });
+    std::vector<bool> asyncCapable = kAsyncCapable;
+    asyncCapable.push_back(false);
+    pScheduler = createScheduler(passes, asyncCapable);
+    std::vector<double> culledCost = cost;
+    culledCost.push_back(100.0);
+    if (pScheduler->simulate(culledCost).frameTime != 10.0) return test_fail("A culled pass was counted");
+
+    // Everything on one queue: the prediction is the serial time
+    pScheduler = createScheduler(createPipeline(), std::vector<bool>(cost.size(), false));
+    timeline = pScheduler->simulate(cost);
+    if (timeline.frameTime != timeline.serialTime) return test_fail("Without an async queue the frame should take the serial time");
+    return test_pass();
+}
+
+int main()
+{
+    PassSchedulerTest pst;
+    pst.init(false);
+    pst.run();
+    return 0;
+}
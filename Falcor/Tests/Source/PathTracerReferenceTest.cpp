@@ -0,0 +1,317 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "PathTracerReferenceTest.h"
+#include "Utils/CpuTimer.h"
+#include <cstdio>
+#include <random>
+
+using Falcor::PathTracerReference;
+
+namespace
+{
+    const uint32_t kSize = 24;
+    const char* kSceneFile = "PathTracerReferenceTest.scene";
+
+    void addQuad(PathTracerReference::Scene& scene, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d, uint32_t material)
+    {
+        PathTracerReference::Triangle t0, t1;
+        t0.p0 = a; t0.p1 = b; t0.p2 = c; t0.material = material;
+        t1.p0 = a; t1.p1 = c; t1.p2 = d; t1.material = material;
+        scene.triangles.push_back(t0);
+        scene.triangles.push_back(t1);
+    }
+
+    // A Cornell box open towards the camera, with a glossy block, an emissive panel and a point light under the ceiling
+    PathTracerReference::Scene createScene()
+    {
+        PathTracerReference::Scene scene;
+        PathTracerReference::Material white, red, green, glossy, panel;
+        white.diffuse = glm::vec3(0.7f);
+        red.diffuse = glm::vec3(0.7f, 0.1f, 0.1f);
+        green.diffuse = glm::vec3(0.1f, 0.7f, 0.1f);
+        glossy.diffuse = glm::vec3(0.2f);
+        glossy.specular = glm::vec3(0.8f);
+        glossy.linearRoughness = 0.3f;
+        panel.diffuse = glm::vec3(0.0f);
+        panel.emissive = glm::vec3(4.0f);
+        scene.materials = { white, red, green, glossy, panel };
+
+        addQuad(scene, glm::vec3(-1, -1, -1), glm::vec3(1, -1, -1), glm::vec3(1, -1, 1), glm::vec3(-1, -1, 1), 0);   // Floor
+        addQuad(scene, glm::vec3(-1, 1, -1), glm::vec3(-1, 1, 1), glm::vec3(1, 1, 1), glm::vec3(1, 1, -1), 0);       // Ceiling
+        addQuad(scene, glm::vec3(-1, -1, -1), glm::vec3(-1, 1, -1), glm::vec3(1, 1, -1), glm::vec3(1, -1, -1), 0);   // Back
+        addQuad(scene, glm::vec3(-1, -1, -1), glm::vec3(-1, -1, 1), glm::vec3(-1, 1, 1), glm::vec3(-1, 1, -1), 1);   // Left
+        addQuad(scene, glm::vec3(1, -1, -1), glm::vec3(1, 1, -1), glm::vec3(1, 1, 1), glm::vec3(1, -1, 1), 2);       // Right
+        addQuad(scene, glm::vec3(-0.3f, 0.99f, -0.3f), glm::vec3(0.3f, 0.99f, -0.3f), glm::vec3(0.3f, 0.99f, 0.3f), glm::vec3(-0.3f, 0.99f, 0.3f), 4);
+
+        // Block: top and the three faces the camera can see
+        glm::vec3 lo(-0.6f, -1.0f, -0.6f), hi(0.0f, -0.2f, 0.0f);
+        addQuad(scene, glm::vec3(lo.x, hi.y, lo.z), glm::vec3(hi.x, hi.y, lo.z), glm::vec3(hi.x, hi.y, hi.z), glm::vec3(lo.x, hi.y, hi.z), 3);
+        addQuad(scene, glm::vec3(lo.x, lo.y, hi.z), glm::vec3(hi.x, lo.y, hi.z), glm::vec3(hi.x, hi.y, hi.z), glm::vec3(lo.x, hi.y, hi.z), 3);
+        addQuad(scene, glm::vec3(hi.x, lo.y, lo.z), glm::vec3(hi.x, hi.y, lo.z), glm::vec3(hi.x, hi.y, hi.z), glm::vec3(hi.x, lo.y, hi.z), 3);
+        addQuad(scene, glm::vec3(lo.x, lo.y, lo.z), glm::vec3(lo.x, lo.y, hi.z), glm::vec3(lo.x, hi.y, hi.z), glm::vec3(lo.x, hi.y, lo.z), 3);
+
+        PathTracerReference::PointLight light;
+        light.position = glm::vec3(0.2f, 0.8f, 0.2f);
+        light.intensity = glm::vec3(3.0f);
+        scene.lights.push_back(light);
+
+        scene.cameraPos = glm::vec3(0.0f, 0.0f, 3.2f);
+        scene.cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
+        scene.fovY = 0.9f;
+        scene.backgroundColor = glm::vec3(0.3f, 0.3f, 0.5f);
+        scene.skyColor = glm::vec3(0.106f, 0.162f, 0.184f);
+        return scene;
+    }
+
+    PathTracerReference::Settings createSettings(uint32_t maxDepth)
+    {
+        PathTracerReference::Settings settings;
+        settings.width = kSize;
+        settings.height = kSize;
+        settings.maxDepth = maxDepth;
+        return settings;
+    }
+
+    // Largest per-channel difference, relative to the brighter of the two values (or absolute below 1)
+    float maxRelativeDifference(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b)
+    {
+        float maxDiff = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                float scale = std::max(1.0f, std::max(std::abs(a[i][c]), std::abs(b[i][c])));
+                maxDiff = std::max(maxDiff, std::abs(a[i][c] - b[i][c]) / scale);
+            }
+        }
+        return maxDiff;
+    }
+
+    double imageSum(const std::vector<glm::vec3>& image)
+    {
+        double sum = 0;
+        for (const auto& c : image) sum += double(c.x) + double(c.y) + double(c.z);
+        return sum;
+    }
+}
+
+void PathTracerReferenceTest::addTests()
+{
+    addTestToList<TestWavefrontMatchesRecursive>();
+    addTestToList<TestDirectOnly>();
+    addTestToList<TestActivePathCounts>();
+    addTestToList<TestRussianRouletteIsUnbiased>();
+    addTestToList<TestBvhMatchesScan>();
+    addTestToList<TestSceneFileRoundTrip>();
+}
+
+testing_func(PathTracerReferenceTest, TestWavefrontMatchesRecursive)
+{
+    // Both draw the same random numbers in the same order, so only floating-point rounding may differ
+    PathTracerReference::Scene scene = createScene();
+    for (uint32_t maxDepth : { 1u, 3u, 6u })
+    {
+        PathTracerReference::Settings settings = createSettings(maxDepth);
+        for (uint32_t frame = 0; frame < 4; frame++)
+        {
+            std::vector<glm::vec3> recursive = PathTracerReference::renderRecursive(scene, settings, frame);
+            std::vector<glm::vec3> wavefront = PathTracerReference::renderWavefront(scene, settings, frame);
+            float diff = maxRelativeDifference(recursive, wavefront);
+            if (diff > 1e-4f)
+            {
+                return test_fail("Images differ by " + std::to_string(diff) + " with " + std::to_string(maxDepth) + " bounces, frame " + std::to_string(frame));
+            }
+        }
+    }
+
+    // ... and the paths really went somewhere
+    PathTracerReference::Settings settings = createSettings(3);
+    double direct = imageSum(PathTracerReference::renderWavefront(scene, createSettings(0), 0));
+    double indirect = imageSum(PathTracerReference::renderWavefront(scene, settings, 0));
+    if (indirect <= direct) return test_fail("Indirect bounces didn't add any light");
+    return test_pass();
+}
+
+testing_func(PathTracerReferenceTest, TestDirectOnly)
+{
+    // Without bounces, there is a single stage of shading and no extension rays
+    PathTracerReference::Scene scene = createScene();
+    PathTracerReference::Settings settings = createSettings(3);
+    settings.doIndirect = false;
+
+    PathTracerReference::Stats stats;
+    std::vector<glm::vec3> wavefront = PathTracerReference::renderWavefront(scene, settings, 7, &stats);
+    std::vector<glm::vec3> recursive = PathTracerReference::renderRecursive(scene, settings, 7);
+    if (maxRelativeDifference(recursive, wavefront) > 1e-4f) return test_fail("Direct lighting differs");
+    if (stats.activePaths.size() != 1) return test_fail("Paths were extended without indirect lighting");
+    // Every surface the camera sees faces the point light
+    if (stats.shadowRays[0] != stats.activePaths[0]) return test_fail("Some paths didn't trace a shadow ray");
+    return test_pass();
+}
+
+testing_func(PathTracerReferenceTest, TestActivePathCounts)
+{
+    PathTracerReference::Scene scene = createScene();
+    PathTracerReference::Settings settings = createSettings(6);
+    PathTracerReference::Stats stats;
+    std::vector<glm::vec3> image = PathTracerReference::renderWavefront(scene, settings, 3, &stats);
+
+    // Every pixel covering geometry starts a path
+    uint32_t geometryPixels = 0;
+    for (const auto& c : image) geometryPixels += (c == scene.backgroundColor) ? 0 : 1;
+    if (stats.activePaths.empty() || stats.activePaths[0] != geometryPixels)
+    {
+        return test_fail("Bounce 0 shaded " + std::to_string(stats.activePaths.empty() ? 0 : stats.activePaths[0]) + " paths for " + std::to_string(geometryPixels) + " pixels");
+    }
+    if (stats.activePaths.size() != settings.maxDepth + 1) return test_fail("Expected a queue for every bounce");
+
+    // Paths only leave the queue (escaping through the open side, or at the last bounce), and neither misses nor surfaces
+    //     facing away from the light trace a shadow ray
+    for (size_t b = 1; b < stats.activePaths.size(); b++)
+    {
+        if (stats.activePaths[b] > stats.activePaths[b - 1]) return test_fail("Bounce " + std::to_string(b) + " has more paths than the one before");
+        if (stats.shadowRays[b] > stats.activePaths[b]) return test_fail("More shadow rays than paths at bounce " + std::to_string(b));
+    }
+    if (stats.activePaths.back() == stats.activePaths[0]) return test_fail("No path escaped the open box");
+
+    // Russian roulette thins out the deeper bounces
+    settings.russianRoulette = true;
+    PathTracerReference::Stats rouletteStats;
+    PathTracerReference::renderWavefront(scene, settings, 3, &rouletteStats);
+    if (rouletteStats.activePaths[1] != stats.activePaths[1]) return test_fail("Russian roulette ran before its start depth");
+    if (rouletteStats.activePaths.size() < 4 || rouletteStats.activePaths[3] >= stats.activePaths[3]) return test_fail("Russian roulette didn't terminate any path");
+    return test_pass();
+}
+
+testing_func(PathTracerReferenceTest, TestRussianRouletteIsUnbiased)
+{
+    // Terminated paths are made up for by boosting the survivors, so the average over many frames must not change
+    PathTracerReference::Scene scene = createScene();
+    PathTracerReference::Settings settings = createSettings(6);
+    PathTracerReference::Settings roulette = settings;
+    roulette.russianRoulette = true;
+    roulette.rouletteStartDepth = 1;
+
+    const uint32_t kFrames = 96;
+    double sum = 0, rouletteSum = 0;
+    for (uint32_t frame = 0; frame < kFrames; frame++)
+    {
+        sum += imageSum(PathTracerReference::renderWavefront(scene, settings, frame));
+        rouletteSum += imageSum(PathTracerReference::renderWavefront(scene, roulette, frame + 1000));
+    }
+    double ratio = rouletteSum / sum;
+    if (std::abs(ratio - 1.0) > 0.02) return test_fail("Russian roulette changed the image's average by " + std::to_string(ratio));
+    return test_pass();
+}
+
+testing_func(PathTracerReferenceTest, TestBvhMatchesScan)
+{
+    // A cloud of small random triangles under the box's light. The box itself is left out: where its walls meet, two triangles
+    //     of different materials are hit at exactly the same distance, and which one wins depends on the order they are tested in.
+    PathTracerReference::Scene box = createScene();
+    PathTracerReference::Scene scene;
+    scene.materials = box.materials;
+    scene.lights = box.lights;
+    scene.cameraPos = box.cameraPos;
+    scene.cameraTarget = box.cameraTarget;
+    scene.fovY = box.fovY;
+    scene.backgroundColor = box.backgroundColor;
+    scene.skyColor = box.skyColor;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> position(-0.9f, 0.9f);
+    std::uniform_real_distribution<float> offset(-0.05f, 0.05f);
+    for (uint32_t i = 0; i < 4000; i++)
+    {
+        PathTracerReference::Triangle tri;
+        tri.p0 = glm::vec3(position(rng), position(rng), position(rng));
+        tri.p1 = tri.p0 + glm::vec3(offset(rng), offset(rng), offset(rng));
+        tri.p2 = tri.p0 + glm::vec3(offset(rng), offset(rng), offset(rng));
+        tri.material = i % 4;
+        scene.triangles.push_back(tri);
+    }
+    PathTracerReference::Settings settings = createSettings(3);
+
+    auto start = CpuTimer::getCurrentTimePoint();
+    std::vector<glm::vec3> scan = PathTracerReference::renderRecursive(scene, settings, 5);
+    double scanMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    start = CpuTimer::getCurrentTimePoint();
+    PathTracerReference::buildBvh(scene);
+    std::vector<glm::vec3> bvh = PathTracerReference::renderRecursive(scene, settings, 5);
+    double bvhMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    logInfo("PathTracerReference, " + std::to_string(scene.triangles.size()) + " triangles: " + std::to_string(scanMs) + " ms testing every triangle, " +
+        std::to_string(bvhMs) + " ms with the hierarchy (" + std::to_string(scene.bvh.size()) + " nodes, including the build)");
+
+    // The hierarchy only changes the order triangles are tested in, never which one is closest
+    if (maxRelativeDifference(scan, bvh) > 1e-5f) return test_fail("The hierarchy changed the image");
+    if (bvhMs >= scanMs) return test_fail("The hierarchy was slower than testing every triangle");
+    return test_pass();
+}
+
+testing_func(PathTracerReferenceTest, TestSceneFileRoundTrip)
+{
+    // The coordinator renders what the application exported, so the image must not change on the way
+    PathTracerReference::Scene scene = createScene();
+    PathTracerReference::Settings settings = createSettings(3);
+    if (!PathTracerReference::saveScene(scene, kSceneFile)) return test_fail("Can't write the scene file");
+
+    PathTracerReference::Scene loaded;
+    bool ok = PathTracerReference::loadScene(kSceneFile, loaded);
+    if (!ok) return test_fail("Can't read the scene file");
+    if (loaded.triangles.size() != scene.triangles.size() || loaded.materials.size() != scene.materials.size() || loaded.lights.size() != scene.lights.size())
+    {
+        return test_fail("The scene file lost geometry, materials or lights");
+    }
+    if (maxRelativeDifference(PathTracerReference::renderRecursive(scene, settings, 2), PathTracerReference::renderRecursive(loaded, settings, 2)) != 0.0f)
+    {
+        return test_fail("The loaded scene renders differently");
+    }
+
+    // A truncated file is rejected and leaves the scene alone
+    std::FILE* pFile = std::fopen(kSceneFile, "rb");
+    std::vector<char> bytes(64 * 1024);
+    bytes.resize(std::fread(bytes.data(), 1, bytes.size(), pFile));
+    std::fclose(pFile);
+    pFile = std::fopen(kSceneFile, "wb");
+    std::fwrite(bytes.data(), 1, bytes.size() / 2, pFile);
+    std::fclose(pFile);
+    ok = PathTracerReference::loadScene(kSceneFile, loaded);
+    std::remove(kSceneFile);
+    if (ok) return test_fail("A truncated scene file was accepted");
+    if (loaded.triangles.size() != scene.triangles.size()) return test_fail("A truncated scene file modified the scene");
+    return test_pass();
+}
+
+int main()
+{
+    PathTracerReferenceTest ptrt;
+    ptrt.init(false);
+    ptrt.run();
+    return 0;
+}
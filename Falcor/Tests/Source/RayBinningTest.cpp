@@ -0,0 +1,251 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "RayBinningTest.h"
+#include "Utils/CpuTimer.h"
+#include <algorithm>
+#include <random>
+
+namespace
+{
+    using namespace RayBinning;
+
+    struct Ray
+    {
+        glm::vec3 origin;
+        glm::vec3 dir;
+    };
+
+    // Reflection rays leaving a floor in random directions, with every 8th pixel missing geometry
+    std::vector<Ray> createRays(uint32_t count, float gridSize, uint32_t seed, std::vector<uint32_t>& keys)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(0.0f, gridSize);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        std::vector<Ray> rays(count);
+        keys.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            glm::vec3 dir;
+            do
+            {
+                dir = glm::vec3(unit(rng), unit(rng), unit(rng));
+            } while (glm::dot(dir, dir) > 1.0f || glm::dot(dir, dir) < 1e-4f);
+            dir = glm::normalize(dir);
+            dir.y = std::abs(dir.y);
+
+            rays[i].origin = glm::vec3(position(rng), 1.5f, position(rng));
+            rays[i].dir = dir;
+            keys[i] = (i % 8 == 7) ? kInvalidKey : binKey(rays[i].origin, rays[i].dir, glm::vec3(0.0f), glm::vec3(gridSize));
+        }
+        return rays;
+    }
+
+    /** A voxel scene too big for the CPU caches, traced with a 3D DDA.  Coherent ray orders touch the same voxels in a
+        row, which is the CPU stand-in for the memory and divergence savings binning buys on the GPU.
+    */
+    class VoxelScene
+    {
+    public:
+        VoxelScene(uint32_t size, uint32_t seed) : mSize(size), mVoxels(size_t(size) * size * size, 0)
+        {
+            // A floor, and a field of pillars and floating blocks
+            std::mt19937 rng(seed);
+            std::uniform_int_distribution<uint32_t> cell(0, size - 1);
+            for (uint32_t z = 0; z < size; z++) for (uint32_t x = 0; x < size; x++) set(x, 0, z);
+            for (uint32_t i = 0; i < size * 16; i++)
+            {
+                uint32_t x = cell(rng), y = cell(rng) / 2, z = cell(rng), s = 1 + cell(rng) % 6;
+                for (uint32_t dz = 0; dz < s; dz++) for (uint32_t dy = 0; dy < s; dy++) for (uint32_t dx = 0; dx < s; dx++)
+                {
+                    if (x + dx < size && y + dy < size && z + dz < size) set(x + dx, y + dy, z + dz);
+                }
+            }
+        }
+
+        // Index of the first solid voxel along the ray, or ~0 if it leaves the grid
+        uint32_t trace(const Ray& ray) const
+        {
+            int cell[3], step[3];
+            float tMax[3], tDelta[3];
+            for (int i = 0; i < 3; i++)
+            {
+                cell[i] = int(ray.origin[i]);
+                step[i] = ray.dir[i] < 0.0f ? -1 : 1;
+                float invDir = 1.0f / std::max(std::abs(ray.dir[i]), 1e-8f);
+                float boundary = ray.dir[i] < 0.0f ? float(cell[i]) : float(cell[i] + 1);
+                tMax[i] = std::abs(boundary - ray.origin[i]) * invDir;
+                tDelta[i] = invDir;
+            }
+
+            while (uint32_t(cell[0]) < mSize && uint32_t(cell[1]) < mSize && uint32_t(cell[2]) < mSize)
+            {
+                uint32_t index = (uint32_t(cell[2]) * mSize + uint32_t(cell[1])) * mSize + uint32_t(cell[0]);
+                if (mVoxels[index]) return index;
+
+                int axis = (tMax[0] < tMax[1]) ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+                cell[axis] += step[axis];
+                tMax[axis] += tDelta[axis];
+            }
+            return ~0u;
+        }
+
+    private:
+        void set(uint32_t x, uint32_t y, uint32_t z) { mVoxels[(size_t(z) * mSize + y) * mSize + x] = 1; }
+
+        uint32_t mSize;
+        std::vector<uint8_t> mVoxels;
+    };
+}
+
+void RayBinningTest::addTests()
+{
+    addTestToList<TestKeys>();
+    addTestToList<TestSortReference>();
+    addTestToList<TestBenchmark>();
+}
+
+testing_func(RayBinningTest, TestKeys)
+{
+    // Bit i of the octant is the sign of component i, and the octant sits above the Morton code
+    if (directionOctant(glm::vec3(1, 1, 1)) != 0 || directionOctant(glm::vec3(-1, 1, -1)) != 5 || directionOctant(glm::vec3(-1, -1, -1)) != 7)
+    {
+        return test_fail("Wrong direction octants");
+    }
+
+    const glm::vec3 sceneMin(-10.0f), sceneExtent(20.0f);
+    const uint32_t cellsPerAxis = 1u << kMortonBitsPerAxis;
+    if (mortonCode(sceneMin, sceneMin, sceneExtent) != 0) return test_fail("The scene corner should have Morton code 0");
+    if (mortonCode(glm::vec3(10.0f), sceneMin, sceneExtent) != (1u << (3 * kMortonBitsPerAxis)) - 1) return test_fail("The far corner should have the largest Morton code");
+    if (mortonCode(glm::vec3(100.0f, -100.0f, 0.0f), sceneMin, sceneExtent) >= (1u << (3 * kMortonBitsPerAxis))) return test_fail("Positions outside the scene must clamp");
+
+    // Each axis step moves the code by its interleaved bit
+    float cell = 20.0f / float(cellsPerAxis);
+    glm::vec3 p(-10.0f + 0.5f * cell);
+    if (mortonCode(glm::vec3(p.x + cell, p.y, p.z), sceneMin, sceneExtent) != 1 ||
+        mortonCode(glm::vec3(p.x, p.y + cell, p.z), sceneMin, sceneExtent) != 2 ||
+        mortonCode(glm::vec3(p.x, p.y, p.z + cell), sceneMin, sceneExtent) != 4)
+    {
+        return test_fail("Morton bits are not interleaved x, y, z");
+    }
+
+    if (binKey(p, glm::vec3(-1, 1, -1), sceneMin, sceneExtent) != (5u << (3 * kMortonBitsPerAxis))) return test_fail("The octant must be the top bits of the key");
+    return test_pass();
+}
+
+testing_func(RayBinningTest, TestSortReference)
+{
+    std::vector<uint32_t> keys;
+    createRays(100000, 64.0f, 1, keys);
+
+    // Reference: a stable comparison sort of the valid rays
+    std::vector<uint32_t> reference;
+    for (uint32_t i = 0; i < uint32_t(keys.size()); i++)
+    {
+        if (keys[i] != kInvalidKey) reference.push_back(i);
+    }
+    std::stable_sort(reference.begin(), reference.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    std::vector<uint32_t> binOffsets;
+    std::vector<uint32_t> sorted = sortByKey(keys, &binOffsets);
+    if (sorted != reference) return test_fail("The counting sort doesn't match a stable sort by key");
+
+    // Bin ranges are what the GPU uses to find its rays, so they must bracket exactly the rays with that key
+    if (binOffsets.size() != kBinCount) return test_fail("Expected " + std::to_string(kBinCount) + " bin offsets");
+    for (uint32_t bin = 0; bin < kBinCount; bin++)
+    {
+        uint32_t begin = binOffsets[bin];
+        uint32_t end = (bin + 1 < kBinCount) ? binOffsets[bin + 1] : uint32_t(sorted.size());
+        if (begin > end) return test_fail("Bin offsets are not increasing");
+        for (uint32_t i = begin; i < end; i++)
+        {
+            if (keys[sorted[i]] != bin) return test_fail("Ray " + std::to_string(sorted[i]) + " is in bin " + std::to_string(bin) + " but has key " + std::to_string(keys[sorted[i]]));
+        }
+    }
+
+    // Rays without geometry are dropped; nothing valid is lost
+    if (sorted.size() != keys.size() - keys.size() / 8) return test_fail("Wrong number of sorted rays");
+    if (!sortByKey(std::vector<uint32_t>(10, kInvalidKey)).empty()) return test_fail("Invalid rays were kept");
+    return test_pass();
+}
+
+testing_func(RayBinningTest, TestBenchmark)
+{
+    const uint32_t kGridSize = 256;
+    const uint32_t kRayCount = 1 << 18;
+    VoxelScene scene(kGridSize, 2);
+    std::vector<uint32_t> keys;
+    std::vector<Ray> rays = createRays(kRayCount, float(kGridSize), 3, keys);
+
+    std::vector<uint32_t> unsortedOrder;
+    for (uint32_t i = 0; i < kRayCount; i++)
+    {
+        if (keys[i] != kInvalidKey) unsortedOrder.push_back(i);
+    }
+
+    // Trace in launch order, then bin (the key pass and the sort count against the sorted run) and trace in bin order
+    std::vector<uint32_t> unsortedHits(kRayCount, ~0u), sortedHits(kRayCount, ~0u);
+    CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i : unsortedOrder) unsortedHits[i] = scene.trace(rays[i]);
+    double unsortedMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    start = CpuTimer::getCurrentTimePoint();
+    std::vector<uint32_t> sortKeys(kRayCount);
+    for (uint32_t i = 0; i < kRayCount; i++)
+    {
+        sortKeys[i] = (i % 8 == 7) ? kInvalidKey : binKey(rays[i].origin, rays[i].dir, glm::vec3(0.0f), glm::vec3(float(kGridSize)));
+    }
+    std::vector<uint32_t> sortedOrder = sortByKey(sortKeys);
+    double sortMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    for (uint32_t i : sortedOrder) sortedHits[i] = scene.trace(rays[i]);
+    double sortedMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    std::vector<glm::vec3> dirs(kRayCount);
+    for (uint32_t i = 0; i < kRayCount; i++) dirs[i] = rays[i].dir;
+    float unsortedCoherence = directionCoherence(dirs, unsortedOrder);
+    float sortedCoherence = directionCoherence(dirs, sortedOrder);
+
+    double rayCount = double(unsortedOrder.size());
+    logInfo("RayBinning, " + std::to_string(unsortedOrder.size()) + " rays in a " + std::to_string(kGridSize) + "^3 voxel grid: unsorted " +
+        std::to_string(rayCount / unsortedMs * 1e-3) + " Mrays/s, sorted " + std::to_string(rayCount / sortedMs * 1e-3) + " Mrays/s (binning " +
+        std::to_string(sortMs) + " ms); direction coherence " + std::to_string(unsortedCoherence) + " -> " + std::to_string(sortedCoherence));
+
+    // Sorting changes the order rays are traced in, never what they hit
+    if (sortedOrder.size() != unsortedOrder.size()) return test_fail("Binning lost rays");
+    if (sortedHits != unsortedHits) return test_fail("Sorted rays hit different voxels");
+    if (sortedCoherence <= unsortedCoherence) return test_fail("Sorting didn't make consecutive rays more coherent");
+    return test_pass();
+}
+
+int main()
+{
+    RayBinningTest rbt;
+    rbt.init(false);
+    rbt.run();
+    return 0;
+}
@@ -0,0 +1,219 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ReservoirTest.h"
+#include <random>
+
+namespace
+{
+    const uint32_t kLightCount = 16;
+    const uint32_t kTrials = 200000;
+
+    // Contribution of each light to a pixel, with a few bright lights among many dim ones
+    float lightContribution(uint32_t light)
+    {
+        return (light % 5 == 0) ? 10.0f + float(light) : 0.5f + 0.1f * float(light);
+    }
+
+    // The target pdf only approximates the contribution, like an unshadowed estimate does
+    float targetPdf(uint32_t light)
+    {
+        return lightContribution(light) * ((light % 2) ? 0.5f : 1.5f);
+    }
+
+    double contributionSum()
+    {
+        double sum = 0;
+        for (uint32_t i = 0; i < kLightCount; i++) sum += lightContribution(i);
+        return sum;
+    }
+
+    // RIS with lights picked uniformly as the candidates
+    Falcor::Reservoir sampleLights(uint32_t candidateCount, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> dist;
+        Falcor::Reservoir r;
+        for (uint32_t i = 0; i < candidateCount; i++)
+        {
+            uint32_t light = std::min(uint32_t(dist(rng) * kLightCount), kLightCount - 1);
+            float sourcePdf = 1.0f / kLightCount;
+            r.update(light, targetPdf(light) / sourcePdf, targetPdf(light), dist(rng));
+        }
+        r.finalize();
+        return r;
+    }
+}
+
+void ReservoirTest::addTests()
+{
+    addTestToList<TestSelectionProbability>();
+    addTestToList<TestRisIsUnbiased>();
+    addTestToList<TestMergeIsUnbiased>();
+    addTestToList<TestZeroTargetPdf>();
+    addTestToList<TestHistoryCap>();
+}
+
+testing_func(ReservoirTest, TestSelectionProbability)
+{
+    // Streaming the same candidates every time, each one must be kept with a probability proportional to its weight
+    const float weights[] = { 1, 4, 0.5f, 2, 8, 0.25f, 3, 1.25f };
+    const uint32_t count = arraysize(weights);
+    float weightSum = 0;
+    for (float w : weights) weightSum += w;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist;
+    std::vector<uint32_t> kept(count, 0);
+    for (uint32_t t = 0; t < kTrials; t++)
+    {
+        Falcor::Reservoir r;
+        for (uint32_t i = 0; i < count; i++) r.update(i, weights[i], weights[i], dist(rng));
+        kept[r.sample]++;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float frequency = float(kept[i]) / kTrials;
+        float expected = weights[i] / weightSum;
+        if (std::abs(frequency - expected) > 0.005f)
+        {
+            return test_fail("Candidate " + std::to_string(i) + " was kept " + std::to_string(frequency) + " of the time instead of " + std::to_string(expected));
+        }
+    }
+    return test_pass();
+}
+
+testing_func(ReservoirTest, TestRisIsUnbiased)
+{
+    // f(sample) * W estimates the sum of the contributions, whatever the number of candidates
+    double expected = contributionSum();
+    std::mt19937 rng(2);
+    for (uint32_t candidateCount : { 1u, 4u, 32u })
+    {
+        double sum = 0;
+        for (uint32_t t = 0; t < kTrials; t++)
+        {
+            Falcor::Reservoir r = sampleLights(candidateCount, rng);
+            sum += lightContribution(r.sample) * r.W;
+        }
+        double estimate = sum / kTrials;
+        if (std::abs(estimate / expected - 1) > 0.01)
+        {
+            return test_fail("RIS with " + std::to_string(candidateCount) + " candidates estimates " + std::to_string(estimate) + " instead of " + std::to_string(expected));
+        }
+    }
+    return test_pass();
+}
+
+testing_func(ReservoirTest, TestMergeIsUnbiased)
+{
+    // Merging reservoirs of the same pixel, as temporal reuse does for a static pixel, must keep the estimate unbiased
+    // and count the candidates of both
+    double expected = contributionSum();
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> dist;
+    double sum = 0;
+    for (uint32_t t = 0; t < kTrials; t++)
+    {
+        Falcor::Reservoir current = sampleLights(2, rng);
+        Falcor::Reservoir history = sampleLights(6, rng);
+
+        Falcor::Reservoir r;
+        r.merge(current, current.sample != Falcor::Reservoir::kInvalidSample ? targetPdf(current.sample) : 0.0f, dist(rng));
+        r.merge(history, history.sample != Falcor::Reservoir::kInvalidSample ? targetPdf(history.sample) : 0.0f, dist(rng));
+        r.finalize();
+        if (r.M != 8) return test_fail("A merged reservoir counts " + std::to_string(r.M) + " candidates instead of 8");
+        sum += lightContribution(r.sample) * r.W;
+    }
+    double estimate = sum / kTrials;
+    if (std::abs(estimate / expected - 1) > 0.01)
+    {
+        return test_fail("Merged reservoirs estimate " + std::to_string(estimate) + " instead of " + std::to_string(expected));
+    }
+    return test_pass();
+}
+
+testing_func(ReservoirTest, TestZeroTargetPdf)
+{
+    // Candidates with a zero target pdf are never kept, and a reservoir without a sample contributes nothing
+    Falcor::Reservoir empty;
+    empty.update(0, 0.0f, 0.0f, 0.0f);
+    empty.update(1, 0.0f, 0.0f, 0.5f);
+    empty.finalize();
+    if (empty.sample != Falcor::Reservoir::kInvalidSample || empty.W != 0 || empty.M != 2)
+    {
+        return test_fail("A reservoir with only zero weight candidates kept a sample or has a non zero weight");
+    }
+
+    Falcor::Reservoir r;
+    r.update(3, 2.0f, 2.0f, 0.5f);
+    r.update(4, 0.0f, 0.0f, 0.0f);
+    r.finalize();
+    if (r.sample != 3)
+    {
+        return test_fail("A zero weight candidate replaced the kept sample");
+    }
+
+    // It still counts as a candidate: W = weightSum / (M * targetPdf) = 2 / (2 * 2)
+    if (std::abs(r.W - 0.5f) > 1e-6f)
+    {
+        return test_fail("The contribution weight is " + std::to_string(r.W) + " instead of 0.5");
+    }
+
+    // A sample whose target pdf is zero at another pixel doesn't carry over
+    Falcor::Reservoir neighbor;
+    neighbor.merge(r, 0.0f, 0.0f);
+    neighbor.finalize();
+    if (neighbor.sample != Falcor::Reservoir::kInvalidSample || neighbor.W != 0 || neighbor.M != r.M)
+    {
+        return test_fail("A sample with a zero target pdf at the neighbor was kept when merging");
+    }
+    return test_pass();
+}
+
+testing_func(ReservoirTest, TestHistoryCap)
+{
+    std::mt19937 rng(4);
+    Falcor::Reservoir history = sampleLights(100, rng);
+    history.capHistory(20);
+    if (history.M != 20) return test_fail("The history was capped to " + std::to_string(history.M) + " candidates instead of 20");
+
+    // The cap doesn't change W, only how much the history weighs against new candidates
+    Falcor::Reservoir uncapped = sampleLights(4, rng);
+    float W = uncapped.W;
+    uncapped.capHistory(20);
+    if (uncapped.M != 4 || uncapped.W != W) return test_fail("Capping changed a reservoir below the cap");
+    return test_pass();
+}
+
+int main()
+{
+    ReservoirTest rt;
+    rt.init(false);
+    rt.run();
+    return 0;
+}
@@ -0,0 +1,341 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TemporalUpscaleTest.h"
+#include "Utils/PatternGenerators/HaltonSamplePattern.h"
+
+using Falcor::TemporalUpscaleReference;
+using Falcor::HaltonSamplePattern;
+
+namespace
+{
+    using Frame = TemporalUpscaleReference::Frame;
+
+    const glm::uvec2 kOutputSize = glm::uvec2(96, 64);
+    const float kFactors[] = { 1.5f, 2.0f, 3.0f };
+
+    // A checkerboard panned by the camera, with a striped disc moving in front of it. Positions are screen UVs.
+    struct Scene
+    {
+        glm::vec2 pan = glm::vec2(0.0f);            ///< Camera motion, in UVs per frame
+        glm::vec2 discStart = glm::vec2(0.5f);
+        glm::vec2 discVelocity = glm::vec2(0.0f);   ///< In UVs per frame
+        float discRadius = 0.0f;
+        float brightness = 1.0f;
+    };
+
+    glm::vec2 discCenter(const Scene& scene, uint32_t frame)
+    {
+        return scene.discStart + scene.discVelocity * float(frame);
+    }
+
+    bool inDisc(const Scene& scene, uint32_t frame, glm::vec2 uv)
+    {
+        glm::vec2 d = (uv - discCenter(scene, frame)) * glm::vec2(1.5f, 1.0f);
+        return dot(d, d) < scene.discRadius * scene.discRadius;
+    }
+
+    // Color, linear depth and motion of the surface at a position
+    glm::vec3 shade(const Scene& scene, uint32_t frame, glm::vec2 uv, float* pZ = nullptr, glm::vec2* pMotion = nullptr)
+    {
+        glm::vec3 color;
+        if (inDisc(scene, frame, uv))
+        {
+            glm::vec2 d = uv - discCenter(scene, frame);
+            color = glm::vec3(0.9f, 0.35f, 0.1f) * (0.55f + 0.45f * std::sin(d.x * 140.0f));
+            if (pZ) *pZ = 2.0f;
+            if (pMotion) *pMotion = -scene.discVelocity;
+        }
+        else
+        {
+            // Checker edges and a fine pattern the render resolutions can't hold
+            glm::vec2 p = uv + scene.pan * float(frame);
+            int32_t checker = (int32_t(std::floor(p.x * 11.3f + p.y * 0.9f)) + int32_t(std::floor(p.y * 7.7f - p.x * 0.6f))) & 1;
+            float fine = 0.5f + 0.5f * std::sin(p.x * 90.0f) * std::sin(p.y * 60.0f);
+            color = checker ? glm::vec3(0.8f, 0.8f, 0.75f) : glm::vec3(0.1f, 0.2f, 0.3f) + 0.3f * fine;
+            if (pZ) *pZ = 10.0f;
+            if (pMotion) *pMotion = scene.pan;
+        }
+        return color * scene.brightness;
+    }
+
+    // What the G-buffer and lighting passes produce: one sample per render pixel, at its jittered position
+    Frame render(const Scene& scene, uint32_t frame, glm::uvec2 renderSize, glm::vec2 jitter)
+    {
+        Frame f;
+        f.renderSize = renderSize;
+        f.jitter = jitter;
+        uint32_t count = renderSize.x * renderSize.y;
+        f.color.resize(count);
+        f.linearZ.resize(count);
+        f.motion.resize(count);
+        std::vector<float> z(count);
+        for (uint32_t y = 0; y < renderSize.y; y++)
+        {
+            for (uint32_t x = 0; x < renderSize.x; x++)
+            {
+                uint32_t i = y * renderSize.x + x;
+                glm::vec2 uv = (glm::vec2(float(x), float(y)) + 0.5f + jitter) / glm::vec2(renderSize);
+                f.color[i] = shade(scene, frame, uv, &z[i], &f.motion[i]);
+            }
+        }
+
+        // The depth slope, from the differences across 2x2 quads like ddx() and ddy()
+        for (uint32_t y = 0; y < renderSize.y; y++)
+        {
+            for (uint32_t x = 0; x < renderSize.x; x++)
+            {
+                uint32_t i = y * renderSize.x + x;
+                uint32_t nx = std::min(x ^ 1, renderSize.x - 1), ny = std::min(y ^ 1, renderSize.y - 1);
+                float slope = std::max(std::abs(z[y * renderSize.x + nx] - z[i]), std::abs(z[ny * renderSize.x + x] - z[i]));
+                f.linearZ[i] = glm::vec2(z[i], slope);
+            }
+        }
+        return f;
+    }
+
+    // The image a renderer converges to at the output resolution: 8x8 samples per pixel
+    std::vector<glm::vec3> renderGroundTruth(const Scene& scene, uint32_t frame)
+    {
+        std::vector<glm::vec3> image(kOutputSize.x * kOutputSize.y);
+        for (uint32_t y = 0; y < kOutputSize.y; y++)
+        {
+            for (uint32_t x = 0; x < kOutputSize.x; x++)
+            {
+                glm::vec3 sum = glm::vec3(0.0f);
+                for (uint32_t s = 0; s < 64; s++)
+                {
+                    glm::vec2 uv = (glm::vec2(float(x), float(y)) + (glm::vec2(float(s % 8), float(s / 8)) + 0.5f) / 8.0f) / glm::vec2(kOutputSize);
+                    sum += shade(scene, frame, uv);
+                }
+                image[y * kOutputSize.x + x] = sum / 64.0f;
+            }
+        }
+        return image;
+    }
+
+    // Run the upscaler over frames [0, frameCount), and return the last output
+    std::vector<glm::vec3> runUpscaler(TemporalUpscaleReference* pUpscaler, const Scene& scene, float factor, uint32_t frameCount, uint32_t firstFrame = 0)
+    {
+        glm::uvec2 renderSize = TemporalUpscaleReference::getRenderSize(kOutputSize, factor);
+        auto pJitter = HaltonSamplePattern::create(TemporalUpscaleReference::getJitterSampleCount(factor));
+        for (uint32_t frame = 0; frame < firstFrame; frame++) pJitter->next();
+        std::vector<glm::vec3> output;
+        for (uint32_t frame = firstFrame; frame < firstFrame + frameCount; frame++)
+        {
+            output = pUpscaler->upscale(render(scene, frame, renderSize, pJitter->next()));
+        }
+        return output;
+    }
+
+    // What the pipeline shows without the upscaler: the frame rendered at a lower resolution, stretched
+    std::vector<glm::vec3> runBilinear(const Scene& scene, float factor, uint32_t frame)
+    {
+        glm::uvec2 renderSize = TemporalUpscaleReference::getRenderSize(kOutputSize, factor);
+        return TemporalUpscaleReference::bilinearUpscale(render(scene, frame, renderSize, glm::vec2(0.0f)).color, renderSize, kOutputSize);
+    }
+
+    std::string dB(double value)
+    {
+        return std::to_string(value) + " dB";
+    }
+}
+
+void TemporalUpscaleTest::addTests()
+{
+    addTestToList<TestRenderSizes>();
+    addTestToList<TestStaticConvergence>();
+    addTestToList<TestCameraPan>();
+    addTestToList<TestDisocclusion>();
+    addTestToList<TestNeighborhoodClamp>();
+}
+
+testing_func(TemporalUpscaleTest, TestRenderSizes)
+{
+    // Render sizes round up like ResourceManager's, and jitter cycles grow with the number of output pixels per render pixel
+    const glm::uvec2 kSizes[] = { glm::uvec2(64, 43), glm::uvec2(48, 32), glm::uvec2(32, 22) };
+    const uint32_t kSampleCounts[] = { 18, 32, 72 };
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        if (TemporalUpscaleReference::getRenderSize(kOutputSize, kFactors[i]) != kSizes[i]) return test_fail("Wrong render size at " + std::to_string(kFactors[i]) + "x");
+        if (TemporalUpscaleReference::getJitterSampleCount(kFactors[i]) != kSampleCounts[i]) return test_fail("Wrong jitter sample count at " + std::to_string(kFactors[i]) + "x");
+    }
+    if (TemporalUpscaleReference::getRenderSize(kOutputSize, 1.0f) != kOutputSize) return test_fail("Native rendering isn't at the output size");
+
+    // A flat image stays flat, whatever the jitter, history and motion
+    for (float factor : kFactors)
+    {
+        glm::uvec2 renderSize = TemporalUpscaleReference::getRenderSize(kOutputSize, factor);
+        auto pUpscaler = TemporalUpscaleReference::create(kOutputSize);
+        auto pJitter = HaltonSamplePattern::create(TemporalUpscaleReference::getJitterSampleCount(factor));
+        for (uint32_t frame = 0; frame < 8; frame++)
+        {
+            Frame f;
+            f.renderSize = renderSize;
+            f.jitter = pJitter->next();
+            f.color.assign(renderSize.x * renderSize.y, glm::vec3(0.25f, 0.5f, 1.0f));
+            f.linearZ.assign(renderSize.x * renderSize.y, glm::vec2(5.0f, 0.0f));
+            f.motion.assign(renderSize.x * renderSize.y, glm::vec2(0.01f * float(frame), 0.0f));
+            for (const auto& c : pUpscaler->upscale(f))
+            {
+                glm::vec3 d = c - glm::vec3(0.25f, 0.5f, 1.0f);
+                if (dot(d, d) > 1e-8f) return test_fail("A flat image isn't flat after upscaling");
+            }
+        }
+    }
+    return test_pass();
+}
+
+testing_func(TemporalUpscaleTest, TestStaticConvergence)
+{
+    // Once a jitter cycle has gone by, upscaling beats stretching the frame by a wide margin, and at 1.5x and 2x beats an aliased native render
+    Scene scene;
+    auto groundTruth = renderGroundTruth(scene, 95);
+    double nativePsnr = TemporalUpscaleReference::psnr(runBilinear(scene, 1.0f, 95), groundTruth);
+    auto pNative = TemporalUpscaleReference::create(kOutputSize);
+    double nativeTaaPsnr = TemporalUpscaleReference::psnr(runUpscaler(pNative.get(), scene, 1.0f, 96), groundTruth);
+
+    double prevPsnr = nativeTaaPsnr;
+    for (float factor : kFactors)
+    {
+        auto pUpscaler = TemporalUpscaleReference::create(kOutputSize);
+        double psnr = TemporalUpscaleReference::psnr(runUpscaler(pUpscaler.get(), scene, factor, 96), groundTruth);
+        double bilinearPsnr = TemporalUpscaleReference::psnr(runBilinear(scene, factor, 95), groundTruth);
+        std::string mode = std::to_string(factor) + "x";
+        if (psnr < bilinearPsnr + 4.0) return test_fail(mode + " upscaling has a PSNR of " + dB(psnr) + ", stretching " + dB(bilinearPsnr));
+        if (factor <= 2.0f && psnr < nativePsnr) return test_fail(mode + " upscaling has a PSNR of " + dB(psnr) + ", native rendering " + dB(nativePsnr));
+        if (psnr > prevPsnr) return test_fail(mode + " upscaling is better than a lower factor");
+        prevPsnr = psnr;
+    }
+    return test_pass();
+}
+
+testing_func(TemporalUpscaleTest, TestCameraPan)
+{
+    // The history follows the motion vectors. Resampling it blurs fine details, but it still does better than stretching.
+    Scene scene;
+    scene.pan = glm::vec2(0.37f, 0.21f) / glm::vec2(kOutputSize);
+    auto groundTruth = renderGroundTruth(scene, 95);
+    for (float factor : kFactors)
+    {
+        auto pUpscaler = TemporalUpscaleReference::create(kOutputSize);
+        double psnr = TemporalUpscaleReference::psnr(runUpscaler(pUpscaler.get(), scene, factor, 96), groundTruth);
+        double bilinearPsnr = TemporalUpscaleReference::psnr(runBilinear(scene, factor, 95), groundTruth);
+        if (psnr < bilinearPsnr + 0.5) return test_fail(std::to_string(factor) + "x upscaling of a pan has a PSNR of " + dB(psnr) + ", stretching " + dB(bilinearPsnr));
+    }
+
+    // Whole-pixel motion doesn't blur anything, so a pan converges about as well as a still image
+    scene.pan = glm::vec2(1.0f, 0.0f) / glm::vec2(kOutputSize);
+    auto pStill = TemporalUpscaleReference::create(kOutputSize);
+    auto pPanned = TemporalUpscaleReference::create(kOutputSize);
+    double stillPsnr = TemporalUpscaleReference::psnr(runUpscaler(pStill.get(), Scene(), 2.0f, 96), renderGroundTruth(Scene(), 95));
+    double panPsnr = TemporalUpscaleReference::psnr(runUpscaler(pPanned.get(), scene, 2.0f, 96), renderGroundTruth(scene, 95));
+    if (panPsnr < stillPsnr - 3.0) return test_fail("A pan of whole pixels has a PSNR of " + dB(panPsnr) + ", a still image " + dB(stillPsnr));
+    return test_pass();
+}
+
+testing_func(TemporalUpscaleTest, TestDisocclusion)
+{
+    // A disc stays long enough to fill the history, then jumps away. The background it uncovers doesn't have the depth the history
+    // was rendered at, so the history is dropped there instead of ghosting.
+    Scene before, after;
+    before.discRadius = after.discRadius = 0.25f;
+    before.discStart = glm::vec2(0.3f, 0.5f);
+    after.discStart = glm::vec2(0.75f, 0.5f);
+
+    TemporalUpscaleReference::Settings noDepthTest;
+    noDepthTest.depthTest = false;
+    TemporalUpscaleReference::Settings noRejection = noDepthTest;
+    noRejection.neighborhoodClamp = false;
+    std::vector<TemporalUpscaleReference::SharedPtr> upscalers = { TemporalUpscaleReference::create(kOutputSize),
+        TemporalUpscaleReference::create(kOutputSize, noDepthTest), TemporalUpscaleReference::create(kOutputSize, noRejection) };
+    std::vector<std::vector<glm::vec3>> outputs;
+    for (auto& pUpscaler : upscalers)
+    {
+        runUpscaler(pUpscaler.get(), before, 2.0f, 48);
+        outputs.push_back(runUpscaler(pUpscaler.get(), after, 2.0f, 1, 48));
+    }
+    auto groundTruth = renderGroundTruth(after, 48);
+
+    // Pixels well inside where the disc was
+    const glm::vec2 margin = glm::vec2(4.0f) / glm::vec2(kOutputSize);
+    double weight[3] = {}, error[3] = {};
+    uint32_t uncovered = 0;
+    for (uint32_t y = 0; y < kOutputSize.y; y++)
+    {
+        for (uint32_t x = 0; x < kOutputSize.x; x++)
+        {
+            glm::vec2 uv = (glm::vec2(float(x), float(y)) + 0.5f) / glm::vec2(kOutputSize);
+            bool inside = true;
+            for (uint32_t i = 0; i < 4; i++) inside &= inDisc(before, 0, uv + margin * glm::vec2((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f));
+            if (!inside || inDisc(after, 48, uv)) continue;
+
+            uint32_t index = y * kOutputSize.x + x;
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                glm::vec3 d = glm::abs(outputs[i][index] - groundTruth[index]);
+                error[i] += d.x + d.y + d.z;
+                weight[i] += upscalers[i]->getHistoryWeight()[index];
+            }
+            uncovered++;
+        }
+    }
+    if (uncovered == 0) return test_fail("The disc doesn't uncover anything");
+    if (weight[0] / uncovered > 1.5 || weight[1] / uncovered < 8.0) return test_fail("Uncovered pixels have a weight of " + std::to_string(weight[0] / uncovered) + ", " + std::to_string(weight[1] / uncovered) + " without the depth test");
+    if (error[0] > 0.25 * error[2]) return test_fail("Uncovered pixels ghost: error of " + std::to_string(error[0] / uncovered) + ", " + std::to_string(error[2] / uncovered) + " without rejection");
+    if (error[0] > error[1]) return test_fail("The depth test doesn't help the neighborhood clamp");
+    return test_pass();
+}
+
+testing_func(TemporalUpscaleTest, TestNeighborhoodClamp)
+{
+    // When the lighting changes without anything moving, only the neighborhood clamp stops the history from lagging behind
+    Scene scene;
+    TemporalUpscaleReference::Settings noClamp;
+    noClamp.neighborhoodClamp = false;
+    auto pUpscaler = TemporalUpscaleReference::create(kOutputSize);
+    auto pLagging = TemporalUpscaleReference::create(kOutputSize, noClamp);
+    runUpscaler(pUpscaler.get(), scene, 2.0f, 64);
+    runUpscaler(pLagging.get(), scene, 2.0f, 64);
+
+    scene.brightness = 0.4f;
+    auto output = runUpscaler(pUpscaler.get(), scene, 2.0f, 2, 64);
+    auto lagging = runUpscaler(pLagging.get(), scene, 2.0f, 2, 64);
+    auto groundTruth = renderGroundTruth(scene, 65);
+    double psnr = TemporalUpscaleReference::psnr(output, groundTruth);
+    double laggingPsnr = TemporalUpscaleReference::psnr(lagging, groundTruth);
+    if (psnr < laggingPsnr + 6.0) return test_fail("Two frames after a lighting change, the PSNR is " + dB(psnr) + ", " + dB(laggingPsnr) + " without the clamp");
+    return test_pass();
+}
+
+int main()
+{
+    TemporalUpscaleTest tut;
+    tut.init(false);
+    tut.run();
+    return 0;
+}
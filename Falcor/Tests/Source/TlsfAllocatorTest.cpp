@@ -0,0 +1,313 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TlsfAllocatorTest.h"
+#include "Utils/CpuTimer.h"
+#include <map>
+#include <random>
+
+namespace
+{
+    const uint64_t kCapacity = 256ull << 20;
+    const uint64_t kGranularity = 256;
+
+    /** Tracks the live ranges handed out by an allocator and checks that new ones don't overlap them
+    */
+    class RangeChecker
+    {
+    public:
+        bool add(uint64_t offset, uint64_t size)
+        {
+            auto next = mRanges.lower_bound(offset);
+            if (next != mRanges.end() && next->first < offset + size) return false;
+            if (next != mRanges.begin() && std::prev(next)->second > offset) return false;
+            mRanges[offset] = offset + size;
+            return true;
+        }
+        void remove(uint64_t offset) { mRanges.erase(offset); }
+
+    private:
+        std::map<uint64_t, uint64_t> mRanges;   ///< Offset -> end
+    };
+
+    /** Address-ordered first-fit over a map of free ranges; the simple allocator TLSF replaces
+    */
+    class FirstFitAllocator
+    {
+    public:
+        FirstFitAllocator(uint64_t capacity) { mFree[0] = capacity; }
+
+        uint64_t allocate(uint64_t size, uint64_t alignment)
+        {
+            size = (size + kGranularity - 1) & ~(kGranularity - 1);
+            for (auto it = mFree.begin(); it != mFree.end(); ++it)
+            {
+                uint64_t begin = it->first, end = begin + it->second;
+                uint64_t offset = (begin + alignment - 1) & ~(alignment - 1);
+                if (offset + size > end) continue;
+
+                mFree.erase(it);
+                if (offset > begin) mFree[begin] = offset - begin;
+                if (offset + size < end) mFree[offset + size] = end - offset - size;
+                return offset;
+            }
+            return TlsfAllocator::kInvalidOffset;
+        }
+
+        void release(uint64_t offset, uint64_t size)
+        {
+            size = (size + kGranularity - 1) & ~(kGranularity - 1);
+            auto it = mFree.emplace(offset, size).first;
+            auto next = std::next(it);
+            if (next != mFree.end() && it->first + it->second == next->first)
+            {
+                it->second += next->second;
+                mFree.erase(next);
+            }
+            if (it != mFree.begin())
+            {
+                auto prev = std::prev(it);
+                if (prev->first + prev->second == it->first)
+                {
+                    prev->second += it->second;
+                    mFree.erase(it);
+                }
+            }
+        }
+
+        float fragmentation() const
+        {
+            uint64_t total = 0, largest = 0;
+            for (const auto& range : mFree)
+            {
+                total += range.second;
+                largest = std::max(largest, range.second);
+            }
+            return total ? 1.0f - float(double(largest) / double(total)) : 0.0f;
+        }
+
+    private:
+        std::map<uint64_t, uint64_t> mFree;    ///< Offset -> size
+    };
+
+    /** A stream of resource allocations and releases resembling a streaming scene: mostly small buffers and texture mips
+        with the odd large texture, at the alignments D3D12 placed resources use.
+    */
+    struct Op
+    {
+        bool allocate;
+        uint64_t size;          ///< For allocations
+        uint64_t alignment;
+        uint32_t victim;        ///< For releases, a random pick among the live allocations
+    };
+
+    std::vector<Op> createWorkload(uint32_t opCount, uint32_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        const uint64_t kAlignments[] = { 256, 4096, 65536 };
+        std::vector<Op> ops(opCount);
+        uint32_t liveCount = 0;
+        for (Op& op : ops)
+        {
+            op.allocate = (liveCount == 0) || (rng() % 100 < 52);
+            if (op.allocate)
+            {
+                op.size = 1 + ((rng() % 4) ? rng() % (64 << 10) : rng() % (4 << 20));
+                op.alignment = kAlignments[rng() % 3];
+                liveCount++;
+            }
+            else
+            {
+                op.victim = uint32_t(rng());
+                liveCount--;
+            }
+        }
+        return ops;
+    }
+}
+
+void TlsfAllocatorTest::addTests()
+{
+    addTestToList<TestAllocateRelease>();
+    addTestToList<TestFragmentation>();
+    addTestToList<TestBenchmark>();
+}
+
+testing_func(TlsfAllocatorTest, TestAllocateRelease)
+{
+    TlsfAllocator allocator(1 << 20, kGranularity);
+
+    // Sizes round up to the granularity, offsets honor the alignment
+    TlsfAllocator::Allocation a = allocator.allocate(100);
+    TlsfAllocator::Allocation b = allocator.allocate(5000, 4096);
+    if (!a.isValid() || !b.isValid()) return test_fail("Allocation failed");
+    if (a.size != 256 || b.size != 5120) return test_fail("Sizes are not rounded up to the granularity");
+    if (b.offset % 4096 != 0) return test_fail("Alignment not honored");
+    if (a.offset < b.offset + b.size && b.offset < a.offset + a.size) return test_fail("Allocations overlap");
+
+    // Requests that can't fit fail cleanly, without changing anything
+    uint64_t used = allocator.getUsedBytes();
+    if (allocator.allocate(2 << 20).isValid()) return test_fail("An allocation larger than the capacity succeeded");
+    if (allocator.getUsedBytes() != used || allocator.getAllocationCount() != 2) return test_fail("A failed allocation changed the usage");
+
+    // Filling the range exactly works, and releasing everything merges it back into one block
+    allocator.release(a);
+    allocator.release(b);
+    if (!allocator.isEmpty() || allocator.getStats().freeBlockCount != 1) return test_fail("Released blocks were not merged");
+    std::vector<TlsfAllocator::Allocation> all;
+    for (uint32_t i = 0; i < 16; i++) all.push_back(allocator.allocate(64 << 10));
+    for (const auto& alloc : all) if (!alloc.isValid()) return test_fail("Couldn't fill the whole range");
+    if (allocator.allocate(1).isValid()) return test_fail("Allocated from a full range");
+
+    // Free every other block, then the rest: the holes can't hold a bigger block until their neighbors are gone
+    for (uint32_t i = 0; i < 16; i += 2) allocator.release(all[i]);
+    if (allocator.allocate(128 << 10).isValid()) return test_fail("Allocated across a live block");
+    if (allocator.getStats().freeBlockCount != 8) return test_fail("Expected 8 free holes");
+    for (uint32_t i = 1; i < 16; i += 2) allocator.release(all[i]);
+    TlsfAllocator::Stats stats = allocator.getStats();
+    if (stats.freeBlockCount != 1 || stats.largestFreeBlock != (1 << 20) || stats.fragmentation() != 0.0f) return test_fail("The range didn't coalesce");
+    return test_pass();
+}
+
+testing_func(TlsfAllocatorTest, TestFragmentation)
+{
+    // Churn through a long mixed workload, checking every allocation, and compare how fragmented the free space ends up
+    //     against address-ordered first fit (which is known to fragment well, but is O(free blocks) per allocation)
+    const std::vector<Op> ops = createWorkload(200000, 1);
+    TlsfAllocator tlsf(kCapacity, kGranularity);
+    FirstFitAllocator firstFit(kCapacity);
+    RangeChecker ranges;
+    std::vector<TlsfAllocator::Allocation> live;
+    std::vector<std::pair<uint64_t, uint64_t>> firstFitLive;
+    uint32_t tlsfFailures = 0, firstFitFailures = 0;
+    float tlsfFragmentation = 0.0f, firstFitFragmentation = 0.0f;
+    uint32_t samples = 0;
+
+    for (uint32_t i = 0; i < uint32_t(ops.size()); i++)
+    {
+        const Op& op = ops[i];
+        if (op.allocate)
+        {
+            TlsfAllocator::Allocation alloc = tlsf.allocate(op.size, op.alignment);
+            if (alloc.isValid())
+            {
+                if (alloc.offset % op.alignment || alloc.size < op.size || alloc.offset + alloc.size > kCapacity) return test_fail("Bad allocation at op " + std::to_string(i));
+                if (!ranges.add(alloc.offset, alloc.size)) return test_fail("Overlapping allocation at op " + std::to_string(i));
+                live.push_back(alloc);
+            }
+            else tlsfFailures++;
+
+            uint64_t offset = firstFit.allocate(op.size, op.alignment);
+            if (offset != TlsfAllocator::kInvalidOffset) firstFitLive.push_back({ offset, op.size });
+            else firstFitFailures++;
+        }
+        else
+        {
+            if (live.size())
+            {
+                size_t k = op.victim % live.size();
+                ranges.remove(live[k].offset);
+                tlsf.release(live[k]);
+                live[k] = live.back();
+                live.pop_back();
+            }
+            if (firstFitLive.size())
+            {
+                size_t k = op.victim % firstFitLive.size();
+                firstFit.release(firstFitLive[k].first, firstFitLive[k].second);
+                firstFitLive[k] = firstFitLive.back();
+                firstFitLive.pop_back();
+            }
+        }
+
+        if (i % 1000 == 999)
+        {
+            tlsfFragmentation += tlsf.getStats().fragmentation();
+            firstFitFragmentation += firstFit.fragmentation();
+            samples++;
+        }
+    }
+    tlsfFragmentation /= float(samples);
+    firstFitFragmentation /= float(samples);
+
+    TlsfAllocator::Stats stats = tlsf.getStats();
+    logInfo("TlsfAllocator, " + std::to_string(ops.size()) + " ops over " + std::to_string(kCapacity >> 20) + " MB: mean fragmentation " + std::to_string(tlsfFragmentation) +
+        " (first fit " + std::to_string(firstFitFragmentation) + "), failed allocations " + std::to_string(tlsfFailures) + " (first fit " + std::to_string(firstFitFailures) +
+        "), " + std::to_string(stats.allocationCount) + " live in " + std::to_string(stats.usedBytes >> 20) + " MB with " + std::to_string(stats.freeBlockCount) + " free blocks");
+
+    if (stats.usedBytes + stats.freeBytes != kCapacity) return test_fail("Used and free bytes don't add up to the capacity");
+    if (tlsfFailures > firstFitFailures + firstFitFailures / 4 + 10) return test_fail("TLSF fails far more allocations than first fit");
+
+    for (const auto& alloc : live) tlsf.release(alloc);
+    stats = tlsf.getStats();
+    if (!tlsf.isEmpty() || stats.freeBlockCount != 1 || stats.freeBytes != kCapacity) return test_fail("The heap didn't coalesce after releasing everything");
+    return test_pass();
+}
+
+testing_func(TlsfAllocatorTest, TestBenchmark)
+{
+    const std::vector<Op> ops = createWorkload(2000000, 2);
+
+    auto run = [&](auto allocate, auto release, auto& live)
+    {
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        for (const Op& op : ops)
+        {
+            if (op.allocate) allocate(op);
+            else if (live.size())
+            {
+                size_t k = op.victim % live.size();
+                release(live[k]);
+                live[k] = live.back();
+                live.pop_back();
+            }
+        }
+        return double(ops.size()) / CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) * 1e-3;
+    };
+
+    TlsfAllocator tlsf(kCapacity, kGranularity);
+    std::vector<TlsfAllocator::Allocation> tlsfLive;
+    double tlsfRate = run([&](const Op& op) { auto alloc = tlsf.allocate(op.size, op.alignment); if (alloc.isValid()) tlsfLive.push_back(alloc); },
+        [&](const TlsfAllocator::Allocation& alloc) { tlsf.release(alloc); }, tlsfLive);
+
+    FirstFitAllocator firstFit(kCapacity);
+    std::vector<std::pair<uint64_t, uint64_t>> firstFitLive;
+    double firstFitRate = run([&](const Op& op) { uint64_t offset = firstFit.allocate(op.size, op.alignment); if (offset != TlsfAllocator::kInvalidOffset) firstFitLive.push_back({ offset, op.size }); },
+        [&](const std::pair<uint64_t, uint64_t>& alloc) { firstFit.release(alloc.first, alloc.second); }, firstFitLive);
+
+    logInfo("TlsfAllocator, " + std::to_string(ops.size()) + " ops: TLSF " + std::to_string(tlsfRate) + " Mops/s, first fit " + std::to_string(firstFitRate) + " Mops/s");
+    if (tlsfRate <= firstFitRate) return test_fail("TLSF is slower than first fit");
+    return test_pass();
+}
+
+int main()
+{
+    TlsfAllocatorTest tat;
+    tat.init(false);
+    tat.run();
+    return 0;
+}
@@ -46,6 +46,7 @@ shared Texture2D<float4>   gSpecMatl;
 shared Texture2D<float4>   gExtraMatl;
 shared Texture2D<float4>   gEnvMap;
 shared Texture2D<float4>   gEmissive;
+shared Buffer<uint>        gSobolDirections;   // For the samplers of LowDiscrepancy.slang
 shared RWTexture2D<float4> gOutput;
 
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
@@ -110,8 +111,7 @@ void SimpleDiffuseGIRayGen()
 	// Initialize our random number generator
 	//uint randSeed        = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
 
-	HaltonState hState;
-	haltonInit(hState, launchIndex.x, launchIndex.y, 1, 1, gFrameCount, 1);
+	LowDiscrepancySequence samples = initLowDiscrepancySequence(LD_SEQUENCE_SOBOL, gFrameCount, ldPixelSeed(launchIndex));
 	uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
 
 	// Do shading, if we have geoemtry here (otherwise, output the background color)
@@ -123,12 +123,12 @@ void SimpleDiffuseGIRayGen()
 		// (Optionally) do explicit direct lighting to a random light in the scene
 		float3 directColor;
 		if (gDoDirectGI)
-			shadeColor += ggxDirect(randSeed, hState, worldPos.xyz, worldNorm.xyz, V,
+			shadeColor += ggxDirect(randSeed, samples, worldPos.xyz, worldNorm.xyz, V,
 				                   difMatlColor.rgb, specMatlColor.rgb, roughness);
 
 		// (Optionally) do indirect lighting for global illumination
 		if (gDoIndirectGI && (gMaxDepth > 0))
-			shadeColor += ggxIndirect(randSeed, hState, worldPos.xyz, worldNorm.xyz, noMapN,
+			shadeColor += ggxIndirect(randSeed, samples, worldPos.xyz, worldNorm.xyz, noMapN,
 				                      V, difMatlColor.rgb, specMatlColor.rgb, roughness, 0, gInverseRoughness);
 	}
 	
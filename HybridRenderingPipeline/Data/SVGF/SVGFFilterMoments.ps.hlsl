@@ -38,6 +38,7 @@ cbuffer PerImageCB
 {
     float       gPhiColor;
     float       gPhiNormal;
+    int2        gRenderDim;         // Pixels rendered this frame (the top-left part of the textures)
 };
 
 float4 main(FullScreenPassVsOut vsOut) : SV_TARGET0
@@ -46,7 +47,7 @@ float4 main(FullScreenPassVsOut vsOut) : SV_TARGET0
     int2 ipos = int2(posH.xy);
 
     float h = gHistoryLength[ipos].x;
-    int2 screenSize = getTextureDims(gHistoryLength, 0);
+    int2 screenSize = gRenderDim;
 
     if (h < 4.0) // not enough temporal history available
     {
@@ -39,6 +39,7 @@ cbuffer PerImageCB
     int         gStepSize;
     float       gPhiColor;
     float       gPhiNormal;
+    int2        gRenderDim;         // Pixels rendered this frame (the top-left part of the textures)
 };
 
 // computes a 3x3 gaussian blur of the variance, centered around
@@ -69,7 +70,7 @@ float computeVarianceCenter(int2 ipos)
 float4 main(FullScreenPassVsOut vsOut) : SV_TARGET0
 {
     const int2 ipos       = int2(vsOut.posH.xy);
-    const int2 screenSize = getTextureDims(gIllumination, 0);
+    const int2 screenSize = gRenderDim;
 
     const float epsVariance      = 1e-10;
     const float kernelWeights[3] = { 1.0, 2.0 / 3.0, 1.0 / 6.0 };
@@ -37,8 +37,7 @@ bool isNaN(float f)
 }
 
 Texture2D   gMotionAndFWidth;
-Texture2D   gShadow;
-Texture2D   gAO;
+Texture2D   gVisibility;      // Light visibility in .r, ambient occlusion in .g
 Texture2D   gPrevIllum;
 Texture2D   gPrevMoments;
 Texture2D   gLinearZAndNormal;
@@ -49,6 +48,8 @@ cbuffer PerImageCB
 {
     float       gAlpha;
     float       gMomentsAlpha;
+    int2        gRenderDim;         // Pixels rendered this frame (the top-left part of the textures, see ResourceManager::getRenderSize())
+    int2        gPrevRenderDim;     // Pixels rendered last frame, which the history covers
 };
 
 float3 demodulate(float3 c, float3 albedo)
@@ -58,7 +59,7 @@ float3 demodulate(float3 c, float3 albedo)
 
 bool isReprjValid(int2 coord, float Z, float Zprev, float fwidthZ, float3 normal, float3 normalPrev, float fwidthNormal)
 {
-    const int2 imageDim = getTextureDims(gShadow, 0);
+    const int2 imageDim = gPrevRenderDim;
 
     // check whether reprojected pixel is inside of the screen
     if (any(coord < int2(1, 1)) || any(coord > imageDim - int2(1, 1))) return false;
@@ -75,13 +76,14 @@ bool isReprjValid(int2 coord, float Z, float Zprev, float fwidthZ, float3 normal
 bool loadPrevData(float2 posH, out float4 prevIllum, out float2 prevMoments, out float historyLength)
 {
     const int2 ipos = posH;
-    const float2 imageDim = float2(getTextureDims(gShadow, 0));
 
     const float2 motion = gMotionAndFWidth[ipos].xy;
     const float normalFwidth = gMotionAndFWidth[ipos].w;
 
-    // +0.5 to account for texel center offset
-    const int2 iposPrev = int2(float2(ipos)+motion.xy * imageDim + float2(0.5, 0.5));
+    // Motion is in UVs, so the previous position is found in last frame's render size, which can differ from this frame's.
+    //    +0.5 to account for texel center offset
+    const float2 posPrevCenter = ((float2(ipos) + 0.5) / float2(gRenderDim) + motion.xy) * float2(gPrevRenderDim);
+    const int2 iposPrev = int2(posPrevCenter);
 
     float2 depth = gLinearZAndNormal[ipos].xy;
     float3 normal = oct_to_ndir_snorm(gLinearZAndNormal[ipos].zw);
@@ -90,7 +92,7 @@ bool loadPrevData(float2 posH, out float4 prevIllum, out float2 prevMoments, out
     prevMoments = float2(0, 0);
 
     bool v[4];
-    const float2 posPrev = floor(posH.xy) + motion.xy * imageDim;
+    const float2 posPrev = posPrevCenter - float2(0.5, 0.5);
     const int2 offset[4] = { int2(0, 0), int2(1, 0), int2(0, 1), int2(1, 1) };
 
     // check for all 4 taps of the bilinear filter for validity
@@ -201,7 +203,8 @@ PS_OUT main(FullScreenPassVsOut vsOut)
     const int2 ipos = posH.xy;
 
     //float3 illumination = demodulate(gColor[ipos].rgb - gEmission[ipos].rgb, gAlbedo[ipos].rgb);
-    float3 illumination = float3(gShadow[ipos].r * gAO[ipos].r);
+    const float2 visibility = gVisibility[ipos].rg;
+    float3 illumination = float3(visibility.r * visibility.g);
 
     // Workaround path tracer bugs. TODO: remove this when we can.
     if (isNaN(illumination.x) || isNaN(illumination.y) || isNaN(illumination.z))
@@ -16,18 +16,8 @@
 # ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **********************************************************************************************************************/
 
-#define PI 3.1415926
-
-// Utility function to get a vector perpendicular to an input vector 
-//    (from "Efficient Construction of Perpendicular Vectors Without Branching")
-float3 getPerpendicularVector(float3 u)
-{
-	float3 a = abs(u);
-	uint xm = ((a.x - a.y)<0 && (a.x - a.z)<0) ? 1 : 0;
-	uint ym = (a.y - a.z)<0 ? (1 ^ xm) : 0;
-	uint zm = 1 ^ (xm | ym);
-	return cross(u, float3(xm, ym, zm));
-}
+// The purely math-based helpers (random numbers, GGX sampling) live in their own file so compute shaders can use them
+#include "samplingUtils.hlsli"
 
 void getLightData(in int index, in float3 hitPos, out float3 toLight, out float3 lightIntensity, out float distToLight)
 {
@@ -49,28 +39,6 @@ void getLightData(in int index, in float3 hitPos, out float3 toLight, out float3
 	distToLight = length(ls.posW - hitPos);
 }
 
-// Generates a seed for a random number generator from 2 inputs plus a backoff
-uint initRand(uint val0, uint val1, uint backoff = 16)
-{
-	uint v0 = val0, v1 = val1, s0 = 0;
-
-	[unroll]
-	for (uint n = 0; n < backoff; n++)
-	{
-		s0 += 0x9e3779b9;
-		v0 += ((v1 << 4) + 0xa341316c) ^ (v1 + s0) ^ ((v1 >> 5) + 0xc8013ea4);
-		v1 += ((v0 << 4) + 0xad90777d) ^ (v0 + s0) ^ ((v0 >> 5) + 0x7e95761e);
-	}
-	return v0;
-}
-
-// Takes our seed, updates it, and returns a pseudorandom float in [0..1]
-float nextRand(inout uint s)
-{
-	s = (1664525u * s + 1013904223u);
-	return float(s & 0x00FFFFFF) / float(0x01000000);
-}
-
 float3 getCosHemisphereSample(inout uint randSeed, float3 hitNorm)
 {
 	// Get 2 random numbers to select our sample with
@@ -145,29 +113,6 @@ float ggxSchlickMaskingTerm(float NdotL, float NdotV, float roughness)
 	return g_v * g_l;
 }
 
-float3 getGGXMicrofacet(float2 Xi, float3 N, float roughness)
-{
-	float a = roughness * roughness;
-
-	float phi = 2.0 * PI * Xi.x;
-	float cosTheta = sqrt((1.0 - Xi.y) / (1.0 + (a * a - 1.0) * Xi.y));
-	float sinTheta = sqrt(1.0 - cosTheta * cosTheta);
-
-	// from spherical coordinates to cartesian coordinates
-	float3 H;
-	H.x = cos(phi) * sinTheta;
-	H.y = sin(phi) * sinTheta;
-	H.z = cosTheta;
-
-	// from tangent-space vector to world-space sample vector
-	float3 up = abs(N.z) < 0.999 ? float3(0.0, 0.0, 1.0) : float3(1.0, 0.0, 0.0);
-	float3 tangent = normalize(cross(up, N));
-	float3 bitangent = cross(N, tangent);
-
-	float3 sampleVec = tangent * H.x + bitangent * H.y + N * H.z;
-	return normalize(sampleVec);
-}
-
 // Our material has have both a diffuse and a specular lobe.  
 //     With what probability should we sample the diffuse one?
 float probabilityToSampleDiffuse(float3 difColor, float3 specColor)
@@ -0,0 +1,169 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Probe grid shared by the DDGI shaders (see DDGIPass.h).  Each probe stores, in an octahedral tile of its own:
+//     -> irradiance: the cosine-weighted average radiance around each direction (i.e., irradiance / pi)
+//     -> distance: the mean and mean squared distance to the nearest surface around each direction
+//     Tiles have a one texel border copied from the opposite side of the octahedron, so bilinear lookups wrap properly.
+//     Must match DDGIPass.cpp.
+
+import MathHelpers;                    // ndir_to_oct_snorm(), oct_to_ndir_snorm()
+
+// Interior texels along each side of a probe's tile (the border is not included)
+#define DDGI_IRRADIANCE_TEXELS  8
+#define DDGI_DISTANCE_TEXELS    16
+
+cbuffer DDGICB
+{
+	float4x4 gRayRotation;     // Random rotation of this frame's probe rays
+	float3   gProbeOrigin;     // Position of probe (0, 0, 0)
+	float    gNormalBias;      // Offset along the normal before sampling, relative to the smallest probe spacing
+	float3   gProbeSpacing;    // Distance between neighboring probes along each axis
+	float    gViewBias;        // Offset towards the viewer before sampling, relative to the smallest probe spacing
+	int3     gProbeCounts;     // Probes along each axis
+	float    gMaxRayDistance;  // Probe rays stop after this distance
+	uint     gProbeOffset;     // First probe updated this frame; the updated subset rotates through the grid
+	uint     gProbesPerFrame;  // Number of probes updated this frame
+	uint     gRaysPerProbe;
+	float    gHysteresis;      // Weight of the old probe texels when blending in this frame's rays
+}
+
+uint ddgiProbeCount()
+{
+	return uint(gProbeCounts.x * gProbeCounts.y * gProbeCounts.z);
+}
+
+int3 ddgiProbeCoords(uint probeIndex)
+{
+	int i = int(probeIndex);
+	return int3(i % gProbeCounts.x, (i / gProbeCounts.x) % gProbeCounts.y, i / (gProbeCounts.x * gProbeCounts.y));
+}
+
+float3 ddgiProbePosition(int3 probe)
+{
+	return gProbeOrigin + float3(probe) * gProbeSpacing;
+}
+
+// The probe updated by the <slot>-th row of this frame's rays
+uint ddgiUpdatedProbe(uint slot)
+{
+	return (gProbeOffset + slot) % ddgiProbeCount();
+}
+
+// Probe tiles are laid out with x and z side by side along the atlas' width, and y along its height
+uint2 ddgiProbeTile(int3 probe)
+{
+	return uint2(probe.x + gProbeCounts.x * probe.z, probe.y);
+}
+
+// Direction of each probe ray: a spherical Fibonacci set, randomly rotated every frame so probes see new directions
+float3 ddgiRayDirection(uint rayIndex)
+{
+	const float goldenAngle = 2.39996323f;
+	float z = 1.0f - (2.0f * float(rayIndex) + 1.0f) / float(gRaysPerProbe);
+	float r = sqrt(saturate(1.0f - z * z));
+	float phi = goldenAngle * float(rayIndex);
+	float3 dir = float3(r * cos(phi), r * sin(phi), z);
+	return normalize(mul(gRayRotation, float4(dir, 0.0f)).xyz);
+}
+
+// Direction stored by a texel of a probe's tile, including its border.  <texel> is in [0, interiorTexels + 2)^2.
+float3 ddgiTexelDirection(uint2 texel, uint interiorTexels)
+{
+	int n = int(interiorTexels);
+	int2 t = int2(texel) - int2(1, 1);
+	bool2 outside = bool2(t.x < 0 || t.x >= n, t.y < 0 || t.y >= n);
+
+	// Crossing an edge of the octahedral map mirrors the position along that edge.  Corners wrap to the opposite corner.
+	if (outside.x && outside.y) t = int2(t.x < 0 ? n - 1 : 0, t.y < 0 ? n - 1 : 0);
+	else if (outside.x)         t = int2(clamp(t.x, 0, n - 1), n - 1 - t.y);
+	else if (outside.y)         t = int2(n - 1 - t.x, clamp(t.y, 0, n - 1));
+
+	return oct_to_ndir_snorm((float2(t) + 0.5f) / float(n) * 2.0f - 1.0f);
+}
+
+// Texture coordinate in an atlas for looking up direction <dir> of a probe
+float2 ddgiAtlasUV(int3 probe, float3 dir, uint interiorTexels, float2 atlasSize)
+{
+	float2 tileOrigin = float2(ddgiProbeTile(probe) * (interiorTexels + 2) + 1);
+	float2 oct = ndir_to_oct_snorm(dir) * 0.5f + 0.5f;
+	return (tileOrigin + oct * float(interiorTexels)) / atlasSize;
+}
+
+// Irradiance (divided by pi) at a surface, interpolated from the 8 probes around it.  Besides the trilinear weights,
+//     probes get less weight when they are behind the surface, or when their distance moments suggest something
+//     occludes them from the surface (a Chebyshev test, as in variance shadow maps).  Probes that were never updated
+//     (alpha 0 in the irradiance atlas) are ignored.
+float3 ddgiIrradiance(float3 posW, float3 N, float3 V, Texture2D<float4> irradianceAtlas, Texture2D<float2> distanceAtlas,
+                      SamplerState linearSampler)
+{
+	float2 irradianceSize, distanceSize;
+	irradianceAtlas.GetDimensions(irradianceSize.x, irradianceSize.y);
+	distanceAtlas.GetDimensions(distanceSize.x, distanceSize.y);
+
+	// Move the lookup away from the surface, so the visibility test doesn't see the surface itself
+	float minSpacing = min(gProbeSpacing.x, min(gProbeSpacing.y, gProbeSpacing.z));
+	float3 biasedPos = posW + (gNormalBias * N + gViewBias * V) * minSpacing;
+
+	int3 baseProbe = clamp(int3(floor((biasedPos - gProbeOrigin) / gProbeSpacing)), int3(0, 0, 0), gProbeCounts - 1);
+	float3 alpha = saturate((biasedPos - ddgiProbePosition(baseProbe)) / gProbeSpacing);
+
+	float3 irradianceSum = float3(0.0f, 0.0f, 0.0f);
+	float weightSum = 0.0f;
+	[unroll]
+	for (uint i = 0; i < 8; i++)
+	{
+		int3 offset = int3(i, i >> 1, i >> 2) & 1;
+		int3 probe = min(baseProbe + offset, gProbeCounts - 1);
+		float3 probePos = ddgiProbePosition(probe);
+
+		// Smooth backface test
+		float3 toProbe = normalize(probePos - posW);
+		float wrap = (dot(toProbe, N) + 1.0f) * 0.5f;
+		float weight = wrap * wrap + 0.2f;
+
+		// Chebyshev visibility test
+		float3 probeToPoint = biasedPos - probePos;
+		float dist = length(probeToPoint);
+		float2 moments = distanceAtlas.SampleLevel(linearSampler,
+			ddgiAtlasUV(probe, probeToPoint / max(dist, 1e-4f), DDGI_DISTANCE_TEXELS, distanceSize), 0.0f);
+		if (dist > moments.x)
+		{
+			float variance = abs(moments.y - moments.x * moments.x);
+			float d = dist - moments.x;
+			float chebyshev = variance / (variance + d * d);
+			weight *= chebyshev * chebyshev * chebyshev;
+		}
+
+		// Crush tiny weights, so light leaking through thin occluders fades out
+		weight = max(weight, 1e-6f);
+		const float crushThreshold = 0.2f;
+		if (weight < crushThreshold) weight *= weight * weight / (crushThreshold * crushThreshold);
+
+		float3 trilinear = lerp(1.0f - alpha, alpha, float3(offset));
+		weight *= trilinear.x * trilinear.y * trilinear.z;
+
+		float4 irradiance = irradianceAtlas.SampleLevel(linearSampler,
+			ddgiAtlasUV(probe, N, DDGI_IRRADIANCE_TEXELS, irradianceSize), 0.0f);
+		weight *= irradiance.a;
+
+		irradianceSum += weight * irradiance.rgb;
+		weightSum += weight;
+	}
+	return (weightSum > 0.0f) ? irradianceSum / weightSum : float3(0.0f, 0.0f, 0.0f);
+}
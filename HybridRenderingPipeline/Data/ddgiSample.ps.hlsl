@@ -0,0 +1,48 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Looks up the probes' irradiance for each pixel of the G-buffer and returns the diffuse light it reflects
+
+#include "ddgiCommon.hlsli"
+
+cbuffer PerFrameCB
+{
+	float3 gCameraPos;
+	float  gIntensity;       // Scales the indirect light
+}
+
+Texture2D<float4>   gPos;               // G-buffer world-space position
+Texture2D<float4>   gNorm;              // G-buffer world-space normal
+Texture2D<float4>   gDiffuseMatl;       // G-buffer diffuse material (RGB) and opacity (A)
+Texture2D<float4>   gIrradianceAtlas;
+Texture2D<float2>   gDistanceAtlas;
+SamplerState        gLinearSampler;
+
+float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
+{
+	uint2 pixelPos = (uint2)pos.xy;
+	float4 worldPos = gPos[pixelPos];
+
+	// Our camera sees the background if worldPos.w is 0.  There is nothing to light.
+	if (worldPos.w == 0.0f) return float4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	float3 N = gNorm[pixelPos].xyz;
+	float3 V = normalize(gCameraPos - worldPos.xyz);
+	float3 irradiance = ddgiIrradiance(worldPos.xyz, N, V, gIrradianceAtlas, gDistanceAtlas, gLinearSampler);
+	return float4(gIntensity * gDiffuseMatl[pixelPos].rgb * irradiance, 1.0f);
+}
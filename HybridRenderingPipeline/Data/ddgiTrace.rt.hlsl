@@ -0,0 +1,142 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Traces this frame's probe rays.  Each row of the launch is one updated probe and each column one of its rays.  We
+//     write the radiance leaving the closest hit towards the probe (emission, one shadowed light picked at random, and
+//     the light the probes gathered last frame for further bounces) and the hit distance, which ddgiUpdate.cs.hlsl
+//     blends into the probe atlases.
+
+#include "HostDeviceSharedMacros.h"
+#include "HostDeviceData.h"
+
+// Include and import common Falcor utilities and data structures
+import Raytracing;
+import ShaderCommon;
+import Shading;                      // Shading functions, etc
+import Lights;                       // Light structures for our current scene
+
+#include "commonUtils.hlsli"
+#include "ddgiCommon.hlsli"
+
+cbuffer RayGenCB
+{
+	float3 gSkyRadiance;     // Radiance of rays leaving the scene
+	float  gMinT;            // Min distance to start a ray to avoid self-occlusion
+	uint   gFrameCount;      // Frame counter, used to perturb random seed each frame
+}
+
+Texture2D<float4>   gIrradianceAtlas;   // Last frame's probes, for multiple bounces
+Texture2D<float2>   gDistanceAtlas;
+SamplerState        gLinearSampler;
+RWTexture2D<float4> gRayRadiance;       // Radiance (rgb) and hit distance (a) of each ray; distance < 0 on back faces
+
+// The closest hit hands its surface back to the ray generation shader, which does the shading
+struct ProbeRayPayload
+{
+	float3 posW;
+	float  hitT;             // Negative if the ray missed
+	float3 N;
+	uint   backFace;
+	float3 diffuse;
+	float3 emissive;
+};
+
+#include "standardShadowRay.hlsli"
+
+[shader("miss")]
+void ProbeMiss(inout ProbeRayPayload rayData)
+{
+	rayData.hitT = -1.0f;
+}
+
+[shader("anyhit")]
+void ProbeAnyHit(inout ProbeRayPayload rayData, BuiltInTriangleIntersectionAttributes attribs)
+{
+	// Is this a transparent part of the surface?  If so, ignore this hit
+	if (alphaTestFails(attribs))
+		IgnoreHit();
+}
+
+[shader("closesthit")]
+void ProbeClosestHit(inout ProbeRayPayload rayData, BuiltInTriangleIntersectionAttributes attribs)
+{
+	ShadingData shadeData = getShadingData(PrimitiveIndex(), attribs);
+	rayData.posW = shadeData.posW;
+	rayData.hitT = RayTCurrent();
+	rayData.N = shadeData.N;
+	rayData.backFace = (dot(shadeData.N, WorldRayDirection()) > 0.0f) ? 1 : 0;
+	rayData.diffuse = shadeData.diffuse;
+	rayData.emissive = shadeData.emissive;
+}
+
+[shader("raygeneration")]
+void ProbeRayGen()
+{
+	uint2 launchIndex = DispatchRaysIndex().xy;
+	uint rayIndex = launchIndex.x;
+	int3 probe = ddgiProbeCoords(ddgiUpdatedProbe(launchIndex.y));
+
+	RayDesc ray;
+	ray.Origin = ddgiProbePosition(probe);
+	ray.Direction = ddgiRayDirection(rayIndex);
+	ray.TMin = 0.0f;
+	ray.TMax = gMaxRayDistance;
+
+	ProbeRayPayload payload;
+	payload.hitT = -1.0f;
+	payload.backFace = 0;
+	TraceRay(gRtScene, RAY_FLAG_NONE, 0xFF, 0, hitProgramCount, 0, ray, payload);
+
+	if (payload.hitT < 0.0f)
+	{
+		gRayRadiance[launchIndex] = float4(gSkyRadiance, gMaxRayDistance);
+		return;
+	}
+
+	// Rays hitting back faces started inside geometry.  We store a short negative distance, so the probe's visibility
+	//     test mostly rejects it, and no light.
+	if (payload.backFace != 0)
+	{
+		gRayRadiance[launchIndex] = float4(0.0f, 0.0f, 0.0f, -0.2f * payload.hitT);
+		return;
+	}
+
+	float3 radiance = payload.emissive;
+	if (gLightsCount > 0)
+	{
+		uint randSeed = initRand(launchIndex.x + launchIndex.y * DispatchRaysDimensions().x, gFrameCount, 16);
+		int lightToSample = min(int(nextRand(randSeed) * gLightsCount), gLightsCount - 1);
+
+		float distToLight;
+		float3 lightIntensity;
+		float3 L;
+		getLightData(lightToSample, payload.posW, L, lightIntensity, distToLight);
+		float NdotL = saturate(dot(payload.N, L));
+		if (NdotL > 0.0f)
+		{
+			float visibility = shadowRayVisibility(payload.posW, L, gMinT, distToLight);
+			radiance += float(gLightsCount) * visibility * NdotL * lightIntensity * payload.diffuse / PI;
+		}
+	}
+
+	// Light from further bounces, as seen by last frame's probes
+	float3 irradiance = ddgiIrradiance(payload.posW, payload.N, -ray.Direction, gIrradianceAtlas, gDistanceAtlas, gLinearSampler);
+	radiance += payload.diffuse * irradiance;
+
+	gRayRadiance[launchIndex] = float4(radiance, payload.hitT);
+}
@@ -0,0 +1,87 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Blends this frame's probe rays (from ddgiTrace.rt.hlsl) into the probe atlases.  One thread per texel of each
+//     updated probe's tile, border included: border texels compute the same value as the interior texel they mirror.
+
+#include "ddgiCommon.hlsli"
+
+cbuffer UpdateCB
+{
+	uint gUpdatesSinceReset;   // Probes updated since the atlases were cleared (saturates at the probe count)
+}
+
+Texture2D<float4>   gRayRadiance;       // One row per updated probe: radiance (rgb) and hit distance (a) of each ray
+RWTexture2D<float4> gIrradianceAtlas;
+RWTexture2D<float2> gDistanceAtlas;
+
+// Sharpness of the distance filter; irradiance uses a plain cosine lobe
+static const float kDistanceExponent = 50.0f;
+
+// A probe's first update replaces the cleared atlas instead of blending with it
+float getHysteresis(uint slot)
+{
+	return (gUpdatesSinceReset + slot < ddgiProbeCount()) ? 0.0f : gHysteresis;
+}
+
+[numthreads(8, 8, 1)]
+void UpdateIrradiance(uint3 threadId : SV_DispatchThreadID)
+{
+	const uint tileSize = DDGI_IRRADIANCE_TEXELS + 2;
+	uint slot = threadId.z;
+	if (any(threadId.xy >= tileSize) || slot >= gProbesPerFrame) return;
+
+	float3 texelDir = ddgiTexelDirection(threadId.xy, DDGI_IRRADIANCE_TEXELS);
+	float3 radianceSum = float3(0.0f, 0.0f, 0.0f);
+	float weightSum = 0.0f;
+	for (uint i = 0; i < gRaysPerProbe; i++)
+	{
+		float weight = saturate(dot(texelDir, ddgiRayDirection(i)));
+		radianceSum += weight * gRayRadiance[uint2(i, slot)].rgb;
+		weightSum += weight;
+	}
+	float3 irradiance = (weightSum > 0.0f) ? radianceSum / weightSum : float3(0.0f, 0.0f, 0.0f);
+
+	uint2 atlasTexel = ddgiProbeTile(ddgiProbeCoords(ddgiUpdatedProbe(slot))) * tileSize + threadId.xy;
+	float3 oldIrradiance = gIrradianceAtlas[atlasTexel].rgb;
+	gIrradianceAtlas[atlasTexel] = float4(lerp(irradiance, oldIrradiance, getHysteresis(slot)), 1.0f);
+}
+
+[numthreads(8, 8, 1)]
+void UpdateDistance(uint3 threadId : SV_DispatchThreadID)
+{
+	const uint tileSize = DDGI_DISTANCE_TEXELS + 2;
+	uint slot = threadId.z;
+	if (any(threadId.xy >= tileSize) || slot >= gProbesPerFrame) return;
+
+	float3 texelDir = ddgiTexelDirection(threadId.xy, DDGI_DISTANCE_TEXELS);
+	float2 momentSum = float2(0.0f, 0.0f);
+	float weightSum = 0.0f;
+	for (uint i = 0; i < gRaysPerProbe; i++)
+	{
+		float weight = pow(saturate(dot(texelDir, ddgiRayDirection(i))), kDistanceExponent);
+		float dist = min(abs(gRayRadiance[uint2(i, slot)].a), gMaxRayDistance);
+		momentSum += weight * float2(dist, dist * dist);
+		weightSum += weight;
+	}
+	float2 moments = (weightSum > 0.0f) ? momentSum / weightSum : float2(gMaxRayDistance, gMaxRayDistance * gMaxRayDistance);
+
+	uint2 atlasTexel = ddgiProbeTile(ddgiProbeCoords(ddgiUpdatedProbe(slot))) * tileSize + threadId.xy;
+	float2 oldMoments = gDistanceAtlas[atlasTexel];
+	gDistanceAtlas[atlasTexel] = lerp(moments, oldMoments, getHysteresis(slot));
+}
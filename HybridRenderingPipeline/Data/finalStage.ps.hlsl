@@ -24,6 +24,7 @@ Texture2D<float4>   gReflection;
 Texture2D<float4>   gDirectLighting;
 Texture2D<float4>   gShadowAO;
 Texture2D<float4>   gEmissive;
+Texture2D<float4>   gIndirectDiffuse;
 
 float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
 {
@@ -38,7 +39,18 @@ float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
 	float3 shadeColor;
 
 	// Todo: reflection
-	shadeColor = (directLighting * (float4(ambient) + shadow)).rgb + reflection.rgb + emissive.rgb;
+#ifdef INDIRECT_DIFFUSE
+	// Indirect light from the probes replaces the constant ambient term
+	ambient = 0.0f;
+	float3 indirect = gIndirectDiffuse[pixelPos].rgb;
+#else
+	float3 indirect = float3(0.0f, 0.0f, 0.0f);
+#endif
+#ifdef SHADOWED_DIRECT_LIGHTING
+	shadeColor = directLighting.rgb + indirect + reflection.rgb + emissive.rgb;
+#else
+	shadeColor = (directLighting * (float4(ambient) + shadow)).rgb + indirect + reflection.rgb + emissive.rgb;
+#endif
 	bool isGeometryValid = (worldPos.w != 0.0f);
 	shadeColor = (worldPos.w != 0.0f) ? shadeColor : shadeColor + float3(0.48, 0.75, 0.85);
 	return float4(shadeColor, 1.0f);
@@ -0,0 +1,50 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// A hierarchical depth (Hi-Z) pyramid stored in a flat buffer.  Level 0 holds the view-space depth of each pixel
+//     (a huge value where there's no geometry); each higher level holds the minimum (i.e., closest) depth of the
+//     2x2 cells below it.  Levels are stored one after another, each row-major.
+
+#define HIZ_MAX_LEVELS   16
+#define HIZ_EMPTY_DEPTH  1.0e30f
+
+// Dimensions of a level of the pyramid
+uint2 hiZLevelSize(uint2 baseSize, uint level)
+{
+	return max(uint2(1, 1), (baseSize + (1u << level) - 1u) >> level);
+}
+
+// Where a level of the pyramid starts in the buffer
+uint hiZLevelOffset(uint2 baseSize, uint level)
+{
+	uint offset = 0;
+	for (uint l = 0; l < level; l++)
+	{
+		uint2 size = hiZLevelSize(baseSize, l);
+		offset += size.x * size.y;
+	}
+	return offset;
+}
+
+// How many levels does a pyramid over a <baseSize> image have (down to and including 1x1)?
+uint hiZLevelCount(uint2 baseSize)
+{
+	uint levels = 1;
+	while (any(hiZLevelSize(baseSize, levels - 1) > 1u) && levels < HIZ_MAX_LEVELS) levels++;
+	return levels;
+}
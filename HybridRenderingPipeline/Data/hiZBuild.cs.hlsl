@@ -0,0 +1,66 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Builds the Hi-Z pyramid described in hiZ.hlsli.  HiZBuildBase fills level 0 from the G-buffer, then HiZDownsample
+//     is run once per remaining level.
+
+#include "hiZ.hlsli"
+
+cbuffer HiZCB
+{
+	float3 gCameraPos;
+	uint   gDstLevel;        // Level HiZDownsample writes (it reads gDstLevel - 1)
+	float3 gCameraForward;
+	uint   _pad0;
+	uint2  gBaseSize;        // Size of level 0 (i.e., the screen)
+}
+
+Texture2D<float4> gPos;
+RWBuffer<float>   gHiZ;
+
+[numthreads(16, 16, 1)]
+void HiZBuildBase(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 pixel = threadId.xy;
+	if (any(pixel >= gBaseSize)) return;
+
+	float4 worldPos = gPos[pixel];
+	float depth = (worldPos.w != 0.0f) ? dot(worldPos.xyz - gCameraPos, gCameraForward) : HIZ_EMPTY_DEPTH;
+	gHiZ[pixel.x + pixel.y * gBaseSize.x] = depth;
+}
+
+[numthreads(16, 16, 1)]
+void HiZDownsample(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 dstSize = hiZLevelSize(gBaseSize, gDstLevel);
+	uint2 cell = threadId.xy;
+	if (any(cell >= dstSize)) return;
+
+	uint2 srcSize = hiZLevelSize(gBaseSize, gDstLevel - 1);
+	uint srcOffset = hiZLevelOffset(gBaseSize, gDstLevel - 1);
+
+	// Take the minimum over the (up to) 2x2 source cells.  Odd-sized levels clamp at the edge.
+	float depth = HIZ_EMPTY_DEPTH;
+	[unroll]
+	for (uint i = 0; i < 4; i++)
+	{
+		uint2 src = min(cell * 2 + uint2(i & 1, i >> 1), srcSize - 1);
+		depth = min(depth, gHiZ[srcOffset + src.x + src.y * srcSize.x]);
+	}
+	gHiZ[hiZLevelOffset(gBaseSize, gDstLevel) + cell.x + cell.y * dstSize.x] = depth;
+}
@@ -16,7 +16,7 @@
 # ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **********************************************************************************************************************/
 
-#include "halton.hlsli"
+#include "LowDiscrepancy.slang"
 
 // The payload structure for our indirect rays
 struct IndirectRayPayload
@@ -24,10 +24,10 @@ struct IndirectRayPayload
 	float3 color;    // The (returned) color in the ray's direction
 	uint   rndSeed;  // Our random seed, so we pick uncorrelated RNGs along our ray
 	uint   rayDepth; // What is the depth of our current ray?
-	HaltonState hState;
+	LowDiscrepancySequence samples;  // The pixel's sample, so bounces keep drawing its next dimensions
 };
 
-float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint curPathLen, uint seed, HaltonState hState, uint curDepth)
+float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint curPathLen, uint seed, LowDiscrepancySequence samples, uint curDepth)
 {
 	// Setup our indirect ray
 	RayDesc rayColor;
@@ -41,7 +41,7 @@ float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint curPat
 	payload.color = float3(0, 0, 0);
 	payload.rndSeed = seed;
 	payload.rayDepth = curDepth + 1;
-	payload.hState = hState;
+	payload.samples = samples;
 
 	// Trace our ray to get a color in the indirect direction.  Use hit group #1 and miss shader #1
 	TraceRay(gRtScene, 0, 0xFF, 1, hitProgramCount, 1, rayColor, payload);
@@ -72,7 +72,7 @@ void IndirectAnyHit(inout IndirectRayPayload rayData, BuiltInTriangleIntersectio
 		IgnoreHit();
 }
 
-float3 lambertianDirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 norm, float3 difColor)
+float3 lambertianDirect(inout uint rndSeed, inout LowDiscrepancySequence samples, float3 hit, float3 norm, float3 difColor)
 {
 	// Pick a random light from our scene to shoot a shadow ray towards
 	int lightToSample = min(int(nextRand(rndSeed) * gLightsCount), gLightsCount - 1);
@@ -93,24 +93,24 @@ float3 lambertianDirect(inout uint rndSeed, HaltonState hState, float3 hit, floa
 	return shadowMult * LdotN * lightIntensity * difColor / M_PI;
 }
 
-float3 lambertianIndirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 norm, float3 difColor, uint rayDepth)
+float3 lambertianIndirect(inout uint rndSeed, inout LowDiscrepancySequence samples, float3 hit, float3 norm, float3 difColor, uint rayDepth)
 {
 	// Shoot a randomly selected cosine-sampled diffuse ray.
 	float3 L = getCosHemisphereSample(rndSeed, norm);
-	float3 bounceColor = shootIndirectRay(hit, L, gMinT, 0, rndSeed, hState, rayDepth);
+	float3 bounceColor = shootIndirectRay(hit, L, gMinT, 0, rndSeed, samples, rayDepth);
 
 	// Accumulate the color: (NdotL * incomingLight * difColor / pi) 
 	// Probability of sampling:  (NdotL / pi)
 	return bounceColor * difColor;
 }
 
-float3 ggxDirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N, float3 V, float3 dif, float3 spec, float rough)
+float3 ggxDirect(inout uint rndSeed, inout LowDiscrepancySequence samples, float3 hit, float3 N, float3 V, float3 dif, float3 spec, float rough)
 {
-	return lambertianDirect(rndSeed, hState, hit, N, dif) * dif;
+	return lambertianDirect(rndSeed, samples, hit, N, dif) * dif;
 	//return float3(0.0);
 }
 
-float3 ggxIndirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N, float3 noNormalN, float3 V, float3 dif, float3 spec, float rough, uint rayDepth, bool inverseRoughness)
+float3 ggxIndirect(inout uint rndSeed, inout LowDiscrepancySequence samples, float3 hit, float3 N, float3 noNormalN, float3 V, float3 dif, float3 spec, float rough, uint rayDepth, bool inverseRoughness)
 {
 	if (!inverseRoughness) {
 		rough = 1.0 - rough;
@@ -123,21 +123,19 @@ float3 ggxIndirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N,
 	float NdotV = saturate(dot(N, V));
 
 	// If we randomly selected to sample our diffuse lobe...
-	if (frac(haltonNext(hState) + nextRand(rndSeed)) > rough)
+	if (nextLowDiscrepancy1D(samples, gSobolDirections) > rough)
 	{
-		return lambertianIndirect(rndSeed, hState, hit, N, dif, rayDepth);
+		return lambertianIndirect(rndSeed, samples, hit, N, dif, rayDepth);
 		//return float3(0.0);
 	}
 	// Otherwise we randomly selected to sample our GGX lobe
 	else
 	{
-		float rnd1 = frac(haltonNext(hState) + nextRand(rndSeed));
-		float rnd2 = frac(haltonNext(hState) + nextRand(rndSeed));
-		float2 Xi = float2(rnd1, rnd2);
+		float2 Xi = nextLowDiscrepancy2D(samples, gSobolDirections);
 		float3 H = ImportanceSampleGGX(Xi, N, 1.0 - rough);
 		float3 L = normalize(2.0 * dot(V, H) * H - V);
 
-		float3 bounceColor = shootIndirectRay(hit, L, gMinT, 0, rndSeed, hState, rayDepth);
+		float3 bounceColor = shootIndirectRay(hit, L, gMinT, 0, rndSeed, samples, rayDepth);
 		return bounceColor;
 		//return float3(0.0, 1.0, 0.0);
 	}
@@ -155,7 +153,7 @@ void IndirectClosestHit(inout IndirectRayPayload rayData, BuiltInTriangleInterse
 	// Do direct illumination at this hit location
     if (gDoDirectGI)
     {
-        rayData.color += ggxDirect(rayData.rndSeed, rayData.hState, shadeData.posW, shadeData.N, shadeData.V,
+        rayData.color += ggxDirect(rayData.rndSeed, rayData.samples, shadeData.posW, shadeData.N, shadeData.V,
             shadeData.diffuse, shadeData.specular, 0.0);
     }
 
@@ -165,7 +163,7 @@ void IndirectClosestHit(inout IndirectRayPayload rayData, BuiltInTriangleInterse
 		// Use the same normal for the normal-mapped and non-normal mapped vectors... This means we could get light
 		//     leaks at secondary surfaces with normal maps due to indirect rays going below the surface.  This
 		//     isn't a huge issue, but this is a (TODO: fix)
-		rayData.color += ggxIndirect(rayData.rndSeed, rayData.hState, shadeData.posW, shadeData.N, shadeData.N, shadeData.V,
+		rayData.color += ggxIndirect(rayData.rndSeed, rayData.samples, shadeData.posW, shadeData.N, shadeData.N, shadeData.V,
 			shadeData.diffuse, shadeData.specular, shadeData.roughness, rayData.rayDepth, gInverseRoughness);
 	}
 }
@@ -28,10 +28,45 @@ __import Lights;                       // Light structures for our current scene
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "commonUtils.hlsli"
 
+// Importance sampling of the environment map with EnvMapSampler's alias tables
+#include "EnvMapSampling.slang"
+
+cbuffer EnvCB
+{
+	uint  gEnvSamples;      // Environment map directions per pixel, picked from its alias tables.  0 leaves the environment map out.
+	uint  gFrameCount;      // Frame counter, used to perturb random seed each frame
+	uint2 gRenderDim;       // G-buffer pixels rendered this frame
+}
+
 Texture2D<float4>   gPos;           // G-buffer world-space position
 Texture2D<float4>   gNorm;          // G-buffer world-space normal
 Texture2D<float4>   gDiffuseMatl;   // G-buffer diffuse material (RGB) and opacity (A)
 Texture2D<float4>   gSpecMatl;
+Texture2D<float4>   gEnvMap;        // Latitude-longitude environment map
+ByteAddressBuffer   gEnvMarginal;   // Its alias tables (see EnvMapSampler)
+ByteAddressBuffer   gEnvConditional;
+
+// Unshadowed irradiance from the environment map, estimated with directions drawn in proportion to its brightness
+float3 estimateEnvIrradiance(float3 normal, uint2 pixelPos)
+{
+	uint2 envDims;
+	gEnvMap.GetDimensions(envDims.x, envDims.y);
+	uint randSeed = initRand(pixelPos.x + pixelPos.y * gRenderDim.x, gFrameCount, 16);
+
+	float3 irradiance = float3(0.0, 0.0, 0.0);
+	for (uint i = 0; i < gEnvSamples; i++)
+	{
+		float envPdf;
+		float3 envDir = sampleEnvMap(gEnvMarginal, gEnvConditional, envDims, float2(nextRand(randSeed), nextRand(randSeed)), envPdf);
+		float NdotE = saturate(dot(normal, envDir));
+		if (NdotE > 0.0f && envPdf > 0.0f)
+		{
+			uint2 texel = min(uint2(envMapDirToUV(envDir) * float2(envDims)), envDims - 1);
+			irradiance += NdotE * gEnvMap[texel].rgb / envPdf;
+		}
+	}
+	return irradiance / float(gEnvSamples);
+}
 
 float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
 {
@@ -43,6 +78,7 @@ float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
 
 	float3 shadeColor;
 	float ambient = 0.03;
+	float envShare = 0.0f;  // The environment map's share of the unshadowed light
 
 	float probDiffuse = probabilityToSampleDiffuse(difMatlColor.xyz, specMatlColor.xyz);
 
@@ -69,11 +105,20 @@ float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
 			// Accumulate our Lambertian shading color
 			shadeColor += LdotN * lightIntensity;
 		}
+
+		// Add the environment map's light.  Its share goes in alpha, so VisibilityPass can split its shadow rays between
+		//     the lights and the environment map.
+		if (gEnvSamples > 0)
+		{
+			float3 envIrradiance = estimateEnvIrradiance(worldNorm.xyz, pixelPos);
+			shadeColor += envIrradiance;
+			envShare = luminance(envIrradiance) / max(luminance(shadeColor), 1e-6f);
+		}
 		// Modulate based on the physically based Lambertian term (albedo/pi)
 		shadeColor *= difMatlColor.rgb / 3.141592f;
 	}
 
 	shadeColor = max(shadeColor, 0.05 * difMatlColor.xyz);
 
-	return float4(shadeColor, 1.0f);
+	return float4(shadeColor, envShare);
 }
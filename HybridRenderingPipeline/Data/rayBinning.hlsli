@@ -0,0 +1,60 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Ray binning keys used to sort rays for coherent tracing.  Keep in sync with SharedUtils/RayBinning.h, which is the
+//     CPU reference for everything in this file.
+//
+// Key layout (15 bits):  [14:12] direction octant, [11:0] Morton code of the ray origin (4 bits per axis)
+//     Putting the octant in the top bits means rays heading the same general direction end up next to each other,
+//     and within an octant, rays starting near each other do, too.
+
+#define RAY_BIN_MORTON_BITS_PER_AXIS  4
+#define RAY_BIN_COUNT                 (1u << (3 + 3 * RAY_BIN_MORTON_BITS_PER_AXIS))
+#define RAY_BIN_INVALID_KEY           0xFFFFFFFFu
+
+// Which of the 8 octants does this direction point into?  (Bit i is set if component i is negative.)
+uint rayDirectionOctant(float3 dir)
+{
+	return (dir.x < 0.0f ? 1u : 0u) | (dir.y < 0.0f ? 2u : 0u) | (dir.z < 0.0f ? 4u : 0u);
+}
+
+// Quantizes a position to a grid over the scene bounds and interleaves the cell's bits (x in the lowest bit of each triple)
+uint rayMortonCode(float3 pos, float3 sceneMin, float3 sceneExtent)
+{
+	const uint cellsPerAxis = 1u << RAY_BIN_MORTON_BITS_PER_AXIS;
+	uint3 cell = uint3(clamp((pos - sceneMin) / max(sceneExtent, 1e-6f) * float(cellsPerAxis), 0.0f, float(cellsPerAxis - 1)));
+
+	uint code = 0;
+	[unroll]
+	for (uint b = 0; b < RAY_BIN_MORTON_BITS_PER_AXIS; b++)
+	{
+		code |= ((cell.x >> b) & 1u) << (3 * b + 0);
+		code |= ((cell.y >> b) & 1u) << (3 * b + 1);
+		code |= ((cell.z >> b) & 1u) << (3 * b + 2);
+	}
+	return code;
+}
+
+uint rayBinKey(float3 origin, float3 dir, float3 sceneMin, float3 sceneExtent)
+{
+	return (rayDirectionOctant(dir) << (3 * RAY_BIN_MORTON_BITS_PER_AXIS)) | rayMortonCode(origin, sceneMin, sceneExtent);
+}
+
+// Ray launch indices are stored in the sorted ray buffer packed into a single uint
+uint packRayPixel(uint2 pixel)   { return (pixel.y << 16) | (pixel.x & 0xFFFFu); }
+uint2 unpackRayPixel(uint packed) { return uint2(packed & 0xFFFFu, packed >> 16); }
@@ -0,0 +1,40 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// With dynamic resolution, a pass can trace fewer rays than there are G-buffer pixels (see ResourceManager::ResolutionGroup).
+//    Each ray then covers a footprint of up to 2x2 pixels at the G-buffer's render size: it's traced from one of them, picked
+//    differently every frame so the temporal filters see them all, and its result is written to the whole footprint.
+//    When the launch is as large as the render size, every footprint is the ray's own pixel.
+struct RayFootprint
+{
+	uint2 pixel;    // The pixel to trace the ray from
+	uint2 first;    // Top-left pixel of the footprint
+	uint2 end;      // One past the bottom-right pixel of the footprint
+};
+
+RayFootprint getRayFootprint(uint2 launchIndex, uint2 launchDim, uint2 renderDim, uint frameCount)
+{
+	RayFootprint footprint;
+	footprint.first = (launchIndex * renderDim) / launchDim;
+	footprint.end = max(((launchIndex + 1) * renderDim) / launchDim, footprint.first + 1);
+
+	uint2 size = footprint.end - footprint.first;
+	uint hash = (launchIndex.x * 73856093u) ^ (launchIndex.y * 19349663u) ^ (frameCount * 83492791u);
+	footprint.pixel = footprint.first + uint2(hash % size.x, (hash / size.x) % size.y);
+	return footprint;
+}
@@ -26,7 +26,9 @@ __import Lights;                       // Light structures for our current scene
 
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "commonUtils.hlsli"
-#include "halton.hlsli"
+#include "LowDiscrepancy.slang"
+#include "reflectionRay.hlsli"
+#include "rayBinning.hlsli"
 
 // Payload for our primary rays.  We really don't use this for this g-buffer pass
 struct ReflectRayPayload
@@ -45,6 +47,7 @@ cbuffer RayGenCB
 	float gMinT;
 	bool gOpenScene;
 	bool gHalfResolution;
+	uint2 gLaunchDim;        // Only used by ReflectSortedRayGen
 }
 
 // Input and out textures that need to be set by the C++ code
@@ -52,9 +55,15 @@ Texture2D<float4> gPos;
 Texture2D<float4> gNorm;
 Texture2D<float4> gDiffuseMatl;
 Texture2D<float4> gSpecMatl;
-Texture2D<float4>   gShadow;
 RWTexture2D<float4> gOutput;
 
+// Sorted ray order, from reflectionBinning.cs.hlsl (only used by ReflectSortedRayGen)
+Buffer<uint>        gSortedRays;
+Buffer<uint>        gRayCount;
+
+// Sobol direction numbers for the samplers of LowDiscrepancy.slang
+Buffer<uint>        gSobolDirections;
+
 #include "standardShadowRay.hlsli"
 
 [shader("miss")]
@@ -102,24 +111,13 @@ void ReflectClosestHit(inout ReflectRayPayload rayData, BuiltInTriangleIntersect
 }
 
 
-[shader("raygeneration")]
-void ReflectRayGen()
+// Traces and shades the reflection ray for one launch index.  <launchDim> is the size of the (unsorted) launch,
+//     which seeds the random numbers, so the sorted ray generation below reproduces the exact same rays.
+void shadeReflection(uint2 launchIndex, uint2 launchDim)
 {
-	// Where is this ray on screen?
-	uint2 launchIndex = DispatchRaysIndex().xy;
-	uint2 launchDim = DispatchRaysDimensions().xy;
-	// Initialize random seed per sample based on a screen position and temporally varying count
-	uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
-
+	// From here on, launchIndex is the G-buffer pixel we reflect from and launchIndexCopy the output pixel we write
 	uint2 launchIndexCopy;
-	
-	if (!gHalfResolution) {
-		launchIndexCopy = launchIndex;
-	}
-	else {
-		launchIndexCopy = launchIndex * 2;
-		launchIndex = launchIndex * 2 + uint2(int(randSeed) & 1, int(nextRand(randSeed)) & 1);
-	}
+	getReflectionPixel(launchIndex, launchDim, gFrameCount, gHalfResolution, launchIndex, launchIndexCopy);
 
 	// Load the position and normal from our g-buffer
 	float4 worldPos = gPos[launchIndex];
@@ -141,14 +139,8 @@ void ReflectRayGen()
 	float3 bounceColor;
 	if (isGeometryValid)
 	{
-		HaltonState hState;
-		haltonInit(hState, launchIndex.x, launchIndex.y, 1, 1, gFrameCount, 1);
-		uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
-		float rnd1 = frac(haltonNext(hState) + nextRand(randSeed));
-		float rnd2 = frac(haltonNext(hState) + nextRand(randSeed));
-		float2 Xi = float2(rnd1, rnd2);
-		float3 H = getGGXMicrofacet(Xi, N, roughness);
-		float3 L = normalize(2.0 * dot(V, H) * H - V);
+		uint randSeed;
+		float3 L = getReflectionDirection(launchIndex, launchDim, gFrameCount, N, V, roughness, gSobolDirections, randSeed);
 
 		RayDesc rayReflect;
 		rayReflect.Origin = worldPos.xyz;
@@ -200,3 +192,21 @@ void ReflectRayGen()
 	}
 
 }
+
+[shader("raygeneration")]
+void ReflectRayGen()
+{
+	// Where is this ray on screen?
+	shadeReflection(DispatchRaysIndex().xy, DispatchRaysDimensions().xy);
+}
+
+[shader("raygeneration")]
+void ReflectSortedRayGen()
+{
+	// Rays were sorted by reflectionBinning.cs.hlsl; we trace the i-th ray in sorted order
+	uint2 launchDim = DispatchRaysDimensions().xy;
+	uint rayIdx = DispatchRaysIndex().x + DispatchRaysIndex().y * launchDim.x;
+	if (rayIdx >= gRayCount[0]) return;
+
+	shadeReflection(unpackRayPixel(gSortedRays[rayIdx]), gLaunchDim);
+}
@@ -0,0 +1,140 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Sorts this frame's reflection rays by coherence (see rayBinning.hlsli) so ReflectSortedRayGen traces them in order.
+//     Three passes of a counting sort:
+//        BinCount:   generate each pixel's reflection ray, compute its key, and histogram the keys
+//        BinScan:    exclusive prefix sum over the bins (a single thread group), total ray count goes in gRayCount[0]
+//        BinScatter: write each ray's launch index into its bin's range of gSortedRays
+
+#include "samplingUtils.hlsli"
+#include "LowDiscrepancy.slang"
+#include "reflectionRay.hlsli"
+#include "rayBinning.hlsli"
+
+cbuffer BinningCB
+{
+	float3 gSceneMin;
+	uint   gFrameCount;
+	float3 gSceneExtent;
+	uint   gHalfResolution;
+	float3 gCameraPos;
+	uint   _pad0;
+	uint2  gLaunchDim;       // Dimensions the unsorted ray launch would use (needed to reproduce its random seeds)
+	uint2  gBinDim;          // Number of rays we actually generate in x and y
+}
+
+Texture2D<float4>   gPos;
+Texture2D<float4>   gNorm;
+Texture2D<float4>   gSpecMatl;
+Buffer<uint>        gSobolDirections;   // For the samplers of LowDiscrepancy.slang
+RWTexture2D<float4> gOutput;
+
+RWBuffer<uint>      gKeys;          // One per ray, RAY_BIN_INVALID_KEY if there's nothing to reflect from
+RWBuffer<uint>      gBinCounts;     // RAY_BIN_COUNT entries, cleared to zero before BinCount
+RWBuffer<uint>      gBinOffsets;    // RAY_BIN_COUNT entries; start of each bin, incremented as BinScatter fills it
+RWBuffer<uint>      gRayCount;      // [0] holds the number of valid rays
+RWBuffer<uint>      gSortedRays;    // Packed launch indices, in sorted order
+
+[numthreads(16, 16, 1)]
+void BinCount(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 launchIndex = threadId.xy;
+	if (any(launchIndex >= gBinDim)) return;
+	uint rayIdx = launchIndex.x + launchIndex.y * gBinDim.x;
+
+	uint2 pixel, outPixel;
+	getReflectionPixel(launchIndex, gLaunchDim, gFrameCount, gHalfResolution != 0, pixel, outPixel);
+
+	float4 worldPos = gPos[pixel];
+	if (worldPos.w == 0.0f)
+	{
+		// No geometry here, so no ray.  Write the same black the ray generation shader would have.
+		gKeys[rayIdx] = RAY_BIN_INVALID_KEY;
+		gOutput[outPixel] = float4(0, 0, 0, 1.0f);
+		if (gHalfResolution != 0) {
+			gOutput[outPixel + uint2(0, 1)] = float4(0, 0, 0, 1.0f);
+			gOutput[outPixel + uint2(1, 0)] = float4(0, 0, 0, 1.0f);
+			gOutput[outPixel + uint2(1, 1)] = float4(0, 0, 0, 1.0f);
+		}
+		return;
+	}
+
+	float3 V = normalize(gCameraPos - worldPos.xyz);
+	float3 N = gNorm[pixel].xyz;
+	if (dot(N, V) <= 0.0f) N = -N;
+
+	uint randSeed;
+	float3 L = getReflectionDirection(pixel, gLaunchDim, gFrameCount, N, V, gSpecMatl[pixel].w, gSobolDirections, randSeed);
+
+	uint key = rayBinKey(worldPos.xyz, L, gSceneMin, gSceneExtent);
+	gKeys[rayIdx] = key;
+	InterlockedAdd(gBinCounts[key], 1);
+}
+
+#define SCAN_THREADS   1024
+#define BINS_PER_THREAD (RAY_BIN_COUNT / SCAN_THREADS)
+
+groupshared uint gsPartialSums[SCAN_THREADS];
+
+[numthreads(SCAN_THREADS, 1, 1)]
+void BinScan(uint3 threadId : SV_GroupThreadID)
+{
+	uint firstBin = threadId.x * BINS_PER_THREAD;
+
+	// Each thread totals a contiguous run of bins
+	uint sum = 0;
+	for (uint i = 0; i < BINS_PER_THREAD; i++)
+		sum += gBinCounts[firstBin + i];
+	gsPartialSums[threadId.x] = sum;
+	GroupMemoryBarrierWithGroupSync();
+
+	// Inclusive scan of the per-thread totals (Hillis-Steele; plenty fast for a single group)
+	for (uint offset = 1; offset < SCAN_THREADS; offset <<= 1)
+	{
+		uint add = (threadId.x >= offset) ? gsPartialSums[threadId.x - offset] : 0;
+		GroupMemoryBarrierWithGroupSync();
+		gsPartialSums[threadId.x] += add;
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	// Then walk our own run of bins again to write their exclusive offsets
+	uint running = gsPartialSums[threadId.x] - sum;
+	for (uint j = 0; j < BINS_PER_THREAD; j++)
+	{
+		gBinOffsets[firstBin + j] = running;
+		running += gBinCounts[firstBin + j];
+	}
+
+	if (threadId.x == SCAN_THREADS - 1)
+		gRayCount[0] = gsPartialSums[threadId.x];
+}
+
+[numthreads(16, 16, 1)]
+void BinScatter(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 launchIndex = threadId.xy;
+	if (any(launchIndex >= gBinDim)) return;
+
+	uint key = gKeys[launchIndex.x + launchIndex.y * gBinDim.x];
+	if (key == RAY_BIN_INVALID_KEY) return;
+
+	uint slot;
+	InterlockedAdd(gBinOffsets[key], 1, slot);
+	gSortedRays[slot] = packRayPixel(launchIndex);
+}
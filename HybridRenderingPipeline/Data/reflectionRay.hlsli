@@ -0,0 +1,43 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Generates the GGX-sampled reflection ray for a launch index.  Shared by the reflection ray generation shader and the
+//     compute pass that bins reflection rays (so both agree on exactly which ray each pixel shoots).
+//
+// Expects samplingUtils.hlsli (or commonUtils.hlsli) and LowDiscrepancy.slang to already be included.
+
+// Which pixel of the G-buffer does the ray launched at <launchIndex> start from?  <outPixel> is the (top-left)
+//     output pixel it writes; these differ when tracing at half resolution.
+void getReflectionPixel(uint2 launchIndex, uint2 launchDim, uint frameCount, bool halfResolution, out uint2 pixel, out uint2 outPixel)
+{
+	uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, frameCount, 16);
+	outPixel = halfResolution ? launchIndex * 2 : launchIndex;
+	pixel = halfResolution ? launchIndex * 2 + uint2(int(randSeed) & 1, int(nextRand(randSeed)) & 1) : launchIndex;
+}
+
+// Samples a reflection direction about N for the given G-buffer pixel.  The microfacet normal is the first 2D sample of the
+//     pixel's Owen-scrambled Sobol sequence, indexed by frame.  <randSeed> is returned so the caller can keep drawing
+//     random numbers for the rest of the path.
+float3 getReflectionDirection(uint2 pixel, uint2 launchDim, uint frameCount, float3 N, float3 V, float roughness, Buffer<uint> sobolDirections, out uint randSeed)
+{
+	LowDiscrepancySequence samples = initLowDiscrepancySequence(LD_SEQUENCE_SOBOL, frameCount, ldPixelSeed(pixel));
+	float2 Xi = nextLowDiscrepancy2D(samples, sobolDirections);
+	randSeed = initRand(pixel.x + pixel.y * launchDim.x, frameCount, 16);
+	float3 H = getGGXMicrofacet(Xi, N, roughness);
+	return normalize(2.0 * dot(V, H) * H - V);
+}
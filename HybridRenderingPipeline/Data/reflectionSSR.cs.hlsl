@@ -0,0 +1,204 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Screen-space reflections, traced against the Hi-Z pyramid (see hiZ.hlsli) before falling back to DXR.
+//     Each thread generates the same reflection ray ReflectRayGen would (see reflectionRay.hlsli) and marches it
+//     through the pyramid.  Hits are shaded from the lit image; rays that leave the screen, run out of steps, or
+//     hit something we can't trust are appended to gFallbackRays so ReflectSortedRayGen can trace them for real.
+
+#include "samplingUtils.hlsli"
+#include "LowDiscrepancy.slang"
+#include "reflectionRay.hlsli"
+#include "rayBinning.hlsli"
+#include "hiZ.hlsli"
+
+cbuffer SSRCB
+{
+	float4x4 gViewProj;
+	float3   gCameraPos;
+	uint     gFrameCount;
+	float3   gCameraForward;
+	uint     gHalfResolution;
+	uint2    gLaunchDim;       // Dimensions the unsorted ray launch would use (needed to reproduce its random seeds)
+	uint2    gBinDim;          // Number of rays we actually generate in x and y
+	uint2    gBaseSize;        // Screen size (i.e., size of Hi-Z level 0)
+	uint     gMaxSteps;        // Give up (and fall back to DXR) after this many traversal steps
+	float    gThickness;       // How far behind a depth sample (relative to its depth) still counts as a hit
+	float    gMaxDistance;     // Longest ray we'll march, in world units
+}
+
+Texture2D<float4>   gPos;
+Texture2D<float4>   gNorm;
+Texture2D<float4>   gSpecMatl;
+Texture2D<float4>   gLit;           // Lit image we reuse for on-screen hits
+Buffer<float>       gHiZ;
+Buffer<uint>        gSobolDirections;   // For the samplers of LowDiscrepancy.slang
+RWTexture2D<float4> gOutput;
+
+RWBuffer<uint>      gFallbackRays;  // Packed launch indices of rays that need DXR
+RWBuffer<uint>      gRayCount;      // [0] number of fallback rays, [1] number of pixels that reflect at all
+
+float2 clipToPixel(float4 posH)
+{
+	float2 ndc = posH.xy / posH.w;
+	return float2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f) * float2(gBaseSize);
+}
+
+// Marches a ray through the Hi-Z pyramid.  Returns true and the pixel it hit if it found an intersection on screen.
+bool traceHiZ(float3 origin, float3 dir, out uint2 hitPixel)
+{
+	hitPixel = uint2(0, 0);
+
+	// Clip the ray so it stays in front of the camera.  (View depth is linear along the ray.)
+	const float kNearDepth = 1.0e-3f;
+	float originDepth = dot(origin - gCameraPos, gCameraForward);
+	float dirDepth = dot(dir, gCameraForward);
+	float rayLength = gMaxDistance;
+	if (dirDepth < 0.0f) rayLength = min(rayLength, (originDepth - kNearDepth) / -dirDepth);
+	if (rayLength <= 0.0f) return false;
+
+	// Project both ends.  Screen position is linear in t, and so is 1/depth.
+	float4 h0 = mul(float4(origin, 1.0f), gViewProj);
+	float4 h1 = mul(float4(origin + dir * rayLength, 1.0f), gViewProj);
+	float2 s0 = clipToPixel(h0);
+	float2 delta = clipToPixel(h1) - s0;
+	float k0 = 1.0f / h0.w;
+	float k1 = 1.0f / h1.w;
+
+	// Rays (nearly) parallel to the view direction barely move on screen; leave those to DXR
+	float pixelLength = max(abs(delta.x), abs(delta.y));
+	if (pixelLength < 1.0f) return false;
+	float2 invDelta = float2(delta.x != 0.0f ? 1.0f / delta.x : 1.0e30f, delta.y != 0.0f ? 1.0f / delta.y : 1.0e30f);
+	float tEpsilon = 0.01f / pixelLength;
+
+	uint maxLevel = hiZLevelCount(gBaseSize) - 1;
+	uint level = 0;
+	float t = 1.0f / pixelLength;   // Start a pixel away to avoid hitting ourselves
+
+	for (uint step = 0; step < gMaxSteps; step++)
+	{
+		if (t > 1.0f) return false;
+		float2 p = s0 + delta * t;
+		if (any(p < 0.0f) || any(p >= float2(gBaseSize))) return false;
+
+		// Which cell of the current level are we in, and where does the ray leave it?
+		uint2 cell = uint2(p) >> level;
+		float2 cellMin = float2(cell << level);
+		float2 cellMax = float2((cell + 1) << level);
+		float2 tBoundary = (float2(delta.x > 0.0f ? cellMax.x : cellMin.x, delta.y > 0.0f ? cellMax.y : cellMin.y) - s0) * invDelta;
+		float tExit = max(min(tBoundary.x, tBoundary.y), t + tEpsilon);
+
+		// Range of ray depths within this cell
+		float depthIn = 1.0f / lerp(k0, k1, t);
+		float depthOut = 1.0f / lerp(k0, k1, min(tExit, 1.0f));
+		float rayNear = min(depthIn, depthOut);
+		float rayFar = max(depthIn, depthOut);
+
+		uint2 levelSize = hiZLevelSize(gBaseSize, level);
+		float cellDepth = gHiZ[hiZLevelOffset(gBaseSize, level) + cell.x + cell.y * levelSize.x];
+
+		if (rayFar < cellDepth)
+		{
+			// The ray passes in front of everything in this cell.  Skip it, and try bigger steps.
+			t = tExit + tEpsilon;
+			level = min(level + 1, maxLevel);
+		}
+		else if (level > 0)
+		{
+			// Something in this cell might be hit; look more closely
+			level--;
+		}
+		else if (rayNear <= cellDepth * (1.0f + gThickness))
+		{
+			hitPixel = cell;
+			return true;
+		}
+		else
+		{
+			// We're behind this pixel's surface, but too far behind for it to be what we hit.  Keep going.
+			t = tExit + tEpsilon;
+		}
+	}
+	return false;
+}
+
+// Writes a reflected color the same way ReflectRayGen does for a DXR hit
+void writeReflection(uint2 outPixel, float3 N, float3 L, float3 hitPoint, float3 bounceColor)
+{
+	if (gHalfResolution != 0)
+	{
+		[unroll]
+		for (uint i = 0; i < 4; i++)
+		{
+			uint2 sub = outPixel + uint2(i >> 1, i & 1);
+			float NdotL = saturate(dot(N, normalize(hitPoint - gPos[sub].xyz)));
+			gOutput[sub] = float4(NdotL * bounceColor, 1);
+		}
+	}
+	else
+	{
+		gOutput[outPixel] = float4(saturate(dot(N, L)) * bounceColor, 1);
+	}
+}
+
+[numthreads(16, 16, 1)]
+void ScreenSpaceReflect(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 launchIndex = threadId.xy;
+	if (any(launchIndex >= gBinDim)) return;
+
+	uint2 pixel, outPixel;
+	getReflectionPixel(launchIndex, gLaunchDim, gFrameCount, gHalfResolution != 0, pixel, outPixel);
+
+	float4 worldPos = gPos[pixel];
+	if (worldPos.w == 0.0f)
+	{
+		// No geometry here, so no ray.  Write the same black the ray generation shader would have.
+		uint2 blockSize = (gHalfResolution != 0) ? uint2(2, 2) : uint2(1, 1);
+		for (uint y = 0; y < blockSize.y; y++)
+			for (uint x = 0; x < blockSize.x; x++)
+				gOutput[outPixel + uint2(x, y)] = float4(0, 0, 0, 1.0f);
+		return;
+	}
+	InterlockedAdd(gRayCount[1], 1);
+
+	float3 V = normalize(gCameraPos - worldPos.xyz);
+	float3 N = gNorm[pixel].xyz;
+	if (dot(N, V) <= 0.0f) N = -N;
+
+	uint randSeed;
+	float3 L = getReflectionDirection(pixel, gLaunchDim, gFrameCount, N, V, gSpecMatl[pixel].w, gSobolDirections, randSeed);
+
+	// Only accept hits on surfaces that face the ray and actually lie ahead of us
+	uint2 hitPixel;
+	if (traceHiZ(worldPos.xyz, L, hitPixel) && any(hitPixel != pixel))
+	{
+		float3 hitPoint = gPos[hitPixel].xyz;
+		float3 hitN = gNorm[hitPixel].xyz;
+		if (dot(hitN, L) < 0.0f && dot(hitPoint - worldPos.xyz, L) > 0.0f)
+		{
+			writeReflection(outPixel, N, L, hitPoint, gLit[hitPixel].rgb);
+			return;
+		}
+	}
+
+	// Off screen, occluded, or otherwise unknown:  queue a real ray
+	uint slot;
+	InterlockedAdd(gRayCount[0], 1, slot);
+	gFallbackRays[slot] = packRayPixel(launchIndex);
+}
@@ -0,0 +1,111 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// First ReSTIR pass: draws light candidates for each pixel into a reservoir, then merges last frame's reservoir for the
+//     same surface into it.
+
+#include "HostDeviceSharedMacros.h"
+#include "HostDeviceData.h"
+
+// Include and import common Falcor utilities and data structures
+__import Raytracing;
+__import ShaderCommon;
+__import Shading;                      // Shading functions, etc
+__import Lights;                       // Light structures for our current scene
+import MathHelpers;                    // oct_to_ndir_snorm()
+
+#include "commonUtils.hlsli"
+#include "restirUtils.hlsli"
+
+// Per-pixel sample sequences, drawn from the LCG or from blue-noise masks
+#include "BlueNoise.slang"
+
+cbuffer PerFrameCB
+{
+	uint  gFrameCount;       // Frame counter, used to perturb random seed each frame
+	uint  gCandidateCount;   // Number of light candidates drawn per pixel
+	uint  gTemporalReuse;    // Merge last frame's reservoirs?
+	float gMaxHistory;       // Last frame's reservoir counts for at most this many times the new candidates
+	float gDepthThreshold;   // Surface similarity tests, see isSimilarSurface()
+	float gNormalThreshold;
+	uint2 gRenderDim;        // Pixels rendered this frame (the top-left part of the textures, see ResourceManager::getRenderSize())
+	uint2 gPrevRenderDim;    // Pixels rendered last frame, which the reservoir history covers
+	uint  gBlueNoise;        // Draw samples from the blue-noise masks instead of the LCG?
+}
+
+Texture2D<float4>   gPos;                   // G-buffer world-space position
+Texture2D<float4>   gNorm;                  // G-buffer world-space normal
+Texture2D<float4>   gDiffuseMatl;           // G-buffer diffuse material (RGB) and opacity (A)
+Texture2D<float4>   gLinearZAndNormal;      // Linear Z, its derivative and the packed normal
+Texture2D<float4>   gMotionAndFWidth;       // Screen-space motion to last frame in .xy
+Texture2D<float4>   gPrevLinearZAndNormal;  // Last frame's gLinearZAndNormal
+Texture2D<float4>   gPrevReservoirs;        // Last frame's final reservoirs
+Texture2DArray<float4> gBlueNoiseMasks;     // Spatiotemporal blue noise, one slice per frame (see BlueNoise.slang)
+
+float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
+{
+	uint2 pixelPos = (uint2)pos.xy;
+	float4 worldPos = gPos[pixelPos];
+	float3 worldNorm = gNorm[pixelPos].xyz;
+	float3 difMatlColor = gDiffuseMatl[pixelPos].rgb;
+
+	// Our camera sees the background if worldPos.w is 0.  There is nothing to light.
+	if (worldPos.w == 0.0f || gLightsCount == 0) return packReservoir(emptyReservoir());
+
+	// With blue noise, neighboring pixels keep different lights, so the spatial pass and SVGF average out the error faster
+	uint randSeed = initRand(pixelPos.x + pixelPos.y * gRenderDim.x, gFrameCount, 16);
+	SampleSequence samples = initSampleSequence(pixelPos, gFrameCount, randSeed, gBlueNoise != 0);
+
+	// Resample lights picked uniformly, with weighted reservoir sampling
+	Reservoir r = emptyReservoir();
+	float sourcePdf = 1.0f / float(gLightsCount);
+	for (uint i = 0; i < gCandidateCount; i++)
+	{
+		float2 u = nextSample2D(samples, gBlueNoiseMasks);
+		uint lightIndex = min(uint(u.x * gLightsCount), uint(gLightsCount - 1));
+		float targetPdf = evalTargetPdf(lightIndex, worldPos.xyz, worldNorm, difMatlColor);
+		updateReservoir(r, lightIndex, targetPdf / sourcePdf, targetPdf, u.y);
+	}
+	finalizeReservoir(r);
+
+	if (gTemporalReuse == 0) return packReservoir(r);
+
+	// Find where our surface was last frame.  Motion is in UVs, and last frame may have been rendered at another size.
+	float2 motion = gMotionAndFWidth[pixelPos].xy;
+	int2 prevPos = int2(((float2(pixelPos) + 0.5f) / float2(gRenderDim) + motion) * float2(gPrevRenderDim));
+	if (any(prevPos < int2(0, 0)) || any(prevPos >= int2(gPrevRenderDim))) return packReservoir(r);
+
+	// Only reuse the reservoir if it belonged to the same surface
+	float4 linearZAndNormal = gLinearZAndNormal[pixelPos];
+	float4 prevLinearZAndNormal = gPrevLinearZAndNormal[prevPos];
+	if (!isSimilarSurface(linearZAndNormal.x, oct_to_ndir_snorm(linearZAndNormal.zw),
+	                      prevLinearZAndNormal.x, oct_to_ndir_snorm(prevLinearZAndNormal.zw), gDepthThreshold, gNormalThreshold))
+	{
+		return packReservoir(r);
+	}
+
+	Reservoir prev = unpackReservoir(gPrevReservoirs[prevPos]);
+	capReservoirHistory(prev, gMaxHistory * max(r.M, 1.0f));
+
+	Reservoir combined = emptyReservoir();
+	float2 u = nextSample2D(samples, gBlueNoiseMasks);
+	mergeReservoir(combined, r, r.targetPdf, u.x);
+	mergeReservoir(combined, prev, evalTargetPdf(prev.lightIndex, worldPos.xyz, worldNorm, difMatlColor), u.y);
+	finalizeReservoir(combined);
+	return packReservoir(combined);
+}
@@ -0,0 +1,107 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Last ReSTIR pass: traces one shadow ray per pixel towards the light its reservoir kept, and shades with the
+//     reservoir's contribution weight.  The reservoir is then stored for next frame's temporal reuse, without its weight
+//     if the light turned out to be occluded, so occluded samples are not reused.
+
+#include "HostDeviceSharedMacros.h"
+#include "HostDeviceData.h"
+
+// Include and import common Falcor utilities and data structures
+import Raytracing;
+import ShaderCommon;
+import Shading;                      // Shading functions, etc
+import Lights;                       // Light structures for our current scene
+
+#include "commonUtils.hlsli"
+#include "restirUtils.hlsli"
+
+cbuffer RayGenCB
+{
+	float gMinT;            // Min distance to start a ray to avoid self-occlusion
+}
+
+Texture2D<float4>   gPos;               // G-buffer world-space position
+Texture2D<float4>   gNorm;              // G-buffer world-space normal
+Texture2D<float4>   gDiffuseMatl;       // G-buffer diffuse material (RGB) and opacity (A)
+Texture2D<float4>   gReservoirs;        // Final reservoirs, after spatial reuse
+RWTexture2D<float4> gReservoirHistory;  // Reservoirs kept for next frame
+RWTexture2D<float4> gOutput;            // Shadowed direct lighting
+
+struct ShadowRayPayload
+{
+	float visFactor;  // Will be 1.0 for unoccluded, 0.0 for occluded
+};
+
+[shader("miss")]
+void ShadowMiss(inout ShadowRayPayload rayData)
+{
+	rayData.visFactor = 1.0f;
+}
+
+[shader("anyhit")]
+void ShadowAnyHit(inout ShadowRayPayload rayData, BuiltInTriangleIntersectionAttributes attribs)
+{
+	// Is this a transparent part of the surface?  If so, ignore this hit
+	if (alphaTestFails(attribs))
+		IgnoreHit();
+}
+
+[shader("closesthit")]
+void ShadowClosestHit(inout ShadowRayPayload rayData, BuiltInTriangleIntersectionAttributes attribs)
+{
+}
+
+[shader("raygeneration")]
+void RestirShadeRayGen()
+{
+	uint2 launchIndex = DispatchRaysIndex().xy;
+	float4 worldPos = gPos[launchIndex];
+	float3 worldNorm = gNorm[launchIndex].xyz;
+	float3 difMatlColor = gDiffuseMatl[launchIndex].rgb;
+
+	Reservoir r = unpackReservoir(gReservoirs[launchIndex]);
+	float3 shadeColor = float3(0.0f, 0.0f, 0.0f);
+	if (worldPos.w != 0.0f && r.lightIndex < uint(gLightsCount) && r.W > 0.0f)
+	{
+		float distToLight;
+		float3 lightIntensity;
+		float3 toLight;
+		getLightData(r.lightIndex, worldPos.xyz, toLight, lightIntensity, distToLight);
+
+		RayDesc ray;
+		ray.Origin = worldPos.xyz;
+		ray.Direction = toLight;
+		ray.TMin = gMinT;
+		ray.TMax = distToLight;
+
+		// Our rays are *assumed* to hit geometry; the miss shader changes this to 1.0 for "visible"
+		ShadowRayPayload payload = { 0.0f };
+		TraceRay(gRtScene,
+			RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH | RAY_FLAG_SKIP_CLOSEST_HIT_SHADER,
+			0xFF, 0, hitProgramCount, 0, ray, payload);
+
+		shadeColor = evalLightContribution(r.lightIndex, worldPos.xyz, worldNorm, difMatlColor) * r.W * payload.visFactor;
+		if (payload.visFactor == 0.0f) r.W = 0.0f;
+	}
+	gReservoirHistory[launchIndex] = packReservoir(r);
+
+	// Same floor as DirectLightingPass, standing in for ambient light
+	gOutput[launchIndex] = float4(max(shadeColor, 0.05f * difMatlColor), 1.0f);
+}
@@ -0,0 +1,101 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Second ReSTIR pass: merges the reservoirs of a few random neighbors on a similar surface into each pixel's reservoir.
+//     Neighbors are merged with the plain 1/M weights, which is slightly biased where their target pdfs differ from ours;
+//     the surface similarity test keeps that bias low.
+
+#include "HostDeviceSharedMacros.h"
+#include "HostDeviceData.h"
+
+// Include and import common Falcor utilities and data structures
+__import Raytracing;
+__import ShaderCommon;
+__import Shading;                      // Shading functions, etc
+__import Lights;                       // Light structures for our current scene
+import MathHelpers;                    // oct_to_ndir_snorm()
+
+#include "commonUtils.hlsli"
+#include "restirUtils.hlsli"
+
+// Per-pixel sample sequences, drawn from the LCG or from blue-noise masks
+#include "BlueNoise.slang"
+
+// First blue-noise dimension we use, past any restirCandidates.ps.hlsl uses, so the two passes' samples aren't correlated
+#define SPATIAL_FIRST_DIMENSION 1024
+
+cbuffer PerFrameCB
+{
+	uint  gFrameCount;       // Frame counter, used to perturb random seed each frame
+	uint  gSpatialSamples;   // Number of neighbors merged per pixel
+	float gSpatialRadius;    // Neighbors are picked within this many pixels
+	float gDepthThreshold;   // Surface similarity tests, see isSimilarSurface()
+	float gNormalThreshold;
+	uint2 gRenderDim;        // Pixels rendered this frame (the top-left part of the textures)
+	uint  gBlueNoise;        // Draw samples from the blue-noise masks instead of the LCG?
+}
+
+Texture2D<float4>   gPos;                   // G-buffer world-space position
+Texture2D<float4>   gNorm;                  // G-buffer world-space normal
+Texture2D<float4>   gDiffuseMatl;           // G-buffer diffuse material (RGB) and opacity (A)
+Texture2D<float4>   gLinearZAndNormal;      // Linear Z, its derivative and the packed normal
+Texture2D<float4>   gReservoirs;            // Reservoirs from restirCandidates.ps.hlsl
+Texture2DArray<float4> gBlueNoiseMasks;     // Spatiotemporal blue noise, one slice per frame (see BlueNoise.slang)
+
+float4 main(float2 texC : TEXCOORD, float4 pos : SV_Position) : SV_Target0
+{
+	uint2 pixelPos = (uint2)pos.xy;
+	float4 worldPos = gPos[pixelPos];
+	float3 worldNorm = gNorm[pixelPos].xyz;
+	float3 difMatlColor = gDiffuseMatl[pixelPos].rgb;
+
+	if (worldPos.w == 0.0f) return packReservoir(emptyReservoir());
+
+	uint randSeed = initRand(pixelPos.x + pixelPos.y * gRenderDim.x, gFrameCount + 0x5bd1e995, 16);
+	SampleSequence samples = initSampleSequence(pixelPos, gFrameCount, randSeed, gBlueNoise != 0);
+	samples.dimension = SPATIAL_FIRST_DIMENSION;
+
+	Reservoir center = unpackReservoir(gReservoirs[pixelPos]);
+	Reservoir r = emptyReservoir();
+	mergeReservoir(r, center, evalTargetPdf(center.lightIndex, worldPos.xyz, worldNorm, difMatlColor), nextSample1D(samples, gBlueNoiseMasks));
+
+	float4 linearZAndNormal = gLinearZAndNormal[pixelPos];
+	float3 normal = oct_to_ndir_snorm(linearZAndNormal.zw);
+	for (uint i = 0; i < gSpatialSamples; i++)
+	{
+		// A random neighbor in a disk around our pixel
+		float2 u = nextSample2D(samples, gBlueNoiseMasks);
+		float radius = gSpatialRadius * sqrt(u.x);
+		float angle = 2.0f * 3.14159265f * u.y;
+		int2 neighborPos = int2(pixelPos) + int2(radius * float2(cos(angle), sin(angle)));
+		neighborPos = clamp(neighborPos, int2(0, 0), int2(gRenderDim) - int2(1, 1));
+		if (all(neighborPos == int2(pixelPos))) continue;
+
+		float4 neighborLinearZAndNormal = gLinearZAndNormal[neighborPos];
+		if (!isSimilarSurface(linearZAndNormal.x, normal,
+		                      neighborLinearZAndNormal.x, oct_to_ndir_snorm(neighborLinearZAndNormal.zw), gDepthThreshold, gNormalThreshold))
+		{
+			continue;
+		}
+
+		Reservoir neighbor = unpackReservoir(gReservoirs[neighborPos]);
+		mergeReservoir(r, neighbor, evalTargetPdf(neighbor.lightIndex, worldPos.xyz, worldNorm, difMatlColor), nextSample1D(samples, gBlueNoiseMasks));
+	}
+	finalizeReservoir(r);
+	return packReservoir(r);
+}
@@ -0,0 +1,116 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Reservoirs for ReSTIR direct lighting.  The reservoir math mirrors Falcor::Reservoir (Utils/Reservoir.h), which is its
+//     CPU reference and is unit tested; keep the two in sync.  Expects commonUtils.hlsli to already be included.
+
+#define RESTIR_INVALID_SAMPLE 0xFFFFFFFF
+
+struct Reservoir
+{
+	uint  lightIndex;   // The kept light sample
+	float targetPdf;    // Target pdf of the kept sample at this pixel (not stored, recomputed when a reservoir is loaded)
+	float weightSum;    // Sum of the resampling weights of the candidates
+	float M;            // Number of candidates the reservoir has seen
+	float W;            // Contribution weight of the kept sample
+};
+
+Reservoir emptyReservoir()
+{
+	Reservoir r = { RESTIR_INVALID_SAMPLE, 0.0f, 0.0f, 0.0f, 0.0f };
+	return r;
+}
+
+// Stream a candidate with resampling weight targetPdf / sourcePdf.  Returns true if it replaced the kept sample.
+bool updateReservoir(inout Reservoir r, uint lightIndex, float weight, float targetPdf, float u)
+{
+	r.weightSum += weight;
+	r.M += 1.0f;
+	if (weight > 0.0f && u * r.weightSum < weight)
+	{
+		r.lightIndex = lightIndex;
+		r.targetPdf = targetPdf;
+		return true;
+	}
+	return false;
+}
+
+// Stream all the candidates of another finalized reservoir, represented by its sample.  <targetPdfHere> is the target
+//     pdf of the other reservoir's sample at this reservoir's pixel.
+bool mergeReservoir(inout Reservoir r, Reservoir other, float targetPdfHere, float u)
+{
+	float weight = targetPdfHere * other.W * other.M;
+	r.weightSum += weight;
+	r.M += other.M;
+	if (weight > 0.0f && u * r.weightSum < weight)
+	{
+		r.lightIndex = other.lightIndex;
+		r.targetPdf = targetPdfHere;
+		return true;
+	}
+	return false;
+}
+
+void finalizeReservoir(inout Reservoir r)
+{
+	r.W = (r.targetPdf > 0.0f && r.M > 0.0f) ? r.weightSum / (r.M * r.targetPdf) : 0.0f;
+}
+
+// Limit the number of candidates a reservoir stands for, so old samples don't outweigh new ones
+void capReservoirHistory(inout Reservoir r, float maxM)
+{
+	r.M = min(r.M, maxM);
+}
+
+// Reservoirs are stored in one RGBA32F texel
+float4 packReservoir(Reservoir r)
+{
+	return float4(asfloat(r.lightIndex), r.weightSum, r.M, r.W);
+}
+
+Reservoir unpackReservoir(float4 v)
+{
+	Reservoir r = { asuint(v.x), 0.0f, v.y, v.z, v.w };
+	return r;
+}
+
+// Unshadowed Lambertian contribution of a light to a G-buffer pixel
+float3 evalLightContribution(uint lightIndex, float3 worldPos, float3 worldNorm, float3 difMatlColor)
+{
+	float distToLight;
+	float3 lightIntensity;
+	float3 toLight;
+	getLightData(lightIndex, worldPos, toLight, lightIntensity, distToLight);
+	return saturate(dot(worldNorm, toLight)) * lightIntensity * difMatlColor / 3.141592f;
+}
+
+// The target pdf is the luminance of the unshadowed contribution
+float evalTargetPdf(uint lightIndex, float3 worldPos, float3 worldNorm, float3 difMatlColor)
+{
+	if (lightIndex >= uint(gLightsCount)) return 0.0f;
+	return dot(evalLightContribution(lightIndex, worldPos, worldNorm, difMatlColor), float3(0.2126f, 0.7152f, 0.0722f));
+}
+
+// Can a reservoir from another pixel (or frame) be reused here?  The linear depths must differ by less than
+//     <depthThreshold> times ours, and the cosine between the normals must be at least <normalThreshold>.
+bool isSimilarSurface(float linearZ, float3 normal, float otherLinearZ, float3 otherNormal, float depthThreshold, float normalThreshold)
+{
+	if (otherLinearZ <= 0.0f) return false;
+	if (abs(otherLinearZ - linearZ) > depthThreshold * linearZ) return false;
+	return dot(normal, otherNormal) >= normalThreshold;
+}
@@ -28,18 +28,23 @@ import Lights;                       // Light structures for our current scene
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "shadowsUtils.hlsli"
 
+// Per-pixel sample sequences, drawn from the LCG or from blue-noise masks
+#include "BlueNoise.slang"
+
 // A constant buffer we'll populate from our C++ code 
 cbuffer RayGenCB
 {
 	float gMinT;        // Min distance to start a ray to avoid self-occlusion
 	uint  gFrameCount;  // Frame counter, used to perturb random seed each frame
 	float gMaxCosineTheta;
+	uint  gBlueNoise;   // Draw samples from the blue-noise masks instead of the LCG?
 }
 
 // Input and out textures that need to be set by the C++ code
 Texture2D<float4>   gPos;           // G-buffer world-space position
 Texture2D<float4>   gNorm;          // G-buffer world-space normal
 RWTexture2D<float4> gOutput;        // Output to store shaded result
+Texture2DArray<float4> gBlueNoiseMasks; // Spatiotemporal blue noise, one slice per frame (see BlueNoise.slang)
 
 // Payload for our shadow rays. 
 struct ShadowRayPayload
@@ -50,12 +55,12 @@ struct ShadowRayPayload
 
 // A utility function to trace a shadow ray and return 1 if no shadow and 0 if shadowed.
 //    -> Note:  This assumes the shadow hit programs and miss programs are index 0!
-float shadowRayVisibility(float3 origin, float3 direction, float minT, float maxT, uint randSeed)
+float shadowRayVisibility(float3 origin, float3 direction, float minT, float maxT, float2 coneSample)
 {
 	// Setup our shadow ray
 	RayDesc ray;
 	ray.Origin = origin;        // Where does it start?
-	ray.Direction = normalize(getConeSample(randSeed, direction, gMaxCosineTheta));
+	ray.Direction = normalize(getConeSample(coneSample, direction, gMaxCosineTheta));
 	ray.TMin = minT;            // The closest distance we'll count as a hit
 	ray.TMax = maxT;            // The farthest distance we'll count as a hit
 
@@ -111,8 +116,9 @@ void LambertShadowsRayGen()
 	// If we don't hit any geometry, our difuse material contains our background color.
 	float3 shadeColor = float3(0.0);
 
-	// Initialize our random number generator
+	// Initialize our random number generator, and the sample sequence drawing from it or from the blue-noise masks
 	uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
+	SampleSequence samples = initSampleSequence(launchIndex, gFrameCount, randSeed, gBlueNoise != 0);
 
 	float shadowMult = 0.0;
 
@@ -124,7 +130,7 @@ void LambertShadowsRayGen()
 	// Our camera sees the background if worldPos.w is 0, only do diffuse shading elsewhere
 	if (worldPos.w != 0.0f)
 	{
-		int lightToSample = min(int(nextRand(randSeed) * gLightsCount), gLightsCount - 1);
+		int lightToSample = min(int(nextSample1D(samples, gBlueNoiseMasks) * gLightsCount), gLightsCount - 1);
 
 		// We need to query our scene to find info about the current light
 		float distToLight;      // How far away is it?
@@ -139,7 +145,7 @@ void LambertShadowsRayGen()
 
 		// Shoot our ray.  Since we're randomly sampling lights, divide by the probability of sampling
 		//    (we're uniformly sampling, so this probability is: 1 / #lights) 
-		shadowMult = float(gLightsCount) * shadowRayVisibility(worldPos.xyz, toLight, gMinT, distToLight, randSeed);
+		shadowMult = float(gLightsCount) * shadowRayVisibility(worldPos.xyz, toLight, gMinT, distToLight, nextSample2D(samples, gBlueNoiseMasks));
 	}
 
 	// Save out our final shaded
@@ -16,13 +16,10 @@
 # ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **********************************************************************************************************************/
 
-// Get a random vector in a cone centered around a specified normal direction.
-float3 getConeSample(inout uint randSeed, float3 hitNorm, float cosThetaMax)
+// Get a vector in a cone centered around a specified normal direction, from 2 random numbers in [0..1)
+float3 getConeSample(float2 randVal, float3 hitNorm, float cosThetaMax)
 {
-	// Get 2 random numbers to select our sample with
-	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
-
-	// Cosine weighted hemisphere sample from RNG
+	// Uniform sample within the cone
 	float3 bitangent = getPerpendicularVector(hitNorm);
 	float3 tangent = cross(bitangent, hitNorm);
 
@@ -34,6 +31,14 @@ float3 getConeSample(inout uint randSeed, float3 hitNorm, float cosThetaMax)
 	return tangent * (r * cos(phi)) + bitangent * (r * sin(phi)) + hitNorm.xyz * cosTheta;
 }
 
+// Get a random vector in a cone centered around a specified normal direction.
+float3 getConeSample(inout uint randSeed, float3 hitNorm, float cosThetaMax)
+{
+	// Get 2 random numbers to select our sample with
+	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
+	return getConeSample(randVal, hitNorm, cosThetaMax);
+}
+
 // A helper to extract important light data from internal Falcor data structures.  What's going on isn't particularly
 //     important -- any framework you use will expose internal scene data in some way.  Use your framework's utilities.
 void getLightData(in int index, in float3 hitPos, out float3 toLight, out float3 lightIntensity, out float distToLight)
@@ -89,13 +94,10 @@ float nextRand(inout uint s)
 	return float(s & 0x00FFFFFF) / float(0x01000000);
 }
 
-// Get a cosine-weighted random vector centered around a specified normal direction.
-float3 getCosHemisphereSample(inout uint randSeed, float3 hitNorm)
+// Get a cosine-weighted vector centered around a specified normal direction, from 2 random numbers in [0..1)
+float3 getCosHemisphereSample(float2 randVal, float3 hitNorm)
 {
-	// Get 2 random numbers to select our sample with
-	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
-
-	// Cosine weighted hemisphere sample from RNG
+	// Cosine weighted hemisphere sample
 	float3 bitangent = getPerpendicularVector(hitNorm);
 	float3 tangent = cross(bitangent, hitNorm);
 	float r = sqrt(randVal.x);
@@ -105,6 +107,14 @@ float3 getCosHemisphereSample(inout uint randSeed, float3 hitNorm)
 	return tangent * (r * cos(phi).x) + bitangent * (r * sin(phi)) + hitNorm.xyz * sqrt(1 - randVal.x);
 }
 
+// Get a cosine-weighted random vector centered around a specified normal direction.
+float3 getCosHemisphereSample(inout uint randSeed, float3 hitNorm)
+{
+	// Get 2 random numbers to select our sample with
+	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
+	return getCosHemisphereSample(randVal, hitNorm);
+}
+
 // This function tests if the alpha test fails, given the attributes of the current hit. 
 //   -> Can legally be called in a DXR any-hit shader or a DXR closest-hit shader, and 
 //      accesses Falcor helpers and data structures to extract and perform the alpha test.
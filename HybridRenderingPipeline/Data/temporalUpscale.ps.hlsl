@@ -0,0 +1,182 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Temporal upscaling (see TemporalUpscalePass).  Each screen pixel gathers the jittered samples rendered around it this frame,
+//     weighted by how close they landed, and adds them to its history reprojected with the G-buffer's motion vectors.  Falcor's
+//     TemporalUpscaleReference runs the same steps on the CPU, to compare the reconstruction against native renders.
+
+Texture2D<float4>   gColor;                 // This frame, in the top-left gRenderDim pixels
+Texture2D<float4>   gLinearZAndNormal;      // x: linear depth, y: its screen-space slope
+Texture2D<float4>   gMotionAndFWidth;       // xy: previous minus current UV of the surface each sample saw, without jitter
+Texture2D<float4>   gPrevLinearZ;           // Last frame's gLinearZAndNormal, in the top-left gPrevRenderDim pixels
+Texture2D<float4>   gHistory;               // rgb: last frame's output, a: the sample weight it accumulated
+
+cbuffer PerImageCB
+{
+	int2    gOutputDim;
+	int2    gRenderDim;
+	int2    gPrevRenderDim;
+	float2  gJitter;                        // Offset of this frame's samples from the render pixel centers, in render pixels (+y is down)
+	float   gKernelScale;                   // -1 / (2 sigma^2) of the Gaussian weighting the samples, with sigma in screen pixels
+	float   gMaxHistoryWeight;              // Cap of the accumulated weight of still history...
+	float   gMaxMotionHistoryWeight;        // ... and of history which moved gMotionWeightDistance screen pixels or more
+	float   gMotionWeightDistance;
+	float   gClampGamma;                    // Half size of the neighborhood color box, in standard deviations
+	float   gDepthTolerance;                // Depth changes over this many times the depth slope are disocclusions
+	bool    gNeighborhoodClamp;
+	bool    gDepthTest;
+};
+
+struct PsOut
+{
+	float4 color   : SV_Target0;
+	float4 history : SV_Target1;
+};
+
+// Clamping in YCoCg keeps the box tight around the luminance of the neighborhood, where most of the variation is
+float3 rgbToYCoCg(float3 c)
+{
+	return float3(0.25f * c.x + 0.5f * c.y + 0.25f * c.z, 0.5f * c.x - 0.5f * c.z, -0.25f * c.x + 0.5f * c.y - 0.25f * c.z);
+}
+
+float3 yCoCgToRgb(float3 c)
+{
+	float t = c.x - c.z;
+	return float3(t + c.y, c.x + c.z, t - c.y);
+}
+
+// Weights of the 4 texels around a position, which is t past the second one
+float4 catmullRomWeights(float t)
+{
+	return float4(t * (-0.5f + t * (1.0f - 0.5f * t)),
+	              1.0f + t * t * (-2.5f + 1.5f * t),
+	              t * (0.5f + t * (2.0f - 1.5f * t)),
+	              t * t * (-0.5f + 0.5f * t));
+}
+
+bool isInside(int2 p, int2 dim)
+{
+	return all(p >= int2(0, 0)) && all(p < dim);
+}
+
+PsOut main(float2 texC : TEXCOORD, float4 pos : SV_Position)
+{
+	const float2 uv = pos.xy / float2(gOutputDim);
+	const float2 renderPos = uv * float2(gRenderDim);
+	const int2 center = int2(floor(renderPos));
+	const float2 outputPerRender = float2(gOutputDim) / float2(gRenderDim);
+
+	// Gather the render samples around the pixel, and the color statistics of the neighborhood
+	float3 sum = float3(0.0f, 0.0f, 0.0f);
+	float sumWeight = 0.0f;
+	float3 m1 = float3(0.0f, 0.0f, 0.0f);
+	float3 m2 = float3(0.0f, 0.0f, 0.0f);
+	float count = 0.0f;
+	float closestZ = 3.402823466e+38f;
+	int2 closest = clamp(center, int2(0, 0), gRenderDim - 1);
+	for (int dy = -1; dy <= 1; dy++)
+	{
+		for (int dx = -1; dx <= 1; dx++)
+		{
+			int2 p = center + int2(dx, dy);
+			if (!isInside(p, gRenderDim)) continue;
+			float3 c = gColor[p].rgb;
+
+			float2 d = (float2(p) + 0.5f + gJitter - renderPos) * outputPerRender;
+			float w = exp(gKernelScale * dot(d, d));
+			sum += w * c;
+			sumWeight += w;
+
+			float3 ycocg = rgbToYCoCg(c);
+			m1 += ycocg;
+			m2 += ycocg * ycocg;
+			count += 1.0f;
+
+			// Foreground motion wins at edges, so silhouettes reproject with the object that covers them
+			float z = gLinearZAndNormal[p].x;
+			if (z < closestZ)
+			{
+				closestZ = z;
+				closest = p;
+			}
+		}
+	}
+	float3 current = sum / max(sumWeight, 1e-20f);
+
+	// Find the pixel in the previous frame, and check it saw the same surface
+	const float2 motion = gMotionAndFWidth[closest].xy;
+	const float2 prevUV = uv + motion;
+	bool valid = all(prevUV >= 0.0f) && all(prevUV <= 1.0f);
+	if (valid && gDepthTest)
+	{
+		const float2 z = gLinearZAndNormal[closest].xy;
+		const float tolerance = gDepthTolerance * (z.y + 1e-2f);
+		const int2 base = int2(floor(prevUV * float2(gPrevRenderDim) - 0.5f));
+		valid = false;
+		for (int i = 0; i < 4; i++)
+		{
+			int2 p = base + int2(i & 1, i >> 1);
+			if (isInside(p, gPrevRenderDim) && abs(gPrevLinearZ[p].x - z.x) <= tolerance) valid = true;
+		}
+	}
+
+	float historyWeight = 0.0f;
+	float3 history = float3(0.0f, 0.0f, 0.0f);
+	if (valid)
+	{
+		// Catmull-Rom keeps the history sharp through the many resamplings it goes through; its weight is filtered bilinearly
+		const float2 histPos = prevUV * float2(gOutputDim) - 0.5f;
+		const int2 base = int2(floor(histPos));
+		const float2 f = histPos - float2(base);
+		const float4 wx = catmullRomWeights(f.x);
+		const float4 wy = catmullRomWeights(f.y);
+		for (int j = 0; j < 4; j++)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				int2 p = clamp(base + int2(i - 1, j - 1), int2(0, 0), gOutputDim - 1);
+				history += (wx[i] * wy[j]) * gHistory[p].rgb;
+			}
+		}
+		history = max(history, float3(0.0f, 0.0f, 0.0f));
+		for (int k = 0; k < 4; k++)
+		{
+			int2 p = clamp(base + int2(k & 1, k >> 1), int2(0, 0), gOutputDim - 1);
+			historyWeight += ((k & 1) ? f.x : 1.0f - f.x) * ((k >> 1) ? f.y : 1.0f - f.y) * gHistory[p].a;
+		}
+
+		// Every frame of motion resamples the history, which blurs it a little more: keep less of it the further it moved
+		float motionFactor = min(length(motion * float2(gOutputDim)) / gMotionWeightDistance, 1.0f);
+		historyWeight = min(historyWeight, lerp(gMaxHistoryWeight, gMaxMotionHistoryWeight, motionFactor));
+
+		if (gNeighborhoodClamp)
+		{
+			float3 mean = m1 / count;
+			float3 sigma = sqrt(max(m2 / count - mean * mean, 0.0f));
+			history = yCoCgToRgb(clamp(rgbToYCoCg(history), mean - gClampGamma * sigma, mean + gClampGamma * sigma));
+		}
+	}
+
+	float weight = historyWeight + sumWeight;
+	float3 color = (history * historyWeight + current * sumWeight) / max(weight, 1e-20f);
+
+	PsOut output;
+	output.color = float4(color, 1.0f);
+	output.history = float4(color, weight);
+	return output;
+}
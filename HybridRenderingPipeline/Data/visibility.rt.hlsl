@@ -0,0 +1,192 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "HostDeviceSharedMacros.h"
+#include "HostDeviceData.h"            // Some #defines used for shading across Falcor
+
+// Include and import common Falcor utilities and data structures
+import Raytracing;
+import ShaderCommon; 
+import Shading;                      // Shading functions, etc   
+import Lights;                       // Light structures for our current scene
+
+// A separate file with some simple utility functions: getConeSample(), getCosHemisphereSample(), initRand(), nextRand()
+#include "shadowsUtils.hlsli"
+
+// Per-pixel sample sequences, drawn from the LCG or from blue-noise masks
+#include "BlueNoise.slang"
+
+// Maps rays to G-buffer pixels when tracing at a lower resolution
+#include "rayFootprint.hlsli"
+
+// Importance sampling of the environment map with EnvMapSampler's alias tables
+#include "EnvMapSampling.slang"
+
+// Environment map directions drawn per shadow ray towards the environment map; one of them is traced
+#define ENV_CANDIDATES 4
+
+// A constant buffer we'll populate from our C++ code 
+cbuffer RayGenCB
+{
+	float gMinT;            // Min distance to start a ray to avoid self-occlusion
+	uint  gFrameCount;      // Frame counter, used to perturb random seed each frame
+	float gMaxCosineTheta;  // Size of the cone our shadow rays are jittered in (soft shadows)
+	float gAORadius;        // Max distance of an occluder for our AO rays
+	uint  gNumAORays;       // How many AO rays per pixel?
+	uint  gBlueNoise;       // Draw samples from the blue-noise masks instead of the LCG?
+	uint2 gRenderDim;       // G-buffer pixels rendered this frame.  We may launch fewer rays (see rayFootprint.hlsli)
+	uint2 gEnvDim;          // Size of the environment map gEnvMarginal and gEnvConditional were built for
+}
+
+// Input and out textures that need to be set by the C++ code
+Texture2D<float4>   gPos;           // G-buffer world-space position
+Texture2D<float4>   gNorm;          // G-buffer world-space normal
+RWTexture2D<float2> gOutput;        // Light visibility in .r, ambient occlusion in .g
+Texture2DArray<float4> gBlueNoiseMasks; // Spatiotemporal blue noise, one slice per frame (see BlueNoise.slang)
+Texture2D<float4>   gDirectLighting;    // DirectLightingPass output.  Alpha is the environment map's share of the unshadowed light.
+ByteAddressBuffer   gEnvMarginal;       // The environment map's alias tables (see EnvMapSampler)
+ByteAddressBuffer   gEnvConditional;
+
+// Shadow and AO rays both only ask "is anything in the way?", so they share a payload, miss shader and hit group
+struct VisibilityRayPayload
+{
+	float visFactor;  // Will be 1.0 for unoccluded, 0.0 for occluded
+};
+
+// A utility function to trace a visibility ray and return 1 if nothing is hit before maxT and 0 otherwise.
+float traceVisibilityRay(float3 origin, float3 direction, float minT, float maxT)
+{
+	RayDesc ray;
+	ray.Origin = origin;
+	ray.Direction = direction;
+	ray.TMin = minT;
+	ray.TMax = maxT;
+
+	// Our rays are *assumed* to hit geometry; the miss shader changes this to 1.0 for "visible"
+	VisibilityRayPayload payload = { 0.0f };
+	TraceRay(gRtScene,
+		RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH | RAY_FLAG_SKIP_CLOSEST_HIT_SHADER,
+		0xFF, 0, hitProgramCount, 0, ray, payload);
+	return payload.visFactor;
+}
+
+[shader("miss")]
+void VisibilityMiss(inout VisibilityRayPayload rayData)
+{
+	rayData.visFactor = 1.0f;
+}
+
+[shader("anyhit")]
+void VisibilityAnyHit(inout VisibilityRayPayload rayData, BuiltInTriangleIntersectionAttributes attribs)
+{
+	// Is this a transparent part of the surface?  If so, ignore this hit
+	if (alphaTestFails(attribs))
+		IgnoreHit();
+}
+
+[shader("closesthit")]
+void VisibilityClosestHit(inout VisibilityRayPayload rayData, BuiltInTriangleIntersectionAttributes attribs)
+{
+}
+
+// Write a ray's result to all the pixels it stands for
+void writeFootprint(RayFootprint footprint, float2 visibility)
+{
+	for (uint y = footprint.first.y; y < footprint.end.y; y++)
+	{
+		for (uint x = footprint.first.x; x < footprint.end.x; x++)
+		{
+			gOutput[uint2(x, y)] = visibility;
+		}
+	}
+}
+
+// Trace the shadow ray and the AO rays for a pixel, reading the G-buffer once
+[shader("raygeneration")]
+void VisibilityRayGen()
+{
+	// Get the pixels this ray stands for
+	uint2 launchIndex = DispatchRaysIndex().xy;
+	uint2 launchDim = DispatchRaysDimensions().xy;
+	RayFootprint footprint = getRayFootprint(launchIndex, launchDim, gRenderDim, gFrameCount);
+	uint2 pixel = footprint.pixel;
+
+	// Load g-buffer data:  world-space position and normal
+	float4 worldPos = gPos[pixel];
+	float4 worldNorm = gNorm[pixel];
+
+	// Our camera sees the background if worldPos.w is 0.  It's unshadowed and unoccluded, but there is no light to shadow.
+	if (worldPos.w == 0.0f)
+	{
+		writeFootprint(footprint, float2(0.0f, 1.0f));
+		return;
+	}
+
+	// One sample sequence for both ray types, so their samples aren't correlated.  With blue noise, the error left in
+	//     each frame is mostly high frequency, which SVGF's spatial and temporal filters remove much better than white noise.
+	uint randSeed = initRand(pixel.x + pixel.y * gRenderDim.x, gFrameCount, 16);
+	SampleSequence samples = initSampleSequence(pixel, gFrameCount, randSeed, gBlueNoise != 0);
+
+	// The shadow ray goes towards the environment map or a light, in proportion to their share of the unshadowed light
+	float envShare = gDirectLighting[pixel].a;
+	float lightSample = nextSample1D(samples, gBlueNoiseMasks);
+	float2 dirSample = nextSample2D(samples, gBlueNoiseMasks);
+	float shadowMult;
+	if (lightSample < envShare)
+	{
+		// Draw a few directions from the environment map's alias tables, and keep one with probability proportional to N.L.  The
+		//     kept direction is distributed like the environment map's unshadowed light, so its visibility estimates what
+		//     fraction of that light gets through.
+		float3 envDir = worldNorm.xyz;
+		float weightSum = 0.0f;
+		for (uint i = 0; i < ENV_CANDIDATES; i++)
+		{
+			float2 u = (i == 0) ? dirSample : float2(nextLcgSample(samples), nextLcgSample(samples));
+			float envPdf;
+			float3 candidate = sampleEnvMap(gEnvMarginal, gEnvConditional, gEnvDim, u, envPdf);
+			float weight = saturate(dot(worldNorm.xyz, candidate));
+			weightSum += weight;
+			if (weight > 0.0f && nextLcgSample(samples) * weightSum < weight) envDir = candidate;
+		}
+		shadowMult = traceVisibilityRay(worldPos.xyz, envDir, gMinT, 1.0e38f);
+	}
+	else
+	{
+		// A randomly selected light, jittered in a cone for soft shadows
+		float lightU = (lightSample - envShare) / (1.0f - envShare);
+		int lightToSample = min(int(lightU * gLightsCount), gLightsCount - 1);
+		float distToLight;
+		float3 lightIntensity;
+		float3 toLight;
+		getLightData(lightToSample, worldPos.xyz, toLight, lightIntensity, distToLight);
+		float3 shadowDir = normalize(getConeSample(dirSample, toLight, gMaxCosineTheta));
+
+		// Since we're randomly sampling lights, divide by the probability of sampling (1 / #lights) 
+		shadowMult = float(gLightsCount) * traceVisibilityRay(worldPos.xyz, shadowDir, gMinT, distToLight);
+	}
+
+	// Cosine-weighted AO rays around the surface normal
+	float ambientOcclusion = 0.0f;
+	for (uint i = 0; i < gNumAORays; i++)
+	{
+		float3 aoDir = getCosHemisphereSample(nextSample2D(samples, gBlueNoiseMasks), worldNorm.xyz);
+		ambientOcclusion += traceVisibilityRay(worldPos.xyz, aoDir, gMinT, gAORadius);
+	}
+
+	writeFootprint(footprint, float2(shadowMult, ambientOcclusion / float(gNumAORays)));
+}
@@ -18,15 +18,17 @@
 
 #include "Falcor.h"
 #include "../SharedUtils/RenderingPipeline.h"
-#include "Passes/AmbientOcclusionPass.h"
-#include "Passes/ShadowPass.h"
+#include "Passes/VisibilityPass.h"
+#include "Passes/RestirDirectLightingPass.h"
 #include "Passes/ReflectionPass.h"
 #include "Passes/DirectLightingPass.h"
+#include "Passes/DDGIPass.h"
 #include "Passes/FinalStagePass.h"
 #include "Passes/SVGFPass.h"
 #include "Passes/SVGFShadowPass.h"
 #include "Passes/ComparePass.h"
 #include "Passes/MergePass.h"
+#include "Passes/TemporalUpscalePass.h"
 #include "../CommonPasses/SimpleGBufferPass.h"
 #include "../CommonPasses/SimpleAccumulationPass.h"
 #include "../CommonPasses/CopyToOutputPass.h"
@@ -37,12 +39,35 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
 	RenderingPipeline *pipeline = new RenderingPipeline();
   Falcor::gProfileEnabled = true;
 
+	// Optionally (-cookTextures) load scene textures from cached block-compressed DDS files, cooking them on first use.
+	//     This can also be turned on in the GUI before loading a scene.
+	ArgList args;
+	args.parseCommandLine(lpCmdLine);
+	Falcor::TextureCooker::setEnabled(args.argExists("cookTextures"));
+
+	// Optionally (-streamTextures) only load the low-resolution mips at scene load, and stream the rest in as the camera needs them
+	Falcor::TextureStreamer::setEnabled(args.argExists("streamTextures"));
+
 	int idx = 0;
 	constexpr bool useAccum = false;
 	constexpr bool perf = true;
 
+	// Resample the lights with ReSTIR instead of shading with all of them unshadowed and a separate random shadow ray
+	constexpr bool useRestir = false;
+
+	// Light the scene indirectly from a grid of irradiance probes, instead of a constant ambient term
+	constexpr bool useProbeGI = false;
+
+	// Render at a fraction of the screen resolution and reconstruct the rest temporally (the mode can be changed in the GUI)
+	constexpr bool useUpscaler = false;
+
 	pipeline->setPass(idx++, SimpleGBufferPass::create());
-	pipeline->setPass(idx++, DirectLightingPass::create("directLightingChannel"));
+	if (useRestir) {
+		pipeline->setPass(idx++, RestirDirectLightingPass::create("directLightingChannel"));
+	}
+	else {
+		pipeline->setPass(idx++, DirectLightingPass::create("directLightingChannel"));
+	}
 	if (useAccum) {
 		pipeline->setPass(idx++, ReflectionPass::create("reflectionFilter"));
 		pipeline->setPass(idx++, SimpleAccumulationPass::create("reflectionFilter"));
@@ -51,10 +76,18 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
 		pipeline->setPass(idx++, ReflectionPass::create("reflectionOut"));
 		pipeline->setPass(idx++, SVGFPass::create("reflectionFilter", "reflectionOut"));
 	}
-	pipeline->setPass(idx++, AmbientOcclusionPass::create("aoChannel"));
-	pipeline->setPass(idx++, ShadowPass::create("shadowChannel"));
-	pipeline->setPass(idx++, SVGFShadowPass::create("shadowFilter", "shadowChannel", "aoChannel"));
-	pipeline->setPass(idx++, FinalStagePass::create(perf ? ResourceManager::kOutputChannel : "finalOutput"));
+	if (!useRestir) {
+		pipeline->setPass(idx++, VisibilityPass::create("visibilityChannel"));
+		pipeline->setPass(idx++, SVGFShadowPass::create("shadowFilter", "visibilityChannel"));
+	}
+	if (useProbeGI) {
+		pipeline->setPass(idx++, DDGIPass::create("indirectDiffuseChannel"));
+	}
+	pipeline->setPass(idx++, FinalStagePass::create(useUpscaler ? "renderedColor" : (perf ? ResourceManager::kOutputChannel : "finalOutput"), useRestir,
+	                                                useProbeGI ? "indirectDiffuseChannel" : ""));
+	if (useUpscaler) {
+		pipeline->setPass(idx++, TemporalUpscalePass::create(perf ? ResourceManager::kOutputChannel : "finalOutput", "renderedColor"));
+	}
 	if (!perf) {
 		pipeline->setPass(idx++, ComparePass::create("compareOutput"));
 		pipeline->setPass(idx++, CopyToOutputPass::create());
@@ -39,6 +39,10 @@ bool AmbientOcclusionPass::initialize(RenderContext* pRenderContext, ResourceMan
 	mNormalIndex   = mpResManager->requestTextureResource("WorldNormal");
 	mOutputIndex   = mpResManager->requestTextureResource(mOutputTexName);
 
+	// Tell the pipeline which channels we read and write, so it can order (or cull) us appropriately
+	declareInputs({ "WorldPosition", "WorldNormal" });
+	declareOutputs({ mOutputTexName }, Resource::State::UnorderedAccess);
+
 	// Create our wrapper around a ray tracing pass.  Tell it where our ray generation shader and ray-specific shaders are
 	mpRays = RayLaunch::create(kFileRayTrace, kEntryPointRayGen);
 	mpRays->addMissShader(kFileRayTrace, kEntryPointMiss0);
@@ -47,8 +47,15 @@ void ComparePass::renderGui(Gui* pGui)
 {
 	std::string outText = "Current buffer size " + std::to_string(mLeftBuffers.size());
 	pGui->addText(outText.c_str());
-	pGui->addDropdown("Buffer left", mLeftBuffers, mSelectLeft);
-    pGui->addDropdown("Buffer right", mRightBuffers, mSelectRight);
+	bool changed = pGui->addDropdown("Buffer left", mLeftBuffers, mSelectLeft);
+    changed = pGui->addDropdown("Buffer right", mRightBuffers, mSelectRight) || changed;
+
+	// Different buffers means different passes feed us, so the pipeline's pass graph needs rebuilding
+	if (changed)
+	{
+		declareSelectedChannels();
+		setRebindFlag();
+	}
 }
 
 void ComparePass::resize(uint32_t width, uint32_t height) {
@@ -67,8 +74,9 @@ void ComparePass::execute(RenderContext* pRenderContext)
 	auto shaderVars = mpCompareShader->getVars();
 	shaderVars["gLeft"] = leftTexture;
 	shaderVars["gRight"] = rightTexture;
+	mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
 	mpCompareShader->execute(pRenderContext, mpGfxState);
-	pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), outputTexture->getRTV());
+	pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), outputTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 }
 
 void ComparePass::updateDropdown(ResourceManager::SharedPtr pResManager) {
@@ -85,6 +93,15 @@ void ComparePass::updateDropdown(ResourceManager::SharedPtr pResManager) {
 		if (mSelectLeft == uint32_t(-1)) mSelectLeft = i;
 		if (mSelectRight == uint32_t(-1)) mSelectRight = i;
 	}
+	declareSelectedChannels();
+}
+
+void ComparePass::declareSelectedChannels()
+{
+	clearDeclaredChannels();
+	if (mSelectLeft != uint32_t(-1)) declareInputs({ mpResManager->getTextureName(mSelectLeft) });
+	if (mSelectRight != uint32_t(-1)) declareInputs({ mpResManager->getTextureName(mSelectRight) });
+	declareOutputs({ mOutputChannel });
 }
 
 
@@ -40,7 +40,9 @@ protected:
 	void resize(uint32_t width, uint32_t height) override;
     void pipelineUpdated(ResourceManager::SharedPtr pResManager) override;
 	void updateDropdown(ResourceManager::SharedPtr pResManager);
+	void declareSelectedChannels();
 	bool appliesPostprocess() override { return true; }
+	bool canRecordInParallel() override { return true; }
 
 	// Information about the rendering texture we're accumulating into
 	std::string       mOutputChannel;
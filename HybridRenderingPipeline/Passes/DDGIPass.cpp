@@ -0,0 +1,286 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "DDGIPass.h"
+
+namespace {
+	// Where are our shaders located?
+	const char* kFileRayTrace = "ddgiTrace.rt.hlsl";
+	const char* kFileUpdate = "ddgiUpdate.cs.hlsl";
+	const char* kSampleShader = "ddgiSample.ps.hlsl";
+
+	// What are the entry points in those shaders?
+	const char* kEntryPointRayGen = "ProbeRayGen";
+	const char* kEntryPointMiss0 = "ProbeMiss";
+	const char* kEntryProbeAnyHit = "ProbeAnyHit";
+	const char* kEntryProbeClosestHit = "ProbeClosestHit";
+	const char* kEntryPointMiss1 = "ShadowMiss";
+	const char* kEntryShadowAnyHit = "ShadowAnyHit";
+	const char* kEntryShadowClosestHit = "ShadowClosestHit";
+	const char* kEntryUpdateIrradiance = "UpdateIrradiance";
+	const char* kEntryUpdateDistance = "UpdateDistance";
+
+	// Input buffers
+	const char kInputBufferWorldPosition[] = "WorldPosition";
+	const char kInputBufferWorldNormal[] = "WorldNormal";
+	const char kInputBufferDiffuse[] = "MaterialDiffuse";
+
+	// Must match DDGI_IRRADIANCE_TEXELS and DDGI_DISTANCE_TEXELS in ddgiCommon.hlsli.  Tiles have a one texel border.
+	const uint32_t kIrradianceTileSize = 8 + 2;
+	const uint32_t kDistanceTileSize = 16 + 2;
+
+	// Keeps the atlases within the maximum texture width
+	const int32_t kMaxProbesPerAxis = 24;
+
+	// Profiler events we time to report the update cost
+	const char* kTraceEvent = "DDGITrace";
+	const char* kUpdateEvent = "DDGIUpdate";
+	const char* kSampleEvent = "DDGISample";
+};
+
+bool DDGIPass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
+{
+	// Stash our resource manager; ask for the textures we read and write
+	mpResManager = pResManager;
+	mpResManager->requestTextureResources({ kInputBufferWorldPosition, kInputBufferWorldNormal, kInputBufferDiffuse });
+	mpResManager->requestTextureResource(mOutputTexName);
+
+	// Tell the pipeline which channels we read and write, so it can order (or cull) us appropriately.  The probes are
+	//     our own state, not a channel, since they don't depend on the screen.
+	declareInputs({ kInputBufferWorldPosition, kInputBufferWorldNormal, kInputBufferDiffuse });
+	declareOutputs({ mOutputTexName });
+
+	// Probe rays are ray type #0; shadow rays from their hits are ray type #1 (see standardShadowRay.hlsli)
+	mpProbeRays = RayLaunch::create(kFileRayTrace, kEntryPointRayGen);
+	mpProbeRays->addMissShader(kFileRayTrace, kEntryPointMiss0);
+	mpProbeRays->addHitShader(kFileRayTrace, kEntryProbeClosestHit, kEntryProbeAnyHit);
+	mpProbeRays->addMissShader(kFileRayTrace, kEntryPointMiss1);
+	mpProbeRays->addHitShader(kFileRayTrace, kEntryShadowClosestHit, kEntryShadowAnyHit);
+	mpProbeRays->compileRayProgram();
+	if (mpScene) mpProbeRays->setScene(mpScene);
+
+	mpUpdateIrradiance = ComputeLaunch::create(kFileUpdate, kEntryUpdateIrradiance);
+	mpUpdateDistance = ComputeLaunch::create(kFileUpdate, kEntryUpdateDistance);
+
+	mpGfxState = GraphicsState::create();
+	mpSampleShader = FullscreenLaunch::create(kSampleShader);
+
+	// The atlases are looked up bilinearly; the tile borders take care of wrapping
+	Sampler::Desc desc;
+	desc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Point);
+	desc.setAddressingMode(Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp);
+	mpLinearSampler = Sampler::create(desc);
+	return true;
+}
+
+void DDGIPass::initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene)
+{
+	// Stash a copy of the scene and pass it to our ray tracer (if initialized).  The grid follows the scene's bounds.
+	mpScene = std::dynamic_pointer_cast<RtScene>(pScene);
+	if (!mpScene) return;
+	if (mpProbeRays) mpProbeRays->setScene(mpScene);
+	mGridNeedsUpdate = true;
+}
+
+void DDGIPass::resize(uint32_t width, uint32_t height)
+{
+	mpSampleFbo = ResourceManager::createFbo(width, height, ResourceFormat::RGBA32Float);
+}
+
+void DDGIPass::createProbeGrid(RenderContext* pRenderContext)
+{
+	// Union of the scene's instance bounds, as Scene::updateExtents() computes them
+	BoundingBox sceneBox;
+	bool first = true;
+	for (uint32_t i = 0; i < mpScene->getModelCount(); i++)
+	{
+		for (uint32_t j = 0; j < mpScene->getModelInstanceCount(i); j++)
+		{
+			const BoundingBox& instanceBox = mpScene->getModelInstance(i, j)->getBoundingBox();
+			sceneBox = first ? instanceBox : BoundingBox::fromUnion(sceneBox, instanceBox);
+			first = false;
+		}
+	}
+	if (first) return;
+
+	// Probes sit on the box's corners and spread evenly inside it.  A single probe along an axis sits in the middle.
+	vec3 boxMin = sceneBox.center - sceneBox.extent;
+	vec3 boxSize = glm::max(2.0f * sceneBox.extent, vec3(1e-3f));
+	for (int axis = 0; axis < 3; axis++)
+	{
+		bool single = (mProbeCounts[axis] == 1);
+		mProbeSpacing[axis] = single ? boxSize[axis] : boxSize[axis] / float(mProbeCounts[axis] - 1);
+		mProbeOrigin[axis] = single ? sceneBox.center[axis] : boxMin[axis];
+	}
+	mMaxRayDistance = glm::length(boxSize);
+
+	// Tiles are laid out with x and z along the atlas width and y along its height (see ddgiProbeTile())
+	uvec2 tiles = uvec2(mProbeCounts.x * mProbeCounts.z, mProbeCounts.y);
+	Resource::BindFlags flags = Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess;
+	mpIrradianceAtlas = Texture::create2D(tiles.x * kIrradianceTileSize, tiles.y * kIrradianceTileSize, ResourceFormat::RGBA16Float, 1, 1, nullptr, flags);
+	mpDistanceAtlas = Texture::create2D(tiles.x * kDistanceTileSize, tiles.y * kDistanceTileSize, ResourceFormat::RG16Float, 1, 1, nullptr, flags);
+	pRenderContext->clearUAV(mpIrradianceAtlas->getUAV().get(), vec4(0.0f));
+	pRenderContext->clearUAV(mpDistanceAtlas->getUAV().get(), vec4(0.0f));
+
+	mProbeOffset = 0;
+	mUpdatesSinceReset = 0;
+	mGridNeedsUpdate = false;
+}
+
+uint32_t DDGIPass::getProbesPerFrame() const
+{
+	uint32_t probeCount = uint32_t(mProbeCounts.x * mProbeCounts.y * mProbeCounts.z);
+	return glm::clamp(uint32_t(mRayBudget / mRaysPerProbe), 1u, probeCount);
+}
+
+void DDGIPass::setProbeGridVars(SimpleVars::SharedPtr pVars, const glm::mat4& rayRotation, uint32_t probesPerFrame)
+{
+	pVars["DDGICB"]["gRayRotation"] = rayRotation;
+	pVars["DDGICB"]["gProbeOrigin"] = mProbeOrigin;
+	pVars["DDGICB"]["gNormalBias"] = mNormalBias;
+	pVars["DDGICB"]["gProbeSpacing"] = mProbeSpacing;
+	pVars["DDGICB"]["gViewBias"] = mViewBias;
+	pVars["DDGICB"]["gProbeCounts"] = mProbeCounts;
+	pVars["DDGICB"]["gMaxRayDistance"] = mMaxRayDistance;
+	pVars["DDGICB"]["gProbeOffset"] = mProbeOffset;
+	pVars["DDGICB"]["gProbesPerFrame"] = probesPerFrame;
+	pVars["DDGICB"]["gRaysPerProbe"] = uint32_t(mRaysPerProbe);
+	pVars["DDGICB"]["gHysteresis"] = mHysteresis;
+}
+
+void DDGIPass::renderGui(Gui* pGui)
+{
+	int dirty = 0;
+	if (pGui->addInt3Var("Probes per axis", mProbeCounts, 1, kMaxProbesPerAxis))
+	{
+		mGridNeedsUpdate = true;
+		dirty = 1;
+	}
+	dirty |= (int)pGui->addIntVar("Rays per probe", mRaysPerProbe, 16, 1024, 16);
+	dirty |= (int)pGui->addIntVar("Ray budget per frame", mRayBudget, 1024, 1 << 20, 1024);
+	dirty |= (int)pGui->addFloatVar("Hysteresis", mHysteresis, 0.0f, 0.999f, 0.005f);
+
+	pGui->addText("");
+	dirty |= (int)pGui->addFloatVar("Normal bias", mNormalBias, 0.0f, 1.0f, 0.005f);
+	dirty |= (int)pGui->addFloatVar("View bias", mViewBias, 0.0f, 1.0f, 0.005f);
+	dirty |= (int)pGui->addFloatVar("Intensity", mIntensity, 0.0f, 10.0f, 0.05f);
+	dirty |= (int)pGui->addCheckBox("Is Open Scene", mIsOpenScene);
+	if (mIsOpenScene) dirty |= (int)pGui->addRgbColor("Sky radiance", mSkyRadiance);
+
+	// Per-frame update cost
+	uint32_t probeCount = uint32_t(mProbeCounts.x * mProbeCounts.y * mProbeCounts.z);
+	uint32_t probesPerFrame = getProbesPerFrame();
+	char buf[256];
+	pGui->addText("");
+	sprintf_s(buf, "%u probes, %u updated per frame", probeCount, probesPerFrame);
+	pGui->addText(buf);
+	sprintf_s(buf, "%u rays per frame, every probe refreshed every %u frames", probesPerFrame * uint32_t(mRaysPerProbe),
+	          (probeCount + probesPerFrame - 1) / probesPerFrame);
+	pGui->addText(buf);
+	sprintf_s(buf, "Trace %.3f ms, update %.3f ms, sample %.3f ms", mAvgTraceTime, mAvgUpdateTime, mAvgSampleTime);
+	pGui->addText(buf);
+
+	// If any of our UI parameters changed, let the pipeline know we're doing something different next frame
+	if (dirty) setRefreshFlag();
+}
+
+void DDGIPass::execute(RenderContext* pRenderContext)
+{
+	Texture::SharedPtr pDstTex = mpResManager->getTexture(mOutputTexName);
+
+	// Do we have all the resources we need to render?  If not, return
+	if (!pDstTex || !mpScene || !mpSampleFbo || !mpProbeRays || !mpProbeRays->readyToRender()) return;
+
+	if (mGridNeedsUpdate) createProbeGrid(pRenderContext);
+	if (!mpIrradianceAtlas) return;
+
+	// One row of rays per updated probe
+	uint32_t probesPerFrame = getProbesPerFrame();
+	if (!mpRayRadiance || mpRayRadiance->getWidth() != uint32_t(mRaysPerProbe) || mpRayRadiance->getHeight() != probesPerFrame)
+	{
+		mpRayRadiance = Texture::create2D(uint32_t(mRaysPerProbe), probesPerFrame, ResourceFormat::RGBA32Float, 1, 1, nullptr,
+		                                  Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
+	}
+
+	// A new random rotation every frame, so the probes see new directions
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	float z = 2.0f * uniform(mRng) - 1.0f;
+	float phi = 2.0f * float(M_PI) * uniform(mRng);
+	vec3 axis = vec3(sqrt(1.0f - z * z) * cos(phi), sqrt(1.0f - z * z) * sin(phi), z);
+	mat4 rayRotation = glm::rotate(mat4(1.0f), 2.0f * float(M_PI) * uniform(mRng), axis);
+
+	{
+		Falcor::ProfilerEvent _traceEvent(kTraceEvent);
+		auto rayGenVars = mpProbeRays->getRayGenVars();
+		setProbeGridVars(rayGenVars, rayRotation, probesPerFrame);
+		rayGenVars["RayGenCB"]["gSkyRadiance"] = mIsOpenScene ? mSkyRadiance : vec3(0.0f);
+		rayGenVars["RayGenCB"]["gMinT"] = mpResManager->getMinTDist();
+		rayGenVars["RayGenCB"]["gFrameCount"] = mFrameCount;
+		rayGenVars["gIrradianceAtlas"] = mpIrradianceAtlas;
+		rayGenVars["gDistanceAtlas"] = mpDistanceAtlas;
+		rayGenVars["gLinearSampler"] = mpLinearSampler;
+		rayGenVars["gRayRadiance"] = mpRayRadiance;
+		mpProbeRays->execute(pRenderContext, uvec2(mRaysPerProbe, probesPerFrame));
+	}
+
+	{
+		Falcor::ProfilerEvent _updateEvent(kUpdateEvent);
+		auto irradianceVars = mpUpdateIrradiance->getVars();
+		setProbeGridVars(irradianceVars, rayRotation, probesPerFrame);
+		irradianceVars["UpdateCB"]["gUpdatesSinceReset"] = mUpdatesSinceReset;
+		irradianceVars["gRayRadiance"] = mpRayRadiance;
+		irradianceVars["gIrradianceAtlas"] = mpIrradianceAtlas;
+		mpUpdateIrradiance->execute(pRenderContext, uvec3(kIrradianceTileSize, kIrradianceTileSize, probesPerFrame));
+
+		auto distanceVars = mpUpdateDistance->getVars();
+		setProbeGridVars(distanceVars, rayRotation, probesPerFrame);
+		distanceVars["UpdateCB"]["gUpdatesSinceReset"] = mUpdatesSinceReset;
+		distanceVars["gRayRadiance"] = mpRayRadiance;
+		distanceVars["gDistanceAtlas"] = mpDistanceAtlas;
+		mpUpdateDistance->execute(pRenderContext, uvec3(kDistanceTileSize, kDistanceTileSize, probesPerFrame));
+	}
+
+	{
+		Falcor::ProfilerEvent _sampleEvent(kSampleEvent);
+		auto sampleVars = mpSampleShader->getVars();
+		setProbeGridVars(sampleVars, rayRotation, probesPerFrame);
+		sampleVars["PerFrameCB"]["gCameraPos"] = mpScene->getActiveCamera()->getPosition();
+		sampleVars["PerFrameCB"]["gIntensity"] = mIntensity;
+		sampleVars["gPos"] = mpResManager->getTexture(kInputBufferWorldPosition);
+		sampleVars["gNorm"] = mpResManager->getTexture(kInputBufferWorldNormal);
+		sampleVars["gDiffuseMatl"] = mpResManager->getTexture(kInputBufferDiffuse);
+		sampleVars["gIrradianceAtlas"] = mpIrradianceAtlas;
+		sampleVars["gDistanceAtlas"] = mpDistanceAtlas;
+		sampleVars["gLinearSampler"] = mpLinearSampler;
+		mpGfxState->setFbo(mpSampleFbo);
+		mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
+		mpSampleShader->execute(pRenderContext, mpGfxState);
+		pRenderContext->blit(mpSampleFbo->getColorTexture(0)->getSRV(), pDstTex->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
+	}
+
+	// Rotate the updated subset through the grid
+	uint32_t probeCount = uint32_t(mProbeCounts.x * mProbeCounts.y * mProbeCounts.z);
+	mProbeOffset = (mProbeOffset + probesPerFrame) % probeCount;
+	mUpdatesSinceReset = std::min(mUpdatesSinceReset + probesPerFrame, probeCount);
+	mFrameCount++;
+
+	// Profiler times lag a frame behind, which is fine for a moving average
+	mAvgTraceTime = 0.95 * mAvgTraceTime + 0.05 * Profiler::getEventGpuTime(kTraceEvent);
+	mAvgUpdateTime = 0.95 * mAvgUpdateTime + 0.05 * Profiler::getEventGpuTime(kUpdateEvent);
+	mAvgSampleTime = 0.95 * mAvgSampleTime + 0.05 * Profiler::getEventGpuTime(kSampleEvent);
+}
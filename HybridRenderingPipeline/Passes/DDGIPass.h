@@ -0,0 +1,108 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include "../SharedUtils/RenderPass.h"
+#include "../SharedUtils/FullscreenLaunch.h"
+#include "../SharedUtils/ComputeLaunch.h"
+#include "../SharedUtils/RayLaunch.h"
+#include <random>
+
+/** Real-time diffuse global illumination from a grid of irradiance probes (dynamic diffuse GI).  The probes cover
+    the scene's bounding box.  Every frame:
+      1) ddgiTrace.rt.hlsl traces a fixed budget of rays from a subset of the probes.  The subset rotates through the
+         grid, so every probe is refreshed once per cycle.  Hits are lit by one shadowed light and by last frame's
+         probes, which gives multiple bounces over time.
+      2) ddgiUpdate.cs.hlsl blends the rays into each probe's octahedral irradiance and distance-moment tiles, with
+         hysteresis.
+      3) ddgiSample.ps.hlsl interpolates the 8 probes around each G-buffer pixel, weighted by a backface and a
+         Chebyshev visibility test, and writes the diffuse light they reflect to our output channel.
+    The output is meant to replace the constant ambient term in FinalStagePass (see its indirect channel).
+*/
+class DDGIPass : public ::RenderPass, inherit_shared_from_this<::RenderPass, DDGIPass>
+{
+public:
+    using SharedPtr = std::shared_ptr<DDGIPass>;
+    using SharedConstPtr = std::shared_ptr<const DDGIPass>;
+
+    static SharedPtr create(const std::string& outputChannel) { return SharedPtr(new DDGIPass(outputChannel)); }
+    virtual ~DDGIPass() = default;
+
+protected:
+    DDGIPass(const std::string& outputChannel) : ::RenderPass("Probe GI (DDGI)", "Probe GI Options"), mOutputTexName(outputChannel) {}
+
+    // Implementation of RenderPass interface
+    bool initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager) override;
+    void initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene) override;
+    void execute(RenderContext* pRenderContext) override;
+    void renderGui(Gui* pGui) override;
+    void resize(uint32_t width, uint32_t height) override;
+
+    // The RenderPass class defines various methods we can override to specify this pass' properties. 
+    bool requiresScene() override { return true; }
+    bool usesRayTracing() override { return true; }
+    ResourceManager::ResolutionGroup getResolutionGroup() override { return ResourceManager::ResolutionGroup::Count; }  // Probe updates don't depend on the resolution
+
+    // Places the probes over the scene's bounding box and (re)allocates the atlases.  Clears all probes.
+    void createProbeGrid(RenderContext* pRenderContext);
+
+    // Number of probes traced and blended this frame, given the ray budget
+    uint32_t getProbesPerFrame() const;
+
+    // Sets the constants in ddgiCommon.hlsli
+    void setProbeGridVars(SimpleVars::SharedPtr pVars, const glm::mat4& rayRotation, uint32_t probesPerFrame);
+
+    std::string                             mOutputTexName;
+    RayLaunch::SharedPtr                    mpProbeRays;            ///< Traces this frame's probe rays
+    ComputeLaunch::SharedPtr                mpUpdateIrradiance;     ///< Blends the rays into the irradiance atlas
+    ComputeLaunch::SharedPtr                mpUpdateDistance;       ///< Blends the rays into the distance atlas
+    FullscreenLaunch::SharedPtr             mpSampleShader;         ///< Looks up the probes for each pixel
+    GraphicsState::SharedPtr                mpGfxState;
+    Fbo::SharedPtr                          mpSampleFbo;
+    Sampler::SharedPtr                      mpLinearSampler;
+    RtScene::SharedPtr                      mpScene;
+
+    // Probe state
+    Texture::SharedPtr                      mpIrradianceAtlas;      ///< Octahedral irradiance tiles (RGB) and whether the probe was updated yet (A)
+    Texture::SharedPtr                      mpDistanceAtlas;        ///< Octahedral tiles of the mean and mean squared hit distance
+    Texture::SharedPtr                      mpRayRadiance;          ///< This frame's rays, one row per updated probe
+    vec3                                    mProbeOrigin = vec3(0.0f);
+    vec3                                    mProbeSpacing = vec3(1.0f);
+    float                                   mMaxRayDistance = 1.0f;
+    uint32_t                                mProbeOffset = 0;       ///< First probe updated next frame
+    uint32_t                                mUpdatesSinceReset = 0; ///< Probe updates since the atlases were cleared, up to the probe count
+    bool                                    mGridNeedsUpdate = true;
+    uint32_t                                mFrameCount = 0;        ///< Frame count used to help seed our shaders' random number generator
+    std::mt19937                            mRng;                   ///< Picks each frame's ray rotation
+
+    // Parameters
+    ivec3                                   mProbeCounts = ivec3(16, 8, 16);
+    int32_t                                 mRaysPerProbe = 128;
+    int32_t                                 mRayBudget = 32768;     ///< Probe rays traced per frame
+    float                                   mHysteresis = 0.97f;    ///< Weight of the old probe texels when blending in new rays
+    float                                   mNormalBias = 0.05f;    ///< Relative to the smallest probe spacing
+    float                                   mViewBias = 0.2f;       ///< Relative to the smallest probe spacing
+    float                                   mIntensity = 1.0f;
+    bool                                    mIsOpenScene = true;    ///< Do rays that leave the scene see the sky?
+    vec3                                    mSkyRadiance = vec3(0.053f, 0.081f, 0.092f);   ///< Same as ReflectionPass' sky
+
+    // Update cost, so the budget can be tuned (moving averages, in ms)
+    double                                  mAvgTraceTime = 0.0;
+    double                                  mAvgUpdateTime = 0.0;
+    double                                  mAvgSampleTime = 0.0;
+};
@@ -42,6 +42,10 @@ bool DirectLightingPass::initialize(RenderContext* pRenderContext, ResourceManag
 	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough" });
 	mpResManager->requestTextureResource(mOutputTexName);
 
+	// Tell the pipeline which channels we read and write, so it can order (or cull) us appropriately
+	declareInputs({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough" });
+	declareOutputs({ mOutputTexName });
+
 	// Create our graphics state and an accumulation shader
 	mpGfxState = GraphicsState::create();
 	mpLambertShader = FullscreenLaunch::create(kLambertShader);
@@ -78,6 +82,15 @@ void DirectLightingPass::renderGui(Gui* pGui)
 
 	// Display a count of accumulated frames
 	pGui->addText("");
+
+	// Environment map lighting, importance sampled with the resource manager's alias tables
+	int dirty = 0;
+	dirty |= (int)pGui->addCheckBox("Light with the environment map", mEnvLighting);
+	if (mEnvLighting)
+	{
+		dirty |= (int)pGui->addIntVar("Env. map samples per pixel", mEnvSamples, 1, 64);
+	}
+	if (dirty) setRefreshFlag();
 }
 
 void DirectLightingPass::execute(RenderContext* pRenderContext)
@@ -96,9 +109,23 @@ void DirectLightingPass::execute(RenderContext* pRenderContext)
 	shaderVars["gDiffuseMatl"] = mpResManager->getTexture("MaterialDiffuse");
 	shaderVars["gSpecMatl"] = mpResManager->getTexture("MaterialSpecRough");
 
-    // Execute the accumulation shader
+	// Without the environment map's alias tables, we can't sample it
+	EnvMapSampler::SharedPtr pEnvSampler = mpResManager->getEnvironmentMapSampler();
+	bool envLighting = mEnvLighting && pEnvSampler;
+	shaderVars["EnvCB"]["gEnvSamples"] = uint32_t(envLighting ? mEnvSamples : 0);
+	shaderVars["EnvCB"]["gFrameCount"] = mFrameCount++;
+	shaderVars["EnvCB"]["gRenderDim"] = mpResManager->getRenderSize();
+	if (envLighting)
+	{
+		shaderVars["gEnvMap"] = mpResManager->getTexture(ResourceManager::kEnvironmentMap);
+		shaderVars["gEnvMarginal"] = pEnvSampler->getMarginalBuffer();
+		shaderVars["gEnvConditional"] = pEnvSampler->getConditionalBuffer();
+	}
+
+    // Execute the accumulation shader, over the pixels the G-buffer rendered
+    mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
     mpLambertShader->execute(pRenderContext, mpGfxState);
 
     // We've accumulated our result.  Copy that back to the input/output buffer
-    pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), pDstTex->getRTV());
+    pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), pDstTex->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 }
@@ -52,4 +52,9 @@ protected:
 
 	// We stash a copy of our current scene.  Why?  To detect if changes have occurred.
 	Scene::SharedPtr              mpScene;
+
+	// Environment map lighting.  Unshadowed, like the lights; VisibilityPass shadows it with the share we write to alpha.
+	bool                          mEnvLighting = false;   ///< Off by default: the default environment map is a constant sky color
+	int32_t                       mEnvSamples = 4;        ///< Importance-sampled directions per pixel
+	uint32_t                      mFrameCount = 0;        ///< Seeds the random numbers
 };
@@ -29,27 +29,49 @@ namespace {
 };
 
 // Define our constructor methods
-FinalStagePass::SharedPtr FinalStagePass::create(const std::string & bufferOut)
+FinalStagePass::SharedPtr FinalStagePass::create(const std::string & bufferOut, bool shadowedDirectLighting, const std::string &indirectChannel)
 { 
-	return SharedPtr(new FinalStagePass(bufferOut));
+	return SharedPtr(new FinalStagePass(bufferOut, shadowedDirectLighting, indirectChannel));
 }
 
-FinalStagePass::FinalStagePass(const std::string &bufferOut)
+FinalStagePass::FinalStagePass(const std::string &bufferOut, bool shadowedDirectLighting, const std::string &indirectChannel)
 	: ::RenderPass("FinalStagePass Pass", "FinalStage Options")
 {
 	mOutputTexName = bufferOut;
+	mShadowedDirectLighting = shadowedDirectLighting;
+	mIndirectTexName = indirectChannel;
 }
 
 bool FinalStagePass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
 {
 	// Stash our resource manager; ask for the texture the developer asked us to write
 	mpResManager = pResManager;
-	mpResManager->requestTextureResources({ kWorldPos, kShadowAOChannel, kDirectLightChannel, kReflectionChannel });
+	mpResManager->requestTextureResources({ kWorldPos, kDirectLightChannel, kReflectionChannel });
 	mpResManager->requestTextureResource(mOutputTexName);
 
+	// Tell the pipeline which channels we read and write, so it can order (or cull) us appropriately.  Shadows already
+	//     in the direct lighting mean nobody needs to produce the shadow channel.
+	if (mShadowedDirectLighting)
+	{
+		declareInputs({ kWorldPos, kDirectLightChannel, kReflectionChannel, kEmissiveChannel });
+	}
+	else
+	{
+		mpResManager->requestTextureResource(kShadowAOChannel);
+		declareInputs({ kWorldPos, kShadowAOChannel, kDirectLightChannel, kReflectionChannel, kEmissiveChannel });
+	}
+	if (!mIndirectTexName.empty())
+	{
+		mpResManager->requestTextureResource(mIndirectTexName);
+		declareInputs({ mIndirectTexName });
+	}
+	declareOutputs({ mOutputTexName });
+
 	// Create our graphics state and an accumulation shader
 	mpGfxState = GraphicsState::create();
 	mpShader = FullscreenLaunch::create(kLambertShader);
+	if (mShadowedDirectLighting) mpShader->addDefine("SHADOWED_DIRECT_LIGHTING", "1");
+	if (!mIndirectTexName.empty()) mpShader->addDefine("INDIRECT_DIFFUSE", "1");
 
 	return true;
 }
@@ -92,13 +114,15 @@ void FinalStagePass::execute(RenderContext* pRenderContext)
 	auto shaderVars = mpShader->getVars();
 	shaderVars["gReflection"] = mpResManager->getTexture(kReflectionChannel);
 	shaderVars["gDirectLighting"] = mpResManager->getTexture(kDirectLightChannel);
-	shaderVars["gShadowAO"] = mpResManager->getTexture(kShadowAOChannel);
+	if (!mShadowedDirectLighting) shaderVars["gShadowAO"] = mpResManager->getTexture(kShadowAOChannel);
 	shaderVars["gEmissive"] = mpResManager->getTexture(kEmissiveChannel);
+	if (!mIndirectTexName.empty()) shaderVars["gIndirectDiffuse"] = mpResManager->getTexture(mIndirectTexName);
 	shaderVars["gPos"] = mpResManager->getTexture(kWorldPos);
 
-  // Execute the accumulation shader
+  // Execute the accumulation shader, over the pixels the G-buffer rendered
+  mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
   mpShader->execute(pRenderContext, mpGfxState);
 
   // We've accumulated our result.  Copy that back to the input/output buffer
-  pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), pDstTex->getRTV());
+  pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), pDstTex->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 }
@@ -27,11 +27,15 @@ class FinalStagePass : public ::RenderPass, inherit_shared_from_this<::RenderPas
 public:
     using SharedPtr = std::shared_ptr<FinalStagePass>;
 
-	static SharedPtr create(const std::string &bufferToAccumulate = ResourceManager::kOutputChannel);
+	// If <shadowedDirectLighting> is true, the direct lighting channel already contains shadows (e.g., from
+	//     RestirDirectLightingPass) and the shadow / AO channel is not used.  If <indirectChannel> is given, the indirect
+	//     diffuse light it holds (e.g., from DDGIPass) replaces the constant ambient term.
+	static SharedPtr create(const std::string &bufferToAccumulate = ResourceManager::kOutputChannel, bool shadowedDirectLighting = false,
+	                        const std::string &indirectChannel = "");
 	virtual ~FinalStagePass() = default;
 
 protected:
-	FinalStagePass(const std::string &bufferToAccumulate);
+	FinalStagePass(const std::string &bufferToAccumulate, bool shadowedDirectLighting, const std::string &indirectChannel);
 
     // Implementation of SimpleRenderPass interface
 	bool initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager) override;
@@ -44,6 +48,8 @@ protected:
 	bool appliesPostprocess() override { return true; }
 
 	std::string                   mOutputTexName;
+	bool                          mShadowedDirectLighting;
+	std::string                   mIndirectTexName;
 
 	// State for our shader
 	FullscreenLaunch::SharedPtr   mpShader;
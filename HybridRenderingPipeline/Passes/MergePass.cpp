@@ -44,6 +44,10 @@ bool MergePass::initialize(RenderContext* pRenderContext, ResourceManager::Share
   mpResManager->requestTextureResource(mBuffersToMerge[1]);
 	mpResManager->requestTextureResource(mOutputTexName);
 
+	// Tell the pipeline which channels we read and write, so it can order (or cull) us appropriately
+	declareInputs({ mBuffersToMerge[0], mBuffersToMerge[1] });
+	declareOutputs({ mOutputTexName });
+
 	// Create our graphics state and an accumulation shader
 	mpGfxState = GraphicsState::create();
 	mpShader = FullscreenLaunch::create(kLambertShader);
@@ -79,8 +83,9 @@ void MergePass::execute(RenderContext* pRenderContext)
   shaderVars["gM1"] = mpResManager->getTexture(mBuffersToMerge[0]);
   shaderVars["gM2"] = mpResManager->getTexture(mBuffersToMerge[1]);
 
-  // Execute the accumulation shader
+  // Execute the accumulation shader, over the pixels the G-buffer rendered
+  mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
   mpShader->execute(pRenderContext, mpGfxState);
   // We've accumulated our result.  Copy that back to the input/output buffer
-  pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), pDstTex->getRTV());
+  pRenderContext->blit(mpInternalFbo->getColorTexture(0)->getSRV(), pDstTex->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 }
@@ -42,6 +42,7 @@ protected:
 
 	// The RenderPass class defines various methods we can override to specify this pass' properties. 
 	bool appliesPostprocess() override { return true; }
+	bool canRecordInParallel() override { return true; }
 
 	std::string                   mOutputTexName;
   std::vector<std::string>      mBuffersToMerge;
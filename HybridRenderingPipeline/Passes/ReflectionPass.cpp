@@ -25,6 +25,7 @@ namespace {
 
 	// What are the entry points in that shader for various ray tracing shaders?
 	const char* kEntryPointRayGen = "ReflectRayGen";
+	const char* kEntryPointSortedRayGen = "ReflectSortedRayGen";
 	const char* kEntryPointMiss0 = "ReflectMiss";
 	const char* kEntryReflectAnyHit = "ReflectAnyHit";
 	const char* kEntryReflectClosestHit = "ReflectClosestHit";
@@ -32,27 +33,96 @@ namespace {
 	const char* kEntryPointMiss1 = "ShadowMiss";
 	const char* kEntryShadowAnyHit = "ShadowAnyHit";
 	const char* kEntryShadowClosestHit = "ShadowClosestHit";
+
+	// Our compute shader that bins and sorts rays, and its entry points
+	const char* kFileRayBinning = "reflectionBinning.cs.hlsl";
+	const char* kEntryBinCount = "BinCount";
+	const char* kEntryBinScan = "BinScan";
+	const char* kEntryBinScatter = "BinScatter";
+
+	// Must match RAY_BIN_COUNT in rayBinning.hlsli (and RayBinning::kBinCount)
+	const uint32_t kRayBinCount = 1u << 15;
+
+	// Our compute shaders for screen-space reflections, and their entry points
+	const char* kFileHiZ = "hiZBuild.cs.hlsl";
+	const char* kEntryHiZBuildBase = "HiZBuildBase";
+	const char* kEntryHiZDownsample = "HiZDownsample";
+	const char* kFileScreenSpace = "reflectionSSR.cs.hlsl";
+	const char* kEntryScreenSpace = "ScreenSpaceReflect";
+
+	// Must match HIZ_MAX_LEVELS in hiZ.hlsli
+	const uint32_t kHiZMaxLevels = 16;
+
+	// Profiler events we time to compute ray throughput
+	const char* kTraceEvent = "ReflectionTrace";
+	const char* kBinningEvent = "ReflectionBinning";
+	const char* kScreenSpaceEvent = "ReflectionScreenSpace";
 };
 
+// Mirrors hiZLevelSize() in hiZ.hlsli
+static uvec2 hiZLevelSize(uvec2 baseSize, uint32_t level)
+{
+	return glm::max(uvec2(1), (baseSize + uvec2((1u << level) - 1u)) >> level);
+}
+
+// Mirrors hiZLevelCount() in hiZ.hlsli
+static uint32_t hiZLevelCount(uvec2 baseSize)
+{
+	uint32_t levels = 1;
+	while (glm::any(glm::greaterThan(hiZLevelSize(baseSize, levels - 1), uvec2(1))) && levels < kHiZMaxLevels) levels++;
+	return levels;
+}
+
+// Creates a ray launch with our two ray types, using the specified ray generation shader
+static RayLaunch::SharedPtr createReflectionRays(const char* rayGenEntryPoint)
+{
+	RayLaunch::SharedPtr pRays = RayLaunch::create(kFileRayTrace, rayGenEntryPoint);
+	// Add ray type #0 (reflection rays)
+	pRays->addMissShader(kFileRayTrace, kEntryPointMiss0);
+	pRays->addHitShader(kFileRayTrace, kEntryReflectClosestHit, kEntryReflectAnyHit);
+
+	// Add ray type #1 (shadow rays)
+	pRays->addMissShader(kFileRayTrace, kEntryPointMiss1);
+	pRays->addHitShader(kFileRayTrace, kEntryShadowClosestHit, kEntryShadowAnyHit);
+
+	pRays->compileRayProgram();
+	return pRays;
+}
+
 bool ReflectionPass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
 {
 	// Keep a copy of our resource manager; request needed buffer resources
 	mpResManager = pResManager;
-	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough", "shadowChannel" });
+	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough" });
 	mpResManager->requestTextureResource(mAccumChannel);
+	if (mScreenSpaceFirst) mpResManager->requestTextureResource(mLitChannel);
 
-	// Create our wrapper around a ray tracing pass.  Tell it where our shaders are, then compile/link the program
-	mpRays = RayLaunch::create(kFileRayTrace, kEntryPointRayGen);
-	// Add ray type #0 (reflection rays)
-	mpRays->addMissShader(kFileRayTrace, kEntryPointMiss0);
-	mpRays->addHitShader(kFileRayTrace, kEntryReflectClosestHit, kEntryReflectAnyHit);
+	// Tell the pipeline which channels we read and write, so it can order (or cull) us appropriately
+	declareChannels();
 
-	// Add ray type #1 (shadow rays)
-	mpRays->addMissShader(kFileRayTrace, kEntryPointMiss1);
-	mpRays->addHitShader(kFileRayTrace, kEntryShadowClosestHit, kEntryShadowAnyHit);
+	// Create our wrappers around a ray tracing pass.  Tell it where our shaders are, then compile/link the program.
+	//     The second traces the same rays in the order our binning shaders sorted them.
+	mpRays = createReflectionRays(kEntryPointRayGen);
+	mpSortedRays = createReflectionRays(kEntryPointSortedRayGen);
+	if (mpScene)
+	{
+		mpRays->setScene(mpScene);
+		mpSortedRays->setScene(mpScene);
+	}
+
+	// Create our compute passes that sort rays
+	mpBinCount = ComputeLaunch::create(kFileRayBinning, kEntryBinCount);
+	mpBinScan = ComputeLaunch::create(kFileRayBinning, kEntryBinScan);
+	mpBinScatter = ComputeLaunch::create(kFileRayBinning, kEntryBinScatter);
+	mpBinCounts = TypedBuffer<uint32_t>::create(kRayBinCount);
+	mpBinOffsets = TypedBuffer<uint32_t>::create(kRayBinCount);
+	mpRayCount = TypedBuffer<uint32_t>::create(2);
 
-	mpRays->compileRayProgram();
-	if (mpScene) mpRays->setScene(mpScene);
+	// Create our compute passes for screen-space reflections
+	mpHiZBuildBase = ComputeLaunch::create(kFileHiZ, kEntryHiZBuildBase);
+	mpHiZDownsample = ComputeLaunch::create(kFileHiZ, kEntryHiZDownsample);
+	mpScreenSpace = ComputeLaunch::create(kFileScreenSpace, kEntryScreenSpace);
+	mpRayCountReadback = GpuReadback::create(2 * sizeof(uint32_t));
 	return true;
 }
 
@@ -61,6 +131,144 @@ void ReflectionPass::initScene(RenderContext* pRenderContext, Scene::SharedPtr p
 	// Stash a copy of the scene and pass it to our ray tracer (if initialized)
 	mpScene = std::dynamic_pointer_cast<RtScene>(pScene);
 	if (mpRays) mpRays->setScene(mpScene);
+	if (mpSortedRays) mpSortedRays->setScene(mpScene);
+}
+
+void ReflectionPass::allocateRayBuffers(uint32_t rayCount)
+{
+	if (rayCount == mAllocatedRayCount) return;
+	mpRayKeys = TypedBuffer<uint32_t>::create(rayCount);
+	mpSortedRayList = TypedBuffer<uint32_t>::create(rayCount);
+	mAllocatedRayCount = rayCount;
+}
+
+void ReflectionPass::sortRays(RenderContext* pRenderContext, Texture::SharedPtr pDstTex, uvec2 binDim)
+{
+	allocateRayBuffers(binDim.x * binDim.y);
+
+	// Bin over the scene's bounding box
+	vec3 sceneMin = mpScene->getCenter() - vec3(mpScene->getRadius());
+	vec3 sceneExtent = vec3(2.0f * mpScene->getRadius());
+
+	auto countVars = mpBinCount->getVars();
+	countVars["BinningCB"]["gSceneMin"] = sceneMin;
+	countVars["BinningCB"]["gFrameCount"] = mFrameCount;
+	countVars["BinningCB"]["gSceneExtent"] = sceneExtent;
+	countVars["BinningCB"]["gHalfResolution"] = uint32_t(mTraceHalfResolution ? 1 : 0);
+	countVars["BinningCB"]["gCameraPos"] = mpScene->getActiveCamera()->getPosition();
+	countVars["BinningCB"]["gLaunchDim"] = mpResManager->getRenderSize();
+	countVars["BinningCB"]["gBinDim"] = binDim;
+	countVars["gPos"] = mpResManager->getTexture("WorldPosition");
+	countVars["gNorm"] = mpResManager->getTexture("WorldNormal");
+	countVars["gSpecMatl"] = mpResManager->getTexture("MaterialSpecRough");
+	countVars["gSobolDirections"] = mpResManager->getSobolDirections();
+	countVars["gOutput"] = pDstTex;
+	countVars["gKeys"] = mpRayKeys;
+	countVars["gBinCounts"] = mpBinCounts;
+
+	auto scanVars = mpBinScan->getVars();
+	scanVars["gBinCounts"] = mpBinCounts;
+	scanVars["gBinOffsets"] = mpBinOffsets;
+	scanVars["gRayCount"] = mpRayCount;
+
+	auto scatterVars = mpBinScatter->getVars();
+	scatterVars["BinningCB"]["gBinDim"] = binDim;
+	scatterVars["gKeys"] = mpRayKeys;
+	scatterVars["gBinOffsets"] = mpBinOffsets;
+	scatterVars["gSortedRays"] = mpSortedRayList;
+
+	// Histogram, scan, scatter.  Each step reads the UAVs the last one wrote, so we need barriers in between.
+	pRenderContext->clearUAV(mpBinCounts->getUAV().get(), uvec4(0));
+	mpBinCount->execute(pRenderContext, uvec3(binDim, 1));
+	pRenderContext->uavBarrier(mpBinCounts.get());
+	pRenderContext->uavBarrier(mpRayKeys.get());
+	mpBinScan->executeGroups(pRenderContext, uvec3(1));
+	pRenderContext->uavBarrier(mpBinOffsets.get());
+	pRenderContext->uavBarrier(mpRayCount.get());
+	mpBinScatter->execute(pRenderContext, uvec3(binDim, 1));
+}
+
+void ReflectionPass::buildHiZ(RenderContext* pRenderContext)
+{
+	// Size the pyramid for the full screen, so changing the render scale doesn't reallocate it, but only build it over the rendered pixels
+	uvec2 screenSize = mpResManager->getScreenSize();
+	if (screenSize != mHiZSize)
+	{
+		uint32_t elementCount = 0;
+		for (uint32_t level = 0; level < hiZLevelCount(screenSize); level++)
+		{
+			uvec2 size = hiZLevelSize(screenSize, level);
+			elementCount += size.x * size.y;
+		}
+		mpHiZ = TypedBuffer<float>::create(elementCount);
+		mHiZSize = screenSize;
+	}
+	uvec2 baseSize = mpResManager->getRenderSize();
+	uint32_t levelCount = hiZLevelCount(baseSize);
+
+	const Camera::SharedPtr& pCamera = mpScene->getActiveCamera();
+	vec3 cameraForward = glm::normalize(pCamera->getTarget() - pCamera->getPosition());
+
+	auto baseVars = mpHiZBuildBase->getVars();
+	baseVars["HiZCB"]["gCameraPos"] = pCamera->getPosition();
+	baseVars["HiZCB"]["gCameraForward"] = cameraForward;
+	baseVars["HiZCB"]["gBaseSize"] = baseSize;
+	baseVars["gPos"] = mpResManager->getTexture("WorldPosition");
+	baseVars["gHiZ"] = mpHiZ;
+	mpHiZBuildBase->execute(pRenderContext, uvec3(baseSize, 1));
+
+	// Each level reads the one before it, so we need a barrier between each
+	auto downVars = mpHiZDownsample->getVars();
+	downVars["HiZCB"]["gBaseSize"] = baseSize;
+	downVars["gHiZ"] = mpHiZ;
+	for (uint32_t level = 1; level < levelCount; level++)
+	{
+		pRenderContext->uavBarrier(mpHiZ.get());
+		downVars["HiZCB"]["gDstLevel"] = level;
+		mpHiZDownsample->execute(pRenderContext, uvec3(hiZLevelSize(baseSize, level), 1));
+	}
+	pRenderContext->uavBarrier(mpHiZ.get());
+}
+
+void ReflectionPass::traceScreenSpace(RenderContext* pRenderContext, Texture::SharedPtr pDstTex, uvec2 binDim)
+{
+	allocateRayBuffers(binDim.x * binDim.y);
+	buildHiZ(pRenderContext);
+
+	const Camera::SharedPtr& pCamera = mpScene->getActiveCamera();
+	vec3 cameraForward = glm::normalize(pCamera->getTarget() - pCamera->getPosition());
+
+	auto ssrVars = mpScreenSpace->getVars();
+	ssrVars["SSRCB"]["gViewProj"] = pCamera->getViewProjMatrix();
+	ssrVars["SSRCB"]["gCameraPos"] = pCamera->getPosition();
+	ssrVars["SSRCB"]["gFrameCount"] = mFrameCount;
+	ssrVars["SSRCB"]["gCameraForward"] = cameraForward;
+	ssrVars["SSRCB"]["gHalfResolution"] = uint32_t(mTraceHalfResolution ? 1 : 0);
+	ssrVars["SSRCB"]["gLaunchDim"] = mpResManager->getRenderSize();
+	ssrVars["SSRCB"]["gBinDim"] = binDim;
+	ssrVars["SSRCB"]["gBaseSize"] = mpResManager->getRenderSize();
+	ssrVars["SSRCB"]["gMaxSteps"] = uint32_t(mSSRMaxSteps);
+	ssrVars["SSRCB"]["gThickness"] = mSSRThickness;
+	ssrVars["SSRCB"]["gMaxDistance"] = 2.0f * mpScene->getRadius();
+	ssrVars["gPos"] = mpResManager->getTexture("WorldPosition");
+	ssrVars["gNorm"] = mpResManager->getTexture("WorldNormal");
+	ssrVars["gSpecMatl"] = mpResManager->getTexture("MaterialSpecRough");
+	ssrVars["gLit"] = mpResManager->getTexture(mLitChannel);
+	ssrVars["gHiZ"] = mpHiZ;
+	ssrVars["gSobolDirections"] = mpResManager->getSobolDirections();
+	ssrVars["gOutput"] = pDstTex;
+	ssrVars["gFallbackRays"] = mpSortedRayList;
+	ssrVars["gRayCount"] = mpRayCount;
+
+	pRenderContext->clearUAV(mpRayCount->getUAV().get(), uvec4(0));
+	mpScreenSpace->execute(pRenderContext, uvec3(binDim, 1));
+	pRenderContext->uavBarrier(mpRayCount.get());
+
+	// Grab the counts for the GUI (these arrive a few frames late)
+	mpRayCountReadback->copy(pRenderContext, mpRayCount);
+	uint32_t counts[2];
+	if (mpRayCountReadback->read(counts))
+		mFallbackFraction = counts[1] > 0 ? float(counts[0]) / float(counts[1]) : 0.0f;
 }
 
 void ReflectionPass::execute(RenderContext* pRenderContext)
@@ -70,23 +278,77 @@ void ReflectionPass::execute(RenderContext* pRenderContext)
 
 	// Do we have all the resources we need to render?  If not, return
 	if (!pDstTex || !mpRays || !mpRays->readyToRender()) return;
+	bool useScreenSpace = mScreenSpaceFirst && mpSortedRays && mpSortedRays->readyToRender() && mpResManager->getTexture(mLitChannel);
+	bool useSortedRays = !useScreenSpace && mSortRays && mpSortedRays && mpSortedRays->readyToRender();
+
+	// Trace at half resolution if asked to, or if the dynamic resolution controller wants reflections well below the G-buffer's resolution
+	mTraceHalfResolution = mHalfResolution ||
+		mpResManager->getRenderScale(ResourceManager::ResolutionGroup::Reflection) < 0.75f * mpResManager->getRenderScale(ResourceManager::ResolutionGroup::GBuffer);
+
+	// How many rays do we actually shoot?  (One per 2x2 block at half resolution.)
+	uvec2 screenSize = mpResManager->getRenderSize();
+	uvec2 binDim = mTraceHalfResolution ? (screenSize + uvec2(1)) / 2u : screenSize;
+
+	if (useScreenSpace)
+	{
+		// Resolve what we can on screen; whatever's left goes in the ray list
+		Falcor::ProfilerEvent _screenSpaceEvent(kScreenSpaceEvent);
+		traceScreenSpace(pRenderContext, pDstTex, binDim);
+	}
+	else if (useSortedRays)
+	{
+		Falcor::ProfilerEvent _binningEvent(kBinningEvent);
+		sortRays(pRenderContext, pDstTex, binDim);
+	}
 
-	// Set our ray tracing shader variables 
-	auto rayGenVars = mpRays->getRayGenVars();
+	// Set our ray tracing shader variables.  Both screen-space reflections and sorting leave us a list of rays to trace.
+	bool traceRayList = useScreenSpace || useSortedRays;
+	RayLaunch::SharedPtr pRays = traceRayList ? mpSortedRays : mpRays;
+	auto rayGenVars = pRays->getRayGenVars();
 	rayGenVars["RayGenCB"]["gMinT"] = mpResManager->getMinTDist();
 	rayGenVars["RayGenCB"]["gFrameCount"] = mFrameCount++;
 	rayGenVars["RayGenCB"]["gOpenScene"] = mIsOpenScene;
-	rayGenVars["RayGenCB"]["gHalfResolution"] = mHalfResolution;
+	rayGenVars["RayGenCB"]["gHalfResolution"] = mTraceHalfResolution;
+	rayGenVars["gSobolDirections"] = mpResManager->getSobolDirections();
+	if (traceRayList)
+	{
+		rayGenVars["RayGenCB"]["gLaunchDim"] = screenSize;
+		rayGenVars["gSortedRays"] = mpSortedRayList;
+		rayGenVars["gRayCount"] = mpRayCount;
+	}
 	// Pass our G-buffer textures down to the HLSL so we can shade
 	rayGenVars["gPos"] = mpResManager->getTexture("WorldPosition");
 	rayGenVars["gNorm"] = mpResManager->getTexture("WorldNormal");
 	rayGenVars["gDiffuseMatl"] = mpResManager->getTexture("MaterialDiffuse");
 	rayGenVars["gSpecMatl"] = mpResManager->getTexture("MaterialSpecRough");
-	rayGenVars["gShadow"] = mpResManager->getTexture("shadowChannel");
 	rayGenVars["gOutput"] = pDstTex;
 
-	// Shoot our rays and shade our primary hit points
-	mpRays->execute(pRenderContext, mpResManager->getScreenSize());
+	// Shoot our rays and shade our primary hit points.  The sorted launch only needs one thread per possible ray
+	//     (the unsorted one keeps its full-screen launch, since its launch size seeds the random numbers).
+	{
+		Falcor::ProfilerEvent _traceEvent(kTraceEvent);
+		pRays->execute(pRenderContext, traceRayList ? binDim : screenSize);
+	}
+
+	// Profiler times lag a frame behind, which is fine for a moving average.  Count every possible ray (including
+	//     pixels with no geometry) in both modes, so the numbers compare like-for-like.
+	double traceMs = Profiler::getEventGpuTime(kTraceEvent);
+	if (traceMs > 0.0 && !useScreenSpace)
+	{
+		double& avg = mAvgRaysPerSec[useSortedRays ? 1 : 0];
+		double raysPerSec = double(binDim.x) * double(binDim.y) / (traceMs * 1.0e-3);
+		avg = (avg == 0.0) ? raysPerSec : 0.95 * avg + 0.05 * raysPerSec;
+	}
+	if (useSortedRays) mAvgBinningTime = 0.95 * mAvgBinningTime + 0.05 * Profiler::getEventGpuTime(kBinningEvent);
+}
+
+void ReflectionPass::declareChannels()
+{
+	// Only the screen-space march reads the lit image, so don't make the pipeline keep (or wait on) it otherwise
+	clearDeclaredChannels();
+	declareInputs({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough" });
+	if (mScreenSpaceFirst) declareInputs({ mLitChannel });
+	declareOutputs({ mAccumChannel }, Resource::State::UnorderedAccess);
 }
 
 void ReflectionPass::renderGui(Gui* pGui)
@@ -96,6 +358,37 @@ void ReflectionPass::renderGui(Gui* pGui)
 
 	dirty |= (int)pGui->addCheckBox("Is Open Scene", mIsOpenScene);
 	dirty |= (int)pGui->addCheckBox("Half Resolution", mHalfResolution);
+	if (pGui->addCheckBox("Screen-space first (Hi-Z)", mScreenSpaceFirst))
+	{
+		// The lit image is only created once something asks for it
+		if (mScreenSpaceFirst)
+		{
+			mpResManager->requestTextureResource(mLitChannel);
+			mpResManager->initializeResources();
+		}
+		declareChannels();
+		setRebindFlag();
+		dirty = 1;
+	}
+	if (mScreenSpaceFirst)
+	{
+		dirty |= (int)pGui->addIntVar("Max Hi-Z steps", mSSRMaxSteps, 1, 512);
+		dirty |= (int)pGui->addFloatVar("Surface thickness", mSSRThickness, 0.0f, 1.0f, 0.001f);
+
+		char fraction[64];
+		sprintf_s(fraction, "Pixels needing DXR rays: %.1f%%", 100.0f * mFallbackFraction);
+		pGui->addText(fraction);
+	}
+	else
+	{
+		dirty |= (int)pGui->addCheckBox("Sort rays by coherence", mSortRays);
+	}
+
+	char buf[256];
+	sprintf_s(buf, "Unsorted: %.1f Mrays/s", mAvgRaysPerSec[0] * 1.0e-6);
+	pGui->addText(buf);
+	sprintf_s(buf, "Sorted: %.1f Mrays/s (+%.3f ms binning)", mAvgRaysPerSec[1] * 1.0e-6, mAvgBinningTime);
+	pGui->addText(buf);
 
 	// If any of our UI parameters changed, let the pipeline know we're doing something different next frame
 	if (dirty) setRefreshFlag();
@@ -1,6 +1,8 @@
 #pragma once
 #include "../SharedUtils/RenderPass.h"
 #include "../SharedUtils/RayLaunch.h"
+#include "../SharedUtils/ComputeLaunch.h"
+#include "../SharedUtils/GpuReadback.h"
 
 /** Ray traced ambient occlusion pass.
 */
@@ -10,12 +12,13 @@ public:
     using SharedPtr = std::shared_ptr<ReflectionPass>;
     using SharedConstPtr = std::shared_ptr<const ReflectionPass>;
 
-    static SharedPtr create(const std::string& channel) { return SharedPtr(new ReflectionPass(channel)); }
+    static SharedPtr create(const std::string& channel, const std::string& litChannel = "directLightingChannel") { return SharedPtr(new ReflectionPass(channel, litChannel)); }
     virtual ~ReflectionPass() = default;
 
 protected:
-    ReflectionPass(const std::string& channel) : ::RenderPass("Reflection", "Reflection Options") {
+    ReflectionPass(const std::string& channel, const std::string& litChannel) : ::RenderPass("Reflection", "Reflection Options") {
         mAccumChannel = channel;
+        mLitChannel = litChannel;
     }
 
     // Implementation of RenderPass interface
@@ -27,15 +30,61 @@ protected:
     // The RenderPass class defines various methods we can override to specify this pass' properties. 
     bool requiresScene() override { return true; }
     bool usesRayTracing() override { return true; }
+    bool canRunAsync() override { return true; }
+    ResourceManager::ResolutionGroup getResolutionGroup() override { return ResourceManager::ResolutionGroup::Reflection; }
+
+    // Sorts this frame's reflection rays by direction and origin (see RayBinning.h) so they're traced coherently
+    void sortRays(RenderContext* pRenderContext, Texture::SharedPtr pDstTex, uvec2 binDim);
+
+    // (Re)allocates the per-ray buffers if the number of rays changed
+    void allocateRayBuffers(uint32_t rayCount);
+
+    // Declares our channels to the pipeline; the lit image is only an input when mScreenSpaceFirst is set
+    void declareChannels();
+
+    // Builds the Hi-Z pyramid, then marches rays through it.  Rays that miss on screen go to mpSortedRayList
+    void buildHiZ(RenderContext* pRenderContext);
+    void traceScreenSpace(RenderContext* pRenderContext, Texture::SharedPtr pDstTex, uvec2 binDim);
 
     // Rendering state
     std::string                             mAccumChannel;
+    std::string                             mLitChannel;            ///< Lit image that screen-space hits are shaded from
     RayLaunch::SharedPtr                    mpRays;                 ///< Our wrapper around a DX Raytracing pass
+    RayLaunch::SharedPtr                    mpSortedRays;           ///< Same as mpRays, but traces rays in the order mpBinScatter sorted them
     RtScene::SharedPtr                      mpScene;                ///< Our scene file (passed in from app)  
 
+    // Ray binning state
+    ComputeLaunch::SharedPtr                mpBinCount;             ///< Generates rays, computes their keys and histograms them
+    ComputeLaunch::SharedPtr                mpBinScan;              ///< Prefix sum over the bin histogram
+    ComputeLaunch::SharedPtr                mpBinScatter;           ///< Writes each ray into its place in the sorted list
+    TypedBufferBase::SharedPtr              mpRayKeys;              ///< Per-ray bin key
+    TypedBufferBase::SharedPtr              mpBinCounts;            ///< Per-bin ray count
+    TypedBufferBase::SharedPtr              mpBinOffsets;           ///< Per-bin start in mpSortedRayList
+    TypedBufferBase::SharedPtr              mpRayCount;             ///< [0] rays to trace, [1] reflecting pixels (screen-space only)
+    TypedBufferBase::SharedPtr              mpSortedRayList;        ///< Packed launch indices of rays to trace, in order
+    uint32_t                                mAllocatedRayCount = 0; ///< Size the per-ray buffers were allocated for
+
+    // Screen-space (Hi-Z) reflection state
+    ComputeLaunch::SharedPtr                mpHiZBuildBase;         ///< Fills Hi-Z level 0 from the G-buffer
+    ComputeLaunch::SharedPtr                mpHiZDownsample;        ///< Builds each higher Hi-Z level from the one below
+    ComputeLaunch::SharedPtr                mpScreenSpace;          ///< Marches reflection rays through the Hi-Z pyramid
+    TypedBufferBase::SharedPtr              mpHiZ;                  ///< All Hi-Z levels, back to back
+    uvec2                                   mHiZSize = uvec2(0);    ///< Screen size mpHiZ was allocated for
+    GpuReadback::SharedPtr                  mpRayCountReadback;     ///< Gets mpRayCount back to the CPU for stats
+
     // Various internal parameters
     uint32_t                                mMinTSelector = 1;      ///< Allow user to select which minT value to use for rays
     uint32_t                                mFrameCount = 0;
     bool                                    mIsOpenScene = true;
     bool                                    mHalfResolution = false;
+    bool                                    mTraceHalfResolution = false;  ///< mHalfResolution, or forced on by the reflection render scale
+    bool                                    mSortRays = false;
+    bool                                    mScreenSpaceFirst = false;  ///< March the Hi-Z pyramid before tracing DXR rays?  Off by default: hits are shaded from the direct-lit image only
+    int32_t                                 mSSRMaxSteps = 64;          ///< Traversal steps before a ray falls back to DXR
+    float                                   mSSRThickness = 0.02f;      ///< Assumed surface thickness, relative to depth
+
+    // Throughput stats, so sorted vs. unsorted tracing can be compared
+    double                                  mAvgRaysPerSec[2] = { 0.0, 0.0 };   ///< Moving average for [unsorted, sorted]
+    double                                  mAvgBinningTime = 0.0;              ///< Moving average of binning cost (ms)
+    float                                   mFallbackFraction = 0.0f;           ///< Fraction of reflecting pixels that needed DXR
 };
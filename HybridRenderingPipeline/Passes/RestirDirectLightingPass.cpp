@@ -0,0 +1,205 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "RestirDirectLightingPass.h"
+
+namespace {
+	// Where are our shaders located?
+	const char* kCandidatesShader = "restirCandidates.ps.hlsl";
+	const char* kSpatialShader = "restirSpatial.ps.hlsl";
+	const char* kFileRayTrace = "restirShade.rt.hlsl";
+
+	// What are the entry points in that shader for various ray tracing shaders?
+	const char* kEntryPointRayGen = "RestirShadeRayGen";
+	const char* kEntryPointMiss0 = "ShadowMiss";
+	const char* kEntryShadowAnyHit = "ShadowAnyHit";
+	const char* kEntryShadowClosestHit = "ShadowClosestHit";
+
+	// Input buffers
+	const char kInputBufferWorldPosition[] = "WorldPosition";
+	const char kInputBufferWorldNormal[] = "WorldNormal";
+	const char kInputBufferDiffuse[] = "MaterialDiffuse";
+	const char kInputBufferLinearZAndNormal[] = "linearZAndNormal";
+	const char kInputBufferMotionVecAndFWidth[] = "MotiveVectorsAndFWidth";
+
+	// Internal buffer names
+	const char kInternalBufferReservoirHistory[] = "ReSTIR Reservoir History";
+	const char kInternalBufferPreviousLinearZAndNormal[] = "ReSTIR Previous Linear Z and Packed Normal";
+};
+
+bool RestirDirectLightingPass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
+{
+	// Stash our resource manager; ask for the textures we read and write
+	mpResManager = pResManager;
+	mpResManager->requestTextureResources({ kInputBufferWorldPosition, kInputBufferWorldNormal, kInputBufferDiffuse,
+	                                        kInputBufferLinearZAndNormal, kInputBufferMotionVecAndFWidth });
+	mpResManager->requestTextureResource(kInternalBufferReservoirHistory, ResourceFormat::RGBA32Float);
+	mpResManager->requestTextureResource(kInternalBufferPreviousLinearZAndNormal);
+	mpResManager->requestTextureResource(mOutputTexName);
+
+	// Tell the pipeline which channels we read and write.  The history channels are both read (last frame's) and
+	//     written (this frame's), which the pipeline treats as temporal state that must be kept alive.
+	declareInputs({ kInputBufferWorldPosition, kInputBufferWorldNormal, kInputBufferDiffuse, kInputBufferLinearZAndNormal,
+	                kInputBufferMotionVecAndFWidth, kInternalBufferReservoirHistory, kInternalBufferPreviousLinearZAndNormal });
+	declareOutputs({ mOutputTexName, kInternalBufferReservoirHistory, kInternalBufferPreviousLinearZAndNormal });
+
+	// The reservoir passes run as full-screen shaders into our own framebuffers
+	mpGfxState = GraphicsState::create();
+	mpCandidatesShader = FullscreenLaunch::create(kCandidatesShader);
+	mpSpatialShader = FullscreenLaunch::create(kSpatialShader);
+
+	// One shadow ray per pixel
+	mpShadeRays = RayLaunch::create(kFileRayTrace, kEntryPointRayGen);
+	mpShadeRays->addMissShader(kFileRayTrace, kEntryPointMiss0);
+	mpShadeRays->addHitShader(kFileRayTrace, kEntryShadowClosestHit, kEntryShadowAnyHit);
+	mpShadeRays->compileRayProgram();
+	if (mpScene)
+	{
+		mpShadeRays->setScene(mpScene);
+		mpCandidatesShader->setLights(mpScene->getLights());
+		mpSpatialShader->setLights(mpScene->getLights());
+	}
+	return true;
+}
+
+void RestirDirectLightingPass::initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene)
+{
+	// Stash a copy of the scene and pass it to our shaders (if initialized).  Reservoirs refer to the old scene's lights.
+	mpScene = std::dynamic_pointer_cast<RtScene>(pScene);
+	if (!mpScene) return;
+	if (mpShadeRays) mpShadeRays->setScene(mpScene);
+	if (mpCandidatesShader) mpCandidatesShader->setLights(mpScene->getLights());
+	if (mpSpatialShader) mpSpatialShader->setLights(mpScene->getLights());
+	mHistoryNeedsClear = true;
+}
+
+void RestirDirectLightingPass::resize(uint32_t width, uint32_t height)
+{
+	mpCandidatesFbo = ResourceManager::createFbo(width, height, ResourceFormat::RGBA32Float);
+	mpSpatialFbo = ResourceManager::createFbo(width, height, ResourceFormat::RGBA32Float);
+	mHistoryNeedsClear = true;
+}
+
+void RestirDirectLightingPass::clearHistory(RenderContext* pRenderContext)
+{
+	// An all-zero reservoir has seen no candidates, so it is never reused
+	mpResManager->clearTexture(mpResManager->getTexture(kInternalBufferReservoirHistory), glm::vec4(0.f));
+	mpResManager->clearTexture(mpResManager->getTexture(kInternalBufferPreviousLinearZAndNormal), glm::vec4(0.f));
+}
+
+void RestirDirectLightingPass::renderGui(Gui* pGui)
+{
+	int dirty = 0;
+	dirty |= (int)pGui->addIntVar("Light candidates", mCandidateCount, 1, 256);
+	dirty |= (int)pGui->addCheckBox(mUseBlueNoise ? "Using blue-noise samples" : "Using white-noise samples", mUseBlueNoise);
+
+	pGui->addText("");
+	dirty |= (int)pGui->addCheckBox(mTemporalReuse ? "Temporal reuse enabled" : "Temporal reuse disabled", mTemporalReuse);
+	dirty |= (int)pGui->addFloatVar("Max history", mMaxHistory, 1.0f, 100.0f, 1.0f);
+
+	pGui->addText("");
+	dirty |= (int)pGui->addCheckBox(mSpatialReuse ? "Spatial reuse enabled" : "Spatial reuse disabled", mSpatialReuse);
+	dirty |= (int)pGui->addIntVar("Neighbors", mSpatialSamples, 1, 16);
+	dirty |= (int)pGui->addFloatVar("Radius (pixels)", mSpatialRadius, 1.0f, 100.0f, 1.0f);
+
+	pGui->addText("");
+	pGui->addText("Reuse reservoirs of similar surfaces only");
+	dirty |= (int)pGui->addFloatVar("Relative depth", mDepthThreshold, 0.001f, 1.0f, 0.005f);
+	dirty |= (int)pGui->addFloatVar("Normal cosine", mNormalThreshold, 0.0f, 1.0f, 0.01f);
+
+	// If any of our UI parameters changed, let the pipeline know we're doing something different next frame
+	if (dirty) setRefreshFlag();
+}
+
+void RestirDirectLightingPass::execute(RenderContext* pRenderContext)
+{
+	Texture::SharedPtr pDstTex = mpResManager->getTexture(mOutputTexName);
+	Texture::SharedPtr pHistoryTex = mpResManager->getTexture(kInternalBufferReservoirHistory);
+	Texture::SharedPtr pLinearZAndNormalTex = mpResManager->getTexture(kInputBufferLinearZAndNormal);
+	Texture::SharedPtr pPrevLinearZAndNormalTex = mpResManager->getTexture(kInternalBufferPreviousLinearZAndNormal);
+
+	// Do we have all the resources we need to render?  If not, return
+	if (!pDstTex || !mpScene || !mpCandidatesFbo || !mpShadeRays || !mpShadeRays->readyToRender()) return;
+
+	if (mHistoryNeedsClear)
+	{
+		clearHistory(pRenderContext);
+		mHistoryNeedsClear = false;
+	}
+
+	// Candidate generation and temporal reuse
+	auto candidateVars = mpCandidatesShader->getVars();
+	candidateVars["PerFrameCB"]["gFrameCount"] = mFrameCount;
+	candidateVars["PerFrameCB"]["gCandidateCount"] = uint32_t(mCandidateCount);
+	candidateVars["PerFrameCB"]["gTemporalReuse"] = uint32_t(mTemporalReuse ? 1 : 0);
+	candidateVars["PerFrameCB"]["gMaxHistory"] = mMaxHistory;
+	candidateVars["PerFrameCB"]["gDepthThreshold"] = mDepthThreshold;
+	candidateVars["PerFrameCB"]["gNormalThreshold"] = mNormalThreshold;
+	candidateVars["PerFrameCB"]["gRenderDim"] = mpResManager->getRenderSize();
+	candidateVars["PerFrameCB"]["gPrevRenderDim"] = mpResManager->getPrevRenderSize();
+	candidateVars["PerFrameCB"]["gBlueNoise"] = uint32_t(mUseBlueNoise ? 1 : 0);
+	candidateVars["gPos"] = mpResManager->getTexture(kInputBufferWorldPosition);
+	candidateVars["gNorm"] = mpResManager->getTexture(kInputBufferWorldNormal);
+	candidateVars["gDiffuseMatl"] = mpResManager->getTexture(kInputBufferDiffuse);
+	candidateVars["gLinearZAndNormal"] = pLinearZAndNormalTex;
+	candidateVars["gMotionAndFWidth"] = mpResManager->getTexture(kInputBufferMotionVecAndFWidth);
+	candidateVars["gPrevLinearZAndNormal"] = pPrevLinearZAndNormalTex;
+	candidateVars["gPrevReservoirs"] = pHistoryTex;
+	candidateVars["gBlueNoiseMasks"] = mpResManager->getBlueNoise()->getTexture();
+	mpGfxState->setFbo(mpCandidatesFbo);
+	mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
+	mpCandidatesShader->execute(pRenderContext, mpGfxState);
+	Texture::SharedPtr pReservoirs = mpCandidatesFbo->getColorTexture(0);
+
+	// Spatial reuse
+	if (mSpatialReuse)
+	{
+		auto spatialVars = mpSpatialShader->getVars();
+		spatialVars["PerFrameCB"]["gFrameCount"] = mFrameCount;
+		spatialVars["PerFrameCB"]["gSpatialSamples"] = uint32_t(mSpatialSamples);
+		spatialVars["PerFrameCB"]["gSpatialRadius"] = mSpatialRadius;
+		spatialVars["PerFrameCB"]["gDepthThreshold"] = mDepthThreshold;
+		spatialVars["PerFrameCB"]["gNormalThreshold"] = mNormalThreshold;
+		spatialVars["PerFrameCB"]["gRenderDim"] = mpResManager->getRenderSize();
+		spatialVars["PerFrameCB"]["gBlueNoise"] = uint32_t(mUseBlueNoise ? 1 : 0);
+		spatialVars["gPos"] = mpResManager->getTexture(kInputBufferWorldPosition);
+		spatialVars["gNorm"] = mpResManager->getTexture(kInputBufferWorldNormal);
+		spatialVars["gDiffuseMatl"] = mpResManager->getTexture(kInputBufferDiffuse);
+		spatialVars["gLinearZAndNormal"] = pLinearZAndNormalTex;
+		spatialVars["gReservoirs"] = pReservoirs;
+		spatialVars["gBlueNoiseMasks"] = mpResManager->getBlueNoise()->getTexture();
+		mpGfxState->setFbo(mpSpatialFbo);
+		mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
+		mpSpatialShader->execute(pRenderContext, mpGfxState);
+		pReservoirs = mpSpatialFbo->getColorTexture(0);
+	}
+
+	// One shadow ray per pixel, which also writes the reservoirs kept for next frame
+	auto rayGenVars = mpShadeRays->getRayGenVars();
+	rayGenVars["RayGenCB"]["gMinT"] = mpResManager->getMinTDist();
+	rayGenVars["gPos"] = mpResManager->getTexture(kInputBufferWorldPosition);
+	rayGenVars["gNorm"] = mpResManager->getTexture(kInputBufferWorldNormal);
+	rayGenVars["gDiffuseMatl"] = mpResManager->getTexture(kInputBufferDiffuse);
+	rayGenVars["gReservoirs"] = pReservoirs;
+	rayGenVars["gReservoirHistory"] = pHistoryTex;
+	rayGenVars["gOutput"] = pDstTex;
+	mpShadeRays->execute(pRenderContext, mpResManager->getRenderSize());
+
+	pRenderContext->blit(pLinearZAndNormalTex->getSRV(), pPrevLinearZAndNormalTex->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
+	mFrameCount++;
+}
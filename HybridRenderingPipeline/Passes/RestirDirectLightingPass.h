@@ -0,0 +1,82 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include "../SharedUtils/RenderPass.h"
+#include "../SharedUtils/FullscreenLaunch.h"
+#include "../SharedUtils/RayLaunch.h"
+
+/** Shadowed direct lighting with reservoir-based spatiotemporal resampling (ReSTIR).  Each pixel keeps a reservoir
+    holding one light sample:
+      1) restirCandidates.ps.hlsl draws light candidates uniformly and resamples them by their unshadowed contribution,
+         then merges last frame's reservoir, found through the motion vectors, if it belongs to a similar surface.
+      2) restirSpatial.ps.hlsl merges the reservoirs of a few neighbors on similar surfaces.
+      3) restirShade.rt.hlsl traces one shadow ray towards the kept light and shades with the reservoir's weight.  The
+         reservoir becomes next frame's history, without its weight if the light was occluded.
+    The output already contains shadows; pair it with FinalStagePass(..., true).  The reservoir math is mirrored on
+    the CPU by Falcor::Reservoir, which is unit tested.
+*/
+class RestirDirectLightingPass : public ::RenderPass, inherit_shared_from_this<::RenderPass, RestirDirectLightingPass>
+{
+public:
+    using SharedPtr = std::shared_ptr<RestirDirectLightingPass>;
+    using SharedConstPtr = std::shared_ptr<const RestirDirectLightingPass>;
+
+    static SharedPtr create(const std::string& outputChannel) { return SharedPtr(new RestirDirectLightingPass(outputChannel)); }
+    virtual ~RestirDirectLightingPass() = default;
+
+protected:
+    RestirDirectLightingPass(const std::string& outputChannel) : ::RenderPass("ReSTIR Direct Lighting", "ReSTIR Direct Lighting Options"), mOutputTexName(outputChannel) {}
+
+    // Implementation of RenderPass interface
+    bool initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager) override;
+    void initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene) override;
+    void execute(RenderContext* pRenderContext) override;
+    void renderGui(Gui* pGui) override;
+    void resize(uint32_t width, uint32_t height) override;
+
+    // The RenderPass class defines various methods we can override to specify this pass' properties. 
+    bool requiresScene() override { return true; }
+    bool usesRayTracing() override { return true; }
+
+    void clearHistory(RenderContext* pRenderContext);
+
+    // Rendering state
+    std::string                             mOutputTexName;
+    FullscreenLaunch::SharedPtr             mpCandidatesShader;     ///< Candidate generation and temporal reuse
+    FullscreenLaunch::SharedPtr             mpSpatialShader;        ///< Spatial reuse
+    RayLaunch::SharedPtr                    mpShadeRays;            ///< Final visibility ray and shading
+    GraphicsState::SharedPtr                mpGfxState;
+    Fbo::SharedPtr                          mpCandidatesFbo;        ///< Reservoirs after temporal reuse
+    Fbo::SharedPtr                          mpSpatialFbo;           ///< Reservoirs after spatial reuse
+    RtScene::SharedPtr                      mpScene;
+
+    uint32_t                                mFrameCount = 0;        ///< Frame count used to help seed our shaders' random number generator
+    bool                                    mHistoryNeedsClear = true;
+    bool                                    mUseBlueNoise = true;   ///< Draw samples from the blue-noise masks (or from a white-noise LCG)?
+
+    // Resampling parameters
+    int32_t                                 mCandidateCount = 32;   ///< Light candidates drawn per pixel and frame
+    bool                                    mTemporalReuse = true;
+    float                                   mMaxHistory = 20.0f;    ///< Last frame's reservoir counts for at most this many times the new candidates
+    bool                                    mSpatialReuse = true;
+    int32_t                                 mSpatialSamples = 5;    ///< Neighbors merged per pixel
+    float                                   mSpatialRadius = 30.0f; ///< In pixels
+    float                                   mDepthThreshold = 0.1f; ///< Reused reservoirs' linear depth must be within this fraction of ours
+    float                                   mNormalThreshold = 0.9f;///< Cosine between our normal and the reused reservoirs' normal
+};
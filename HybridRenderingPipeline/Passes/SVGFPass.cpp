@@ -71,6 +71,12 @@ bool SVGFPass::initialize(RenderContext* pRenderContext, ResourceManager::Shared
 	});
 	mpResManager->requestTextureResource(mOutputTexName);
 
+	// Tell the pipeline which channels we read and write.  Our linear Z history is both read (last frame's) and
+	//     written (this frame's), which the pipeline treats as temporal state that must be kept alive.
+	declareInputs({ mInputTexName, kInputBufferWorldPosition, kInputBufferWorldNormal, kInputBufferLinearZAndNormal,
+	                kInputBufferMotionVecAndFWidth, kInternalBufferPreviousLinearZAndNormal });
+	declareOutputs({ mOutputTexName, kInternalBufferPreviousLinearZAndNormal });
+
 	// Create our graphics state and an accumulation shader
 	mpGfxState = GraphicsState::create();
 	
@@ -172,7 +178,7 @@ void SVGFPass::execute(RenderContext* pRenderContext)
 	}
 
 	if (!mFilterEnabled) {
-		pRenderContext->blit(pColorTexture->getSRV(), pOutputTexture->getRTV());
+		pRenderContext->blit(pColorTexture->getSRV(), pOutputTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 		return;
 	}
   
@@ -183,10 +189,10 @@ void SVGFPass::execute(RenderContext* pRenderContext)
 
   computeAtrousDecomposition(pRenderContext, pLinearZAndNormalTexture);
 
-  pRenderContext->blit(mpPingPongFbo[0]->getColorTexture(0)->getSRV(), pOutputTexture->getRTV());
+  pRenderContext->blit(mpPingPongFbo[0]->getColorTexture(0)->getSRV(), pOutputTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 
   std::swap(mpCurReprojFbo, mpPrevReprojFbo);
-  pRenderContext->blit(pLinearZAndNormalTexture->getSRV(), pPrevLinearZAndNormalTexture->getRTV());
+  pRenderContext->blit(pLinearZAndNormalTexture->getSRV(), pPrevLinearZAndNormalTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 }
 
 void SVGFPass::computeReprojection(RenderContext* pRenderContext,
@@ -207,8 +213,11 @@ void SVGFPass::computeReprojection(RenderContext* pRenderContext,
 
   shaderVars["PerImageCB"]["gAlpha"] = mAlpha;
   shaderVars["PerImageCB"]["gMomentsAlpha"] = mMomentsAlpha;
+  shaderVars["PerImageCB"]["gRenderDim"] = ivec2(mpResManager->getRenderSize());
+  shaderVars["PerImageCB"]["gPrevRenderDim"] = ivec2(mpResManager->getPrevRenderSize());
 
   mpGfxState->setFbo(mpCurReprojFbo);
+  mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
   mpReprojection->execute(pRenderContext, mpGfxState);
 }
 
@@ -223,8 +232,10 @@ void SVGFPass::computeFilteredMoments(RenderContext* pRenderContext, Texture::Sh
 
   shaderVars["PerImageCB"]["gPhiColor"]  = mPhiColor;
   shaderVars["PerImageCB"]["gPhiNormal"]  = mPhiNormal;
+  shaderVars["PerImageCB"]["gRenderDim"] = ivec2(mpResManager->getRenderSize());
 
   mpGfxState->setFbo(mpPingPongFbo[0]);
+  mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
   mpFilterMoments->execute(pRenderContext, mpGfxState);
 }
 
@@ -236,6 +247,7 @@ void SVGFPass::computeAtrousDecomposition(RenderContext* pRenderContext, Texture
   shaderVars["gLinearZAndNormal"] = pCurLinearZTexture;
   shaderVars["PerImageCB"]["gPhiColor"]  = mPhiColor;
   shaderVars["PerImageCB"]["gPhiNormal"] = mPhiNormal;
+  shaderVars["PerImageCB"]["gRenderDim"] = ivec2(mpResManager->getRenderSize());
 
   for (int i = 0; i < mFilterIterations; i++)
   {
@@ -243,12 +255,13 @@ void SVGFPass::computeAtrousDecomposition(RenderContext* pRenderContext, Texture
     shaderVars["gIllumination"] = mpPingPongFbo[0]->getColorTexture(0);
     shaderVars["PerImageCB"]["gStepSize"] = 1 << i;
     mpGfxState->setFbo(curTargetFbo);
+    mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
     mpAtrous->execute(pRenderContext, mpGfxState);
 
     // store the filtered color for the feedback path
     if (i == std::min(mFeedbackTap, mFilterIterations - 1))
     {
-        pRenderContext->blit(curTargetFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0));
+        pRenderContext->blit(curTargetFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0), mpResManager->getRenderRect(), mpResManager->getRenderRect());
     }
 
     std::swap(mpPingPongFbo[0], mpPingPongFbo[1]);
@@ -256,6 +269,6 @@ void SVGFPass::computeAtrousDecomposition(RenderContext* pRenderContext, Texture
 
   if (mFeedbackTap < 0)
   {
-    pRenderContext->blit(mpCurReprojFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0));
+    pRenderContext->blit(mpCurReprojFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0), mpResManager->getRenderRect(), mpResManager->getRenderRect());
   }
 }
\ No newline at end of file
@@ -23,6 +23,7 @@ protected:
 
 	// The RenderPass class defines various methods we can override to specify this pass' properties. 
 	bool appliesPostprocess() override { return true; }
+	ResourceManager::ResolutionGroup getResolutionGroup() override { return ResourceManager::ResolutionGroup::Denoise; }
 	void clearBuffers(RenderContext* pRenderContext);
 
 	std::string                   mOutputTexName;
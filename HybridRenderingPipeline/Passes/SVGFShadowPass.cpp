@@ -40,20 +40,17 @@ namespace {
 
 // Define our constructor methods
 SVGFShadowPass::SharedPtr SVGFShadowPass::create(const std::string& bufferToAccumulate,
-                                                 const std::string& directShadowBuffer,
-                                                 const std::string& aoBuffer)
+                                                 const std::string& visibilityBuffer)
 {
-	return SharedPtr(new SVGFShadowPass(bufferToAccumulate, directShadowBuffer, aoBuffer));
+	return SharedPtr(new SVGFShadowPass(bufferToAccumulate, visibilityBuffer));
 }
 
 SVGFShadowPass::SVGFShadowPass(const std::string& bufferToAccumulate,
-                                const std::string& directShadowBuffer,
-                                const std::string& aoBuffer)
+                                const std::string& visibilityBuffer)
 	: ::RenderPass("SVGF Shadow Pass", "SVGF Shadow Options")
 {
 	 mOutputTexName = bufferToAccumulate;
-    mDirectShadowTexName = directShadowBuffer;
-    mAoTexName = aoBuffer;
+    mVisibilityTexName = visibilityBuffer;
 }
 
 bool SVGFShadowPass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
@@ -75,6 +72,12 @@ bool SVGFShadowPass::initialize(RenderContext* pRenderContext, ResourceManager::
 	});
 	mpResManager->requestTextureResource(mOutputTexName);
 
+	// Tell the pipeline which channels we read and write.  Our linear Z history is both read (last frame's) and
+	//     written (this frame's), which the pipeline treats as temporal state that must be kept alive.
+	declareInputs({ mVisibilityTexName, kInputBufferWorldPosition, kInputBufferWorldNormal,
+	                kInputBufferLinearZAndNormal, kInputBufferMotionVecAndFWidth, kInternalBufferPreviousLinearZAndNormal });
+	declareOutputs({ mOutputTexName, kInternalBufferPreviousLinearZAndNormal });
+
 	// Create our graphics state and an accumulation shader
 	mpGfxState = GraphicsState::create();
 	
@@ -155,8 +158,7 @@ void SVGFShadowPass::renderGui(Gui* pGui)
 
 void SVGFShadowPass::execute(RenderContext* pRenderContext)
 {
-	Texture::SharedPtr pShadowTexture = mpResManager->getTexture(mDirectShadowTexName);
-	Texture::SharedPtr pAoTexture = mpResManager->getTexture(mAoTexName);
+	Texture::SharedPtr pVisibilityTexture = mpResManager->getTexture(mVisibilityTexName);
 	Texture::SharedPtr pWorldPositionTexture = mpResManager->getTexture(kInputBufferWorldPosition);
 	Texture::SharedPtr pWorldNormalTexture = mpResManager->getTexture(kInputBufferWorldNormal);
 	Texture::SharedPtr pLinearZAndNormalTexture = mpResManager->getTexture(kInputBufferLinearZAndNormal);
@@ -173,35 +175,36 @@ void SVGFShadowPass::execute(RenderContext* pRenderContext)
 		mBuffersNeedClear = false;
 	}
 
+	// Without filtering, still let the reprojection pass combine shadow and AO, but don't blend in any history
 	if (!mFilterEnabled) {
-		pRenderContext->blit(pShadowTexture->getSRV(), pOutputTexture->getRTV());
+		computeReprojection(pRenderContext, pVisibilityTexture, pMotionVectorAndFWidthTexture, pLinearZAndNormalTexture, pPrevLinearZAndNormalTexture, 1.0f);
+		pRenderContext->blit(mpCurReprojFbo->getColorTexture(0)->getSRV(), pOutputTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 		return;
 	}
   
-  computeReprojection(pRenderContext, pShadowTexture, pAoTexture, pMotionVectorAndFWidthTexture, pLinearZAndNormalTexture, pPrevLinearZAndNormalTexture);
+  computeReprojection(pRenderContext, pVisibilityTexture, pMotionVectorAndFWidthTexture, pLinearZAndNormalTexture, pPrevLinearZAndNormalTexture, mAlpha);
   
   computeFilteredMoments(pRenderContext, pLinearZAndNormalTexture);
 
   computeAtrousDecomposition(pRenderContext, pLinearZAndNormalTexture);
 
-  pRenderContext->blit(mpPingPongFbo[0]->getColorTexture(0)->getSRV(), pOutputTexture->getRTV());
+  pRenderContext->blit(mpPingPongFbo[0]->getColorTexture(0)->getSRV(), pOutputTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 
   std::swap(mpCurReprojFbo, mpPrevReprojFbo);
-  pRenderContext->blit(pLinearZAndNormalTexture->getSRV(), pPrevLinearZAndNormalTexture->getRTV());
+  pRenderContext->blit(pLinearZAndNormalTexture->getSRV(), pPrevLinearZAndNormalTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
 }
 
 void SVGFShadowPass::computeReprojection(RenderContext* pRenderContext,
-                                          Texture::SharedPtr pShadowTexture,
-                                          Texture::SharedPtr pAoTexture,
+                                          Texture::SharedPtr pVisibilityTexture,
                                           Texture::SharedPtr pMotionVectorAndFWidthTexture,
                                           Texture::SharedPtr pCurLinearZTexture,
-                                          Texture::SharedPtr pPrevLinearZTexture)
+                                          Texture::SharedPtr pPrevLinearZTexture,
+                                          float alpha)
 {
   auto shaderVars = mpReprojection->getVars();
 
   shaderVars["gMotionAndFWidth"]        = pMotionVectorAndFWidthTexture;
-  shaderVars["gShadow"]         = pShadowTexture;
-  shaderVars["gAO"]         = pAoTexture;
+  shaderVars["gVisibility"]     = pVisibilityTexture;
   shaderVars["gPrevIllum"]     = mpFilteredPastFbo->getColorTexture(0);
   shaderVars["gPrevMoments"]   = mpPrevReprojFbo->getColorTexture(1);
   shaderVars["gLinearZAndNormal"]       = pCurLinearZTexture;
@@ -209,10 +212,11 @@ void SVGFShadowPass::computeReprojection(RenderContext* pRenderContext,
   shaderVars["gPrevHistoryLength"] = mpPrevReprojFbo->getColorTexture(2);
 
   // Setup variables for our reprojection pass
-  shaderVars["PerImageCB"]["gAlpha"] = mAlpha;
-  shaderVars["PerImageCB"]["gMomentsAlpha"] = mMomentsAlpha;
+  shaderVars["PerImageCB"]["gAlpha"] = alpha;
+  shaderVars["PerImageCB"]["gMomentsAlpha"] = std::max(alpha, mMomentsAlpha);
 
   mpGfxState->setFbo(mpCurReprojFbo);
+  mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
   mpReprojection->execute(pRenderContext, mpGfxState);
 }
 
@@ -227,8 +231,10 @@ void SVGFShadowPass::computeFilteredMoments(RenderContext* pRenderContext, Textu
 
   shaderVars["PerImageCB"]["gPhiColor"]  = mPhiColor;
   shaderVars["PerImageCB"]["gPhiNormal"]  = mPhiNormal;
+  shaderVars["PerImageCB"]["gRenderDim"] = ivec2(mpResManager->getRenderSize());
 
   mpGfxState->setFbo(mpPingPongFbo[0]);
+  mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
   mpFilterMoments->execute(pRenderContext, mpGfxState);
 }
 
@@ -240,6 +246,7 @@ void SVGFShadowPass::computeAtrousDecomposition(RenderContext* pRenderContext, T
   shaderVars["gLinearZAndNormal"] = pCurLinearZTexture;
   shaderVars["PerImageCB"]["gPhiColor"]  = mPhiColor;
   shaderVars["PerImageCB"]["gPhiNormal"] = mPhiNormal;
+  shaderVars["PerImageCB"]["gRenderDim"] = ivec2(mpResManager->getRenderSize());
 
   for (int i = 0; i < mFilterIterations; i++)
   {
@@ -247,12 +254,13 @@ void SVGFShadowPass::computeAtrousDecomposition(RenderContext* pRenderContext, T
     shaderVars["gIllumination"] = mpPingPongFbo[0]->getColorTexture(0);
     shaderVars["PerImageCB"]["gStepSize"] = 1 << i;
     mpGfxState->setFbo(curTargetFbo);
+    mpGfxState->setViewport(0, mpResManager->getRenderViewport(), true);
     mpAtrous->execute(pRenderContext, mpGfxState);
 
     // store the filtered color for the feedback path
     if (i == std::min(mFeedbackTap, mFilterIterations - 1))
     {
-        pRenderContext->blit(curTargetFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0));
+        pRenderContext->blit(curTargetFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0), mpResManager->getRenderRect(), mpResManager->getRenderRect());
     }
 
     std::swap(mpPingPongFbo[0], mpPingPongFbo[1]);
@@ -260,6 +268,6 @@ void SVGFShadowPass::computeAtrousDecomposition(RenderContext* pRenderContext, T
 
   if (mFeedbackTap < 0)
   {
-    pRenderContext->blit(mpCurReprojFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0));
+    pRenderContext->blit(mpCurReprojFbo->getColorTexture(0)->getSRV(), mpFilteredPastFbo->getRenderTargetView(0), mpResManager->getRenderRect(), mpResManager->getRenderRect());
   }
 }
\ No newline at end of file
@@ -9,15 +9,14 @@ class SVGFShadowPass : public ::RenderPass, inherit_shared_from_this<::RenderPas
 public:
 	using SharedPtr = std::shared_ptr<SVGFShadowPass>;
 
+	// The visibility buffer holds light visibility in .r and ambient occlusion in .g (see VisibilityPass)
 	static SharedPtr create(const std::string& bufferToAccumulate,
-                          const std::string& directShadowBuffer,
-                          const std::string& aoBuffer);
+                          const std::string& visibilityBuffer);
 	virtual ~SVGFShadowPass() = default;
 
 protected:
 	SVGFShadowPass(const std::string& bufferToAccumulate,
-                  const std::string& directShadowBuffer,
-                  const std::string& aoBuffer);
+                  const std::string& visibilityBuffer);
 
 	// Implementation of SimpleRenderPass interface
 	bool initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager) override;
@@ -27,11 +26,11 @@ protected:
 
 	// The RenderPass class defines various methods we can override to specify this pass' properties. 
 	bool appliesPostprocess() override { return true; }
+	ResourceManager::ResolutionGroup getResolutionGroup() override { return ResourceManager::ResolutionGroup::Denoise; }
 	void clearBuffers(RenderContext* pRenderContext);
 
 	std::string                   mOutputTexName;
-  std::string                   mDirectShadowTexName;
-  std::string                   mAoTexName;
+  std::string                   mVisibilityTexName;
 
 	// State for our shader
 	GraphicsState::SharedPtr      mpGfxState;
@@ -64,11 +63,11 @@ protected:
 private:
   void allocateFbos(glm::uvec2 dim);
   void computeReprojection(RenderContext* pRenderContext,
-							              Texture::SharedPtr pShadowTexture,
-                            Texture::SharedPtr pAoTexture,
+							              Texture::SharedPtr pVisibilityTexture,
                             Texture::SharedPtr pMotionVectorAndFWidthTexture,
                             Texture::SharedPtr pCurLinearZTexture,
-                            Texture::SharedPtr pPrevLinearZAndNormalTexture);
+                            Texture::SharedPtr pPrevLinearZAndNormalTexture,
+                            float alpha);
   void computeFilteredMoments(RenderContext* pRenderContext, Texture::SharedPtr pCurLinearZTexture);
   void computeAtrousDecomposition(RenderContext* pRenderContext, Texture::SharedPtr pCurLinearZTexture);
 };
@@ -37,6 +37,10 @@ bool ShadowPass::initialize(RenderContext* pRenderContext, ResourceManager::Shar
 	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", "MaterialDiffuse" });
 	mpResManager->requestTextureResource(mAccumChannel);
 
+	// Tell the pipeline which channels we actually touch (the shadow rays only need the G-buffer position & normal)
+	declareInputs({ "WorldPosition", "WorldNormal" });
+	declareOutputs({ mAccumChannel }, Resource::State::UnorderedAccess);
+
 	// Create our wrapper around a ray tracing pass.  Tell it where our shaders are, then compile/link the program
 	mpRays = RayLaunch::create(kFileRayTrace, kEntryPointRayGen);
 	mpRays->addMissShader(kFileRayTrace, kEntryPointMiss0);
@@ -66,14 +70,16 @@ void ShadowPass::execute(RenderContext* pRenderContext)
 	rayGenVars["RayGenCB"]["gMinT"] = mpResManager->getMinTDist();
 	rayGenVars["RayGenCB"]["gFrameCount"] = mFrameCount++;
 	rayGenVars["RayGenCB"]["gMaxCosineTheta"] = mMaxCosineTheta;
+	rayGenVars["RayGenCB"]["gBlueNoise"] = uint32_t(mUseBlueNoise ? 1 : 0);
 
 	// Pass our G-buffer textures down to the HLSL so we can shade
 	rayGenVars["gPos"] = mpResManager->getTexture("WorldPosition");
 	rayGenVars["gNorm"] = mpResManager->getTexture("WorldNormal");
 	rayGenVars["gOutput"] = pDstTex;
+	rayGenVars["gBlueNoiseMasks"] = mpResManager->getBlueNoise()->getTexture();
 
 	// Shoot our rays and shade our primary hit points
-	mpRays->execute(pRenderContext, mpResManager->getScreenSize());
+	mpRays->execute(pRenderContext, mpResManager->getRenderSize());
 }
 
 
@@ -82,6 +88,7 @@ void ShadowPass::renderGui(Gui* pGui)
 	int dirty = 0;
 
 	dirty |= (int)pGui->addFloatVar("maxCosineTheta", mMaxCosineTheta, 0.8f, 1.0f, 0.005f, true);
+	dirty |= (int)pGui->addCheckBox(mUseBlueNoise ? "Using blue-noise samples" : "Using white-noise samples", mUseBlueNoise);
 	
 	// If any of our UI parameters changed, let the pipeline know we're doing something different next frame
 	if (dirty) setRefreshFlag();
@@ -27,6 +27,7 @@ protected:
     // The RenderPass class defines various methods we can override to specify this pass' properties. 
     bool requiresScene() override { return true; }
     bool usesRayTracing() override { return true; }
+    bool canRunAsync() override { return true; }
 
     // Rendering state
     std::string                             mAccumChannel;
@@ -35,6 +36,7 @@ protected:
 
     uint32_t                                mFrameCount = 0;        ///< Frame count used to help seed our shaders' random number generator
     float                                   mMaxCosineTheta = 0.99f;
+    bool                                    mUseBlueNoise = true;   ///< Draw samples from the blue-noise masks (or from a white-noise LCG)?
 
     // Various internal parameters
     uint32_t                                mMinTSelector = 1;      ///< Allow user to select which minT value to use for rays
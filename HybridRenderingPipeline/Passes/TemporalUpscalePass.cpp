@@ -0,0 +1,204 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "TemporalUpscalePass.h"
+
+namespace {
+	// Where is our shader located?
+	const char kUpscaleShader[] = "temporalUpscale.ps.hlsl";
+
+	// Input buffers, from the G-buffer
+	const char kInputBufferLinearZAndNormal[] = "linearZAndNormal";
+	const char kInputBufferMotionVecAndFWidth[] = "MotiveVectorsAndFWidth";
+
+	// Internal buffer names
+	const char kInternalBufferPreviousLinearZ[] = "Upscaler Previous Linear Z";
+
+	const Gui::DropdownList kModes = {
+		{ int32_t(TemporalUpscalePass::Mode::Off),         "Off" },
+		{ int32_t(TemporalUpscalePass::Mode::Native),      "Native (TAA)" },
+		{ int32_t(TemporalUpscalePass::Mode::Quality),     "Quality (1.5x)" },
+		{ int32_t(TemporalUpscalePass::Mode::Balanced),    "Balanced (2x)" },
+		{ int32_t(TemporalUpscalePass::Mode::Performance), "Performance (3x)" },
+	};
+};
+
+// Define our constructor methods
+TemporalUpscalePass::SharedPtr TemporalUpscalePass::create(const std::string &bufferOut, const std::string &inputColorBuffer, Mode mode)
+{
+	return SharedPtr(new TemporalUpscalePass(bufferOut, inputColorBuffer, mode));
+}
+
+TemporalUpscalePass::TemporalUpscalePass(const std::string &bufferOut, const std::string &inputColorBuffer, Mode mode)
+	: ::RenderPass("Temporal Upscale Pass", "Temporal Upscale Options")
+{
+	mOutputTexName = bufferOut;
+	mInputTexName = inputColorBuffer;
+	mMode = uint32_t(mode);
+}
+
+float TemporalUpscalePass::getUpscaleFactor(Mode mode)
+{
+	switch (mode)
+	{
+	case Mode::Quality:     return 1.5f;
+	case Mode::Balanced:    return 2.0f;
+	case Mode::Performance: return 3.0f;
+	default:                return 1.0f;
+	}
+}
+
+bool TemporalUpscalePass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
+{
+	// Stash our resource manager; ask for the texture the developer asked us to write
+	mpResManager = pResManager;
+	mpResManager->requestTextureResources({ mInputTexName, kInputBufferLinearZAndNormal, kInputBufferMotionVecAndFWidth });
+	mpResManager->requestTextureResource(kInternalBufferPreviousLinearZ);
+	mpResManager->requestTextureResource(mOutputTexName);
+
+	// Tell the pipeline which channels we read and write.  Our linear Z history is both read (last frame's) and
+	//     written (this frame's), which the pipeline treats as temporal state that must be kept alive.
+	declareInputs({ mInputTexName, kInputBufferLinearZAndNormal, kInputBufferMotionVecAndFWidth, kInternalBufferPreviousLinearZ });
+	declareOutputs({ mOutputTexName, kInternalBufferPreviousLinearZ });
+
+	// Create our graphics state and the upscaling shader
+	mpGfxState = GraphicsState::create();
+	mpUpscale = FullscreenLaunch::create(kUpscaleShader);
+
+	applyMode();
+	return true;
+}
+
+void TemporalUpscalePass::initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene)
+{
+	// Stash the scene, whose camera we jitter.  A new scene has nothing to do with our history.
+	mpScene = pScene;
+	mBuffersNeedClear = true;
+	applyMode();
+}
+
+void TemporalUpscalePass::resize(uint32_t width, uint32_t height)
+{
+	// Two MRTs: the output, and the history (RGB, and the sample weight accumulated in alpha)
+	Fbo::Desc desc;
+	desc.setColorTarget(0, Falcor::ResourceFormat::RGBA32Float);
+	desc.setColorTarget(1, Falcor::ResourceFormat::RGBA32Float);
+	mpHistoryFbo[0] = FboHelper::create2D(width, height, desc);
+	mpHistoryFbo[1] = FboHelper::create2D(width, height, desc);
+	mBuffersNeedClear = true;
+}
+
+void TemporalUpscalePass::applyMode()
+{
+	const bool enabled = Mode(mMode) != Mode::Off;
+	const float factor = getUpscaleFactor(Mode(mMode));
+	if (mpResManager) mpResManager->setUpscaling(enabled, factor);
+
+	// Jitter sequences long enough for every screen pixel to get several samples close to its center
+	mpJitterPattern = enabled ? HaltonSamplePattern::create(TemporalUpscaleReference::getJitterSampleCount(factor)) : nullptr;
+	Camera::SharedPtr pCamera = mpScene ? mpScene->getActiveCamera() : nullptr;
+	if (pCamera) pCamera->setPatternGenerator(mpJitterPattern, vec2(1.0f) / vec2(glm::max(mpResManager->getRenderSize(), uvec2(1))));
+	mBuffersNeedClear = true;
+}
+
+void TemporalUpscalePass::renderGui(Gui* pGui)
+{
+	int dirty = 0;
+	if (pGui->addDropdown("Upscaling", kModes, mMode))
+	{
+		applyMode();
+		setRefreshFlag();
+	}
+	if (Mode(mMode) == Mode::Off) return;
+
+	dirty |= (int)pGui->addCheckBox("Drop history at disocclusions", mSettings.depthTest);
+	dirty |= (int)pGui->addCheckBox("Clamp history to neighborhood", mSettings.neighborhoodClamp);
+	dirty |= (int)pGui->addFloatVar("Clamp box size (sigmas)", mSettings.clampGamma, 0.25f, 8.0f, 0.05f);
+	dirty |= (int)pGui->addFloatVar("Depth tolerance", mSettings.depthTolerance, 0.5f, 100.0f, 0.5f);
+	dirty |= (int)pGui->addFloatVar("Sample kernel radius", mSettings.kernelRadius, 0.1f, 2.0f, 0.01f);
+
+	pGui->addText("");
+	pGui->addText("How much history should be used?");
+	pGui->addText("    (sample weight, when still and when moving)");
+	dirty |= (int)pGui->addFloatVar("Max weight", mSettings.maxHistoryWeight, 1.0f, 256.0f, 0.5f);
+	dirty |= (int)pGui->addFloatVar("Max weight in motion", mSettings.maxMotionHistoryWeight, 0.5f, 256.0f, 0.5f);
+
+	if (dirty) mBuffersNeedClear = true;
+}
+
+void TemporalUpscalePass::execute(RenderContext* pRenderContext)
+{
+	// Grab our textures
+	Texture::SharedPtr pOutputTexture = mpResManager->getTexture(mOutputTexName);
+	Texture::SharedPtr pColorTexture = mpResManager->getTexture(mInputTexName);
+	Texture::SharedPtr pLinearZTexture = mpResManager->getTexture(kInputBufferLinearZAndNormal);
+	Texture::SharedPtr pMotionTexture = mpResManager->getTexture(kInputBufferMotionVecAndFWidth);
+	Texture::SharedPtr pPrevLinearZTexture = mpResManager->getTexture(kInternalBufferPreviousLinearZ);
+	if (!pOutputTexture || !pColorTexture) return;
+
+	// Not upscaling?  Pass the rendered pixels through, and let the pipeline's final blit stretch them.
+	if (Mode(mMode) == Mode::Off)
+	{
+		pRenderContext->blit(pColorTexture->getSRV(), pOutputTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
+		return;
+	}
+
+	if (mBuffersNeedClear)
+	{
+		pRenderContext->clearFbo(mpHistoryFbo[0].get(), float4(0), 1.0f, 0, FboAttachmentType::All);
+		pRenderContext->clearFbo(mpHistoryFbo[1].get(), float4(0), 1.0f, 0, FboAttachmentType::All);
+		mBuffersNeedClear = false;
+	}
+
+	// The jitter the camera rendered this frame with, as an offset from the render pixel centers.  The camera shifts the image
+	//     by (jitterX, jitterY) in UVs with +y up, so the samples moved the other way.
+	const uvec2 renderSize = mpResManager->getRenderSize();
+	Camera::SharedPtr pCamera = mpScene ? mpScene->getActiveCamera() : nullptr;
+	vec2 jitter = pCamera ? vec2(-pCamera->getJitterX(), pCamera->getJitterY()) * vec2(renderSize) : vec2(0.0f);
+
+	auto shaderVars = mpUpscale->getVars();
+	shaderVars["gColor"] = pColorTexture;
+	shaderVars["gLinearZAndNormal"] = pLinearZTexture;
+	shaderVars["gMotionAndFWidth"] = pMotionTexture;
+	shaderVars["gPrevLinearZ"] = pPrevLinearZTexture;
+	shaderVars["gHistory"] = mpHistoryFbo[1 - mCurHistory]->getColorTexture(1);
+	shaderVars["PerImageCB"]["gOutputDim"] = ivec2(mpResManager->getScreenSize());
+	shaderVars["PerImageCB"]["gRenderDim"] = ivec2(renderSize);
+	shaderVars["PerImageCB"]["gPrevRenderDim"] = ivec2(mpResManager->getPrevRenderSize());
+	shaderVars["PerImageCB"]["gJitter"] = jitter;
+	shaderVars["PerImageCB"]["gKernelScale"] = -0.5f / (mSettings.kernelRadius * mSettings.kernelRadius);
+	shaderVars["PerImageCB"]["gMaxHistoryWeight"] = mSettings.maxHistoryWeight;
+	shaderVars["PerImageCB"]["gMaxMotionHistoryWeight"] = mSettings.maxMotionHistoryWeight;
+	shaderVars["PerImageCB"]["gMotionWeightDistance"] = mSettings.motionWeightDistance;
+	shaderVars["PerImageCB"]["gClampGamma"] = mSettings.clampGamma;
+	shaderVars["PerImageCB"]["gDepthTolerance"] = mSettings.depthTolerance;
+	shaderVars["PerImageCB"]["gNeighborhoodClamp"] = mSettings.neighborhoodClamp;
+	shaderVars["PerImageCB"]["gDepthTest"] = mSettings.depthTest;
+
+	// Reconstruct the whole screen
+	mpGfxState->setFbo(mpHistoryFbo[mCurHistory]);
+	mpUpscale->execute(pRenderContext, mpGfxState);
+	pRenderContext->blit(mpHistoryFbo[mCurHistory]->getColorTexture(0)->getSRV(), pOutputTexture->getRTV());
+
+	// Keep this frame's depth to find disocclusions next frame, and swap the histories
+	pRenderContext->blit(pLinearZTexture->getSRV(), pPrevLinearZTexture->getRTV(), mpResManager->getRenderRect(), mpResManager->getRenderRect());
+	mCurHistory = 1 - mCurHistory;
+
+	// Next frame's jitter is scaled to this frame's render size, which is what it will most likely be rendered at
+	if (pCamera) pCamera->setPatternGenerator(mpJitterPattern, vec2(1.0f) / vec2(renderSize));
+}
@@ -0,0 +1,82 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Temporal upscaling: the passes before this one render at a fraction of the screen resolution, with the camera jittered by a
+//     different sub-pixel offset every frame, and this pass reconstructs the whole screen from those frames.  Motion vectors
+//     carry the history from frame to frame; it is dropped where the depth changed (disocclusions) and clamped to the colors
+//     rendered around each pixel elsewhere.  Falcor's TemporalUpscaleReference is the same algorithm on the CPU.
+
+#pragma once
+#include "../SharedUtils/RenderPass.h"
+#include "../SharedUtils/FullscreenLaunch.h"
+
+class TemporalUpscalePass : public ::RenderPass, inherit_shared_from_this<::RenderPass, TemporalUpscalePass>
+{
+public:
+    using SharedPtr = std::shared_ptr<TemporalUpscalePass>;
+
+	// Off leaves the pipeline at native resolution (stretched by the final blit if dynamic resolution lowered it), Native
+	//     renders at native resolution and only accumulates (i.e., TAA), and the others render 1.5x, 2x and 3x fewer pixels per axis.
+	enum class Mode : uint32_t { Off = 0, Native, Quality, Balanced, Performance };
+
+	// Reads the color the pipeline rendered from <inputColorBuffer>, and writes the screen-sized reconstruction to <bufferOut>
+	static SharedPtr create(const std::string &bufferOut, const std::string &inputColorBuffer, Mode mode = Mode::Balanced);
+	virtual ~TemporalUpscalePass() = default;
+
+	// The factor between the screen and render resolutions of a mode
+	static float getUpscaleFactor(Mode mode);
+
+protected:
+	TemporalUpscalePass(const std::string &bufferOut, const std::string &inputColorBuffer, Mode mode);
+
+	// Implementation of SimpleRenderPass interface
+	bool initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager) override;
+	void initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene) override;
+	void execute(RenderContext* pRenderContext) override;
+	void renderGui(Gui* pGui) override;
+	void resize(uint32_t width, uint32_t height) override;
+
+	// The RenderPass class defines various methods we can override to specify this pass' properties.  We always run at the
+	//     screen resolution, whatever the render scales.
+	bool appliesPostprocess() override { return true; }
+	ResourceManager::ResolutionGroup getResolutionGroup() override { return ResourceManager::ResolutionGroup::Count; }
+
+	// Tell the resource manager and the camera about the current mode
+	void applyMode();
+
+	std::string                   mOutputTexName;
+	std::string                   mInputTexName;
+
+	// State for our shader
+	FullscreenLaunch::SharedPtr   mpUpscale;
+	GraphicsState::SharedPtr      mpGfxState;
+
+	// Screen-size FBOs with the output and the history (color and accumulated sample weight).  Each frame reads the history
+	//     of the other one.
+	Fbo::SharedPtr                mpHistoryFbo[2];
+	uint32_t                      mCurHistory = 0;
+	bool                          mBuffersNeedClear = false;
+
+	// The camera we jitter, and the offsets we jitter it with
+	Scene::SharedPtr              mpScene;
+	HaltonSamplePattern::SharedPtr mpJitterPattern;
+
+	// The upscaling mode, and the settings of the algorithm, which it shares with the CPU reference
+	uint32_t                      mMode;
+	TemporalUpscaleReference::Settings mSettings;
+};
@@ -0,0 +1,112 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "VisibilityPass.h"
+
+// Some global vars, used to simplify changing shader location & entry points
+namespace {
+	// Where is our shader located?
+	const char* kFileRayTrace = "visibility.rt.hlsl";
+
+	// What are the entry points in that shader for various ray tracing shaders?
+	const char* kEntryPointRayGen = "VisibilityRayGen";
+	const char* kEntryPointMiss0 = "VisibilityMiss";
+	const char* kEntryVisibilityAnyHit = "VisibilityAnyHit";
+	const char* kEntryVisibilityClosestHit = "VisibilityClosestHit";
+};
+
+bool VisibilityPass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
+{
+	// Keep a copy of our resource manager; request needed buffer resources.  Our output only has two channels.
+	mpResManager = pResManager;
+	mpResManager->requestTextureResources({ "WorldPosition", "WorldNormal", mDirectLightingChannel });
+	mpResManager->requestTextureResource(mOutputChannel, ResourceFormat::RG16Float);
+
+	// Tell the pipeline which channels we actually touch.  The direct lighting tells us how much of it comes from the environment map.
+	declareInputs({ "WorldPosition", "WorldNormal", mDirectLightingChannel });
+	declareOutputs({ mOutputChannel }, Resource::State::UnorderedAccess);
+
+	// Create our wrapper around a ray tracing pass.  Shadow and AO rays share ray type #0.
+	mpRays = RayLaunch::create(kFileRayTrace, kEntryPointRayGen);
+	mpRays->addMissShader(kFileRayTrace, kEntryPointMiss0);
+	mpRays->addHitShader(kFileRayTrace, kEntryVisibilityClosestHit, kEntryVisibilityAnyHit);
+	mpRays->compileRayProgram();
+	if (mpScene) mpRays->setScene(mpScene);
+	return true;
+}
+
+void VisibilityPass::initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene)
+{
+	// Stash a copy of the scene and pass it to our ray tracer (if initialized)
+	mpScene = std::dynamic_pointer_cast<RtScene>(pScene);
+	if (!mpScene) return;
+	if (mpRays) mpRays->setScene(mpScene);
+
+	// Set a default AO radius when we load a new scene.
+	mAORadius = glm::max(0.1f, mpScene->getRadius() * 0.05f);
+}
+
+void VisibilityPass::execute(RenderContext* pRenderContext)
+{
+	// Get the output buffer we're writing into.  Every pixel is written, so there's no need to clear it.
+	Texture::SharedPtr pDstTex = mpResManager->getTexture(mOutputChannel);
+
+	// Do we have all the resources we need to render?  If not, return
+	if (!pDstTex || !mpRays || !mpRays->readyToRender()) return;
+
+	// Set our ray tracing shader variables 
+	auto rayGenVars = mpRays->getRayGenVars();
+	rayGenVars["RayGenCB"]["gMinT"] = mpResManager->getMinTDist();
+	rayGenVars["RayGenCB"]["gFrameCount"] = mFrameCount++;
+	rayGenVars["RayGenCB"]["gMaxCosineTheta"] = mMaxCosineTheta;
+	rayGenVars["RayGenCB"]["gAORadius"] = mAORadius;
+	rayGenVars["RayGenCB"]["gNumAORays"] = uint32_t(mNumAORaysPerPixel);
+	rayGenVars["RayGenCB"]["gBlueNoise"] = uint32_t(mUseBlueNoise ? 1 : 0);
+	rayGenVars["RayGenCB"]["gRenderDim"] = mpResManager->getRenderSize();
+
+	// Pass our G-buffer textures down to the HLSL
+	rayGenVars["gPos"] = mpResManager->getTexture("WorldPosition");
+	rayGenVars["gNorm"] = mpResManager->getTexture("WorldNormal");
+	rayGenVars["gOutput"] = pDstTex;
+	rayGenVars["gBlueNoiseMasks"] = mpResManager->getBlueNoise()->getTexture();
+	rayGenVars["gDirectLighting"] = mpResManager->getTexture(mDirectLightingChannel);
+
+	// Shadow rays towards the environment map are drawn from its alias tables
+	EnvMapSampler::SharedPtr pEnvSampler = mpResManager->getEnvironmentMapSampler();
+	if (pEnvSampler)
+	{
+		rayGenVars["RayGenCB"]["gEnvDim"] = uvec2(pEnvSampler->getWidth(), pEnvSampler->getHeight());
+		rayGenVars["gEnvMarginal"] = pEnvSampler->getMarginalBuffer();
+		rayGenVars["gEnvConditional"] = pEnvSampler->getConditionalBuffer();
+	}
+
+	// Shoot our shadow and AO rays, possibly fewer than there are G-buffer pixels (see rayFootprint.hlsli)
+	mpRays->execute(pRenderContext, mpResManager->getRenderSize(ResourceManager::ResolutionGroup::Visibility));
+}
+
+void VisibilityPass::renderGui(Gui* pGui)
+{
+	int dirty = 0;
+	dirty |= (int)pGui->addFloatVar("maxCosineTheta", mMaxCosineTheta, 0.8f, 1.0f, 0.005f, true);
+	dirty |= (int)pGui->addFloatVar("AO radius", mAORadius, 1e-4f, 1e38f, mAORadius * 0.01f);
+	dirty |= (int)pGui->addIntVar("Num AO Rays", mNumAORaysPerPixel, 1, 64);
+	dirty |= (int)pGui->addCheckBox(mUseBlueNoise ? "Using blue-noise samples" : "Using white-noise samples", mUseBlueNoise);
+
+	// If any of our UI parameters changed, let the pipeline know we're doing something different next frame
+	if (dirty) setRefreshFlag();
+}
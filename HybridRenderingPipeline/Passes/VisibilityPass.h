@@ -0,0 +1,66 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include "../SharedUtils/RenderPass.h"
+#include "../SharedUtils/RayLaunch.h"
+
+/** Ray traced shadow and ambient occlusion visibility in a single launch.  Each pixel reads the G-buffer once, traces
+    a cone-jittered shadow ray to a random light plus N cosine-weighted AO rays, and writes both into one RG16F channel
+    (light visibility in .r, AO in .g) that SVGFShadowPass filters directly.  Samples come from spatiotemporal blue noise by
+    default, which leaves less noise after filtering than the per-pixel LCG at the same ray count.
+    When DirectLightingPass lights with the environment map, the shadow ray goes towards it for that share of the light, in a
+    direction drawn from its alias tables.
+*/
+class VisibilityPass : public ::RenderPass, inherit_shared_from_this<::RenderPass, VisibilityPass>
+{
+public:
+    using SharedPtr = std::shared_ptr<VisibilityPass>;
+    using SharedConstPtr = std::shared_ptr<const VisibilityPass>;
+
+    static SharedPtr create(const std::string& channel, const std::string& directLightingChannel = "directLightingChannel") { return SharedPtr(new VisibilityPass(channel, directLightingChannel)); }
+    virtual ~VisibilityPass() = default;
+
+protected:
+    VisibilityPass(const std::string& channel, const std::string& directLightingChannel)
+        : ::RenderPass("Shadow + AO Visibility Rays", "Shadow + AO Visibility Options"), mOutputChannel(channel), mDirectLightingChannel(directLightingChannel) {}
+
+    // Implementation of RenderPass interface
+    bool initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager) override;
+    void initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene) override;
+    void execute(RenderContext* pRenderContext) override;
+    void renderGui(Gui* pGui) override;
+
+    // The RenderPass class defines various methods we can override to specify this pass' properties. 
+    bool requiresScene() override { return true; }
+    bool usesRayTracing() override { return true; }
+    bool canRunAsync() override { return true; }
+    ResourceManager::ResolutionGroup getResolutionGroup() override { return ResourceManager::ResolutionGroup::Visibility; }
+
+    // Rendering state
+    std::string                             mOutputChannel;
+    std::string                             mDirectLightingChannel; ///< Its alpha is the environment map's share of the unshadowed light (see DirectLightingPass)
+    RayLaunch::SharedPtr                    mpRays;                 ///< Our wrapper around a DX Raytracing pass
+    RtScene::SharedPtr                      mpScene;                ///< Our scene file (passed in from app)  
+
+    uint32_t                                mFrameCount = 0;        ///< Frame count used to help seed our shaders' random number generator
+    float                                   mMaxCosineTheta = 0.99f;///< Cone our shadow rays are jittered in
+    float                                   mAORadius = 0.0f;       ///< What radius are we using for AO rays (i.e., maxT when ray tracing)
+    int32_t                                 mNumAORaysPerPixel = 1; ///< How many ambient occlusion rays should we shoot per pixel?
+    bool                                    mUseBlueNoise = true;   ///< Draw samples from the blue-noise masks (or from a white-noise LCG)?
+};
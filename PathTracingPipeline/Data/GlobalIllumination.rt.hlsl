@@ -36,6 +36,7 @@ shared cbuffer GlobalCB
 	uint  gMaxDepth;       // Maximum number of recursive bounces to allow
     float gEmitMult;       // Multiply emissive amount by this factor (set to 1, usually)
 	bool  gOpenScene;
+	bool  gEnvLighting;    // Light the scene with the environment map, importance sampled with its alias tables
 }
 
 // Input and out textures that need to be set by the C++ code (for the ray gen shader)
@@ -46,22 +47,21 @@ shared Texture2D<float4>   gSpecMatl;
 shared Texture2D<float4>   gEmissive;
 shared RWTexture2D<float4> gOutput;
 
+// The environment map and the alias tables EnvMapSampler built for it
+shared Texture2D<float4>   gEnvMap;
+shared ByteAddressBuffer   gEnvMarginal;
+shared ByteAddressBuffer   gEnvConditional;
+
 // A separate file with some simple utility functions: getPerpendicularVector(), initRand(), nextRand()
 #include "GlobalIlluminationUtils.hlsli"
 
+// Falcor's helpers to sample directions towards bright regions of the environment map
+#include "EnvMapSampling.slang"
+
 // Include implementations of GGX normal distribution function, Fresnel approx,
 //     masking term and function to sampl NDF 
 #include "microfacetBRDFUtils.hlsli"
 
-// Our material has have both a diffuse and a specular lobe.  
-//     With what probability should we sample the diffuse one?
-float probabilityToSampleDiffuse(float3 difColor, float3 specColor)
-{
-	float lumDiffuse = max(0.01f, luminance(difColor.rgb));
-	float lumSpecular = max(0.01f, luminance(specColor.rgb));
-	return lumDiffuse / (lumDiffuse + lumSpecular);
-}
-
 // Include shader entries, data structures, and utility functions to spawn rays
 #include "standardShadowRay.hlsli"
 #include "indirectRay.hlsli"
@@ -102,11 +102,7 @@ void SimpleDiffuseGIRayGen()
 	// If we don't hit any geometry, our difuse material contains our background color.
 	float3 shadeColor    = isGeometryValid ? float3(0,0,0) : difMatlColor.rgb;
 
-	// Initialize our random number generator
-	//uint randSeed        = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
-
-	HaltonState hState;
-	haltonInit(hState, launchIndex.x, launchIndex.y, 1, 1, gFrameCount, 1);
+	// Initialize our random number generator.  This stays the LCG, which PathTracerReference and the wavefront mode reproduce.
 	uint randSeed = initRand(launchIndex.x + launchIndex.y * launchDim.x, gFrameCount, 16);
 
 	// Do shading, if we have geoemtry here (otherwise, output the background color)
@@ -115,15 +111,19 @@ void SimpleDiffuseGIRayGen()
         // Add any emissive color from primary rays
         shadeColor = gEmitMult * pixelEmissive.rgb;
 
-		// (Optionally) do explicit direct lighting to a random light in the scene
-		float3 directColor;
+		// (Optionally) do explicit direct lighting to a random light in the scene, and to the environment map
 		if (gDoDirectGI)
-			shadeColor += ggxDirect(randSeed, hState, worldPos.xyz, worldNorm.xyz, V,
+		{
+			shadeColor += ggxDirect(randSeed, worldPos.xyz, worldNorm.xyz, V,
 				                   difMatlColor.rgb, specMatlColor.rgb, roughness);
+			if (gEnvLighting)
+				shadeColor += ggxEnvDirect(randSeed, worldPos.xyz, worldNorm.xyz, V,
+					                      difMatlColor.rgb, specMatlColor.rgb, roughness);
+		}
 
 		// (Optionally) do indirect lighting for global illumination
 		if (gDoIndirectGI && (gMaxDepth > 0))
-			shadeColor += ggxIndirect(randSeed, hState, worldPos.xyz, worldNorm.xyz,
+			shadeColor += ggxIndirect(randSeed, worldPos.xyz, worldNorm.xyz,
 				                      V, difMatlColor.rgb, specMatlColor.rgb, roughness, 0, gOpenScene);
 	}
 	
@@ -94,6 +94,9 @@ ShadingData simplePrepareShadingData(VertexOut v, MaterialData m, float3 camPosW
 	return sd;
 }
 
+// The wavefront mode's compute shaders share the helpers here, but don't import Raytracing.  They define
+//     GI_COMPUTE_SHADER to leave out the functions that need the current hit.
+#ifndef GI_COMPUTE_SHADER
 // Encapsulates a bunch of Falcor stuff into one simpler function. 
 //    -> This can only be called within a closest hit or any hit shader
 ShadingData getHitShadingData(BuiltInTriangleIntersectionAttributes attribs, float3 cameraPos)
@@ -102,6 +105,7 @@ ShadingData getHitShadingData(BuiltInTriangleIntersectionAttributes attribs, flo
 	VertexOut  vsOut = getVertexAttributes(PrimitiveIndex(), attribs);
 	return simplePrepareShadingData(vsOut, gMaterial, cameraPos);
 }
+#endif
 
 // Utility function to get a vector perpendicular to an input vector 
 //    (from "Efficient Construction of Perpendicular Vectors Without Branching")
@@ -179,6 +183,34 @@ float3 getCosHemisphereSample(inout uint randSeed, float3 hitNorm)
 	return tangent * (r * cos(phi).x) + bitangent * (r * sin(phi)) + hitNorm.xyz * sqrt(max(0.0, 1.0f - randVal.x));
 }
 
+// Get a random vector in a cone centered around a specified normal direction.
+float3 getConeSample(inout uint randSeed, float3 hitNorm, float cosThetaMax)
+{
+	// Get 2 random numbers to select our sample with
+	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
+
+	// Cosine weighted hemisphere sample from RNG
+	float3 bitangent = getPerpendicularVector(hitNorm);
+	float3 tangent = cross(bitangent, hitNorm);
+
+	float cosTheta = (1.0 - randVal.x) + randVal.x * cosThetaMax;
+	float r = sqrt(1.0 - cosTheta * cosTheta);
+	float phi = randVal.y * 2.0 * 3.14159265f;
+
+	// Get our cosine-weighted hemisphere lobe sample direction
+	return tangent * (r * cos(phi)) + bitangent * (r * sin(phi)) + hitNorm.xyz * cosTheta;
+}
+
+// Our material has have both a diffuse and a specular lobe.  
+//     With what probability should we sample the diffuse one?
+float probabilityToSampleDiffuse(float3 difColor, float3 specColor)
+{
+	float lumDiffuse = max(0.01f, luminance(difColor.rgb));
+	float lumSpecular = max(0.01f, luminance(specColor.rgb));
+	return lumDiffuse / (lumDiffuse + lumSpecular);
+}
+
+#ifndef GI_COMPUTE_SHADER
 // This function tests if the alpha test fails, given the attributes of the current hit. 
 //   -> Can legally be called in a DXR any-hit shader or a DXR closest-hit shader, and 
 //      accesses Falcor helpers and data structures to extract and perform the alpha test.
@@ -195,3 +227,4 @@ bool alphaTestFails(BuiltInTriangleIntersectionAttributes attribs)
 	// Test if this hit point fails a standard alpha test.  
 	return (baseColor.a < gMaterial.alphaThreshold);
 }
+#endif
@@ -16,19 +16,17 @@
 # ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **********************************************************************************************************************/
 
-#include "halton.hlsli"
-
 // The payload structure for our indirect rays
 struct IndirectRayPayload
 {
 	float3 color;    // The (returned) color in the ray's direction
 	uint   rndSeed;  // Our random seed, so we pick uncorrelated RNGs along our ray
 	uint   rayDepth; // What is the depth of our current ray?
-	HaltonState hState;
 	bool isOpenScene;
+	float bsdfPdf;   // Density the ray direction was sampled with, to weight the environment map on a miss (0 if it wasn't sampled as light)
 };
 
-float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint curPathLen, uint seed, HaltonState hState, uint curDepth, bool isOpenScene)
+float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint curPathLen, uint seed, uint curDepth, bool isOpenScene, float bsdfPdf)
 {
 	// Setup our indirect ray
 	RayDesc rayColor;
@@ -42,8 +40,8 @@ float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint curPat
 	payload.color = float3(0, 0, 0);
 	payload.rndSeed = seed;
 	payload.rayDepth = curDepth + 1;
-	payload.hState = hState;
 	payload.isOpenScene = isOpenScene;
+	payload.bsdfPdf = bsdfPdf;
 
 	// Trace our ray to get a color in the indirect direction.  Use hit group #1 and miss shader #1
 	TraceRay(gRtScene, 0, 0xFF, 1, hitProgramCount, 1, rayColor, payload);
@@ -52,9 +50,38 @@ float3 shootIndirectRay(float3 rayOrigin, float3 rayDir, float minT, uint curPat
 	return payload.color;
 }
 
+// Power heuristic weight of a sample drawn with density pdf, when another strategy could have drawn it with otherPdf
+float misWeight(float pdf, float otherPdf)
+{
+	return (pdf * pdf) / (pdf * pdf + otherPdf * otherPdf);
+}
+
+// Radiance of the environment map for a (u,v) from wsVectorToLatLong()
+float3 envMapRadiance(float2 uv)
+{
+	uint2 dims;
+	gEnvMap.GetDimensions(dims.x, dims.y);
+	return gEnvMap[min(uint2(uv * dims), dims - 1)].rgb;
+}
+
 [shader("miss")]
 void IndirectMiss(inout IndirectRayPayload rayData)
 {
+	if (gEnvLighting)
+	{
+		float2 uv = wsVectorToLatLong(WorldRayDirection());
+		rayData.color = envMapRadiance(uv);
+
+		// Direct lighting also samples the environment map; weight our contribution against it
+		if (rayData.bsdfPdf > 0)
+		{
+			uint2 dims;
+			gEnvMap.GetDimensions(dims.x, dims.y);
+			float envPdf = evalEnvMapPdf(gEnvMarginal, gEnvConditional, dims, WorldRayDirection(), uv);
+			rayData.color *= misWeight(rayData.bsdfPdf, envPdf);
+		}
+		return;
+	}
 	rayData.color = rayData.isOpenScene? float3(0.106, 0.162, 0.184) : float3(0);
 	//rayData.color = float3(0.106, 0.162, 0.184);
 }
@@ -67,7 +94,7 @@ void IndirectAnyHit(inout IndirectRayPayload rayData, BuiltInTriangleIntersectio
 		IgnoreHit();
 }
 
-float3 ggxDirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N, float3 V, float3 dif, float3 spec, float rough)
+float3 ggxDirect(inout uint rndSeed, float3 hit, float3 N, float3 V, float3 dif, float3 spec, float rough)
 {
 	// Pick a random light from our scene to shoot a shadow ray towards
 	int lightToSample = min(int(nextRand(rndSeed) * gLightsCount), gLightsCount - 1);
@@ -78,8 +105,9 @@ float3 ggxDirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N, f
 	float3 L;
 	getLightData(lightToSample, hit, L, lightIntensity, distToLight);
 
-	// Compute our lambertion term (N dot L)
+	// Compute our lambertion term (N dot L).  A light behind the surface adds nothing (and would make the masking term 0/0).
 	float NdotL = saturate(dot(N, L));
+	if (NdotL <= 0) return float3(0, 0, 0);
 
 	// Shoot our shadow ray to our randomly selected light
 	float shadowMult = float(gLightsCount) * shadowRayVisibility(rndSeed, hit, L, gMinT, distToLight);
@@ -103,7 +131,49 @@ float3 ggxDirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N, f
 	return shadowMult * lightIntensity * ( /* NdotL * */ ggxTerm + NdotL * dif / M_PI);
 }
 
-float3 ggxIndirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N, float3 V, float3 dif, float3 spec, float rough, uint rayDepth, bool isOpenScene)
+// Density ggxIndirect() samples direction L with: a mix of the cosine and GGX lobes
+float ggxSamplingPdf(float3 N, float3 V, float3 L, float rough, float probDiffuse)
+{
+	float3 H = normalize(V + L);
+	float NdotL = saturate(dot(N, L));
+	float NdotH = saturate(dot(N, H));
+	float LdotH = saturate(dot(L, H));
+	float ggxProb = ggxNormalDistribution(NdotH, rough) * NdotH / max(4 * LdotH, 1e-6f);
+	return probDiffuse * NdotL / M_PI + (1.0f - probDiffuse) * ggxProb;
+}
+
+// Direct lighting from a direction drawn towards the bright regions of the environment map
+float3 ggxEnvDirect(inout uint rndSeed, float3 hit, float3 N, float3 V, float3 dif, float3 spec, float rough)
+{
+	uint2 dims;
+	gEnvMap.GetDimensions(dims.x, dims.y);
+
+	float envPdf;
+	float3 L = sampleEnvMap(gEnvMarginal, gEnvConditional, dims, float2(nextRand(rndSeed), nextRand(rndSeed)), envPdf);
+	float NdotL = saturate(dot(N, L));
+	if (NdotL <= 0 || envPdf <= 0) return float3(0, 0, 0);
+
+	// Nothing between us and the environment?
+	float visibility = shadowRayVisibility(rndSeed, hit, L, gMinT, 1.0e38f);
+	if (visibility <= 0) return float3(0, 0, 0);
+
+	// Evaluate the same BRDF as ggxDirect()
+	float3 H = normalize(V + L);
+	float NdotH = saturate(dot(N, H));
+	float LdotH = saturate(dot(L, H));
+	float NdotV = saturate(dot(N, V));
+	float  D = ggxNormalDistribution(NdotH, rough);
+	float  G = ggxSchlickMaskingTerm(NdotL, NdotV, rough);
+	float3 F = schlickFresnel(spec, LdotH);
+	float3 ggxTerm = D * G * F / (4 * NdotV /* * NdotL */);
+
+	// Indirect rays can reach the environment in this direction too, weight our sample against them
+	float bsdfPdf = ggxSamplingPdf(N, V, L, rough, probabilityToSampleDiffuse(dif, spec));
+	float3 radiance = envMapRadiance(wsVectorToLatLong(L));
+	return visibility * radiance * (ggxTerm + NdotL * dif / M_PI) * misWeight(envPdf, bsdfPdf) / envPdf;
+}
+
+float3 ggxIndirect(inout uint rndSeed, float3 hit, float3 N, float3 V, float3 dif, float3 spec, float rough, uint rayDepth, bool isOpenScene)
 {
 	// We have to decide whether we sample our diffuse or specular/ggx lobe.
 	float probDiffuse = probabilityToSampleDiffuse(dif, spec);
@@ -117,7 +187,8 @@ float3 ggxIndirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N,
 	{
 		// Shoot a randomly selected cosine-sampled diffuse ray.
 		float3 L = getCosHemisphereSample(rndSeed, N);
-		float3 bounceColor = shootIndirectRay(hit, L, gMinT, 0, rndSeed, hState, rayDepth, isOpenScene);
+		float bsdfPdf = (gEnvLighting && gDoDirectGI) ? ggxSamplingPdf(N, V, L, rough, probDiffuse) : 0.0f;
+		float3 bounceColor = shootIndirectRay(hit, L, gMinT, 0, rndSeed, rayDepth, isOpenScene, bsdfPdf);
 
 		// Accumulate the color: (NdotL * incomingLight * dif / pi) 
 		// Probability of sampling:  (NdotL / pi) * probDiffuse
@@ -132,8 +203,12 @@ float3 ggxIndirect(inout uint rndSeed, HaltonState hState, float3 hit, float3 N,
 		// Compute the outgoing direction based on this (perfectly reflective) microfacet
 		float3 L = normalize(2.f * dot(V, H) * H - V);
 
+		// Reflections below the horizon carry no light (their weight would be 0/0), so don't trace them
+		if (dot(N, L) <= 0) return float3(0, 0, 0);
+
 		// Compute our color by tracing a ray in this direction
-		float3 bounceColor = shootIndirectRay(hit, L, gMinT, 0, rndSeed, hState, rayDepth, isOpenScene);
+		float bsdfPdf = (gEnvLighting && gDoDirectGI) ? ggxSamplingPdf(N, V, L, rough, probDiffuse) : 0.0f;
+		float3 bounceColor = shootIndirectRay(hit, L, gMinT, 0, rndSeed, rayDepth, isOpenScene, bsdfPdf);
 
 		// Compute some dot products needed for shading
 		float  NdotL = saturate(dot(N, L));
@@ -167,8 +242,13 @@ void IndirectClosestHit(inout IndirectRayPayload rayData, BuiltInTriangleInterse
 	// Do direct illumination at this hit location
     if (gDoDirectGI)
     {
-        rayData.color += ggxDirect(rayData.rndSeed, rayData.hState, shadeData.posW, shadeData.N, shadeData.V,
+        rayData.color += ggxDirect(rayData.rndSeed, shadeData.posW, shadeData.N, shadeData.V,
             shadeData.diffuse, shadeData.specular, 0.0);
+
+        // Use the roughness ggxIndirect() samples with, so the two weight each other consistently
+        if (gEnvLighting)
+            rayData.color += ggxEnvDirect(rayData.rndSeed, shadeData.posW, shadeData.N, shadeData.V,
+                shadeData.diffuse, shadeData.specular, shadeData.roughness);
     }
 
 	// Do indirect illumination at this hit location (if we haven't traversed too far)
@@ -177,7 +257,7 @@ void IndirectClosestHit(inout IndirectRayPayload rayData, BuiltInTriangleInterse
 		// Use the same normal for the normal-mapped and non-normal mapped vectors... This means we could get light
 		//     leaks at secondary surfaces with normal maps due to indirect rays going below the surface.  This
 		//     isn't a huge issue, but this is a (TODO: fix)
-		rayData.color += ggxIndirect(rayData.rndSeed, rayData.hState, shadeData.posW, shadeData.N, shadeData.V,
+		rayData.color += ggxIndirect(rayData.rndSeed, shadeData.posW, shadeData.N, shadeData.V,
 			shadeData.diffuse, shadeData.specular, shadeData.roughness, rayData.rayDepth, rayData.isOpenScene);
 	}
 }
@@ -15,24 +15,6 @@
 # LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
 # ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **********************************************************************************************************************/
-// Get a random vector in a cone centered around a specified normal direction.
-float3 getConeSample(inout uint randSeed, float3 hitNorm, float cosThetaMax)
-{
-	// Get 2 random numbers to select our sample with
-	float2 randVal = float2(nextRand(randSeed), nextRand(randSeed));
-
-	// Cosine weighted hemisphere sample from RNG
-	float3 bitangent = getPerpendicularVector(hitNorm);
-	float3 tangent = cross(bitangent, hitNorm);
-
-	float cosTheta = (1.0 - randVal.x) + randVal.x * cosThetaMax;
-	float r = sqrt(1.0 - cosTheta * cosTheta);
-	float phi = randVal.y * 2.0 * 3.14159265f;
-
-	// Get our cosine-weighted hemisphere lobe sample direction
-	return tangent * (r * cos(phi)) + bitangent * (r * sin(phi)) + hitNorm.xyz * cosTheta;
-}
-
 // Payload for our shadow rays. 
 struct ShadowRayPayload
 {
@@ -0,0 +1,265 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// The compute stages of the wavefront mode: generating paths from the G-buffer, shading each bounce's queue, and
+//     writing the result.  wavefrontCommon.hlsli describes the path state and how a bounce is laid out; the shading
+//     follows SimpleDiffuseGIRayGen() and IndirectClosestHit() (GlobalIllumination.rt.hlsl and indirectRay.hlsli) and
+//     draws the same random numbers, so without Russian roulette both modes render the same image.
+
+#include "HostDeviceSharedMacros.h"
+#include "HostDeviceData.h"
+
+import ShaderCommon;                 // gLights[], filled in by ComputeLaunch::setLights()
+import Shading;
+import Lights;
+
+#define GI_COMPUTE_SHADER
+#include "GlobalIlluminationUtils.hlsli"
+#include "microfacetBRDFUtils.hlsli"
+#include "wavefrontCommon.hlsli"
+
+cbuffer ShadeCB
+{
+	float3 gCameraPos;
+	uint   gFrameCount;             // An integer changing every frame to update the random number
+	bool   gDoIndirectGI;
+	bool   gDoDirectGI;
+	uint   gMaxDepth;               // Maximum number of indirect bounces
+	float  gEmitMult;
+	bool   gOpenScene;
+	bool   gEnvLighting;            // Paths that leave the scene see the environment map.  Unlike the megakernel, we
+	                                //     don't also sample it as a light, so these misses aren't MIS weighted.
+	bool   gRussianRoulette;
+	uint   gRouletteStartDepth;     // First bounce whose paths can be terminated
+	float  gRouletteMinProbability; // Lowest probability to continue a path with
+}
+
+// G-buffer, for the primary hits
+Texture2D<float4>   gPos;
+Texture2D<float4>   gNorm;
+Texture2D<float4>   gDiffuseMatl;
+Texture2D<float4>   gSpecMatl;
+Texture2D<float4>   gEmissive;
+
+Texture2D<float4>   gEnvMap;
+RWByteAddressBuffer gDispatchArgs;      // Thread group counts of each bounce's shading dispatch
+RWTexture2D<float4> gOutput;
+
+// Light arriving along a ray that left the scene
+float3 skyRadiance(float3 dir)
+{
+	if (gEnvLighting)
+	{
+		uint2 dims;
+		gEnvMap.GetDimensions(dims.x, dims.y);
+		return gEnvMap[min(uint2(wsVectorToLatLong(dir) * dims), dims - 1)].rgb;
+	}
+	return gOpenScene ? float3(0.106, 0.162, 0.184) : float3(0, 0, 0);
+}
+
+// Starts a path at every pixel that has geometry in the G-buffer, and queues it for bounce 0
+[numthreads(16, 16, 1)]
+void WavefrontGenerate(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 dims;
+	gOutput.GetDimensions(dims.x, dims.y);
+	if (any(threadId.xy >= dims)) return;
+	uint path = threadId.x + threadId.y * dims.x;
+
+	float4 worldPos = gPos[threadId.xy];
+	float4 difMatlColor = gDiffuseMatl[threadId.xy];
+
+	// If we don't hit any geometry, our difuse material contains our background color
+	if (worldPos.w == 0.0f)
+	{
+		gPathRadiance[path] = float4(difMatlColor.rgb, 0.0f);
+		return;
+	}
+
+	float4 specMatlColor = gSpecMatl[threadId.xy];
+	float3 N = gNorm[threadId.xy].xyz;
+	float3 V = normalize(gCameraPos - worldPos.xyz);
+	if (dot(N, V) <= 0.0f) N = -N;
+
+	gHitPosW[path] = float4(worldPos.xyz, 1.0f);
+	gHitNormal[path] = float4(N, specMatlColor.a * specMatlColor.a);
+	gHitDiffuse[path] = float4(difMatlColor.rgb, 0.0f);
+	gHitSpecular[path] = float4(specMatlColor.rgb, 0.0f);
+	gHitEmissive[path] = float4(gEmissive[threadId.xy].rgb, 0.0f);
+
+	gPathOrigin[path] = float4(gCameraPos, 0.0f);
+	gPathThroughput[path] = float4(1.0f, 1.0f, 1.0f, 0.0f);
+	gPathRadiance[path] = float4(gEmitMult * gEmissive[threadId.xy].rgb, 0.0f);
+	gPathSeed[path] = initRand(path, gFrameCount, 16);
+
+	uint slot;
+	InterlockedAdd(gCounters[WAVEFRONT_PATH_COUNT(0)], 1, slot);
+	gPathQueue[slot] = path;
+}
+
+// Sizes the shading dispatch of bounce gBounce to its queue
+[numthreads(1, 1, 1)]
+void WavefrontPrepareShade(uint3 threadId : SV_DispatchThreadID)
+{
+	uint pathCount = gCounters[WAVEFRONT_PATH_COUNT(gBounce)];
+	gDispatchArgs.Store3(12 * gBounce, uint3((pathCount + WAVEFRONT_GROUP_SIZE - 1) / WAVEFRONT_GROUP_SIZE, 1, 1));
+}
+
+// Shades one hit of every path in gPathQueue
+[numthreads(WAVEFRONT_GROUP_SIZE, 1, 1)]
+void WavefrontShade(uint3 threadId : SV_DispatchThreadID)
+{
+	if (threadId.x >= gCounters[WAVEFRONT_PATH_COUNT(gBounce)]) return;
+	uint path = gPathQueue[threadId.x];
+
+	float3 throughput = gPathThroughput[path].rgb;
+	float3 radiance = gPathRadiance[path].rgb;
+	float4 hitPos = gHitPosW[path];
+
+	// Bounce 0 already added the G-buffer's emission.  Later bounces may have missed the scene.
+	if (gBounce > 0)
+	{
+		if (hitPos.w == 0.0f)
+		{
+			gPathRadiance[path] = float4(radiance + throughput * skyRadiance(gPathDir[path].xyz), 0.0f);
+			return;
+		}
+		radiance += throughput * gEmitMult * gHitEmissive[path].rgb;
+	}
+
+	uint randSeed = gPathSeed[path];
+	float3 hit = hitPos.xyz;
+	float3 N = gHitNormal[path].xyz;
+	float rough = gHitNormal[path].w;
+	float3 V = normalize(gPathOrigin[path].xyz - hit);
+	float3 dif = gHitDiffuse[path].rgb;
+	float3 spec = gHitSpecular[path].rgb;
+
+	// Set up the shadow ray ggxDirect() would shoot.  Like IndirectClosestHit(), later bounces drop the specular lobe.
+	if (gDoDirectGI && gLightsCount > 0)
+	{
+		int lightToSample = min(int(nextRand(randSeed) * gLightsCount), gLightsCount - 1);
+
+		float distToLight;
+		float3 lightIntensity;
+		float3 L;
+		getLightData(lightToSample, hit, L, lightIntensity, distToLight);
+
+		float NdotL = saturate(dot(N, L));
+		if (NdotL > 0)
+		{
+			float directRough = (gBounce == 0) ? rough : 0.0f;
+			float3 shadowDir = normalize(getConeSample(randSeed, L, 0.995));
+
+			float3 H = normalize(V + L);
+			float NdotH = saturate(dot(N, H));
+			float LdotH = saturate(dot(L, H));
+			float NdotV = saturate(dot(N, V));
+			float  D = ggxNormalDistribution(NdotH, directRough);
+			float  G = ggxSchlickMaskingTerm(NdotL, NdotV, directRough);
+			float3 F = schlickFresnel(spec, LdotH);
+			float3 ggxTerm = D * G * F / (4 * NdotV);
+
+			uint slot;
+			InterlockedAdd(gCounters[WAVEFRONT_SHADOW_COUNT(gBounce)], 1, slot);
+			gShadowQueue[slot] = path;
+			gShadowRay[path] = float4(shadowDir, distToLight);
+			gShadowContribution[path] = float4(throughput * float(gLightsCount) * lightIntensity * (ggxTerm + NdotL * dif / M_PI), 0.0f);
+		}
+	}
+
+	// Pick the direction ggxIndirect() would continue in, and weigh the path by that sample
+	bool extend = gDoIndirectGI && (gBounce < gMaxDepth);
+	if (extend)
+	{
+		float probDiffuse = probabilityToSampleDiffuse(dif, spec);
+		float chooseDiffuse = (nextRand(randSeed) < probDiffuse);
+		float NdotV = saturate(dot(N, V));
+
+		float3 L;
+		float3 weight;
+		if (chooseDiffuse)
+		{
+			L = getCosHemisphereSample(randSeed, N);
+			weight = dif / probDiffuse;
+		}
+		else
+		{
+			float3 H = getGGXMicrofacet(randSeed, rough, N);
+			L = normalize(2.f * dot(V, H) * H - V);
+
+			float  NdotL = saturate(dot(N, L));
+			float  NdotH = saturate(dot(N, H));
+			float  LdotH = saturate(dot(L, H));
+			float  D = ggxNormalDistribution(NdotH, rough);
+			float  G = ggxSchlickMaskingTerm(NdotL, NdotV, rough);
+			float3 F = schlickFresnel(spec, LdotH);
+			float3 ggxTerm = D * G * F / (4 * NdotL * NdotV);
+			float  ggxProb = D * NdotH / (4 * LdotH);
+			weight = NdotL * ggxTerm / (ggxProb * (1.0f - probDiffuse));
+
+			// Reflections below the horizon carry no light
+			extend = (dot(N, L) > 0);
+		}
+
+		// The megakernel zeroes out pixels whose color is NaN.  Mark the path, so the pixel ends up the same.
+		if (extend && any(isnan(weight)))
+		{
+			radiance = asfloat(0x7fc00000).xxx;
+			extend = false;
+		}
+
+		// Russian roulette: keep the path with a probability that follows its throughput, and boost the survivors
+		if (extend)
+		{
+			throughput *= weight;
+			if (gRussianRoulette && (gBounce + 1 >= gRouletteStartDepth))
+			{
+				float q = min(1.0f, max(gRouletteMinProbability, max(throughput.r, max(throughput.g, throughput.b))));
+				if (nextRand(randSeed) >= q) extend = false;
+				throughput /= q;
+			}
+		}
+
+		if (extend)
+		{
+			gPathOrigin[path] = float4(hit, 0.0f);
+			gPathDir[path] = float4(L, 0.0f);
+
+			uint slot;
+			InterlockedAdd(gCounters[WAVEFRONT_PATH_COUNT(gBounce + 1)], 1, slot);
+			gNextPathQueue[slot] = path;
+		}
+	}
+
+	gPathThroughput[path] = float4(throughput, 0.0f);
+	gPathRadiance[path] = float4(radiance, 0.0f);
+	gPathSeed[path] = randSeed;
+}
+
+// Writes every path's radiance to the output, zeroing the NaNs out like the megakernel does
+[numthreads(16, 16, 1)]
+void WavefrontResolve(uint3 threadId : SV_DispatchThreadID)
+{
+	uint2 dims;
+	gOutput.GetDimensions(dims.x, dims.y);
+	if (any(threadId.xy >= dims)) return;
+
+	float3 radiance = gPathRadiance[threadId.x + threadId.y * dims.x].rgb;
+	gOutput[threadId.xy] = float4(any(isnan(radiance)) ? float3(0, 0, 0) : radiance, 1.0f);
+}
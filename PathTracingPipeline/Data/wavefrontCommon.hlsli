@@ -0,0 +1,74 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Path state shared by the stages of the wavefront mode (see GlobalIlluminationPass::executeWavefront()).  Every stage
+//     works on one path per pixel, indexed by the pixel's position in the frame (x + y * width), through
+//     structure-of-arrays buffers.  Each bounce:
+//         -> wavefrontShade.cs.hlsl shades the paths in gPathQueue: it adds what the hit emits, sets up a shadow ray
+//            (queued in gShadowQueue), samples the BRDF, plays Russian roulette and appends survivors to gNextPathQueue
+//         -> wavefrontShadow.rt.hlsl traces the queued shadow rays and adds the light of those that get through
+//         -> wavefrontExtend.rt.hlsl traces the survivors and writes their next hit record
+//     Queues are compacted with atomics on gCounters, so a bounce only launches threads for the paths still alive.
+//     Must match GlobalIllumination.h.
+
+// Largest number of indirect bounces the wavefront mode keeps counters for
+#define WAVEFRONT_MAX_BOUNCES  8
+
+// gCounters holds the length of each bounce's path queue, followed by the number of shadow rays each bounce traced
+#define WAVEFRONT_PATH_COUNT(bounce)    (bounce)
+#define WAVEFRONT_SHADOW_COUNT(bounce)  (WAVEFRONT_MAX_BOUNCES + 1 + (bounce))
+
+// Threads per group of the stages dispatched over a queue
+#define WAVEFRONT_GROUP_SIZE  64
+
+cbuffer WavefrontCB
+{
+	uint   gBounce;                 // Bounce this stage runs for.  Bounce 0 shades the G-buffer.
+	uint   gFrameWidth;             // Width of the frame, to go from pixels to path indices
+	float  gMinT;                   // Min distance to start a ray to avoid self-occlusion
+}
+
+// Per path state
+RWBuffer<float4>           gPathOrigin;        // Where the ray that found the current hit started (xyz)
+RWBuffer<float4>           gPathDir;           // Direction of the path's next extension ray (xyz)
+RWBuffer<float4>           gPathThroughput;    // Product of the BRDF sample weights so far (rgb)
+RWBuffer<float4>           gPathRadiance;      // Light gathered so far (rgb).  NaN once a sample weight was NaN.
+RWBuffer<uint>             gPathSeed;          // The path's random number generator state
+
+// The hit record the extension rays write, and the shading stage reads
+RWBuffer<float4>           gHitPosW;           // Position (xyz), and 1 in w if the ray hit anything (0 if it missed)
+RWBuffer<float4>           gHitNormal;         // Normal facing the ray origin (xyz), and the GGX roughness to sample with (w)
+RWBuffer<float4>           gHitDiffuse;
+RWBuffer<float4>           gHitSpecular;
+RWBuffer<float4>           gHitEmissive;
+
+// The shadow ray each path set up this bounce
+RWBuffer<float4>           gShadowRay;         // Direction (xyz) and distance to the light (w)
+RWBuffer<float4>           gShadowContribution; // Light the path gathers if nothing is in the way (rgb)
+
+// Queues of path indices, and their lengths
+RWBuffer<uint>             gPathQueue;         // Paths to shade this bounce
+RWBuffer<uint>             gNextPathQueue;     // Paths that continue to the next bounce
+RWBuffer<uint>             gShadowQueue;       // Paths that traced a shadow ray this bounce
+RWBuffer<uint>             gCounters;
+
+// Linear index of a ray tracing launch (which is 2D, as large as the frame)
+uint wavefrontLaunchIndex(uint2 launchIndex)
+{
+	return launchIndex.x + launchIndex.y * gFrameWidth;
+}
@@ -0,0 +1,100 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Traces the extension rays of the wavefront mode: one thread for each path that survived this bounce's shading.
+//     The launch covers the whole frame, since its size can't come from the GPU; threads past the end of the queue
+//     exit right away.  The closest hit hands its surface back, and we store it as the path's next hit record.
+
+#include "HostDeviceSharedMacros.h"
+#include "HostDeviceData.h"
+
+import Raytracing;
+import ShaderCommon;
+import Shading;
+import Lights;
+
+#include "GlobalIlluminationUtils.hlsli"
+#include "wavefrontCommon.hlsli"
+
+struct ExtensionRayPayload
+{
+	float3 posW;
+	float  hitT;             // Negative if the ray missed
+	float3 N;
+	float  roughness;
+	float3 diffuse;
+	float3 specular;
+	float3 emissive;
+};
+
+[shader("miss")]
+void ExtensionMiss(inout ExtensionRayPayload rayData)
+{
+	rayData.hitT = -1.0f;
+}
+
+[shader("anyhit")]
+void ExtensionAnyHit(inout ExtensionRayPayload rayData, BuiltInTriangleIntersectionAttributes attribs)
+{
+	// Is this a transparent part of the surface?  If so, ignore this hit
+	if (alphaTestFails(attribs))
+		IgnoreHit();
+}
+
+[shader("closesthit")]
+void ExtensionClosestHit(inout ExtensionRayPayload rayData, BuiltInTriangleIntersectionAttributes attribs)
+{
+	// Same shading data IndirectClosestHit() uses
+	ShadingData shadeData = getHitShadingData(attribs, WorldRayOrigin());
+	rayData.posW = shadeData.posW;
+	rayData.hitT = RayTCurrent();
+	rayData.N = shadeData.N;
+	rayData.roughness = shadeData.roughness;
+	rayData.diffuse = shadeData.diffuse;
+	rayData.specular = shadeData.specular;
+	rayData.emissive = shadeData.emissive;
+}
+
+[shader("raygeneration")]
+void ExtensionRayGen()
+{
+	uint i = wavefrontLaunchIndex(DispatchRaysIndex().xy);
+	if (i >= gCounters[WAVEFRONT_PATH_COUNT(gBounce + 1)]) return;
+	uint path = gNextPathQueue[i];
+
+	RayDesc ray;
+	ray.Origin = gPathOrigin[path].xyz;
+	ray.Direction = gPathDir[path].xyz;
+	ray.TMin = gMinT;
+	ray.TMax = 1.0e38f;
+
+	ExtensionRayPayload payload;
+	payload.hitT = -1.0f;
+	TraceRay(gRtScene, RAY_FLAG_NONE, 0xFF, 0, hitProgramCount, 0, ray, payload);
+
+	if (payload.hitT < 0.0f)
+	{
+		gHitPosW[path] = float4(0.0f, 0.0f, 0.0f, 0.0f);
+		return;
+	}
+	gHitPosW[path] = float4(payload.posW, 1.0f);
+	gHitNormal[path] = float4(payload.N, payload.roughness);
+	gHitDiffuse[path] = float4(payload.diffuse, 0.0f);
+	gHitSpecular[path] = float4(payload.specular, 0.0f);
+	gHitEmissive[path] = float4(payload.emissive, 0.0f);
+}
@@ -0,0 +1,57 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// Traces the shadow rays this bounce's shading set up, one thread per queued path, and adds the light of the rays
+//     that reach their light.  Like wavefrontExtend.rt.hlsl, the launch covers the whole frame.
+
+#include "HostDeviceSharedMacros.h"
+#include "HostDeviceData.h"
+
+import Raytracing;
+import ShaderCommon;
+import Shading;
+import Lights;
+
+#include "GlobalIlluminationUtils.hlsli"
+#include "wavefrontCommon.hlsli"
+
+// ShadowMiss(), ShadowAnyHit() and ShadowClosestHit()
+#include "standardShadowRay.hlsli"
+
+[shader("raygeneration")]
+void ShadowRayGen()
+{
+	uint i = wavefrontLaunchIndex(DispatchRaysIndex().xy);
+	if (i >= gCounters[WAVEFRONT_SHADOW_COUNT(gBounce)]) return;
+	uint path = gShadowQueue[i];
+
+	float4 shadowRay = gShadowRay[path];
+	RayDesc ray;
+	ray.Origin = gHitPosW[path].xyz;
+	ray.Direction = shadowRay.xyz;
+	ray.TMin = gMinT;
+	ray.TMax = shadowRay.w;
+
+	// Our shadow rays are *assumed* to hit geometry; the miss shader changes this to 1.0 for "visible"
+	ShadowRayPayload payload = { 0.0f };
+	TraceRay(gRtScene, RAY_FLAG_ACCEPT_FIRST_HIT_AND_END_SEARCH | RAY_FLAG_SKIP_CLOSEST_HIT_SHADER,
+		0xFF, 0, hitProgramCount, 0, ray, payload);
+
+	if (payload.visFactor > 0.0f)
+		gPathRadiance[path] = float4(gPathRadiance[path].rgb + gShadowContribution[path].rgb, 0.0f);
+}
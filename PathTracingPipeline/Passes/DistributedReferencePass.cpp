@@ -0,0 +1,247 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "DistributedReferencePass.h"
+#include "Data/VertexAttrib.h"
+#include "Utils/Math/FalcorMath.h"
+#include <map>
+
+namespace {
+	// What GlobalIlluminationPass and SimpleGBufferPass show where rays miss, in an open scene
+	const vec3 kBackgroundColor = vec3(0.48f, 0.75f, 0.85f);
+	const vec3 kSkyColor = vec3(0.106f, 0.162f, 0.184f);
+
+	// Object-space triangles of a mesh's full-detail level, read back from its vertex and index buffers
+	std::vector<vec3> readMeshTriangles(const Mesh* pMesh)
+	{
+		std::vector<vec3> corners;
+		const Vao* pVao = pMesh->getVao().get();
+		Vao::ElementDesc position = pVao->getElementIndexByLocation(VERTEX_POSITION_LOC);
+		if (position.vbIndex == Vao::ElementDesc::kInvalidIndex || !pVao->getIndexBuffer() || pVao->getPrimitiveTopology() != Vao::Topology::TriangleList) return corners;
+
+		const VertexBufferLayout* pLayout = pVao->getVertexLayout()->getBufferLayout(position.vbIndex).get();
+		uint32_t stride = pLayout->getStride();
+		uint32_t offset = pLayout->getElementOffset(position.elementIndex);
+		bool quantized = pLayout->getElementFormat(position.elementIndex) == ResourceFormat::RGBA16Unorm;
+
+		// Mapping copies the buffers to staging memory, and waits for the GPU
+		const Buffer::SharedPtr& pVB = pVao->getVertexBuffer(position.vbIndex);
+		const Buffer::SharedPtr& pIB = pVao->getIndexBuffer();
+		const uint8_t* pVertices = (const uint8_t*)pVB->map(Buffer::MapType::Read);
+		const uint8_t* pIndices = (const uint8_t*)pIB->map(Buffer::MapType::Read);
+		bool shortIndices = pVao->getIndexBufferFormat() == ResourceFormat::R16Uint;
+
+		const Mesh::Lod& lod = pMesh->getLod(0);
+		corners.resize(lod.indexCount);
+		for (uint32_t i = 0; i < lod.indexCount; i++)
+		{
+			uint32_t index = shortIndices ? ((const uint16_t*)pIndices)[lod.firstIndex + i] : ((const uint32_t*)pIndices)[lod.firstIndex + i];
+			const uint8_t* pVertex = pVertices + size_t(index) * stride + offset;
+			if (quantized)
+			{
+				const uint16_t* pQuantized = (const uint16_t*)pVertex;
+				vec4 p = pMesh->getPositionDequantMatrix() * vec4(pQuantized[0] / 65535.0f, pQuantized[1] / 65535.0f, pQuantized[2] / 65535.0f, 1.0f);
+				corners[i] = vec3(p);
+			}
+			else
+			{
+				corners[i] = *(const vec3*)pVertex;
+			}
+		}
+
+		pIB->unmap();
+		pVB->unmap();
+		return corners;
+	}
+
+	// The constant shading parameters of a material, as Shading.slang's prepareShadingData() derives them.  Textures are ignored.
+	PathTracerReference::Material exportMaterial(const Material* pMaterial)
+	{
+		PathTracerReference::Material m;
+		vec3 baseColor = vec3(pMaterial->getBaseColor());
+		const vec4& spec = pMaterial->getSpecularParams();
+		if (pMaterial->getShadingModel() == ShadingModelMetalRough)
+		{
+			m.diffuse = glm::mix(baseColor, vec3(0.0f), spec.b);
+			m.specular = glm::mix(vec3(0.04f), baseColor, spec.b);
+			m.linearRoughness = spec.g;
+		}
+		else
+		{
+			m.diffuse = baseColor;
+			m.specular = vec3(spec);
+			m.linearRoughness = 1.0f - spec.a;
+		}
+		m.emissive = pMaterial->getEmissiveColor();
+		return m;
+	}
+};
+
+bool DistributedReferencePass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
+{
+	// We don't read or write any channels, so the pipeline never culls us
+	mpResManager = pResManager;
+	return true;
+}
+
+void DistributedReferencePass::initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene)
+{
+	// Render a reference of every new scene, once
+	mpScene = pScene;
+	mRendered = (pScene == nullptr);
+}
+
+PathTracerReference::Scene DistributedReferencePass::exportScene()
+{
+	PathTracerReference::Scene scene;
+	std::map<const Material*, uint32_t> materialIDs;
+	uint32_t texturedMaterials = 0;
+
+	for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+	{
+		const Model* pModel = mpScene->getModel(modelID).get();
+		for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+		{
+			const Mesh* pMesh = pModel->getMesh(meshID).get();
+			const Material* pMaterial = pMesh->getMaterial().get();
+			auto material = materialIDs.find(pMaterial);
+			if (material == materialIDs.end())
+			{
+				material = materialIDs.insert(std::make_pair(pMaterial, uint32_t(scene.materials.size()))).first;
+				scene.materials.push_back(exportMaterial(pMaterial));
+				if (pMaterial->getBaseColorTexture() || pMaterial->getSpecularTexture() || pMaterial->getEmissiveTexture()) texturedMaterials++;
+			}
+
+			// Skinned meshes are exported in their bind pose
+			std::vector<vec3> corners = readMeshTriangles(pMesh);
+			for (uint32_t modelInstanceID = 0; modelInstanceID < mpScene->getModelInstanceCount(modelID); modelInstanceID++)
+			{
+				const Scene::ModelInstance* pModelInstance = mpScene->getModelInstance(modelID, modelInstanceID).get();
+				if (!pModelInstance->isVisible()) continue;
+				for (uint32_t instanceID = 0; instanceID < pModel->getMeshInstanceCount(meshID); instanceID++)
+				{
+					const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, instanceID).get();
+					if (!pMeshInstance->isVisible()) continue;
+
+					mat4 worldMat = pModelInstance->getTransformMatrix() * pMeshInstance->getTransformMatrix();
+					for (size_t i = 0; i + 2 < corners.size(); i += 3)
+					{
+						PathTracerReference::Triangle tri;
+						tri.p0 = vec3(worldMat * vec4(corners[i], 1.0f));
+						tri.p1 = vec3(worldMat * vec4(corners[i + 1], 1.0f));
+						tri.p2 = vec3(worldMat * vec4(corners[i + 2], 1.0f));
+						tri.material = material->second;
+						scene.triangles.push_back(tri);
+					}
+				}
+			}
+		}
+	}
+	if (texturedMaterials > 0)
+	{
+		logWarning("DistributedReferencePass: " + std::to_string(texturedMaterials) + " materials are textured, the reference uses their constant colors");
+	}
+
+	// The reference only has point lights.  Spot lights are exported without their cone.
+	uint32_t skippedLights = 0;
+	for (uint32_t i = 0; i < mpScene->getLightCount(); i++)
+	{
+		const PointLight* pPointLight = dynamic_cast<const PointLight*>(mpScene->getLight(i).get());
+		if (!pPointLight)
+		{
+			skippedLights++;
+			continue;
+		}
+		PathTracerReference::PointLight light;
+		light.position = pPointLight->getWorldPosition();
+		light.intensity = pPointLight->getIntensity();
+		scene.lights.push_back(light);
+	}
+	if (skippedLights > 0)
+	{
+		logWarning("DistributedReferencePass: skipped " + std::to_string(skippedLights) + " lights which aren't point lights");
+	}
+
+	const Camera* pCamera = mpScene->getActiveCamera().get();
+	scene.cameraPos = pCamera->getPosition();
+	scene.cameraTarget = pCamera->getTarget();
+	scene.cameraUp = pCamera->getUpVector();
+	if (pCamera->getFocalLength() > 0.0f) scene.fovY = focalLengthToFovY(pCamera->getFocalLength(), pCamera->getFrameHeight());
+	scene.backgroundColor = kBackgroundColor;
+	scene.skyColor = kSkyColor;
+
+	PathTracerReference::buildBvh(scene);
+	return scene;
+}
+
+void DistributedReferencePass::execute(RenderContext* pRenderContext)
+{
+	if (mRendered || !mpScene) return;
+	mRendered = true;
+
+	// The render blocks the application until it's done
+	PathTracerReference::Scene scene = exportScene();
+	PathTracerReference::Settings ptSettings;
+	ptSettings.width = mpResManager->getWidth();
+	ptSettings.height = mpResManager->getHeight();
+
+	if (!mSceneFile.empty())
+	{
+		if (PathTracerReference::saveScene(scene, mSceneFile))
+		{
+			mStatus = "Exported " + mSceneFile + " (" + std::to_string(ptSettings.width) + "x" + std::to_string(ptSettings.height) + ")";
+			logInfo("DistributedReferencePass: " + mStatus);
+		}
+		else
+		{
+			mStatus = "Can't write " + mSceneFile;
+			logError("DistributedReferencePass: " + mStatus);
+		}
+	}
+	if (mSamplesPerPixel == 0) return;
+
+	DistributedReference::Settings settings;
+	settings.width = ptSettings.width;
+	settings.height = ptSettings.height;
+	settings.totalSamples = mSamplesPerPixel;
+	settings.workerCount = mWorkerCount;
+
+	logInfo("DistributedReferencePass: rendering " + std::to_string(scene.triangles.size()) + " triangles at " + std::to_string(settings.width) + "x" +
+		std::to_string(settings.height) + ", " + std::to_string(settings.totalSamples) + " samples per pixel on " + std::to_string(settings.workerCount) + " workers");
+	CpuTimer timer;
+	timer.update();
+	DistributedReference::SharedPtr pRenderer = DistributedReference::create(settings, DistributedReference::pathTracerBackend(scene, ptSettings));
+	pRenderer->render();
+	timer.update();
+
+	std::vector<vec3> image = pRenderer->getImage();
+	Bitmap::saveImage(mOutputFile, settings.width, settings.height, Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::None, ResourceFormat::RGB32Float, true, image.data());
+	mStatus = "Wrote " + mOutputFile + " after " + std::to_string(timer.getElapsedTime()) + " s";
+	logInfo("DistributedReferencePass: " + mStatus);
+}
+
+void DistributedReferencePass::renderGui(Gui* pGui)
+{
+	if (mSamplesPerPixel == 0)
+	{
+		pGui->addText(mStatus.c_str());
+		return;
+	}
+	pGui->addText((std::to_string(mSamplesPerPixel) + " samples per pixel on " + std::to_string(mWorkerCount) + " workers").c_str());
+	pGui->addText(mStatus.c_str());
+}
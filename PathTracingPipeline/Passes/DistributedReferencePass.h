@@ -0,0 +1,67 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+// This render pass doesn't draw anything.  Once a scene is loaded, it hands the scene to the CPU path tracer
+//     (PathTracerReference), spreads a reference render of it over worker processes (DistributedReference), and
+//     writes the converged image to an EXR file, to compare GlobalIlluminationPass's accumulated output against.
+
+#pragma once
+#include "../SharedUtils/RenderPass.h"
+
+class DistributedReferencePass : public ::RenderPass, inherit_shared_from_this<::RenderPass, DistributedReferencePass>
+{
+public:
+    using SharedPtr = std::shared_ptr<DistributedReferencePass>;
+    using SharedConstPtr = std::shared_ptr<const DistributedReferencePass>;
+
+	/** Render a reference of every loaded scene
+	    \param[in] workerCount Worker processes (threads on Windows) to render with (0 renders in the application's thread)
+	    \param[in] samplesPerPixel Samples per pixel of the finished image, 0 to only export the scene
+	    \param[in] outputFile EXR file to write the image to
+	    \param[in] sceneFile If not empty, the exported scene is also written there, for DistributedReferenceCoordinator to render on machines without a GPU
+	*/
+    static SharedPtr create(uint32_t workerCount, uint32_t samplesPerPixel, const std::string &outputFile, const std::string &sceneFile = "")
+	{
+		return SharedPtr(new DistributedReferencePass(workerCount, samplesPerPixel, outputFile, sceneFile));
+	}
+    virtual ~DistributedReferencePass() = default;
+
+protected:
+	DistributedReferencePass(uint32_t workerCount, uint32_t samplesPerPixel, const std::string &outputFile, const std::string &sceneFile) : mWorkerCount(workerCount),
+		mSamplesPerPixel(samplesPerPixel), mOutputFile(outputFile), mSceneFile(sceneFile), ::RenderPass("Distributed Reference", "Distributed Reference Options") {}
+
+    // Implementation of RenderPass interface
+    bool initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager) override;
+    void initScene(RenderContext* pRenderContext, Scene::SharedPtr pScene) override;
+    void execute(RenderContext* pRenderContext) override;
+	void renderGui(Gui* pGui) override;
+
+	// Override some functions that provide information to the RenderPipeline class
+	bool requiresScene() override { return true; }
+
+	// Copy the scene's geometry, materials, point lights and camera into the CPU path tracer's scene description
+	PathTracerReference::Scene exportScene();
+
+    Scene::SharedPtr        mpScene;                      ///< Our scene file (passed in from app)
+	uint32_t                mWorkerCount;
+	uint32_t                mSamplesPerPixel;
+	std::string             mOutputFile;
+	std::string             mSceneFile;
+	bool                    mRendered = true;             ///< Has the current scene been rendered yet?  (Nothing to render until a scene loads)
+	std::string             mStatus = "Waiting for a scene";
+};
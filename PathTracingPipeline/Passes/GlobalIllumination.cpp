@@ -33,6 +33,11 @@ namespace {
 	const char* kEntryPointMiss1         = "IndirectMiss";
 	const char* kEntryIndirectAnyHit     = "IndirectAnyHit";
 	const char* kEntryIndirectClosestHit = "IndirectClosestHit";
+
+	// The wavefront mode's stages
+	const char* kFileWavefront           = "wavefront.cs.hlsl";
+	const char* kFileWavefrontExtend     = "wavefrontExtend.rt.hlsl";
+	const char* kFileWavefrontShadow     = "wavefrontShadow.rt.hlsl";
 };
 
 bool GlobalIlluminationPass::initialize(RenderContext* pRenderContext, ResourceManager::SharedPtr pResManager)
@@ -43,6 +48,10 @@ bool GlobalIlluminationPass::initialize(RenderContext* pRenderContext, ResourceM
 	mpResManager->requestTextureResource(mOutputTextureName);
 	mpResManager->requestTextureResource(ResourceManager::kEnvironmentMap);
 
+	// Tell the pipeline which channels we read and write, so it can order (or cull) us appropriately
+	declareInputs({ "WorldPosition", "WorldNormal", "MaterialDiffuse", "MaterialSpecRough", "Emissive", ResourceManager::kEnvironmentMap });
+	declareOutputs({ mOutputTextureName }, Resource::State::UnorderedAccess);
+
 	// Set the default scene to load
 	mpResManager->setDefaultSceneName("Data/picapica/picapica.fscene");
 
@@ -61,6 +70,28 @@ bool GlobalIlluminationPass::initialize(RenderContext* pRenderContext, ResourceM
 	mpRays->compileRayProgram();
 	mpRays->setMaxRecursionDepth(uint32_t(mMaxPossibleRayDepth));
 	if (mpScene) mpRays->setScene(mpScene);
+
+	// The wavefront mode shades in compute shaders, and only traces one ray deep
+	mpWavefrontGenerate = ComputeLaunch::create(kFileWavefront, "WavefrontGenerate");
+	mpWavefrontPrepareShade = ComputeLaunch::create(kFileWavefront, "WavefrontPrepareShade");
+	mpWavefrontShade = ComputeLaunch::create(kFileWavefront, "WavefrontShade");
+	mpWavefrontResolve = ComputeLaunch::create(kFileWavefront, "WavefrontResolve");
+
+	mpExtensionRays = RayLaunch::create(kFileWavefrontExtend, "ExtensionRayGen");
+	mpExtensionRays->addMissShader(kFileWavefrontExtend, "ExtensionMiss");
+	mpExtensionRays->addHitShader(kFileWavefrontExtend, "ExtensionClosestHit", "ExtensionAnyHit");
+	mpExtensionRays->compileRayProgram();
+	if (mpScene) mpExtensionRays->setScene(mpScene);
+
+	mpShadowRays = RayLaunch::create(kFileWavefrontShadow, "ShadowRayGen");
+	mpShadowRays->addMissShader(kFileWavefrontShadow, kEntryPointMiss0);
+	mpShadowRays->addHitShader(kFileWavefrontShadow, kEntryShadowClosestHit, kEntryShadowAnyHit);
+	mpShadowRays->compileRayProgram();
+	if (mpScene) mpShadowRays->setScene(mpScene);
+
+	mpCounters = TypedBuffer<uint32_t>::create(2 * (kWavefrontMaxBounces + 1));
+	mpCountersReadback = GpuReadback::create(2 * (kWavefrontMaxBounces + 1) * sizeof(uint32_t));
+	mpDispatchArgs = Buffer::create((kWavefrontMaxBounces + 1) * 3 * sizeof(uint32_t), Resource::BindFlags::IndirectArg | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
     return true;
 }
 
@@ -69,6 +100,8 @@ void GlobalIlluminationPass::initScene(RenderContext* pRenderContext, Scene::Sha
 	// Stash a copy of the scene and pass it to our ray tracer (if initialized)
     mpScene = std::dynamic_pointer_cast<RtScene>(pScene);
 	if (mpRays) mpRays->setScene(mpScene);
+	if (mpExtensionRays) mpExtensionRays->setScene(mpScene);
+	if (mpShadowRays) mpShadowRays->setScene(mpScene);
 }
 
 void GlobalIlluminationPass::renderGui(Gui* pGui)
@@ -80,6 +113,26 @@ void GlobalIlluminationPass::renderGui(Gui* pGui)
 	dirty |= (int)pGui->addCheckBox(mDoIndirectGI ? "Shooting global illumination rays" : "Skipping global illumination", 
 		                            mDoIndirectGI);
 	dirty |= (int)pGui->addCheckBox("Is Open Scene", mIsOpenScene);
+	dirty |= (int)pGui->addCheckBox(mEnvLighting ? "Importance sampling environment map" : "No environment lighting", mEnvLighting);
+
+	dirty |= (int)pGui->addCheckBox(mUseWavefront ? "Wavefront path tracing" : "Megakernel path tracing", mUseWavefront);
+	if (mUseWavefront)
+	{
+		dirty |= (int)pGui->addCheckBox("Russian roulette", mRussianRoulette);
+		if (mRussianRoulette)
+		{
+			dirty |= (int)pGui->addIntVar("Roulette from bounce", mRouletteStartDepth, 1, mMaxPossibleRayDepth);
+			dirty |= (int)pGui->addFloatVar("Min. continue probability", mRouletteMinProbability, 0.01f, 1.0f, 0.01f);
+		}
+		if (mEnvLighting) pGui->addText("Environment map seen by paths only (no MIS)");
+
+		// What the queues looked like a few frames ago
+		for (int32_t bounce = 0; bounce <= mUserSpecifiedRayDepth; bounce++)
+		{
+			pGui->addText(("Bounce " + std::to_string(bounce) + ": " + std::to_string(mActivePaths[bounce]) + " paths, " +
+			               std::to_string(mShadowRays[bounce]) + " shadow rays").c_str());
+		}
+	}
 
 	if (dirty) setRefreshFlag();
 }
@@ -93,6 +146,12 @@ void GlobalIlluminationPass::execute(RenderContext* pRenderContext)
 	// Do we have all the resources we need to render?  If not, return
 	if (!pDstTex || !mpRays || !mpRays->readyToRender()) return;
 
+	if (mUseWavefront)
+	{
+		executeWavefront(pRenderContext, pDstTex);
+		return;
+	}
+
 	// Set our variables into the global HLSL namespace
 	auto globalVars = mpRays->getGlobalVars();
 	globalVars["GlobalCB"]["gMinT"]         = mpResManager->getMinTDist();
@@ -102,6 +161,7 @@ void GlobalIlluminationPass::execute(RenderContext* pRenderContext)
 	globalVars["GlobalCB"]["gMaxDepth"]     = mUserSpecifiedRayDepth;
     globalVars["GlobalCB"]["gEmitMult"]     = 1.0f;
 	globalVars["GlobalCB"]["gOpenScene"]	= mIsOpenScene;
+	globalVars["GlobalCB"]["gEnvLighting"]  = mEnvLighting;
 	globalVars["gPos"]         = mpResManager->getTexture("WorldPosition");
 	globalVars["gNorm"]        = mpResManager->getTexture("WorldNormal");
 	globalVars["gDiffuseMatl"] = mpResManager->getTexture("MaterialDiffuse");
@@ -109,9 +169,157 @@ void GlobalIlluminationPass::execute(RenderContext* pRenderContext)
     globalVars["gEmissive"]    = mpResManager->getTexture("Emissive");
 	globalVars["gOutput"]      = pDstTex;
 
+	// The environment map, and the alias tables to pick directions towards its bright regions
+	globalVars["gEnvMap"] = mpResManager->getTexture(ResourceManager::kEnvironmentMap);
+	EnvMapSampler::SharedPtr pEnvSampler = mpResManager->getEnvironmentMapSampler();
+	if (pEnvSampler)
+	{
+		Buffer::SharedPtr pEnvMarginal = pEnvSampler->getMarginalBuffer();
+		Buffer::SharedPtr pEnvConditional = pEnvSampler->getConditionalBuffer();
+		globalVars["gEnvMarginal"]    = pEnvMarginal;
+		globalVars["gEnvConditional"] = pEnvConditional;
+	}
+
 	// Shoot our rays and shade our primary hit points
 	mpRays->execute( pRenderContext, mpResManager->getScreenSize() );
 
 }
 
+void GlobalIlluminationPass::resizeWavefrontBuffers(const uvec2& frameSize)
+{
+	uint32_t pathCount = frameSize.x * frameSize.y;
+	mpPathOrigin = TypedBuffer<vec4>::create(pathCount);
+	mpPathDir = TypedBuffer<vec4>::create(pathCount);
+	mpPathThroughput = TypedBuffer<vec4>::create(pathCount);
+	mpPathRadiance = TypedBuffer<vec4>::create(pathCount);
+	mpPathSeed = TypedBuffer<uint32_t>::create(pathCount);
+	mpHitPosW = TypedBuffer<vec4>::create(pathCount);
+	mpHitNormal = TypedBuffer<vec4>::create(pathCount);
+	mpHitDiffuse = TypedBuffer<vec4>::create(pathCount);
+	mpHitSpecular = TypedBuffer<vec4>::create(pathCount);
+	mpHitEmissive = TypedBuffer<vec4>::create(pathCount);
+	mpShadowRay = TypedBuffer<vec4>::create(pathCount);
+	mpShadowContribution = TypedBuffer<vec4>::create(pathCount);
+	mpPathQueues[0] = TypedBuffer<uint32_t>::create(pathCount);
+	mpPathQueues[1] = TypedBuffer<uint32_t>::create(pathCount);
+	mpShadowQueue = TypedBuffer<uint32_t>::create(pathCount);
+	mWavefrontSize = frameSize;
+}
+
+void GlobalIlluminationPass::setWavefrontVars(SimpleVars::SharedPtr pVars, uint32_t bounce)
+{
+	// Each stage only uses some of these.  The set*() calls skip the others (the [] syntax would assert).
+	pVars->setVariable("WavefrontCB", "gBounce", bounce);
+	pVars->setVariable("WavefrontCB", "gFrameWidth", mWavefrontSize.x);
+	pVars->setVariable("WavefrontCB", "gMinT", mpResManager->getMinTDist());
+	pVars->setTypedBuffer("gPathOrigin", mpPathOrigin);
+	pVars->setTypedBuffer("gPathDir", mpPathDir);
+	pVars->setTypedBuffer("gPathThroughput", mpPathThroughput);
+	pVars->setTypedBuffer("gPathRadiance", mpPathRadiance);
+	pVars->setTypedBuffer("gPathSeed", mpPathSeed);
+	pVars->setTypedBuffer("gHitPosW", mpHitPosW);
+	pVars->setTypedBuffer("gHitNormal", mpHitNormal);
+	pVars->setTypedBuffer("gHitDiffuse", mpHitDiffuse);
+	pVars->setTypedBuffer("gHitSpecular", mpHitSpecular);
+	pVars->setTypedBuffer("gHitEmissive", mpHitEmissive);
+	pVars->setTypedBuffer("gShadowRay", mpShadowRay);
+	pVars->setTypedBuffer("gShadowContribution", mpShadowContribution);
 
+	// The queues swap roles every bounce
+	pVars->setTypedBuffer("gPathQueue", mpPathQueues[bounce % 2]);
+	pVars->setTypedBuffer("gNextPathQueue", mpPathQueues[(bounce + 1) % 2]);
+	pVars->setTypedBuffer("gShadowQueue", mpShadowQueue);
+	pVars->setTypedBuffer("gCounters", mpCounters);
+}
+
+void GlobalIlluminationPass::executeWavefront(RenderContext* pRenderContext, Texture::SharedPtr pDstTex)
+{
+	if (!mpScene || !mpExtensionRays->readyToRender() || !mpShadowRays->readyToRender()) return;
+
+	uvec2 frameSize = mpResManager->getScreenSize();
+	if (frameSize != mWavefrontSize) resizeWavefrontBuffers(frameSize);
+	pRenderContext->clearUAV(mpCounters->getUAV().get(), uvec4(0));
+
+	// Everything the shading stages need that doesn't change between bounces
+	uint32_t maxDepth = mDoIndirectGI ? uint32_t(mUserSpecifiedRayDepth) : 0u;
+	mpWavefrontShade->setLights(mpScene->getLights());
+	for (auto pShader : { mpWavefrontGenerate, mpWavefrontShade })
+	{
+		auto shadeVars = pShader->getVars();
+		shadeVars->setVariable("ShadeCB", "gCameraPos", mpScene->getActiveCamera()->getPosition());
+		shadeVars->setVariable("ShadeCB", "gFrameCount", mFrameCount);
+		shadeVars->setVariable("ShadeCB", "gDoIndirectGI", mDoIndirectGI);
+		shadeVars->setVariable("ShadeCB", "gDoDirectGI", mDoDirectGI);
+		shadeVars->setVariable("ShadeCB", "gMaxDepth", maxDepth);
+		shadeVars->setVariable("ShadeCB", "gEmitMult", 1.0f);
+		shadeVars->setVariable("ShadeCB", "gOpenScene", mIsOpenScene);
+		shadeVars->setVariable("ShadeCB", "gEnvLighting", mEnvLighting);
+		shadeVars->setVariable("ShadeCB", "gRussianRoulette", mRussianRoulette);
+		shadeVars->setVariable("ShadeCB", "gRouletteStartDepth", uint32_t(mRouletteStartDepth));
+		shadeVars->setVariable("ShadeCB", "gRouletteMinProbability", mRouletteMinProbability);
+		shadeVars->setTexture("gEnvMap", mpResManager->getTexture(ResourceManager::kEnvironmentMap));
+		shadeVars->setTexture("gOutput", pDstTex);
+	}
+	mFrameCount++;
+
+	// Start a path at each pixel with geometry
+	auto generateVars = mpWavefrontGenerate->getVars();
+	setWavefrontVars(generateVars, 0);
+	generateVars["gPos"]         = mpResManager->getTexture("WorldPosition");
+	generateVars["gNorm"]        = mpResManager->getTexture("WorldNormal");
+	generateVars["gDiffuseMatl"] = mpResManager->getTexture("MaterialDiffuse");
+	generateVars["gSpecMatl"]    = mpResManager->getTexture("MaterialSpecRough");
+	generateVars["gEmissive"]    = mpResManager->getTexture("Emissive");
+	mpWavefrontGenerate->execute(pRenderContext, uvec3(frameSize, 1));
+
+	// Each stage reads what the one before wrote
+	std::vector<Resource*> pathState = { mpPathOrigin.get(), mpPathDir.get(), mpPathThroughput.get(), mpPathRadiance.get(),
+		mpPathSeed.get(), mpHitPosW.get(), mpHitNormal.get(), mpHitDiffuse.get(), mpHitSpecular.get(), mpHitEmissive.get(),
+		mpShadowRay.get(), mpShadowContribution.get(), mpPathQueues[0].get(), mpPathQueues[1].get(), mpShadowQueue.get(), mpCounters.get() };
+	auto barrier = [&]() { for (Resource* pResource : pathState) pRenderContext->uavBarrier(pResource); };
+
+	for (uint32_t bounce = 0; bounce <= maxDepth; bounce++)
+	{
+		barrier();
+		auto prepareVars = mpWavefrontPrepareShade->getVars();
+		setWavefrontVars(prepareVars, bounce);
+		prepareVars["gDispatchArgs"] = mpDispatchArgs;
+		mpWavefrontPrepareShade->execute(pRenderContext, uvec3(1));
+		pRenderContext->uavBarrier(mpDispatchArgs.get());
+
+		setWavefrontVars(mpWavefrontShade->getVars(), bounce);
+		mpWavefrontShade->executeIndirect(pRenderContext, mpDispatchArgs.get(), bounce * 3 * sizeof(uint32_t));
+		barrier();
+
+		// Ray tracing launches can't be sized on the GPU, so these cover the frame and skip past the end of their queue
+		if (mDoDirectGI)
+		{
+			setWavefrontVars(mpShadowRays->getRayGenVars(), bounce);
+			mpShadowRays->execute(pRenderContext, frameSize);
+		}
+		if (bounce < maxDepth)
+		{
+			barrier();
+			setWavefrontVars(mpExtensionRays->getRayGenVars(), bounce);
+			mpExtensionRays->execute(pRenderContext, frameSize);
+		}
+	}
+
+	barrier();
+	auto resolveVars = mpWavefrontResolve->getVars();
+	setWavefrontVars(resolveVars, 0);
+	resolveVars["gOutput"] = pDstTex;
+	mpWavefrontResolve->execute(pRenderContext, uvec3(frameSize, 1));
+
+	// Grab the per-bounce counts for the GUI (these arrive a few frames late)
+	mpCountersReadback->copy(pRenderContext, mpCounters);
+	uint32_t counts[2 * (kWavefrontMaxBounces + 1)];
+	if (mpCountersReadback->read(counts))
+	{
+		for (uint32_t bounce = 0; bounce <= kWavefrontMaxBounces; bounce++)
+		{
+			mActivePaths[bounce] = counts[bounce];
+			mShadowRays[bounce] = counts[kWavefrontMaxBounces + 1 + bounce];
+		}
+	}
+}
@@ -23,6 +23,8 @@
 #pragma once
 #include "../SharedUtils/RenderPass.h"
 #include "../SharedUtils/RayLaunch.h"
+#include "../SharedUtils/ComputeLaunch.h"
+#include "../SharedUtils/GpuReadback.h"
 
 class GlobalIlluminationPass : public ::RenderPass, inherit_shared_from_this<::RenderPass, GlobalIlluminationPass>
 {
@@ -46,6 +48,12 @@ protected:
 	// Override some functions that provide information to the RenderPipeline class
 	bool requiresScene() override { return true; }
 	bool usesRayTracing() override { return true; }
+	bool usesEnvironmentMap() override { return true; }
+
+	// The wavefront mode: one dispatch per stage and bounce, over queues of the paths still alive
+	void executeWavefront(RenderContext* pRenderContext, Texture::SharedPtr pDstTex);
+	void resizeWavefrontBuffers(const uvec2& frameSize);
+	void setWavefrontVars(SimpleVars::SharedPtr pVars, uint32_t bounce);
 
     // Rendering state
 	RayLaunch::SharedPtr    mpRays;                       ///< Our wrapper around a DX Raytracing pass
@@ -58,6 +66,32 @@ protected:
 	int32_t                 mUserSpecifiedRayDepth = 1;   ///<  What is the current maximum ray depth
 	const int32_t           mMaxPossibleRayDepth = 8;     ///<  The largest ray depth we support (without recompile)
 	bool                    mIsOpenScene = true;
+	bool                    mEnvLighting = false;         ///<  Light with the environment map (misses otherwise return a constant)
+
+	// Wavefront mode (see wavefrontCommon.hlsli).  Must match WAVEFRONT_MAX_BOUNCES there.
+	static const uint32_t   kWavefrontMaxBounces = 8;
+	bool                    mUseWavefront = false;        ///<  Trace bounce by bounce instead of with the megakernel
+	bool                    mRussianRoulette = true;      ///<  Terminate low-throughput paths (wavefront mode only)
+	int32_t                 mRouletteStartDepth = 2;      ///<  First bounce whose paths can be terminated
+	float                   mRouletteMinProbability = 0.05f;
+
+	ComputeLaunch::SharedPtr mpWavefrontGenerate;         ///<  Starts the paths from the G-buffer
+	ComputeLaunch::SharedPtr mpWavefrontPrepareShade;     ///<  Sizes each bounce's shading dispatch to its queue
+	ComputeLaunch::SharedPtr mpWavefrontShade;            ///<  Shades a bounce, queueing shadow and extension rays
+	ComputeLaunch::SharedPtr mpWavefrontResolve;          ///<  Writes the paths' radiance to the output
+	RayLaunch::SharedPtr    mpExtensionRays;
+	RayLaunch::SharedPtr    mpShadowRays;
+
+	uvec2                   mWavefrontSize = uvec2(0);    ///<  Frame size the path buffers were allocated for
+	TypedBufferBase::SharedPtr mpPathOrigin, mpPathDir, mpPathThroughput, mpPathRadiance, mpPathSeed;
+	TypedBufferBase::SharedPtr mpHitPosW, mpHitNormal, mpHitDiffuse, mpHitSpecular, mpHitEmissive;
+	TypedBufferBase::SharedPtr mpShadowRay, mpShadowContribution;
+	TypedBufferBase::SharedPtr mpPathQueues[2], mpShadowQueue;
+	TypedBufferBase::SharedPtr mpCounters;                ///<  Queue lengths and shadow rays of each bounce
+	Buffer::SharedPtr       mpDispatchArgs;               ///<  Thread group counts of each bounce's shading dispatch
+	GpuReadback::SharedPtr  mpCountersReadback;
+	uint32_t                mActivePaths[kWavefrontMaxBounces + 1] = {};   ///<  Paths shaded at each bounce, a few frames late
+	uint32_t                mShadowRays[kWavefrontMaxBounces + 1] = {};    ///<  Shadow rays traced at each bounce, a few frames late
 
 	// What texture should was ask the resource manager to store our result in?
 	std::string             mOutputTextureName;
@@ -19,6 +19,7 @@
 #include "Falcor.h"
 #include "../SharedUtils/RenderingPipeline.h"
 #include "Passes/GlobalIllumination.h"
+#include "Passes/DistributedReferencePass.h"
 #include "../CommonPasses/SimpleAccumulationPass.h"
 #include "../CommonPasses/SimpleToneMappingPass.h"
 #include "../CommonPasses/SimpleGBufferPass.h"
@@ -34,6 +35,31 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _
 	pipeline->setPass(2, SimpleAccumulationPass::create("HDRColorOutput"));     // Accumulate on "HDRColorOutput"
 	pipeline->setPass(3, SimpleToneMappingPass::create("HDRColorOutput", ResourceManager::kOutputChannel));  // Tonemap "HDRColorOutput" to the output channel
 
+	// Optionally (-distributed-reference <workers> <spp> <out.exr>) render a CPU reference of the loaded scene over worker threads,
+	//     and write it to an EXR file to compare the accumulated output against.  -export-reference-scene <file> writes the scene
+	//     the reference renders, for DistributedReferenceCoordinator to render it over processes on a Linux machine instead.
+	ArgList args;
+	args.parseCommandLine(lpCmdLine);
+	std::vector<ArgList::Arg> referenceArgs = args.getValues("distributed-reference");
+	std::vector<ArgList::Arg> exportArgs = args.getValues("export-reference-scene");
+	std::string sceneFile = exportArgs.size() == 1 ? exportArgs[0].asString() : "";
+	if (referenceArgs.size() == 3)
+	{
+		pipeline->setPass(4, DistributedReferencePass::create(referenceArgs[0].asUint(), referenceArgs[1].asUint(), referenceArgs[2].asString(), sceneFile));
+	}
+	else if (args.argExists("distributed-reference"))
+	{
+		logWarning("Usage: -distributed-reference <workers> <samples per pixel> <output.exr>");
+	}
+	else if (sceneFile.size())
+	{
+		pipeline->setPass(4, DistributedReferencePass::create(0, 0, "", sceneFile));
+	}
+	if (args.argExists("export-reference-scene") && exportArgs.size() != 1)
+	{
+		logWarning("Usage: -export-reference-scene <scene file>");
+	}
+
 	// Define a set of config / window parameters for our program
     SampleConfig config;
 	config.windowDesc.title = "Path Tracing";
@@ -0,0 +1,151 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "AsyncQueue.h"
+
+AsyncQueue::SharedPtr AsyncQueue::create(const RenderContext::SharedPtr& pGraphicsContext)
+{
+	CommandQueueHandle pComputeQueue = gpDevice->getCommandQueueHandle(LowLevelContextData::CommandQueueType::Compute, 0);
+	if (!pGraphicsContext || !pComputeQueue) return nullptr;
+
+	SharedPtr pThis = SharedPtr(new AsyncQueue());
+	pThis->mpContexts[uint32_t(Queue::Graphics)] = pGraphicsContext;
+	pThis->mpContexts[uint32_t(Queue::Async)] = RenderContext::create(pComputeQueue, LowLevelContextData::CommandQueueType::Compute);
+	return pThis->mpContexts[uint32_t(Queue::Async)] ? pThis : nullptr;
+}
+
+AsyncQueue::Scope::Scope(AsyncQueue* pQueue)
+{
+	Device::setThreadRenderContext(pQueue->getContext(Queue::Async));
+}
+
+AsyncQueue::Scope::~Scope()
+{
+	Device::setThreadRenderContext(nullptr);
+}
+
+bool AsyncQueue::isComputeState(Resource::State state)
+{
+	switch (state)
+	{
+	case Resource::State::Undefined:
+	case Resource::State::PreInitialized:
+	case Resource::State::Common:
+	case Resource::State::VertexBuffer:
+	case Resource::State::ConstantBuffer:
+	case Resource::State::UnorderedAccess:
+	case Resource::State::IndirectArg:
+	case Resource::State::CopyDest:
+	case Resource::State::CopySource:
+	case Resource::State::NonPixelShader:
+	case Resource::State::AccelerationStructure:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void AsyncQueue::signal(Queue queue)
+{
+	mpContexts[uint32_t(queue)]->flush(false);
+}
+
+void AsyncQueue::wait(Queue queue)
+{
+	Queue other = (queue == Queue::Async) ? Queue::Graphics : Queue::Async;
+	getFence(other)->syncGpu(mpContexts[uint32_t(queue)]->getLowLevelData()->getCommandQueue());
+	mWaited[uint32_t(queue)] = getFence(other)->getCpuValue() - 1;
+}
+
+void AsyncQueue::waitForOtherQueue(Queue queue, const Resource* pResource)
+{
+	auto use = mLastUse.find(pResource);
+	if (use == mLastUse.end()) return;
+
+	Queue other = (queue == Queue::Async) ? Queue::Graphics : Queue::Async;
+	uint64_t otherUse = use->second[uint32_t(other)];
+	if (otherUse == 0 || otherUse <= mWaited[uint32_t(queue)]) return;
+
+	// The other queue's use may still be sitting in its command list
+	if (getFence(other)->getCpuValue() <= otherUse) signal(other);
+	wait(queue);
+}
+
+void AsyncQueue::markUsed(Queue queue, const Resource* pResource)
+{
+	auto &use = mLastUse[pResource];      // Value-initialized (unused by either queue) on first use
+	use[uint32_t(queue)] = getFence(queue)->getCpuValue();
+}
+
+void AsyncQueue::transition(Queue queue, const std::vector<CopyContext::Transition>& transitions)
+{
+	std::vector<CopyContext::Transition> handOff, barriers;
+	for (const auto &t : transitions)
+	{
+		bool global = t.pResource->isStateGlobal();
+		Resource::State state = global ? t.pResource->getGlobalState() : Resource::State::Undefined;
+		if (queue == Queue::Async && (!global || !isComputeState(state)))
+		{
+			handOff.push_back(t);
+			continue;
+		}
+
+		// What the context will actually transition to (see CopyContext::resourceBarrier())
+		Resource::State newState = t.newState;
+		if (queue == Queue::Async && newState == Resource::State::ShaderResource && state != newState) newState = Resource::State::NonPixelShader;
+
+		if (state != newState) waitForOtherQueue(queue, t.pResource);
+		markUsed(queue, t.pResource);
+		barriers.push_back(t);
+	}
+
+	// Leave the graphics-only states on the graphics queue, and have the async queue pick the resources up from there
+	if (handOff.size())
+	{
+		for (const auto &t : handOff)
+		{
+			waitForOtherQueue(Queue::Graphics, t.pResource);
+			markUsed(Queue::Graphics, t.pResource);
+		}
+		getContext(Queue::Graphics)->resourceBarriers(handOff);
+		signal(Queue::Graphics);
+		wait(Queue::Async);
+		for (const auto &t : handOff) markUsed(Queue::Async, t.pResource);
+	}
+
+	if (barriers.size()) getContext(queue)->resourceBarriers(barriers);
+}
+
+void AsyncQueue::endFrame()
+{
+	// The scheduler already joins the last async pass into the graphics queue; this catches anything recorded after it
+	const auto &pAsyncContext = getContext(Queue::Async);
+	if (pAsyncContext->hasPendingCommands())
+	{
+		signal(Queue::Async);
+		wait(Queue::Graphics);
+	}
+
+	// Forget uses both queues have already waited past
+	for (auto use = mLastUse.begin(); use != mLastUse.end();)
+	{
+		bool done = use->second[uint32_t(Queue::Graphics)] <= mWaited[uint32_t(Queue::Async)] &&
+		            use->second[uint32_t(Queue::Async)] <= mWaited[uint32_t(Queue::Graphics)];
+		use = done ? mLastUse.erase(use) : std::next(use);
+	}
+}
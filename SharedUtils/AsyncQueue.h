@@ -0,0 +1,101 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include "Falcor.h"
+#include "PassScheduler.h"
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+using namespace Falcor;
+
+/** The compute queue RenderingPipeline runs PassScheduler's Queue::Async passes on.
+
+    Owns a RenderContext that submits to the device's first compute queue (RenderingPipeline::run() asks the device
+    for one) and keeps it in step with the graphics context.  signal() submits what a queue recorded so far and
+    signals its context's fence; wait() makes a queue wait on the other queue's last signal.  RenderingPipeline calls
+    them where PassScheduler put its fences.
+
+    The pass graph only orders passes that hazard on a channel's contents.  transition() covers the two other ways the
+    queues can trip over each other:
+       1) State changes.  Before changing the state of a channel the other queue used, the queue waits for it, even
+          if both only read the channel (e.g., as a pixel shader resource on one queue, and from a ray generation
+          shader on the other).
+       2) Graphics-only states.  A compute queue can't transition a resource out of the render target, depth or
+          pixel shader states, so those transitions get recorded on the graphics queue, which then signals the
+          async queue.
+*/
+class AsyncQueue : public std::enable_shared_from_this<AsyncQueue>
+{
+public:
+	using SharedPtr = std::shared_ptr<AsyncQueue>;
+	using SharedConstPtr = std::shared_ptr<const AsyncQueue>;
+	using Queue = PassScheduler::Queue;
+
+	/** Create a context on the device's compute queue.
+	    \param[in] pGraphicsContext The context the rest of the frame is recorded into.
+	    \return nullptr if the device was created without a compute queue.
+	*/
+	static SharedPtr create(const RenderContext::SharedPtr& pGraphicsContext);
+	virtual ~AsyncQueue() = default;
+
+	const RenderContext::SharedPtr& getContext(Queue queue) const { return mpContexts[uint32_t(queue)]; }
+
+	/** While alive, anything the framework records on its own on this thread (uploads, clears, acceleration structure
+	    builds, GPU timers) goes into the async queue's context too.  Wrap the recording of each async pass in one.
+	*/
+	class Scope
+	{
+	public:
+		Scope(AsyncQueue* pQueue);
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	// Submit everything <queue> recorded so far, then signal its fence
+	void signal(Queue queue);
+
+	// Make <queue> wait until the other queue reaches its last signal
+	void wait(Queue queue);
+
+	// Record a pass' transitions for it to run on <queue> (see above)
+	void transition(Queue queue, const std::vector<CopyContext::Transition>& transitions);
+
+	// Submit whatever is left on the async queue and join it into the graphics queue, so the frame ends with both idle
+	void endFrame();
+
+	// Can a compute queue transition a resource out of this state?
+	static bool isComputeState(Resource::State state);
+
+protected:
+	AsyncQueue() = default;
+
+	// Make <queue> wait for the other queue if it used <pResource> since <queue> last waited on it
+	void waitForOtherQueue(Queue queue, const Resource* pResource);
+
+	// Remember that <queue> used <pResource> in the work its next signal covers
+	void markUsed(Queue queue, const Resource* pResource);
+
+	const GpuFence::SharedPtr& getFence(Queue queue) const { return mpContexts[uint32_t(queue)]->getLowLevelData()->getFence(); }
+
+	RenderContext::SharedPtr                                     mpContexts[uint32_t(Queue::Count)];
+	uint64_t                                                     mWaited[uint32_t(Queue::Count)] = { 0, 0 };  ///< Per queue, the other queue's last fence value it waited on
+	std::unordered_map<const Resource*, std::array<uint64_t, 2>> mLastUse;                                    ///< Per queue, the fence value covering its last use (0 == unused)
+};
@@ -0,0 +1,125 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "ComputeLaunch.h"
+
+using namespace Falcor;
+
+ComputeLaunch::SharedPtr ComputeLaunch::create(const char *computeShader, const char *entryPoint)
+{
+	return SharedPtr(new ComputeLaunch(computeShader, entryPoint));
+}
+
+ComputeLaunch::ComputeLaunch(const char *computeShader, const char *entryPoint)
+{
+	mpProgram = ComputeProgram::createFromFile(computeShader, entryPoint);
+	mpState = ComputeState::create();
+	mpState->setProgram(mpProgram);
+	mInvalidVarReflector = true;
+}
+
+void ComputeLaunch::execute(RenderContext* pRenderContext, const glm::uvec3 &threadCount)
+{
+	glm::uvec3 groupSize = glm::max(getThreadGroupSize(), glm::uvec3(1));
+	executeGroups(pRenderContext, (threadCount + groupSize - glm::uvec3(1)) / groupSize);
+}
+
+void ComputeLaunch::executeGroups(RenderContext* pRenderContext, const glm::uvec3 &groupCount)
+{
+	// Ok.  We're executing.  If we still have an invalid shader variable reflector, we'd better get one now!
+	if (mInvalidVarReflector) createComputeVariables();
+
+	if (mpProgram && mpVars && pRenderContext && groupCount.x > 0 && groupCount.y > 0 && groupCount.z > 0)
+	{
+		pRenderContext->pushComputeState(mpState);
+		pRenderContext->pushComputeVars(mpVars);
+			pRenderContext->dispatch(groupCount.x, groupCount.y, groupCount.z);
+		pRenderContext->popComputeVars();
+		pRenderContext->popComputeState();
+	}
+}
+
+void ComputeLaunch::executeIndirect(RenderContext* pRenderContext, const Buffer* pArgs, uint64_t argOffset)
+{
+	if (mInvalidVarReflector) createComputeVariables();
+
+	if (mpProgram && mpVars && pRenderContext && pArgs)
+	{
+		pRenderContext->pushComputeState(mpState);
+		pRenderContext->pushComputeVars(mpVars);
+			pRenderContext->dispatchIndirect(pArgs, argOffset);
+		pRenderContext->popComputeVars();
+		pRenderContext->popComputeState();
+	}
+}
+
+void ComputeLaunch::createComputeVariables()
+{
+	// Do we need to recreate our variables?  Do we also have a valid shader?
+	if (mInvalidVarReflector && mpProgram && mpProgram->getActiveVersion())
+	{
+		mpVars       = ComputeVars::create(mpProgram->getActiveVersion()->getReflector());
+		mpSimpleVars = SimpleVars::create(mpVars.get());
+		mInvalidVarReflector = false;
+	}
+}
+
+SimpleVars::SharedPtr ComputeLaunch::getVars()
+{
+	if (mInvalidVarReflector)
+		createComputeVariables();
+
+	return mpSimpleVars;
+}
+
+glm::uvec3 ComputeLaunch::getThreadGroupSize()
+{
+	if (!mpProgram || !mpProgram->getActiveVersion()) return glm::uvec3(1);
+	return mpProgram->getActiveVersion()->getReflector()->getThreadGroupSize();
+}
+
+void ComputeLaunch::addDefine(const std::string& name, const std::string& value)
+{
+	mpProgram->addDefine(name, value);
+	mInvalidVarReflector = true;
+}
+
+void ComputeLaunch::removeDefine(const std::string& name)
+{
+	mpProgram->removeDefine(name);
+	mInvalidVarReflector = true;
+}
+
+void ComputeLaunch::setLights(const std::vector< Falcor::Light::SharedPtr > &pLights)
+{
+	if (mInvalidVarReflector) createComputeVariables();
+	if (!mpVars) return;
+
+	// Same internal Falcor names FullscreenLaunch::setLights() uses
+	ConstantBuffer::SharedPtr perFrameCB = mpVars["InternalPerFrameCB"];
+	if (perFrameCB)
+	{
+		perFrameCB["gLightsCount"] = uint32_t(pLights.size());
+		const auto& pLightOffset = perFrameCB->getBufferReflector()->findMember("gLights");
+		size_t lightOffset = pLightOffset ? pLightOffset->getOffset() : ConstantBuffer::kInvalidOffset;
+		for (uint32_t i = 0; i < uint32_t(pLights.size()); i++)
+		{
+			pLights[i]->setIntoProgramVars(mpVars.get(), perFrameCB.get(), i * Light::getShaderStructSize() + lightOffset);
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+
+#include "Falcor.h"
+#include "SimpleVars.h"
+
+/** This is a very light wrapper around a Falcor compute program, state and vars that removes some of the
+boilerplate of setting up a compute pass and uses the SimpleVars wrapper to access variables, constant
+buffers, textures, etc using a simple array [] notation and overloaded operator=()
+
+Initialization:
+   ComputeLaunch::SharedPtr mpMyPass = ComputeLaunch::create("myComputeShader.cs.hlsl");
+
+Pass setup / setting HLSL variable values:
+    auto passHLSLVars = mpMyPass->getVars();
+	passHLSLVars["myShaderCB"]["myVar"] = uint4( 1, 2, 4, 16 );
+	passHLSLVars["myShaderBuffer"] = myBufferResource;
+
+Pass execution (the number of thread groups is derived from the shader's [numthreads()]):
+	mpMyPass->execute( pRenderContext, uvec3(width, height, 1) );
+
+*/
+class ComputeLaunch : public std::enable_shared_from_this<ComputeLaunch>
+{
+public:
+	using SharedPtr = std::shared_ptr<ComputeLaunch>;
+	using SharedConstPtr = std::shared_ptr<const ComputeLaunch>;
+	virtual ~ComputeLaunch() = default;
+
+	// Create our compute shader wrapper with a single HLSL compute shader
+	static SharedPtr create(const char *computeShader, const char *entryPoint = "main");
+
+	// Execute the compute shader with (at least) the specified number of threads, rounded up to whole thread groups
+	void execute(Falcor::RenderContext* pRenderContext, const glm::uvec3 &threadCount);
+
+	// Execute the compute shader with exactly the specified number of thread groups
+	void executeGroups(Falcor::RenderContext* pRenderContext, const glm::uvec3 &groupCount);
+
+	// Execute the compute shader with the thread group counts a GPU pass wrote into pArgs (three uints at argOffset)
+	void executeIndirect(Falcor::RenderContext* pRenderContext, const Falcor::Buffer* pArgs, uint64_t argOffset = 0);
+
+	// Want to send variables to your HLSL code?  You do that via the SimpleVars wrapper
+	SimpleVars::SharedPtr getVars();
+
+	// Get the [numthreads()] declared by the shader
+	glm::uvec3 getThreadGroupSize();
+
+	// Compute passes have no scene, so Falcor doesn't fill in 'gLights[]' for us.  Call this to use them in HLSL.
+	void setLights(const std::vector< Falcor::Light::SharedPtr > &pLights);
+
+	// Falcor allows programmatically adding #defines to your HLSL shader.  If you use this class, you
+	//     should set them using the following methods (rather than default Falcor methods) to ensure
+	//     the syntactic sugar for setting variables remains valid.
+	// Note: When adding/removing defines, assume all previous HLSL variables you bound are invalidated
+	void addDefine(const std::string& name, const std::string& value);
+	void removeDefine(const std::string& name);
+
+protected:
+	ComputeLaunch(const char *computeShader, const char *entryPoint);
+
+	// Called to recreate our variable reflectors when creating a program (or the old ones are invalidated)
+	void createComputeVariables();
+
+	bool                               mInvalidVarReflector = true;
+	Falcor::ComputeProgram::SharedPtr  mpProgram;
+	Falcor::ComputeState::SharedPtr    mpState;
+	Falcor::ComputeVars::SharedPtr     mpVars;
+	SimpleVars::SharedPtr              mpSimpleVars;
+};
@@ -0,0 +1,110 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "CpuRecordingStats.h"
+#include <algorithm>
+
+void CpuRecordingStats::beginFrame()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mThreadIds.empty()) mThreadIds.push_back(std::this_thread::get_id());
+	mFrameStart = CpuTimer::getCurrentTimePoint();
+	mFrame++;
+	mFrameOrder = 0;
+}
+
+void CpuRecordingStats::endFrame()
+{
+	double frameMs = CpuTimer::calcDuration(mFrameStart, CpuTimer::getCurrentTimePoint());
+	mFrameAvgMs = (mFrameAvgMs == 0.0) ? frameMs : (1.0 - mSmoothing) * mFrameAvgMs + mSmoothing * frameMs;
+
+	// Passes that were culled (or removed) this frame shouldn't keep a row, or count towards the thread totals
+	std::lock_guard<std::mutex> lock(mMutex);
+	mPasses.erase(std::remove_if(mPasses.begin(), mPasses.end(), [this](const PassStats &pass) { return pass.lastFrame != mFrame; }), mPasses.end());
+	std::stable_sort(mPasses.begin(), mPasses.end(), [](const PassStats &a, const PassStats &b) { return a.order < b.order; });
+}
+
+void CpuRecordingStats::recordPass(uint32_t passIdx, const std::string &name, double ms)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto it = std::find_if(mPasses.begin(), mPasses.end(), [&](const PassStats &p) { return p.passIdx == passIdx && p.name == name; });
+	if (it == mPasses.end())
+	{
+		// First time we see this pass (or a different pass now lives at this index); start a fresh average
+		mPasses.emplace_back();
+		it = mPasses.end() - 1;
+		it->name = name;
+		it->passIdx = passIdx;
+		it->avgMs = ms;
+	}
+	else
+	{
+		it->avgMs = (1.0 - mSmoothing) * it->avgMs + mSmoothing * ms;
+	}
+
+	PassStats &pass = *it;
+	pass.lastMs = ms;
+	pass.lastFrame = mFrame;
+	pass.order = mFrameOrder++;
+	pass.threadIdx = getThreadIndex(std::this_thread::get_id());
+}
+
+void CpuRecordingStats::reset()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mPasses.clear();
+}
+
+uint32_t CpuRecordingStats::getThreadIndex(std::thread::id id)
+{
+	auto it = std::find(mThreadIds.begin(), mThreadIds.end(), id);
+	if (it != mThreadIds.end()) return uint32_t(it - mThreadIds.begin());
+	mThreadIds.push_back(id);
+	return uint32_t(mThreadIds.size() - 1);
+}
+
+std::vector<double> CpuRecordingStats::getThreadTimes() const
+{
+	std::vector<double> times(std::max(size_t(1), mThreadIds.size()), 0.0);
+	for (const auto &pass : mPasses)
+	{
+		if (pass.threadIdx < times.size()) times[pass.threadIdx] += pass.avgMs;
+	}
+	return times;
+}
+
+double CpuRecordingStats::predictParallelRecording(uint32_t threadCount, double submitCostMs) const
+{
+	threadCount = std::max(threadCount, 1u);
+
+	// Longest-processing-time-first greedy assignment: give the most expensive remaining pass to the least loaded thread
+	std::vector<double> costs;
+	for (const auto &pass : mPasses) costs.push_back(pass.avgMs);
+	std::sort(costs.begin(), costs.end(), std::greater<double>());
+
+	std::vector<double> load(threadCount, 0.0);
+	for (double cost : costs)
+	{
+		auto minLoad = std::min_element(load.begin(), load.end());
+		*minLoad += cost;
+	}
+
+	// The main thread still submits every command list once the workers are done
+	double criticalPath = *std::max_element(load.begin(), load.end());
+	return criticalPath + submitCostMs * double(costs.size());
+}
@@ -0,0 +1,117 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include "Falcor.h"
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace Falcor;
+
+/** Tracks how long each pass spends recording commands on the CPU, and on which thread.
+
+    RenderingPipeline wraps each pass' execute() in a ScopedTimer.  Timings are kept as an exponential moving
+    average per pass, along with the thread that recorded it, so the GUI can show where the CPU side of a frame goes.
+    Only passes that recorded during the last frame are listed (culled passes drop out), in the order they ran.
+
+    RenderingPipeline records some passes on ParallelRecorder's worker threads; their rows carry the worker's thread index,
+    and getThreadTimes() shows how the recording time splits over the threads.  predictParallelRecording() estimates the
+    critical path if every pass could be spread over the threads (recording order does not need to respect pass
+    dependencies--only submission does--so this is a simple greedy load balance), for comparison.
+
+    Recording into the stats is thread safe.
+*/
+class CpuRecordingStats : public std::enable_shared_from_this<CpuRecordingStats>
+{
+public:
+	using SharedPtr = std::shared_ptr<CpuRecordingStats>;
+	using SharedConstPtr = std::shared_ptr<const CpuRecordingStats>;
+
+	struct PassStats
+	{
+		std::string name;
+		uint32_t    passIdx = 0;            ///< Index of the pass in the pipeline
+		uint32_t    threadIdx = 0;          ///< 0 == the thread that called beginFrame() (i.e., the main thread)
+		double      lastMs = 0.0;
+		double      avgMs = 0.0;
+		uint64_t    lastFrame = 0;          ///< Frame the pass last recorded in
+		uint32_t    order = 0;              ///< Position in that frame's recording order
+	};
+
+	/** Times a scope and reports it to the stats object when destroyed.
+	*/
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(CpuRecordingStats* pStats, uint32_t passIdx, const std::string &name)
+			: mpStats(pStats), mPassIdx(passIdx), mName(name), mStart(CpuTimer::getCurrentTimePoint()) {}
+		~ScopedTimer()
+		{
+			if (mpStats) mpStats->recordPass(mPassIdx, mName, CpuTimer::calcDuration(mStart, CpuTimer::getCurrentTimePoint()));
+		}
+	private:
+		CpuRecordingStats*   mpStats;
+		uint32_t             mPassIdx;
+		std::string          mName;
+		CpuTimer::TimePoint  mStart;
+	};
+
+	static SharedPtr create(double smoothing = 0.05) { return SharedPtr(new CpuRecordingStats(smoothing)); }
+	virtual ~CpuRecordingStats() = default;
+
+	// Call on the main thread at the start and end of each frame.  endFrame() drops passes that did not record.
+	void beginFrame();
+	void endFrame();
+
+	// Report that pass <passIdx> spent <ms> milliseconds recording on the calling thread
+	void recordPass(uint32_t passIdx, const std::string &name, double ms);
+
+	// Forget all passes (e.g., when the pipeline changes and pass indices shift)
+	void reset();
+
+	const std::vector<PassStats>& getPassStats() const { return mPasses; }
+	uint32_t getThreadCount() const { return uint32_t(mThreadIds.size()); }
+
+	// Average recording time per frame for each thread (index 0 is the main thread)
+	std::vector<double> getThreadTimes() const;
+
+	// Average wall-clock time between beginFrame() and endFrame()
+	double getFrameMs() const { return mFrameAvgMs; }
+
+	/** Predict the recording critical path with <threadCount> recording threads, using the averaged pass costs.
+	    \param[in] submitCostMs Per-command-list cost of handing work back to the main thread for submission.
+	*/
+	double predictParallelRecording(uint32_t threadCount, double submitCostMs = 0.0) const;
+
+protected:
+	CpuRecordingStats(double smoothing) : mSmoothing(smoothing) {}
+
+	uint32_t getThreadIndex(std::thread::id id);    ///< Expects mMutex to be held
+
+	std::vector<PassStats>                    mPasses;          ///< Passes recorded last frame, in recording order
+	std::vector<std::thread::id>              mThreadIds;       ///< Index 0 is the main thread
+	double                                    mSmoothing;
+	double                                    mFrameAvgMs = 0.0;
+	uint64_t                                  mFrame = 0;
+	uint32_t                                  mFrameOrder = 0;
+	CpuTimer::TimePoint                       mFrameStart;
+	std::mutex                                mMutex;
+};
@@ -0,0 +1,49 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "GpuReadback.h"
+
+using namespace Falcor;
+
+GpuReadback::GpuReadback(size_t size) : mSize(size)
+{
+	// Buffers with no bind flags live in the readback heap, so mapping them doesn't flush the GPU
+	for (uint32_t i = 0; i < kLatency; i++)
+		mStaging.push_back(Buffer::create(size, Resource::BindFlags::None, Buffer::CpuAccess::Read, nullptr));
+}
+
+void GpuReadback::copy(RenderContext* pRenderContext, const Buffer::SharedPtr& pSrc, uint64_t srcOffset)
+{
+	if (!pRenderContext || !pSrc) return;
+	const Buffer::SharedPtr& pDst = mStaging[mCopiesIssued % kLatency];
+	pRenderContext->copyBufferRegion(pDst.get(), 0, pSrc.get(), srcOffset, mSize);
+	mCopiesIssued++;
+}
+
+bool GpuReadback::read(void* pDst)
+{
+	// The buffer we're about to overwrite next is also the oldest one written, i.e., the one most likely done
+	if (mCopiesIssued < kLatency) return false;
+	const Buffer::SharedPtr& pSrc = mStaging[mCopiesIssued % kLatency];
+
+	const void* pData = pSrc->map(Buffer::MapType::Read);
+	if (!pData) return false;
+	memcpy(pDst, pData, mSize);
+	pSrc->unmap();
+	return true;
+}
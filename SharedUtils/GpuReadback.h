@@ -0,0 +1,63 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+
+#include "Falcor.h"
+
+/** A small ring of CPU-readable staging buffers for getting GPU-computed values (counters, statistics) back to
+    the CPU without stalling.  Each frame, copy() snapshots a region of a GPU buffer into the next staging buffer;
+    read() returns the most recent snapshot the GPU is guaranteed to have finished, which lags a few frames behind.
+    That's fine for statistics and feedback loops, not for anything that must be exact this frame.
+
+    Usage:
+        GpuReadback::SharedPtr pReadback = GpuReadback::create(sizeof(uint32_t) * 2);
+        ...
+        pReadback->copy(pRenderContext, pCounterBuffer);
+        uint32_t counts[2];
+        if (pReadback->read(counts)) { ... }
+*/
+class GpuReadback : public std::enable_shared_from_this<GpuReadback>
+{
+public:
+	using SharedPtr = std::shared_ptr<GpuReadback>;
+	using SharedConstPtr = std::shared_ptr<const GpuReadback>;
+	virtual ~GpuReadback() = default;
+
+	// Number of staging buffers.  Must exceed the number of frames the GPU can run behind the CPU.
+	static const uint32_t kLatency = 4;
+
+	static SharedPtr create(size_t size) { return SharedPtr(new GpuReadback(size)); }
+
+	/** Record a copy of <size> bytes (the size this readback was created with) from pSrc, starting at srcOffset
+	*/
+	void copy(Falcor::RenderContext* pRenderContext, const Falcor::Buffer::SharedPtr& pSrc, uint64_t srcOffset = 0);
+
+	/** Copy the oldest completed snapshot into pDst.  Returns false until enough frames have gone by.
+	*/
+	bool read(void* pDst);
+
+	size_t getSize() const { return mSize; }
+
+protected:
+	GpuReadback(size_t size);
+
+	size_t                                  mSize;                 ///< Bytes copied per snapshot
+	std::vector<Falcor::Buffer::SharedPtr>  mStaging;              ///< Ring of CPU-readable buffers
+	uint64_t                                mCopiesIssued = 0;     ///< Total number of copy() calls so far
+};
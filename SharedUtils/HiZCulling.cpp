@@ -0,0 +1,159 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "HiZCulling.h"
+
+namespace HiZCulling
+{
+	glm::uvec2 levelSize(const glm::uvec2& baseSize, uint32_t level)
+	{
+		return glm::max(glm::uvec2(1), (baseSize + glm::uvec2((1u << level) - 1u)) >> level);
+	}
+
+	uint32_t levelOffset(const glm::uvec2& baseSize, uint32_t level)
+	{
+		uint32_t offset = 0;
+		for (uint32_t l = 0; l < level; l++)
+		{
+			glm::uvec2 size = levelSize(baseSize, l);
+			offset += size.x * size.y;
+		}
+		return offset;
+	}
+
+	uint32_t levelCount(const glm::uvec2& baseSize)
+	{
+		uint32_t levels = 1;
+		while (glm::any(glm::greaterThan(levelSize(baseSize, levels - 1), glm::uvec2(1))) && levels < kMaxLevels) levels++;
+		return levels;
+	}
+
+	uint32_t pyramidSize(const glm::uvec2& baseSize)
+	{
+		return levelOffset(baseSize, levelCount(baseSize));
+	}
+
+	std::vector<float> reprojectDepth(const std::vector<float>& prevDepth, const glm::uvec2& size, const glm::mat4& prevInvViewProj, const glm::mat4& viewProj)
+	{
+		// Zero marks pixels nothing landed in.  Depths are positive, so keeping the max works as on the GPU (which
+		//     compares the float bits as uints).
+		std::vector<float> depth(size.x * size.y, 0.0f);
+		for (uint32_t y = 0; y < size.y; y++)
+		{
+			for (uint32_t x = 0; x < size.x; x++)
+			{
+				float d = prevDepth[x + y * size.x];
+				if (d >= 1.0f) continue;     // Nothing was rendered here
+
+				glm::vec4 ndc((x + 0.5f) / size.x * 2.0f - 1.0f, 1.0f - (y + 0.5f) / size.y * 2.0f, d, 1.0f);
+				glm::vec4 world = prevInvViewProj * ndc;
+				glm::vec4 clip = viewProj * glm::vec4(glm::vec3(world) / world.w, 1.0f);
+				if (clip.w <= 0.0f) continue;
+
+				glm::vec3 pos = glm::vec3(clip) / clip.w;
+				if (pos.z <= 0.0f || pos.z >= 1.0f) continue;
+				float u = pos.x * 0.5f + 0.5f;
+				float v = 0.5f - pos.y * 0.5f;
+				if (u < 0.0f || u >= 1.0f || v < 0.0f || v >= 1.0f) continue;
+
+				float& dst = depth[uint32_t(u * size.x) + uint32_t(v * size.y) * size.x];
+				dst = std::max(dst, pos.z);
+			}
+		}
+
+		for (float& d : depth)
+		{
+			if (d == 0.0f) d = 1.0f;
+		}
+		return depth;
+	}
+
+	std::vector<float> buildPyramid(const std::vector<float>& depth, const glm::uvec2& size)
+	{
+		std::vector<float> pyramid(pyramidSize(size));
+		std::copy(depth.begin(), depth.begin() + size.x * size.y, pyramid.begin());
+
+		uint32_t levels = levelCount(size);
+		for (uint32_t level = 1; level < levels; level++)
+		{
+			glm::uvec2 srcSize = levelSize(size, level - 1);
+			glm::uvec2 dstSize = levelSize(size, level);
+			const float* pSrc = &pyramid[levelOffset(size, level - 1)];
+			float* pDst = &pyramid[levelOffset(size, level)];
+			for (uint32_t y = 0; y < dstSize.y; y++)
+			{
+				for (uint32_t x = 0; x < dstSize.x; x++)
+				{
+					// Odd-sized levels clamp at the edge
+					float d = 0.0f;
+					for (uint32_t i = 0; i < 4; i++)
+					{
+						uint32_t sx = std::min(x * 2 + (i & 1), srcSize.x - 1);
+						uint32_t sy = std::min(y * 2 + (i >> 1), srcSize.y - 1);
+						d = std::max(d, pSrc[sx + sy * srcSize.x]);
+					}
+					pDst[x + y * dstSize.x] = d;
+				}
+			}
+		}
+		return pyramid;
+	}
+
+	bool isOccluded(const std::vector<float>& pyramid, const glm::uvec2& baseSize, const Falcor::BoundingBox& box, const glm::mat4& viewProj)
+	{
+		// Screen rectangle and closest depth of the box's corners
+		glm::vec2 uvMin(1.0f), uvMax(0.0f);
+		float minDepth = 1.0f;
+		for (uint32_t i = 0; i < 8; i++)
+		{
+			glm::vec3 corner = box.center + box.extent * glm::vec3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+			glm::vec4 clip = viewProj * glm::vec4(corner, 1.0f);
+			if (clip.w <= 0.0f || clip.z < 0.0f) return false;     // Crosses the near plane
+
+			glm::vec3 pos = glm::vec3(clip) / clip.w;
+			glm::vec2 uv(pos.x * 0.5f + 0.5f, 0.5f - pos.y * 0.5f);
+			uvMin = glm::min(uvMin, uv);
+			uvMax = glm::max(uvMax, uv);
+			minDepth = std::min(minDepth, pos.z);
+		}
+
+		// Pixels covered, clamped to the screen
+		glm::uvec2 pixelMin = glm::min(glm::uvec2(glm::clamp(uvMin, glm::vec2(0.0f), glm::vec2(1.0f)) * glm::vec2(baseSize)), baseSize - glm::uvec2(1));
+		glm::uvec2 pixelMax = glm::min(glm::uvec2(glm::clamp(uvMax, glm::vec2(0.0f), glm::vec2(1.0f)) * glm::vec2(baseSize)), baseSize - glm::uvec2(1));
+
+		// The finest level where the rectangle spans at most 2 cells per axis, i.e., where a cell is wider than it
+		uint32_t span = std::max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y);
+		uint32_t level = 0;
+		while ((span >> level) != 0) level++;
+		level = std::min(level, levelCount(baseSize) - 1);
+
+		glm::uvec2 size = levelSize(baseSize, level);
+		uint32_t offset = levelOffset(baseSize, level);
+		glm::uvec2 cellMin = pixelMin >> level;
+		glm::uvec2 cellMax = pixelMax >> level;
+		float maxDepth = 0.0f;
+		for (uint32_t y = cellMin.y; y <= cellMax.y; y++)
+		{
+			for (uint32_t x = cellMin.x; x <= cellMax.x; x++)
+			{
+				maxDepth = std::max(maxDepth, pyramid[offset + x + y * size.x]);
+			}
+		}
+		return minDepth > maxDepth;
+	}
+};
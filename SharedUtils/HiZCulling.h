@@ -0,0 +1,73 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+
+#include "Falcor.h"
+
+/** CPU reference for the Hi-Z occlusion test HiZOcclusionCuller runs on the GPU (see
+    CommonPasses/Data/CommonPasses/hiZCulling.hlsli for the HLSL version, which must make identical decisions).
+
+    The pyramid holds hardware depth (0 at the near plane, 1 at the far plane).  Level 0 is one value per pixel; each
+    higher level holds the maximum (i.e., farthest) depth of the 2x2 cells below it, so a level-l cell is a
+    conservative occluder for everything behind it.  Levels are stored one after another, each row-major.
+
+    A box is occluded when its closest point is behind the farthest depth stored in the (at most 2x2) cells covering
+    its screen rectangle, at the level where that rectangle spans no more than 2 cells per axis.  Boxes that cross the
+    near plane are never occluded.
+*/
+namespace HiZCulling
+{
+	static const uint32_t kMaxLevels = 16;
+
+	/** Dimensions of a level of the pyramid
+	*/
+	glm::uvec2 levelSize(const glm::uvec2& baseSize, uint32_t level);
+
+	/** Where a level of the pyramid starts
+	*/
+	uint32_t levelOffset(const glm::uvec2& baseSize, uint32_t level);
+
+	/** How many levels does a pyramid over a <baseSize> image have (down to and including 1x1)?
+	*/
+	uint32_t levelCount(const glm::uvec2& baseSize);
+
+	/** Total number of values in a pyramid over a <baseSize> image
+	*/
+	uint32_t pyramidSize(const glm::uvec2& baseSize);
+
+	/** Move last frame's depth buffer to where the current camera sees it.  Each pixel is unprojected with the
+	    previous camera and splatted into the pixel it lands in with the current one, keeping the farthest depth when
+	    several land in the same pixel.  Pixels nothing lands in (disocclusions, and the sky) get the far plane, so
+	    they never occlude anything.
+	        \param[in] prevDepth Last frame's depth, row-major, <size> pixels
+	        \param[in] prevInvViewProj Inverse view-projection matrix of the camera last frame
+	        \param[in] viewProj View-projection matrix of the camera this frame
+	*/
+	std::vector<float> reprojectDepth(const std::vector<float>& prevDepth, const glm::uvec2& size, const glm::mat4& prevInvViewProj, const glm::mat4& viewProj);
+
+	/** Build a max-depth pyramid over a depth image
+	*/
+	std::vector<float> buildPyramid(const std::vector<float>& depth, const glm::uvec2& size);
+
+	/** Is a world-space box hidden behind the depths in a pyramid?
+	    \param[in] pyramid Built by buildPyramid() over a <baseSize> image
+	    \param[in] viewProj View-projection matrix of the camera the pyramid was built (or reprojected) for
+	*/
+	bool isOccluded(const std::vector<float>& pyramid, const glm::uvec2& baseSize, const Falcor::BoundingBox& box, const glm::mat4& viewProj);
+};
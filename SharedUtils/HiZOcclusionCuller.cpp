@@ -0,0 +1,270 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "HiZOcclusionCuller.h"
+#include "HiZCulling.h"
+
+using namespace Falcor;
+
+namespace {
+	// Where are our shaders located?
+	const char* kFileHiZCulling = "CommonPasses\\hiZCulling.cs.hlsl";
+
+	// sizeof(D3D12_DRAW_INDEXED_ARGUMENTS):  index count, instance count, start index, base vertex, start instance
+	const uint32_t kDrawArgsSize = 5 * sizeof(uint32_t);
+};
+
+// A scene renderer that draws each mesh instance on its own, through drawIndexedIndirect().  The instance's cull box
+//     picks its argument record.  SceneRenderer tests an instance's box right before drawing it, which is how we know
+//     which box the next draw belongs to.
+class HiZOcclusionCuller::Renderer : public SceneRenderer
+{
+public:
+	static std::shared_ptr<Renderer> create(const Scene::SharedPtr& pScene) { return std::shared_ptr<Renderer>(new Renderer(pScene)); }
+
+	// Draw through the records of pArgs starting at firstRecord and, if pTemplates isn't null, store each draw's
+	//     arguments there for the cull kernels.  With a null pArgs, draws directly like SceneRenderer.
+	void setDrawArgs(const Buffer* pArgs, uint32_t firstRecord, uint32_t* pTemplates, uint32_t boxCount)
+	{
+		mpArgs = pArgs;
+		mFirstRecord = firstRecord;
+		mpTemplates = pTemplates;
+		mBoxCount = boxCount;
+	}
+
+protected:
+	Renderer(const Scene::SharedPtr& pScene) : SceneRenderer(pScene)
+	{
+		// One instance per draw, so each draw matches one box.  We rely on the per-instance cull test to find the box.
+		setMaxInstanceCount(1);
+		toggleMeshCulling(true);
+	}
+
+	bool cullMeshInstance(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t cullBox) override
+	{
+		mCurrentBox = cullBox;
+		return SceneRenderer::cullMeshInstance(currentData, pModelInstance, pMeshInstance, cullBox);
+	}
+
+	void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex) override
+	{
+		if (!mpArgs || mCurrentBox >= mBoxCount)
+		{
+			SceneRenderer::executeDraw(currentData, indexCount, instanceCount, startIndex);
+			return;
+		}
+
+		if (mpTemplates)
+		{
+			uint32_t* pTemplate = mpTemplates + mCurrentBox * (kDrawArgsSize / sizeof(uint32_t));
+			pTemplate[0] = indexCount;
+			pTemplate[1] = instanceCount;
+			pTemplate[2] = startIndex;
+			pTemplate[3] = 0;
+			pTemplate[4] = 0;
+		}
+		currentData.pContext->drawIndexedIndirect(mpArgs, uint64_t(mFirstRecord + mCurrentBox) * kDrawArgsSize);
+	}
+
+	const Buffer* mpArgs = nullptr;
+	uint32_t      mFirstRecord = 0;
+	uint32_t*     mpTemplates = nullptr;
+	uint32_t      mBoxCount = 0;
+	uint32_t      mCurrentBox = 0;
+};
+
+HiZOcclusionCuller::HiZOcclusionCuller()
+{
+	mpReproject = ComputeLaunch::create(kFileHiZCulling, "HiZReproject");
+	mpResolveReprojection = ComputeLaunch::create(kFileHiZCulling, "HiZResolveReprojection");
+	mpCopyDepth = ComputeLaunch::create(kFileHiZCulling, "HiZCopyDepth");
+	mpDownsample = ComputeLaunch::create(kFileHiZCulling, "HiZDownsample");
+	mpCullPhase1 = ComputeLaunch::create(kFileHiZCulling, "HiZCullPhase1");
+	mpCullPhase2 = ComputeLaunch::create(kFileHiZCulling, "HiZCullPhase2");
+
+	mpCounters = TypedBuffer<uint32_t>::create(4);
+	mpCountersReadback = GpuReadback::create(4 * sizeof(uint32_t));
+}
+
+void HiZOcclusionCuller::setScene(const Scene::SharedPtr& pScene)
+{
+	mpScene = pScene;
+	mpRenderer = pScene ? Renderer::create(pScene) : nullptr;
+	mHistoryValid = false;
+	mStats = Stats();
+}
+
+SceneRenderer::SharedPtr HiZOcclusionCuller::getSceneRenderer() const
+{
+	return mpRenderer;
+}
+
+void HiZOcclusionCuller::resize(const glm::uvec2& depthSize, uint32_t boxCount)
+{
+	if (depthSize != mDepthSize)
+	{
+		mpReprojected = TypedBuffer<uint32_t>::create(depthSize.x * depthSize.y);
+		mpHiZ = TypedBuffer<float>::create(HiZCulling::pyramidSize(depthSize));
+		mDepthSize = depthSize;
+		mHistoryValid = false;
+	}
+
+	if (boxCount > mBoxCapacity)
+	{
+		mBoxCapacity = boxCount;
+		mpBoxes = TypedBuffer<glm::vec4>::create(2 * boxCount, Resource::BindFlags::ShaderResource);
+		mpRetest = TypedBuffer<uint32_t>::create(boxCount);
+		mpDrawTemplates = Buffer::create(boxCount * kDrawArgsSize, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::Write);
+		mpDrawArgs = Buffer::create(2 * boxCount * kDrawArgsSize, Resource::BindFlags::IndirectArg | Resource::BindFlags::UnorderedAccess, Buffer::CpuAccess::None);
+	}
+	mBoxCount = boxCount;
+}
+
+void HiZOcclusionCuller::buildPyramid(RenderContext* pRenderContext, uint32_t levelCount)
+{
+	// Each level reads the one before it, so we need a barrier between each
+	auto downVars = mpDownsample->getVars();
+	downVars["HiZCB"]["gBaseSize"] = mDepthSize;
+	downVars["gHiZ"] = mpHiZ;
+	for (uint32_t level = 1; level < levelCount; level++)
+	{
+		pRenderContext->uavBarrier(mpHiZ.get());
+		downVars["HiZCB"]["gDstLevel"] = level;
+		mpDownsample->execute(pRenderContext, uvec3(HiZCulling::levelSize(mDepthSize, level), 1));
+	}
+	pRenderContext->uavBarrier(mpHiZ.get());
+}
+
+void HiZOcclusionCuller::cullFirstPhase(RenderContext* pRenderContext, const Texture::SharedPtr& pDepth, const Camera* pCamera)
+{
+	mBoxCount = 0;
+	if (!mpRenderer || !pDepth || !pCamera) return;
+
+	// Same boxes the renderer will frustum cull against (the update is a no-op when it runs again in renderScene())
+	const InstanceCuller::SharedPtr& pCuller = mpRenderer->getInstanceCuller();
+	pCuller->update(mpScene.get());
+	resize(uvec2(pDepth->getWidth(), pDepth->getHeight()), pCuller->getBoxCount());
+	if (mBoxCount == 0) return;
+
+	mBoxData.resize(2 * mBoxCount);
+	for (uint32_t i = 0; i < mBoxCount; i++)
+	{
+		const BoundingBox& box = pCuller->getBox(i);
+		mBoxData[2 * i] = vec4(box.center, 0.0f);
+		mBoxData[2 * i + 1] = vec4(box.extent, 0.0f);
+	}
+	mpBoxes->updateData(mBoxData.data(), 0, mBoxData.size() * sizeof(vec4));
+
+	// The renderer writes the draw arguments while recording the draws, i.e., after the cull kernels are recorded
+	//     but before any of them run.  Upload memory is read when the GPU gets there, so that's fine.  Boxes it
+	//     doesn't draw keep an instance count of 0.
+	uint32_t* pTemplates = (uint32_t*)mpDrawTemplates->map(Buffer::MapType::WriteDiscard);
+	memset(pTemplates, 0, mBoxCount * kDrawArgsSize);
+
+	mViewProj = pCamera->getViewProjMatrix();
+	uint32_t levelCount = HiZCulling::levelCount(mDepthSize);
+	if (mHistoryValid)
+	{
+		auto reprojectVars = mpReproject->getVars();
+		reprojectVars["HiZCB"]["gViewProj"] = mViewProj;
+		reprojectVars["HiZCB"]["gPrevInvViewProj"] = glm::inverse(mPrevViewProj);
+		reprojectVars["HiZCB"]["gBaseSize"] = mDepthSize;
+		reprojectVars["gDepth"] = pDepth;
+		reprojectVars["gReprojected"] = mpReprojected;
+		pRenderContext->clearUAV(mpReprojected->getUAV().get(), uvec4(0));
+		mpReproject->execute(pRenderContext, uvec3(mDepthSize, 1));
+		pRenderContext->uavBarrier(mpReprojected.get());
+
+		auto resolveVars = mpResolveReprojection->getVars();
+		resolveVars["HiZCB"]["gBaseSize"] = mDepthSize;
+		resolveVars["gReprojected"] = mpReprojected;
+		resolveVars["gHiZ"] = mpHiZ;
+		mpResolveReprojection->execute(pRenderContext, uvec3(mDepthSize, 1));
+		buildPyramid(pRenderContext, levelCount);
+	}
+
+	auto cullVars = mpCullPhase1->getVars();
+	cullVars["HiZCB"]["gViewProj"] = mViewProj;
+	cullVars["HiZCB"]["gBaseSize"] = mDepthSize;
+	cullVars["HiZCB"]["gBoxCount"] = mBoxCount;
+	cullVars["HiZCB"]["gPyramidValid"] = uint32_t(mHistoryValid ? 1 : 0);
+	cullVars["gHiZ"] = mpHiZ;
+	cullVars["gBoxes"] = mpBoxes;
+	cullVars["gDrawTemplates"] = mpDrawTemplates;
+	cullVars["gDrawArgs"] = mpDrawArgs;
+	cullVars["gRetest"] = mpRetest;
+	cullVars["gCounters"] = mpCounters;
+	pRenderContext->clearUAV(mpCounters->getUAV().get(), uvec4(0));
+	mpCullPhase1->execute(pRenderContext, uvec3(mBoxCount, 1, 1));
+
+	mpRenderer->setDrawArgs(mpDrawArgs.get(), 0, pTemplates, mBoxCount);
+}
+
+void HiZOcclusionCuller::cullSecondPhase(RenderContext* pRenderContext, const Texture::SharedPtr& pDepth)
+{
+	if (!mpRenderer || !pDepth || mBoxCount == 0) return;
+
+	auto copyVars = mpCopyDepth->getVars();
+	copyVars["HiZCB"]["gBaseSize"] = mDepthSize;
+	copyVars["gDepth"] = pDepth;
+	copyVars["gHiZ"] = mpHiZ;
+	mpCopyDepth->execute(pRenderContext, uvec3(mDepthSize, 1));
+	buildPyramid(pRenderContext, HiZCulling::levelCount(mDepthSize));
+
+	auto cullVars = mpCullPhase2->getVars();
+	cullVars["HiZCB"]["gViewProj"] = mViewProj;
+	cullVars["HiZCB"]["gBaseSize"] = mDepthSize;
+	cullVars["HiZCB"]["gBoxCount"] = mBoxCount;
+	cullVars["gHiZ"] = mpHiZ;
+	cullVars["gBoxes"] = mpBoxes;
+	cullVars["gDrawTemplates"] = mpDrawTemplates;
+	cullVars["gDrawArgs"] = mpDrawArgs;
+	cullVars["gRetest"] = mpRetest;
+	cullVars["gCounters"] = mpCounters;
+	pRenderContext->uavBarrier(mpRetest.get());
+	mpCullPhase2->execute(pRenderContext, uvec3(mBoxCount, 1, 1));
+
+	// Phase 2 records come after all the phase 1 records.  The kernel already has the arguments phase 1 recorded.
+	mpRenderer->setDrawArgs(mpDrawArgs.get(), mBoxCount, nullptr, mBoxCount);
+}
+
+void HiZOcclusionCuller::endFrame(RenderContext* pRenderContext)
+{
+	if (!mpRenderer) return;
+	mpRenderer->setDrawArgs(nullptr, 0, nullptr, 0);
+	if (mBoxCount == 0) return;
+	mpDrawTemplates->unmap();
+
+	// The depth buffer now holds everything this frame needs, drawn from this camera
+	mPrevViewProj = mViewProj;
+	mHistoryValid = true;
+
+	mStats.instances = mBoxCount;
+	mStats.frustumCulled = mBoxCount - uint32_t(mpRenderer->getInstanceCuller()->getVisibleBoxes().size());
+
+	// Grab the counts for the GUI (these arrive a few frames late)
+	mpCountersReadback->copy(pRenderContext, mpCounters);
+	uint32_t counts[4];
+	if (mpCountersReadback->read(counts))
+	{
+		mStats.tested = counts[0];
+		mStats.culledFirstPhase = counts[1];
+		mStats.drawnSecondPhase = counts[2];
+		mStats.occlusionCulled = counts[3];
+	}
+}
@@ -0,0 +1,126 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+
+#include "Falcor.h"
+#include "ComputeLaunch.h"
+#include "GpuReadback.h"
+
+/** Two-phase Hi-Z occlusion culling for a raster pass that draws the scene with getSceneRenderer().
+
+    Phase 1 builds a max-depth pyramid from last frame's depth buffer, reprojected to this frame's camera, and tests
+    the bounds of every frustum-visible mesh instance against it.  The pass then draws the instances that passed.
+    Phase 2 builds the pyramid again from the depth phase 1 just wrote and tests the instances phase 1 culled; the
+    pass draws the scene a second time, and only those that are visible now (disoccluded since last frame, or missed
+    by the reprojection) are drawn.  Nothing visible is ever culled, since phase 2 tests against this frame's depth.
+
+    All the tests run on the GPU.  The scene renderer still records one draw per frustum-visible instance in each
+    phase, but through drawIndexedIndirect(), with arguments the cull kernels copy from what the CPU recorded and
+    zero out for the instances to skip.  HiZCulling.h is a CPU reference for the test.
+
+    Usage, each frame:
+        mpCuller->cullFirstPhase(pRenderContext, pDepth, pCamera);     // Before clearing pDepth
+        <clear, then render the scene with getSceneRenderer()>
+        mpCuller->cullSecondPhase(pRenderContext, pDepth);
+        <render the scene with getSceneRenderer() again, without clearing>
+        mpCuller->endFrame(pRenderContext);
+*/
+class HiZOcclusionCuller : public std::enable_shared_from_this<HiZOcclusionCuller>
+{
+public:
+	using SharedPtr = std::shared_ptr<HiZOcclusionCuller>;
+	using SharedConstPtr = std::shared_ptr<const HiZOcclusionCuller>;
+	virtual ~HiZOcclusionCuller() = default;
+
+	// Per-frame instance counts.  The frustum count is exact; the others come back from the GPU a few frames late.
+	struct Stats
+	{
+		uint32_t instances = 0;          ///< Mesh instances in the scene
+		uint32_t frustumCulled = 0;      ///< Instances outside the view frustum
+		uint32_t tested = 0;             ///< Instances tested against the Hi-Z pyramid (i.e., inside the frustum)
+		uint32_t culledFirstPhase = 0;   ///< Instances hidden behind last frame's (reprojected) depth
+		uint32_t drawnSecondPhase = 0;   ///< Instances phase 1 culled that turned out to be visible
+		uint32_t occlusionCulled = 0;    ///< Instances hidden in both phases, i.e., never drawn
+	};
+
+	static SharedPtr create() { return SharedPtr(new HiZOcclusionCuller()); }
+
+	/** Set the scene.  Also forgets last frame's depth, so phase 1 culls nothing until a frame was drawn with the culler.
+	*/
+	void setScene(const Falcor::Scene::SharedPtr& pScene);
+
+	/** The renderer the culled pass must draw the scene with (e.g., via RasterLaunch::setSceneRenderer()).  Outside of
+	    the two phases it draws every frustum-visible instance, like the default renderer.
+	*/
+	Falcor::SceneRenderer::SharedPtr getSceneRenderer() const;
+
+	/** Build the pyramid from last frame's depth and record the phase 1 tests.  Scene draws that follow use the
+	    phase 1 results.
+	        \param[in] pDepth The depth buffer, still holding what the culled pass drew last frame
+	        \param[in] pCamera The camera this frame is rendered from
+	*/
+	void cullFirstPhase(Falcor::RenderContext* pRenderContext, const Falcor::Texture::SharedPtr& pDepth, const Falcor::Camera* pCamera);
+
+	/** Build the pyramid from the depth phase 1 drew and record the phase 2 tests.  Scene draws that follow use the
+	    phase 2 results.
+	*/
+	void cullSecondPhase(Falcor::RenderContext* pRenderContext, const Falcor::Texture::SharedPtr& pDepth);
+
+	/** Read back the statistics and go back to drawing every frustum-visible instance
+	*/
+	void endFrame(Falcor::RenderContext* pRenderContext);
+
+	const Stats& getStats() const { return mStats; }
+
+protected:
+	HiZOcclusionCuller();
+
+	class Renderer;
+
+	void resize(const glm::uvec2& depthSize, uint32_t boxCount);
+	void buildPyramid(Falcor::RenderContext* pRenderContext, uint32_t levelCount);
+
+	std::shared_ptr<Renderer>           mpRenderer;            ///< Scene renderer which draws through mpDrawArgs
+	Falcor::Scene::SharedPtr            mpScene;
+
+	ComputeLaunch::SharedPtr            mpReproject;           ///< Splats last frame's depth to where this frame's camera sees it
+	ComputeLaunch::SharedPtr            mpResolveReprojection; ///< Fills pyramid level 0 from the splatted depth
+	ComputeLaunch::SharedPtr            mpCopyDepth;           ///< Fills pyramid level 0 from this frame's depth
+	ComputeLaunch::SharedPtr            mpDownsample;          ///< Builds each higher pyramid level from the one below
+	ComputeLaunch::SharedPtr            mpCullPhase1;
+	ComputeLaunch::SharedPtr            mpCullPhase2;
+
+	Falcor::TypedBufferBase::SharedPtr  mpReprojected;         ///< Reprojected depth bits, one per pixel
+	Falcor::TypedBufferBase::SharedPtr  mpHiZ;                 ///< All pyramid levels, back to back
+	Falcor::TypedBufferBase::SharedPtr  mpBoxes;               ///< World-space center and half extent of each instance
+	Falcor::TypedBufferBase::SharedPtr  mpRetest;              ///< Instances phase 1 culled
+	Falcor::TypedBufferBase::SharedPtr  mpCounters;            ///< See the Stats members
+	Falcor::Buffer::SharedPtr           mpDrawTemplates;       ///< Upload buffer of the draw arguments the renderer records
+	Falcor::Buffer::SharedPtr           mpDrawArgs;            ///< Arguments of the phase 1 draws, then of the phase 2 draws
+	GpuReadback::SharedPtr              mpCountersReadback;
+
+	glm::uvec2                          mDepthSize = glm::uvec2(0);
+	uint32_t                            mBoxCapacity = 0;
+	uint32_t                            mBoxCount = 0;
+	glm::mat4                           mViewProj;
+	glm::mat4                           mPrevViewProj;         ///< Camera the depth buffer was drawn with last frame
+	bool                                mHistoryValid = false;
+	std::vector<glm::vec4>              mBoxData;
+	Stats                               mStats;
+};
@@ -0,0 +1,225 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "ParallelRecorder.h"
+#include <algorithm>
+
+ParallelRecorder::SharedPtr ParallelRecorder::create(const RenderContext::SharedPtr& pGraphicsContext, uint32_t threadCount)
+{
+	if (!pGraphicsContext || threadCount == 0) return nullptr;
+
+	SharedPtr pThis = SharedPtr(new ParallelRecorder());
+	pThis->mpGraphicsContext = pGraphicsContext;
+	pThis->mWorkers.resize(threadCount);
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		Worker &worker = pThis->mWorkers[i];
+		worker.allocators = gpDevice->createThreadAllocators();
+		worker.thread = std::thread(&ParallelRecorder::workerMain, pThis.get(), i);
+	}
+	return pThis;
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWorkAvailable.notify_all();
+	for (auto &worker : mWorkers)
+	{
+		if (worker.thread.joinable()) worker.thread.join();
+	}
+}
+
+void ParallelRecorder::beginFrame(std::vector<Job> jobs)
+{
+	endFrame();
+
+	// The workers are idle, so their allocators can take back what the GPU is done with
+	for (auto &worker : mWorkers)
+	{
+		worker.allocators.pResourceAllocator->executeDeferredReleases();
+		worker.allocators.pCpuDescPool->executeDeferredReleases();
+		worker.allocators.pGpuDescPool->executeDeferredReleases();
+		worker.jobs.clear();
+	}
+
+	mJobs.clear();
+	for (auto &job : jobs)
+	{
+		mJobs.emplace_back();
+		mJobs.back().job = std::move(job);
+
+		// Views get created on first use, and a resource's view cache isn't thread safe.  Create the default ones now.
+		for (const auto &state : mJobs.back().job.channelStates)
+		{
+			const Resource* pResource = state.first;
+			if (is_set(pResource->getBindFlags(), Resource::BindFlags::ShaderResource)) pResource->getSRV();
+			if (is_set(pResource->getBindFlags(), Resource::BindFlags::UnorderedAccess)) pResource->getUAV();
+			if (is_set(pResource->getBindFlags(), Resource::BindFlags::RenderTarget)) pResource->getRTV();
+			if (is_set(pResource->getBindFlags(), Resource::BindFlags::DepthStencil)) pResource->getDSV();
+		}
+	}
+	if (mJobs.empty()) return;
+
+	// Longest-processing-time-first: give the most expensive remaining job to the least loaded worker.  (Same balance as
+	//     CpuRecordingStats::predictParallelRecording().)
+	std::vector<uint32_t> byCost(mJobs.size());
+	for (uint32_t i = 0; i < uint32_t(byCost.size()); i++) byCost[i] = i;
+	std::stable_sort(byCost.begin(), byCost.end(), [this](uint32_t a, uint32_t b) { return mJobs[a].job.cost > mJobs[b].job.cost; });
+
+	std::vector<double> load(mWorkers.size(), 0.0);
+	for (uint32_t jobIdx : byCost)
+	{
+		uint32_t worker = uint32_t(std::min_element(load.begin(), load.end()) - load.begin());
+		load[worker] += mJobs[jobIdx].job.cost;
+		mJobs[jobIdx].worker = worker;
+	}
+	for (uint32_t i = 0; i < uint32_t(mJobs.size()); i++)
+	{
+		mWorkers[mJobs[i].worker].jobs.push_back(i);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPendingJobs = uint32_t(mJobs.size());
+		mFrame++;
+	}
+	mWorkAvailable.notify_all();
+}
+
+const ParallelRecorder::JobState* ParallelRecorder::findJob(uint32_t passIdx) const
+{
+	auto it = std::find_if(mJobs.begin(), mJobs.end(), [passIdx](const JobState &job) { return job.job.passIdx == passIdx; });
+	return (it == mJobs.end()) ? nullptr : &(*it);
+}
+
+bool ParallelRecorder::submit(uint32_t passIdx)
+{
+	JobState* pJob = const_cast<JobState*>(findJob(passIdx));
+	if (!pJob || pJob->submitted) return false;
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mJobRecorded.wait(lock, [pJob] { return pJob->recorded; });
+	}
+
+	// Everything recorded on the main thread so far goes first, then the pass.  Time it on the main context, around both.
+	auto execute = [&]()
+	{
+		mpGraphicsContext->flush(false);
+		pJob->pContext->flush(false);
+	};
+	if (Falcor::gProfileEnabled)
+	{
+		Falcor::ProfilerEvent _profileEvent(pJob->job.name.c_str());
+		execute();
+	}
+	else
+	{
+		execute();
+	}
+
+	pJob->submitted = true;
+	return true;
+}
+
+void ParallelRecorder::endFrame()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mJobRecorded.wait(lock, [this] { return mPendingJobs == 0; });
+
+	// A job nobody submitted still has its commands in its context.  Submit them now (late, but the context has to be empty
+	//     before a worker records into it again).
+	for (auto &job : mJobs)
+	{
+		if (!job.submitted && job.pContext)
+		{
+			logWarning("ParallelRecorder: '" + job.job.name + "' was recorded but never submitted");
+			job.pContext->flush(false);
+		}
+		job.submitted = true;
+	}
+}
+
+void ParallelRecorder::workerMain(uint32_t workerIdx)
+{
+	Worker &worker = mWorkers[workerIdx];
+	Device::setThreadAllocators(worker.allocators);
+
+	while (true)
+	{
+		// The main thread sets up the next frame's jobs as soon as the last one got recorded, so take a copy of ours
+		std::vector<uint32_t> jobs;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWorkAvailable.wait(lock, [&] { return mQuit || worker.frame != mFrame; });
+			if (mQuit) break;
+			worker.frame = mFrame;
+			jobs = worker.jobs;
+		}
+
+		for (uint32_t i = 0; i < uint32_t(jobs.size()); i++)
+		{
+			JobState &job = mJobs[jobs[i]];
+			recordJob(worker, i, job);
+
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				job.recorded = true;
+				mPendingJobs--;
+			}
+			mJobRecorded.notify_all();
+		}
+	}
+
+	// Don't let the thread's exit destroy the allocators and contexts after the device
+	worker.contexts.clear();
+	Device::setThreadRenderContext(nullptr);
+	Device::setThreadAllocators(Device::ThreadAllocators());
+}
+
+void ParallelRecorder::recordJob(Worker& worker, uint32_t contextIdx, JobState& job)
+{
+	if (contextIdx >= worker.contexts.size())
+	{
+		worker.contexts.push_back(RenderContext::create(mpGraphicsContext->getLowLevelData()->getCommandQueue()));
+	}
+	job.pContext = worker.contexts[contextIdx];
+
+	// Submitting (on the main thread) re-binds the main thread's descriptor heaps
+	Device::setThreadRenderContext(job.pContext);
+	job.pContext->bindDescriptorHeaps();
+
+	Resource::StateMap states = job.job.channelStates;
+	Resource::setThreadStates(&states);
+	job.job.record(job.pContext.get());
+
+	// Leave the channels in the states the main thread expects them to be in once the pass executed
+	std::vector<CopyContext::Transition> restore;
+	for (const auto &state : job.job.channelStates)
+	{
+		if (states[state.first] != state.second) restore.push_back({ state.first, state.second });
+	}
+	if (restore.size()) job.pContext->resourceBarriers(restore);
+
+	Resource::setThreadStates(nullptr);
+	Device::setThreadRenderContext(nullptr);
+}
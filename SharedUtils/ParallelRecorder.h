@@ -0,0 +1,118 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include "Falcor.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Falcor;
+
+/** Records passes on worker threads, each pass into its own command list, for the main thread to submit in pipeline order.
+
+    Each worker has its own descriptor pools and upload allocator (see Device::setThreadAllocators()), and records a pass
+    into one of its own RenderContexts, which it also makes the thread's device context (see Device::setThreadRenderContext()).
+    The main thread keeps recording everything else into its own context while the workers run, and calls submit() where
+    a worker's pass goes in the pipeline: that submits what the main thread recorded so far, then the pass' command list,
+    on the same queue.  So the GPU executes passes in pipeline (i.e., PassGraph) order, whichever thread recorded them.
+
+    Resource states: a job lists the state each channel it uses will be in when its commands execute (the main thread
+    transitions them there before calling submit()).  The worker tracks those channels' states on its own while it records
+    (see Resource::setThreadStates()), and transitions them back before it's done.  A pass recorded in parallel must not
+    touch channels it didn't declare, or anything else shared with other passes (see RenderPass::canRecordInParallel()).
+*/
+class ParallelRecorder : public std::enable_shared_from_this<ParallelRecorder>
+{
+public:
+	using SharedPtr = std::shared_ptr<ParallelRecorder>;
+	using SharedConstPtr = std::shared_ptr<const ParallelRecorder>;
+
+	/** One pass to record.
+	*/
+	struct Job
+	{
+		uint32_t                              passIdx;
+		std::string                           name;           ///< For the profiler event around the submitted command list
+		std::function<void(RenderContext*)>   record;         ///< Records the pass into the context it gets
+		Resource::StateMap                    channelStates;  ///< The channels the pass uses, in the states they are in when it executes
+		double                                cost = 0.0;     ///< Expected recording time (any unit), to balance the workers
+	};
+
+	/** Start the worker threads.
+	    \param[in] pGraphicsContext The context the main thread records into.  Workers' command lists go on its queue.
+	    \param[in] threadCount Number of workers.
+	*/
+	static SharedPtr create(const RenderContext::SharedPtr& pGraphicsContext, uint32_t threadCount);
+	virtual ~ParallelRecorder();
+
+	uint32_t getThreadCount() const { return uint32_t(mWorkers.size()); }
+
+	/** Hand the workers a frame's jobs, in pipeline order.  Returns right away.  Each worker records its share of the jobs in
+	    that order, so the first ones get submitted early; the most expensive jobs get spread first.
+	*/
+	void beginFrame(std::vector<Job> jobs);
+
+	/** Wait for pass <passIdx> to be recorded, then submit it after whatever the graphics context recorded so far.
+	    \return false if the pass wasn't handed to the workers this frame (i.e., record it on the main thread).
+	*/
+	bool submit(uint32_t passIdx);
+
+	// Is pass <passIdx> one of this frame's jobs?
+	bool hasJob(uint32_t passIdx) const { return findJob(passIdx) != nullptr; }
+
+	// Wait for all workers to finish this frame's jobs (they all should have been submitted by then)
+	void endFrame();
+
+protected:
+	ParallelRecorder() = default;
+
+	struct JobState
+	{
+		Job                      job;
+		uint32_t                 worker = 0;
+		RenderContext::SharedPtr pContext;    ///< Set by the worker
+		bool                     recorded = false;
+		bool                     submitted = false;
+	};
+
+	struct Worker
+	{
+		std::thread                           thread;
+		Device::ThreadAllocators              allocators;
+		std::vector<RenderContext::SharedPtr> contexts;    ///< One per job it records in a frame, reused across frames
+		std::vector<uint32_t>                 jobs;        ///< Indices into mJobs, in pipeline order
+		uint64_t                              frame = 0;   ///< Last frame it picked up
+	};
+
+	void workerMain(uint32_t workerIdx);
+	void recordJob(Worker& worker, uint32_t contextIdx, JobState& job);
+	const JobState* findJob(uint32_t passIdx) const;
+
+	RenderContext::SharedPtr    mpGraphicsContext;
+	std::vector<Worker>         mWorkers;
+	std::vector<JobState>       mJobs;          ///< This frame's jobs, in pipeline order
+	uint64_t                    mFrame = 0;
+	uint32_t                    mPendingJobs = 0;
+	bool                        mQuit = false;
+	std::mutex                  mMutex;
+	std::condition_variable     mWorkAvailable; ///< Signaled when a frame starts (or the recorder is going away)
+	std::condition_variable     mJobRecorded;   ///< Signaled when a worker finishes a job
+};
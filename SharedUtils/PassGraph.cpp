@@ -0,0 +1,234 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "PassGraph.h"
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+
+namespace {
+	// Returned for passes that have no transitions (or invalid pass indices)
+	const std::vector<PassGraph::Transition> kNoTransitions;
+
+	bool contains(const std::vector<std::string> &list, const std::string &item)
+	{
+		return std::find(list.begin(), list.end(), item) != list.end();
+	}
+};
+
+bool PassGraph::compile(const std::vector<PassDesc>& passes, const std::vector<std::string>& sinkChannels, const std::vector<std::string>& externalChannels)
+{
+	// Start from a clean slate
+	mpGraph = DirectedGraph::create();
+	mEdgeData.clear();
+	mIsLive.clear();
+	mIsDeclared.clear();
+	mExecutionOrder.clear();
+	mMessages.clear();
+	mTransitions.assign(passes.size(), std::vector<Transition>());
+	mTransitionCount = 0;
+	mIsCompiled = false;
+
+	// One node per pass.  DirectedGraph hands out sequential IDs, so node ID == index into the pass list.
+	for (uint32_t i = 0; i < uint32_t(passes.size()); i++)
+	{
+		uint32_t nodeId = mpGraph->addNode();
+		if (nodeId != i) return false;
+		mIsDeclared.push_back(passes[i].declared);
+	}
+
+	buildEdges(passes);
+	cullPasses(passes, sinkChannels);
+	validateReads(passes, externalChannels);
+	computeTransitions(passes);
+
+	// Pipeline order is already a valid topological order of the graph (every edge points from an earlier pass
+	//     to a later one), and keeping it means culling never changes the relative order of surviving passes.
+	for (uint32_t i = 0; i < uint32_t(passes.size()); i++)
+	{
+		if (mIsLive[i]) mExecutionOrder.push_back(i);
+	}
+
+	mIsCompiled = true;
+	return true;
+}
+
+const std::vector<PassGraph::Transition>& PassGraph::getTransitions(uint32_t passIdx) const
+{
+	return (passIdx < mTransitions.size()) ? mTransitions[passIdx] : kNoTransitions;
+}
+
+void PassGraph::buildEdges(const std::vector<PassDesc>& passes)
+{
+	std::unordered_map<std::string, uint32_t> lastWriter;                 // Which pass last wrote each channel?
+	std::unordered_map<std::string, std::vector<uint32_t>> readers;       // Who read each channel since it was last written?
+
+	auto addEdge = [&](uint32_t src, uint32_t dst, const std::string &channel, EdgeType type)
+	{
+		uint32_t edgeId = mpGraph->addEdge(src, dst);
+		if (edgeId != DirectedGraph::kInvalidID) mEdgeData[edgeId] = { channel, type };
+	};
+
+	for (uint32_t i = 0; i < uint32_t(passes.size()); i++)
+	{
+		const PassDesc &pass = passes[i];
+
+		for (const auto &channel : pass.inputs)
+		{
+			auto writer = lastWriter.find(channel);
+			if (writer != lastWriter.end() && writer->second != i)
+				addEdge(writer->second, i, channel, EdgeType::ReadAfterWrite);
+			readers[channel].push_back(i);
+		}
+
+		for (const auto &channel : pass.outputs)
+		{
+			for (uint32_t reader : readers[channel])
+			{
+				if (reader != i) addEdge(reader, i, channel, EdgeType::WriteAfterRead);
+			}
+
+			// If we also read this channel, the read-after-write edge above already orders us after the old writer
+			auto writer = lastWriter.find(channel);
+			if (writer != lastWriter.end() && writer->second != i && !contains(pass.inputs, channel))
+				addEdge(writer->second, i, channel, EdgeType::WriteAfterWrite);
+
+			lastWriter[channel] = i;
+			readers[channel].clear();
+		}
+	}
+}
+
+void PassGraph::cullPasses(const std::vector<PassDesc>& passes, const std::vector<std::string>& sinkChannels)
+{
+	// Classic backwards liveness over the pass list.  A pass survives if it writes a channel someone downstream
+	//     still needs.  Channels read before they are written (temporal history, e.g. SVGF's previous-frame buffers)
+	//     are needed from the *previous* frame, so we wrap around and iterate until the set of channels live at the
+	//     start of the frame stops changing.
+	std::set<std::string> liveAtFrameStart;
+	uint32_t maxIterations = uint32_t(passes.size()) + 2;
+
+	for (uint32_t iter = 0; iter < maxIterations; iter++)
+	{
+		std::set<std::string> live(sinkChannels.begin(), sinkChannels.end());
+		live.insert(liveAtFrameStart.begin(), liveAtFrameStart.end());
+		mIsLive.assign(passes.size(), false);
+
+		for (int32_t i = int32_t(passes.size()) - 1; i >= 0; i--)
+		{
+			const PassDesc &pass = passes[i];
+
+			bool isNeeded = !pass.declared;
+			for (const auto &channel : pass.outputs)
+				isNeeded = isNeeded || (live.count(channel) > 0);
+			if (!isNeeded) continue;
+
+			mIsLive[i] = true;
+
+			// Anything we fully overwrite is no longer needed from earlier passes; anything we read now is.
+			for (const auto &channel : pass.outputs)
+				if (!contains(pass.inputs, channel)) live.erase(channel);
+			live.insert(pass.inputs.begin(), pass.inputs.end());
+		}
+
+		if (live == liveAtFrameStart) break;
+		liveAtFrameStart = live;
+	}
+}
+
+void PassGraph::validateReads(const std::vector<PassDesc>& passes, const std::vector<std::string>& externalChannels)
+{
+	std::unordered_set<std::string> written(externalChannels.begin(), externalChannels.end());
+
+	for (uint32_t i = 0; i < uint32_t(passes.size()); i++)
+	{
+		if (!mIsLive[i]) continue;
+		const PassDesc &pass = passes[i];
+
+		for (const auto &channel : pass.inputs)
+		{
+			// Already produced this frame, or something the pass maintains itself across frames?  All good.
+			if (written.count(channel) > 0 || contains(pass.outputs, channel)) continue;
+
+			// Is there a later writer?  Then we are (perhaps unintentionally) consuming last frame's data.
+			std::string laterWriter;
+			for (uint32_t j = i + 1; j < uint32_t(passes.size()) && laterWriter.empty(); j++)
+			{
+				if (mIsLive[j] && contains(passes[j].outputs, channel)) laterWriter = passes[j].name;
+			}
+
+			if (!laterWriter.empty())
+				mMessages.push_back("'" + pass.name + "' reads '" + channel + "' before '" + laterWriter + "' writes it (sees previous frame)");
+			else
+				mMessages.push_back("'" + pass.name + "' reads '" + channel + "', which no active pass writes");
+		}
+
+		written.insert(pass.outputs.begin(), pass.outputs.end());
+	}
+
+	for (const auto &msg : mMessages)
+		logWarning("PassGraph: " + msg);
+}
+
+void PassGraph::computeTransitions(const std::vector<PassDesc>& passes)
+{
+	// The frame loops, so the state a channel is left in at the end of one frame is the state it starts the next
+	//     frame in.  Do one dry run to learn the end-of-frame states, then record transitions on the second run.
+	std::unordered_map<std::string, Resource::State> curState;
+
+	for (uint32_t run = 0; run < 2; run++)
+	{
+		bool record = (run == 1);
+
+		for (uint32_t i = 0; i < uint32_t(passes.size()); i++)
+		{
+			if (!mIsLive[i]) continue;
+			const PassDesc &pass = passes[i];
+
+			auto require = [&](const std::string &channel, Resource::State state)
+			{
+				auto cur = curState.find(channel);
+				if (cur != curState.end() && cur->second == state) return;
+				curState[channel] = state;
+				if (record) mTransitions[i].push_back({ channel, state });
+			};
+
+			for (const auto &channel : pass.inputs)
+			{
+				// Read-modify-write channels are transitioned by the pass itself as it goes
+				if (contains(pass.outputs, channel)) continue;
+				require(channel, Resource::State::ShaderResource);
+			}
+
+			for (size_t j = 0; j < pass.outputs.size(); j++)
+			{
+				const std::string &channel = pass.outputs[j];
+				if (contains(pass.inputs, channel))
+				{
+					// We don't know what state the pass leaves this channel in, so force a transition on the next use
+					curState.erase(channel);
+					continue;
+				}
+				require(channel, pass.getOutputState(j));
+			}
+		}
+	}
+
+	for (const auto &list : mTransitions)
+		mTransitionCount += uint32_t(list.size());
+}
@@ -0,0 +1,134 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include "Falcor.h"
+#include "Utils/DirectedGraph.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using namespace Falcor;
+
+/** Compiles the ordered list of passes in a RenderingPipeline into a dependency graph over ResourceManager channels.
+
+    Each pass describes the channels it reads and the channels it writes.  From this, compile() builds a DirectedGraph
+    (one node per pass, node ID == index in the pass list) with an edge for each read-after-write, write-after-read
+    and write-after-write hazard, then:
+       1) culls passes whose outputs never reach one of the sink channels (e.g., a debug view nobody displays),
+       2) reports channels that are read before anyone writes them this frame, and
+       3) derives the minimal list of resource transitions to issue before each surviving pass.
+
+    This class never touches the GPU, so it can be exercised entirely on the CPU.
+*/
+class PassGraph : public std::enable_shared_from_this<PassGraph>
+{
+public:
+	using SharedPtr = std::shared_ptr<PassGraph>;
+	using SharedConstPtr = std::shared_ptr<const PassGraph>;
+
+	/** What the pipeline knows about one pass when compiling the graph.
+	*/
+	struct PassDesc
+	{
+		std::string               name;                                             ///< Used for diagnostics only
+		std::vector<std::string>  inputs;                                           ///< Channels this pass reads
+		std::vector<std::string>  outputs;                                          ///< Channels this pass writes
+		std::vector<Resource::State> outputStates;                                  ///< How each output gets written (RTV, UAV, DSV); RTV if missing
+		bool                      declared = true;                                  ///< Passes that declared nothing are never culled
+
+		Resource::State getOutputState(size_t i) const { return i < outputStates.size() ? outputStates[i] : Resource::State::RenderTarget; }
+	};
+
+	/** The kind of hazard an edge in the graph represents.
+	*/
+	enum class EdgeType
+	{
+		ReadAfterWrite,     ///< The destination consumes data the source produced
+		WriteAfterRead,     ///< The destination overwrites data the source still needs to read
+		WriteAfterWrite,    ///< Both write the same channel; the destination's result must win
+	};
+
+	struct EdgeData
+	{
+		std::string channel;
+		EdgeType    type;
+	};
+
+	/** A state change for one channel that should happen right before a pass executes.
+	*/
+	struct Transition
+	{
+		std::string     channel;
+		Resource::State state;
+	};
+
+	static SharedPtr create() { return SharedPtr(new PassGraph()); }
+	virtual ~PassGraph() = default;
+
+	/** Build the graph.
+	    \param[in] passes Passes in pipeline order.  Empty (null) slots of the pipeline should not be included.
+	    \param[in] sinkChannels Channels that must be valid at the end of the frame (usually just the pipeline output).
+	    \param[in] externalChannels Channels that are valid without any pass writing them (e.g., the environment map).
+	    \return false if the graph could not be compiled (in which case the pipeline should run every pass in order).
+	*/
+	bool compile(const std::vector<PassDesc>& passes, const std::vector<std::string>& sinkChannels, const std::vector<std::string>& externalChannels = {});
+
+	// Passes that should run this frame, as indices into the list given to compile(), in execution order
+	const std::vector<uint32_t>& getExecutionOrder() const { return mExecutionOrder; }
+
+	// Is the pass with the specified index culled?
+	bool isCulled(uint32_t passIdx) const { return passIdx < mIsLive.size() ? !mIsLive[passIdx] : false; }
+	uint32_t getCulledPassCount() const { return uint32_t(mIsLive.size() - mExecutionOrder.size()); }
+	uint32_t getPassCount() const { return uint32_t(mIsLive.size()); }
+
+	// Did the pass with the specified index declare its channels?  (If not, the graph has no edges for it.)
+	bool isDeclared(uint32_t passIdx) const { return passIdx < mIsDeclared.size() ? mIsDeclared[passIdx] : false; }
+
+	// Transitions to issue before the pass with the specified index executes (empty for culled passes)
+	const std::vector<Transition>& getTransitions(uint32_t passIdx) const;
+	uint32_t getTransitionCount() const { return mTransitionCount; }
+
+	// Read-before-write and similar diagnostics produced by the last call to compile()
+	const std::vector<std::string>& getMessages() const { return mMessages; }
+
+	// The compiled dependency graph, plus the channel/hazard carried by each edge
+	DirectedGraph::SharedPtr getGraph() const { return mpGraph; }
+	const EdgeData& getEdgeData(uint32_t edgeId) const { return mEdgeData.at(edgeId); }
+
+	// Did the last call to compile() succeed?
+	bool isCompiled() const { return mIsCompiled; }
+
+protected:
+	PassGraph() = default;
+
+	void buildEdges(const std::vector<PassDesc>& passes);
+	void cullPasses(const std::vector<PassDesc>& passes, const std::vector<std::string>& sinkChannels);
+	void validateReads(const std::vector<PassDesc>& passes, const std::vector<std::string>& externalChannels);
+	void computeTransitions(const std::vector<PassDesc>& passes);
+
+	DirectedGraph::SharedPtr                    mpGraph;
+	std::unordered_map<uint32_t, EdgeData>      mEdgeData;          ///< Keyed by DirectedGraph edge ID
+	std::vector<bool>                           mIsLive;            ///< Per pass; false if the pass was culled
+	std::vector<bool>                           mIsDeclared;        ///< Per pass; copied from PassDesc::declared
+	std::vector<uint32_t>                       mExecutionOrder;
+	std::vector<std::vector<Transition>>        mTransitions;       ///< Per pass
+	std::vector<std::string>                    mMessages;
+	uint32_t                                    mTransitionCount = 0;
+	bool                                        mIsCompiled = false;
+};
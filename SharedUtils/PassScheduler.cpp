@@ -0,0 +1,227 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "PassScheduler.h"
+#include <algorithm>
+
+bool PassScheduler::build(const PassGraph::SharedPtr& pGraph, const std::vector<bool>& asyncCapable)
+{
+	// Start from a clean slate
+	mFences.clear();
+	mExecutionOrder.clear();
+	for (uint32_t q = 0; q < uint32_t(Queue::Count); q++)
+	{
+		mQueuePasses[q].clear();
+		mLastWaited[q] = -1;
+	}
+
+	uint32_t passCount = pGraph ? pGraph->getPassCount() : 0;
+	mQueues.assign(passCount, Queue::Graphics);
+	mQueuePosition.assign(passCount, 0);
+
+	if (!pGraph || !pGraph->isCompiled()) return false;
+	mExecutionOrder = pGraph->getExecutionOrder();
+
+	// Without a matching list of async-capable passes, keep everything on the graphics queue
+	bool useAsync = (asyncCapable.size() == passCount);
+
+	// Assign queues.  Passes that did not declare their channels have no edges in the graph, so we cannot tell
+	//     what they depend on; they stay on the graphics queue and act as a full join with the async queue.
+	for (uint32_t passIdx : mExecutionOrder)
+	{
+		Queue queue = (useAsync && asyncCapable[passIdx] && pGraph->isDeclared(passIdx)) ? Queue::Async : Queue::Graphics;
+		mQueues[passIdx] = queue;
+		mQueuePosition[passIdx] = uint32_t(mQueuePasses[uint32_t(queue)].size());
+		mQueuePasses[uint32_t(queue)].push_back(passIdx);
+	}
+
+	DirectedGraph::SharedPtr pDag = pGraph->getGraph();
+	uint32_t lastUndeclared = kFrameStart;
+	for (uint32_t execIdx = 0; execIdx < uint32_t(mExecutionOrder.size()); execIdx++)
+	{
+		uint32_t dst = mExecutionOrder[execIdx];
+		Queue dstQueue = mQueues[dst];
+
+		// Find the live passes we depend on.  Culled passes do not run, but their hazards still order the passes
+		//     around them (e.g., a reads 'x', culled c overwrites 'x', b overwrites 'x' ==> b must wait for a), so
+		//     walk through them to the nearest live predecessors.
+		uint32_t bestSrc = kFrameStart;
+		std::string bestChannel;
+		std::vector<std::pair<uint32_t, std::string>> toVisit = { { dst, "" } };
+		std::vector<bool> visited(passCount, false);
+		while (!toVisit.empty())
+		{
+			uint32_t node = toVisit.back().first;
+			std::string channel = toVisit.back().second;
+			toVisit.pop_back();
+
+			const DirectedGraph::Node* pNode = pDag->getNode(node);
+			for (uint32_t i = 0; pNode && i < pNode->getIncomingEdgeCount(); i++)
+			{
+				uint32_t edgeId = pNode->getIncomingEdge(i);
+				uint32_t src = pDag->getEdge(edgeId)->getSourceNode();
+				if (visited[src]) continue;
+				visited[src] = true;
+
+				const std::string &edgeChannel = channel.empty() ? pGraph->getEdgeData(edgeId).channel : channel;
+				if (pGraph->isCulled(src))
+				{
+					toVisit.push_back({ src, edgeChannel });
+				}
+				else if (mQueues[src] != dstQueue)
+				{
+					// Queues run in order, so only the latest pass we depend on in the other queue matters
+					if (bestSrc == kFrameStart || mQueuePosition[src] > mQueuePosition[bestSrc])
+					{
+						bestSrc = src;
+						bestChannel = edgeChannel;
+					}
+				}
+			}
+		}
+
+		// Undeclared passes (always on the graphics queue) wait for all prior async work; async work after them waits on them
+		if (!pGraph->isDeclared(dst))
+		{
+			for (int32_t i = int32_t(execIdx) - 1; i >= 0; i--)
+			{
+				if (mQueues[mExecutionOrder[i]] != Queue::Async) continue;
+				if (bestSrc == kFrameStart || mQueuePosition[mExecutionOrder[i]] > mQueuePosition[bestSrc])
+				{
+					bestSrc = mExecutionOrder[i];
+					bestChannel = "";
+				}
+				break;
+			}
+			lastUndeclared = dst;
+		}
+		else if (dstQueue == Queue::Async && lastUndeclared != kFrameStart &&
+			     (bestSrc == kFrameStart || mQueuePosition[lastUndeclared] > mQueuePosition[bestSrc]))
+		{
+			bestSrc = lastUndeclared;
+			bestChannel = "";
+		}
+
+		// The first async pass must not start before the graphics queue is done with last frame's use of its outputs.
+		//     Waiting on any graphics pass from this frame guarantees that.
+		if (dstQueue == Queue::Async && bestSrc == kFrameStart && mLastWaited[uint32_t(Queue::Async)] < 0)
+		{
+			for (int32_t i = int32_t(execIdx) - 1; i >= 0; i--)
+			{
+				if (mQueues[mExecutionOrder[i]] == Queue::Graphics)
+				{
+					bestSrc = mExecutionOrder[i];
+					break;
+				}
+			}
+			if (bestSrc == kFrameStart)
+			{
+				mFences.push_back({ kFrameStart, dst, Queue::Graphics, Queue::Async, "" });
+				mLastWaited[uint32_t(Queue::Async)] = 0;
+				continue;
+			}
+		}
+
+		if (bestSrc != kFrameStart) addWait(bestSrc, dst, bestChannel);
+	}
+
+	// Join the async queue back into the graphics queue before the frame ends (i.e., before we present)
+	const auto &asyncPasses = mQueuePasses[uint32_t(Queue::Async)];
+	if (!asyncPasses.empty() && mLastWaited[uint32_t(Queue::Graphics)] < int64_t(asyncPasses.size()) - 1)
+	{
+		mFences.push_back({ asyncPasses.back(), kFrameEnd, Queue::Async, Queue::Graphics, "" });
+		mLastWaited[uint32_t(Queue::Graphics)] = int64_t(asyncPasses.size()) - 1;
+	}
+
+	return true;
+}
+
+void PassScheduler::addWait(uint32_t srcPass, uint32_t dstPass, const std::string &channel)
+{
+	Queue srcQueue = getQueue(srcPass);
+	Queue dstQueue = getQueue(dstPass);
+	if (srcQueue == dstQueue) return;
+
+	// Already waited on this pass (or a later one on the same queue)?  Then the wait is redundant.
+	int64_t position = int64_t(getQueuePosition(srcPass));
+	if (position <= mLastWaited[uint32_t(dstQueue)]) return;
+
+	mFences.push_back({ srcPass, dstPass, srcQueue, dstQueue, channel });
+	mLastWaited[uint32_t(dstQueue)] = position;
+}
+
+std::vector<uint32_t> PassScheduler::getWaits(uint32_t passIdx) const
+{
+	std::vector<uint32_t> waits;
+	for (uint32_t i = 0; i < uint32_t(mFences.size()); i++)
+	{
+		if (mFences[i].waitPass == passIdx) waits.push_back(i);
+	}
+	return waits;
+}
+
+bool PassScheduler::needsSignal(uint32_t passIdx) const
+{
+	for (const auto &fence : mFences)
+	{
+		if (fence.signalPass == passIdx) return true;
+	}
+	return false;
+}
+
+PassScheduler::Timeline PassScheduler::simulate(const std::vector<double>& passCost, double fenceLatency, double asyncSlowdown) const
+{
+	Timeline timeline;
+	timeline.passStart.assign(mQueues.size(), 0.0);
+	timeline.passEnd.assign(mQueues.size(), 0.0);
+
+	double queueFree[uint32_t(Queue::Count)] = { 0.0, 0.0 };
+
+	// Waits only ever refer to passes earlier in the execution order, so one pass over it is enough
+	for (uint32_t passIdx : mExecutionOrder)
+	{
+		uint32_t queue = uint32_t(mQueues[passIdx]);
+		double cost = (passIdx < passCost.size()) ? passCost[passIdx] : 0.0;
+		timeline.serialTime += cost;
+		if (mQueues[passIdx] == Queue::Async) cost *= asyncSlowdown;
+
+		double start = queueFree[queue];
+		for (const auto &fence : mFences)
+		{
+			if (fence.waitPass != passIdx) continue;
+			double signaled = (fence.signalPass == kFrameStart) ? 0.0 : timeline.passEnd[fence.signalPass];
+			start = std::max(start, signaled + fenceLatency);
+		}
+
+		timeline.passStart[passIdx] = start;
+		timeline.passEnd[passIdx] = start + cost;
+		timeline.queueBusy[queue] += cost;
+		queueFree[queue] = start + cost;
+	}
+
+	// The frame is over once the graphics queue has joined with the async queue
+	timeline.frameTime = queueFree[uint32_t(Queue::Graphics)];
+	for (const auto &fence : mFences)
+	{
+		if (fence.waitPass == kFrameEnd)
+			timeline.frameTime = std::max(timeline.frameTime, timeline.passEnd[fence.signalPass] + fenceLatency);
+	}
+	timeline.frameTime = std::max(timeline.frameTime, queueFree[uint32_t(Queue::Async)]);
+
+	return timeline;
+}
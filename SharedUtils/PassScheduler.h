@@ -0,0 +1,122 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+#include "PassGraph.h"
+#include <string>
+#include <vector>
+
+/** Assigns the passes of a compiled PassGraph to hardware queues and works out where cross-queue fences are needed.
+
+    Passes marked as async-capable (ray tracing or compute only; no rasterization or blits) go on the async queue;
+    everything else stays on the graphics queue.  Each queue executes its passes in pipeline order, so a pass only
+    needs to wait on another queue when the graph has a hazard edge crossing queues.  Waits that are implied by an
+    earlier wait (on the same or a later pass of the other queue) are dropped.
+
+    simulate() predicts the resulting overlap from per-pass costs (e.g., measured GPU times from the profiler), so
+    queue assignments can be evaluated (and tested) without a GPU.
+
+    RenderingPipeline runs the schedule for real: Queue::Async passes go to a compute queue (see AsyncQueue), and each
+    fence is a signal after its signalPass and a GPU-side wait before its waitPass.
+*/
+class PassScheduler : public std::enable_shared_from_this<PassScheduler>
+{
+public:
+	using SharedPtr = std::shared_ptr<PassScheduler>;
+	using SharedConstPtr = std::shared_ptr<const PassScheduler>;
+
+	enum class Queue : uint32_t
+	{
+		Graphics = 0,
+		Async    = 1,
+		Count
+	};
+
+	static const uint32_t kFrameStart = 0xFFFFFFFEu;   ///< Used as Fence::signalPass for "whatever the other queue finished last frame"
+	static const uint32_t kFrameEnd   = 0xFFFFFFFFu;   ///< Used as Fence::waitPass for the end-of-frame join back to the graphics queue
+
+	/** One signal/wait pair.  The queue running signalPass signals once it completes; the queue running waitPass
+	    waits on that signal before starting it.
+	*/
+	struct Fence
+	{
+		uint32_t    signalPass;
+		uint32_t    waitPass;
+		Queue       signalQueue;
+		Queue       waitQueue;
+		std::string channel;        ///< The channel causing the hazard (for display; empty for frame start/end)
+	};
+
+	/** Predicted execution of one frame.
+	*/
+	struct Timeline
+	{
+		std::vector<double> passStart;                         ///< Per pass (culled passes start and end at 0)
+		std::vector<double> passEnd;
+		double              queueBusy[uint32_t(Queue::Count)] = { 0.0, 0.0 };
+		double              frameTime = 0.0;                   ///< When the last queue finishes
+		double              serialTime = 0.0;                  ///< Cost of running every pass back to back on one queue
+	};
+
+	static SharedPtr create() { return SharedPtr(new PassScheduler()); }
+	virtual ~PassScheduler() = default;
+
+	/** Build a schedule.
+	    \param[in] pGraph A compiled pass graph.
+	    \param[in] asyncCapable Per pass (same indexing as the graph), can this pass run on the async queue?
+	    \return false if the graph is not compiled or the sizes do not match (everything then runs on the graphics queue).
+	*/
+	bool build(const PassGraph::SharedPtr& pGraph, const std::vector<bool>& asyncCapable);
+
+	Queue getQueue(uint32_t passIdx) const { return passIdx < mQueues.size() ? mQueues[passIdx] : Queue::Graphics; }
+	const std::vector<uint32_t>& getQueuePasses(Queue queue) const { return mQueuePasses[uint32_t(queue)]; }
+	uint32_t getAsyncPassCount() const { return uint32_t(mQueuePasses[uint32_t(Queue::Async)].size()); }
+
+	// All fences, in the order their waits occur
+	const std::vector<Fence>& getFences() const { return mFences; }
+
+	// Indices into getFences() to wait on before the specified pass runs (use kFrameEnd for the end-of-frame join)
+	std::vector<uint32_t> getWaits(uint32_t passIdx) const;
+
+	// Does the specified pass need to signal a fence once it completes?
+	bool needsSignal(uint32_t passIdx) const;
+
+	/** Predict how one frame executes.
+	    \param[in] passCost Per pass cost (any unit, usually milliseconds).  Missing entries count as zero.
+	    \param[in] fenceLatency Extra delay added to every cross-queue wait.
+	    \param[in] asyncSlowdown Scales the cost of passes on the async queue, to model the two queues competing for the
+	               same shader cores (1.0 == perfect overlap).
+	*/
+	Timeline simulate(const std::vector<double>& passCost, double fenceLatency = 0.0, double asyncSlowdown = 1.0) const;
+
+protected:
+	PassScheduler() = default;
+
+	// Adds a wait on <srcPass> before <dstPass> unless an earlier wait already covers it
+	void addWait(uint32_t srcPass, uint32_t dstPass, const std::string &channel);
+
+	// Position of a pass within its queue's submission order
+	uint32_t getQueuePosition(uint32_t passIdx) const { return passIdx < mQueuePosition.size() ? mQueuePosition[passIdx] : 0; }
+
+	std::vector<Queue>                 mQueues;                                 ///< Per pass
+	std::vector<uint32_t>              mQueuePosition;                          ///< Per pass
+	std::vector<uint32_t>              mQueuePasses[uint32_t(Queue::Count)];    ///< Per queue, in submission order
+	std::vector<Fence>                 mFences;
+	std::vector<uint32_t>              mExecutionOrder;
+	int64_t                            mLastWaited[uint32_t(Queue::Count)];     ///< Per waiting queue, last position waited on in the other queue
+};
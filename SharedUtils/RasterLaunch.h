@@ -65,6 +65,10 @@ public:
 	// When the Falcor scene you're using changes, make sure to tell us!
 	void setScene(Scene::SharedPtr pScene);
 
+	// Draw the scene with your own scene renderer (e.g., one that culls differently) instead of the default one
+	//     setScene() creates.  Calling setScene() again goes back to the default.
+	void setSceneRenderer(SceneRenderer::SharedPtr pSceneRenderer) { mpSceneRenderer = pSceneRenderer; }
+
 	// Execute the shader.
 	void execute(RenderContext::SharedPtr pRenderContext, GraphicsState::SharedPtr pGfxState, const Fbo::SharedPtr &pTargetFbo);
     void execute(RenderContext* pRenderContext, GraphicsState::SharedPtr pGfxState, const Fbo::SharedPtr &pTargetFbo);
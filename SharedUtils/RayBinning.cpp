@@ -0,0 +1,92 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "RayBinning.h"
+
+namespace RayBinning
+{
+	uint32_t directionOctant(const glm::vec3& dir)
+	{
+		return (dir.x < 0.0f ? 1u : 0u) | (dir.y < 0.0f ? 2u : 0u) | (dir.z < 0.0f ? 4u : 0u);
+	}
+
+	uint32_t mortonCode(const glm::vec3& pos, const glm::vec3& sceneMin, const glm::vec3& sceneExtent)
+	{
+		const float cellsPerAxis = float(1u << kMortonBitsPerAxis);
+		uint32_t cell[3];
+		for (int i = 0; i < 3; i++)
+		{
+			float t = (pos[i] - sceneMin[i]) / std::max(sceneExtent[i], 1e-6f) * cellsPerAxis;
+			cell[i] = uint32_t(std::min(std::max(t, 0.0f), cellsPerAxis - 1.0f));
+		}
+
+		uint32_t code = 0;
+		for (uint32_t b = 0; b < kMortonBitsPerAxis; b++)
+		{
+			code |= ((cell[0] >> b) & 1u) << (3 * b + 0);
+			code |= ((cell[1] >> b) & 1u) << (3 * b + 1);
+			code |= ((cell[2] >> b) & 1u) << (3 * b + 2);
+		}
+		return code;
+	}
+
+	uint32_t binKey(const glm::vec3& origin, const glm::vec3& dir, const glm::vec3& sceneMin, const glm::vec3& sceneExtent)
+	{
+		return (directionOctant(dir) << (3 * kMortonBitsPerAxis)) | mortonCode(origin, sceneMin, sceneExtent);
+	}
+
+	std::vector<uint32_t> sortByKey(const std::vector<uint32_t>& keys, std::vector<uint32_t>* binOffsets)
+	{
+		// Histogram of keys
+		std::vector<uint32_t> offsets(kBinCount, 0);
+		for (uint32_t key : keys)
+		{
+			if (key < kBinCount) offsets[key]++;
+		}
+
+		// Exclusive prefix sum gives where each bin starts in the sorted list
+		uint32_t total = 0;
+		for (uint32_t& o : offsets)
+		{
+			uint32_t count = o;
+			o = total;
+			total += count;
+		}
+		if (binOffsets) *binOffsets = offsets;
+
+		// Scatter.  Walking rays in launch order keeps the sort stable.
+		std::vector<uint32_t> sorted(total);
+		for (uint32_t i = 0; i < uint32_t(keys.size()); i++)
+		{
+			if (keys[i] < kBinCount) sorted[offsets[keys[i]]++] = i;
+		}
+		return sorted;
+	}
+
+	float directionCoherence(const std::vector<glm::vec3>& dirs, const std::vector<uint32_t>& order)
+	{
+		if (order.size() < 2) return 1.0f;
+
+		double sum = 0.0;
+		for (size_t i = 1; i < order.size(); i++)
+		{
+			sum += glm::dot(dirs[order[i - 1]], dirs[order[i]]);
+		}
+		return float(sum / double(order.size() - 1));
+	}
+};
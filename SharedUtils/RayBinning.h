@@ -0,0 +1,60 @@
+/**********************************************************************************************************************
+# Copyright (c) 2018, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+# following conditions are met:
+#  * Redistributions of code must retain the copyright notice, this list of conditions and the following disclaimer.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its contributors may be used to endorse or promote products
+#    derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT
+# SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#pragma once
+
+#include "Falcor.h"
+
+/** CPU reference for the ray binning used to sort reflection rays for coherent tracing (see
+    HybridRenderingPipeline/Data/rayBinning.hlsli for the HLSL version, which must compute identical keys).
+
+    Each ray gets a 15-bit key: the 3-bit octant of its direction on top of a 12-bit Morton code of its origin
+    within the scene bounds.  Rays are then counting-sorted by key, which groups rays that head the same way from
+    nearby points.  This is the same sort the GPU does with a histogram, a prefix sum over bins and a scatter; the
+    bin ranges match exactly, though the GPU scatter uses atomics so the order of rays inside a bin may differ.
+*/
+namespace RayBinning
+{
+	static const uint32_t kMortonBitsPerAxis = 4;
+	static const uint32_t kBinCount = 1u << (3 + 3 * kMortonBitsPerAxis);
+	static const uint32_t kInvalidKey = 0xFFFFFFFFu;
+
+	/** Which of the 8 octants does this direction point into?  (Bit i is set if component i is negative.)
+	*/
+	uint32_t directionOctant(const glm::vec3& dir);
+
+	/** Morton code of a position quantized to a (2^kMortonBitsPerAxis)^3 grid over [sceneMin, sceneMin+sceneExtent]
+	*/
+	uint32_t mortonCode(const glm::vec3& pos, const glm::vec3& sceneMin, const glm::vec3& sceneExtent);
+
+	/** The full sort key of a ray
+	*/
+	uint32_t binKey(const glm::vec3& origin, const glm::vec3& dir, const glm::vec3& sceneMin, const glm::vec3& sceneExtent);
+
+	/** Stable counting sort of rays by key.  Rays with kInvalidKey (i.e., no geometry to reflect from) are dropped.
+	        \param[in] keys Key of each ray, indexed by launch order
+	        \param[out] binOffsets If non-null, the exclusive prefix sum of the per-bin counts (kBinCount entries)
+	        \return Launch indices of the valid rays, in sorted order
+	*/
+	std::vector<uint32_t> sortByKey(const std::vector<uint32_t>& keys, std::vector<uint32_t>* binOffsets = nullptr);
+
+	/** A simple measure of how coherent a ray ordering is:  the mean cosine between the directions of consecutive
+	    rays.  1 means every ray matches its neighbor; random directions average around 0.
+	*/
+	float directionCoherence(const std::vector<glm::vec3>& dirs, const std::vector<uint32_t>& order);
+};
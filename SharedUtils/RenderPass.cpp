@@ -18,6 +18,7 @@
 
 #include "RenderPass.h"
 #include "Externals/dear_imgui/imgui.h"
+#include <algorithm>
 
 using namespace Falcor;
 
@@ -60,3 +61,33 @@ void ::RenderPass::onShutdown()
     }
     mIsInitialized = false;
 }
+
+// protected
+
+void ::RenderPass::declareInputs(const std::vector<std::string>& channels)
+{
+    for (const auto& channel : channels)
+    {
+        if (std::find(mInputChannels.begin(), mInputChannels.end(), channel) == mInputChannels.end())
+            mInputChannels.push_back(channel);
+    }
+}
+
+void ::RenderPass::declareOutputs(const std::vector<std::string>& channels, Resource::State writeState)
+{
+    for (const auto& channel : channels)
+    {
+        if (std::find(mOutputChannels.begin(), mOutputChannels.end(), channel) == mOutputChannels.end())
+        {
+            mOutputChannels.push_back(channel);
+            mOutputStates.push_back(writeState);
+        }
+    }
+}
+
+void ::RenderPass::clearDeclaredChannels()
+{
+    mInputChannels.clear();
+    mOutputChannels.clear();
+    mOutputStates.clear();
+}
@@ -58,10 +58,16 @@ public:
 	virtual bool usesRasterization()  { return false; }      // Will your pass rasterize a scene?
 	virtual bool usesRayTracing()     { return false; }      // Will your pass ray trace a scene?
 	virtual bool usesCompute()        { return false; }      // Will your pass use a compute pass?
+	virtual bool canRunAsync()        { return false; }      // Can your pass run on an async queue?  (Only ray tracing / compute work; no rasterization or blits)
+	virtual bool canRecordInParallel() { return false; }     // Can your pass record on a worker thread?  (Only touches its declared channels and its own resources; no scene or profiler events)
 	virtual bool appliesPostprocess() { return false; }      // Does your pass apply a postprocess?
 	virtual bool usesEnvironmentMap() { return false; }      // Does your pass use an environment map?
 	virtual bool hasAnimation()       { return true;  }      // Controls if "freeze animation" GUI is shown (should generally leave as true)
 
+	// Which group's resolution does your pass render at, for dynamic resolution?  Its GPU time is charged to that group.  (Passes
+	//     whose cost doesn't depend on the resolution, e.g. probe updates, return ResolutionGroup::Count.)
+	virtual ResourceManager::ResolutionGroup getResolutionGroup() { return ResourceManager::ResolutionGroup::GBuffer; }
+
 
     //
     // Public interface. These functions call corresponding virtual protected interface functions.
@@ -185,6 +191,22 @@ public:
     */
     void resetRebindFlag() { mRebindFlag = false; }
 
+    /** Returns the ResourceManager channels this pass reads, as declared via declareInputs().
+    */
+    const std::vector<std::string>& getInputChannels() const { return mInputChannels; }
+
+    /** Returns the ResourceManager channels this pass writes, as declared via declareOutputs().
+    */
+    const std::vector<std::string>& getOutputChannels() const { return mOutputChannels; }
+
+    /** Returns the resource state each output channel is written in (parallel to getOutputChannels()).
+    */
+    const std::vector<Falcor::Resource::State>& getOutputStates() const { return mOutputStates; }
+
+    /** Returns true if this pass has declared any channels.  Passes that do not are never culled by the pipeline.
+    */
+    bool hasDeclaredChannels() const { return !mInputChannels.empty() || !mOutputChannels.empty(); }
+
 protected:
     /** Constructor.
         \param[in] name The name of the render pass.
@@ -204,6 +226,19 @@ protected:
     */
     void setRebindFlag() { mRebindFlag = true; }
 
+    /** Declare channels this pass reads.  The pipeline uses these to build its pass dependency graph, which
+        decides which passes can be culled and what resource transitions are needed.
+    */
+    void declareInputs(const std::vector<std::string>& channels);
+
+    /** Declare channels this pass writes, and how it writes them (render target, UAV, or depth-stencil).
+    */
+    void declareOutputs(const std::vector<std::string>& channels, Falcor::Resource::State writeState = Falcor::Resource::State::RenderTarget);
+
+    /** Forget all declared channels (e.g., before re-declaring them when a UI selection changes).
+    */
+    void clearDeclaredChannels();
+
 private:
     // Internal state
     std::string mName;                          ///< Name of the render pass.
@@ -215,6 +250,10 @@ private:
     bool mRefreshFlag = true;                   ///< User flag that is automatically reset after execute().
     bool mRebindFlag = true;                    ///< User flag that is manually reset by calling resetRebindFlag().
 
+    std::vector<std::string> mInputChannels;                ///< Channels declared via declareInputs()
+    std::vector<std::string> mOutputChannels;               ///< Channels declared via declareOutputs()
+    std::vector<Falcor::Resource::State> mOutputStates;     ///< How each of mOutputChannels is written
+
 protected:
     ResourceManager::SharedPtr mpResManager;    ///< All passes will need to talk to the resource manager, so will need to stash a copy
 };
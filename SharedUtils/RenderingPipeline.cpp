@@ -20,11 +20,20 @@
 #include "RenderingPipeline.h"
 #include "Externals/dear_imgui/imgui.h"
 #include "SceneLoaderWrapper.h"
+#include "AsyncQueue.h"
+#include "ParallelRecorder.h"
 #include <algorithm>
 
 namespace {
 	const char     *kNullPassDescriptor = "< None >";   ///< Name used in dropdown lists when no pass is selected.
 	const uint32_t  kNullPassId = 0xFFFFFFFFu;          ///< Id used to represent the null pass (using -1).
+	const char     *kSceneMemoryOwner = "Scene";        ///< GpuMemoryTracker owner for the scene, its models and acceleration structures
+	const char     *kSceneAccelerationChannel = "__SceneAcceleration";  ///< Pass graph channel written by every ray tracing pass (never a real resource)
+
+	// GpuMemoryTracker owner for everything a pass allocates itself (private FBOs, history buffers, ...)
+	std::string getMemoryOwner(::RenderPass* pPass) { return "Pass/" + pPass->getName(); }
+
+	double toMB(uint64_t bytes) { return double(bytes) / (1024.0 * 1024.0); }
 };
 
 
@@ -52,12 +61,20 @@ void RenderingPipeline::onLoad(SampleCallbacks* pSample, const RenderContext::Sh
 	mpResourceManager = ResourceManager::create(mLastKnownSize.x, mLastKnownSize.y, pSample);
 	mOutputBufferIndex = mpResourceManager->requestTextureResource(ResourceManager::kOutputChannel);
 
+	// Async-capable passes run on a compute queue (if the device gave us one; see run())
+	mpAsyncQueue = AsyncQueue::create(pRenderContext);
+
+	// Worker threads for the passes that can record in parallel (leave a core for this thread)
+	uint32_t workerCount = std::min(4u, std::max(1u, std::thread::hardware_concurrency()) - 1);
+	if (workerCount > 0) mpParallelRecorder = ParallelRecorder::create(pRenderContext, workerCount);
+
 	// Initialize all of the RenderPasses we have available to select for our pipeline
 	for (uint32_t i = 0; i < mAvailPasses.size(); i++)
 	{
 		if (mAvailPasses[i])
 		{
 			// Initialize.  If failure, remove this pass from the list.
+			GpuMemoryTracker::Scope _memScope(getMemoryOwner(mAvailPasses[i].get()));
 			bool initialized = mAvailPasses[i]->onInitialize(pRenderContext.get(), mpResourceManager);
 			if (!initialized) mAvailPasses[i] = nullptr;
 		}
@@ -93,6 +110,12 @@ void RenderingPipeline::onLoad(SampleCallbacks* pSample, const RenderContext::Sh
 	// We're going to create a default graphics state
 	mpDefaultGfxState = GraphicsState::create();
 
+	// The pass graph gets compiled the first time we render (and whenever the pipeline changes)
+	mpPassGraph = PassGraph::create();
+	mpPassScheduler = PassScheduler::create();
+	mpRecordingStats = CpuRecordingStats::create();
+	createDynamicResolution();
+
 	// If we've requested to have an environment map... 
 	if (mPipeUsesEnvMap)
 	{
@@ -221,7 +244,122 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
     for (auto &p : mPassAvgTime) {
       pGui->addText(p.first + std::to_string(p.second));
     }
+    if (mpPassScheduler && mpPassScheduler->getAsyncPassCount() > 0) {
+      pGui->addText("Predicted with an async queue: " + std::to_string(mPredictedTimeline.frameTime) +
+                    " (serial: " + std::to_string(mPredictedTimeline.serialTime) + ")");
+    }
+    if (mpRecordingStats) {
+      // CPU recording time per executed pass (and the thread that recorded it), plus the per-thread totals.  Passes
+      // recorded by the parallel recorder's workers show up under the worker's thread; the rest under the main thread.
+      pGui->addText("CPU recording (ms):");
+      for (auto &pass : mpRecordingStats->getPassStats()) {
+        pGui->addText("  [thread " + std::to_string(pass.threadIdx) + "] " + pass.name + " " + std::to_string(pass.avgMs));
+      }
+      std::vector<double> threadTimes = mpRecordingStats->getThreadTimes();
+      for (uint32_t i = 0; i < threadTimes.size(); i++) {
+        pGui->addText("  thread " + std::to_string(i) + (i == 0 ? " (main): " : ": ") + std::to_string(threadTimes[i]));
+      }
+      uint32_t workers = std::max(1u, std::thread::hardware_concurrency());
+      pGui->addText("  perfectly balanced over " + std::to_string(workers) + " threads: " +
+                    std::to_string(mpRecordingStats->predictParallelRecording(workers)));
+    }
   }
+
+	// Who owns the GPU memory (shared channels, passes, the scene) and how it compares to the budget
+	{
+		GpuMemoryTracker::Report report = GpuMemoryTracker::getReport();
+		char buf[256];
+		pGui->addText("");
+		sprintf_s(buf, "GPU memory: %.1f MB (peak %.1f MB)", toMB(report.liveBytes), toMB(report.peakBytes));
+		pGui->addText(buf);
+		pGui->addIntVar("Memory budget (MB)", mGpuMemoryBudgetMB, 0);
+		if (mGpuMemoryBudgetMB > 0 && report.liveBytes > uint64_t(mGpuMemoryBudgetMB) * 1024 * 1024)
+		{
+			pGui->addText("     Over budget!");
+		}
+		pGui->addCheckBox("Show memory by owner", mShowMemoryReport);
+		if (mShowMemoryReport)
+		{
+			for (auto& owner : report.owners)
+			{
+				sprintf_s(buf, "     %s: %.1f MB (peak %.1f MB, %u tex, %u buf)", owner.name.c_str(), toMB(owner.liveBytes), toMB(owner.peakBytes), owner.textureCount, owner.bufferCount);
+				pGui->addText(buf);
+			}
+		}
+		if (pGui->addButton("Save memory report"))
+		{
+			std::string resolution = std::to_string(mLastKnownSize.x) + "x" + std::to_string(mLastKnownSize.y);
+			std::string filename = "GpuMemory_" + resolution + ".json";
+			if (!GpuMemoryTracker::dumpJson(filename, resolution))
+			{
+				logWarning("RenderingPipeline: Unable to write " + filename);
+			}
+		}
+	}
+
+	// Dynamic resolution: the scale each group of passes renders at to hit the frame time target (needs the profiler's pass times)
+	pGui->addText("");
+	if (pGui->addCheckBox("Dynamic resolution", mDynamicResolution))
+	{
+		mpDynamicResolution->reset();
+	}
+	if (mDynamicResolution)
+	{
+		DynamicResolution::Settings settings = mpDynamicResolution->getSettings();
+		if (pGui->addFloatVar("Target frame time (ms)", settings.targetMs, 1.0f, 100.0f))
+		{
+			mpDynamicResolution->setSettings(settings);
+		}
+		if (!Falcor::gProfileEnabled)
+		{
+			pGui->addText("     Show the profiling window (P) to measure the passes");
+		}
+		char buf[256];
+		sprintf_s(buf, "     Frame: %.2f ms (predicted %.2f ms, %.2f ms outside the groups)", mpDynamicResolution->getFrameTime(),
+		          mpDynamicResolution->getPredictedFrameTime(), mpDynamicResolution->getFixedTime());
+		pGui->addText(buf);
+		for (uint32_t i = 0; i < mpDynamicResolution->getGroupCount(); i++)
+		{
+			uvec2 size = mpResourceManager->getRenderSize(ResourceManager::ResolutionGroup(i));
+			sprintf_s(buf, "     %s: %.2f (%ux%u)", mpDynamicResolution->getGroupDesc(i).name.c_str(), mpDynamicResolution->getScale(i), size.x, size.y);
+			pGui->addText(buf);
+		}
+	}
+
+	// How scene textures are loaded.  Takes effect for the next scene that is loaded.
+	bool cookTextures = TextureCooker::isEnabled();
+	if (pGui->addCheckBox("Load cooked BC textures (next scene)", cookTextures))
+	{
+		TextureCooker::setEnabled(cookTextures);
+	}
+	bool streamTextures = TextureStreamer::isEnabled();
+	if (pGui->addCheckBox("Stream texture mips (next scene)", streamTextures))
+	{
+		TextureStreamer::setEnabled(streamTextures);
+	}
+
+	// Texture streaming: resident memory vs. budget, and what's still waiting to be loaded
+	if (mpTextureStreamer)
+	{
+		const TextureStreamer::Stats& stats = mpTextureStreamer->getStats();
+		char buf[256];
+		sprintf_s(buf, "Streamed textures: %u, %.1f MB resident (%.1f MB requested)", stats.textureCount, toMB(stats.residentBytes), toMB(stats.requestedBytes));
+		pGui->addText(buf);
+		sprintf_s(buf, "     %u pending (%u loading, %u over budget), %llu evictions", stats.pendingRequests, stats.inFlightRequests, stats.deniedRequests, (unsigned long long)stats.evictions);
+		pGui->addText(buf);
+		sprintf_s(buf, "     Budget pressure: %.2f", stats.getBudgetPressure());
+		pGui->addText(buf);
+		if (pGui->addIntVar("Texture budget (MB)", mTextureBudgetMB, 16))
+		{
+			mpTextureStreamer->setBudget(uint64_t(mTextureBudgetMB) * 1024 * 1024);
+		}
+		float mipBias = mpTextureStreamer->getMipBias();
+		if (pGui->addFloatVar("Texture mip bias", mipBias, -2.0f, 4.0f))
+		{
+			mpTextureStreamer->setMipBias(mipBias);
+		}
+	}
+
 #ifdef _DEBUG
 	pGui->addSeparator();
 
@@ -234,7 +372,11 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
 		{
 			// A wrapper function to open a window, load a UI, and do some sanity checking
 			Fbo::SharedPtr outputFBO = pSample->getCurrentFbo();
-			RtScene::SharedPtr loadedScene = loadScene(uvec2(outputFBO->getWidth(), outputFBO->getHeight()));
+			RtScene::SharedPtr loadedScene;
+			{
+				GpuMemoryTracker::Scope _memScope(kSceneMemoryOwner);
+				loadedScene = loadScene(uvec2(outputFBO->getWidth(), outputFBO->getHeight()));
+			}
 
 			// We have a method that explicitly initializes all render passes given our new scene.
 			if (loadedScene)
@@ -351,6 +493,7 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
             pGui->pushWindow(mActivePasses[i]->getGuiName().c_str(),guiSz.x, guiSz.y, guiPos.x, guiPos.y, true, true);
 
 			// Render the pass' GUI to this new UI window, then pop the new UI window.
+			GpuMemoryTracker::Scope _memScope(getMemoryOwner(mActivePasses[i].get()));
 			mActivePasses[i]->onRenderGui(pGui);
 			pGui->popWindow();
 		}
@@ -387,6 +530,35 @@ void RenderingPipeline::onGuiRender(SampleCallbacks* pSample, Gui* pGui)
 		}
 	}
 
+	// Show what the pass graph decided to do with the current pipeline
+	if (mpPassGraph && mpPassGraph->isCompiled())
+	{
+		pGui->addText("");
+		pGui->addCheckBox("Cull passes with unused outputs", mCullUnusedPasses);
+		pGui->addText((std::string("     Culled passes: ") + std::to_string(mpPassGraph->getCulledPassCount()) +
+			           std::string(", transitions: ") + std::to_string(mpPassGraph->getTransitionCount())).c_str());
+		if (mpAsyncQueue && pGui->addCheckBox("Run ray tracing on an async compute queue", mUseAsyncQueue))
+		{
+			schedulePasses();
+		}
+		if (mpParallelRecorder)
+		{
+			pGui->addCheckBox(("Record passes on " + std::to_string(mpParallelRecorder->getThreadCount()) + " worker threads").c_str(), mRecordInParallel);
+		}
+		pGui->addText((std::string("     Async passes: ") + std::to_string(mpPassScheduler->getAsyncPassCount()) +
+			           std::string(", fences: ") + std::to_string(mpPassScheduler->getFences().size())).c_str());
+		for (auto& fence : mpPassScheduler->getFences())
+		{
+			std::string signal = (fence.signalPass < mGraphPasses.size()) ? mGraphPasses[fence.signalPass]->getName() : "<last frame>";
+			std::string wait = (fence.waitPass < mGraphPasses.size()) ? mGraphPasses[fence.waitPass]->getName() : "<end of frame>";
+			pGui->addText(("     " + signal + " -> " + wait + (fence.channel.empty() ? "" : " (" + fence.channel + ")")).c_str());
+		}
+		for (auto& msg : mpPassGraph->getMessages())
+		{
+			pGui->addText(("     " + msg).c_str());
+		}
+	}
+
     pGui->addText("");
     pGui->addSeparator();
     pGui->addText(Falcor::gProfileEnabled ? "Press (P):  Hide profiling window" : "Press (P):  Show profiling window");
@@ -586,6 +758,8 @@ void RenderingPipeline::changePass(uint32_t passNum, ::RenderPass::SharedPtr pNe
 	// Do any activation of the newly selected pass (if it's non-null)
 	if (pNewPass)
 	{
+		GpuMemoryTracker::Scope _memScope(getMemoryOwner(pNewPass.get()));
+
 		// Ensure the pass knows the correct size
 		pNewPass->onResize(mLastKnownSize.x, mLastKnownSize.y);
 
@@ -612,7 +786,11 @@ void RenderingPipeline::onFirstRun(SampleCallbacks* pSample)
 	// Did the user ask for us to load a scene by default?
 	if (mPipeNeedsDefaultScene)
 	{
-		RtScene::SharedPtr loadedScene = loadScene(mLastKnownSize, mpResourceManager->getDefaultSceneName().c_str());
+		RtScene::SharedPtr loadedScene;
+		{
+			GpuMemoryTracker::Scope _memScope(kSceneMemoryOwner);
+			loadedScene = loadScene(mLastKnownSize, mpResourceManager->getDefaultSceneName().c_str());
+		}
 		if (loadedScene) onInitNewScene(pSample->getRenderContext().get(), loadedScene);
 	}
 
@@ -638,7 +816,14 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 	{
 		// Make sure we're updateing the correct camera, then update the scene
 		mpCameraControl->attachCamera(mpScene->getActiveCamera() ? mpScene->getActiveCamera() : nullptr);
+		GpuMemoryTracker::Scope _memScope(kSceneMemoryOwner);
 		mpScene->update(pSample->getCurrentTime(), mpCameraControl.get());
+
+		// Stream in the texture mips the current view needs (and evict the ones it doesn't)
+		if (mpTextureStreamer)
+		{
+			mpTextureStreamer->update(pRenderContext.get(), mpScene->getActiveCamera().get(), mLastKnownSize.y);
+		}
 	}
 
 	// Check if the pipeline has changed since last frame and needs updating
@@ -650,6 +835,7 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 		{
 			if (mActivePasses[passNum])
 			{
+				GpuMemoryTracker::Scope _memScope(getMemoryOwner(mActivePasses[passNum].get()));
 				mActivePasses[passNum]->onPipelineUpdate( mpResourceManager );
 			}
 		}
@@ -657,6 +843,12 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 		// Update our flags
 		updatePipelineRequirementFlags();
 		updatedPipeline = true;
+
+		// Passes may have re-declared their channels, so figure out which ones we actually need to run
+		compilePassGraph();
+
+		// The controller's cost estimates were for the old passes
+		if (mpDynamicResolution) mpDynamicResolution->reset();
 	}
 
 	// Check if any passes have set their refresh flag
@@ -667,39 +859,140 @@ void RenderingPipeline::onFrameRender(SampleCallbacks* pSample, const RenderCont
 		{
 			if (mActivePasses[passNum])
 			{
+				GpuMemoryTracker::Scope _memScope(getMemoryOwner(mActivePasses[passNum].get()));
 				mActivePasses[passNum]->onStateRefresh();
 			}
 		}
 		mGlobalPipeRefresh = false;
 	}
 
-    // Execute all of the passes in the current pipeline
-    for (uint32_t passNum = 0; passNum < mActivePasses.size(); passNum++)
+    // Latch this frame's render sizes (and remember last frame's, for passes that reproject)
+    mpResourceManager->beginFrame();
+
+    // Start the worker threads on the passes that can record in parallel.  The first frame after the pipeline changed
+    //     records everything on this thread, so programs, views and the framework's shared objects get created before
+    //     several threads use them.
+    mpRecordingStats->beginFrame();
+    bool recordInParallel = mRecordInParallel && mpParallelRecorder && mpPassGraph->isCompiled() && !mRecordSerially;
+    if (recordInParallel)
     {
-        if (mActivePasses[passNum])
+        mpParallelRecorder->beginFrame(createRecordingJobs());
+    }
+    mRecordSerially = false;
+
+    // Execute all of the passes in the current pipeline (skipping any the pass graph culled)
+    for (uint32_t passNum = 0; passNum < mGraphPasses.size(); passNum++)
+    {
+        if (mCullUnusedPasses && mpPassGraph->isCompiled() && mpPassGraph->isCulled(passNum)) continue;
+
+        // Which queue does this pass run on, and what does it have to wait for there?
+        PassScheduler::Queue queue = mpAsyncQueue ? mpPassScheduler->getQueue(passNum) : PassScheduler::Queue::Graphics;
+        RenderContext::SharedPtr pPassContext = mpAsyncQueue ? mpAsyncQueue->getContext(queue) : pRenderContext;
+        if (mpAsyncQueue)
+        {
+            for (uint32_t fence : mpPassScheduler->getWaits(passNum))
+            {
+                mpAsyncQueue->wait(mpPassScheduler->getFences()[fence].waitQueue);
+            }
+        }
+
+        // Move any channels this pass touches into the state it needs, all at once (in one barrier batch), before it starts.
+        //     A pass recorded on a worker thread started from the states all its channels are in when it executes, so
+        //     transition every one of them (not just those the graph knows to change).
+        bool recordedByWorker = recordInParallel && mpParallelRecorder->hasJob(passNum);
+        if (mpPassGraph->isCompiled())
+        {
+            std::vector<CopyContext::Transition> barriers;
+            if (recordedByWorker)
+            {
+                for (const auto& state : getChannelStates(passNum)) barriers.push_back({ state.first, state.second });
+            }
+            else
+            {
+                for (const auto& transition : mpPassGraph->getTransitions(passNum))
+                {
+                    if (transition.channel == kSceneAccelerationChannel) continue;
+                    Texture::SharedPtr pTex = mpResourceManager->getTexture(transition.channel);
+                    if (pTex) barriers.push_back({ pTex.get(), transition.state });
+                }
+            }
+            if (mpAsyncQueue) mpAsyncQueue->transition(queue, barriers);
+            else if (barriers.size()) pRenderContext->resourceBarriers(barriers);
+        }
+
+        std::string passName = mGraphPasses[passNum]->getName();
+        if (recordedByWorker)
+        {
+            // Submits what this thread recorded so far, then the pass (inside its profiling event)
+            mpParallelRecorder->submit(passNum);
+        }
+        else
         {
-            std::string passName = mActivePasses[passNum]->getName();
+            CpuRecordingStats::ScopedTimer _recordTimer(mpRecordingStats.get(), passNum, passName);
+            GpuMemoryTracker::Scope _memScope(getMemoryOwner(mGraphPasses[passNum].get()));
+
+            // Whatever the framework records on its own while an async pass executes (clears, uploads, TLAS updates)
+            //     has to go into that pass' context too
+            std::unique_ptr<AsyncQueue::Scope> pAsyncScope;
+            if (queue == PassScheduler::Queue::Async) pAsyncScope.reset(new AsyncQueue::Scope(mpAsyncQueue.get()));
+
             if (Falcor::gProfileEnabled)
             {
                 // Insert a per-pass profiling event.  
                 assert(passNum < mProfileNames.size());
                 Falcor::ProfilerEvent _profileEvent(passName.c_str());
-                mActivePasses[passNum]->onExecute(pRenderContext.get());
+                mGraphPasses[passNum]->onExecute(pPassContext.get());
             }
             else
             {
-                mActivePasses[passNum]->onExecute(pRenderContext.get());
-            }
-            if (Falcor::gProfileEnabled) {
-                mPassAvgTime[passName] = Profiler::getEventGpuTime(passName.c_str());
+                mGraphPasses[passNum]->onExecute(pPassContext.get());
             }
         }
+
+        // Submit the pass, so the other queue can wait for it
+        if (mpAsyncQueue && mpPassScheduler->needsSignal(passNum))
+        {
+            mpAsyncQueue->signal(queue);
+        }
+        if (Falcor::gProfileEnabled) {
+            mPassAvgTime[passName] = Profiler::getEventGpuTime(passName.c_str());
+        }
     }
+    if (recordInParallel) mpParallelRecorder->endFrame();
+    mpRecordingStats->endFrame();
+
+    // Join the async queue back into the graphics queue before anything else (GUI, present) gets recorded
+    if (mpAsyncQueue)
+    {
+        for (uint32_t fence : mpPassScheduler->getWaits(PassScheduler::kFrameEnd))
+        {
+            mpAsyncQueue->wait(mpPassScheduler->getFences()[fence].waitQueue);
+        }
+        mpAsyncQueue->endFrame();
+    }
+
+	// Predict how much the async queue saves, given what each pass cost on the GPU.  (Culled passes didn't run this
+	//     frame, so their last measured times are stale.)
+	if (Falcor::gProfileEnabled)
+	{
+		std::vector<double> passCosts;
+		for (uint32_t passNum = 0; passNum < mGraphPasses.size(); passNum++)
+		{
+			bool culled = mCullUnusedPasses && mpPassGraph->isCompiled() && mpPassGraph->isCulled(passNum);
+			passCosts.push_back(culled ? 0.0 : mPassAvgTime[mGraphPasses[passNum]->getName()]);
+		}
+		mPredictedTimeline = mpPassScheduler->simulate(passCosts);
+	}
+
+	// Pick the render scales of the next frame from this frame's pass times
+	updateDynamicResolution();
 
-	// Now that we're done rendering, grab out output texture and blit it into our target FBO
+	// Now that we're done rendering, grab out output texture and blit it into our target FBO.  Unless a temporal upscaler
+	//     reconstructed the whole screen, passes only filled the top-left render-sized corner of it, so this also (bilinearly) upscales.
 	if (pTargetFbo && mpResourceManager->getTexture(mOutputBufferIndex))
 	{
-		pRenderContext->blit(mpResourceManager->getTexture(mOutputBufferIndex)->getSRV(), pTargetFbo->getColorTexture(0)->getRTV());
+		pRenderContext->blit(mpResourceManager->getTexture(mOutputBufferIndex)->getSRV(), pTargetFbo->getColorTexture(0)->getRTV(),
+		                     mpResourceManager->getOutputRect(), uvec4(-1));
 	}
 
 	// Once we're done rendering, clear the pipeline dirty state.
@@ -715,11 +1008,24 @@ void RenderingPipeline::onInitNewScene(RenderContext* pRenderContext, Scene::Sha
 	if (pScene) 
 		mpScene = pScene;
 
+	// Scene textures were loaded with their low-resolution mips only. Let the streamer bring in the rest.
+	if (pScene && TextureStreamer::isEnabled())
+	{
+		if (!mpTextureStreamer) mpTextureStreamer = TextureStreamer::create(uint64_t(mTextureBudgetMB) * 1024 * 1024);
+		mpTextureStreamer->setScene(pScene);
+	}
+	else if (pScene)
+	{
+		// Streaming was turned off before this scene loaded, so its textures are complete
+		mpTextureStreamer = nullptr;
+	}
+
 	// When a new scene is loaded, we'll tell all our passes about it (not just active passes)
 	for (uint32_t i = 0; i < mAvailPasses.size(); i++)
 	{
 		if (mAvailPasses[i])
 		{
+			GpuMemoryTracker::Scope _memScope(getMemoryOwner(mAvailPasses[i].get()));
 			mAvailPasses[i]->onInitScene(pRenderContext, pScene);
 		}
 	}
@@ -739,15 +1045,20 @@ void RenderingPipeline::onResizeSwapChain(SampleCallbacks* pSample, uint32_t wid
 	{
 		mpResourceManager->resize(width, height);
 	}
+	if (mpDynamicResolution) mpDynamicResolution->reset();
 
 	// We're only going to resize render passes that are active.  Other passes will get resized when activated.
 	for (uint32_t i = 0; i < mActivePasses.size(); i++)
 	{
 		if (mActivePasses[i])
 		{
+			GpuMemoryTracker::Scope _memScope(getMemoryOwner(mActivePasses[i].get()));
 			mActivePasses[i]->onResize(width, height);
 		}
 	}
+
+	// Peak memory is tracked per resolution, so start over once everything has been reallocated at the new size
+	GpuMemoryTracker::resetPeaks();
 }
 
 void RenderingPipeline::onShutdown(SampleCallbacks* pSample)
@@ -761,6 +1072,20 @@ void RenderingPipeline::onShutdown(SampleCallbacks* pSample)
 			mAvailPasses[i]->onShutdown();
 		}
 	}
+
+	// The workers' command lists go on the graphics queue; wait for them before their contexts go away
+	if (mpParallelRecorder)
+	{
+		gpDevice->getRenderContext()->flush(true);
+		mpParallelRecorder = nullptr;
+	}
+
+	// Don't let the device go away under work still in flight on the compute queue
+	if (mpAsyncQueue)
+	{
+		mpAsyncQueue->getContext(PassScheduler::Queue::Async)->flush(true);
+		mpAsyncQueue = nullptr;
+	}
 }
 
 bool RenderingPipeline::onKeyEvent(SampleCallbacks* pSample, const KeyboardEvent& keyEvent)
@@ -806,6 +1131,70 @@ bool RenderingPipeline::canAddPassAfter(uint32_t passNum)
 	return (mEnableAddRemove[passNum] & UIOptions::CanAddAfter) != 0x0u;
 }
 
+void RenderingPipeline::createDynamicResolution(void)
+{
+	// Groups are added in ResourceManager::ResolutionGroup order, so the indices match.  Ray-traced visibility and reflections
+	//     are scaled relative to the G-buffer (i.e., rays per pixel); reflections can only be traced at full or half resolution.
+	//     Denoisers filter every G-buffer pixel, so they just follow it.
+	mpDynamicResolution = DynamicResolution::create();
+
+	DynamicResolution::GroupDesc gbuffer;
+	gbuffer.name = "G-buffer";
+	uint32_t gbufferGroup = mpDynamicResolution->addGroup(gbuffer);
+
+	DynamicResolution::GroupDesc visibility;
+	visibility.name = "Visibility";
+	visibility.parent = gbufferGroup;
+	mpDynamicResolution->addGroup(visibility);
+
+	DynamicResolution::GroupDesc reflection;
+	reflection.name = "Reflection";
+	reflection.scaleStep = 0.5f;
+	reflection.priority = 0.5f;
+	reflection.parent = gbufferGroup;
+	mpDynamicResolution->addGroup(reflection);
+
+	DynamicResolution::GroupDesc denoise;
+	denoise.name = "Denoise";
+	denoise.minScale = 1.0f;
+	denoise.parent = gbufferGroup;
+	mpDynamicResolution->addGroup(denoise);
+}
+
+void RenderingPipeline::updateDynamicResolution(void)
+{
+	const uint32_t groupCount = uint32_t(ResourceManager::ResolutionGroup::Count);
+	if (!mDynamicResolution)
+	{
+		for (uint32_t i = 0; i < groupCount; i++)
+		{
+			mpResourceManager->setRenderScale(ResourceManager::ResolutionGroup(i), 1.0f);
+		}
+		return;
+	}
+
+	// We need the per-pass GPU times, which we only have while profiling
+	if (!Falcor::gProfileEnabled) return;
+
+	float frameMs = 0.0f;
+	std::vector<float> groupMs(groupCount, 0.0f);
+	for (uint32_t passNum = 0; passNum < mGraphPasses.size(); passNum++)
+	{
+		if (mCullUnusedPasses && mpPassGraph->isCompiled() && mpPassGraph->isCulled(passNum)) continue;
+		float passMs = float(mPassAvgTime[mGraphPasses[passNum]->getName()]);
+		frameMs += passMs;
+
+		ResourceManager::ResolutionGroup group = mGraphPasses[passNum]->getResolutionGroup();
+		if (group != ResourceManager::ResolutionGroup::Count) groupMs[uint32_t(group)] += passMs;
+	}
+
+	mpDynamicResolution->update(frameMs, groupMs);
+	for (uint32_t i = 0; i < groupCount; i++)
+	{
+		mpResourceManager->setRenderScale(ResourceManager::ResolutionGroup(i), mpDynamicResolution->getScale(i));
+	}
+}
+
 void RenderingPipeline::getActivePasses(std::vector<::RenderPass::SharedPtr>& activePasses) const
 {
     activePasses.clear();
@@ -840,6 +1229,108 @@ bool RenderingPipeline::anyRequestedPipelineChanges(void)
 	return mPipelineChanged;
 }
 
+void RenderingPipeline::compilePassGraph(void)
+{
+	// Describe each (non-null) active pass, in pipeline order, using the channels it declared
+	getActivePasses(mGraphPasses);
+	std::vector<PassGraph::PassDesc> passDescs;
+	for (auto& pPass : mGraphPasses)
+	{
+		PassGraph::PassDesc desc;
+		desc.name = pPass->getName();
+		desc.inputs = pPass->getInputChannels();
+		desc.outputs = pPass->getOutputChannels();
+		desc.outputStates = pPass->getOutputStates();
+		desc.declared = pPass->hasDeclaredChannels();
+
+		// Ray tracing passes share the scene's acceleration structure, which RtScene rebuilds or refits in place on
+		//     demand.  Have them all write a pseudo channel, so they stay ordered even when on different queues.
+		if (desc.declared && pPass->usesRayTracing())
+		{
+			desc.outputStates.resize(desc.outputs.size(), Resource::State::RenderTarget);
+			desc.outputs.push_back(kSceneAccelerationChannel);
+			desc.outputStates.push_back(Resource::State::UnorderedAccess);
+		}
+		passDescs.push_back(desc);
+	}
+
+	// Only the pipeline output gets displayed.  The environment map is loaded from disk, not rendered by a pass.
+	if (!mpPassGraph->compile(passDescs, { ResourceManager::kOutputChannel }, { ResourceManager::kEnvironmentMap }))
+	{
+		logWarning("RenderingPipeline: Unable to compile the pass graph; executing all passes in order");
+	}
+
+	schedulePasses();
+
+	// Pass indices may have shifted, so old CPU timings no longer line up
+	mpRecordingStats->reset();
+	mRecordSerially = true;
+}
+
+void RenderingPipeline::schedulePasses(void)
+{
+	// Decide which passes run on the async queue, and where the queues need to synchronize.  Without a compute queue
+	//     everything stays on the graphics queue (and the profiling window's prediction has nothing to overlap).
+	std::vector<bool> asyncCapable;
+	for (auto& pPass : mGraphPasses)
+	{
+		asyncCapable.push_back(mUseAsyncQueue && mpAsyncQueue && pPass->canRunAsync());
+	}
+	mpPassScheduler->build(mpPassGraph, asyncCapable);
+}
+
+Resource::StateMap RenderingPipeline::getChannelStates(uint32_t passNum)
+{
+	// The states the pass graph puts the pass' channels in.  A channel the pass both reads and writes is left in its write
+	//     state; the pass transitions it as it goes.
+	Resource::StateMap states;
+	const auto& pPass = mGraphPasses[passNum];
+	for (const auto& channel : pPass->getInputChannels())
+	{
+		Texture::SharedPtr pTex = mpResourceManager->getTexture(channel);
+		if (pTex) states[pTex.get()] = Resource::State::ShaderResource;
+	}
+	const auto& outputs = pPass->getOutputChannels();
+	const auto& outputStates = pPass->getOutputStates();
+	for (size_t i = 0; i < outputs.size(); i++)
+	{
+		Texture::SharedPtr pTex = mpResourceManager->getTexture(outputs[i]);
+		if (pTex) states[pTex.get()] = (i < outputStates.size()) ? outputStates[i] : Resource::State::RenderTarget;
+	}
+	return states;
+}
+
+std::vector<ParallelRecorder::Job> RenderingPipeline::createRecordingJobs(void)
+{
+	// Last frames' recording times balance the workers
+	std::unordered_map<uint32_t, double> recordingMs;
+	for (const auto& pass : mpRecordingStats->getPassStats()) recordingMs[pass.passIdx] = pass.avgMs;
+
+	std::vector<ParallelRecorder::Job> jobs;
+	for (uint32_t passNum = 0; passNum < mGraphPasses.size(); passNum++)
+	{
+		const auto& pPass = mGraphPasses[passNum];
+		if (mCullUnusedPasses && mpPassGraph->isCulled(passNum)) continue;
+		if (!pPass->canRecordInParallel() || !pPass->hasDeclaredChannels()) continue;
+		if (mpAsyncQueue && mpPassScheduler->getQueue(passNum) != PassScheduler::Queue::Graphics) continue;
+
+		ParallelRecorder::Job job;
+		job.passIdx = passNum;
+		job.name = pPass->getName();
+		job.channelStates = getChannelStates(passNum);
+		job.cost = recordingMs.count(passNum) ? recordingMs[passNum] : 0.1;
+		CpuRecordingStats* pStats = mpRecordingStats.get();
+		job.record = [pPass, passNum, pStats](RenderContext* pContext)
+		{
+			CpuRecordingStats::ScopedTimer _recordTimer(pStats, passNum, pPass->getName());
+			GpuMemoryTracker::Scope _memScope(getMemoryOwner(pPass.get()));
+			pPass->onExecute(pContext);
+		};
+		jobs.push_back(std::move(job));
+	}
+	return jobs;
+}
+
 bool RenderingPipeline::havePassesSetRefreshFlag(void)
 {
 	bool refreshFlag = false;
@@ -901,5 +1392,8 @@ void RenderingPipeline::extractProfilingData(void)
 void RenderingPipeline::run(RenderingPipeline *pipe, SampleConfig &config)
 {
 	pipe->updatePipelineRequirementFlags();
+
+	// One compute queue, for the passes PassScheduler puts on the async queue
+	config.deviceDesc.cmdQueues[uint32_t(LowLevelContextData::CommandQueueType::Compute)] = 1;
 	Sample::run(config, std::unique_ptr<Renderer>(pipe));
 }
\ No newline at end of file
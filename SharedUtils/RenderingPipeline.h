@@ -20,6 +20,11 @@
 #include "Falcor.h"
 #include "RenderPass.h"
 #include "ResourceManager.h"
+#include "PassGraph.h"
+#include "PassScheduler.h"
+#include "AsyncQueue.h"
+#include "ParallelRecorder.h"
+#include "CpuRecordingStats.h"
 #include <unordered_map>
 
 class RenderingPipeline : public Renderer, inherit_shared_from_this<Renderer, RenderingPipeline>
@@ -115,6 +120,20 @@ private:
 	// Extract profiling data
 	void extractProfilingData(void);
 
+	// Rebuild the pass dependency graph from the channels declared by the active passes
+	void compilePassGraph(void);
+
+	// Re-assign the compiled graph's passes to queues, e.g. when the async toggle changes
+	void schedulePasses(void);
+
+	// The states the pass graph puts a pass' channels in, and this frame's passes for the parallel recorder
+	Resource::StateMap getChannelStates(uint32_t passNum);
+	std::vector<ParallelRecorder::Job> createRecordingJobs(void);
+
+	// Set up the dynamic resolution groups, and pick the next frame's render scales from the pass times
+	void createDynamicResolution(void);
+	void updateDynamicResolution(void);
+
 	enum UIOptions { CanRemove = 0x1u, CanAddAfter = 0x2u };
 
 	// Internal state
@@ -143,6 +162,38 @@ private:
 	std::vector< double > mProfileGPUTimes;
   std::vector< double > mProfileLastGPUTimes;
 
+	// Pass dependency graph, rebuilt whenever the pipeline changes
+	PassGraph::SharedPtr mpPassGraph;
+	std::vector<::RenderPass::SharedPtr> mGraphPasses;      ///< Active passes (without gaps) in the order given to mpPassGraph
+	bool mCullUnusedPasses = true;                          ///< Skip passes whose outputs never reach the pipeline output?
+
+	// Queue assignment for the compiled pass graph, plus its predicted timeline (from measured per-pass GPU times).  Passes
+	//     assigned to the async queue get recorded into, and submitted on, mpAsyncQueue's compute context.
+	PassScheduler::SharedPtr mpPassScheduler;
+	PassScheduler::Timeline mPredictedTimeline;
+	AsyncQueue::SharedPtr mpAsyncQueue;                     ///< nullptr if the device has no compute queue
+	bool mUseAsyncQueue = true;                             ///< Let async-capable passes run on the async compute queue?
+
+	// CPU time each pass spends recording commands (and on which thread)
+	CpuRecordingStats::SharedPtr mpRecordingStats;
+
+	// Worker threads recording the passes that can record in parallel, each into its own command list
+	ParallelRecorder::SharedPtr mpParallelRecorder;         ///< nullptr on single-core machines
+	bool mRecordInParallel = true;
+	bool mRecordSerially = true;                            ///< Record everything on the main thread next frame (e.g., after the pipeline changed)
+
+	// GPU memory accounting (see GpuMemoryTracker); 0 means no budget
+	int32_t mGpuMemoryBudgetMB = 0;
+	bool mShowMemoryReport = false;
+
+	// Render scales picked to hit a frame time target, from the measured pass times (see DynamicResolution)
+	DynamicResolution::SharedPtr mpDynamicResolution;
+	bool mDynamicResolution = false;
+
+	// Scene texture mips streamed within a budget (only created when TextureStreamer is enabled)
+	TextureStreamer::SharedPtr mpTextureStreamer;
+	int32_t mTextureBudgetMB = 512;
+
 	// Are we storing an environment map?
 	Gui::DropdownList mEnvMapSelector;
 
@@ -22,11 +22,55 @@
 const std::string ResourceManager::kOutputChannel  = "PipelineOutput";
 const std::string ResourceManager::kEnvironmentMap = "EnvironmentMap";
 
+namespace {
+	// GpuMemoryTracker owner for a shared channel. Channels are shared by several passes, so they are reported separately.
+	std::string getMemoryOwner(const std::string &channelName) { return "Channel/" + channelName; }
+};
+
 ResourceManager::SharedPtr ResourceManager::create(uint32_t width, uint32_t height, SampleCallbacks *callbacks)
 {
 	return SharedPtr(new ResourceManager(width, height, callbacks));
 }
 
+ResourceManager::ResourceManager(uint32_t width, uint32_t height, SampleCallbacks *callbacks) 
+	: mWidth(width), mHeight(height), mpAppCallbacks(callbacks)
+{
+	for (auto& size : mRenderSizes) size = uvec2(width, height);
+	mPrevRenderSize = uvec2(width, height);
+}
+
+void ResourceManager::setRenderScale(ResolutionGroup group, float scale)
+{
+	mRenderScales[uint32_t(group)] = glm::clamp(scale, 0.1f, 1.0f);
+}
+
+void ResourceManager::setUpscaling(bool enabled, float factor)
+{
+	mNextUpscaling = enabled;
+	mNextUpscaleFactor = glm::clamp(factor, 1.0f, 4.0f);
+}
+
+void ResourceManager::beginFrame()
+{
+	mUpscaling = mNextUpscaling;
+	mUpscaleFactor = mNextUpscaleFactor;
+	const float upscale = getUpscaleFactor();
+
+	mPrevRenderSize = mRenderSizes[uint32_t(ResolutionGroup::GBuffer)];
+	for (uint32_t i = 0; i < uint32_t(ResolutionGroup::Count); i++)
+	{
+		// Round up, so a scale of 1 is exactly the screen and no group ever gets an empty sub-rect
+		vec2 size = glm::ceil(vec2(mWidth, mHeight) * mRenderScales[i] / upscale);
+		mRenderSizes[i] = glm::clamp(uvec2(size), uvec2(1), uvec2(glm::max(mWidth, 1u), glm::max(mHeight, 1u)));
+	}
+}
+
+GraphicsState::Viewport ResourceManager::getRenderViewport(ResolutionGroup group) const
+{
+	uvec2 size = getRenderSize(group);
+	return GraphicsState::Viewport(0.0f, 0.0f, float(size.x), float(size.y), 0.0f, 1.0f);
+}
+
 void ResourceManager::resize(uint32_t width, uint32_t height)
 {
 	// Don't spend time resizing resources if we didn't change resolutions!
@@ -36,6 +80,10 @@ void ResourceManager::resize(uint32_t width, uint32_t height)
 	mWidth = width;
 	mHeight = height;
 
+	// There's no history to reproject across a resize, so start from the current scales as if they had always been used
+	beginFrame();
+	mPrevRenderSize = mRenderSizes[uint32_t(ResolutionGroup::GBuffer)];
+
 	// We can't really do anything with resources when the screen size is 0
 	if (mWidth <= 0 || mHeight <= 0) return;
 
@@ -50,6 +98,7 @@ void ResourceManager::resize(uint32_t width, uint32_t height)
 		if (mTextureSizes[i] != ivec2(-1, -1)) continue;
 
 		// Recreate our texture with the new size
+		GpuMemoryTracker::Scope _memScope(getMemoryOwner(mTextureNames[i]));
 		mTextures[i] = Texture::create2D(mWidth, mHeight, mTextureFormat[i], 1u, 1u, nullptr, mTextureFlags[i]);
 	}
 
@@ -67,7 +116,10 @@ void ResourceManager::initializeResources()
 
 		// Create the resource (unless it already exists, because a pass created it and passed it in to be managed)
 		if (!mTextures[i])
+		{
+			GpuMemoryTracker::Scope _memScope(getMemoryOwner(mTextureNames[i]));
 			mTextures[i] = Texture::create2D(texWidth, texHeight, mTextureFormat[i], 1u, 1u, nullptr, mTextureFlags[i]);
+		}
 	}
 
 	mIsInitialized = true;
@@ -76,12 +128,15 @@ void ResourceManager::initializeResources()
 
 bool ResourceManager::updateEnvironmentMap(const std::string &filename)
 {
+	GpuMemoryTracker::Scope _memScope(getMemoryOwner(ResourceManager::kEnvironmentMap));
+
 	// Pass in a NULL file?  Change to our default texture
 	if (filename == "")
 	{
 		Texture::SharedPtr tmpEnv = Texture::create2D(128, 128, ResourceFormat::RGBA32Float, 1u, 1u, nullptr, ResourceManager::kDefaultFlags);
 		mpAppCallbacks->getRenderContext()->clearUAV(tmpEnv->getUAV().get(), vec4(0.5f, 0.5f, 0.8f, 1.0f));
 		manageTextureResource(ResourceManager::kEnvironmentMap, tmpEnv);
+		mpEnvMapSampler = EnvMapSampler::create(mpAppCallbacks->getRenderContext(), tmpEnv);
 		mUpdatedFlag = true;
 		return true;
 	}
@@ -90,19 +145,24 @@ bool ResourceManager::updateEnvironmentMap(const std::string &filename)
 		Texture::SharedPtr tmpEnv = Texture::create2D(128, 128, ResourceFormat::RGBA32Float, 1u, 1u, nullptr, ResourceManager::kDefaultFlags);
 		mpAppCallbacks->getRenderContext()->clearUAV(tmpEnv->getUAV().get(), vec4(0.0f, 0.0f, 0.0f, 1.0f));
 		manageTextureResource(ResourceManager::kEnvironmentMap, tmpEnv);
+		mpEnvMapSampler = EnvMapSampler::create(mpAppCallbacks->getRenderContext(), tmpEnv);
 		mUpdatedFlag = true;
 		return true;
 	}
 	else
 	{
 		// Non null file?  Try to load it.
-		Texture::SharedPtr envMap = createTextureFromFile(filename, false, false);
+		Texture::SharedPtr envMap = TextureCooker::isEnabled() ? loadCookedEnvironmentMap(filename) : nullptr;
+		if (!envMap) envMap = createTextureFromFile(filename, false, false);
 		if (envMap)
 		{
 			// Success.  Update the filename we loaded and remember to manage this texture we just loaded.
 			size_t found = filename.find_last_of("/\\");
 			mEnvMapFilename = filename.substr(found + 1).c_str();
 			manageTextureResource(ResourceManager::kEnvironmentMap, envMap);
+
+			// Build the tables used to importance sample the map's bright regions
+			mpEnvMapSampler = EnvMapSampler::create(mpAppCallbacks->getRenderContext(), envMap);
 			mUpdatedFlag = true;
 			return true;
 		}
@@ -110,6 +170,20 @@ bool ResourceManager::updateEnvironmentMap(const std::string &filename)
 	return false;
 }
 
+Texture::SharedPtr ResourceManager::loadCookedEnvironmentMap(const std::string &filename)
+{
+	// Environment maps are HDR, so the cooker stores them as BC6H with their mips already built.  Load the whole chain 
+	//     ourselves, since createTextureFromFile() only uses cooked images when asked for mips, and would hand them to the streamer.
+	std::string cookedFile = TextureCooker::getCookedFile(filename, TextureCooker::getQuality());
+	DdsMipChain chain;
+	std::vector<uint8_t> texels;
+	if (cookedFile.empty() || !readDdsMipChain(cookedFile, false, chain) || !readDdsMips(chain, 0, chain.mipCount, texels)) return nullptr;
+
+	Texture::SharedPtr envMap = Texture::create2D(chain.width, chain.height, chain.format, 1u, chain.mipCount, texels.data(), Resource::BindFlags::ShaderResource);
+	if (envMap) envMap->setSourceFilename(filename);
+	return envMap;
+}
+
 uvec2 ResourceManager::getEnvironmentMapSize() const
 {
 	int32_t existingIndex = getTextureIndex(ResourceManager::kEnvironmentMap);
@@ -118,6 +192,32 @@ uvec2 ResourceManager::getEnvironmentMapSize() const
 	return uvec2( mTextureSizes[existingIndex] );
 }
 
+BlueNoise::SharedPtr ResourceManager::getBlueNoise()
+{
+	if (mpBlueNoise) return mpBlueNoise;
+
+	// The defaults are 64x64 masks over 16 frames, with two channels so 2D samples come from a single texel
+	BlueNoise::Desc desc;
+	std::string cacheFile = getExecutableDirectory() + "/BlueNoise" + std::to_string(desc.size) + "x" + std::to_string(desc.depth) + ".bin";
+	mpBlueNoise = BlueNoise::createFromFile(cacheFile);
+	if (!mpBlueNoise || mpBlueNoise->getDesc().size != desc.size || mpBlueNoise->getDesc().depth != desc.depth || mpBlueNoise->getDesc().channels != desc.channels)
+	{
+		mpBlueNoise = BlueNoise::create(desc);
+		mpBlueNoise->writeToFile(cacheFile);
+	}
+	return mpBlueNoise;
+}
+
+TypedBuffer<uint32_t>::SharedPtr ResourceManager::getSobolDirections()
+{
+	if (mpSobolDirections) return mpSobolDirections;
+
+	const std::vector<uint32_t>& directions = LowDiscrepancy::getSobolDirections();
+	mpSobolDirections = TypedBuffer<uint32_t>::create(uint32_t(directions.size()), Resource::BindFlags::ShaderResource);
+	mpSobolDirections->updateData(directions.data(), 0, directions.size() * sizeof(uint32_t));
+	return mpSobolDirections;
+}
+
 int32_t ResourceManager::manageTextureResource(const std::string &channelName, Texture::SharedPtr sharedTex)
 {
 	// See if we've already defined this channel
@@ -180,7 +280,8 @@ Texture::SharedPtr ResourceManager::getClearedTexture(const std::string &channel
 	Texture::SharedPtr channel = getTexture(channelName);
 	if (!channel) return nullptr;
 
-	mpAppCallbacks->getRenderContext()->clearUAV(channel->getUAV().get(), clearColor);
+	// Clear in whatever context the pass is being recorded into (e.g., one on the async compute queue), not the app's
+	gpDevice->getRenderContext()->clearUAV(channel->getUAV().get(), clearColor);
 	return channel;
 }
 
@@ -189,7 +290,7 @@ Texture::SharedPtr ResourceManager::getClearedTexture(int32_t channelIdx, vec4 &
 	Texture::SharedPtr channel = getTexture(channelIdx);
 	if (!channel) return nullptr;
 
-	mpAppCallbacks->getRenderContext()->clearUAV(channel->getUAV().get(), clearColor);
+	gpDevice->getRenderContext()->clearUAV(channel->getUAV().get(), clearColor);
 	return channel;
 }
 
@@ -200,11 +301,11 @@ void ResourceManager::clearTexture(Texture::SharedPtr &tex, const vec4 &clearCol
 
 	// Clear as appropriate.  If a depth texture, clear the depth with the red channel of the clear color
 	if ((flags & Resource::BindFlags::RenderTarget) == Resource::BindFlags::RenderTarget)
-		mpAppCallbacks->getRenderContext()->clearRtv(tex->getRTV().get(), clearColor);
+		gpDevice->getRenderContext()->clearRtv(tex->getRTV().get(), clearColor);
 	else if ((flags & Resource::BindFlags::UnorderedAccess) == Resource::BindFlags::UnorderedAccess)
-		mpAppCallbacks->getRenderContext()->clearUAV(tex->getUAV().get(), clearColor);
+		gpDevice->getRenderContext()->clearUAV(tex->getUAV().get(), clearColor);
 	else if ((flags & Resource::BindFlags::DepthStencil) == Resource::BindFlags::DepthStencil)
-		mpAppCallbacks->getRenderContext()->clearDsv(tex->getDSV().get(), clearColor.r, 0);
+		gpDevice->getRenderContext()->clearDsv(tex->getDSV().get(), clearColor.r, 0);
 }
 
 int32_t ResourceManager::requestTextureResource(const std::string &channelName, 
@@ -333,6 +434,7 @@ void ResourceManager::updateTextureSize(int32_t channelIdx, int32_t newWidth, in
 	if (mTextureSizes[channelIdx] == newSize) return;
 
 	// Update the channel
+	GpuMemoryTracker::Scope _memScope(getMemoryOwner(mTextureNames[channelIdx]));
 	mTextures[channelIdx] = Texture::create2D(newSize.x, newSize.y, mTextureFormat[channelIdx], 1u, Texture::kMaxPossible, nullptr, mTextureFlags[channelIdx]);
 	mTextureSizes[channelIdx] = newSize;
 	mUpdatedFlag = true;
@@ -89,6 +89,18 @@ public:
 	Texture::SharedPtr getEnvironmentMap() { return getTexture( kEnvironmentMap );  }
 	uvec2 getEnvironmentMapSize() const;
 
+	// Get the alias tables to importance sample the environment map with (see EnvMapSampling.slang).  They are
+	//     rebuilt every time the environment map changes.
+	EnvMapSampler::SharedPtr getEnvironmentMapSampler() const { return mpEnvMapSampler; }
+
+	// Get the spatiotemporal blue-noise masks ray generation shaders can draw their samples from (see BlueNoise.slang).  They are
+	//     generated the first time they are requested, and cached next to the executable so later runs only load them.
+	BlueNoise::SharedPtr getBlueNoise();
+
+	// Get the Sobol direction numbers ray generation shaders pass to the samplers of LowDiscrepancy.slang.  The buffer is created
+	//     the first time it is requested.
+	TypedBuffer<uint32_t>::SharedPtr getSobolDirections();
+
 	// Creates a framebuffer from a set of resources managed by the ResourceManager.  
 	//    -> Note:  This FBO remains valid until haveResourcesChanged() is true, at which point the user needs to recreate it
 	//    -> Color buffers are attached based on their location in the vector.  Invalid indicies (i.e., -1) can be inserted 
@@ -129,6 +141,39 @@ public:
     uint32_t getHeight() const     { return mHeight; }
 	uvec2    getScreenSize() const { return uvec2(mWidth, mHeight); }
 
+	// Groups of passes whose resolution can be lowered independently to hit a frame time (see DynamicResolution).  Fullscreen channels
+	//    keep their screen-sized allocation; passes render to the top-left getRenderSize() pixels of them instead.  Visibility and
+	//    reflection rays are traced at their group's size but written at the G-buffer's, so every channel uses getRenderSize().
+	enum class ResolutionGroup { GBuffer = 0, Visibility, Reflection, Denoise, Count };
+
+	// Set the scale of a group, relative to the screen size.  Takes effect at the next beginFrame().
+	void  setRenderScale(ResolutionGroup group, float scale);
+	float getRenderScale(ResolutionGroup group = ResolutionGroup::GBuffer) const { return mRenderScales[uint32_t(group)]; }
+
+	// Size of the sub-rect of fullscreen channels a group renders to this frame
+	uvec2 getRenderSize(ResolutionGroup group = ResolutionGroup::GBuffer) const { return mRenderSizes[uint32_t(group)]; }
+
+	// Size the G-buffer was rendered at last frame, to reproject the history of temporal passes
+	uvec2 getPrevRenderSize() const { return mPrevRenderSize; }
+
+	// A viewport covering the render size of a group, to set after binding an FBO of fullscreen channels
+	GraphicsState::Viewport getRenderViewport(ResolutionGroup group = ResolutionGroup::GBuffer) const;
+
+	// The render size of a group as a [left, up, right, down] rectangle, to only blit the pixels that were rendered
+	uvec4 getRenderRect(ResolutionGroup group = ResolutionGroup::GBuffer) const { return uvec4(0, 0, getRenderSize(group)); }
+
+	// Temporal upscaling: every group renders at 1 / factor of its scale, and an upscaling pass reconstructs the whole screen from the
+	//    jittered frames.  Like the scales, this takes effect at the next beginFrame().
+	void  setUpscaling(bool enabled, float factor = 1.0f);
+	bool  isUpscaling() const       { return mUpscaling; }
+	float getUpscaleFactor() const  { return mUpscaling ? mUpscaleFactor : 1.0f; }
+
+	// The part of the output channel holding the final image: the whole screen when upscaling, the G-buffer's render size otherwise
+	uvec4 getOutputRect() const { return mUpscaling ? uvec4(0, 0, mWidth, mHeight) : getRenderRect(); }
+
+	// The pipeline calls this before executing its passes, to apply the scales set since the last frame
+	void beginFrame();
+
 	// If resources have changed since last frame (and previous resource pointers may be invalid), this will return true
 	bool haveResourcesChanged() const { return mUpdatedFlag; }
 
@@ -140,7 +185,7 @@ public:
 	void  setMinTDist(float newMinT) { mMinT = newMinT; }
 
 protected:
-	ResourceManager(uint32_t width, uint32_t height, SampleCallbacks *callbacks) : mWidth(width), mHeight(height), mpAppCallbacks(callbacks) {}
+	ResourceManager(uint32_t width, uint32_t height, SampleCallbacks *callbacks);
 
     // Various internal state
     uint32_t mWidth = 0;    
@@ -149,8 +194,22 @@ protected:
 	bool     mUpdatedFlag = true;
 	float    mMinT = 1.0e-4f;
 
+	// Dynamic resolution state (see getRenderSize())
+	float    mRenderScales[uint32_t(ResolutionGroup::Count)] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	uvec2    mRenderSizes[uint32_t(ResolutionGroup::Count)];
+	uvec2    mPrevRenderSize = uvec2(0);
+	bool     mUpscaling = false;
+	float    mUpscaleFactor = 1.0f;
+	bool     mNextUpscaling = false;        ///< Set by setUpscaling(), applied by beginFrame()
+	float    mNextUpscaleFactor = 1.0f;
+
 	// If using the resource manager to manage an environment map, its filename is here.
 	std::string mEnvMapFilename = "";
+	EnvMapSampler::SharedPtr mpEnvMapSampler;
+
+	// Blue-noise masks for the ray generation shaders, created on first use
+	BlueNoise::SharedPtr mpBlueNoise;
+	TypedBuffer<uint32_t>::SharedPtr mpSobolDirections;
 
 	// Can specify the default scene to load
 	std::string mDefaultSceneName = "Media/Arcade/Arcade.fscene";
@@ -170,4 +229,7 @@ private:
 	// These are not meant to be exposed outside the class and may not have suitable error checking non-private use.
 	bool hasBindFlag(int32_t index, Resource::BindFlags flag);
 
+	// Loads the BC6H version of an environment map from the texture cooker's cache, cooking it if needed.  Returns nullptr if it can't be cooked.
+	Texture::SharedPtr loadCookedEnvironmentMap(const std::string &filename);
+
 };
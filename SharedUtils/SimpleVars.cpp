@@ -30,7 +30,12 @@ SimpleVars::SharedPtr SimpleVars::SimpleVars::create(Falcor::GraphicsVars *pVars
 	return SharedPtr(new SimpleVars( pVars ));
 }
 
-SimpleVars::SimpleVars(Falcor::GraphicsVars *pVars)
+SimpleVars::SharedPtr SimpleVars::SimpleVars::create(Falcor::ComputeVars *pVars)
+{
+	return SharedPtr(new SimpleVars( pVars ));
+}
+
+SimpleVars::SimpleVars(Falcor::ProgramVars *pVars)
 {
 	mpVars = pVars;
 }
@@ -117,6 +117,7 @@ public:
 	// public constructors
 	static SharedPtr create( Falcor::Program::SharedPtr pProg );       // Create from a Falcor program
 	static SharedPtr create( Falcor::GraphicsVars *pVars );  
+	static SharedPtr create( Falcor::ComputeVars *pVars );  
 	virtual ~SimpleVars() = default;
 
 	// Set a variable
@@ -141,16 +142,16 @@ public:
 	bool setRawBuffer(const std::string& name, Falcor::Buffer::SharedPtr& pBuffer);
 
 	// Get the current underlying Falcor variable class
-	Falcor::GraphicsVars *getVars()
+	Falcor::ProgramVars *getVars()
 	{	
 		return mpVars;
 	}
 
 protected:
-	SimpleVars(Falcor::GraphicsVars *pVars);
+	SimpleVars(Falcor::ProgramVars *pVars);
 
 private:
-	Falcor::GraphicsVars*   mpVars = nullptr;
+	Falcor::ProgramVars*    mpVars = nullptr;
 
 	// Internal utility function that does additional error checking beyond Falcor's built-in checks
 	//    -> returns true if shader variable [varName] exists and has type [varType]